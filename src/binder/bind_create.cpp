@@ -20,6 +20,7 @@
 // THE SOFTWARE.
 //===----------------------------------------------------------------------===//
 
+#include <cctype>
 #include <iterator>
 #include <memory>
 #include <string>
@@ -112,7 +113,31 @@ auto Binder::BindCreate(duckdb_libpgquery::PGCreateStmt *pg_stmt) -> std::unique
     throw bustub::Exception("should have at least 1 column");
   }
 
-  return std::make_unique<CreateStatement>(std::move(table), std::move(columns));
+  // CREATE TABLE ... WITH (layout = pax): 每页按列存 (PaxPage)
+  std::string layout = "row";
+  if (pg_stmt->options != nullptr) {
+    for (auto cell = pg_stmt->options->head; cell != nullptr; cell = cell->next) {
+      auto option = reinterpret_cast<duckdb_libpgquery::PGDefElem *>(cell->data.ptr_value);
+      if (strcmp(option->defname, "layout") != 0) {
+        throw NotImplementedException(fmt::format("table option {} is not supported", option->defname));
+      }
+      if (option->arg != nullptr && option->arg->type == duckdb_libpgquery::T_PGString) {
+        layout = StringUtil::Lower(reinterpret_cast<duckdb_libpgquery::PGValue *>(option->arg)->val.str);
+      } else if (option->arg != nullptr && option->arg->type == duckdb_libpgquery::T_PGTypeName) {
+        // 不加引号的 pax 被 parser 当成类型名
+        auto type_name = reinterpret_cast<duckdb_libpgquery::PGTypeName *>(option->arg);
+        layout = StringUtil::Lower(
+            reinterpret_cast<duckdb_libpgquery::PGValue *>(type_name->names->tail->data.ptr_value)->val.str);
+      } else {
+        throw NotImplementedException("layout expects row or pax");
+      }
+      if (layout != "row" && layout != "pax") {
+        throw NotImplementedException(fmt::format("table layout {} is not supported", layout));
+      }
+    }
+  }
+
+  return std::make_unique<CreateStatement>(std::move(table), std::move(columns), std::move(layout));
 }
 
 auto Binder::BindIndex(duckdb_libpgquery::PGIndexStmt *stmt) -> std::unique_ptr<IndexStatement> {
@@ -129,7 +154,75 @@ auto Binder::BindIndex(duckdb_libpgquery::PGIndexStmt *stmt) -> std::unique_ptr<
     }
   }
 
-  return std::make_unique<IndexStatement>(stmt->idxname, std::move(table), std::move(cols));
+  // PG 的 INCLUDE 子句 parser 不支持, 用 reloption 代替: CREATE INDEX ... WITH (include = 'c1, c2')
+  std::vector<std::unique_ptr<BoundColumnRef>> include_cols;
+  if (stmt->options != nullptr) {
+    for (auto cell = stmt->options->head; cell != nullptr; cell = cell->next) {
+      auto option = reinterpret_cast<duckdb_libpgquery::PGDefElem *>(cell->data.ptr_value);
+      if (strcmp(option->defname, "include") != 0) {
+        throw NotImplementedException(fmt::format("index option {} is not supported", option->defname));
+      }
+      std::vector<std::string> names;
+      if (option->arg != nullptr && option->arg->type == duckdb_libpgquery::T_PGString) {
+        auto list = StringUtil::Strip(reinterpret_cast<duckdb_libpgquery::PGValue *>(option->arg)->val.str, ' ');
+        names = StringUtil::Split(StringUtil::Lower(list), ',');
+      } else if (option->arg != nullptr && option->arg->type == duckdb_libpgquery::T_PGTypeName) {
+        // include = v2, 一个不加引号的列名被 parser 当成类型名
+        auto type_name = reinterpret_cast<duckdb_libpgquery::PGTypeName *>(option->arg);
+        names.emplace_back(
+            reinterpret_cast<duckdb_libpgquery::PGValue *>(type_name->names->tail->data.ptr_value)->val.str);
+      } else {
+        throw NotImplementedException("include expects a list of column names");
+      }
+      for (const auto &name : names) {
+        auto column_ref = ResolveColumn(*table, std::vector{name});
+        include_cols.emplace_back(std::make_unique<BoundColumnRef>(dynamic_cast<const BoundColumnRef &>(*column_ref)));
+      }
+    }
+  }
+
+  // CREATE INDEX ... USING hash / art / lsm; 不写 USING 时 parser 填的是 DEFAULT_INDEX_TYPE, 当作 btree
+  std::string index_type =
+      stmt->accessMethod == nullptr || !HasAccessMethodClause(stmt) ? "btree" : StringUtil::Lower(stmt->accessMethod);
+  if (index_type != "btree" && index_type != "hash" && index_type != "art" && index_type != "lsm") {
+    throw NotImplementedException(fmt::format("index access method {} is not supported", index_type));
+  }
+
+  return std::make_unique<IndexStatement>(stmt->idxname, std::move(table), std::move(cols), std::move(include_cols),
+                                          std::move(index_type));
+}
+
+auto Binder::HasAccessMethodClause(duckdb_libpgquery::PGIndexStmt *stmt) const -> bool {
+  if (query_.empty()) {
+    // 没有原文(直接 SaveParseTree), 只能看值: 和默认值一样就当作没写
+    return strcmp(stmt->accessMethod, DEFAULT_INDEX_TYPE) != 0;
+  }
+  // ON table [USING method] (columns): 表名之后, 列的左括号之前出现 USING 这个词.
+  // 不能用 Tokenize, 它会重置 parser 的内存, stmt 跟着失效
+  bool quoted = false;
+  for (auto i = static_cast<size_t>(stmt->relation->location); i < query_.size(); i++) {
+    char c = query_[i];
+    if (c == '"') {
+      quoted = !quoted;
+    }
+    if (quoted || c == '"') {
+      continue;
+    }
+    if (c == '(') {
+      return false;
+    }
+    size_t end = i;
+    while (end < query_.size() && (isalnum(query_[end]) != 0 || query_[end] == '_')) {
+      end++;
+    }
+    if (end > i) {
+      if (StringUtil::Lower(query_.substr(i, end - i)) == "using") {
+        return true;
+      }
+      i = end - 1;
+    }
+  }
+  return false;
 }
 
 }  // namespace bustub
@@ -8,6 +8,7 @@
 #include "binder/bound_order_by.h"
 #include "binder/bound_table_ref.h"
 #include "binder/expressions/bound_constant.h"
+#include "binder/statement/copy_statement.h"
 #include "binder/statement/delete_statement.h"
 #include "binder/statement/insert_statement.h"
 #include "binder/statement/select_statement.h"
@@ -34,6 +35,59 @@ auto Binder::BindInsert(duckdb_libpgquery::PGInsertStmt *pg_stmt) -> std::unique
   return std::make_unique<InsertStatement>(std::move(table), std::move(select_statement));
 }
 
+auto Binder::BindCopy(duckdb_libpgquery::PGCopyStmt *stmt) -> std::unique_ptr<CopyStatement> {
+  if (!stmt->is_from || stmt->is_program || stmt->filename == nullptr || stmt->relation == nullptr) {
+    throw NotImplementedException("copy only supports COPY table FROM 'file'");
+  }
+  if (stmt->attlist != nullptr) {
+    throw NotImplementedException("copy only supports all columns, don't specify columns");
+  }
+  auto table = BindBaseTableRef(stmt->relation->relname, std::nullopt);
+  if (StringUtil::StartsWith(table->table_, "__")) {
+    throw bustub::Exception(fmt::format("invalid table for copy: {}", table->table_));
+  }
+
+  // (FORMAT csv, DELIMITER '|', HEADER) 里的选项, 值是 PGString (不写值时为空)
+  std::string format = "csv";
+  char delimiter = ',';
+  bool header = false;
+  if (stmt->options != nullptr) {
+    for (auto cell = stmt->options->head; cell != nullptr; cell = cell->next) {
+      auto option = reinterpret_cast<duckdb_libpgquery::PGDefElem *>(cell->data.ptr_value);
+      std::string name = StringUtil::Lower(option->defname);
+      std::optional<std::string> arg;
+      if (option->arg != nullptr && option->arg->type == duckdb_libpgquery::T_PGString) {
+        arg = reinterpret_cast<duckdb_libpgquery::PGValue *>(option->arg)->val.str;
+      } else if (option->arg != nullptr && option->arg->type == duckdb_libpgquery::T_PGInteger) {
+        arg = std::to_string(reinterpret_cast<duckdb_libpgquery::PGValue *>(option->arg)->val.ival);
+      } else if (option->arg != nullptr) {
+        throw NotImplementedException(fmt::format("unsupported value for copy option {}", name));
+      }
+      if (name == "format") {
+        format = StringUtil::Lower(arg.value_or(""));
+        if (format != "csv" && format != "binary") {
+          throw NotImplementedException(fmt::format("copy format {} is not supported", format));
+        }
+      } else if (name == "delimiter") {
+        if (!arg.has_value() || arg->size() != 1 || (*arg)[0] == '"' || (*arg)[0] == '\n' || (*arg)[0] == '\r') {
+          throw bustub::Exception("copy delimiter must be a single character other than a quote or a line break");
+        }
+        delimiter = (*arg)[0];
+      } else if (name == "header") {
+        std::string value = StringUtil::Lower(arg.value_or("true"));
+        header = value == "true" || value == "on" || value == "1";
+        if (!header && value != "false" && value != "off" && value != "0") {
+          throw bustub::Exception(fmt::format("invalid value for copy option header: {}", value));
+        }
+      } else {
+        throw NotImplementedException(fmt::format("copy option {} is not supported", name));
+      }
+    }
+  }
+
+  return std::make_unique<CopyStatement>(std::move(table), stmt->filename, std::move(format), delimiter, header);
+}
+
 auto Binder::BindDelete(duckdb_libpgquery::PGDeleteStmt *stmt) -> std::unique_ptr<DeleteStatement> {
   auto table = BindBaseTableRef(stmt->relation->relname, std::nullopt);
   auto ctx_guard = NewContext();
@@ -718,6 +718,18 @@ auto Binder::BindAExpr(duckdb_libpgquery::PGAExpr *root) -> std::unique_ptr<Boun
   BUSTUB_ASSERT(root, "nullptr");
   auto name = std::string((reinterpret_cast<duckdb_libpgquery::PGValue *>(root->name->head->data.ptr_value))->val.str);
 
+  if (root->kind == duckdb_libpgquery::PG_AEXPR_IN) {
+    // x IN (a, b) 展开成 x = a OR x = b; NOT IN 的 name 是 "<>", 展开成 x <> a AND x <> b
+    auto items = BindExpressionList(reinterpret_cast<duckdb_libpgquery::PGList *>(root->rexpr));
+    std::string connective = name == "<>" ? "and" : "or";
+    std::unique_ptr<BoundExpression> expr = nullptr;
+    for (auto &item : items) {
+      auto cmp = std::make_unique<BoundBinaryOp>(name, BindExpression(root->lexpr), std::move(item));
+      expr = expr == nullptr ? std::move(cmp)
+                             : std::make_unique<BoundBinaryOp>(connective, std::move(expr), std::move(cmp));
+    }
+    return expr;
+  }
   if (root->kind != duckdb_libpgquery::PG_AEXPR_OP) {
     throw bustub::Exception("unsupported op in AExpr");
   }
@@ -759,9 +771,9 @@ auto Binder::BindBoolExpr(duckdb_libpgquery::PGBoolExpr *root) -> std::unique_pt
       if (exprs.size() <= 1) {
         throw bustub::Exception("AND should have at least 1 arg");
       }
-      auto expr = std::make_unique<BoundBinaryOp>("and", std::move(exprs[0]), std::move(exprs[1]));
+      auto expr = std::make_unique<BoundBinaryOp>(op_name, std::move(exprs[0]), std::move(exprs[1]));
       for (size_t i = 2; i < exprs.size(); i++) {
-        expr = std::make_unique<BoundBinaryOp>("and", std::move(expr), std::move(exprs[i]));
+        expr = std::make_unique<BoundBinaryOp>(op_name, std::move(expr), std::move(exprs[i]));
       }
       return expr;
     }
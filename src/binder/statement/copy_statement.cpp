@@ -0,0 +1,23 @@
+#include "binder/statement/copy_statement.h"
+#include "fmt/core.h"
+
+namespace bustub {
+
+CopyStatement::CopyStatement(std::unique_ptr<BoundBaseTableRef> table, std::string file_path, std::string format,
+                             char delimiter, bool header)
+    : BoundStatement(StatementType::COPY_STATEMENT),
+      table_(std::move(table)),
+      file_path_(std::move(file_path)),
+      format_(std::move(format)),
+      delimiter_(delimiter),
+      header_(header) {}
+
+auto CopyStatement::ToString() const -> std::string {
+  if (format_ == "binary") {
+    return fmt::format("BoundCopy {{ table={}, file={}, format=binary }}", *table_, file_path_);
+  }
+  return fmt::format("BoundCopy {{ table={}, file={}, format=csv, delimiter='{}', header={} }}", *table_, file_path_,
+                     delimiter_, header_);
+}
+
+}  // namespace bustub
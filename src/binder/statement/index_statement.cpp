@@ -7,14 +7,23 @@
 namespace bustub {
 
 IndexStatement::IndexStatement(std::string index_name, std::unique_ptr<BoundBaseTableRef> table,
-                               std::vector<std::unique_ptr<BoundColumnRef>> cols)
+                               std::vector<std::unique_ptr<BoundColumnRef>> cols,
+                               std::vector<std::unique_ptr<BoundColumnRef>> include_cols, std::string index_type)
     : BoundStatement(StatementType::INDEX_STATEMENT),
       index_name_(std::move(index_name)),
       table_(std::move(table)),
-      cols_(std::move(cols)) {}
+      cols_(std::move(cols)),
+      include_cols_(std::move(include_cols)),
+      index_type_(std::move(index_type)) {}
 
 auto IndexStatement::ToString() const -> std::string {
-  return fmt::format("BoundIndex {{ index_name={}, table={}, cols={} }}", index_name_, *table_, cols_);
+  std::string using_clause = index_type_ == "btree" ? "" : fmt::format(", using={}", index_type_);
+  if (include_cols_.empty()) {
+    return fmt::format("BoundIndex {{ index_name={}, table={}, cols={}{} }}", index_name_, *table_, cols_,
+                       using_clause);
+  }
+  return fmt::format("BoundIndex {{ index_name={}, table={}, cols={}, include={}{} }}", index_name_, *table_, cols_,
+                     include_cols_, using_clause);
 }
 
 }  // namespace bustub
@@ -61,7 +61,7 @@ BufferPoolManagerInstance::~BufferPoolManagerInstance() {
   2 如果 freelist 为空, 则 pages_ 不存在空闲的位置, 则用lru-k 驱逐一个页, 获取 framid, 获取page对象, 如果page脏了, 写磁盘, 返回 page内存地址
 */
 auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
-  //
+  std::scoped_lock<std::mutex> lock(latch_);      // 整个 pool 一把锁, 页内容由各自的 page latch 保护
   bool ret;
   frame_id_t page_fremeid;
   if (!free_list_.empty()) {
@@ -75,8 +75,10 @@ auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
     this->replacer_->SetEvictable(page_fremeid, false);
 
     Page *npg = &(pages_[page_fremeid]);
+    npg->ResetMemory();                               // 可能是 DeletePage 还回来的 frame, 新页要清零
     npg->pin_count_ = 1;
-    
+    npg->is_dirty_ = false;
+
     npg->page_id_ = npid;
 
     *page_id = npid;
@@ -115,12 +117,17 @@ auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
   4 返回该页
 */
 auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
+  std::scoped_lock<std::mutex> lock(latch_);
   bool ret;
   frame_id_t frame_id;
   assert(page_id != INVALID_PAGE_ID);
-  printf("FetchPgImp pageid=%d\n", page_id);
+  tcout << "FetchPgImp pageid=" << page_id << endl;
   if (this->page_table_->Find(page_id, frame_id)) {
-    return &(this->pages_[frame_id]);
+    Page *hpage = &(this->pages_[frame_id]);           // 命中也要 pin, 否则用着的页可能被驱逐
+    hpage->pin_count_++;
+    this->replacer_->RecordAccess(frame_id);
+    this->replacer_->SetEvictable(frame_id, false);
+    return hpage;
   }
 
   if (!this->free_list_.empty()) {
@@ -147,7 +154,7 @@ auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
     this->disk_manager_->WritePage(evp->page_id_, evp->GetData());   //将驱逐页写入
   }
 
-  this->page_table_->Remove(page_id);
+  this->page_table_->Remove(evp->page_id_);               // 删除被驱逐页的映射
   this->page_table_->Insert(page_id, frame_id);
 
   this->replacer_->RecordAccess(frame_id);
@@ -169,8 +176,9 @@ auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
   3 传入为脏, 则设置脏页
 */
 auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
   frame_id_t frame_id;
-  printf("UnpinPgImp pageid=%d\n", page_id);
+  tcout << "UnpinPgImp pageid=" << page_id << endl;
   if (!this->page_table_->Find(page_id, frame_id)) {
     return false;
   }
@@ -185,7 +193,7 @@ auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) ->
     this->replacer_->SetEvictable(frame_id, true);
   }
 
-  fpage->is_dirty_ = is_dirty;
+  fpage->is_dirty_ = fpage->is_dirty_ || is_dirty;       // 只读的 unpin 不能清掉别人写过的脏标记
 
   return true; 
 }
@@ -195,6 +203,7 @@ auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) ->
   2 如果有, 则刷到磁盘, 重置脏标记
 */
 auto BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
   frame_id_t frame_id;
   if (!this->page_table_->Find(page_id, frame_id)) {
     return false;
@@ -211,9 +220,14 @@ auto BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) -> bool {
 }
 
 void BufferPoolManagerInstance::FlushAllPgsImp() {
+  std::scoped_lock<std::mutex> lock(latch_);
   for (size_t i = 0; i < this->pool_size_; i++) {
     Page *fpg = &(this->pages_[i]);
-    this->FlushPgImp(fpg->page_id_);
+    if (fpg->page_id_ == INVALID_PAGE_ID) {
+      continue;
+    }
+    this->disk_manager_->WritePage(fpg->page_id_, fpg->GetData());
+    fpg->is_dirty_ = false;
   }
   return;
 }
@@ -222,7 +236,8 @@ void BufferPoolManagerInstance::FlushAllPgsImp() {
   1 从pagetable中找 page_id, 如果没有, 则返回false; 如果页被pin , 则不可删除, 返回false
   2 删除页在pagetable, lru, 加入freelist 中, 
 */
-auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool { 
+auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
   frame_id_t frame_id;
   if (!this->page_table_->Find(page_id, frame_id)) {
     return false;
@@ -236,9 +251,16 @@ auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
   this->page_table_->Remove(page_id);
   this->replacer_->Remove(frame_id);
   this->free_list_.push_front(frame_id);
+  dpg->page_id_ = INVALID_PAGE_ID;                        // 空闲 frame 不属于任何页
   this->DeallocatePage(page_id);
 
-  return true; 
+  return true;
+}
+
+auto BufferPoolManagerInstance::IsPageResident(page_id_t page_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  frame_id_t frame_id;
+  return this->page_table_->Find(page_id, frame_id);
 }
 
 void BufferPoolManagerInstance::MyPrintData() {
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <optional>
 #include <string>
 #include <tuple>
@@ -5,6 +6,7 @@
 #include "binder/binder.h"
 #include "binder/bound_expression.h"
 #include "binder/bound_statement.h"
+#include "binder/statement/copy_statement.h"
 #include "binder/statement/create_statement.h"
 #include "binder/statement/explain_statement.h"
 #include "binder/statement/index_statement.h"
@@ -18,6 +20,7 @@
 #include "common/exception.h"
 #include "common/util/string_util.h"
 #include "concurrency/lock_manager.h"
+#include "execution/copy_from.h"
 #include "execution/execution_engine.h"
 #include "execution/executor_context.h"
 #include "execution/executors/mock_scan_executor.h"
@@ -31,10 +34,33 @@
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree_index.h"
 #include "type/value_factory.h"
 
 namespace bustub {
 
+namespace {
+
+/** 索引项 (key + include 列) 放在 GenericKey<KeySize> 里, comparator 只比较 key 列 */
+template <size_t KeySize>
+auto CreateBPlusTreeIndex(Catalog *catalog, Transaction *txn, const IndexStatement &index_stmt,
+                          const Schema &key_schema, const std::vector<uint32_t> &col_ids,
+                          const std::vector<uint32_t> &include_ids) -> IndexInfo * {
+  auto *info = catalog->CreateIndex<GenericKey<KeySize>, RID, GenericComparator<KeySize>>(
+      txn, index_stmt.index_name_, index_stmt.table_->table_, index_stmt.table_->schema_, key_schema, col_ids, KeySize,
+      HashFunction<GenericKey<KeySize>>{}, include_ids);
+  using TreeIndex = BPlusTreeIndex<GenericKey<KeySize>, RID, GenericComparator<KeySize>>;
+  if (info != Catalog::NULL_INDEX_INFO) {
+    // catalog 先于 buffer pool 析构 (见 ~BustubInstance), 索引可以一直 pin 着 swizzle 的 frame
+    if (auto *tree = dynamic_cast<TreeIndex *>(info->index_.get()); tree != nullptr) {
+      tree->SetSwizzleLevels(BPLUS_TREE_SWIZZLE_LEVELS);
+    }
+  }
+  return info;
+}
+
+}  // namespace
+
 auto BustubInstance::MakeExecutorContext(Transaction *txn) -> std::unique_ptr<ExecutorContext> {
   return std::make_unique<ExecutorContext>(txn, catalog_, buffer_pool_manager_, transaction_manager_, lock_manager_);
 }
@@ -114,6 +140,104 @@ void BustubInstance::CmdDisplayIndices(ResultWriter &writer) {
   writer.EndTable();
 }
 
+/*
+ * 重建一个 b+ 树索引, 输出重建前后的高度, 页数, 填充率和叶子链连续度.
+ * 内置的语法里没有 REINDEX, 先做成 meta-command.
+ */
+void BustubInstance::CmdReindex(const std::string &index_name, ResultWriter &writer) {
+  IndexInfo *index_info = nullptr;
+  for (const auto &table_name : catalog_->GetTableNames()) {
+    for (auto *info : catalog_->GetTableIndexes(table_name)) {
+      if (info->name_ == index_name) {
+        index_info = info;
+      }
+    }
+  }
+  if (index_info == nullptr) {
+    throw Exception(fmt::format("index {} not found", index_name));
+  }
+  auto before = index_info->index_->GetStats();
+  if (!before.has_value()) {
+    throw NotImplementedException("reindex is only supported on b+ tree indexes");
+  }
+  auto txn = transaction_manager_->Begin();
+  index_info->index_->Reindex(txn);
+  transaction_manager_->Commit(txn);
+  delete txn;
+  auto after = index_info->index_->GetStats();
+
+  writer.BeginTable(false);
+  writer.BeginHeader();
+  for (const auto *header :
+       {"", "height", "internal_pages", "leaf_pages", "entries", "fill_factor", "leaf_contiguity"}) {
+    writer.WriteHeaderCell(header);
+  }
+  writer.EndHeader();
+  for (const auto &[name, stats] : {std::make_pair("before", *before), std::make_pair("after", *after)}) {
+    writer.BeginRow();
+    writer.WriteCell(name);
+    writer.WriteCell(fmt::format("{}", stats.height_));
+    writer.WriteCell(fmt::format("{}", stats.internal_pages_));
+    writer.WriteCell(fmt::format("{}", stats.leaf_pages_));
+    writer.WriteCell(fmt::format("{}", stats.entries_));
+    writer.WriteCell(fmt::format("{:.2f}", stats.fill_factor_));
+    writer.WriteCell(fmt::format("{:.2f}", stats.leaf_contiguity_));
+    writer.EndRow();
+  }
+  writer.EndTable();
+}
+
+/*
+ * 一张表的 zone map: 页数, seq scan 按谓词检查过后读了的页和跳过的页.
+ */
+void BustubInstance::CmdDisplayZoneMap(const std::string &table_name, ResultWriter &writer) {
+  const auto *table_info = catalog_->GetTable(table_name);
+  if (table_info == nullptr) {
+    throw Exception(fmt::format("table {} not found", table_name));
+  }
+  ZoneMap *zone_map = table_info->table_ == nullptr ? nullptr : table_info->table_->GetZoneMap();
+  if (zone_map == nullptr) {
+    throw Exception(fmt::format("table {} has no zone map", table_name));
+  }
+  auto stats = zone_map->GetStats();
+  writer.BeginTable(false);
+  writer.BeginHeader();
+  for (const auto *header : {"pages", "pages_scanned", "pages_skipped"}) {
+    writer.WriteHeaderCell(header);
+  }
+  writer.EndHeader();
+  writer.BeginRow();
+  writer.WriteCell(fmt::format("{}", stats.pages_));
+  writer.WriteCell(fmt::format("{}", stats.pages_scanned_));
+  writer.WriteCell(fmt::format("{}", stats.pages_skipped_));
+  writer.EndRow();
+  writer.EndTable();
+}
+
+/*
+ * 马上 vacuum 一张表的每一页, 不等后台: 访问的页, 整理出的字节, 摘掉的空页, 回收来再用的页.
+ */
+void BustubInstance::CmdVacuum(const std::string &table_name, ResultWriter &writer) {
+  const auto *table_info = catalog_->GetTable(table_name);
+  if (table_info == nullptr || table_info->table_ == nullptr) {
+    throw Exception(fmt::format("table {} not found", table_name));
+  }
+  auto stats = table_info->table_->Vacuum(SIZE_MAX, true);
+  writer.BeginTable(false);
+  writer.BeginHeader();
+  for (const auto *header : {"pages_visited", "bytes_reclaimed", "pages_unlinked", "pages_recycled"}) {
+    writer.WriteHeaderCell(header);
+  }
+  writer.EndHeader();
+  writer.BeginRow();
+  writer.WriteCell(fmt::format("{}", stats.pages_visited_));
+  writer.WriteCell(fmt::format("{}", stats.bytes_reclaimed_));
+  writer.WriteCell(fmt::format("{}", stats.pages_unlinked_));
+  writer.WriteCell(fmt::format("{}", stats.pages_recycled_));
+  writer.EndRow();
+  writer.EndTable();
+}
+
 void BustubInstance::WriteOneCell(const std::string &cell, ResultWriter &writer) {
   writer.BeginTable(true);
   writer.BeginRow();
@@ -127,6 +251,9 @@ void BustubInstance::CmdDisplayHelp(ResultWriter &writer) {
 
 \dt: show all tables
 \di: show all indices
+\reindex <index>: rebuild a b+ tree index compactly, with its leaves in page order
+\zonemap <table>: show how many pages the zone map of a table let seq scans skip
+\vacuum <table>: compact every page of a table now and recycle its empty pages
 \help: show this message again
 
 BusTub shell currently only supports a small set of Postgres queries. We'll set
@@ -155,6 +282,18 @@ void BustubInstance::ExecuteSql(const std::string &sql, ResultWriter &writer) {
       CmdDisplayHelp(writer);
       return;
     }
+    if (sql.rfind("\\reindex ", 0) == 0) {
+      CmdReindex(StringUtil::Strip(sql.substr(9), ' '), writer);
+      return;
+    }
+    if (sql.rfind("\\zonemap ", 0) == 0) {
+      CmdDisplayZoneMap(StringUtil::Strip(sql.substr(9), ' '), writer);
+      return;
+    }
+    if (sql.rfind("\\vacuum ", 0) == 0) {
+      CmdVacuum(StringUtil::Strip(sql.substr(8), ' '), writer);
+      return;
+    }
     throw Exception(fmt::format("unsupported internal command: {}", sql));
   }
 
@@ -167,7 +306,8 @@ void BustubInstance::ExecuteSql(const std::string &sql, ResultWriter &writer) {
       case StatementType::CREATE_STATEMENT: {
         const auto &create_stmt = dynamic_cast<const CreateStatement &>(*statement);
         auto txn = transaction_manager_->Begin();
-        auto info = catalog_->CreateTable(txn, create_stmt.table_, Schema(create_stmt.columns_));
+        auto layout = create_stmt.layout_ == "pax" ? TableLayout::PAX : TableLayout::ROW;
+        auto info = catalog_->CreateTable(txn, create_stmt.table_, Schema(create_stmt.columns_), true, layout);
         transaction_manager_->Commit(txn);
         delete txn;
         if (info == nullptr) {
@@ -181,20 +321,109 @@ void BustubInstance::ExecuteSql(const std::string &sql, ResultWriter &writer) {
         auto txn = transaction_manager_->Begin();
 
         std::vector<uint32_t> col_ids;
+        bool varchar_key = false;
         for (const auto &col : index_stmt.cols_) {
           auto idx = index_stmt.table_->schema_.GetColIdx(col->col_name_.back());
           col_ids.push_back(idx);                                                       // 表中某些列的的一个集合
-          if (index_stmt.table_->schema_.GetColumn(idx).GetType() != TypeId::INTEGER) {
-            throw NotImplementedException("only support creating index on integer column");
+          auto type = index_stmt.table_->schema_.GetColumn(idx).GetType();
+          if (type != TypeId::INTEGER && type != TypeId::VARCHAR) {
+            throw NotImplementedException("only support creating index on integer or varchar column");
           }
+          varchar_key = varchar_key || type == TypeId::VARCHAR;
         }
         if (col_ids.size() != 1) {
           throw NotImplementedException("only support creating index with exactly one column");
         }
+        // covering index: include 列跟在 key 后面存进叶子, 按总长度选 key 大小
+        std::vector<uint32_t> include_ids;
+        for (const auto &col : index_stmt.include_cols_) {
+          auto idx = index_stmt.table_->schema_.GetColIdx(col->col_name_.back());
+          if (index_stmt.table_->schema_.GetColumn(idx).GetType() != TypeId::INTEGER) {
+            throw NotImplementedException("only support including integer columns");
+          }
+          if (std::find(col_ids.begin(), col_ids.end(), idx) != col_ids.end() ||
+              std::find(include_ids.begin(), include_ids.end(), idx) != include_ids.end()) {
+            throw bustub::Exception(fmt::format("column {} is included twice", col->col_name_.back()));
+          }
+          include_ids.push_back(idx);
+        }
         auto key_schema = Schema::CopySchema(&index_stmt.table_->schema_, col_ids);
-        auto info = catalog_->CreateIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>(
-            txn, index_stmt.index_name_, index_stmt.table_->table_, index_stmt.table_->schema_, key_schema, col_ids,
-            INTEGER_SIZE, IntegerHashFunctionType{});
+        // hash 索引只做点查 (IndexLookup), 只支持单个 integer key, 不带 include 列
+        if (index_stmt.index_type_ == "hash") {
+          if (varchar_key || !include_ids.empty()) {
+            throw NotImplementedException("hash indexes only support an integer key without include columns");
+          }
+          auto *info = catalog_->CreateHashIndex<GenericKey<INTEGER_SIZE>, RID, GenericComparator<INTEGER_SIZE>>(
+              txn, index_stmt.index_name_, index_stmt.table_->table_, index_stmt.table_->schema_, key_schema, col_ids,
+              INTEGER_SIZE, HashFunction<GenericKey<INTEGER_SIZE>>{});
+          transaction_manager_->Commit(txn);
+          delete txn;
+          if (info == nullptr) {
+            throw bustub::Exception("Failed to create index");
+          }
+          WriteOneCell(fmt::format("Index created with id = {}", info->index_oid_), writer);
+          continue;
+        }
+        // art 索引在内存里, integer 和 varchar key 都用 KeyEncoder 编码, 不带 include 列
+        if (index_stmt.index_type_ == "art") {
+          if (!include_ids.empty()) {
+            throw NotImplementedException("art indexes do not support include columns");
+          }
+          auto *info = catalog_->CreateArtIndex(txn, index_stmt.index_name_, index_stmt.table_->table_,
+                                                index_stmt.table_->schema_, key_schema, col_ids);
+          transaction_manager_->Commit(txn);
+          delete txn;
+          if (info == nullptr) {
+            throw bustub::Exception("Failed to create index");
+          }
+          WriteOneCell(fmt::format("Index created with id = {}", info->index_oid_), writer);
+          continue;
+        }
+        // lsm 索引: key 的编码同 art, run 写在 buffer pool 的页上, 不带 include 列
+        if (index_stmt.index_type_ == "lsm") {
+          if (!include_ids.empty()) {
+            throw NotImplementedException("lsm indexes do not support include columns");
+          }
+          auto *info = catalog_->CreateLsmIndex(txn, index_stmt.index_name_, index_stmt.table_->table_,
+                                                index_stmt.table_->schema_, key_schema, col_ids);
+          transaction_manager_->Commit(txn);
+          delete txn;
+          if (info == nullptr) {
+            throw bustub::Exception("Failed to create index");
+          }
+          WriteOneCell(fmt::format("Index created with id = {}", info->index_oid_), writer);
+          continue;
+        }
+        // varchar key: 变长 key 的 slotted b+ 树, 不用补齐到 GenericKey<64>, 超长的 key 放到 overflow page
+        if (varchar_key) {
+          if (!include_ids.empty()) {
+            throw NotImplementedException("include columns are only supported on integer keys");
+          }
+          auto *info = catalog_->CreateSlottedIndex(txn, index_stmt.index_name_, index_stmt.table_->table_,
+                                                     index_stmt.table_->schema_, key_schema, col_ids);
+          transaction_manager_->Commit(txn);
+          delete txn;
+          if (info == nullptr) {
+            throw bustub::Exception("Failed to create index");
+          }
+          WriteOneCell(fmt::format("Index created with id = {}", info->index_oid_), writer);
+          continue;
+        }
+        size_t entry_size = INTEGER_SIZE * (col_ids.size() + include_ids.size());
+        IndexInfo *info;
+        if (entry_size <= INTEGER_SIZE) {
+          info = CreateBPlusTreeIndex<INTEGER_SIZE>(catalog_, txn, index_stmt, key_schema, col_ids, include_ids);
+        } else if (entry_size <= 8) {
+          info = CreateBPlusTreeIndex<8>(catalog_, txn, index_stmt, key_schema, col_ids, include_ids);
+        } else if (entry_size <= 16) {
+          info = CreateBPlusTreeIndex<16>(catalog_, txn, index_stmt, key_schema, col_ids, include_ids);
+        } else if (entry_size <= 32) {
+          info = CreateBPlusTreeIndex<32>(catalog_, txn, index_stmt, key_schema, col_ids, include_ids);
+        } else if (entry_size <= 64) {
+          info = CreateBPlusTreeIndex<64>(catalog_, txn, index_stmt, key_schema, col_ids, include_ids);
+        } else {
+          throw NotImplementedException("index entry (key and include columns) is limited to 64 bytes");
+        }
         transaction_manager_->Commit(txn);
         delete txn;
         if (info == nullptr) {
@@ -203,6 +432,28 @@ void BustubInstance::ExecuteSql(const std::string &sql, ResultWriter &writer) {
         WriteOneCell(fmt::format("Index created with id = {}", info->index_oid_), writer);
         continue;
       }
+      case StatementType::COPY_STATEMENT: {
+        // COPY 不经过 planner 和 InsertExecutor, 直接写新页, 见 CopyFromFile
+        const auto &copy_stmt = dynamic_cast<const CopyStatement &>(*statement);
+        CopyFromOptions options;
+        options.binary_ = copy_stmt.format_ == "binary";
+        options.delimiter_ = copy_stmt.delimiter_;
+        options.header_ = copy_stmt.header_;
+        auto txn = transaction_manager_->Begin();
+        size_t rows;
+        try {
+          rows = CopyFromFile(buffer_pool_manager_, catalog_, catalog_->GetTable(copy_stmt.table_->oid_),
+                              copy_stmt.file_path_, options, txn);
+        } catch (...) {
+          transaction_manager_->Abort(txn);
+          delete txn;
+          throw;
+        }
+        transaction_manager_->Commit(txn);
+        delete txn;
+        WriteOneCell(fmt::format("COPY {}", rows), writer);
+        continue;
+      }
       case StatementType::VARIABLE_SHOW_STATEMENT: {
         const auto &show_stmt = dynamic_cast<const VariableShowStatement &>(*statement);
         auto content = GetSessionVariable(show_stmt.variable_);
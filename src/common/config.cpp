@@ -12,10 +12,19 @@
 
 #include "common/config.h"
 
+#include <algorithm>
+#include <thread>  // NOLINT
+
 namespace bustub {
 
 std::atomic<bool> enable_logging(false);
 
+std::atomic<size_t> scan_workers(std::max(1U, std::thread::hardware_concurrency()));
+
+std::atomic<size_t> query_memory_budget(64 << 20);
+
+std::atomic<bool> enable_background_vacuum(false);
+
 std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
@@ -0,0 +1,173 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// csv_reader.cpp
+//
+// Identification: src/common/util/csv_reader.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/csv_reader.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
+
+#include "common/exception.h"
+#include "fmt/format.h"
+
+namespace bustub {
+
+CsvReader::CsvReader(const std::string &path, char delimiter, char quote)
+    : file_(fopen(path.c_str(), "rb")), delimiter_(delimiter), quote_(quote), buffer_(CHUNK_SIZE) {
+  if (file_ == nullptr) {
+    throw Exception(fmt::format("cannot open {}: {}", path, strerror(errno)));
+  }
+}
+
+CsvReader::~CsvReader() { fclose(file_); }
+
+auto CsvReader::NextRow(std::vector<std::string_view> *fields) -> bool {
+  fields->clear();
+  while (true) {
+    if (begin_ == end_ && (eof_ || !Fill())) {
+      return false;
+    }
+    if (ParseRow()) {
+      break;
+    }
+    // 记录跨过了读进来的数据的末尾, 读下一块再从记录开头重新解析; 读到文件尾时 ParseRow 一定能完成
+    Fill();
+  }
+  for (const auto &field : fields_) {
+    const char *base = field.in_scratch_ ? scratch_.data() : buffer_.data();
+    fields->emplace_back(base + field.offset_, field.length_);
+  }
+  return true;
+}
+
+auto CsvReader::ParseRow() -> bool {
+  fields_.clear();
+  scratch_.clear();
+  const char *buf = buffer_.data();
+  const char *p = buf + begin_;
+  const char *end = buf + end_;
+  while (true) {
+    Field field{0, 0, false, false};
+    if (p < end && *p == quote_) {
+      field.quoted_ = true;
+      const char *start = ++p;
+      while (true) {
+        auto q = static_cast<const char *>(memchr(p, quote_, end - p));
+        if (q == nullptr || (q + 1 == end && !eof_)) {
+          if (!eof_) {
+            return false;
+          }
+          throw Exception("unterminated quoted field");
+        }
+        if (q + 1 < end && q[1] == quote_) {
+          // "" 是一个引号: 这个字段要拷到 scratch_ 里去掉转义
+          if (!field.in_scratch_) {
+            field.in_scratch_ = true;
+            field.offset_ = scratch_.size();
+          }
+          scratch_.append(p, q + 1 - p);
+          p = q + 2;
+          continue;
+        }
+        if (field.in_scratch_) {
+          scratch_.append(p, q - p);
+          field.length_ = scratch_.size() - field.offset_;
+        } else {
+          field.offset_ = start - buf;
+          field.length_ = q - start;
+        }
+        p = q + 1;
+        break;
+      }
+      if (p < end && *p != delimiter_ && *p != '\n' && *p != '\r') {
+        throw Exception("unexpected text after a closing quote");
+      }
+    } else {
+      const char *q = FindSpecial(p, end);
+      if (q == end && !eof_) {
+        return false;
+      }
+      if (q < end && *q == quote_) {
+        throw Exception("quote inside an unquoted field");
+      }
+      field.offset_ = p - buf;
+      field.length_ = q - p;
+      p = q;
+    }
+    fields_.push_back(field);
+
+    if (p == end) {
+      break;
+    }
+    if (*p == delimiter_) {
+      p++;
+      continue;
+    }
+    if (*p++ == '\r') {
+      if (p == end && !eof_) {
+        return false;
+      }
+      if (p < end && *p == '\n') {
+        p++;
+      }
+    }
+    break;
+  }
+  begin_ = p - buf;
+  return true;
+}
+
+auto CsvReader::Fill() -> bool {
+  size_t unread = end_ - begin_;
+  memmove(buffer_.data(), buffer_.data() + begin_, unread);
+  begin_ = 0;
+  end_ = unread;
+  // 一条记录比整个 buffer 还长
+  if (end_ == buffer_.size()) {
+    buffer_.resize(buffer_.size() * 2);
+  }
+  size_t read = fread(buffer_.data() + end_, 1, buffer_.size() - end_, file_);
+  end_ += read;
+  if (read == 0) {
+    eof_ = true;
+  }
+  return read > 0;
+}
+
+auto CsvReader::FindSpecial(const char *p, const char *end) const -> const char * {
+#if defined(__SSE2__)
+  const __m128i delimiter = _mm_set1_epi8(delimiter_);
+  const __m128i quote = _mm_set1_epi8(quote_);
+  const __m128i newline = _mm_set1_epi8('\n');
+  const __m128i carriage_return = _mm_set1_epi8('\r');
+  for (; p + 16 <= end; p += 16) {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    const __m128i field_end = _mm_or_si128(_mm_cmpeq_epi8(chunk, delimiter), _mm_cmpeq_epi8(chunk, quote));
+    const __m128i line_end = _mm_or_si128(_mm_cmpeq_epi8(chunk, newline), _mm_cmpeq_epi8(chunk, carriage_return));
+    int mask = _mm_movemask_epi8(_mm_or_si128(field_end, line_end));
+    if (mask != 0) {
+      return p + __builtin_ctz(mask);
+    }
+  }
+#endif
+  for (; p < end; p++) {
+    if (*p == delimiter_ || *p == quote_ || *p == '\n' || *p == '\r') {
+      return p;
+    }
+  }
+  return end;
+}
+
+}  // namespace bustub
@@ -0,0 +1,894 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// adaptive_radix_tree.cpp
+//
+// Identification: src/container/art/adaptive_radix_tree.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <thread>  // NOLINT
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "common/rid.h"
+#include "container/art/adaptive_radix_tree.h"
+
+namespace bustub {
+
+enum class ArtNodeType : uint8_t { Node4, Node16, Node48, Node256 };
+
+/**
+ * Header shared by the four inner node layouts: the optimistic lock and the compressed path.
+ *
+ * version_ bit 0 is the obsolete bit, bit 1 the lock bit, the bits above count write unlocks. Readers race with the
+ * writer on every other field, and only act on what they read once CheckOrRestart says the version did not move.
+ */
+class ArtNode {
+ public:
+  ArtNode(ArtNodeType type, std::string_view prefix)
+      : type_(type),
+        prefix_len_(static_cast<uint32_t>(prefix.size())),
+        prefix_(new char[std::max<size_t>(prefix.size(), 1)]) {
+    memcpy(prefix_.get(), prefix.data(), prefix.size());
+  }
+
+  virtual ~ArtNode() = default;
+
+  /** wait out a writer and return the version, restart if the node has been unlinked */
+  auto ReadLockOrRestart(bool *restart) const -> uint64_t {
+    uint64_t version = version_.load();
+    while ((version & LOCKED) != 0) {
+      std::this_thread::yield();
+      version = version_.load();
+    }
+    if ((version & OBSOLETE) != 0) {
+      *restart = true;
+    }
+    return version;
+  }
+
+  /** restart if anything was written since version was read */
+  void CheckOrRestart(uint64_t version, bool *restart) const {
+    if (version_.load() != version) {
+      *restart = true;
+    }
+  }
+
+  /** lock the node if it is still at version, so everything read under version stays true */
+  void UpgradeToWriteLockOrRestart(uint64_t *version, bool *restart) {
+    if (version_.compare_exchange_strong(*version, *version + LOCKED)) {
+      *version += LOCKED;
+    } else {
+      *restart = true;
+    }
+  }
+
+  void WriteUnlock() { version_.fetch_add(LOCKED); }
+
+  void WriteUnlockObsolete() { version_.fetch_add(LOCKED | OBSOLETE); }
+
+  auto Prefix() const -> std::string_view { return {prefix_.get(), prefix_len_}; }
+
+  /** drop the first n bytes of the prefix in place; the buffer keeps its size, so a racing reader stays inside it */
+  void ChopPrefix(uint32_t n) {
+    memmove(prefix_.get(), prefix_.get() + n, prefix_len_ - n);
+    prefix_len_ -= n;
+  }
+
+  static constexpr uint64_t OBSOLETE = 1;
+  static constexpr uint64_t LOCKED = 2;
+
+  std::atomic<uint64_t> version_{0};
+  const ArtNodeType type_;
+  uint16_t count_{0};
+  uint32_t prefix_len_;
+  std::unique_ptr<char[]> prefix_;
+};
+
+/** up to 4 children, key bytes sorted */
+class ArtNode4 : public ArtNode {
+ public:
+  explicit ArtNode4(std::string_view prefix) : ArtNode(ArtNodeType::Node4, prefix) {}
+  std::array<uint8_t, 4> keys_{};
+  std::array<std::atomic<ArtNode *>, 4> children_{};
+};
+
+/** up to 16 children, key bytes sorted and compared 16 at a time */
+class ArtNode16 : public ArtNode {
+ public:
+  explicit ArtNode16(std::string_view prefix) : ArtNode(ArtNodeType::Node16, prefix) {}
+  std::array<uint8_t, 16> keys_{};
+  std::array<std::atomic<ArtNode *>, 16> children_{};
+};
+
+/** up to 48 children, child_index_ maps a key byte to its slot in children_ */
+class ArtNode48 : public ArtNode {
+ public:
+  static constexpr uint8_t EMPTY = 48;
+  explicit ArtNode48(std::string_view prefix) : ArtNode(ArtNodeType::Node48, prefix) { child_index_.fill(EMPTY); }
+  std::array<uint8_t, 256> child_index_;
+  std::array<std::atomic<ArtNode *>, 48> children_{};
+};
+
+/** one child per key byte */
+class ArtNode256 : public ArtNode {
+ public:
+  explicit ArtNode256(std::string_view prefix) : ArtNode(ArtNodeType::Node256, prefix) {}
+  std::array<std::atomic<ArtNode *>, 256> children_{};
+};
+
+/**
+ * Leaves never change after they are linked in. The key bytes follow the struct in the same allocation, so reaching
+ * the leaf and comparing its key is one cache miss, not two.
+ */
+template <typename ValueType>
+struct ArtLeaf {
+  static auto Make(std::string_view key, const ValueType &value) -> ArtLeaf * {
+    void *memory = ::operator new(sizeof(ArtLeaf) + key.size());
+    auto *leaf = new (memory) ArtLeaf{value, static_cast<uint32_t>(key.size())};
+    memcpy(leaf + 1, key.data(), key.size());
+    return leaf;
+  }
+
+  static void Free(ArtLeaf *leaf) {
+    leaf->~ArtLeaf();
+    ::operator delete(leaf);
+  }
+
+  auto Key() const -> std::string_view { return {reinterpret_cast<const char *>(this + 1), key_len_}; }
+
+  ValueType value_;
+  uint32_t key_len_;
+};
+
+namespace {
+
+// 叶子和内部节点放在同一个 child 指针里, 叶子的指针最低位置 1
+constexpr uintptr_t LEAF_TAG = 1;
+
+auto IsLeaf(const ArtNode *child) -> bool { return (reinterpret_cast<uintptr_t>(child) & LEAF_TAG) != 0; }
+
+template <typename ValueType>
+auto AsLeaf(const ArtNode *child) -> ArtLeaf<ValueType> * {
+  return reinterpret_cast<ArtLeaf<ValueType> *>(reinterpret_cast<uintptr_t>(child) & ~LEAF_TAG);
+}
+
+template <typename ValueType>
+auto TagLeaf(ArtLeaf<ValueType> *leaf) -> ArtNode * {
+  return reinterpret_cast<ArtNode *>(reinterpret_cast<uintptr_t>(leaf) | LEAF_TAG);
+}
+
+auto Byte(std::string_view key, size_t depth) -> uint8_t { return static_cast<uint8_t>(key[depth]); }
+
+/** count_ read by a racing reader may be stale, never index past the arrays with it */
+template <size_t Capacity>
+auto Count(const ArtNode *node) -> size_t {
+  return std::min<size_t>(node->count_, Capacity);
+}
+
+auto NewNode(ArtNodeType type, std::string_view prefix) -> ArtNode * {
+  switch (type) {
+    case ArtNodeType::Node4:
+      return new ArtNode4(prefix);
+    case ArtNodeType::Node16:
+      return new ArtNode16(prefix);
+    case ArtNodeType::Node48:
+      return new ArtNode48(prefix);
+    case ArtNodeType::Node256:
+      return new ArtNode256(prefix);
+  }
+  return nullptr;
+}
+
+auto Grown(ArtNodeType type) -> ArtNodeType {
+  switch (type) {
+    case ArtNodeType::Node4:
+      return ArtNodeType::Node16;
+    case ArtNodeType::Node16:
+      return ArtNodeType::Node48;
+    default:
+      return ArtNodeType::Node256;
+  }
+}
+
+auto Shrunk(ArtNodeType type) -> ArtNodeType {
+  switch (type) {
+    case ArtNodeType::Node256:
+      return ArtNodeType::Node48;
+    case ArtNodeType::Node48:
+      return ArtNodeType::Node16;
+    default:
+      return ArtNodeType::Node4;
+  }
+}
+
+auto IsFull(const ArtNode *node) -> bool {
+  switch (node->type_) {
+    case ArtNodeType::Node4:
+      return node->count_ >= 4;
+    case ArtNodeType::Node16:
+      return node->count_ >= 16;
+    case ArtNodeType::Node48:
+      return node->count_ >= 48;
+    case ArtNodeType::Node256:
+      return false;
+  }
+  return false;
+}
+
+/**
+ * @return true if the node moves to the next smaller layout when it loses one child. The thresholds sit well below
+ * the smaller layout's capacity, so a node at the boundary does not flip back and forth.
+ */
+auto IsUnderfull(const ArtNode *node) -> bool {
+  switch (node->type_) {
+    case ArtNodeType::Node4:
+      return false;
+    case ArtNodeType::Node16:
+      return node->count_ <= 4;
+    case ArtNodeType::Node48:
+      return node->count_ <= 13;
+    case ArtNodeType::Node256:
+      return node->count_ <= 38;
+  }
+  return false;
+}
+
+/** position of byte in a sorted key array, or count if absent */
+template <size_t Capacity>
+auto SearchSorted(const std::array<uint8_t, Capacity> &keys, size_t count, uint8_t byte) -> size_t {
+#if defined(__SSE2__)
+  if constexpr (Capacity == 16) {
+    __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys.data()));
+    auto match = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(static_cast<char>(byte)))));
+    match &= (1U << count) - 1;
+    return match != 0 ? static_cast<size_t>(__builtin_ctz(match)) : count;
+  }
+#endif
+  for (size_t i = 0; i < count; i++) {
+    if (keys[i] == byte) {
+      return i;
+    }
+  }
+  return count;
+}
+
+template <typename Node, size_t Capacity>
+auto FindInSorted(const Node *node, uint8_t byte) -> ArtNode * {
+  size_t count = Count<Capacity>(node);
+  size_t pos = SearchSorted<Capacity>(node->keys_, count, byte);
+  return pos < count ? node->children_[pos].load() : nullptr;
+}
+
+auto FindChild(const ArtNode *node, uint8_t byte) -> ArtNode * {
+  switch (node->type_) {
+    case ArtNodeType::Node4:
+      return FindInSorted<ArtNode4, 4>(static_cast<const ArtNode4 *>(node), byte);
+    case ArtNodeType::Node16:
+      return FindInSorted<ArtNode16, 16>(static_cast<const ArtNode16 *>(node), byte);
+    case ArtNodeType::Node48: {
+      const auto *n = static_cast<const ArtNode48 *>(node);
+      uint8_t slot = n->child_index_[byte];
+      return slot < ArtNode48::EMPTY ? n->children_[slot].load() : nullptr;
+    }
+    case ArtNodeType::Node256:
+      return static_cast<const ArtNode256 *>(node)->children_[byte].load();
+  }
+  return nullptr;
+}
+
+template <typename Node>
+void AddToSorted(Node *node, uint8_t byte, ArtNode *child) {
+  size_t pos = 0;
+  while (pos < node->count_ && node->keys_[pos] < byte) {
+    pos++;
+  }
+  for (size_t i = node->count_; i > pos; i--) {
+    node->keys_[i] = node->keys_[i - 1];
+    node->children_[i].store(node->children_[i - 1].load());
+  }
+  node->keys_[pos] = byte;
+  node->children_[pos].store(child);
+  node->count_++;
+}
+
+/** the node has room and no child under byte */
+void AddChild(ArtNode *node, uint8_t byte, ArtNode *child) {
+  switch (node->type_) {
+    case ArtNodeType::Node4:
+      AddToSorted(static_cast<ArtNode4 *>(node), byte, child);
+      return;
+    case ArtNodeType::Node16:
+      AddToSorted(static_cast<ArtNode16 *>(node), byte, child);
+      return;
+    case ArtNodeType::Node48: {
+      auto *n = static_cast<ArtNode48 *>(node);
+      uint8_t slot = 0;
+      while (n->children_[slot].load() != nullptr) {
+        slot++;
+      }
+      n->children_[slot].store(child);
+      n->child_index_[byte] = slot;
+      n->count_++;
+      return;
+    }
+    case ArtNodeType::Node256: {
+      auto *n = static_cast<ArtNode256 *>(node);
+      n->children_[byte].store(child);
+      n->count_++;
+      return;
+    }
+  }
+}
+
+void ChangeChild(ArtNode *node, uint8_t byte, ArtNode *child) {
+  switch (node->type_) {
+    case ArtNodeType::Node4: {
+      auto *n = static_cast<ArtNode4 *>(node);
+      n->children_[SearchSorted<4>(n->keys_, n->count_, byte)].store(child);
+      return;
+    }
+    case ArtNodeType::Node16: {
+      auto *n = static_cast<ArtNode16 *>(node);
+      n->children_[SearchSorted<16>(n->keys_, n->count_, byte)].store(child);
+      return;
+    }
+    case ArtNodeType::Node48: {
+      auto *n = static_cast<ArtNode48 *>(node);
+      n->children_[n->child_index_[byte]].store(child);
+      return;
+    }
+    case ArtNodeType::Node256:
+      static_cast<ArtNode256 *>(node)->children_[byte].store(child);
+      return;
+  }
+}
+
+template <typename Node, size_t Capacity>
+void RemoveFromSorted(Node *node, uint8_t byte) {
+  size_t pos = SearchSorted<Capacity>(node->keys_, node->count_, byte);
+  for (size_t i = pos; i + 1 < node->count_; i++) {
+    node->keys_[i] = node->keys_[i + 1];
+    node->children_[i].store(node->children_[i + 1].load());
+  }
+  node->children_[node->count_ - 1].store(nullptr);
+  node->count_--;
+}
+
+/** the node has a child under byte */
+void RemoveChild(ArtNode *node, uint8_t byte) {
+  switch (node->type_) {
+    case ArtNodeType::Node4:
+      RemoveFromSorted<ArtNode4, 4>(static_cast<ArtNode4 *>(node), byte);
+      return;
+    case ArtNodeType::Node16:
+      RemoveFromSorted<ArtNode16, 16>(static_cast<ArtNode16 *>(node), byte);
+      return;
+    case ArtNodeType::Node48: {
+      auto *n = static_cast<ArtNode48 *>(node);
+      n->children_[n->child_index_[byte]].store(nullptr);
+      n->child_index_[byte] = ArtNode48::EMPTY;
+      n->count_--;
+      return;
+    }
+    case ArtNodeType::Node256: {
+      auto *n = static_cast<ArtNode256 *>(node);
+      n->children_[byte].store(nullptr);
+      n->count_--;
+      return;
+    }
+  }
+}
+
+/** call f(byte, child) for the children under key bytes from..to, in byte order, until f returns false */
+template <typename F>
+void ForEachChild(const ArtNode *node, uint8_t from, uint8_t to, F &&f) {
+  auto sorted = [&](const auto *n, size_t count) {
+    for (size_t i = 0; i < count && n->keys_[i] <= to; i++) {
+      ArtNode *child = n->children_[i].load();
+      if (n->keys_[i] >= from && child != nullptr && !f(n->keys_[i], child)) {
+        return;
+      }
+    }
+  };
+  switch (node->type_) {
+    case ArtNodeType::Node4:
+      sorted(static_cast<const ArtNode4 *>(node), Count<4>(node));
+      return;
+    case ArtNodeType::Node16:
+      sorted(static_cast<const ArtNode16 *>(node), Count<16>(node));
+      return;
+    case ArtNodeType::Node48: {
+      const auto *n = static_cast<const ArtNode48 *>(node);
+      for (size_t byte = from; byte <= to; byte++) {
+        uint8_t slot = n->child_index_[byte];
+        ArtNode *child = slot < ArtNode48::EMPTY ? n->children_[slot].load() : nullptr;
+        if (child != nullptr && !f(static_cast<uint8_t>(byte), child)) {
+          return;
+        }
+      }
+      return;
+    }
+    case ArtNodeType::Node256: {
+      const auto *n = static_cast<const ArtNode256 *>(node);
+      for (size_t byte = from; byte <= to; byte++) {
+        ArtNode *child = n->children_[byte].load();
+        if (child != nullptr && !f(static_cast<uint8_t>(byte), child)) {
+          return;
+        }
+      }
+      return;
+    }
+  }
+}
+
+/** copy of node in another layout (and with another prefix), without the child under skip if skip >= 0 */
+auto CopyNode(const ArtNode *node, ArtNodeType type, std::string_view prefix, int skip = -1) -> ArtNode * {
+  ArtNode *copy = NewNode(type, prefix);
+  ForEachChild(node, 0, 0xFF, [&](uint8_t byte, ArtNode *child) {
+    if (byte != skip) {
+      AddChild(copy, byte, child);
+    }
+    return true;
+  });
+  return copy;
+}
+
+/** number of leading bytes of the first len prefix bytes that match key from depth on */
+auto MatchPrefix(const ArtNode *node, uint32_t len, std::string_view key, size_t depth) -> uint32_t {
+  const char *prefix = node->prefix_.get();
+  uint32_t i = 0;
+  while (i < len && depth + i < key.size() && prefix[i] == key[depth + i]) {
+    i++;
+  }
+  return i;
+}
+
+}  // namespace
+
+template <typename ValueType>
+AdaptiveRadixTree<ValueType>::AdaptiveRadixTree() : root_(new ArtNode256(std::string_view{})) {}
+
+template <typename ValueType>
+AdaptiveRadixTree<ValueType>::~AdaptiveRadixTree() {
+  FreeSubtree(root_);
+  // 退休的节点只释放自己, 它们的孩子已经挂到了替代它们的节点下
+  for (ArtNode *node : retired_) {
+    if (IsLeaf(node)) {
+      ArtLeaf<ValueType>::Free(AsLeaf<ValueType>(node));
+    } else {
+      delete node;
+    }
+  }
+}
+
+template <typename ValueType>
+void AdaptiveRadixTree<ValueType>::FreeSubtree(ArtNode *node) {
+  if (IsLeaf(node)) {
+    ArtLeaf<ValueType>::Free(AsLeaf<ValueType>(node));
+    return;
+  }
+  ForEachChild(node, 0, 0xFF, [this](uint8_t /* byte */, ArtNode *child) {
+    FreeSubtree(child);
+    return true;
+  });
+  delete node;
+}
+
+template <typename ValueType>
+void AdaptiveRadixTree<ValueType>::Retire(ArtNode *node) {
+  std::scoped_lock<std::mutex> lock(retired_latch_);
+  retired_.push_back(node);
+}
+
+template <typename ValueType>
+auto AdaptiveRadixTree<ValueType>::Successor(std::string_view prefix) -> std::optional<std::string> {
+  std::string next(prefix);
+  while (!next.empty() && static_cast<uint8_t>(next.back()) == 0xFF) {
+    next.pop_back();
+  }
+  if (next.empty()) {
+    return std::nullopt;
+  }
+  next.back() = static_cast<char>(static_cast<uint8_t>(next.back()) + 1);
+  return next;
+}
+
+template <typename ValueType>
+auto AdaptiveRadixTree<ValueType>::Insert(std::string_view key, const ValueType &value) -> bool {
+  while (true) {
+    if (auto inserted = TryInsert(key, value); inserted.has_value()) {
+      if (*inserted) {
+        size_++;
+      }
+      return *inserted;
+    }
+  }
+}
+
+template <typename ValueType>
+auto AdaptiveRadixTree<ValueType>::TryInsert(std::string_view key, const ValueType &value) -> std::optional<bool> {
+  bool restart = false;
+  ArtNode *parent = nullptr;
+  uint64_t parent_version = 0;
+  uint8_t parent_byte = 0;
+  ArtNode *node = root_;
+  uint64_t version = node->ReadLockOrRestart(&restart);
+  if (restart) {
+    return std::nullopt;
+  }
+  size_t depth = 0;
+  while (true) {
+    uint32_t len = node->prefix_len_;
+    uint32_t matched = MatchPrefix(node, len, key, depth);
+    if (matched < len) {
+      if (depth + matched == key.size()) {
+        // key 是这棵子树里所有 key 的前缀
+        node->CheckOrRestart(version, &restart);
+        return restart ? std::nullopt : std::make_optional(false);
+      }
+      // 前缀在 matched 处分叉: 新的 Node4 接管前 matched 个字节, 原节点留下分叉字节之后的部分
+      parent->UpgradeToWriteLockOrRestart(&parent_version, &restart);
+      if (restart) {
+        return std::nullopt;
+      }
+      node->UpgradeToWriteLockOrRestart(&version, &restart);
+      if (restart) {
+        parent->WriteUnlock();
+        return std::nullopt;
+      }
+      ArtNode *split = NewNode(ArtNodeType::Node4, node->Prefix().substr(0, matched));
+      AddChild(split, static_cast<uint8_t>(node->prefix_[matched]), node);
+      AddChild(split, Byte(key, depth + matched), TagLeaf(ArtLeaf<ValueType>::Make(key, value)));
+      node->ChopPrefix(matched + 1);
+      ChangeChild(parent, parent_byte, split);
+      node->WriteUnlock();
+      parent->WriteUnlock();
+      return true;
+    }
+    depth += len;
+    if (depth == key.size()) {
+      node->CheckOrRestart(version, &restart);
+      return restart ? std::nullopt : std::make_optional(false);
+    }
+
+    uint8_t byte = Byte(key, depth);
+    ArtNode *child = FindChild(node, byte);
+    node->CheckOrRestart(version, &restart);
+    if (restart) {
+      return std::nullopt;
+    }
+
+    if (child == nullptr) {
+      if (IsFull(node)) {
+        // 换成大一号的节点; 根是 Node256, 不会满, 所以这里一定有 parent
+        parent->UpgradeToWriteLockOrRestart(&parent_version, &restart);
+        if (restart) {
+          return std::nullopt;
+        }
+        node->UpgradeToWriteLockOrRestart(&version, &restart);
+        if (restart) {
+          parent->WriteUnlock();
+          return std::nullopt;
+        }
+        ArtNode *bigger = CopyNode(node, Grown(node->type_), node->Prefix());
+        AddChild(bigger, byte, TagLeaf(ArtLeaf<ValueType>::Make(key, value)));
+        ChangeChild(parent, parent_byte, bigger);
+        node->WriteUnlockObsolete();
+        parent->WriteUnlock();
+        Retire(node);
+        return true;
+      }
+      node->UpgradeToWriteLockOrRestart(&version, &restart);
+      if (restart) {
+        return std::nullopt;
+      }
+      AddChild(node, byte, TagLeaf(ArtLeaf<ValueType>::Make(key, value)));
+      node->WriteUnlock();
+      return true;
+    }
+
+    if (IsLeaf(child)) {
+      std::string_view leaf_key = AsLeaf<ValueType>(child)->Key();
+      // lazy expansion: 两个 key 的公共部分做新 Node4 的前缀, 两个叶子挂在第一个不同的字节下
+      size_t start = depth + 1;
+      size_t common = 0;
+      while (start + common < key.size() && start + common < leaf_key.size() &&
+             key[start + common] == leaf_key[start + common]) {
+        common++;
+      }
+      if (start + common == key.size() || start + common == leaf_key.size()) {
+        // 相同的 key, 或者一个是另一个的前缀
+        return false;
+      }
+      node->UpgradeToWriteLockOrRestart(&version, &restart);
+      if (restart) {
+        return std::nullopt;
+      }
+      ArtNode *expanded = NewNode(ArtNodeType::Node4, key.substr(start, common));
+      AddChild(expanded, Byte(leaf_key, start + common), child);
+      AddChild(expanded, Byte(key, start + common), TagLeaf(ArtLeaf<ValueType>::Make(key, value)));
+      ChangeChild(node, byte, expanded);
+      node->WriteUnlock();
+      return true;
+    }
+
+    uint64_t child_version = child->ReadLockOrRestart(&restart);
+    node->CheckOrRestart(version, &restart);
+    if (restart) {
+      return std::nullopt;
+    }
+    parent = node;
+    parent_version = version;
+    parent_byte = byte;
+    node = child;
+    version = child_version;
+    depth++;
+  }
+}
+
+template <typename ValueType>
+auto AdaptiveRadixTree<ValueType>::Remove(std::string_view key) -> bool {
+  while (true) {
+    if (auto removed = TryRemove(key); removed.has_value()) {
+      if (*removed) {
+        size_--;
+      }
+      return *removed;
+    }
+  }
+}
+
+template <typename ValueType>
+auto AdaptiveRadixTree<ValueType>::TryRemove(std::string_view key) -> std::optional<bool> {
+  bool restart = false;
+  ArtNode *parent = nullptr;
+  uint64_t parent_version = 0;
+  uint8_t parent_byte = 0;
+  ArtNode *node = root_;
+  uint64_t version = node->ReadLockOrRestart(&restart);
+  if (restart) {
+    return std::nullopt;
+  }
+  size_t depth = 0;
+  while (true) {
+    uint32_t len = node->prefix_len_;
+    if (MatchPrefix(node, len, key, depth) < len || depth + len >= key.size()) {
+      node->CheckOrRestart(version, &restart);
+      return restart ? std::nullopt : std::make_optional(false);
+    }
+    depth += len;
+    uint8_t byte = Byte(key, depth);
+    ArtNode *child = FindChild(node, byte);
+    node->CheckOrRestart(version, &restart);
+    if (restart) {
+      return std::nullopt;
+    }
+    if (child == nullptr) {
+      return false;
+    }
+
+    if (IsLeaf(child)) {
+      if (AsLeaf<ValueType>(child)->Key() != key) {
+        return false;
+      }
+      if (node != root_ && (node->count_ <= 2 || IsUnderfull(node))) {
+        // Node4 只剩一个孩子就和它合并, 其它节点太空了就换小一号
+        parent->UpgradeToWriteLockOrRestart(&parent_version, &restart);
+        if (restart) {
+          return std::nullopt;
+        }
+        node->UpgradeToWriteLockOrRestart(&version, &restart);
+        if (restart) {
+          parent->WriteUnlock();
+          return std::nullopt;
+        }
+        if (node->count_ <= 2) {
+          // Node4 只剩一个孩子: 把它直接挂到 parent 下, 路径 = node 的前缀 + 分支字节 + 它自己的前缀
+          uint8_t other_byte = 0;
+          ArtNode *other = nullptr;
+          ForEachChild(node, 0, 0xFF, [&](uint8_t b, ArtNode *c) {
+            if (b != byte) {
+              other_byte = b;
+              other = c;
+            }
+            return true;
+          });
+          if (!IsLeaf(other)) {
+            uint64_t other_version = other->ReadLockOrRestart(&restart);
+            if (!restart) {
+              other->UpgradeToWriteLockOrRestart(&other_version, &restart);
+            }
+            if (restart) {
+              node->WriteUnlock();
+              parent->WriteUnlock();
+              return std::nullopt;
+            }
+            // 前缀只能原地缩短, 变长了就换一个新节点
+            std::string prefix(node->Prefix());
+            prefix.push_back(static_cast<char>(other_byte));
+            prefix.append(other->Prefix());
+            ArtNode *merged = CopyNode(other, other->type_, prefix);
+            other->WriteUnlockObsolete();
+            Retire(other);
+            other = merged;
+          }
+          ChangeChild(parent, parent_byte, other);
+        } else {
+          ChangeChild(parent, parent_byte, CopyNode(node, Shrunk(node->type_), node->Prefix(), byte));
+        }
+        node->WriteUnlockObsolete();
+        parent->WriteUnlock();
+        Retire(node);
+        Retire(child);
+        return true;
+      }
+      node->UpgradeToWriteLockOrRestart(&version, &restart);
+      if (restart) {
+        return std::nullopt;
+      }
+      RemoveChild(node, byte);
+      node->WriteUnlock();
+      Retire(child);
+      return true;
+    }
+
+    uint64_t child_version = child->ReadLockOrRestart(&restart);
+    node->CheckOrRestart(version, &restart);
+    if (restart) {
+      return std::nullopt;
+    }
+    parent = node;
+    parent_version = version;
+    parent_byte = byte;
+    node = child;
+    version = child_version;
+    depth++;
+  }
+}
+
+template <typename ValueType>
+auto AdaptiveRadixTree<ValueType>::Find(std::string_view key, ValueType *value) const -> bool {
+  while (true) {
+    if (auto found = TryFind(key, value); found.has_value()) {
+      return *found;
+    }
+  }
+}
+
+template <typename ValueType>
+auto AdaptiveRadixTree<ValueType>::TryFind(std::string_view key, ValueType *value) const -> std::optional<bool> {
+  bool restart = false;
+  const ArtNode *node = root_;
+  uint64_t version = node->ReadLockOrRestart(&restart);
+  if (restart) {
+    return std::nullopt;
+  }
+  size_t depth = 0;
+  while (true) {
+    uint32_t len = node->prefix_len_;
+    if (MatchPrefix(node, len, key, depth) < len || depth + len >= key.size()) {
+      node->CheckOrRestart(version, &restart);
+      return restart ? std::nullopt : std::make_optional(false);
+    }
+    depth += len;
+    ArtNode *child = FindChild(node, Byte(key, depth));
+    node->CheckOrRestart(version, &restart);
+    if (restart) {
+      return std::nullopt;
+    }
+    if (child == nullptr) {
+      return false;
+    }
+    if (IsLeaf(child)) {
+      const auto *leaf = AsLeaf<ValueType>(child);
+      if (leaf->Key() != key) {
+        return false;
+      }
+      *value = leaf->value_;
+      return true;
+    }
+    uint64_t child_version = child->ReadLockOrRestart(&restart);
+    node->CheckOrRestart(version, &restart);
+    if (restart) {
+      return std::nullopt;
+    }
+    node = child;
+    version = child_version;
+    depth++;
+  }
+}
+
+template <typename ValueType>
+void AdaptiveRadixTree<ValueType>::ScanRange(std::string_view low, std::optional<std::string_view> high,
+                                             std::vector<std::pair<std::string, ValueType>> *result) const {
+  size_t start = result->size();
+  while (!ScanNode(root_, 0, low, !low.empty(), high, high.has_value(), result)) {
+    result->erase(result->begin() + start, result->end());
+  }
+}
+
+template <typename ValueType>
+auto AdaptiveRadixTree<ValueType>::ScanNode(const ArtNode *node, size_t depth, std::string_view low, bool check_low,
+                                            std::optional<std::string_view> high, bool check_high,
+                                            std::vector<std::pair<std::string, ValueType>> *result) const -> bool {
+  bool restart = false;
+  uint64_t version = node->ReadLockOrRestart(&restart);
+  if (restart) {
+    return false;
+  }
+
+  // 前缀逐字节和两个边界比较: 一旦不相等, 整棵子树都在这个边界的同一侧
+  uint32_t len = node->prefix_len_;
+  const char *prefix = node->prefix_.get();
+  bool outside = false;
+  for (uint32_t i = 0; i <= len && (check_low || check_high) && !outside; i++) {
+    size_t pos = depth + i;
+    bool at_branch = i == len;  // 前缀之后是分支字节, 只看边界是否已经用完
+    if (check_low && pos >= low.size()) {
+      check_low = false;  // low 是这里所有 key 的前缀
+    } else if (check_low && !at_branch && prefix[i] != low[pos]) {
+      outside = static_cast<uint8_t>(prefix[i]) < Byte(low, pos);
+      check_low = false;
+    }
+    if (outside) {
+      break;
+    }
+    if (check_high && pos >= high->size()) {
+      outside = true;  // high 是这里所有 key 的真前缀, 它们都比 high 大
+    } else if (check_high && !at_branch && prefix[i] != (*high)[pos]) {
+      outside = static_cast<uint8_t>(prefix[i]) > Byte(*high, pos);
+      check_high = false;
+    }
+  }
+  depth += len;
+
+  if (outside) {
+    node->CheckOrRestart(version, &restart);
+    return !restart;
+  }
+
+  // 只走边界字节之间的孩子; 每读到一个孩子先确认节点没变过, 再去用它
+  bool ok = true;
+  ForEachChild(node, check_low ? Byte(low, depth) : 0, check_high ? Byte(*high, depth) : 0xFF,
+               [&](uint8_t byte, ArtNode *child) {
+                 node->CheckOrRestart(version, &restart);
+                 if (restart) {
+                   ok = false;
+                   return false;
+                 }
+                 bool child_low = check_low && byte == Byte(low, depth);
+                 bool child_high = check_high && byte == Byte(*high, depth);
+                 if (IsLeaf(child)) {
+                   const auto *leaf = AsLeaf<ValueType>(child);
+                   if ((!child_low || leaf->Key() >= low) && (!child_high || leaf->Key() < *high)) {
+                     result->emplace_back(leaf->Key(), leaf->value_);
+                   }
+                   return true;
+                 }
+                 ok = ScanNode(child, depth + 1, low, child_low, high, child_high, result);
+                 return ok;
+               });
+  if (!ok) {
+    return false;
+  }
+  node->CheckOrRestart(version, &restart);
+  return !restart;
+}
+
+template class AdaptiveRadixTree<RID>;
+// test purpose
+template class AdaptiveRadixTree<int>;
+
+}  // namespace bustub
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <utility>
@@ -26,7 +27,19 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::DiskExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                          const KeyComparator &comparator, HashFunction<KeyType> hash_fn)
     : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
-  //  implement me!
+  // global depth 0: 目录只有一个槽, 指向唯一的 bucket
+  Page *dir_frame = buffer_pool_manager_->NewPage(&directory_page_id_);
+  page_id_t bucket_page_id;
+  Page *bucket_frame = buffer_pool_manager_->NewPage(&bucket_page_id);
+  if (dir_frame == nullptr || bucket_frame == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame for the hash table directory");
+  }
+  auto *dir_page = AsDirectory(dir_frame);
+  dir_page->SetPageId(directory_page_id_);
+  dir_page->SetBucketPageId(0, bucket_page_id);
+  dir_page->SetLocalDepth(0, 0);
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
 }
 
 /*****************************************************************************
@@ -46,22 +59,57 @@ auto HASH_TABLE_TYPE::Hash(KeyType key) -> uint32_t {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 inline auto HASH_TABLE_TYPE::KeyToDirectoryIndex(KeyType key, HashTableDirectoryPage *dir_page) -> uint32_t {
-  return 0;
+  return Hash(key) & dir_page->GetGlobalDepthMask();
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 inline auto HASH_TABLE_TYPE::KeyToPageId(KeyType key, HashTableDirectoryPage *dir_page) -> page_id_t {
-  return 0;
+  return dir_page->GetBucketPageId(KeyToDirectoryIndex(key, dir_page));
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_TYPE::FetchDirectoryPage() -> HashTableDirectoryPage * {
-  return nullptr;
+auto HASH_TABLE_TYPE::FetchPage(page_id_t page_id) -> Page * {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame for a hash table page");
+  }
+  return page;
 }
 
+/*
+  1 读锁目录, 查出 bucket 和目录版本, 放掉目录
+  2 锁 bucket; 期间可能有 split/merge 改了目录
+  3 再读锁目录: 版本没变, 或者 key 仍然映射到这个 bucket, 就可以用; 否则放掉 bucket 重来
+  等 bucket 的时候不持有目录锁, 所以加锁顺序总是 bucket -> 目录
+*/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BUCKET_TYPE * {
-  return nullptr;
+auto HASH_TABLE_TYPE::LatchBucket(const KeyType &key, bool exclusive) -> Page * {
+  Page *dir_frame = FetchPage(directory_page_id_);
+  auto *dir_page = AsDirectory(dir_frame);
+  for (;;) {
+    dir_frame->RLatch();
+    page_id_t bucket_page_id = KeyToPageId(key, dir_page);
+    uint32_t version = dir_page->GetVersion();
+    dir_frame->RUnlatch();
+
+    Page *bucket_page = FetchPage(bucket_page_id);
+    exclusive ? bucket_page->WLatch() : bucket_page->RLatch();
+
+    dir_frame->RLatch();
+    bool valid = dir_page->GetVersion() == version || KeyToPageId(key, dir_page) == bucket_page_id;
+    dir_frame->RUnlatch();
+    if (valid) {
+      buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+      return bucket_page;
+    }
+    ReleaseBucket(bucket_page, exclusive, false);
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::ReleaseBucket(Page *bucket_page, bool exclusive, bool is_dirty) {
+  exclusive ? bucket_page->WUnlatch() : bucket_page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page->GetPageId(), is_dirty);
 }
 
 /*****************************************************************************
@@ -69,7 +117,10 @@ auto HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BU
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool {
-  return false;
+  Page *bucket_page = LatchBucket(key, false);
+  bool found = AsBucket(bucket_page)->GetValue(key, comparator_, result);
+  ReleaseBucket(bucket_page, false, false);
+  return found;
 }
 
 /*****************************************************************************
@@ -77,12 +128,91 @@ auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  Page *bucket_page = LatchBucket(key, true);
+  auto *bucket = AsBucket(bucket_page);
+  if (bucket->IsFull()) {
+    ReleaseBucket(bucket_page, true, false);
+    return SplitInsert(transaction, key, value);
+  }
+  bool inserted = bucket->Insert(key, value, comparator_);
+  ReleaseBucket(bucket_page, true, inserted);
+  return inserted;
 }
 
+/*
+  bucket 满了: 拆开再试, 直到放得下; 一次 split 可能所有元素都落在同一边, 所以是循环
+*/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  for (;;) {
+    Page *bucket_page = LatchBucket(key, true);
+    auto *bucket = AsBucket(bucket_page);
+    if (!bucket->IsFull()) {
+      bool inserted = bucket->Insert(key, value, comparator_);
+      ReleaseBucket(bucket_page, true, inserted);
+      return inserted;
+    }
+    std::vector<ValueType> values;
+    bucket->GetValue(key, comparator_, &values);
+    bool split = std::find(values.begin(), values.end(), value) == values.end() && SplitBucket(bucket_page, key);
+    ReleaseBucket(bucket_page, true, split);
+    if (!split) {
+      return false;
+    }
+  }
+}
+
+/*
+  1 local depth 在 bucket 锁下是稳定的 (只有持有这个 bucket 写锁的人会改它), 读锁目录取出来
+  2 新建 split image, 把第 local depth 位为 1 的元素搬过去; 新页还没挂到目录上, 别人看不到, 不用加锁
+  3 写锁目录, 只改指向这个 bucket 的那些槽 (必要时先把目录翻倍), 然后升版本
+*/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::SplitBucket(Page *bucket_page, const KeyType &key) -> bool {
+  Page *dir_frame = FetchPage(directory_page_id_);
+  auto *dir_page = AsDirectory(dir_frame);
+  dir_frame->RLatch();
+  uint32_t local_depth = dir_page->GetLocalDepth(KeyToDirectoryIndex(key, dir_page));
+  dir_frame->RUnlatch();
+  if ((2U << local_depth) > DIRECTORY_ARRAY_SIZE) {
+    buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+    return false;
+  }
+
+  page_id_t image_page_id;
+  Page *image_frame = buffer_pool_manager_->NewPage(&image_page_id);
+  if (image_frame == nullptr) {
+    buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame to split a hash table bucket");
+  }
+  auto *bucket = AsBucket(bucket_page);
+  auto *image = AsBucket(image_frame);
+  uint32_t high_bit = 1U << local_depth;
+  for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE; i++) {
+    if (bucket->IsReadable(i) && (Hash(bucket->KeyAt(i)) & high_bit) != 0) {
+      image->Insert(bucket->KeyAt(i), bucket->ValueAt(i), comparator_);
+      bucket->RemoveAt(i);
+    }
+  }
+
+  dir_frame->WLatch();
+  if (local_depth == dir_page->GetGlobalDepth()) {
+    dir_page->IncrGlobalDepth();
+  }
+  for (uint32_t i = 0; i < dir_page->Size(); i++) {
+    if (dir_page->GetBucketPageId(i) == bucket_page->GetPageId()) {
+      dir_page->IncrLocalDepth(i);
+      if ((i & high_bit) != 0) {
+        dir_page->SetBucketPageId(i, image_page_id);
+      }
+    }
+  }
+  dir_page->IncrVersion();
+  dir_frame->WUnlatch();
+
+  buffer_pool_manager_->UnpinPage(image_page_id, true);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+  return true;
 }
 
 /*****************************************************************************
@@ -90,25 +220,97 @@ auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  Page *bucket_page = LatchBucket(key, true);
+  auto *bucket = AsBucket(bucket_page);
+  bool removed = bucket->Remove(key, value, comparator_);
+  bool empty = removed && bucket->IsEmpty();
+  ReleaseBucket(bucket_page, true, removed);
+  if (empty) {
+    Merge(transaction, key, value);
+  }
+  return removed;
 }
 
 /*****************************************************************************
  * MERGE
  *****************************************************************************/
+/*
+  1 读锁目录, 找到 key 所在的 bucket 和它的 split image
+  2 两个 bucket 按 page id 顺序加写锁, 再写锁目录, 重新确认: 还互为 split image, local depth 相同, 其中一个是空的
+  3 指向两者的槽都改指非空的那个, local depth 减一, 能缩就缩目录, 升版本
+  4 空 bucket 删掉; 还有人 pin 着 (在等它的锁) 就留着, 那个人会发现映射变了而重来
+  合并后的 bucket 和它新的 split image 可能又有一个是空的 (之前因为 local depth 不同没合成), 所以一直往上合
+*/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {}
+void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  Page *dir_frame = FetchPage(directory_page_id_);
+  auto *dir_page = AsDirectory(dir_frame);
+  bool dir_dirty = false;
+  for (bool merged = true; merged;) {
+    dir_frame->RLatch();
+    uint32_t bucket_idx = KeyToDirectoryIndex(key, dir_page);
+    uint32_t local_depth = dir_page->GetLocalDepth(bucket_idx);
+    page_id_t bucket_page_id = dir_page->GetBucketPageId(bucket_idx);
+    page_id_t image_page_id = dir_page->GetBucketPageId(dir_page->GetSplitImageIndex(bucket_idx));
+    dir_frame->RUnlatch();
+    if (local_depth == 0 || bucket_page_id == image_page_id) {
+      break;
+    }
+
+    Page *first = FetchPage(std::min(bucket_page_id, image_page_id));
+    Page *second = FetchPage(std::max(bucket_page_id, image_page_id));
+    first->WLatch();
+    second->WLatch();
+    Page *bucket_page = bucket_page_id < image_page_id ? first : second;
+    Page *image_page = bucket_page_id < image_page_id ? second : first;
+
+    dir_frame->WLatch();
+    bucket_idx = KeyToDirectoryIndex(key, dir_page);
+    uint32_t image_idx = dir_page->GetSplitImageIndex(bucket_idx);
+    page_id_t empty_page_id = AsBucket(bucket_page)->IsEmpty()  ? bucket_page_id
+                              : AsBucket(image_page)->IsEmpty() ? image_page_id
+                                                                : INVALID_PAGE_ID;
+    merged = empty_page_id != INVALID_PAGE_ID && dir_page->GetBucketPageId(bucket_idx) == bucket_page_id &&
+             dir_page->GetBucketPageId(image_idx) == image_page_id &&
+             dir_page->GetLocalDepth(bucket_idx) == local_depth && dir_page->GetLocalDepth(image_idx) == local_depth;
+    if (merged) {
+      page_id_t kept_page_id = empty_page_id == bucket_page_id ? image_page_id : bucket_page_id;
+      for (uint32_t i = 0; i < dir_page->Size(); i++) {
+        page_id_t page_id = dir_page->GetBucketPageId(i);
+        if (page_id == bucket_page_id || page_id == image_page_id) {
+          dir_page->SetBucketPageId(i, kept_page_id);
+          dir_page->DecrLocalDepth(i);
+        }
+      }
+      while (dir_page->CanShrink()) {
+        dir_page->DecrGlobalDepth();
+      }
+      dir_page->IncrVersion();
+      dir_dirty = true;
+    }
+    dir_frame->WUnlatch();
+
+    second->WUnlatch();
+    first->WUnlatch();
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+    buffer_pool_manager_->UnpinPage(image_page_id, false);
+    if (merged) {
+      buffer_pool_manager_->DeletePage(empty_page_id);
+    }
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, dir_dirty);
+}
 
 /*****************************************************************************
  * GETGLOBALDEPTH - DO NOT TOUCH
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetGlobalDepth() -> uint32_t {
-  table_latch_.RLock();
-  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
-  uint32_t global_depth = dir_page->GetGlobalDepth();
-  assert(buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr));
-  table_latch_.RUnlock();
+  Page *dir_frame = FetchPage(directory_page_id_);
+  dir_frame->RLatch();
+  uint32_t global_depth = AsDirectory(dir_frame)->GetGlobalDepth();
+  dir_frame->RUnlatch();
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr);
   return global_depth;
 }
 
@@ -117,11 +319,11 @@ auto HASH_TABLE_TYPE::GetGlobalDepth() -> uint32_t {
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_TYPE::VerifyIntegrity() {
-  table_latch_.RLock();
-  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
-  dir_page->VerifyIntegrity();
-  assert(buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr));
-  table_latch_.RUnlock();
+  Page *dir_frame = FetchPage(directory_page_id_);
+  dir_frame->RLatch();
+  AsDirectory(dir_frame)->VerifyIntegrity();
+  dir_frame->RUnlatch();
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr);
 }
 
 /*****************************************************************************
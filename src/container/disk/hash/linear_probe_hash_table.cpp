@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <utility>
@@ -17,6 +18,7 @@
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/macros.h"
 #include "common/rid.h"
 #include "container/disk/hash/linear_probe_hash_table.h"
 
@@ -26,21 +28,190 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                       const KeyComparator &comparator, size_t num_buckets,
                                       HashFunction<KeyType> hash_fn)
-    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {}
+    : buffer_pool_manager_(buffer_pool_manager),
+      comparator_(comparator),
+      size_(std::max<size_t>(num_buckets, 1)),
+      hash_fn_(std::move(hash_fn)) {
+  Page *header_frame = buffer_pool_manager_->NewPage(&header_page_id_);
+  if (header_frame == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame for the hash table header");
+  }
+  auto *header_page = AsHeader(header_frame);
+  header_page->SetPageId(header_page_id_);
+  header_page->SetSize(size_);
+  CreateNewBlockPages(header_page, (size_ - 1) / BLOCK_ARRAY_SIZE + 1);
+  buffer_pool_manager_->UnpinPage(header_page_id_, true);
+}
+
+/*****************************************************************************
+ * HELPERS
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::FetchPage(page_id_t page_id) -> Page * {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame for a hash table page");
+  }
+  return page;
+}
+
+/*
+  从 key 的 home slot 往后一个一个看, 只在跨 block 的时候换页; 碰到从没用过的槽说明后面不会再有这个 key
+*/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::Probe(page_id_t header_page_id, const KeyType &key, bool dirty,
+                            const std::function<bool(HASH_TABLE_BLOCK_TYPE *, slot_offset_t)> &visit) -> size_t {
+  Page *header_frame = FetchPage(header_page_id);
+  auto *header_page = AsHeader(header_frame);
+  size_t size = header_page->GetSize();
+  size_t home = static_cast<size_t>(hash_fn_.GetHash(key)) % size;
+  size_t free_slot = size;
+  Page *block_frame = nullptr;
+  for (size_t i = 0; i < size; i++) {
+    size_t slot = (home + i) % size;
+    slot_offset_t offset = slot % BLOCK_ARRAY_SIZE;
+    if (block_frame == nullptr || offset == 0) {
+      if (block_frame != nullptr) {
+        buffer_pool_manager_->UnpinPage(block_frame->GetPageId(), dirty);
+      }
+      block_frame = FetchPage(header_page->GetBlockPageId(slot / BLOCK_ARRAY_SIZE));
+    }
+    auto *block = AsBlock(block_frame);
+    if (!block->IsReadable(offset)) {
+      free_slot = free_slot == size ? slot : free_slot;
+      if (!visit || !block->IsOccupied(offset)) {
+        break;
+      }
+      continue;
+    }
+    if (visit && comparator_(block->KeyAt(offset), key) == 0 && visit(block, offset)) {
+      break;
+    }
+  }
+  buffer_pool_manager_->UnpinPage(block_frame->GetPageId(), dirty);
+  buffer_pool_manager_->UnpinPage(header_page_id, false);
+  return free_slot;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::InsertAt(size_t slot, const KeyType &key, const ValueType &value) {
+  Page *header_frame = FetchPage(header_page_id_);
+  page_id_t block_page_id = AsHeader(header_frame)->GetBlockPageId(slot / BLOCK_ARRAY_SIZE);
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  Page *block_frame = FetchPage(block_page_id);
+  auto *block = AsBlock(block_frame);
+  num_occupied_ += block->IsOccupied(slot % BLOCK_ARRAY_SIZE) ? 0 : 1;
+  block->Insert(slot % BLOCK_ARRAY_SIZE, key, value);
+  buffer_pool_manager_->UnpinPage(block_page_id, true);
+}
+
+/*
+  搬迁专用: 新数组里不会有重复, 直接放进 home slot 之后的第一个空位; header 由调用方一直 pin 着, 每个元素只取一次 block
+*/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::ResizeInsert(HashTableHeaderPage *header_page, const KeyType &key, const ValueType &value) {
+  size_t size = header_page->GetSize();
+  size_t slot = static_cast<size_t>(hash_fn_.GetHash(key)) % size;
+  for (size_t probed = 0; probed < size;) {
+    page_id_t block_page_id = header_page->GetBlockPageId(slot / BLOCK_ARRAY_SIZE);
+    auto *block = AsBlock(FetchPage(block_page_id));
+    size_t block_end = std::min(size, (slot / BLOCK_ARRAY_SIZE + 1) * BLOCK_ARRAY_SIZE);
+    for (; slot < block_end; slot++, probed++) {
+      bool fresh = !block->IsOccupied(slot % BLOCK_ARRAY_SIZE);
+      if (block->Insert(slot % BLOCK_ARRAY_SIZE, key, value)) {
+        num_occupied_ += fresh ? 1 : 0;
+        buffer_pool_manager_->UnpinPage(block_page_id, true);
+        return;
+      }
+    }
+    buffer_pool_manager_->UnpinPage(block_page_id, false);
+    slot %= size;
+  }
+  BUSTUB_ASSERT(false, "the new array has room for every migrated pair");
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::CreateNewBlockPages(HashTableHeaderPage *header_page, size_t num_blocks) {
+  for (size_t i = 0; i < num_blocks; i++) {
+    page_id_t block_page_id;
+    if (buffer_pool_manager_->NewPage(&block_page_id) == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame for a hash table block");
+    }
+    header_page->AddBlockPageId(block_page_id);
+    buffer_pool_manager_->UnpinPage(block_page_id, true);
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::DeleteBlockPages(HashTableHeaderPage *old_header_page) {
+  for (size_t i = 0; i < old_header_page->NumBlocks(); i++) {
+    buffer_pool_manager_->DeletePage(old_header_page->GetBlockPageId(i));
+  }
+}
 
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool {
-  return false;
+  table_latch_.RLock();
+  bool found = GetValueLatchFree(transaction, key, result);
+  table_latch_.RUnlock();
+  return found;
 }
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::GetValueLatchFree(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result)
+    -> bool {
+  size_t before = result->size();
+  auto collect = [&](HASH_TABLE_BLOCK_TYPE *block, slot_offset_t offset) {
+    result->push_back(block->ValueAt(offset));
+    return false;
+  };
+  Probe(header_page_id_, key, false, collect);
+  if (old_header_page_id_ != INVALID_PAGE_ID) {
+    Probe(old_header_page_id_, key, false, collect);
+  }
+  return result->size() > before;
+}
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
+/*
+  1 先搬 migration_batch_ 个旧槽
+  2 占用 (含墓碑) 超过 3/4 就换一个新数组: 活着的元素多就翻倍, 否则同样大小重建一次, 把墓碑清掉
+  3 两个数组里都没有同样的 (key, value), 才放进新数组
+*/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  table_latch_.WLock();
+  MigrateSlots(migration_batch_);
+  if ((num_occupied_ + 1) * 4 > size_ * 3) {
+    bool mostly_tombstones = num_entries_ * 2 < size_;
+    size_t num_slots = std::min(mostly_tombstones ? size_ : size_ * 2, MAX_NUM_SLOTS);
+    // 一个 header 页装不下更多 block 时不再长大, 直到填满为止
+    if (num_slots > size_ || mostly_tombstones) {
+      StartResize(num_slots);
+    }
+  }
+
+  bool duplicate = false;
+  auto find_duplicate = [&](HASH_TABLE_BLOCK_TYPE *block, slot_offset_t offset) {
+    duplicate = block->ValueAt(offset) == value;
+    return duplicate;
+  };
+  if (old_header_page_id_ != INVALID_PAGE_ID) {
+    Probe(old_header_page_id_, key, false, find_duplicate);
+  }
+  size_t slot = duplicate ? size_ : Probe(header_page_id_, key, false, find_duplicate);
+  bool inserted = !duplicate && slot < size_;
+  if (inserted) {
+    InsertAt(slot, key, value);
+    num_entries_++;
+  }
+  table_latch_.WUnlock();
+  return inserted;
 }
 
 /*****************************************************************************
@@ -48,21 +219,124 @@ auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  table_latch_.WLock();
+  MigrateSlots(migration_batch_);
+  bool removed = false;
+  auto remove = [&](HASH_TABLE_BLOCK_TYPE *block, slot_offset_t offset) {
+    if (block->ValueAt(offset) == value) {
+      block->Remove(offset);
+      removed = true;
+    }
+    return removed;
+  };
+  Probe(header_page_id_, key, true, remove);
+  if (!removed && old_header_page_id_ != INVALID_PAGE_ID) {
+    Probe(old_header_page_id_, key, true, remove);
+  }
+  num_entries_ -= removed ? 1 : 0;
+  table_latch_.WUnlock();
+  return removed;
 }
 
 /*****************************************************************************
  * RESIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Resize(size_t initial_size) {}
+void HASH_TABLE_TYPE::Resize(size_t initial_size) {
+  table_latch_.WLock();
+  StartResize(std::max(initial_size * 2, size_));
+  MigrateSlots(old_size_);
+  table_latch_.WUnlock();
+}
+
+/*
+  只分配新数组的 block 页, 不搬任何元素; 上一次还没搬完的先一次搬完, 任何时候最多两个数组
+*/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::StartResize(size_t num_slots) {
+  if (old_header_page_id_ != INVALID_PAGE_ID) {
+    MigrateSlots(old_size_);
+  }
+  page_id_t new_header_page_id;
+  Page *header_frame = buffer_pool_manager_->NewPage(&new_header_page_id);
+  if (header_frame == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame for the hash table header");
+  }
+  auto *header_page = AsHeader(header_frame);
+  header_page->SetPageId(new_header_page_id);
+  header_page->SetSize(num_slots);
+  CreateNewBlockPages(header_page, (num_slots - 1) / BLOCK_ARRAY_SIZE + 1);
+  buffer_pool_manager_->UnpinPage(new_header_page_id, true);
+
+  old_header_page_id_ = header_page_id_;
+  old_size_ = size_;
+  migrate_cursor_ = 0;
+  header_page_id_ = new_header_page_id;
+  size_ = num_slots;
+  num_occupied_ = 0;
+  if (migration_batch_ == 0) {
+    MigrateSlots(old_size_);
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::MigrateSlots(size_t max_slots) {
+  if (old_header_page_id_ == INVALID_PAGE_ID) {
+    return;
+  }
+  auto *old_header_page = AsHeader(FetchPage(old_header_page_id_));
+  auto *header_page = AsHeader(FetchPage(header_page_id_));
+  size_t end = migrate_cursor_ + std::min(max_slots, old_size_ - migrate_cursor_);
+  while (migrate_cursor_ < end) {
+    size_t block_end = std::min(end, (migrate_cursor_ / BLOCK_ARRAY_SIZE + 1) * BLOCK_ARRAY_SIZE);
+    page_id_t block_page_id = old_header_page->GetBlockPageId(migrate_cursor_ / BLOCK_ARRAY_SIZE);
+    auto *block = AsBlock(FetchPage(block_page_id));
+    for (; migrate_cursor_ < block_end; migrate_cursor_++) {
+      slot_offset_t offset = migrate_cursor_ % BLOCK_ARRAY_SIZE;
+      if (block->IsReadable(offset)) {
+        ResizeInsert(header_page, block->KeyAt(offset), block->ValueAt(offset));
+        block->Remove(offset);
+      }
+    }
+    buffer_pool_manager_->UnpinPage(block_page_id, true);
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+
+  if (migrate_cursor_ < old_size_) {
+    buffer_pool_manager_->UnpinPage(old_header_page_id_, false);
+    return;
+  }
+  // 搬完了, 旧数组整个删掉
+  DeleteBlockPages(old_header_page);
+  buffer_pool_manager_->UnpinPage(old_header_page_id_, false);
+  buffer_pool_manager_->DeletePage(old_header_page_id_);
+  old_header_page_id_ = INVALID_PAGE_ID;
+}
 
 /*****************************************************************************
  * GETSIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetSize() -> size_t {
-  return 0;
+  table_latch_.RLock();
+  size_t size = size_;
+  table_latch_.RUnlock();
+  return size;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::SetMigrationBatch(size_t slots) {
+  table_latch_.WLock();
+  migration_batch_ = slots;
+  table_latch_.WUnlock();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::IsMigrating() -> bool {
+  table_latch_.RLock();
+  bool migrating = old_header_page_id_ != INVALID_PAGE_ID;
+  table_latch_.RUnlock();
+  return migrating;
 }
 
 template class LinearProbeHashTable<int, int, IntComparator>;
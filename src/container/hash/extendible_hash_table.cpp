@@ -10,13 +10,18 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <functional>
 #include <list>
+#include <memory>
 #include <utility>
 #include <iostream>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include "container/hash/extendible_hash_table.h"
 #include "storage/page/page.h"
@@ -35,246 +40,246 @@ namespace bustub {
 
 
 template <typename K, typename V>
-ExtendibleHashTable<K, V>::ExtendibleHashTable(size_t bucket_size)   //构造, 全局深度为0, bucket 大小为2, 1个bucekt
-    : global_depth_(0), bucket_size_(bucket_size), num_buckets_(1) {
-  // 1 创建, bucket
-  std::shared_ptr<Bucket> b = std::make_shared<Bucket>(bucket_size_, 0);
-  dir_.push_back(b);
-  return;
-}
-
-template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::IndexOf(const K &key) -> size_t {   //id, 指向哪一个buckt
-  int mask = (1 << global_depth_) - 1;  // 0, 1 , 11 , 111,  1111,
-  return std::hash<K>()(key) & mask;
+ExtendibleHashTable<K, V>::ExtendibleHashTable(size_t bucket_size)   //构造, 全局深度为0, 1个bucekt
+    : bucket_size_(bucket_size), num_buckets_(1) {
+  // 1 创建, bucket 和只有一项的目录
+  buckets_.push_back(std::make_unique<Bucket>(bucket_size_, 0));
+  dirs_.push_back(std::make_unique<Directory>(0));
+  dirs_.back()->slots_[0].store(buckets_.back().get(), std::memory_order_relaxed);
+  dir_.store(dirs_.back().get(), std::memory_order_release);
 }
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::GetGlobalDepth() const -> int {   //全局深度
-  std::scoped_lock<std::mutex> lock(latch_);
-  return GetGlobalDepthInternal();
-}
-
-template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::GetGlobalDepthInternal() const -> int {
-  return global_depth_;
+  return dir_.load(std::memory_order_acquire)->global_depth_;
 }
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::GetLocalDepth(int dir_index) const -> int {   //local深度
-  std::scoped_lock<std::mutex> lock(latch_);
-  return GetLocalDepthInternal(dir_index);
+  Bucket *bucket = dir_.load(std::memory_order_acquire)->slots_[dir_index].load(std::memory_order_acquire);
+  std::scoped_lock<std::mutex> lock(bucket->GetLatch());
+  return bucket->GetDepth();
 }
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::GetLocalDepthInternal(int dir_index) const -> int {
-  return dir_[dir_index]->GetDepth();
+auto ExtendibleHashTable<K, V>::GetNumBuckets() const -> int {       //bucket 数量
+  std::scoped_lock<std::mutex> lock(dir_latch_);
+  return num_buckets_;
 }
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::GetNumBuckets() const -> int {       //bucket 数量
-  std::scoped_lock<std::mutex> lock(latch_);
-  return GetNumBucketsInternal();
+auto ExtendibleHashTable<K, V>::GetDir() const -> std::vector<Bucket *> {
+  const Directory *dir = dir_.load(std::memory_order_acquire);
+  std::vector<Bucket *> buckets(dir->Size());
+  for (size_t i = 0; i < buckets.size(); i++) {
+    buckets[i] = dir->slots_[i].load(std::memory_order_acquire);
+  }
+  return buckets;
 }
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::GetNumBucketsInternal() const -> int {
-  return num_buckets_;
+auto ExtendibleHashTable<K, V>::LatchBucket(size_t hash, std::unique_lock<std::mutex> *lock) const -> Bucket * {
+  // 目录不加锁读; 锁住桶后桶还覆盖这个 hash 才算找对, 否则桶刚分裂过, 重新读目录
+  while (true) {
+    const Directory *dir = dir_.load(std::memory_order_acquire);
+    Bucket *bucket = dir->slots_[IndexOf(dir, hash)].load(std::memory_order_acquire);
+    *lock = std::unique_lock<std::mutex>(bucket->GetLatch());
+    if (bucket->Covers(hash)) {
+      return bucket;
+    }
+    lock->unlock();
+  }
 }
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::Find(const K &key, V &value) -> bool {    //获取kv
-  size_t id = IndexOf(key);                 // 获取桶index
-  if ((int)id >= num_buckets_) {
-    return false;
-  }
-  std::shared_ptr<Bucket> bp = dir_[id];   // 获取桶
-  if (!bp) {   //指针为空
-    return false;
-  }
-
-  return bp->Find(key, value);
+  size_t hash = std::hash<K>()(key);
+  std::unique_lock<std::mutex> lock;
+  return LatchBucket(hash, &lock)->Find(key, hash, value);
 }
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::Remove(const K &key) -> bool {         //删除kv
-  size_t id = IndexOf(key);                 // 获取桶index
-  if ((int)id >= num_buckets_) {
-    return false;
-  }
-  std::shared_ptr<Bucket> bp = dir_[id];   //获取桶
-  if (!bp) {
-    return false;
-  }
-  return bp->Remove(key);
+  size_t hash = std::hash<K>()(key);
+  std::unique_lock<std::mutex> lock;
+  return LatchBucket(hash, &lock)->Remove(key, hash);
 }
 
 template <typename K, typename V>
 void ExtendibleHashTable<K, V>::Insert(const K &key, const V &value) {   //插入kv
-  //1 如果全局深度为0, 则直接取dir_[0]的 bucket
-  size_t id = 0;
-  tcout << "即将插入数据 " << "key " << key << " hash: " << std::hash<K>()(key) << endl;
-  if (global_depth_ == 0) {
-    std::shared_ptr<Bucket> bk = dir_[0];
-    if (bk->IsFull()) {                       // 如果满了, 则分裂桶
-      tcout << "global_depth_:" << global_depth_ << " 桶: " << 0 << " 满了需要分裂 " << endl;
-      RedistributeBucket(bk, 0);
+  size_t hash = std::hash<K>()(key);
+  tcout << "即将插入数据 " << "key " << key << " hash: " << hash << endl;
+  // 已存在原地更新, 桶满了就分裂; 分裂后 key 可能仍落在满桶里(所有 key 分到了同一边), 继续分裂
+  while (true) {
+    std::unique_lock<std::mutex> lock;
+    Bucket *bucket = LatchBucket(hash, &lock);
+    if (bucket->Insert(key, hash, value)) {
+      return;
     }
-
-    id = IndexOf(key);                         // 分裂桶后, 有可能dir_扩容, 所以要重新获取桶 index
-    bk = dir_[id];
-    tcout << "3 key: "<< key << "id: " << id << endl;
-    tcout << "global_depth_:" << global_depth_ << " 即将向桶: " << id << " 插入数据: " << key << endl;
-    bk->Insert(key, value);
-    return;
+    tcout << "global_depth_:" << GetGlobalDepth() << " 桶满了需要分裂 " << endl;
+    RedistributeBucket(bucket);
   }
-  //2 如果全局深不为 0, 则使用 hash 获取 桶index
-  id = IndexOf(key);
-  tcout << "1 key: "<< key << "id: " << id << endl;
-  std::shared_ptr<Bucket> bk = dir_[id];
-  if (bk->IsFull()) {                           // 如果满了, 则分裂桶
-    tcout << "global_depth_:" << global_depth_ << " 桶: " << id << " 满了需要分裂 " << endl;
-    RedistributeBucket(bk, id);
-  }
-  tcout << "2 key: "<< key << "id: " << id << endl;
-  id = IndexOf(key);                            // 分裂桶后, 有可能dir_扩容, 所以要重新获取桶 index
-  bk = dir_[id];
-
-  tcout << "global_depth_:" << global_depth_ << " 即将向桶: " << id << " 插入数据: " << key << endl;
-  bk->Insert(key, value);
-
-  return;
 }
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::RedistributeBucket(std::shared_ptr<Bucket> bucket, size_t dirId) -> void {   // 核心函数
-  bool capacityExpansion = false;
-
-  int dpth = bucket->GetDepth();
-  if(dpth < this->global_depth_){   // 1 如果桶的depth 小于全局的depth, 则只做bucket分裂, 增加bucekt depth
-    tcout << "RedistributeBucket: 只做bucket分裂" << endl;
-    bucket->IncrementDepth();
-  } else {                         // 2 如果桶的depth 等于全局的depth, 则 dir_ 扩容 + bucket分裂,  dir_ 大小扩容一倍,  bucket depth 和 全局depth 都增加 1
-    tcout << "RedistributeBucket: dir扩容 + bucket分裂, 扩容" << endl;
-    capacityExpansion = true;
-    this->dir_.resize(dir_.size() * 2);
-    bucket->IncrementDepth();
-    this->global_depth_++;
-    this->num_buckets_ = 1 << global_depth_;
-  }
-
-  std::shared_ptr<Bucket> newBp = std::make_shared<Bucket>(this->bucket_size_, bucket->GetDepth());  // 3 创建新桶
-  std::list<std::pair<K, V>> &oldl = bucket->GetItems();                                             // 4 获取老桶的链表
-
-  // 5 用 dirId 和 新的local depth 的 hash值, 重新分配 bucket 的数据, hash 值和dirId相等的说明最高位即 local depth 位为0, 留在原 bucket
-  //   和 dirId 不等的说明最高位即local depth 位为1, 从原bucket 删除, 加入新 bucekt
-  tcout << "RedistributeBucket: 遍历bucket, 重新分配" << endl;
-  size_t newHash = 0;
-  for (auto ft = oldl.begin(); ft != oldl.end(); ft++) {
-    size_t ftHash = bucket->IndexV(((*ft).first));          // 每个key 的hash
-    if (ftHash != dirId) {                                  // 每个key 的hash 和 dir_的id相等, 则留在原处, 否则插入新的bucket
-      if (newHash == 0) {
-        newHash = ftHash;
-      }
-      tcout << "RedistributeBucket: 即将插入输入 newBq key: " << (*ft).first << endl;
-      newBp->Insert((*ft).first, (*ft).second);
+auto ExtendibleHashTable<K, V>::RedistributeBucket(Bucket *bucket) -> void {   // 核心函数
+  std::scoped_lock<std::mutex> dir_lock(dir_latch_);
+  Directory *dir = dir_.load(std::memory_order_relaxed);
 
-      tcout << "RedistributeBucket: 删除老的 key: " << (*ft).first  << endl;
-      ft = oldl.erase(ft);
+  // 1 如果桶的depth 等于全局的depth, 则目录扩容一倍, 新的一半指向原来对应的桶, 全局depth 加 1
+  //   旧目录留在 dirs_ 里, 不加锁的读者可能还拿着它
+  if (bucket->GetDepth() == dir->global_depth_) {
+    tcout << "RedistributeBucket: dir扩容 + bucket分裂, 扩容" << endl;
+    auto grown = std::make_unique<Directory>(dir->global_depth_ + 1);
+    size_t old_size = dir->Size();
+    for (size_t i = 0; i < old_size; i++) {
+      Bucket *slot = dir->slots_[i].load(std::memory_order_relaxed);
+      grown->slots_[i].store(slot, std::memory_order_relaxed);
+      grown->slots_[i + old_size].store(slot, std::memory_order_relaxed);
     }
+    dir = grown.get();
+    dirs_.push_back(std::move(grown));
+    dir_.store(dir, std::memory_order_release);
   }
 
-  tcout << "RedistributeBucket: 设置新桶, dir_:  " << newHash << " 的对象: " << newBp  << " dir_size: " << dir_.size() << endl;
-  dir_[newHash] = newBp;
-
-  // 6 如果扩容了, 则从dir_ 1/2 处向下遍历, 遇到为null的则, 设置一个bucket, 设置到即前一个 depth 的dir_指向的地方,
-  //   即设置到 hash 值最高位 depth 位为0 的位置
-  tcout << "RedistributeBucket- capacityExpansion: 遍历 dir_, 重新分配" << endl;
-  if (capacityExpansion) {
-    size_t newStartId = 1 << (global_depth_ - 1);       //原先共多少个, 举个栗子:现在是 global_depth_是3, 共8个 dir_项; 原来是2, 共2个 dir_项; 则现在从[1<<2]->[4]开始遍历
-
-    int mask = (1 << (global_depth_ - 1)) - 1;  // 0, 1 , 11 , 111,  1111,   原来是1<<(2)-1, 即: 11 , 对每个 i 取两位 hash值
-
-    for (size_t i = newStartId; i < dir_.size(); i++) {
-      if (dir_[i] == nullptr) {
-        size_t oldId =  i & mask;
-        tcout << "RedistributeBucket, 设置 dir: " << i << " 为老的 "<< oldId  << endl;
-        dir_[i] = dir_[oldId];
-      }
-    }
+  // 2 bucket depth 加 1, 新增的这一位为 1 的 key 搬到新桶
+  size_t high_bit = static_cast<size_t>(1) << bucket->GetDepth();
+  buckets_.push_back(std::make_unique<Bucket>(bucket_size_, bucket->GetDepth() + 1, bucket->GetPattern() | high_bit));
+  Bucket *image = buckets_.back().get();
+  bucket->SplitInto(image);
+  num_buckets_++;
+
+  // 3 低 depth 位等于新桶 pattern 的 dir 项都改指向新桶, 每隔 2 * high_bit 一项
+  tcout << "RedistributeBucket: 桶分裂, dir_size: " << dir->Size() << endl;
+  for (size_t i = image->GetPattern(); i < dir->Size(); i += high_bit << 1) {
+    dir->slots_[i].store(image, std::memory_order_release);
   }
-
-  return;
 }
 
 //===--------------------------------------------------------------------===//
 // Bucket
 //===--------------------------------------------------------------------===//
 template <typename K, typename V>
-ExtendibleHashTable<K, V>::Bucket::Bucket(size_t array_size, int depth) : size_(array_size), depth_(depth) {}
+ExtendibleHashTable<K, V>::Bucket::Bucket(size_t array_size, int depth, size_t pattern)
+    : size_(array_size), depth_(depth), pattern_(pattern) {
+  // 1 tags | keys | values 放在同一块内存里, tag 数组补齐到 TAG_GROUP 的整数倍
+  auto align = [](size_t offset, size_t alignment) { return (offset + alignment - 1) / alignment * alignment; };
+  size_t keys_offset = align((size_ + TAG_GROUP - 1) / TAG_GROUP * TAG_GROUP, alignof(K));
+  size_t values_offset = align(keys_offset + size_ * sizeof(K), alignof(V));
+  data_.reset(new char[values_offset + size_ * sizeof(V)]);
+  tags_ = reinterpret_cast<uint8_t *>(data_.get());
+  keys_ = reinterpret_cast<K *>(data_.get() + keys_offset);
+  values_ = reinterpret_cast<V *>(data_.get() + values_offset);
+  std::fill_n(tags_, keys_offset, 0);
+  std::uninitialized_value_construct_n(keys_, size_);
+  std::uninitialized_value_construct_n(values_, size_);
+}
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::Bucket::Find(const K &key, V &value) -> bool {
-  // 1 遍历链表, 发现则返回true
-  for (auto b = list_.begin(); b != list_.end(); b++) {
-    if ((*b).first == key) {
-      value = (*b).second;
-      return true;
+ExtendibleHashTable<K, V>::Bucket::~Bucket() {
+  std::destroy_n(keys_, size_);
+  std::destroy_n(values_, size_);
+}
+
+template <typename K, typename V>
+auto ExtendibleHashTable<K, V>::Bucket::SlotOf(const K &key, uint8_t tag) const -> size_t {
+  // 1 每次比较 TAG_GROUP 个 tag, tag 相等才去比较 key
+  for (size_t base = 0; base < count_; base += TAG_GROUP) {
+    uint32_t match;
+#if defined(__SSE2__)
+    __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&tags_[base]));
+    match = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(static_cast<char>(tag)))));
+#else
+    match = 0;
+    for (size_t i = 0; i < TAG_GROUP; i++) {
+      match |= static_cast<uint32_t>(tags_[base + i] == tag) << i;
+    }
+#endif
+    if (count_ - base < TAG_GROUP) {
+      match &= (1U << (count_ - base)) - 1;  // 尾部的空位不算
+    }
+    for (; match != 0; match &= match - 1) {
+      size_t slot = base + __builtin_ctz(match);
+      if (keys_[slot] == key) {
+        return slot;
+      }
     }
   }
-  return false;
+  return size_;
 }
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::Bucket::Remove(const K &key) -> bool {
-  // 1 遍历链表, 发现则返回true
-  for (auto b = list_.begin(); b != list_.end(); b++) {
-    if ((*b).first == key) {
-      list_.erase(b);
-      size_--;
-      return true;
-    }
+void ExtendibleHashTable<K, V>::Bucket::EraseAt(size_t slot) {
+  count_--;
+  if (slot != count_) {
+    tags_[slot] = tags_[count_];
+    keys_[slot] = std::move(keys_[count_]);
+    values_[slot] = std::move(values_[count_]);
   }
-  return false;
+  values_[count_] = V();  // 不再持有被删除的值
 }
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::Bucket::Insert(const K &key, const V &value) -> bool {
-  // 1 链表操作
-  for (auto b = list_.begin(); b != list_.end(); b++) {
-    if ((*b).first == key) {
-      (*b).second = value;
-      return true;
-    }
+auto ExtendibleHashTable<K, V>::Bucket::Find(const K &key, size_t hash, V &value) const -> bool {
+  size_t slot = SlotOf(key, TagOf(hash));
+  if (slot == size_) {
+    return false;
   }
-  std::pair<K, V> pr = std::make_pair(key, value);
-  this->list_.push_back(pr);
-  tcout << "real insert key: " << key  << " bucket now depth_: " << this->depth_ << " size: " << list_.size() << endl;
+  value = values_[slot];
   return true;
 }
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::Bucket::IndexV(const K &key) -> size_t {   // id, 指向哪一个buckt
-  int mask = (1 << depth_) - 1;  // 0, 1 , 11 , 111,  1111,
-  return std::hash<K>()(key) & mask;
+auto ExtendibleHashTable<K, V>::Bucket::Remove(const K &key, size_t hash) -> bool {
+  size_t slot = SlotOf(key, TagOf(hash));
+  if (slot == size_) {
+    return false;
+  }
+  EraseAt(slot);
+  return true;
 }
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::Bucket::GetTwoIndexByDepth(const K &key, int depth , int &id0, int &id1) -> void {    // 例如 depth 为3, 则id0, 取hash key 的前2位;  id1区 hash key 的3位
-  int mask = (1 << depth) - 1;         // 例如depth 为 3, id0最高位设置为0, id1最高位设置1
-  int tmp = std::hash<K>()(key) & mask;
-  id0 = tmp | (1 <<(depth-1));
-  id1 = tmp & ~(1 <<(depth-1));
+auto ExtendibleHashTable<K, V>::Bucket::Insert(const K &key, size_t hash, const V &value) -> bool {
+  uint8_t tag = TagOf(hash);
+  size_t slot = SlotOf(key, tag);
+  if (slot != size_) {
+    values_[slot] = value;
+    return true;
+  }
+  if (IsFull()) {
+    return false;
+  }
+  tags_[count_] = tag;
+  keys_[count_] = key;
+  values_[count_] = value;
+  count_++;
+  tcout << "real insert key: " << key << " bucket now depth_: " << this->depth_ << " size: " << count_ << endl;
+  return true;
+}
 
-  return ;
+template <typename K, typename V>
+void ExtendibleHashTable<K, V>::Bucket::SplitInto(Bucket *image) {
+  size_t high_bit = static_cast<size_t>(1) << depth_;
+  depth_++;
+  for (size_t slot = 0; slot < count_;) {
+    if ((std::hash<K>()(keys_[slot]) & high_bit) == 0) {
+      slot++;
+      continue;
+    }
+    image->tags_[image->count_] = tags_[slot];
+    image->keys_[image->count_] = std::move(keys_[slot]);
+    image->values_[image->count_] = std::move(values_[slot]);
+    image->count_++;
+    EraseAt(slot);  // 最后一个搬到 slot, 所以 slot 不前进
+  }
 }
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::Bucket::PrintData() ->void {       // 测试函数打印桶内数据
-  for (auto f = list_.begin(); f != list_.end(); f++) {
-    tcout << "key: " << (*f).first << " hash: " << std::hash<K>()((*f).first) << endl;
+auto ExtendibleHashTable<K, V>::Bucket::PrintData() const -> void {       // 测试函数打印桶内数据
+  for (size_t slot = 0; slot < count_; slot++) {
+    tcout << "key: " << keys_[slot] << " hash: " << std::hash<K>()(keys_[slot]) << endl;
   }
-  return;
 }
 
 template class ExtendibleHashTable<page_id_t, Page *>;
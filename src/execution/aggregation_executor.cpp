@@ -1,114 +1,159 @@
-//===----------------------------------------------------------------------===//
-//
-//                         BusTub
-//
-// aggregation_executor.cpp
-//
-// Identification: src/execution/aggregation_executor.cpp
-//
-// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
-//
-//===----------------------------------------------------------------------===//
-#include <memory>
-#include <vector>
-
-#include "execution/executors/aggregation_executor.h"
-
-namespace bustub {
-
-AggregationExecutor::AggregationExecutor(ExecutorContext *exec_ctx, const AggregationPlanNode *plan,
-                                         std::unique_ptr<AbstractExecutor> &&child)
-    : AbstractExecutor(exec_ctx),
-      plan_(plan),
-      child_(std::move(child)),
-      aht_(plan->GetAggregates(), plan->GetAggregateTypes()),
-      aht_iterator_(aht_.Begin()){}
-/*
-因此，Aggregation 需要在 Init() 中直接计算出全部结果，将结果暂存，再在 Next() 中一条一条地 emit
-*/
-
-void AggregationExecutor::Init() {
-    // 从子计划中获取值, 计算, 计算后存在hash中, next 发出值
-    Tuple tuple;
-    RID rid;
-    printf("AggregationExecutor::Init\n");
-    if (plan_->GetAggregates().size() == 0) {
-        return;
-    }
-
-    while (true) {
-        if (!(child_.get()->Next(&tuple, &rid))){
-            break;
-        }
-        aht_.InsertCombine(MakeAggregateKey(&tuple), MakeAggregateValue(&tuple));
-    }
-    aht_iterator_ = aht_.Begin();
-    printf("AggregationExecutor::Init done\n");
-    return;
-}
-
-auto AggregationExecutor::Next(Tuple *tuple, RID *rid) -> bool {
-    printf("AggregationExecutor::Next\n");
-    std::vector<Value> values;
-    std::vector<Value> keys ;
-
-    if (plan_->GetAggregates().size() == 0) {
-        return child_->Next(tuple, rid);
-    }
-    const Schema schema  = GetOutputSchema();
-    //const Schema schema = plan_->InferAggSchema(plan_->GetGroupBys(), plan_->GetAggregates(), plan_->GetAggregateTypes());
-
-    if (aht_iterator_ != aht_.End()) {                // 未结束, 返回true
-        // 将key , val 组合成tuple , 传出, 判断是否可以传出
-        values = aht_iterator_.Val().aggregates_;
-        *tuple = Tuple(values, &schema);
-        ++aht_iterator_;
-        printf("AggregationExecutor::Next true\n");
-        return true;
-    }
-    printf("AggregationExecutor::Next false\n");
-    return false;                                           // 结束, 返回false
-}
-
-/*
-
-void AggregationExecutor::Init() {
-    printf("AggregationExecutor::Init\n");
-    child_->Init();
-    Tuple cur_tuple{};
-    RID rid{};
-    if( plan_->GetAggregates().size() != 0){
-        while (child_->Next(&cur_tuple,&rid)) {
-            aht_.InsertCombine(MakeAggregateKey(&cur_tuple), MakeAggregateValue(&cur_tuple));
-        }
-        aht_iterator_ = aht_.Begin();
-    }
-    printf("AggregationExecutor::Init done\n");
-}
-
-auto AggregationExecutor::Next(Tuple *tuple, RID *rid) -> bool { 
-    printf("AggregationExecutor::Next\n");
-    std::vector<Value> values;
-    const Schema output_schema = GetOutputSchema();
-
-    if( plan_->GetAggregates().size() != 0 ){
-        if( aht_iterator_ != aht_.End() ){
-            values = aht_iterator_.Val().aggregates_;
-            *tuple = Tuple(values, &GetOutputSchema());
-            *rid = tuple->GetRid();
-            ++aht_iterator_;
-            printf("AggregationExecutor::Next true\n");
-            return true;
-        }
-        printf("AggregationExecutor::Next false\n");
-        return false;
-    } else {
-        printf("AggregationExecutor::Next child_->Next\n");
-        return child_->Next(tuple, rid);
-    } 
-    
-}*/
-
-auto AggregationExecutor::GetChildExecutor() const -> const AbstractExecutor * { return child_.get(); }
-
-}  // namespace bustub
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// aggregation_executor.cpp
+//
+// Identification: src/execution/aggregation_executor.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "execution/executors/aggregation_executor.h"
+
+namespace bustub {
+
+AggregationExecutor::AggregationExecutor(ExecutorContext *exec_ctx, const AggregationPlanNode *plan,
+                                         std::unique_ptr<AbstractExecutor> &&child)
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      child_(std::move(child)),
+      aht_(plan->GetAggregates(), plan->GetAggregateTypes(), exec_ctx->GetQueryMemory()),
+      aht_iterator_(aht_.Begin()){}
+
+AggregationExecutor::~AggregationExecutor() { Reset(); }           // 还回预算; spill 的页随 run 删掉
+/*
+因此，Aggregation 需要在 Init() 中直接计算出全部结果，将结果暂存，再在 Next() 中一条一条地 emit
+*/
+
+void AggregationExecutor::Init() {
+    // 从子计划中获取值, 计算, 计算后存在hash中, next 发出值
+    Reset();
+    child_->Init();
+    if (plan_->GetAggregates().empty()) {
+        return;
+    }
+
+    Tuple tuple;
+    RID rid;
+    while (child_->Next(&tuple, &rid)) {
+        Aggregate(tuple, 0);
+    }
+    FinishPartitions(0);
+    aht_iterator_ = aht_.Begin();
+}
+
+auto AggregationExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+    if (plan_->GetAggregates().empty()) {
+        return child_->Next(tuple, rid);
+    }
+
+    while (aht_iterator_ == aht_.End()) {                           // 内存里的组发完了, 聚合下一个 spill 分区
+        if (pending_.empty()) {
+            return false;                                           // 结束, 返回false
+        }
+        auto [run, level] = std::move(pending_.back());
+        pending_.pop_back();
+        aht_.Clear();
+        {
+            SpillRunReader reader(run.get());                       // 先于 run 析构
+            Tuple spilled;
+            while (reader.Next(&spilled)) {
+                Aggregate(spilled, level);
+            }
+        }
+        FinishPartitions(level);
+        aht_iterator_ = aht_.Begin();
+    }
+
+    // 输出 schema 是 group by 的列, 然后是聚合的值
+    std::vector<Value> values = aht_iterator_.Key().group_bys_;
+    const auto &aggregates = aht_iterator_.Val().aggregates_;
+    values.insert(values.end(), aggregates.begin(), aggregates.end());
+    *tuple = Tuple(values, &GetOutputSchema());
+    *rid = tuple->GetRid();
+    ++aht_iterator_;
+    return true;
+}
+
+void AggregationExecutor::Aggregate(const Tuple &tuple, size_t level) {
+    AggregateKey key = MakeAggregateKey(&tuple);
+    if (aht_.TryInsertCombine(key, MakeAggregateValue(&tuple))) {
+        return;
+    }
+    // 新的组放不下: 这一组这一趟都不进内存, 输入按组的 hash 写到分区里; 每一趟换一个种子, 分区能再分开
+    if (partitions_.empty()) {
+        for (size_t i = 0; i < AGGREGATION_SPILL_PARTITIONS; i++) {
+            partitions_.push_back(std::make_unique<SpillRun>(GetExecutorContext()->GetBufferPoolManager()));
+        }
+    }
+    hash_t hash = HashUtil::CombineHashes(std::hash<AggregateKey>{}(key), level);
+    partitions_[hash % AGGREGATION_SPILL_PARTITIONS]->Append(tuple);
+}
+
+void AggregationExecutor::FinishPartitions(size_t level) {
+    for (auto &run : partitions_) {
+        if (run->GetTupleCount() == 0) {
+            continue;
+        }
+        run->Finish();
+        GetExecutorContext()->GetQueryMemory()->RecordSpill(run->GetPageCount());
+        pending_.emplace_back(std::move(run), level + 1);
+    }
+    partitions_.clear();
+}
+
+void AggregationExecutor::Reset() {
+    partitions_.clear();
+    pending_.clear();
+    aht_.Clear();
+    aht_iterator_ = aht_.End();
+}
+
+/*
+
+void AggregationExecutor::Init() {
+    printf("AggregationExecutor::Init\n");
+    child_->Init();
+    Tuple cur_tuple{};
+    RID rid{};
+    if( plan_->GetAggregates().size() != 0){
+        while (child_->Next(&cur_tuple,&rid)) {
+            aht_.InsertCombine(MakeAggregateKey(&cur_tuple), MakeAggregateValue(&cur_tuple));
+        }
+        aht_iterator_ = aht_.Begin();
+    }
+    printf("AggregationExecutor::Init done\n");
+}
+
+auto AggregationExecutor::Next(Tuple *tuple, RID *rid) -> bool { 
+    printf("AggregationExecutor::Next\n");
+    std::vector<Value> values;
+    const Schema output_schema = GetOutputSchema();
+
+    if( plan_->GetAggregates().size() != 0 ){
+        if( aht_iterator_ != aht_.End() ){
+            values = aht_iterator_.Val().aggregates_;
+            *tuple = Tuple(values, &GetOutputSchema());
+            *rid = tuple->GetRid();
+            ++aht_iterator_;
+            printf("AggregationExecutor::Next true\n");
+            return true;
+        }
+        printf("AggregationExecutor::Next false\n");
+        return false;
+    } else {
+        printf("AggregationExecutor::Next child_->Next\n");
+        return child_->Next(tuple, rid);
+    } 
+    
+}*/
+
+auto AggregationExecutor::GetChildExecutor() const -> const AbstractExecutor * { return child_.get(); }
+
+}  // namespace bustub
@@ -0,0 +1,257 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// copy_from.cpp
+//
+// Identification: src/execution/copy_from.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/copy_from.h"
+
+#include <cerrno>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/util/csv_reader.h"
+#include "fmt/format.h"
+#include "storage/table/table_bulk_loader.h"
+#include "storage/table/toast.h"
+#include "storage/table/tuple_view.h"
+#include "type/limits.h"
+#include "type/type.h"
+
+namespace bustub {
+
+/** index entries handed to Index::InsertEntries at a time */
+static constexpr size_t COPY_INDEX_BATCH_SIZE = 1 << 18;
+
+/** parse an integer column; the smallest value of the type is its NULL and is rejected */
+template <typename T>
+static auto ParseInteger(std::string_view field, const Column &col) -> T {
+  int64_t value;
+  auto [end, ec] = std::from_chars(field.data(), field.data() + field.size(), value);
+  if (ec != std::errc() || end != field.data() + field.size() || value <= std::numeric_limits<T>::min() ||
+      value > std::numeric_limits<T>::max()) {
+    throw Exception(fmt::format("invalid value for {} column {}: \"{}\"", Type::TypeIdToString(col.GetType()),
+                                col.GetName(), field));
+  }
+  return static_cast<T>(value);
+}
+
+template <typename T>
+static void Store(std::string *row, uint32_t offset, T value) {
+  memcpy(row->data() + offset, &value, sizeof(T));
+}
+
+/** serialize a csv record into row, in the format Tuple::Tuple(values, schema) builds */
+static void EncodeCsvRow(const Schema &schema, const CsvReader &reader, const std::vector<std::string_view> &fields,
+                         std::string *row) {
+  if (fields.size() != schema.GetColumnCount()) {
+    throw Exception(fmt::format("expected {} fields, got {}", schema.GetColumnCount(), fields.size()));
+  }
+  row->assign(schema.GetLength(), '\0');
+  for (uint32_t i = 0; i < fields.size(); i++) {
+    const auto &col = schema.GetColumn(i);
+    std::string_view field = fields[i];
+    bool is_null = field.empty() && !reader.IsQuoted(i);
+    uint32_t offset = col.GetOffset();
+    switch (col.GetType()) {
+      case TypeId::BOOLEAN: {
+        int8_t value = BUSTUB_BOOLEAN_NULL;
+        if (!is_null) {
+          if (field == "true" || field == "t" || field == "1") {
+            value = 1;
+          } else if (field == "false" || field == "f" || field == "0") {
+            value = 0;
+          } else {
+            throw Exception(fmt::format("invalid value for boolean column {}: \"{}\"", col.GetName(), field));
+          }
+        }
+        Store(row, offset, value);
+        break;
+      }
+      case TypeId::TINYINT:
+        Store(row, offset, is_null ? BUSTUB_INT8_NULL : ParseInteger<int8_t>(field, col));
+        break;
+      case TypeId::SMALLINT:
+        Store(row, offset, is_null ? BUSTUB_INT16_NULL : ParseInteger<int16_t>(field, col));
+        break;
+      case TypeId::INTEGER:
+        Store(row, offset, is_null ? BUSTUB_INT32_NULL : ParseInteger<int32_t>(field, col));
+        break;
+      case TypeId::BIGINT:
+        Store(row, offset, is_null ? BUSTUB_INT64_NULL : ParseInteger<int64_t>(field, col));
+        break;
+      case TypeId::DECIMAL: {
+        double value = BUSTUB_DECIMAL_NULL;
+        if (!is_null) {
+          auto [end, ec] = std::from_chars(field.data(), field.data() + field.size(), value);
+          if (ec != std::errc() || end != field.data() + field.size()) {
+            throw Exception(fmt::format("invalid value for decimal column {}: \"{}\"", col.GetName(), field));
+          }
+        }
+        Store(row, offset, value);
+        break;
+      }
+      case TypeId::VARCHAR: {
+        // 定长部分存数据的相对偏移, 数据 (长度 + 内容) 接在后面; 和 Value 一样内容带上结尾的 '\0'
+        Store(row, offset, static_cast<uint32_t>(row->size()));
+        uint32_t len = is_null ? BUSTUB_VALUE_NULL : static_cast<uint32_t>(field.size()) + 1;
+        row->append(reinterpret_cast<const char *>(&len), sizeof(len));
+        if (!is_null) {
+          row->append(field.data(), field.size());
+          row->push_back('\0');
+        }
+        break;
+      }
+      default:
+        throw NotImplementedException(
+            fmt::format("copy does not support {} column {}", Type::TypeIdToString(col.GetType()), col.GetName()));
+    }
+  }
+}
+
+/** check that the varchar offsets and lengths of a binary row stay inside it */
+static void ValidateBinaryRow(const Schema &schema, const char *data, uint32_t size) {
+  if (size < schema.GetLength()) {
+    throw Exception(fmt::format("a row of {} bytes is shorter than the {} bytes of the fixed-length columns", size,
+                                schema.GetLength()));
+  }
+  for (auto i : schema.GetUnlinedColumns()) {
+    uint32_t offset;
+    uint32_t len;
+    memcpy(&offset, data + schema.GetColumn(i).GetOffset(), sizeof(offset));
+    if (offset < schema.GetLength() || offset > size - sizeof(len)) {
+      throw Exception(fmt::format("column {} points outside the row", schema.GetColumn(i).GetName()));
+    }
+    memcpy(&len, data + offset, sizeof(len));
+    if (len != BUSTUB_VALUE_NULL && len > size - offset - sizeof(len)) {
+      throw Exception(fmt::format("column {} runs past the end of the row", schema.GetColumn(i).GetName()));
+    }
+  }
+}
+
+static void AppendRow(const Schema &schema, TableBulkLoader *loader, uint32_t max_tuple_size, const std::string &row) {
+  // 长的 VARCHAR 存到行外, 放不放得下看存下来的大小
+  uint32_t stored_size = Toast::StoredSize(schema, row.data(), row.size());
+  if (stored_size > max_tuple_size) {
+    throw Exception(fmt::format("a row of {} bytes does not fit in a page", stored_size));
+  }
+  RID rid;
+  if (!loader->Append(row.data(), row.size(), &rid)) {
+    throw Exception("out of buffer pool frames");
+  }
+}
+
+/** read every row of the file into loader; @return the number of rows */
+static auto LoadRows(const TableInfo &table_info, const std::string &path, const CopyFromOptions &options,
+                     TableBulkLoader *loader) -> size_t {
+  const Schema &schema = table_info.schema_;
+  uint32_t max_tuple_size = table_info.table_->MaxTupleSize();
+  size_t rows = 0;
+  std::string row;
+  try {
+    if (options.binary_) {
+      std::unique_ptr<FILE, decltype(&fclose)> file(fopen(path.c_str(), "rb"), &fclose);
+      if (file == nullptr) {
+        throw Exception(fmt::format("cannot open {}: {}", path, strerror(errno)));
+      }
+      setvbuf(file.get(), nullptr, _IOFBF, 1 << 20);
+      uint32_t size;
+      while (fread(&size, sizeof(size), 1, file.get()) == 1) {
+        if (size == 0 || size > max_tuple_size) {
+          throw Exception(fmt::format("invalid row length {}", size));
+        }
+        row.resize(size);
+        if (fread(row.data(), 1, size, file.get()) != size) {
+          throw Exception("unexpected end of file");
+        }
+        ValidateBinaryRow(schema, row.data(), size);
+        AppendRow(schema, loader, max_tuple_size, row);
+        rows++;
+      }
+      if (ferror(file.get()) != 0) {
+        throw Exception(fmt::format("cannot read {}: {}", path, strerror(errno)));
+      }
+    } else {
+      CsvReader reader(path, options.delimiter_);
+      std::vector<std::string_view> fields;
+      if (options.header_) {
+        reader.NextRow(&fields);
+      }
+      while (reader.NextRow(&fields)) {
+        EncodeCsvRow(schema, reader, fields, &row);
+        AppendRow(schema, loader, max_tuple_size, row);
+        rows++;
+      }
+    }
+  } catch (const NotImplementedException &e) {
+    throw;
+  } catch (const Exception &e) {
+    throw Exception(fmt::format("copy failed at row {}: {}", rows + 1, e.what()));
+  }
+  return rows;
+}
+
+/** insert the rows of the loaded pages into every index of the table, a batch at a time */
+static void BuildIndexes(BufferPoolManager *bpm, const TableInfo &table_info, const std::vector<IndexInfo *> &indexes,
+                         const std::vector<page_id_t> &page_ids, Transaction *txn) {
+  if (indexes.empty()) {
+    return;
+  }
+  std::vector<std::vector<std::pair<Tuple, RID>>> entries(indexes.size());
+  std::vector<TupleView> views;
+  std::vector<char> rows;
+  std::vector<Value> values;
+  for (auto page_id : page_ids) {
+    auto page = static_cast<TablePage *>(bpm->FetchPage(page_id));
+    BUSTUB_ASSERT(page != nullptr, "all pages are pinned");
+    page->RLatch();
+    views.clear();
+    table_info.table_->GetTupleViews(page, page->GetData(), nullptr, &rows, &views);
+    for (size_t i = 0; i < indexes.size(); i++) {
+      const Index &index = *indexes[i]->index_;
+      for (const auto &view : views) {
+        values.clear();
+        for (auto attr : index.GetEntryAttrs()) {
+          values.push_back(view.GetValue(&table_info.schema_, attr));
+        }
+        entries[i].emplace_back(Tuple(values, index.GetEntrySchema()), view.GetRid());
+      }
+    }
+    page->RUnlatch();
+    bpm->UnpinPage(page_id, false);
+    for (size_t i = 0; i < indexes.size(); i++) {
+      if (entries[i].size() >= COPY_INDEX_BATCH_SIZE) {
+        indexes[i]->index_->InsertEntries(entries[i], txn);
+        entries[i].clear();
+      }
+    }
+  }
+  for (size_t i = 0; i < indexes.size(); i++) {
+    indexes[i]->index_->InsertEntries(entries[i], txn);
+  }
+}
+
+auto CopyFromFile(BufferPoolManager *bpm, Catalog *catalog, TableInfo *table_info, const std::string &path,
+                  const CopyFromOptions &options, Transaction *txn) -> size_t {
+  // 出错时 loader 析构删掉已经写的页, 表不变
+  TableBulkLoader loader(table_info->table_.get(), txn);
+  size_t rows = LoadRows(*table_info, path, options, &loader);
+  loader.Finish();
+  BuildIndexes(bpm, *table_info, catalog->GetTableIndexes(table_info->name_), loader.GetPageIds(), txn);
+  return rows;
+}
+
+}  // namespace bustub
@@ -0,0 +1,52 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// index_lookup_executor.cpp
+//
+// Identification: src/execution/index_lookup_executor.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/index_lookup_executor.h"
+
+namespace bustub {
+
+IndexLookupExecutor::IndexLookupExecutor(ExecutorContext *exec_ctx, const IndexLookupPlanNode *plan)
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+void IndexLookupExecutor::Init() {
+  auto *catalog = GetExecutorContext()->GetCatalog();
+  auto *index_info = catalog->GetIndex(plan_->GetIndexOid());
+  index_ = index_info->index_.get();
+  table_heap_ = catalog->GetTable(index_info->table_name_)->table_.get();
+  next_key_ = 0;
+  rids_.clear();
+  next_rid_ = 0;
+}
+
+auto IndexLookupExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  auto *txn = GetExecutorContext()->GetTransaction();
+  const auto &keys = plan_->GetKeys();
+  while (true) {
+    // 先把上一次探查的 rid 回表取完, 已经删掉的行 GetTuple 失败, 跳过
+    while (next_rid_ < rids_.size()) {
+      RID candidate = rids_[next_rid_++];
+      if (table_heap_->GetTuple(candidate, tuple, txn)) {
+        *rid = candidate;
+        return true;
+      }
+    }
+    if (next_key_ == keys.size()) {
+      return false;
+    }
+    // 每个 key 探查一次索引; plan 里的 key 没有重复, 同一行不会输出两次
+    rids_.clear();
+    next_rid_ = 0;
+    index_->ScanKey(Tuple({keys[next_key_++]}, index_->GetKeySchema()), &rids_, txn);
+  }
+}
+
+}  // namespace bustub
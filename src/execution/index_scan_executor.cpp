@@ -11,6 +11,14 @@
 //===----------------------------------------------------------------------===//
 #include "execution/executors/index_scan_executor.h"
 
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "storage/index/key_encoder.h"
+#include "type/value_factory.h"
+
 namespace bustub {
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
     : AbstractExecutor(exec_ctx), plan_(plan) {}
@@ -20,40 +28,262 @@ void IndexScanExecutor::Init() {
     Catalog *clog;                      // 目录
     IndexInfo *idInfo;
     TableInfo *tInfo;
-    printf("IndexScanExecutor::Init start\n");
-
-    //BPlusTreeIndexForOneIntegerColumn *tree;    // 索引树
 
     indexOid = plan_->GetIndexOid();
     clog = GetExecutorContext()->GetCatalog();
     idInfo = clog->GetIndex(indexOid);
 
     tInfo = clog->GetTable(idInfo->table_name_);
-    tHeap_ = tInfo->table_.get();
-    tree_ = dynamic_cast<BPlusTreeIndexForOneIntegerColumn *>(idInfo->index_.get());
-    indexIter_ = tree_->GetBeginIterator();   // 获取迭代器; init函数就做了两件事, 1 获取 TableHeap; 为了获取 tuple; , 2 获取
-                           //tree_ b+ 树,  b+ 树中是存在着我们的索引能够快速查找key:val, 其中val 貌似是 rid; 然后用 TableHeap 获取tuple 
-    //IndexIterator(int index, B_PLUS_TREE_LEAF_PAGE_TYPE *page, BufferPoolManager *bpm)
-    //bpm = exec_ctx->GetBufferPoolManager();
-    //firstPage = reinterpret_cast<BPlusTree<BPlusTreePage<GenericKey<8>, RID, GenericComparator<8>> *>(bpm->FetchPage(tHeap->GetFirstPageId());)
-    //firstPage->
-    printf("IndexScanExecutor::Init done\n");
-    return; 
+    tHeap_ = tInfo->table_.get();       // TableHeap, 用 rid 取 tuple
+
+    // covering index 的索引项里带着 include 列, 记下表的每一列在索引项里的位置
+    entrySchema_ = idInfo->index_->GetEntrySchema();
+    const auto &entryAttrs = idInfo->index_->GetEntryAttrs();
+    entryColOfTable_.assign(tInfo->schema_.GetColumnCount(), -1);
+    for (size_t i = 0; i < entryAttrs.size(); i++) {
+        entryColOfTable_[entryAttrs[i]] = static_cast<int>(i);
+    }
+
+    // 变长 key 的 slotted b+ 树, 见 Catalog::CreateSlottedIndex
+    if (auto *slotted = dynamic_cast<SlottedBPlusTreeIndex *>(idInfo->index_.get()); slotted != nullptr) {
+        InitSlottedCursor(slotted);
+        return;
+    }
+
+    // 内存里的 art 索引, 见 Catalog::CreateArtIndex
+    if (auto *art = dynamic_cast<ArtIndex *>(idInfo->index_.get()); art != nullptr) {
+        InitArtCursor(art);
+        return;
+    }
+
+    // lsm 索引, 见 Catalog::CreateLsmIndex
+    if (auto *lsm = dynamic_cast<LsmIndex *>(idInfo->index_.get()); lsm != nullptr) {
+        InitLsmCursor(lsm);
+        return;
+    }
+
+    // 索引项的大小决定了 b+ 树的 key 类型, 见 BustubInstance 建索引
+    switch (idInfo->key_size_) {
+        case 4:
+            InitCursor<4>(idInfo->index_.get());
+            break;
+        case 8:
+            InitCursor<8>(idInfo->index_.get());
+            break;
+        case 16:
+            InitCursor<16>(idInfo->index_.get());
+            break;
+        case 32:
+            InitCursor<32>(idInfo->index_.get());
+            break;
+        case 64:
+            InitCursor<64>(idInfo->index_.get());
+            break;
+        default:
+            throw NotImplementedException("index scan on this key size is not supported");
+    }
 }
 
-auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {      // 这俩参数应该是出参
-    printf("IndexScanExecutor::Next start\n");
-    if (indexIter_ != tree_->GetEndIterator()) {                    // 不等于结束的话, 可以查询出
-        // 从indexIter 获取 tuple 和 rid
-        IntegerValueType ridb = (*indexIter_).second;              // 返回的是 rid
-
-        tHeap_->GetTuple(ridb, tuple, GetExecutorContext()->GetTransaction());      // TableHeap 获取tupple
-        *rid = ridb;
-        printf("IndexScanExecutor::Next done ok\n");
+template <size_t KeySize>
+void IndexScanExecutor::InitCursor(Index *index) {
+    using Tree = BPlusTreeIndex<GenericKey<KeySize>, RID, GenericComparator<KeySize>>;
+    auto *tree = dynamic_cast<Tree *>(index);                       // b+ 树, key:rid
+    BUSTUB_ASSERT(tree != nullptr, "index scan expects a b+ tree index");
+
+    // 范围的两端转成索引 key; 迭代器走到终点就停, 不会扫完整棵树
+    auto toKey = [&](const std::optional<IndexScanBound> &bound) -> std::optional<GenericKey<KeySize>> {
+        if (!bound.has_value()) {
+            return std::nullopt;
+        }
+        GenericKey<KeySize> key;
+        key.SetFromKey(Tuple({bound->key_}, tree->GetKeySchema()));
+        return key;
+    };
+    const auto &lower = plan_->GetLowerBound();
+    const auto &upper = plan_->GetUpperBound();
+    auto iter = std::make_shared<IndexIterator<GenericKey<KeySize>, RID, GenericComparator<KeySize>>>(
+        tree->GetRangeIterator(toKey(lower), !lower.has_value() || lower->inclusive_, toKey(upper),
+                               !upper.has_value() || upper->inclusive_, plan_->IsReverse()));
+                                                                    // 迭代器只能移动, cursor_ 要能拷贝; 析构时放掉叶子
+
+    cursor_ = [iter, schema = entrySchema_](Tuple *entry, RID *rid) -> bool {
+        if (iter->IsEnd()) {
+            return false;
+        }
+        const auto &[key, value] = **iter;
+        if (entry != nullptr) {                                     // 回表时用不到索引项, 不用解出来
+            std::vector<Value> values;
+            values.reserve(schema->GetColumnCount());
+            for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+                values.push_back(key.ToValue(schema, i));
+            }
+            *entry = Tuple(values, schema);
+        }
+        *rid = value;
+        ++*iter;
         return true;
+    };
+}
+
+void IndexScanExecutor::InitSlottedCursor(SlottedBPlusTreeIndex *index) {
+    const auto &lower = plan_->GetLowerBound();
+    const auto &upper = plan_->GetUpperBound();
+    auto *keySchema = index->GetKeySchema();
+    auto iter = std::make_shared<SlottedIndexIterator>(
+        lower.has_value() ? index->GetBeginIterator(Tuple({lower->key_}, keySchema)) : index->GetBeginIterator());
+    if (lower.has_value() && !lower->inclusive_) {                  // 开区间, 跳过等于下界的 key
+        std::string low = index->EncodeKey(Tuple({lower->key_}, keySchema));
+        while (!iter->IsEnd() && (**iter).first == low) {
+            ++*iter;
+        }
+    }
+
+    // 编码后的 key 按字节比较就是 key 的顺序, 上界也编码后比较
+    std::optional<std::string> high;
+    if (upper.has_value()) {
+        high = index->EncodeKey(Tuple({upper->key_}, keySchema));
+    }
+    bool highInclusive = !upper.has_value() || upper->inclusive_;
+    auto inRange = [high, highInclusive](const std::string &key) {
+        return !high.has_value() || key < *high || (highInclusive && key == *high);
+    };
+
+    if (!plan_->IsReverse()) {
+        cursor_ = [iter, inRange, schema = entrySchema_](Tuple *entry, RID *rid) -> bool {
+            if (iter->IsEnd() || !inRange((**iter).first)) {
+                return false;
+            }
+            const auto &[key, value] = **iter;
+            if (entry != nullptr) {
+                *entry = KeyEncoder::Decode(key, schema);
+            }
+            *rid = value;
+            ++*iter;
+            return true;
+        };
+        return;
+    }
+
+    // slotted 树的叶子只有 next 指针, 倒序扫描先把范围内的项正序取出来
+    auto items = std::make_shared<std::vector<std::pair<std::string, RID>>>();
+    for (; !iter->IsEnd() && inRange((**iter).first); ++*iter) {
+        items->push_back(**iter);
+    }
+    cursor_ = [items, schema = entrySchema_](Tuple *entry, RID *rid) -> bool {
+        if (items->empty()) {
+            return false;
+        }
+        if (entry != nullptr) {
+            *entry = KeyEncoder::Decode(items->back().first, schema);
+        }
+        *rid = items->back().second;
+        items->pop_back();
+        return true;
+    };
+}
+
+void IndexScanExecutor::InitArtCursor(ArtIndex *index) {
+    const auto &lower = plan_->GetLowerBound();
+    const auto &upper = plan_->GetUpperBound();
+    auto *keySchema = index->GetKeySchema();
+    auto toKey = [keySchema](const std::optional<IndexScanBound> &bound) -> std::optional<Tuple> {
+        if (!bound.has_value()) {
+            return std::nullopt;
+        }
+        return Tuple({bound->key_}, keySchema);
+    };
+
+    // 树上没有迭代器 (乐观锁下扫描冲突了要整段重来), 先把范围内的项都取出来; 正序就倒过来, 从尾部弹出
+    auto items = std::make_shared<std::vector<std::pair<std::string, RID>>>();
+    index->ScanRange(toKey(lower), !lower.has_value() || lower->inclusive_, toKey(upper),
+                     !upper.has_value() || upper->inclusive_, items.get());
+    if (!plan_->IsReverse()) {
+        std::reverse(items->begin(), items->end());
+    }
+    cursor_ = [items, schema = entrySchema_](Tuple *entry, RID *rid) -> bool {
+        if (items->empty()) {
+            return false;
+        }
+        if (entry != nullptr) {                                     // 编码后面跟着 rid 的字节, Decode 只读 key 列
+            *entry = KeyEncoder::Decode(items->back().first, schema);
+        }
+        *rid = items->back().second;
+        items->pop_back();
+        return true;
+    };
+}
+
+void IndexScanExecutor::InitLsmCursor(LsmIndex *index) {
+    const auto &lower = plan_->GetLowerBound();
+    const auto &upper = plan_->GetUpperBound();
+    auto *keySchema = index->GetKeySchema();
+    auto toKey = [keySchema](const std::optional<IndexScanBound> &bound) -> std::optional<Tuple> {
+        if (!bound.has_value()) {
+            return std::nullopt;
+        }
+        return Tuple({bound->key_}, keySchema);
+    };
+
+    // 迭代器拿着 memtable 和 run 的快照, 扫描期间的写入和 compaction 不影响它
+    auto iter = std::make_shared<LsmIterator>(index->Scan(toKey(lower), !lower.has_value() || lower->inclusive_,
+                                                          toKey(upper), !upper.has_value() || upper->inclusive_));
+    if (!plan_->IsReverse()) {
+        cursor_ = [iter, schema = entrySchema_](Tuple *entry, RID *rid) -> bool {
+            if (iter->IsEnd()) {
+                return false;
+            }
+            if (entry != nullptr) {                                 // 编码后面跟着 rid 的字节, Decode 只读 key 列
+                *entry = KeyEncoder::Decode(iter->Key(), schema);
+            }
+            *rid = LsmIndex::GetRid(iter->Key());
+            ++*iter;
+            return true;
+        };
+        return;
+    }
+
+    // 各层的 run 只能正着读, 倒序扫描先把范围内的项正序取出来
+    auto items = std::make_shared<std::vector<std::string>>();
+    for (; !iter->IsEnd(); ++*iter) {
+        items->push_back(iter->Key());
+    }
+    cursor_ = [items, schema = entrySchema_](Tuple *entry, RID *rid) -> bool {
+        if (items->empty()) {
+            return false;
+        }
+        if (entry != nullptr) {
+            *entry = KeyEncoder::Decode(items->back(), schema);
+        }
+        *rid = LsmIndex::GetRid(items->back());
+        items->pop_back();
+        return true;
+    };
+}
+
+auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {      // 这俩参数应该是出参
+    Tuple entry;
+    RID ridb;
+    while (cursor_(plan_->IsIndexOnly() ? &entry : nullptr, &ridb)) {
+        if (plan_->IsIndexOnly()) {
+            // index-only: 直接用索引项拼出表的 tuple, 不去 TableHeap 随机读页
+            const Schema &schema = plan_->OutputSchema();
+            std::vector<Value> values;
+            values.reserve(schema.GetColumnCount());
+            for (uint32_t i = 0; i < schema.GetColumnCount(); i++) {
+                int entryCol = entryColOfTable_[i];
+                values.push_back(entryCol >= 0 ? entry.GetValue(entrySchema_, entryCol)
+                                               : ValueFactory::GetNullValueByType(schema.GetColumn(i).GetType()));
+            }
+            *tuple = Tuple(values, &schema);
+            *rid = ridb;
+            return true;
+        }
+        if (tHeap_->GetTuple(ridb, tuple, GetExecutorContext()->GetTransaction())) {   // TableHeap 获取tupple
+            *rid = ridb;
+            return true;
+        }
     }
-    printf("IndexScanExecutor::Next done not ok\n");
-    return false;     
+    return false;
 }
 
 }  // namespace bustub
@@ -43,79 +43,61 @@ void InsertExecutor::Init() {
   indexes_ = clog->GetTableIndexes(tinf->name_);  // 所有 index, 为了向b+树中插入KV
 
   child_executor_->Init();  // 子计划初始化, 子计划是啥, 咱也不知道, 反正这玩意儿总得初始化吧
+  rows_.clear();
+  cursor_ = 0;
+  inserted_ = false;
 
   printf("InsertExecutor::Init() done\n");
   return;
 }
 // 要插入的值来自 plan
 /*
-    1 事务记录操作
-    2 从子计划获取kv, 插入表中 TableHeap
+    第一次调用时把子计划的所有 tuple 插入表中, 再按索引批量插入 b+ 树 (InsertEntries 排序后一段叶子只下降一次);
+    之后每次返回一个插入的 tuple
 */
 auto InsertExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool {
-  bool ret;
-  printf("InsertExecutor::Next start\n");
-  // std::cout<< "InsertExecutor::Next start tuple={" <<
-  // tuple->ToString(&(GetExecutorContext()->GetCatalog()->GetTable(plan_->TableOid())->schema_))
-  //             << "}, rid={" << *rid << "}" << std::endl;
-
-  // printf("InsertExecutor::Next start tuple=%s , rid=%s\n",
-  // tuple->ToString(&(GetExecutorContext()->GetCatalog()->GetTable(plan_->TableOid())->schema_)), rid->ToString());
-  ret = child_executor_->Next(tuple, rid);  // 另个参数是出参, 也就是说从这里获取要插入的 tuple 和 rid
-  if (!ret) {
+  if (!inserted_) {
+    InsertAll();
+    inserted_ = true;
+  }
+  if (cursor_ >= rows_.size()) {
     return false;
   }
-  //  auto InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> bool;
-  Insert(tuple, rid);  // 这里插入数据
-  printf("InsertExecutor::Next done\n");
-  // std::cout<< "InsertExecutor::Next done tuple={" <<
-  // tuple->ToString(&(GetExecutorContext()->GetCatalog()->GetTable(plan_->TableOid())->schema_))
-  //             << "}, rid={" << *rid << "}" << std::endl;
-  // printf("InsertExecutor::Next sucess tuple=%s, rid=%s\n",
-  // tuple->ToString(&(GetExecutorContext()->GetCatalog()->GetTable(plan_->TableOid())->schema_)), rid->ToString());
+  *tuple = rows_[cursor_].first;
+  *rid = rows_[cursor_].second;
+  cursor_++;
   return true;
 }
 
 /*
     1 插入表中数据
-    2 事务处理; 遍历index, 将每个事务记录插入;
+    2 事务处理; 遍历index, 记录事务, 把这一批 key 一次交给索引
 */
-void InsertExecutor::Insert(Tuple *tuple, RID *rid) {
-  Catalog *clog;
-  BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>> *bpIndex;
-  Transaction *txn;
-  TableInfo *tinf;
-  table_oid_t tableId;
-
-  txn = GetExecutorContext()->GetTransaction();
-  clog = GetExecutorContext()->GetCatalog();
-  tableId = plan_->TableOid();
-  tinf = clog->GetTable(tableId);
-  // 插入表中数据, 这里已经将要插入的数据, 插入到表中了, 例如: INSERT INTO t1 VALUES (1, 'a');
-  thp_->InsertTuple(*tuple, rid, txn);  // auto InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> bool;
+void InsertExecutor::InsertAll() {
+  Transaction *txn = GetExecutorContext()->GetTransaction();
+  Catalog *clog = GetExecutorContext()->GetCatalog();
+  TableInfo *tinf = clog->GetTable(plan_->TableOid());
 
-  // 遍历 indexs, 用入参 tuple 构造K 插入到b+树中;  上面是插入了一行值, 但一行有多列, 改行的每个列吸入b+树中;
-  // 并事务记录操作 事务操作肯定事务作用, 具体咋作用的咱也没具体分析; 插入b+树肯定是为了查询, 但查询怎么用的咱也没搞,
-
-  for (auto it = indexes_.begin(); it != indexes_.end(); it++) {
-    //(RID rid, table_oid_t table_oid, WType wtype, const Tuple &tuple, index_oid_t index_oid,
-    //            Catalog *catalog)
-    IndexWriteRecord writeRecord =
-        IndexWriteRecord(*rid, plan_->TableOid(), WType::INSERT, *tuple, (*it)->index_oid_, clog);
-
-    txn->AppendIndexWriteRecord(writeRecord);  // 事务记录插入
-    // 获取b+树, 插入b+树
-    // index_oid - > b+树
-    bpIndex = reinterpret_cast<BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>> *>(
-        (*it)->index_.get());  // 模板使用, key 是一个8位的数字key; 获取b+树索引
-    // auto Tuple::KeyFromTuple(const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs)
-    //  b+树索引插入KV
-    bpIndex->InsertEntry(
-        tuple->KeyFromTuple(tinf->schema_, *((*it)->index_->GetKeySchema()), (*it)->index_->GetKeyAttrs()), *rid,
-        txn);  // InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+  Tuple tuple;
+  RID rid;
+  while (child_executor_->Next(&tuple, &rid)) {  // 另个参数是出参, 也就是说从这里获取要插入的 tuple 和 rid
+    // 插入表中数据, 例如: INSERT INTO t1 VALUES (1, 'a');
+    thp_->InsertTuple(tuple, &rid, txn);
+    rows_.emplace_back(tuple, rid);
   }
 
-  return;
+  for (auto *index_info : indexes_) {
+    std::vector<std::pair<Tuple, RID>> entries;
+    entries.reserve(rows_.size());
+    for (auto &[row, row_rid] : rows_) {
+      txn->AppendIndexWriteRecord(
+          IndexWriteRecord(row_rid, plan_->TableOid(), WType::INSERT, row, index_info->index_oid_, clog));
+      entries.emplace_back(
+          row.KeyFromTuple(tinf->schema_, *index_info->index_->GetEntrySchema(), index_info->index_->GetEntryAttrs()),
+          row_rid);
+    }
+    index_info->index_->InsertEntries(entries, txn);
+  }
 }
 
 }  // namespace bustub
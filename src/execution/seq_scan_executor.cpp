@@ -12,8 +12,84 @@
 
 #include "execution/executors/seq_scan_executor.h"
 
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+
 namespace bustub {
 
+namespace {
+
+/** zone map 只比较定长的数值列, 常量和列类型相同或者都是数值 */
+auto IsZoneComparable(TypeId column_type, TypeId constant_type) -> bool {
+    auto numeric = [](TypeId type) {
+        return type == TypeId::TINYINT || type == TypeId::SMALLINT || type == TypeId::INTEGER ||
+               type == TypeId::BIGINT || type == TypeId::DECIMAL;
+    };
+    return column_type != TypeId::VARCHAR &&
+           (column_type == constant_type || (numeric(column_type) && numeric(constant_type)));
+}
+
+/**
+ * 从谓词里找出 zone map 能用的条件: AND 连起来的 `列 op 常量` (或 `常量 op 列`), 每个变成一个 ZoneRange.
+ * 别的 (OR, !=, 两列比较, ...) 不管, 少了条件只是少跳过一些页, 谓词本身还是要逐行算.
+ */
+void CollectZoneRanges(const AbstractExpression &expr, const Schema &schema, std::vector<ZoneRange> *ranges) {
+    if (const auto *logic = dynamic_cast<const LogicExpression *>(&expr); logic != nullptr) {
+        if (logic->logic_type_ == LogicType::And) {
+            CollectZoneRanges(*logic->GetChildAt(0), schema, ranges);
+            CollectZoneRanges(*logic->GetChildAt(1), schema, ranges);
+        }
+        return;
+    }
+    const auto *comparison = dynamic_cast<const ComparisonExpression *>(&expr);
+    if (comparison == nullptr) {
+        return;
+    }
+    ComparisonType type = comparison->comp_type_;
+    const auto *column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(0).get());
+    const auto *constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(1).get());
+    if (column == nullptr) {                                        // 常量在左边: 5 < a 就是 a > 5
+        column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(1).get());
+        constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(0).get());
+        switch (type) {
+            case ComparisonType::LessThan: type = ComparisonType::GreaterThan; break;
+            case ComparisonType::LessThanOrEqual: type = ComparisonType::GreaterThanOrEqual; break;
+            case ComparisonType::GreaterThan: type = ComparisonType::LessThan; break;
+            case ComparisonType::GreaterThanOrEqual: type = ComparisonType::LessThanOrEqual; break;
+            default: break;
+        }
+    }
+    if (column == nullptr || constant == nullptr || constant->val_.IsNull() ||
+        !IsZoneComparable(schema.GetColumn(column->GetColIdx()).GetType(), constant->val_.GetTypeId())) {
+        return;
+    }
+    ZoneRange range;
+    range.column_idx_ = column->GetColIdx();
+    switch (type) {
+        case ComparisonType::Equal:
+            range.lo_ = constant->val_;
+            range.hi_ = constant->val_;
+            break;
+        case ComparisonType::LessThan:
+        case ComparisonType::LessThanOrEqual:
+            range.hi_ = constant->val_;
+            range.hi_inclusive_ = type == ComparisonType::LessThanOrEqual;
+            break;
+        case ComparisonType::GreaterThan:
+        case ComparisonType::GreaterThanOrEqual:
+            range.lo_ = constant->val_;
+            range.lo_inclusive_ = type == ComparisonType::GreaterThanOrEqual;
+            break;
+        default:
+            return;
+    }
+    ranges->push_back(std::move(range));
+}
+
+}  // namespace
+
 SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan) : AbstractExecutor(exec_ctx), plan_(plan) {}
 
 void SeqScanExecutor::Init() {
@@ -31,10 +107,35 @@ void SeqScanExecutor::Init() {
     tinf = ctx->GetCatalog()->GetTable(tableId);                    // exec_ctx 中可以获取 Catalog 就把他当做一个目录, 一些 表信息, index 信息从这里面获取
                                                                     // Catalog 中获取表信息 TableInfo, 即表的schema, 表名字, 表id, 表存储 TableHeap
     thp_ = tinf->table_.get();                                      // 获取  TableHeap 结构指针, 即表存储, 这个结构可以对KV数据 添删改查
-    table_iter_ = thp_->Begin(ctx->GetTransaction());               // TableHeap 实现了迭代器, 获取迭代器, 存入到成员变量中 table_iter_
+    std::vector<ZoneRange> ranges;                                  // 并进来的谓词能推出的列范围, 按 zone map 跳过页
+    if (plan_->filter_predicate_ != nullptr) {
+        CollectZoneRanges(*plan_->filter_predicate_, tinf->schema_, &ranges);
+    }
+    scan_.reset();
+    parallel_scan_.reset();
+    size_t workers = scan_workers;
+    if (workers > 1 && !enable_logging && thp_->GetFreeSpaceMap()->GetNumPages() > SCAN_MORSEL_PAGES) {
+                                                                    // 不止一个 morsel 才值得开线程
+                                                                    // 开了日志要逐行加锁, 只能单线程
+        ParallelPageScan::Filter filter;
+        if (plan_->filter_predicate_ != nullptr) {
+            filter = [this](const Tuple &tuple) {
+                Value value = plan_->filter_predicate_->Evaluate(&tuple, GetOutputSchema());
+                return !value.IsNull() && value.GetAs<bool>();
+            };
+        }
+        parallel_scan_ = std::make_unique<ParallelPageScan>(thp_, ctx->GetTransaction(), workers, std::move(filter),
+                                                            plan_->columns_, std::move(ranges));
+                                                                    // 输出按 morsel 的顺序, 和单线程扫出来的一样
+    } else {
+        scan_ = std::make_unique<TablePageScan>(thp_, ctx->GetTransaction(), plan_->columns_, std::move(ranges));
+                                                                    // 按页扫描, 每页只 fetch 一次
+                                                                    // PAX 表只拼出上层用到的列
+    }
+    pos_ = 0;
 
     return;                                                         // 做完上述准备工作, 即可已返回, 起始就做了两件事 
-                                                                    // 1 thp_; 2 table_iter_, 因为next 函数只需这两个信息即可
+                                                                    // 1 thp_; 2 scan_, 因为next 函数只需这两个信息即可
     /*
     fpId = thp_->GetFirstPageId();
     tp = reinterpret_cast<TablePage *>(bpm->FetchPage(fpId));       // 上面的所有, 只是为了后去要遍历的 TablePage
@@ -49,16 +150,33 @@ void SeqScanExecutor::Init() {
 }
 
 auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {        // 通过出参, 返回tuple, rid
-    if (table_iter_ != thp_->End()) {                               // 迭代器重载了 *, 即获取迭代器指向的 tuple
-        *tuple = *table_iter_;                                      // 返回 rid,  RID包含两个元素 pageid slotnum, 即某个页的的某个位置, 即tupe的位置
+    if (parallel_scan_ != nullptr) {                                // 谓词 worker 已经算过了
+        if (!parallel_scan_->Next(tuple)) {
+            return false;
+        }
         *rid = tuple->GetRid();
-
-        table_iter_++;                                              // 更新迭代器的 tuple 和 tuple 的 rid
-            // todo: 根据 plan_->OutputSchema() 返回tupe, 因为返回的东西可能只是是 schema 的一部分, 根据输出schema 返回数据, 这里是返回了所有的数据
         return true;
     }
-
-    return false;
+    const auto &predicate = plan_->filter_predicate_;               // 没跳过的页里也有不满足谓词的 tuple
+    while (true) {
+        while (pos_ == scan_->GetViews().size()) {                  // 当前页取完了, 换下一页
+            if (!scan_->NextPage()) {
+                return false;
+            }
+            pos_ = 0;
+        }
+        const TupleView &view = scan_->GetViews()[pos_++];          // view 指向 scan_ 拷下来的页, 不再去 TableHeap 取
+        view.CopyTo(tuple);                                         // tuple 的长度不变时复用它的内存
+        *rid = view.GetRid();
+        // todo: 根据 plan_->OutputSchema() 返回tupe, 因为返回的东西可能只是是 schema 的一部分, 根据输出schema 返回数据, 这里是返回了所有的数据
+        if (predicate == nullptr) {
+            return true;
+        }
+        Value value = predicate->Evaluate(tuple, GetOutputSchema());
+        if (!value.IsNull() && value.GetAs<bool>()) {
+            return true;
+        }
+    }
 }
 
 }  // namespace bustub
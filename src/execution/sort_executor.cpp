@@ -1,13 +1,195 @@
 #include "execution/executors/sort_executor.h"
 
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
 namespace bustub {
 
 SortExecutor::SortExecutor(ExecutorContext *exec_ctx, const SortPlanNode *plan,
                            std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), child_(std::move(child_executor)) {}
+
+SortExecutor::~SortExecutor() { Reset(); }                          // 还回预算; run 的页随 runs_ 删掉
+
+void SortExecutor::Init() {
+    Reset();
+    child_->Init();
+    Tuple tuple;
+    RID rid;
+    while (child_->Next(&tuple, &rid)) {
+        Buffer(MakeEntry(tuple));
+    }
+    if (runs_.empty()) {                                            // 全在内存里, 排一下就行
+        SortBuffer();
+        return;
+    }
+    SpillBuffer();                                                  // 剩下的也写出去, 只归并 run
+    BufferPoolManager *bpm = GetExecutorContext()->GetBufferPoolManager();
+    while (runs_.size() > SORT_MERGE_FAN_IN) {                      // 一趟并不完: 相邻的几个并成一个, 保持先后
+        std::vector<std::unique_ptr<SpillRun>> merged;
+        for (size_t first = 0; first < runs_.size(); first += SORT_MERGE_FAN_IN) {
+            size_t last = std::min(first + SORT_MERGE_FAN_IN, runs_.size());
+            if (last - first == 1) {
+                merged.push_back(std::move(runs_[first]));
+                continue;
+            }
+            auto run = std::make_unique<SpillRun>(bpm);
+            StartMerge(first, last);
+            while (NextMerged(&tuple)) {
+                run->Append(tuple);
+            }
+            readers_.clear();
+            run->Finish();
+            GetExecutorContext()->GetQueryMemory()->RecordSpill(run->GetPageCount());
+            merged.push_back(std::move(run));
+        }
+        runs_ = std::move(merged);                                  // 并过的 run 在这里删掉
+    }
+    StartMerge(0, runs_.size());
+}
+
+auto SortExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+    if (!runs_.empty()) {
+        if (!NextMerged(tuple)) {
+            return false;
+        }
+    } else {
+        if (pos_ == order_.size()) {
+            return false;
+        }
+        *tuple = buffer_[order_[pos_++]].tuple_;
+    }
+    *rid = tuple->GetRid();
+    return true;
+}
+
+auto SortExecutor::MakeEntry(const Tuple &tuple) const -> Entry {
+    Entry entry{{}, tuple};
+    entry.keys_.reserve(plan_->GetOrderBy().size());
+    for (const auto &[type, expr] : plan_->GetOrderBy()) {
+        entry.keys_.push_back(expr->Evaluate(&tuple, child_->GetOutputSchema()));
+    }
+    return entry;
+}
+
+auto SortExecutor::EntryBytes(const Entry &entry) -> size_t {
+    size_t bytes = sizeof(Entry) + sizeof(uint32_t) + entry.tuple_.GetLength() + entry.keys_.size() * sizeof(Value);
+    for (const auto &key : entry.keys_) {
+        if (key.GetTypeId() == TypeId::VARCHAR && !key.IsNull()) {  // varchar 的值另外分配
+            bytes += key.GetLength();
+        }
+    }
+    return bytes;
+}
+
+auto SortExecutor::Less(const std::vector<Value> &a, const std::vector<Value> &b) const -> bool {
+    const auto &order_bys = plan_->GetOrderBy();
+    for (size_t i = 0; i < order_bys.size(); i++) {
+        const Value &x = a[i];
+        const Value &y = b[i];
+        bool less;
+        if (x.IsNull() || y.IsNull()) {                             // NULL 最小
+            if (x.IsNull() && y.IsNull()) {
+                continue;
+            }
+            less = x.IsNull();
+        } else if (x.CompareEquals(y) == CmpBool::CmpTrue) {
+            continue;
+        } else {
+            less = x.CompareLessThan(y) == CmpBool::CmpTrue;
+        }
+        return order_bys[i].first == OrderByType::DESC ? !less : less;
+    }
+    return false;
+}
+
+void SortExecutor::Buffer(Entry entry) {
+    QueryMemory *memory = GetExecutorContext()->GetQueryMemory();
+    size_t bytes = EntryBytes(entry);
+    if (!memory->TryReserve(bytes)) {
+        SpillBuffer();
+        if (!memory->TryReserve(bytes)) {                           // 预算放不下一行 (或者被别的算子占了), 只能超
+            memory->Reserve(bytes);
+        }
+    }
+    buffered_bytes_ += bytes;
+    buffer_.push_back(std::move(entry));
+}
+
+void SortExecutor::SortBuffer() {
+    order_.resize(buffer_.size());
+    std::iota(order_.begin(), order_.end(), 0);
+    std::stable_sort(order_.begin(), order_.end(),
+                     [this](uint32_t a, uint32_t b) { return Less(buffer_[a].keys_, buffer_[b].keys_); });
+}
+
+void SortExecutor::SpillBuffer() {
+    if (buffer_.empty()) {
+        return;
+    }
+    SortBuffer();
+    auto run = std::make_unique<SpillRun>(GetExecutorContext()->GetBufferPoolManager());
+    for (uint32_t i : order_) {
+        run->Append(buffer_[i].tuple_);
+    }
+    run->Finish();
+    GetExecutorContext()->GetQueryMemory()->RecordSpill(run->GetPageCount());
+    runs_.push_back(std::move(run));
+    buffer_.clear();
+    order_.clear();
+    GetExecutorContext()->GetQueryMemory()->Release(buffered_bytes_);
+    buffered_bytes_ = 0;
+}
+
+void SortExecutor::StartMerge(size_t first, size_t last) {
+    readers_.clear();
+    heads_.clear();
+    heap_.clear();
+    Tuple tuple;
+    for (size_t i = first; i < last; i++) {
+        readers_.push_back(std::make_unique<SpillRunReader>(runs_[i].get()));
+        heads_.emplace_back();
+        if (readers_.back()->Next(&tuple)) {
+            heads_.back() = MakeEntry(tuple);
+            heap_.push_back(heads_.size() - 1);
+        }
+    }
+    std::make_heap(heap_.begin(), heap_.end(), [this](size_t a, size_t b) { return HeadAfter(a, b); });
+}
+
+auto SortExecutor::HeadAfter(size_t a, size_t b) const -> bool {
+    return Less(heads_[b].keys_, heads_[a].keys_) || (!Less(heads_[a].keys_, heads_[b].keys_) && b < a);
+}
 
-void SortExecutor::Init() { throw NotImplementedException("SortExecutor is not implemented"); }
+auto SortExecutor::NextMerged(Tuple *tuple) -> bool {
+    auto greater = [this](size_t a, size_t b) { return HeadAfter(a, b); };
+    if (heap_.empty()) {
+        return false;
+    }
+    std::pop_heap(heap_.begin(), heap_.end(), greater);
+    size_t i = heap_.back();
+    heap_.pop_back();
+    *tuple = heads_[i].tuple_;
+    Tuple next;
+    if (readers_[i]->Next(&next)) {
+        heads_[i] = MakeEntry(next);
+        heap_.push_back(i);
+        std::push_heap(heap_.begin(), heap_.end(), greater);
+    }
+    return true;
+}
 
-auto SortExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+void SortExecutor::Reset() {
+    readers_.clear();
+    heads_.clear();
+    heap_.clear();
+    runs_.clear();
+    buffer_.clear();
+    order_.clear();
+    GetExecutorContext()->GetQueryMemory()->Release(buffered_bytes_);
+    buffered_bytes_ = 0;
+    pos_ = 0;
+}
 
 }  // namespace bustub
@@ -79,6 +79,7 @@ class CreateStatement;
 class ExplainStatement;
 class IndexStatement;
 class DeleteStatement;
+class CopyStatement;
 
 /**
  * The binder is responsible for transforming the Postgres parse tree to a binder tree
@@ -183,8 +184,14 @@ class Binder {
 
   auto BindIndex(duckdb_libpgquery::PGIndexStmt *stmt) -> std::unique_ptr<IndexStatement>;
 
+  /** Whether CREATE INDEX spells out USING. The parser fills in DEFAULT_INDEX_TYPE otherwise, so the
+   * parse node alone cannot tell `USING art` from no clause; the query text after the table name can. */
+  auto HasAccessMethodClause(duckdb_libpgquery::PGIndexStmt *stmt) const -> bool;
+
   auto BindDelete(duckdb_libpgquery::PGDeleteStmt *stmt) -> std::unique_ptr<DeleteStatement>;
 
+  auto BindCopy(duckdb_libpgquery::PGCopyStmt *stmt) -> std::unique_ptr<CopyStatement>;
+
   auto BindCTE(duckdb_libpgquery::PGWithClause *node) -> std::vector<std::unique_ptr<BoundSubqueryRef>>;
 
   auto BindVariableSet(duckdb_libpgquery::PGVariableSetStmt *stmt) -> std::unique_ptr<VariableSetStatement>;
@@ -240,6 +247,9 @@ class Binder {
   size_t universal_id_{0};
 
   duckdb::PostgresParser parser_;
+
+  /** The query text given to ParseAndSave, parse node locations are offsets into it */
+  std::string query_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,46 @@
+//===----------------------------------------------------------------------===//
+//                         BusTub
+//
+// binder/copy_statement.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "binder/bound_statement.h"
+#include "binder/table_ref/bound_base_table_ref.h"
+
+namespace duckdb_libpgquery {
+struct PGCopyStmt;
+}  // namespace duckdb_libpgquery
+
+namespace bustub {
+
+/** `COPY table FROM 'file' (FORMAT csv | binary, DELIMITER 'c', HEADER)`, see CopyFromFile */
+class CopyStatement : public BoundStatement {
+ public:
+  explicit CopyStatement(std::unique_ptr<BoundBaseTableRef> table, std::string file_path, std::string format,
+                         char delimiter, bool header);
+
+  /** Load into which table */
+  std::unique_ptr<BoundBaseTableRef> table_;
+
+  /** Path of the file, as seen by the server */
+  std::string file_path_;
+
+  /** `csv` (the default) or `binary` */
+  std::string format_;
+
+  /** Field delimiter of a csv file */
+  char delimiter_;
+
+  /** Whether the first record of a csv file is a header to skip */
+  bool header_;
+
+  auto ToString() const -> std::string override;
+};
+
+}  // namespace bustub
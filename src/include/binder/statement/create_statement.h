@@ -21,11 +21,14 @@ namespace bustub {
 
 class CreateStatement : public BoundStatement {
  public:
-  explicit CreateStatement(std::string table, std::vector<Column> columns);
+  explicit CreateStatement(std::string table, std::vector<Column> columns, std::string layout = "row");
 
   std::string table_;
   std::vector<Column> columns_;
 
+  /** Page layout, `WITH (layout = row)` (the default) or `WITH (layout = pax)` */
+  std::string layout_;
+
   auto ToString() const -> std::string override;
 };
 
@@ -25,7 +25,9 @@ namespace bustub {
 class IndexStatement : public BoundStatement {
  public:
   explicit IndexStatement(std::string index_name, std::unique_ptr<BoundBaseTableRef> table,
-                          std::vector<std::unique_ptr<BoundColumnRef>> cols);
+                          std::vector<std::unique_ptr<BoundColumnRef>> cols,
+                          std::vector<std::unique_ptr<BoundColumnRef>> include_cols = {},
+                          std::string index_type = "btree");
 
   /** Name of the index */
   std::string index_name_;
@@ -36,6 +38,12 @@ class IndexStatement : public BoundStatement {
   /** Name of the columns */
   std::vector<std::unique_ptr<BoundColumnRef>> cols_;
 
+  /** Columns stored in the index but not part of the key, `WITH (include = 'c1, c2')` */
+  std::vector<std::unique_ptr<BoundColumnRef>> include_cols_;
+
+  /** Access method, `USING btree` (the default) or `USING hash` */
+  std::string index_type_;
+
   auto ToString() const -> std::string override;
 };
 
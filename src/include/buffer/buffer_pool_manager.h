@@ -87,6 +87,9 @@ class BufferPoolManager {
   /** @return size of the buffer pool */
   virtual auto GetPoolSize() -> size_t = 0;
 
+  /** @return true if the page is in a frame, i.e. FetchPage would not read it from disk */
+  virtual auto IsPageResident(page_id_t page_id) -> bool = 0;
+
  protected:
   /**
    * Grading function. Do not modify!
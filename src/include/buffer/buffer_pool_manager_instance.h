@@ -49,6 +49,9 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /** @brief Return the size (number of frames) of the buffer pool. */
   auto GetPoolSize() -> size_t override { return pool_size_; }
 
+  /** @brief Check the page table only: no pin, no replacer access. */
+  auto IsPageResident(page_id_t page_id) -> bool override;
+
   /** @brief Return the pointer to all the pages in the buffer pool. */
   auto GetPages() -> Page * { return pages_; }
   void MyPrintData();
@@ -20,11 +20,16 @@
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
+#include "common/config.h"
 #include "container/hash/hash_function.h"
+#include "storage/index/art_index.h"
 #include "storage/index/b_plus_tree_index.h"
 #include "storage/index/extendible_hash_table_index.h"
 #include "storage/index/index.h"
+#include "storage/index/lsm_index.h"
+#include "storage/index/slotted_b_plus_tree_index.h"
 #include "storage/table/table_heap.h"
+#include "storage/table/table_vacuum.h"
 
 namespace bustub {
 
@@ -122,10 +127,11 @@ class Catalog {
    * @param table_name The name of the new table, note that all tables beginning with `__` are reserved for the system.
    * @param schema The schema of the new table
    * @param create_table_heap whether to create a table heap for the new table
+   * @param layout how the pages of the table heap store the tuples, `WITH (layout = pax)`
    * @return A (non-owning) pointer to the metadata for the table
    */
-  auto CreateTable(Transaction *txn, const std::string &table_name, const Schema &schema, bool create_table_heap = true)
-      -> TableInfo * {
+  auto CreateTable(Transaction *txn, const std::string &table_name, const Schema &schema, bool create_table_heap = true,
+                   TableLayout layout = TableLayout::ROW) -> TableInfo * {
     if (table_names_.count(table_name) != 0) {      // 已经有 "bustub" 表, 则无需创建
       return NULL_TABLE_INFO;
     }
@@ -137,7 +143,16 @@ class Catalog {
     // When create_table_heap == false, it means that we're running binder tests (where no txn will be provided) or
     // we are running shell without buffer pool. We don't need to create TableHeap in this case.
     if (create_table_heap) {
-      table = std::make_unique<TableHeap>(bpm_, lock_manager_, log_manager_, txn);
+      table = std::make_unique<TableHeap>(bpm_, lock_manager_, log_manager_, txn,
+                                          layout == TableLayout::PAX ? &schema : nullptr);
+      table->EnableZoneMap(schema);                 // seq scan 按谓词跳过页
+      table->EnableToast(schema);                   // 长的 VARCHAR 存到行外的溢出页链
+      if (enable_background_vacuum) {               // 后台整理删过的页, 摘掉空页; 默认关闭, 用 \vacuum
+        if (vacuum_ == nullptr) {
+          vacuum_ = std::make_unique<TableVacuum>();
+        }
+        vacuum_->AddTable(table.get());
+      }
     }
 
     // Fetch the table OID for the new table
@@ -197,29 +212,20 @@ class Catalog {
    * @param key_attrs Key attributes                  key属性
    * @param keysize Size of the key                   key 大小
    * @param hash_function The hash function for the index
+   * @param include_attrs Columns stored in the index entries after the key (covering index); keysize must fit them
    * @return A (non-owning) pointer to the metadata of the new table
    */
   template <class KeyType, class ValueType, class KeyComparator>
   auto CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name, const Schema &schema,
                    const Schema &key_schema, const std::vector<uint32_t> &key_attrs, std::size_t keysize,
-                   HashFunction<KeyType> hash_function) -> IndexInfo * {
-    // Reject the creation request for nonexistent table     要为词表创建index, 所以没有此表, 则返回
-    if (table_names_.find(table_name) == table_names_.end()) {
-      return NULL_INDEX_INFO;
-    }
-
-    // If the table exists, an entry for the table should already be present in index_names_ , 应该有index
-    BUSTUB_ASSERT((index_names_.find(table_name) != index_names_.end()), "Broken Invariant");
-
-    // Determine if the requested index already exists for this table   如果已经有了这个index, 则无需创建
-    auto &table_indexes = index_names_.find(table_name)->second;
-    if (table_indexes.find(index_name) != table_indexes.end()) {
-      // The requested index already exists for this table          // 拒绝已经存在的 index_name
+                   HashFunction<KeyType> hash_function, const std::vector<uint32_t> &include_attrs = {})
+      -> IndexInfo * {
+    if (!CanCreateIndex(index_name, table_name)) {
       return NULL_INDEX_INFO;
     }
 
     // Construct index metdata
-    auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs);    // 获取了 index meta
+    auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs, include_attrs);
 
     // Construct the index, take ownership of metadata
     // TODO(Kyle): We should update the API for CreateIndex
@@ -228,27 +234,100 @@ class Catalog {
 
     // TODO(chi): support both hash index and btree index         b+index         得到 b+ 树的 index
     auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
+    return AddIndex(txn, std::move(index), key_schema, keysize);
+  }
 
-    // Populate the index with all tuples in table heap    计算index
-    auto *table_meta = GetTable(table_name);
-    auto *heap = table_meta->table_.get();
-    for (auto tuple = heap->Begin(txn); tuple != heap->End(); ++tuple) {          // 遍历表的tuple, 将K:V插入 b+ 树; -> 重载过了, 返回tuple
-      index->InsertEntry(tuple->KeyFromTuple(schema, key_schema, key_attrs), tuple->GetRid(), txn);  // 将每个tuple 和 3 个入参生成新的 tuple
+  /**
+   * Create a new hash index (ExtendibleHashTableIndex), populate it and return its metadata.
+   * A hash index only answers point lookups (Index::ScanKey), see Index::IsOrdered.
+   * @param txn The transaction in which the index is being created
+   * @param index_name The name of the new index
+   * @param table_name The name of the table
+   * @param schema The schema of the table
+   * @param key_schema The schema of the key
+   * @param key_attrs Key attributes
+   * @param keysize Size of the key
+   * @param hash_function The hash function for the index
+   * @return A (non-owning) pointer to the metadata of the new index
+   */
+  template <class KeyType, class ValueType, class KeyComparator>
+  auto CreateHashIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
+                       const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs,
+                       std::size_t keysize, HashFunction<KeyType> hash_function) -> IndexInfo * {
+    if (!CanCreateIndex(index_name, table_name)) {
+      return NULL_INDEX_INFO;
     }
+    auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs);
+    auto index = std::make_unique<ExtendibleHashTableIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
+                                                                                               hash_function);
+    return AddIndex(txn, std::move(index), key_schema, keysize);
+  }
 
-    // Get the next OID for the new index                         获取index id
-    const auto index_oid = next_index_oid_.fetch_add(1);
-
-    // Construct index information; IndexInfo takes ownership of the Index itself    获取 indexinfo
-    auto index_info =
-        std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name, keysize);
-    auto *tmp = index_info.get();
+  /**
+   * Create a new in-memory adaptive radix tree index (CREATE INDEX ... USING art) over KeyEncoder-encoded keys.
+   * @param txn The transaction in which the index is being created
+   * @param index_name The name of the new index
+   * @param table_name The name of the table
+   * @param schema The schema of the table
+   * @param key_schema The schema of the key
+   * @param key_attrs Key attributes
+   * @return A (non-owning) pointer to the metadata of the new index, its key_size_ is 0
+   */
+  auto CreateArtIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
+                      const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs)
+      -> IndexInfo * {
+    if (!CanCreateIndex(index_name, table_name)) {
+      return NULL_INDEX_INFO;
+    }
+    auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs);
+    auto index = std::make_unique<ArtIndex>(std::move(meta));
+    return AddIndex(txn, std::move(index), key_schema, 0);
+  }
 
-    // Update internal tracking
-    indexes_.emplace(index_oid, std::move(index_info));             // 保存 索引 id - 索引 信息 index_info 映射
-    table_indexes.emplace(index_name, index_oid);                   // 保存 索引 名字 - 索引 id 映射, 保存在了 table_indexes 中
+  /**
+   * Create a new LSM-tree index (CREATE INDEX ... USING lsm) over KeyEncoder-encoded keys; its runs are written to
+   * pages of the buffer pool.
+   * @param txn The transaction in which the index is being created
+   * @param index_name The name of the new index
+   * @param table_name The name of the table
+   * @param schema The schema of the table
+   * @param key_schema The schema of the key
+   * @param key_attrs Key attributes
+   * @return A (non-owning) pointer to the metadata of the new index, its key_size_ is 0
+   */
+  auto CreateLsmIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
+                      const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs)
+      -> IndexInfo * {
+    if (!CanCreateIndex(index_name, table_name)) {
+      return NULL_INDEX_INFO;
+    }
+    auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs);
+    auto index = std::make_unique<LsmIndex>(std::move(meta), bpm_);
+    return AddIndex(txn, std::move(index), key_schema, 0);
+  }
 
-    return tmp;
+  /**
+   * Create a new index over variable-length keys (SlottedBPlusTreeIndex), populate it and return its metadata.
+   * Keys are encoded with KeyEncoder instead of being copied into a GenericKey<N>, so VARCHAR columns can be
+   * indexed without padding, and keys longer than a page slot go to overflow pages.
+   * @param txn The transaction in which the index is being created
+   * @param index_name The name of the new index
+   * @param table_name The name of the table
+   * @param schema The schema of the table
+   * @param key_schema The schema of the key
+   * @param key_attrs Key attributes
+   * @param unique Reject a second RID for an existing key
+   * @return A (non-owning) pointer to the metadata of the new index, its key_size_ is 0
+   */
+  auto CreateSlottedIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
+                          const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs,
+                          bool unique = false) -> IndexInfo * {
+    if (!CanCreateIndex(index_name, table_name)) {
+      return NULL_INDEX_INFO;
+    }
+    auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs);
+    auto index = std::make_unique<SlottedBPlusTreeIndex>(std::move(meta), bpm_, unique);
+    return AddIndex(txn, std::move(index), key_schema, 0);
   }
 
   /**
@@ -305,7 +384,7 @@ class Catalog {
    * @param index_oid The OID of the index for which to query
    * @return A (non-owning) pointer to the metadata for the index
    */
-  auto GetIndex(index_oid_t index_oid) -> IndexInfo * {
+  auto GetIndex(index_oid_t index_oid) const -> IndexInfo * {
     auto index = indexes_.find(index_oid);
     if (index == indexes_.end()) {
       return NULL_INDEX_INFO;
@@ -340,6 +419,11 @@ class Catalog {
 
     return indexes;
   }
+
+  /** @return the background vacuum of the table heaps, nullptr unless enable_background_vacuum was set when one
+   * was created */
+  auto GetVacuum() -> TableVacuum * { return vacuum_.get(); }
+
   //   /** Map table name -> table identifiers. */
   auto GetTableNames() -> std::vector<std::string> {
     std::vector<std::string> result;
@@ -350,6 +434,53 @@ class Catalog {
   }
 
  private:
+  /** false if the table does not exist or already has an index named index_name */
+  auto CanCreateIndex(const std::string &index_name, const std::string &table_name) -> bool {
+    // Reject the creation request for nonexistent table     要为词表创建index, 所以没有此表, 则返回
+    if (table_names_.find(table_name) == table_names_.end()) {
+      return false;
+    }
+
+    // If the table exists, an entry for the table should already be present in index_names_ , 应该有index
+    BUSTUB_ASSERT((index_names_.find(table_name) != index_names_.end()), "Broken Invariant");
+
+    // Determine if the requested index already exists for this table   如果已经有了这个index, 则无需创建
+    // The requested index already exists for this table          // 拒绝已经存在的 index_name
+    const auto &table_indexes = index_names_.find(table_name)->second;
+    return table_indexes.find(index_name) == table_indexes.end();
+  }
+
+  /** populate a newly constructed index with the tuples of its table and register it */
+  auto AddIndex(Transaction *txn, std::unique_ptr<Index> &&index, const Schema &key_schema, std::size_t keysize)
+      -> IndexInfo * {
+    const auto &index_name = index->GetName();
+    const auto &table_name = index->GetMetadata()->GetTableName();
+
+    // Populate the index with all tuples in table heap    计算index
+    // 插入的是索引项 (key 列 + include 列); 没有 include 列时就是 key
+    auto *table_meta = GetTable(table_name);
+    auto *heap = table_meta->table_.get();
+    const auto &entry_schema = *index->GetEntrySchema();
+    const auto &entry_attrs = index->GetEntryAttrs();
+    for (auto tuple = heap->Begin(txn); tuple != heap->End(); ++tuple) {          // 遍历表的tuple, 将K:V插入 b+ 树; -> 重载过了, 返回tuple
+      index->InsertEntry(tuple->KeyFromTuple(table_meta->schema_, entry_schema, entry_attrs), tuple->GetRid(), txn);
+    }
+
+    // Get the next OID for the new index                         获取index id
+    const auto index_oid = next_index_oid_.fetch_add(1);
+
+    // Construct index information; IndexInfo takes ownership of the Index itself    获取 indexinfo
+    auto index_info =
+        std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name, keysize);
+    auto *tmp = index_info.get();
+
+    // Update internal tracking
+    indexes_.emplace(index_oid, std::move(index_info));             // 保存 索引 id - 索引 信息 index_info 映射
+    index_names_[table_name].emplace(tmp->name_, index_oid);        // 保存 索引 名字 - 索引 id 映射, 保存在了 table_indexes 中
+
+    return tmp;
+  }
+
   [[maybe_unused]] BufferPoolManager *bpm_;
   [[maybe_unused]] LockManager *lock_manager_;
   [[maybe_unused]] LogManager *log_manager_;
@@ -379,6 +510,10 @@ class Catalog {
 
   /** The next index identifier to be used. */
   std::atomic<index_oid_t> next_index_oid_{0};
+
+  /** Background vacuum of the table heaps, started with the first one created while enable_background_vacuum is
+   * set; declared last so it stops before they go. */
+  std::unique_ptr<TableVacuum> vacuum_;
 };
 
 }  // namespace bustub
@@ -260,6 +260,9 @@ class BustubInstance {
  private:
   void CmdDisplayTables(ResultWriter &writer);
   void CmdDisplayIndices(ResultWriter &writer);
+  void CmdReindex(const std::string &index_name, ResultWriter &writer);
+  void CmdDisplayZoneMap(const std::string &table_name, ResultWriter &writer);
+  void CmdVacuum(const std::string &table_name, ResultWriter &writer);
   void CmdDisplayHelp(ResultWriter &writer);
   void WriteOneCell(const std::string &cell, ResultWriter &writer);
   std::unordered_map<std::string, std::string> session_variables_;
@@ -14,6 +14,7 @@
 
 #include <atomic>
 #include <chrono>  // NOLINT
+#include <cstddef>
 #include <cstdint>
 
 namespace bustub {
@@ -24,6 +25,15 @@ extern std::chrono::milliseconds cycle_detection_interval;
 /** True if logging should be enabled, false otherwise. */
 extern std::atomic<bool> enable_logging;
 
+/** Worker threads of a parallel sequential scan (see ParallelPageScan); 1 scans in the calling thread. */
+extern std::atomic<size_t> scan_workers;
+
+/** Bytes of operator state a query may hold in memory before its operators spill to disk (see QueryMemory). */
+extern std::atomic<size_t> query_memory_budget;
+
+/** True if Catalog::CreateTable hands new table heaps to a background TableVacuum; `\vacuum` works either way. */
+extern std::atomic<bool> enable_background_vacuum;
+
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
@@ -36,6 +46,7 @@ static constexpr int BUFFER_POOL_SIZE = 10;
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * BUSTUB_PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                               // size of extendible hash bucket
 static constexpr int LRUK_REPLACER_K = 10;  // lookback window for lru-k replacer
+static constexpr int CHANGE_BUFFER_SIZE = 1024;  // pending changes a b+ tree index buffers for non-resident leaves
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
@@ -0,0 +1,81 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// csv_reader.h
+//
+// Identification: src/include/common/util/csv_reader.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * Streaming CSV tokenizer (RFC 4180): fields separated by delimiter, records by \n or \r\n, a field in quotes may
+ * hold the delimiter, line breaks and doubled quotes. The file is read in large chunks and the fields are views into
+ * the chunk; only quoted fields with doubled quotes are copied. Unquoted fields are scanned 16 bytes at a time for
+ * the next delimiter, quote or line break with SSE2 when the target has it.
+ */
+class CsvReader {
+ public:
+  /** @throw Exception if the file cannot be opened */
+  explicit CsvReader(const std::string &path, char delimiter = ',', char quote = '"');
+
+  ~CsvReader();
+
+  DISALLOW_COPY_AND_MOVE(CsvReader);
+
+  /**
+   * Read the next record. The views stay valid until the next call.
+   * @return false at the end of the file
+   * @throw Exception if the record is malformed (a quote inside an unquoted field, text after a closing quote, a
+   * quote that is never closed)
+   */
+  auto NextRow(std::vector<std::string_view> *fields) -> bool;
+
+  /** @return true if field i of the last record was quoted, which tells "" (an empty string) from nothing (NULL) */
+  auto IsQuoted(size_t i) const -> bool { return fields_[i].quoted_; }
+
+ private:
+  static constexpr size_t CHUNK_SIZE = 1 << 20;
+
+  struct Field {
+    /** offset into buffer_, or into scratch_ if in_scratch_ */
+    size_t offset_;
+    size_t length_;
+    bool in_scratch_;
+    bool quoted_;
+  };
+
+  /** parse the record at begin_; false if it runs past the data read so far */
+  auto ParseRow() -> bool;
+  /** move the unread bytes to the front, growing the buffer if they fill it, and read more; false at end of file */
+  auto Fill() -> bool;
+  /** @return the first delimiter, quote, \n or \r in [p, end), or end */
+  auto FindSpecial(const char *p, const char *end) const -> const char *;
+
+  FILE *file_;
+  char delimiter_;
+  char quote_;
+  std::vector<char> buffer_;
+  /** the unread bytes are buffer_[begin_, end_) */
+  size_t begin_{0};
+  size_t end_{0};
+  bool eof_{false};
+  /** unescaped quoted fields of the current record */
+  std::string scratch_;
+  std::vector<Field> fields_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,119 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// adaptive_radix_tree.h
+//
+// Identification: src/include/container/art/adaptive_radix_tree.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+class ArtNode;
+
+template <typename ValueType>
+struct ArtLeaf;
+
+/**
+ * AdaptiveRadixTree is an in-memory radix tree over byte-string keys (Leis et al., "The Adaptive Radix Tree: ARTful
+ * Indexing for Main-Memory Databases"). It is the primer trie, one level per key byte, made compact enough to index
+ * with:
+ *  - inner nodes come in four layouts picked by fan-out: Node4 and Node16 keep sorted key bytes next to the children,
+ *    Node48 maps all 256 byte values to 48 child slots, Node256 is a plain array. A full node is copied into the next
+ *    bigger layout, one that falls well below the next smaller layout's capacity is copied back into it.
+ *  - path compression: bytes shared by every key below a node are stored once as the node's prefix instead of as a
+ *    chain of one-child nodes.
+ *  - lazy expansion: a leaf hangs below the first byte that tells its key apart from all other keys and carries the
+ *    whole key, which is compared once when the leaf is reached.
+ *
+ * Keys compare as unsigned bytes (std::string order). No key may be a proper prefix of another, KeyEncoder output
+ * followed by a fixed-width suffix never is; Insert refuses such a key.
+ *
+ * Concurrency is optimistic lock coupling (Leis et al., "The ART of Practical Synchronization"). Every inner node has a
+ * version word with a lock bit and an obsolete bit. Readers take no latch: they read the version before using a node
+ * and check it is unchanged afterwards, and start over from the root if it is not. A writer turns the versions of the
+ * nodes it modifies, at most the node and its parent (and the child it merges), into write locks, top-down, and starts
+ * over if one of them moved. Replaced nodes and removed leaves are marked obsolete and retired instead of freed, since
+ * a reader may still be looking at them; retired memory is released with the tree. The root is a Node256 that is
+ * never replaced.
+ *
+ * @tparam ValueType type of the value stored with each key
+ */
+template <typename ValueType>
+class AdaptiveRadixTree {
+ public:
+  AdaptiveRadixTree();
+
+  ~AdaptiveRadixTree();
+
+  DISALLOW_COPY_AND_MOVE(AdaptiveRadixTree);
+
+  /**
+   * @brief Insert key with value.
+   * @return false if the key is already present, or it is a proper prefix of a present key or the other way round
+   */
+  auto Insert(std::string_view key, const ValueType &value) -> bool;
+
+  /**
+   * @brief Remove key.
+   * @return false if the key is not present
+   */
+  auto Remove(std::string_view key) -> bool;
+
+  /**
+   * @brief Point lookup.
+   * @return true and the value in *value if the key is present
+   */
+  auto Find(std::string_view key, ValueType *value) const -> bool;
+
+  /**
+   * @brief Append the entries with low <= key < high to result, in key order. high = std::nullopt has no upper
+   * bound. A prefix scan is the range [prefix, Successor(prefix)).
+   */
+  void ScanRange(std::string_view low, std::optional<std::string_view> high,
+                 std::vector<std::pair<std::string, ValueType>> *result) const;
+
+  /** @return the smallest key greater than every key that starts with prefix, std::nullopt if there is none */
+  static auto Successor(std::string_view prefix) -> std::optional<std::string>;
+
+  /** @return the number of keys */
+  auto GetSize() const -> size_t { return size_.load(); }
+
+ private:
+  /** one attempt of each operation, std::nullopt means a version check failed and it has to start over */
+  auto TryInsert(std::string_view key, const ValueType &value) -> std::optional<bool>;
+  auto TryRemove(std::string_view key) -> std::optional<bool>;
+  auto TryFind(std::string_view key, ValueType *value) const -> std::optional<bool>;
+  /** scan below node, whose prefix starts at key byte depth; check_low / check_high say the bound still matters */
+  auto ScanNode(const ArtNode *node, size_t depth, std::string_view low, bool check_low,
+                std::optional<std::string_view> high, bool check_high,
+                std::vector<std::pair<std::string, ValueType>> *result) const -> bool;
+
+  void Retire(ArtNode *node);
+  void FreeSubtree(ArtNode *node);
+
+  /** Node256, never replaced */
+  ArtNode *root_;
+  std::atomic<size_t> size_{0};
+  /** unlinked nodes (leaves are tagged pointers), freed in the destructor */
+  std::mutex retired_latch_;
+  std::vector<ArtNode *> retired_;
+};
+
+}  // namespace bustub
@@ -30,6 +30,12 @@ namespace bustub {
  * Implementation of extendible hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table grows/shrinks dynamically as buckets become full/empty.
+ *
+ * Concurrency: there is no table-wide latch. Lookups, inserts and removes latch only the page of their bucket (read
+ * or write mode) and take the directory page latch in read mode for a few instructions, to map the key and then to
+ * check the mapping version once the bucket is latched. A split or merge holds the write latches of the buckets it
+ * touches and write-latches the directory only to rewrite the affected slots. Latches are always taken bucket before
+ * directory, and two buckets in page id order.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class DiskExtendibleHashTable {
@@ -122,19 +128,46 @@ class DiskExtendibleHashTable {
   auto KeyToPageId(KeyType key, HashTableDirectoryPage *dir_page) -> page_id_t;
 
   /**
-   * Fetches the directory page from the buffer pool manager.
+   * Fetches a page from the buffer pool manager.
    *
-   * @return a pointer to the directory page
+   * @param page_id the page_id to fetch
+   * @return the pinned page
+   * @throw Exception if the buffer pool has no frame to spare
    */
-  auto FetchDirectoryPage() -> HashTableDirectoryPage *;
+  auto FetchPage(page_id_t page_id) -> Page *;
+
+  /** @return the directory stored in page */
+  static auto AsDirectory(Page *page) -> HashTableDirectoryPage * {
+    return reinterpret_cast<HashTableDirectoryPage *>(page->GetData());
+  }
+
+  /** @return the bucket stored in page */
+  static auto AsBucket(Page *page) -> HASH_TABLE_BUCKET_TYPE * {
+    return reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+  }
 
   /**
-   * Fetches the a bucket page from the buffer pool manager using the bucket's page_id.
+   * Pins and latches the bucket the key maps to. The directory is only read-latched to look up the bucket and, once
+   * the bucket is latched, to check that the directory version is unchanged or still maps the key to it; otherwise
+   * a concurrent split or merge moved the key and the lookup is retried.
    *
-   * @param bucket_page_id the page_id to fetch
-   * @return a pointer to a bucket page
+   * @param key the key to look up
+   * @param exclusive write latch the bucket if true, read latch it otherwise
+   * @return the pinned and latched bucket page
    */
-  auto FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BUCKET_TYPE *;
+  auto LatchBucket(const KeyType &key, bool exclusive) -> Page *;
+
+  /** Unlatches and unpins a page returned by LatchBucket. */
+  void ReleaseBucket(Page *bucket_page, bool exclusive, bool is_dirty);
+
+  /**
+   * Splits a full bucket by its next hash bit into a new page, growing the directory if needed.
+   *
+   * @param bucket_page the write-latched bucket page
+   * @param key a key mapping to the bucket
+   * @return false if the bucket cannot be split, i.e. the directory is at its maximum size
+   */
+  auto SplitBucket(Page *bucket_page, const KeyType &key) -> bool;
 
   /**
    * Performs insertion with an optional bucket splitting.
@@ -151,10 +184,13 @@ class DiskExtendibleHashTable {
    * if Remove makes a bucket empty.
    *
    * There are three conditions under which we skip the merge:
-   * 1. The bucket is no longer empty.
+   * 1. Neither the bucket nor its split image is empty.
    * 2. The bucket has local depth 0.
    * 3. The bucket's local depth doesn't match its split image's local depth.
    *
+   * After a merge the merged bucket is checked against its own split image the same way, so an empty bucket left
+   * behind by condition 3 is folded in once its pair has merged back to the same depth.
+   *
    * @param transaction a pointer to the current transaction
    * @param key the key that was removed
    * @param value the value that was removed
@@ -166,8 +202,6 @@ class DiskExtendibleHashTable {
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
 
-  // Readers includes inserts and removes, writers are splits and merges
-  ReaderWriterLatch table_latch_;
   HashFunction<KeyType> hash_fn_;
 };
 
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <functional>
 #include <queue>
 #include <string>
 #include <vector>
@@ -30,6 +31,11 @@ namespace bustub {
  * Implementation of linear probing hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table dynamically grows once full.
+ *
+ * Growing is incremental: a doubling only allocates the new block array, and the old array stays alongside it.
+ * Every insert and remove then moves the next few slots of the old array (SetMigrationBatch) before doing its own
+ * work, so no single operation pays for rehashing the whole table. Until the old array is drained, lookups and removes
+ * probe both arrays, inserts check both for duplicates and go to the new one.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class LinearProbeHashTable {
@@ -84,10 +90,51 @@ class LinearProbeHashTable {
    */
   auto GetSize() -> size_t;
 
+  /**
+   * Sets how many old slots each insert or remove migrates while the table is growing.
+   * @param slots slots per operation, 0 rehashes the whole table at once when it grows
+   */
+  void SetMigrationBatch(size_t slots);
+
+  /** @return true while an old block array is still being drained */
+  auto IsMigrating() -> bool;
+
  private:
-  auto GetHeaderPage() -> HashTableHeaderPage *;
-  auto GetBlockPage(page_id_t block_page_id) -> HASH_TABLE_BLOCK_TYPE *;
+  /** Slots migrated per insert or remove by default, about a tenth of a block page of 8 byte pairs. */
+  static constexpr size_t DEFAULT_MIGRATION_BATCH = 64;
+  /** All block page ids of an array live in its header page. */
+  static constexpr size_t MAX_NUM_SLOTS = HashTableHeaderPage::MAX_NUM_BLOCKS * BLOCK_ARRAY_SIZE;
+
+  auto FetchPage(page_id_t page_id) -> Page *;
+  static auto AsHeader(Page *page) -> HashTableHeaderPage * {
+    return reinterpret_cast<HashTableHeaderPage *>(page->GetData());
+  }
+  static auto AsBlock(Page *page) -> HASH_TABLE_BLOCK_TYPE * {
+    return reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData());
+  }
+
+  /**
+   * Linear probe of one block array from the home slot of key, until a never occupied slot or a full lap.
+   * @param visit called on every readable slot holding key, returns true to stop the probe; if empty, the probe
+   * stops at the first free slot instead
+   * @param dirty whether visit may modify the blocks
+   * @return the first slot on the way that can take a new pair (free or tombstone), or the array size if none
+   */
+  auto Probe(page_id_t header_page_id, const KeyType &key, bool dirty,
+             const std::function<bool(HASH_TABLE_BLOCK_TYPE *, slot_offset_t)> &visit) -> size_t;
+
+  /** Stores key and value in slot of the current array. */
+  void InsertAt(size_t slot, const KeyType &key, const ValueType &value);
+
+  /** Stores key and value in the first free slot of the array of header_page, without a duplicate check. */
   void ResizeInsert(HashTableHeaderPage *header_page, const KeyType &key, const ValueType &value);
+
+  /** Makes a fresh array of num_slots the current one; the previous array is migrated from then on. */
+  void StartResize(size_t num_slots);
+
+  /** Moves up to max_slots slots of the old array into the current one, and frees the old array once drained. */
+  void MigrateSlots(size_t max_slots);
+
   void DeleteBlockPages(HashTableHeaderPage *old_header_page);
   void CreateNewBlockPages(HashTableHeaderPage *header_page, size_t num_blocks);
   auto GetValueLatchFree(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool;
@@ -97,7 +144,18 @@ class LinearProbeHashTable {
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
 
-  // Readers includes inserts and removes, writer is only resize
+  // number of slots of the current array, and how many of them are occupied (pairs and tombstones)
+  size_t size_;
+  size_t num_occupied_{0};
+  // the array being drained, INVALID_PAGE_ID when not growing; its slots below migrate_cursor_ are empty
+  page_id_t old_header_page_id_{INVALID_PAGE_ID};
+  size_t old_size_{0};
+  size_t migrate_cursor_{0};
+  size_t migration_batch_{DEFAULT_MIGRATION_BATCH};
+  // live pairs in both arrays
+  size_t num_entries_{0};
+
+  // Readers are lookups; inserts and removes write, since each of them also migrates old slots
   ReaderWriterLatch table_latch_;
 
   // Hash function
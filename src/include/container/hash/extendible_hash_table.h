@@ -17,7 +17,8 @@
 
 #pragma once
 
-#include <list>
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <mutex>  // NOLINT
 #include <utility>
@@ -30,6 +31,18 @@ namespace bustub {
 /**
  * ExtendibleHashTable implements a hash table using the extendible hashing algorithm.
  * 使用扩展hash算法, 实现hash表
+ *
+ * Buckets are flat fixed-capacity arrays, allocated together in one block when the bucket is created: a tag array
+ * holding 8 bits of a remixed hash per entry, then the keys, then the values. A lookup compares 16 tags at a time (SSE2
+ * when the target has it) and only reads the keys whose tag matched. Entries are kept dense at the front of the arrays,
+ * a remove moves the last entry into the hole.
+ *
+ * Buckets are owned by buckets_ and never freed before the table, and a doubled directory keeps the old one alive in
+ * dirs_, so a pointer read from any directory stays dereferenceable. Every bucket has its own latch and knows the hash
+ * bits it covers (local depth + pattern). Find, Remove and Insert read the directory without a latch, latch the bucket
+ * it names and check that the bucket still covers the hash, retrying otherwise. A split runs under the latch of the
+ * full bucket and dir_latch_, which serializes directory writers; dir_latch_ is always taken after a bucket latch.
+ *
  * @tparam K key type
  * @tparam V value type
  */
@@ -37,9 +50,6 @@ template <typename K, typename V>
 class ExtendibleHashTable : public HashTable<K, V> {
  public:
   /**
-   *
-   * TODO(P1): Add implementation
-   *
    * @brief Create a new ExtendibleHashTable.   创建
    * @param bucket_size: fixed size for each bucket
    */
@@ -65,9 +75,6 @@ class ExtendibleHashTable : public HashTable<K, V> {
   auto GetNumBuckets() const -> int;
 
   /**
-   *
-   * TODO(P1): Add implementation
-   *
    * @brief Find the value associated with the given key.  获取值
    *
    * Use IndexOf(key) to find the directory index the key hashes to.
@@ -79,9 +86,6 @@ class ExtendibleHashTable : public HashTable<K, V> {
   auto Find(const K &key, V &value) -> bool override;
 
   /**
-   *
-   * TODO(P1): Add implementation
-   *
    * @brief Insert the given key-value pair into the hash table.   插入
    * If a key already exists, the value should be updated.
    * If the bucket is full and can't be inserted, do the following steps before retrying:
@@ -96,9 +100,6 @@ class ExtendibleHashTable : public HashTable<K, V> {
   void Insert(const K &key, const V &value) override;
 
   /**
-   *
-   * TODO(P1): Add implementation
-   *
    * @brief Given the key, remove the corresponding key-value pair in the hash table.  删除
    * Shrink & Combination is not required for this project
    * @param key The key to be deleted.
@@ -108,104 +109,137 @@ class ExtendibleHashTable : public HashTable<K, V> {
 
   /**
    * Bucket class for each hash table bucket that the directory points to.   目录指向
+   * Every lookup passes the full hash of the key along, the bucket takes its tag from it.
    */
   class Bucket {
    public:
-    explicit Bucket(size_t size, int depth = 0);
+    explicit Bucket(size_t size, int depth = 0, size_t pattern = 0);
+    ~Bucket();
 
     /** @brief Check if a bucket is full. */
-    inline auto IsFull() const -> bool { return list_.size() == size_; }
+    inline auto IsFull() const -> bool { return count_ == size_; }
 
     /** @brief Get the local depth of the bucket. */
     inline auto GetDepth() const -> int { return depth_; }
 
-    /** @brief Increment the local depth of a bucket. */
-    inline void IncrementDepth() { depth_++; }
+    /** @brief Get the low local depth bits shared by every hash in the bucket. */
+    inline auto GetPattern() const -> size_t { return pattern_; }
+
+    /** @brief Get the number of entries in the bucket. */
+    inline auto Size() const -> size_t { return count_; }
+
+    /** @brief Whether the bucket holds the keys with this hash, the bucket latch must be held. */
+    inline auto Covers(size_t hash) const -> bool {
+      return (hash & ((static_cast<size_t>(1) << depth_) - 1)) == pattern_;
+    }
 
-    inline auto GetItems() -> std::list<std::pair<K, V>> & { return list_; }
+    /** @brief The bucket latch, a directory writer takes dir_latch_ only after it. */
+    inline auto GetLatch() -> std::mutex & { return latch_; }
 
     /**
-     *
-     * TODO(P1): Add implementation
-     *
      * @brief Find the value associated with the given key in the bucket.   找到这个key的value
      * @param key The key to be searched.
+     * @param hash std::hash of the key
      * @param[out] value The value associated with the key.
      * @return True if the key is found, false otherwise.
      */
-    auto Find(const K &key, V &value) -> bool;
+    auto Find(const K &key, size_t hash, V &value) const -> bool;
 
     /**
-     *
-     * TODO(P1): Add implementation
-     *
      * @brief Given the key, remove the corresponding key-value pair in the bucket.
      * @param key The key to be deleted.
+     * @param hash std::hash of the key
      * @return True if the key exists, false otherwise.
      */
-    auto Remove(const K &key) -> bool;
+    auto Remove(const K &key, size_t hash) -> bool;
 
     /**
-     *
-     * TODO(P1): Add implementation
-     *
      * @brief Insert the given key-value pair into the bucket.
      *      1. If a key already exists, the value should be updated.   如果值存在, 则更新
      *      2. If the bucket is full, do nothing and return false.     如果满了, 则false
      * @param key The key to be inserted.
+     * @param hash std::hash of the key
      * @param value The value to be inserted.
      * @return True if the key-value pair is inserted, false otherwise.
      */
-    auto Insert(const K &key, const V &value) -> bool;
+    auto Insert(const K &key, size_t hash, const V &value) -> bool;
 
-    auto IndexV(const K &key) -> size_t ;
-
-    auto GetTwoIndexByDepth(const K &key, int depth , int &id0, int &id1) -> void;
+    /**
+     * @brief Increment the local depth and move the entries whose hash has the new bit set into image, an empty
+     * bucket with the same depth and the new bit set in its pattern.   分裂: 搬走这一位为 1 的 kv
+     */
+    void SplitInto(Bucket *image);
 
-    auto PrintData() -> void;
+    auto PrintData() const -> void;
 
    private:
-    // TODO(student): You may add additional private members and helper functions
-    size_t size_;
-    int depth_;
-    std::list<std::pair<K, V>> list_;
+    /** tags are compared TAG_GROUP at a time, the tag array is padded to a multiple of it */
+    static constexpr size_t TAG_GROUP = 16;
+
+    /** 8 bits of the hash for the tag array, remixed so that identity hashes of small ints still differ */
+    static inline auto TagOf(size_t hash) -> uint8_t {
+      return static_cast<uint8_t>((static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ULL) >> 56);
+    }
+
+    /** @return the slot holding key, or size_ if it is not in the bucket */
+    auto SlotOf(const K &key, uint8_t tag) const -> size_t;
+
+    /** move the last entry into slot */
+    void EraseAt(size_t slot);
+
+    size_t size_;      // capacity
+    int depth_;        // local depth
+    size_t pattern_;   // the low depth_ bits of every hash in the bucket
+    size_t count_{0};  // entries live in [0, count_)
+    std::unique_ptr<char[]> data_;  // one block for the three arrays below
+    uint8_t *tags_;
+    K *keys_;
+    V *values_;
+    std::mutex latch_;
   };
 
-  auto GetDir() -> std::vector<std::shared_ptr<Bucket>> {
-    return dir_;
-  }
+  /** @brief A copy of the directory, for tests */
+  auto GetDir() const -> std::vector<Bucket *>;
 
  private:
-  // TODO(student): You may add additional private members and helper functions and remove the ones
-  // you don't need.
-  int global_depth_;    // The global depth of the directory   全局深度
-  size_t bucket_size_;  // The size of a bucket                bucket大小
-  int num_buckets_;     // The number of buckets in the hash table  输血量
-  mutable std::mutex latch_;
-  std::vector<std::shared_ptr<Bucket>> dir_;  // The directory of the hash table 目录
+  /** the directory, 2^global_depth_ bucket pointers; a doubling publishes a new one */
+  struct Directory {
+    explicit Directory(int global_depth)
+        : global_depth_(global_depth), slots_(new std::atomic<Bucket *>[static_cast<size_t>(1) << global_depth]) {}
+
+    inline auto Size() const -> size_t { return static_cast<size_t>(1) << global_depth_; }
+
+    int global_depth_;
+    std::unique_ptr<std::atomic<Bucket *>[]> slots_;
+  };
 
-  // The following functions are completely optional, you can delete them if you have your own ideas.
+  size_t bucket_size_;                            // The size of a bucket                bucket大小
+  int num_buckets_;                               // The number of buckets in the hash table  桶数量
+  std::atomic<Directory *> dir_;                  // The directory of the hash table 目录
+  mutable std::mutex dir_latch_;                  // serializes splits, protects num_buckets_, dirs_ and buckets_
+  std::vector<std::unique_ptr<Directory>> dirs_;  // every directory published so far, readers may hold old ones
+  std::vector<std::unique_ptr<Bucket>> buckets_;  // owns every bucket, buckets are never freed before the table
 
   /**
-   * @brief Redistribute the kv pairs in a full bucket.        重分发kv
-   * @param bucket The bucket to be redistributed.
+   * @brief Latch and return the bucket covering hash.
+   * @param[out] lock takes the bucket latch
    */
-  auto RedistributeBucket(std::shared_ptr<Bucket> bucket, size_t dirId) -> void;
+  auto LatchBucket(size_t hash, std::unique_lock<std::mutex> *lock) const -> Bucket *;
 
-  /*****************************************************************
-   * Must acquire latch_ first before calling the below functions. *
-   *****************************************************************/
+  /**
+   * @brief Split a full bucket and redistribute its kv pairs, the bucket latch must be held.        重分发kv
+   * @param bucket The bucket to be redistributed.
+   */
+  auto RedistributeBucket(Bucket *bucket) -> void;
 
   /**
-   * @brief For the given key, return the entry index in the directory where the key hashes to.
-   * @param key The key to be hashed.
+   * @brief For the given hash, return the entry index in the directory where the key hashes to.
+   * @param hash std::hash of the key.
    * @return The entry index in the directory.    dir 的index
    */
-  auto IndexOf(const K &key) -> size_t;
-
-  auto GetGlobalDepthInternal() const -> int;
-  auto GetLocalDepthInternal(int dir_index) const -> int;
-  auto GetNumBucketsInternal() const -> int;
+  static auto IndexOf(const Directory *dir, size_t hash) -> size_t {
+    return hash & ((static_cast<size_t>(1) << dir->global_depth_) - 1);
+  }
 };
 
 }  // namespace bustub
@@ -0,0 +1,48 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// copy_from.h
+//
+// Identification: src/include/execution/copy_from.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/catalog.h"
+#include "concurrency/transaction.h"
+
+namespace bustub {
+
+/** how CopyFromFile reads the file */
+struct CopyFromOptions {
+  /** binary: every row is a uint32 length followed by the bytes of the tuple (what Tuple::SerializeTo writes) */
+  bool binary_{false};
+  /** csv: field delimiter */
+  char delimiter_{','};
+  /** csv: skip the first record */
+  bool header_{false};
+};
+
+/**
+ * COPY table FROM file. The rows are parsed straight into the tuple format and appended to new pages by a
+ * TableBulkLoader, without going through the planner, InsertExecutor or TableHeap::InsertTuple. Once every row is in,
+ * the pages are linked into the table and each index gets the new entries in large sorted batches (InsertEntries).
+ *
+ * In a csv file an unquoted empty field is NULL and a quoted one ("") is an empty string; booleans are true/false,
+ * t/f or 1/0.
+ *
+ * @return the number of rows loaded
+ * @throw Exception naming the row if the file cannot be read or a row does not fit the schema of the table; the
+ * table is left as it was
+ */
+auto CopyFromFile(BufferPoolManager *bpm, Catalog *catalog, TableInfo *table_info, const std::string &path,
+                  const CopyFromOptions &options, Transaction *txn) -> size_t;
+
+}  // namespace bustub
@@ -17,7 +17,9 @@
 #include <vector>
 
 #include "catalog/catalog.h"
+#include "common/config.h"
 #include "concurrency/transaction.h"
+#include "execution/query_memory.h"
 #include "storage/page/tmp_tuple_page.h"
 
 namespace bustub {
@@ -36,7 +38,12 @@ class ExecutorContext {
    */
   ExecutorContext(Transaction *transaction, Catalog *catalog, BufferPoolManager *bpm, TransactionManager *txn_mgr,
                   LockManager *lock_mgr)
-      : transaction_(transaction), catalog_{catalog}, bpm_{bpm}, txn_mgr_(txn_mgr), lock_mgr_(lock_mgr) {}
+      : transaction_(transaction),
+        catalog_{catalog},
+        bpm_{bpm},
+        txn_mgr_(txn_mgr),
+        lock_mgr_(lock_mgr),
+        memory_(query_memory_budget) {}
 
   ~ExecutorContext() = default;
 
@@ -60,6 +67,9 @@ class ExecutorContext {
   /** @return the transaction manager */
   auto GetTransactionManager() -> TransactionManager * { return txn_mgr_; }
 
+  /** @return the memory budget of the query; operators that go over it spill */
+  auto GetQueryMemory() -> QueryMemory * { return &memory_; }
+
  private:
   /** The transaction context associated with this executor context */
   Transaction *transaction_;
@@ -71,6 +81,8 @@ class ExecutorContext {
   TransactionManager *txn_mgr_;
   /** The lock manager associated with this executor context */
   LockManager *lock_mgr_;
+  /** The memory budget of the query, taken from query_memory_budget when the query starts */
+  QueryMemory memory_;
 };
 
 }  // namespace bustub
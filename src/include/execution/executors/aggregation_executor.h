@@ -17,17 +17,23 @@
 #include <utility>
 #include <vector>
 
+#include "common/macros.h"
 #include "common/util/hash_util.h"
 #include "container/hash/hash_function.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/aggregation_plan.h"
+#include "execution/query_memory.h"
+#include "storage/table/spill_run.h"
 #include "storage/table/tuple.h"
 #include "type/value_factory.h"
 
 namespace bustub {
 
+/** spill partitions an AggregationExecutor pass splits the groups that do not fit in the memory budget into */
+static constexpr size_t AGGREGATION_SPILL_PARTITIONS = 8;
+
 /**
  * A simplified hash table that has all the necessary functionality for aggregations.
  * 具有聚合所需的所有功能的简化哈希表。
@@ -43,6 +49,18 @@ class SimpleAggregationHashTable {
                              const std::vector<AggregationType> &agg_types)
       : agg_exprs_{agg_exprs}, agg_types_{agg_types} {}
 
+  /**
+   * Construct a hash table whose groups are counted in a memory budget (see TryInsertCombine).
+   * @param memory the budget of the query, must outlive the table
+   */
+  SimpleAggregationHashTable(const std::vector<AbstractExpressionRef> &agg_exprs,
+                             const std::vector<AggregationType> &agg_types, QueryMemory *memory)
+      : agg_exprs_{agg_exprs}, agg_types_{agg_types}, memory_{memory} {}
+
+  ~SimpleAggregationHashTable() { Clear(); }
+
+  DISALLOW_COPY_AND_MOVE(SimpleAggregationHashTable);
+
   /** @return The initial aggregrate value for this aggregation executor */
   // GenerateInitialAggregateValue 函数改造
   auto GenerateInitialAggregateValue() -> AggregateValue {
@@ -123,10 +141,39 @@ class SimpleAggregationHashTable {
     CombineAggregateValues(&ht_[agg_key], agg_val);
   }
 
+  /**
+   * InsertCombine, unless the key is a new group that does not fit in the memory budget. The first group always
+   * goes in, so an empty table makes progress whatever the budget.
+   * @return false if the key was not inserted; the caller keeps the input for a later pass
+   */
+  auto TryInsertCombine(const AggregateKey &agg_key, const AggregateValue &agg_val) -> bool {
+    auto it = ht_.find(agg_key);
+    if (it == ht_.end()) {
+      size_t bytes = GroupBytes(agg_key);
+      if (memory_ != nullptr) {
+        if (ht_.empty()) {
+          memory_->Reserve(bytes);
+        } else if (!memory_->TryReserve(bytes)) {
+          return false;
+        }
+      }
+      reserved_bytes_ += bytes;
+      it = ht_.insert({agg_key, GenerateInitialAggregateValue()}).first;
+    }
+    CombineAggregateValues(&it->second, agg_val);
+    return true;
+  }
+
   /**
    * Clear the hash table
    */
-  void Clear() { ht_.clear(); }
+  void Clear() {
+    ht_.clear();
+    if (memory_ != nullptr) {
+      memory_->Release(reserved_bytes_);
+    }
+    reserved_bytes_ = 0;
+  }
 
   /** An iterator over the aggregation hash table */
   class Iterator {
@@ -164,6 +211,18 @@ class SimpleAggregationHashTable {
   auto End() -> Iterator { return Iterator{ht_.cend()}; }
 
  private:
+  /** @return the bytes a group is counted for in the memory budget: the node, the values, and varchar bytes */
+  auto GroupBytes(const AggregateKey &agg_key) const -> size_t {
+    size_t bytes = sizeof(std::pair<const AggregateKey, AggregateValue>) + 2 * sizeof(void *) +
+                   (agg_key.group_bys_.size() + agg_types_.size()) * sizeof(Value);
+    for (const auto &key : agg_key.group_bys_) {
+      if (key.GetTypeId() == TypeId::VARCHAR && !key.IsNull()) {
+        bytes += key.GetLength();
+      }
+    }
+    return bytes;
+  }
+
   /** The hash table is just a map from aggregate keys to aggregate values */
   std::unordered_map<AggregateKey, AggregateValue> ht_{};
   /** The aggregate expressions that we have */
@@ -172,11 +231,19 @@ class SimpleAggregationHashTable {
   /** The types of aggregations that we have */
   // 聚合类型
   const std::vector<AggregationType> &agg_types_;
+  /** The budget the groups are counted in, nullptr for none */
+  QueryMemory *memory_{nullptr};
+  size_t reserved_bytes_{0};
 };
 
 /**
  * AggregationExecutor executes an aggregation operation (e.g. COUNT, SUM, MIN, MAX)
  * over the tuples produced by a child executor.
+ *
+ * The groups are counted in the memory budget of the query (see QueryMemory). Once a new group does not fit, the
+ * input tuples of the groups not in the hash table are written to AGGREGATION_SPILL_PARTITIONS SpillRuns by the hash
+ * of their group; a group is then either all in memory or all in one partition. The groups in memory are emitted
+ * first, then every partition is aggregated on its own in a later pass, partitioned again if it does not fit either.
  */
 class AggregationExecutor : public AbstractExecutor {
  public:
@@ -189,6 +256,8 @@ class AggregationExecutor : public AbstractExecutor {
   AggregationExecutor(ExecutorContext *exec_ctx, const AggregationPlanNode *plan,
                       std::unique_ptr<AbstractExecutor> &&child);
 
+  ~AggregationExecutor() override;
+
   /** Initialize the aggregation */
   void Init() override;
 
@@ -227,6 +296,15 @@ class AggregationExecutor : public AbstractExecutor {
     return {vals};
   }
 
+  /** aggregate a tuple of the child, or write it to the spill partition of its group for the pass after level */
+  void Aggregate(const Tuple &tuple, size_t level);
+
+  /** hand the spill partitions written during a pass to pending_ */
+  void FinishPartitions(size_t level);
+
+  /** drop the state of the last Init */
+  void Reset();
+
  private:
   /** The aggregation plan node */
   const AggregationPlanNode *plan_;
@@ -236,5 +314,9 @@ class AggregationExecutor : public AbstractExecutor {
   SimpleAggregationHashTable aht_;
   /** Simple aggregation hash table iterator */
   SimpleAggregationHashTable::Iterator aht_iterator_;
+  /** the spill partitions of the pass being run, created on first use */
+  std::vector<std::unique_ptr<SpillRun>> partitions_;
+  /** the partitions still to aggregate, and the pass that wrote them */
+  std::vector<std::pair<std::unique_ptr<SpillRun>, size_t>> pending_;
 };
 }  // namespace bustub
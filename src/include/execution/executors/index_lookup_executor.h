@@ -0,0 +1,54 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// index_lookup_executor.h
+//
+// Identification: src/include/execution/executors/index_lookup_executor.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "common/rid.h"
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/plans/index_lookup_plan.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * IndexLookupExecutor probes an index once per key of the plan and fetches the matching tuples from the table heap.
+ */
+class IndexLookupExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Creates a new index lookup executor.
+   * @param exec_ctx the executor context
+   * @param plan the index lookup plan to be executed
+   */
+  IndexLookupExecutor(ExecutorContext *exec_ctx, const IndexLookupPlanNode *plan);
+
+  auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
+
+  void Init() override;
+
+  auto Next(Tuple *tuple, RID *rid) -> bool override;
+
+ private:
+  const IndexLookupPlanNode *plan_;
+  Index *index_{nullptr};
+  TableHeap *table_heap_{nullptr};
+  /** the next key of the plan to probe */
+  size_t next_key_{0};
+  /** the rids of the last probe, rids_[next_rid_..] are not fetched yet */
+  std::vector<RID> rids_;
+  size_t next_rid_{0};
+};
+
+}  // namespace bustub
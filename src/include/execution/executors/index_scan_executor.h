@@ -12,12 +12,17 @@
 
 #pragma once
 
+#include <functional>
+#include <optional>
 #include <vector>
 
 #include "common/rid.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/index_scan_plan.h"
+#include "storage/index/art_index.h"
+#include "storage/index/lsm_index.h"
+#include "storage/index/slotted_b_plus_tree_index.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -45,10 +50,22 @@ class IndexScanExecutor : public AbstractExecutor {
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
  private:
+  /** 按索引项的大小实例化 b+ 树的范围迭代器, 包成 cursor_ */
+  template <size_t KeySize>
+  void InitCursor(Index *index);
+  /** varchar 索引 (slotted b+ 树): 在编码后的 key 上按范围扫描 */
+  void InitSlottedCursor(SlottedBPlusTreeIndex *index);
+  /** art 索引: 一次取出范围内的项, 按顺序吐出 */
+  void InitArtCursor(ArtIndex *index);
+  /** lsm 索引: 正序直接走合并迭代器, 倒序先取出来 */
+  void InitLsmCursor(LsmIndex *index);
+
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
-  BPlusTreeIndexForOneIntegerColumn *tree_;
   TableHeap *tHeap_;
-  BPlusTreeIndexIteratorForOneIntegerColumn indexIter_;
+  Schema *entrySchema_;                   // 索引项 = key 列 + include 列
+  std::vector<int> entryColOfTable_;      // 表的第 i 列在索引项里的位置, -1 表示不在索引里
+  // 取下一个索引项 (key + include 列, entry 为 nullptr 时不解) 和 rid, 没有了返回 false
+  std::function<bool(Tuple *entry, RID *rid)> cursor_;
 };
 }  // namespace bustub
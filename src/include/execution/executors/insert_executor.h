@@ -54,7 +54,8 @@ class InsertExecutor : public AbstractExecutor {
   /** @return The output schema for the insert */     // 插入的输出schema
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); };
 
-  void Insert(Tuple *tuple, RID *rid);
+  // 插入子计划的全部 tuple, 索引按批插入
+  void InsertAll();
 
  private:
   /** The insert plan node to be executed*/
@@ -63,6 +64,10 @@ class InsertExecutor : public AbstractExecutor {
 
   std::unique_ptr<AbstractExecutor> child_executor_;
   std::vector<IndexInfo *> indexes_;
+
+  std::vector<std::pair<Tuple, RID>> rows_;   // 已插入的行, Next 依次返回
+  size_t cursor_{0};
+  bool inserted_{false};
 };
 
 }  // namespace bustub
@@ -12,11 +12,14 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/seq_scan_plan.h"
+#include "storage/table/parallel_page_scan.h"
+#include "storage/table/table_page_scan.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -50,7 +53,9 @@ class SeqScanExecutor : public AbstractExecutor {
  private:
   /** The sequential scan plan node to be executed */
   const SeqScanPlanNode *plan_;
-  TableIterator table_iter_ = {nullptr, RID{}, nullptr};
   TableHeap *thp_;
+  std::unique_ptr<TablePageScan> scan_;                           // 一次取一页, 当前页的 tuple 都在 scan_->GetViews()
+  std::unique_ptr<ParallelPageScan> parallel_scan_;               // 大表多线程按 morsel 扫, 谓词在 worker 里算
+  size_t pos_{0};                                                 // 当前页下一个要返回的 tuple
 };
 }  // namespace bustub
\ No newline at end of file
@@ -19,12 +19,21 @@
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/seq_scan_plan.h"
 #include "execution/plans/sort_plan.h"
+#include "storage/table/spill_run.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
+/** sorted runs a merge pass of SortExecutor reads at once */
+static constexpr size_t SORT_MERGE_FAN_IN = 8;
+
 /**
  * The SortExecutor executor executes a sort.
+ *
+ * The input is buffered while it fits in the memory budget of the query (see QueryMemory). When it does not, the
+ * buffer is sorted and written out as a SpillRun, and buffering starts over; at the end of the input the runs are
+ * merged SORT_MERGE_FAN_IN at a time until one pass merges them all into the output. The sort is stable either way,
+ * so the output does not depend on the budget. Tuples that went through a run keep their RID.
  */
 class SortExecutor : public AbstractExecutor {
  public:
@@ -35,6 +44,8 @@ class SortExecutor : public AbstractExecutor {
    */
   SortExecutor(ExecutorContext *exec_ctx, const SortPlanNode *plan, std::unique_ptr<AbstractExecutor> &&child_executor);
 
+  ~SortExecutor() override;
+
   /** Initialize the sort */
   void Init() override;
 
@@ -50,7 +61,52 @@ class SortExecutor : public AbstractExecutor {
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
 
  private:
+  /** a buffered tuple and the values of its sort keys */
+  struct Entry {
+    std::vector<Value> keys_;
+    Tuple tuple_;
+  };
+
+  auto MakeEntry(const Tuple &tuple) const -> Entry;
+
+  /** @return the bytes an entry is counted for in the memory budget */
+  static auto EntryBytes(const Entry &entry) -> size_t;
+
+  /** @return true if keys a sort before keys b */
+  auto Less(const std::vector<Value> &a, const std::vector<Value> &b) const -> bool;
+
+  /** add an entry to the buffer, spilling the buffer first if the entry does not fit in the budget */
+  void Buffer(Entry entry);
+
+  /** sort the buffer into order_ */
+  void SortBuffer();
+
+  /** write the sorted buffer out as a run and empty it */
+  void SpillBuffer();
+
+  /** start merging runs_[first, last); NextMerged returns the merged tuples */
+  void StartMerge(size_t first, size_t last);
+
+  auto NextMerged(Tuple *tuple) -> bool;
+
+  /** @return true if the head of reader a comes out after that of reader b: keys, then run order, so it is stable */
+  auto HeadAfter(size_t a, size_t b) const -> bool;
+
+  /** drop the state of the last Init */
+  void Reset();
+
   /** The sort plan node to be executed */
   const SortPlanNode *plan_;
+  std::unique_ptr<AbstractExecutor> child_;
+
+  std::vector<Entry> buffer_;
+  std::vector<uint32_t> order_;                                   // buffer_ 排好序的下标, 不用搬 tuple
+  size_t buffered_bytes_{0};                                      // buffer_ 在预算里占的
+  size_t pos_{0};                                                 // 没有 spill 时下一个输出的 order_ 下标
+
+  std::vector<std::unique_ptr<SpillRun>> runs_;
+  std::vector<std::unique_ptr<SpillRunReader>> readers_;          // 在 runs_ 后面, 先于 runs_ 析构
+  std::vector<Entry> heads_;                                      // 每个 reader 当前的 entry
+  std::vector<size_t> heap_;                                      // 还有 entry 的 reader, 按 heads_ 排的小顶堆
 };
 }  // namespace bustub
@@ -12,12 +12,17 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstring>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include "catalog/schema.h"
 #include "execution/expressions/abstract_expression.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/constant_value_expression.h"
 #include "fmt/format.h"
 #include "storage/table/tuple.h"
 #include "type/value_factory.h"
@@ -37,6 +42,10 @@ class ComparisonExpression : public AbstractExpression {
       : AbstractExpression({std::move(left), std::move(right)}, TypeId::BOOLEAN), comp_type_{comp_type} {}
 
   auto Evaluate(const Tuple *tuple, const Schema &schema) const -> Value override {
+    int cmp;
+    if (CompareToastedPrefix(tuple, schema, &cmp)) {
+      return ValueFactory::GetBooleanValue(Decide(cmp));
+    }
     Value lhs = GetChildAt(0)->Evaluate(tuple, schema);
     Value rhs = GetChildAt(1)->Evaluate(tuple, schema);
     return ValueFactory::GetBooleanValue(PerformComparison(lhs, rhs));
@@ -77,6 +86,68 @@ class ComparisonExpression : public AbstractExpression {
         BUSTUB_ASSERT(false, "Unsupported comparison type.");
     }
   }
+
+  /** the comparison, given the sign of (lhs - rhs) */
+  auto Decide(int cmp) const -> CmpBool {
+    switch (comp_type_) {
+      case ComparisonType::Equal:
+        return GetCmpBool(cmp == 0);
+      case ComparisonType::NotEqual:
+        return GetCmpBool(cmp != 0);
+      case ComparisonType::LessThan:
+        return GetCmpBool(cmp < 0);
+      case ComparisonType::LessThanOrEqual:
+        return GetCmpBool(cmp <= 0);
+      case ComparisonType::GreaterThan:
+        return GetCmpBool(cmp > 0);
+      case ComparisonType::GreaterThanOrEqual:
+        return GetCmpBool(cmp >= 0);
+      default:
+        BUSTUB_ASSERT(false, "Unsupported comparison type.");
+    }
+  }
+
+  /**
+   * A VARCHAR column compared with a VARCHAR constant, where the value of the column is stored out of line (see
+   * Toast): decide by the prefix kept in the tuple if it can, without reading the value.
+   * @param[out] cmp the sign of (lhs - rhs), as Value compares strings
+   * @return false if the prefix does not decide it
+   */
+  auto CompareToastedPrefix(const Tuple *tuple, const Schema &schema, int *cmp) const -> bool {
+    if (GetChildAt(0)->GetReturnType() != TypeId::VARCHAR || GetChildAt(1)->GetReturnType() != TypeId::VARCHAR ||
+        tuple == nullptr || tuple->GetData() == nullptr) {
+      return false;
+    }
+    bool column_on_left = true;
+    auto column = dynamic_cast<const ColumnValueExpression *>(GetChildAt(0).get());
+    auto constant = dynamic_cast<const ConstantValueExpression *>(GetChildAt(1).get());
+    if (column == nullptr || constant == nullptr) {
+      column_on_left = false;
+      column = dynamic_cast<const ColumnValueExpression *>(GetChildAt(1).get());
+      constant = dynamic_cast<const ConstantValueExpression *>(GetChildAt(0).get());
+    }
+    if (column == nullptr || constant == nullptr || constant->val_.IsNull()) {
+      return false;
+    }
+    std::string_view prefix;
+    uint32_t length;
+    if (!tuple->GetToastedPrefix(&schema, column->GetColIdx(), &prefix, &length)) {
+      return false;
+    }
+    // 长度都不算末尾的 '\0', 和 TypeUtil::CompareStrings 一样先比内容再比长度
+    std::string_view value(constant->val_.GetData(), constant->val_.GetLength() - 1);
+    int result = memcmp(prefix.data(), value.data(), std::min(prefix.size(), value.size()));
+    if (result == 0 && value.size() <= prefix.size()) {
+      result = 1;  // 值比前缀长, 前缀又等于常量
+    } else if (result == 0 && (comp_type_ == ComparisonType::Equal || comp_type_ == ComparisonType::NotEqual) &&
+               length - 1 != value.size()) {
+      result = 1;  // 只看相不相等, 长度不同就够了
+    } else if (result == 0) {
+      return false;
+    }
+    *cmp = column_on_left ? result : -result;
+    return true;
+  }
 };
 }  // namespace bustub
 
@@ -34,6 +34,7 @@ namespace bustub {
 enum class PlanType {
   SeqScan,
   IndexScan,
+  IndexLookup,
   Insert,
   Update,
   Delete,
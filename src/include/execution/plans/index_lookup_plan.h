@@ -0,0 +1,65 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// index_lookup_plan.h
+//
+// Identification: src/include/execution/plans/index_lookup_plan.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "execution/plans/abstract_plan.h"
+#include "fmt/ranges.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * IndexLookupPlanNode probes an index for a list of keys (Index::ScanKey), one probe per key, and outputs the table
+ * tuples the index points to. It serves `col = v` and `col IN (v1, v2, ...)` on any index, hash indexes included.
+ */
+class IndexLookupPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * @param output the output schema, the schema of the table
+   * @param index_oid the index to probe
+   * @param keys the key of every probe, without duplicates
+   */
+  IndexLookupPlanNode(SchemaRef output, index_oid_t index_oid, std::vector<Value> keys)
+      : AbstractPlanNode(std::move(output), {}), index_oid_(index_oid), keys_(std::move(keys)) {}
+
+  auto GetType() const -> PlanType override { return PlanType::IndexLookup; }
+
+  /** @return the index to probe */
+  auto GetIndexOid() const -> index_oid_t { return index_oid_; }
+
+  /** @return the probe keys */
+  auto GetKeys() const -> const std::vector<Value> & { return keys_; }
+
+  BUSTUB_PLAN_NODE_CLONE_WITH_CHILDREN(IndexLookupPlanNode);
+
+ protected:
+  auto PlanNodeToString() const -> std::string override {
+    std::vector<std::string> keys;
+    keys.reserve(keys_.size());
+    for (const auto &key : keys_) {
+      keys.push_back(key.ToString());
+    }
+    return fmt::format("IndexLookup {{ index_oid={}, keys=[{}] }}", index_oid_, fmt::join(keys, ", "));
+  }
+
+ private:
+  index_oid_t index_oid_;
+  std::vector<Value> keys_;
+};
+
+}  // namespace bustub
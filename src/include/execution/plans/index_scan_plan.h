@@ -12,14 +12,23 @@
 
 #pragma once
 
+#include <optional>
 #include <string>
 #include <utility>
 
 #include "catalog/catalog.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/abstract_plan.h"
+#include "type/value.h"
 
 namespace bustub {
+
+/** 索引范围扫描的一端 */
+struct IndexScanBound {
+  Value key_;
+  bool inclusive_;
+};
+
 /**
  * IndexScanPlanNode identifies a table that should be scanned with an optional predicate.
  * 指示了一个表, 该表应该被扫表
@@ -30,25 +39,52 @@ class IndexScanPlanNode : public AbstractPlanNode {
    * Creates a new index scan plan node.
    * @param output the output format of this scan plan node
    * @param table_oid the identifier of table to be scanned
+   * @param lower 范围下界, 无则从最小的 key 开始
+   * @param upper 范围上界, 无则扫到最大的 key
+   * @param reverse 从大到小输出, 用于 ORDER BY ... DESC
+   * @param index_only 只读索引项 (covering index), 不回表; 不在索引里的列输出为 NULL, 由优化器保证上层用不到
    */
-  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid)
-      : AbstractPlanNode(std::move(output), {}), index_oid_(index_oid) {}
+  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid, std::optional<IndexScanBound> lower = std::nullopt,
+                    std::optional<IndexScanBound> upper = std::nullopt, bool reverse = false, bool index_only = false)
+      : AbstractPlanNode(std::move(output), {}),
+        index_oid_(index_oid),
+        lower_(std::move(lower)),
+        upper_(std::move(upper)),
+        reverse_(reverse),
+        index_only_(index_only) {}
 
   auto GetType() const -> PlanType override { return PlanType::IndexScan; }
 
   /** @return the identifier of the table that should be scanned */
   auto GetIndexOid() const -> index_oid_t { return index_oid_; }
 
+  auto GetLowerBound() const -> const std::optional<IndexScanBound> & { return lower_; }
+  auto GetUpperBound() const -> const std::optional<IndexScanBound> & { return upper_; }
+  auto IsReverse() const -> bool { return reverse_; }
+  auto IsIndexOnly() const -> bool { return index_only_; }
+
   BUSTUB_PLAN_NODE_CLONE_WITH_CHILDREN(IndexScanPlanNode);
 
  protected:
   auto PlanNodeToString() const -> std::string override {
-    return fmt::format("IndexScan {{ index_oid={} }}", index_oid_);
+    const char *index_only = index_only_ ? ", index_only" : "";
+    if (!lower_.has_value() && !upper_.has_value() && !reverse_) {
+      return fmt::format("IndexScan {{ index_oid={}{} }}", index_oid_, index_only);
+    }
+    return fmt::format("IndexScan {{ index_oid={}, range={}{}, {}{}{}{} }}", index_oid_,
+                       lower_.has_value() && lower_->inclusive_ ? "[" : "(",
+                       lower_.has_value() ? lower_->key_.ToString() : "-inf",
+                       upper_.has_value() ? upper_->key_.ToString() : "+inf",
+                       upper_.has_value() && upper_->inclusive_ ? "]" : ")", reverse_ ? ", reverse" : "", index_only);
   }
 
  private:
   /** The table whose tuples should be scanned. */   // 该表的 tuples 应该被扫描
   index_oid_t index_oid_;
+  std::optional<IndexScanBound> lower_;
+  std::optional<IndexScanBound> upper_;
+  bool reverse_;
+  bool index_only_;
 };
 
 }  // namespace bustub
@@ -13,14 +13,17 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "binder/table_ref/bound_base_table_ref.h"
 #include "catalog/catalog.h"
 #include "catalog/schema.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/abstract_plan.h"
+#include "fmt/ranges.h"
 
 namespace bustub {
 
@@ -33,9 +36,18 @@ class SeqScanPlanNode : public AbstractPlanNode {
    * Construct a new SeqScanPlanNode instance.
    * @param output The output schema of this sequential scan plan node
    * @param table_oid The identifier of table to be scanned
+   * @param columns The columns the parent plans read, std::nullopt for all (see Optimizer::OptimizeSeqScanColumns)
+   * @param filter_predicate The predicate a tuple must satisfy to be emitted, nullptr for all tuples (see
+   * Optimizer::OptimizeMergeFilterScan)
    */
-  SeqScanPlanNode(SchemaRef output, table_oid_t table_oid, std::string table_name)
-      : AbstractPlanNode(std::move(output), {}), table_oid_{table_oid}, table_name_(std::move(table_name)) {}
+  SeqScanPlanNode(SchemaRef output, table_oid_t table_oid, std::string table_name,
+                  std::optional<std::vector<uint32_t>> columns = std::nullopt,
+                  AbstractExpressionRef filter_predicate = nullptr)
+      : AbstractPlanNode(std::move(output), {}),
+        table_oid_{table_oid},
+        table_name_(std::move(table_name)),
+        columns_(std::move(columns)),
+        filter_predicate_(std::move(filter_predicate)) {}
 
   /** @return The type of the plan node */
   auto GetType() const -> PlanType override { return PlanType::SeqScan; }
@@ -53,8 +65,23 @@ class SeqScanPlanNode : public AbstractPlanNode {
   /** The table name */
   std::string table_name_;
 
+  /** The columns read by the parent plans; a PAX table only puts these together. std::nullopt for all */
+  std::optional<std::vector<uint32_t>> columns_;
+
+  /** The predicate of a Filter merged into the scan; its ranges let the scan skip pages by the zone map */
+  AbstractExpressionRef filter_predicate_;
+
  protected:
-  auto PlanNodeToString() const -> std::string override { return fmt::format("SeqScan {{ table={} }}", table_name_); }
+  auto PlanNodeToString() const -> std::string override {
+    std::string s = fmt::format("SeqScan {{ table={}", table_name_);
+    if (columns_.has_value()) {
+      s += fmt::format(", columns={}", *columns_);
+    }
+    if (filter_predicate_ != nullptr) {
+      s += fmt::format(", filter={}", *filter_predicate_);
+    }
+    return s + " }";
+  }
 };
 
 }  // namespace bustub
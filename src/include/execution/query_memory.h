@@ -0,0 +1,62 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// query_memory.h
+//
+// Identification: src/include/execution/query_memory.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+namespace bustub {
+
+/**
+ * The memory budget of a query, shared by its operators. A blocking operator reserves the bytes of the state it
+ * buffers before it grows it; when a reservation fails it writes the state out to SpillRuns and releases it. The
+ * bytes are an estimate of what the operator holds, not an allocator limit.
+ *
+ * The executors of a query run in one thread, so the budget is not synchronized.
+ */
+class QueryMemory {
+ public:
+  explicit QueryMemory(size_t budget) : budget_(budget) {}
+
+  /** @return true and count the bytes as used if they fit in what is left of the budget */
+  auto TryReserve(size_t bytes) -> bool {
+    if (used_ + bytes > budget_) {
+      return false;
+    }
+    used_ += bytes;
+    return true;
+  }
+
+  /** count the bytes as used even over the budget: state that cannot be spilled, e.g. a single tuple */
+  void Reserve(size_t bytes) { used_ += bytes; }
+
+  void Release(size_t bytes) { used_ -= bytes; }
+
+  /** count a run an operator spilled */
+  void RecordSpill(size_t pages) {
+    spilled_runs_++;
+    spilled_pages_ += pages;
+  }
+
+  auto GetBudget() const -> size_t { return budget_; }
+  auto GetUsed() const -> size_t { return used_; }
+  auto GetSpilledRuns() const -> size_t { return spilled_runs_; }
+  auto GetSpilledPages() const -> size_t { return spilled_pages_; }
+
+ private:
+  size_t budget_;
+  size_t used_{0};
+  size_t spilled_runs_{0};
+  size_t spilled_pages_{0};
+};
+
+}  // namespace bustub
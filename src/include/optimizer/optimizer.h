@@ -73,6 +73,36 @@ class Optimizer {
    */
   auto OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
 
+  /**
+   * @brief optimize filter + seq scan as an index range scan when the predicate bounds an indexed column, e.g.
+   * `WHERE x BETWEEN 1 AND 10` or `WHERE x > 5 AND x <= 8`. The filter is kept above the index scan.
+   */
+  auto OptimizeFilterAsIndexRangeScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
+  /**
+   * @brief optimize filter + seq scan as index point lookups: `x = 5` on a hash index, or `x IN (1, 3, 7)` on any
+   * index on x. Equality on an ordered index is left to OptimizeFilterAsIndexRangeScan. The filter is kept above.
+   */
+  auto OptimizeFilterAsIndexLookup(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
+  /**
+   * @brief mark the index scan under a projection (and an optional filter) as index-only when every column they
+   * reference is stored in the index entry (key or include columns), so the executor never reads the table heap.
+   */
+  auto OptimizeIndexOnlyScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
+  /**
+   * @brief record on a sequential scan of a PAX table the columns that the projection or aggregation above it (and an
+   * optional filter in between) read, so the scan only puts those columns of each row together.
+   */
+  auto OptimizeSeqScanColumns(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
+  /**
+   * @brief merge a filter into the sequential scan below it, so the scan can skip the pages whose zone map rules the
+   * predicate out. Runs after the rules that turn a filter over a scan into an index scan.
+   */
+  auto OptimizeMergeFilterScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
   /** @brief check if the index can be matched */
   auto MatchIndex(const std::string &table_name, uint32_t index_key_idx)
       -> std::optional<std::tuple<index_oid_t, std::string>>;
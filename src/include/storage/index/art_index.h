@@ -0,0 +1,62 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// art_index.h
+//
+// Identification: src/include/storage/index/art_index.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "container/art/adaptive_radix_tree.h"
+#include "storage/index/index.h"
+
+namespace bustub {
+
+/**
+ * In-memory index over AdaptiveRadixTree (CREATE INDEX ... USING art). Keys are encoded with KeyEncoder, so integer
+ * and VARCHAR keys work alike, and the RID is appended to the tree key (page id, then slot, big-endian): duplicate
+ * keys stay apart, tree keys are prefix-free, and ScanKey is a scan over the key's encoding that returns the RIDs in
+ * heap order. Nothing is written to the buffer pool, so the index does not outlive the process.
+ */
+class ArtIndex : public Index {
+ public:
+  explicit ArtIndex(std::unique_ptr<IndexMetadata> &&metadata);
+
+  void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
+
+  /**
+   * Append the entries between low and high to result, in key order; a missing bound is open. Each entry is the
+   * encoded key followed by the RID bytes, KeyEncoder::Decode reads the key back.
+   */
+  void ScanRange(const std::optional<Tuple> &low, bool low_inclusive, const std::optional<Tuple> &high,
+                 bool high_inclusive, std::vector<std::pair<std::string, RID>> *result);
+
+  /** Append the RIDs of the keys that start with prefix, in key order. The key must be a single VARCHAR column. */
+  void ScanPrefix(const std::string &prefix, std::vector<RID> *result);
+
+  /** the encoded form of key, which every tree key of that key starts with */
+  auto EncodeKey(const Tuple &key) const -> std::string;
+
+ private:
+  auto TreeKey(const Tuple &key, RID rid) const -> std::string;
+  void ScanEncoded(std::string_view low, std::optional<std::string_view> high, std::vector<RID> *result);
+
+  AdaptiveRadixTree<RID> tree_;
+};
+
+}  // namespace bustub
@@ -10,11 +10,16 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <optional>
 #include <queue>
 #include <string>
 #include <vector>
 
+#include "common/macros.h"
 #include "concurrency/transaction.h"
+#include "storage/index/index.h"
 #include "storage/index/index_iterator.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
@@ -23,6 +28,12 @@ namespace bustub {
 
 #define BPLUSTREE_TYPE BPlusTree<KeyType, ValueType, KeyComparator>
 
+/** swizzle levels of the B+ tree indexes BustubInstance creates */
+static constexpr int BPLUS_TREE_SWIZZLE_LEVELS = 3;
+
+/** swizzled (and therefore pinned) frames of one tree take at most pool size / SWIZZLE_POOL_FRACTION frames */
+static constexpr size_t SWIZZLE_POOL_FRACTION = 8;
+
 /**
  * Main class providing the API for the Interactive B+ Tree.
  *
@@ -32,6 +43,11 @@ namespace bustub {
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ * (5) descents can swizzle the child references of the top inner levels: a
+ *     child is reached through its frame pointer cached on the parent frame,
+ *     skipping the FetchPage/UnpinPage round trip (see Page::GetSwizzledChild).
+ *     Off by default (SetSwizzleLevels); every swizzled frame stays pinned until
+ *     the tree lets go of it, so the buffer pool must outlive the tree.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
@@ -42,12 +58,20 @@ class BPlusTree {
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
                      int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
 
+  ~BPlusTree();
+
+  DISALLOW_COPY(BPlusTree);
+
   // Returns true if this B+ tree has no keys and values.
   auto IsEmpty() const -> bool;
 
   // Insert a key-value pair into this B+ tree.
   auto Insert(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr) -> bool;
 
+  // Insert many key-value pairs: sorted first, then one descent per run of keys that land in the same leaf.
+  // Duplicated keys are skipped like in Insert. The batch is sorted in place.
+  void InsertBatch(std::vector<MappingType> *batch, Transaction *transaction = nullptr);
+
   // Remove a key and its value from this B+ tree.
   void Remove(const KeyType &key, Transaction *transaction = nullptr);
 
@@ -57,6 +81,19 @@ class BPlusTree {
   // return the page id of the root node
   auto GetRootPageId() -> page_id_t;
 
+  // 下降时对最上面 levels 层内部节点的子节点引用做 swizzle, 0 关闭并放掉所有 swizzle 的 pin
+  void SetSwizzleLevels(int levels);
+
+  // 高度, 页数, 叶子填充率, 叶子链的物理连续度
+  auto GetStats() -> IndexStats;
+
+  /**
+   * 重建: 按 key 顺序把所有 entry 装进连续新分配的叶子(每页装到 fill_factor), 在上面逐层建内部节点,
+   * 最后切换 root. 新树建好之前旧树不被修改, 查询照常走旧树; 切换时还停在旧树上的迭代器继续读旧树,
+   * 所以旧树的页等到没有迭代器了(active_readers_ 为 0)才释放, 见 FreeRetiredTrees.
+   */
+  void Reindex(double fill_factor = 1.0, Transaction *transaction = nullptr);
+
   void SplitInternalNode(InternalPage *bptPage);
 
   void SplitLeafNode(LeafPage *bptPage);
@@ -71,13 +108,32 @@ class BPlusTree {
 
   auto FindLeftMostLeftLeafPage() -> Page*;
 
+  auto FindRightMostLeafPage() -> Page*;
+
   auto FindLeafPageByKey(KeyType key) -> Page*;
 
+  // 同 FindLeafPageByKey, 并返回该叶子的上界: 路径上该叶子右侧最近的分隔 key, 最右叶子没有上界
+  auto FindLeafPageWithFence(const KeyType &key, std::optional<KeyType> *fence) -> Page*;
+
+  /**
+   * key 所在的叶子在 buffer pool 里吗? 只 fetch 已经在 buffer pool 里的页, 路径上遇到不在的页就停下, 不产生 IO.
+   * low_fence / high_fence 返回停下的那个页覆盖的 key 范围 [low_fence, high_fence), 没有的一端为 nullopt.
+   * 空树返回 true (插入直接建根).
+   */
+  auto ProbeLeaf(const KeyType &key, std::optional<KeyType> *low_fence, std::optional<KeyType> *high_fence) -> bool;
+
   // index iterator
   auto Begin() -> INDEXITERATOR_TYPE;
   auto Begin(const KeyType &key) -> INDEXITERATOR_TYPE;
   auto End() -> INDEXITERATOR_TYPE;
 
+  /**
+   * 范围扫描, 两端可选, 可开可闭. 迭代器走到另一端就结束, 不会多读后面的叶子.
+   * reverse 为 true 时从 high 往 low 沿 prev 链接扫描.
+   */
+  auto RangeBegin(const std::optional<KeyType> &low, bool low_inclusive, const std::optional<KeyType> &high,
+                  bool high_inclusive, bool reverse = false) -> INDEXITERATOR_TYPE;
+
   // print the B+ tree
   void Print(BufferPoolManager *bpm);
 
@@ -93,6 +149,45 @@ class BPlusTree {
  private:
   void UpdateRootPageId(int insert_record = 0);
 
+  void SetLeafPrevPageId(page_id_t page_id, page_id_t prev_page_id);
+
+  /**
+   * 下降的起点. 根是内部节点时缓存它的 frame 并一直 pin 着, 之后不再 FetchPage.
+   * @param[out] pinned 返回的页是否被这次调用 pin 了, 是则由调用者 unpin; 否则是 swizzle 持有的 frame
+   */
+  auto FetchRoot(bool *pinned) -> Page *;
+
+  /**
+   * 取内部节点 parent 物理位置 slot 上的孩子(Eytzinger 布局下不是有序下标, 见 InternalPage::SlotAt).
+   * parent 是 swizzle 持有的 frame (parent_pinned 为 false) 且 depth (根为 0) 小于 swizzle_levels_ 时
+   * 优先用 parent frame 上的 swizzle 引用, 没有则 FetchPage 并把这个 pin 留给新挂上的引用.
+   * 叶子总是 FetchPage, 所以 Find*LeafPage 返回的叶子都是 pin 住的.
+   */
+  auto FetchChild(Page *parent, bool parent_pinned, int slot, int depth, bool *pinned) -> Page *;
+
+  void ReleaseDescent(Page *page, bool pinned);
+
+  /** 还能再持有一个 swizzle frame 吗 */
+  auto CanSwizzle() -> bool;
+
+  /**
+   * 放掉所有 swizzle 引用和它们的 pin. 改内部节点结构(分裂, 合并, 借节点, REINDEX)之前调用:
+   * 之后 slot 会挪, 页会被删, 被 pin 着的页 DeletePage 不掉.
+   */
+  void UnswizzleAll();
+
+  /** 放掉 frame 上的 swizzle 引用(递归)和 frame 自己的 pin */
+  void ReleaseSwizzled(Page *frame);
+
+  /** page_id 为根的子树里内部节点的个数, levels 为子树的层数 */
+  auto CountInternalPages(page_id_t page_id, int levels) -> int;
+
+  /** DeletePage 整棵子树 */
+  void FreeSubtree(page_id_t page_id);
+
+  /** 没有迭代器了就释放 REINDEX 换下来的旧树; 写操作和 REINDEX 开始时调用 */
+  void FreeRetiredTrees();
+
   /* Debug Routines for FREE!! */
   void ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstream &out) const;
 
@@ -105,6 +200,14 @@ class BPlusTree {
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
+  Page *root_frame_{nullptr};
+  int swizzle_levels_{0};
+  // swizzle 持有的 frame 数(含根), 最多占 buffer pool 的 1/SWIZZLE_POOL_FRACTION
+  size_t swizzled_frames_{0};
+  // 停在叶子上的迭代器个数, 迭代器拷一份 shared_ptr, 树先析构也不悬空
+  std::shared_ptr<std::atomic<int64_t>> active_readers_{std::make_shared<std::atomic<int64_t>>(0)};
+  // REINDEX 换下来, 还有读者所以没释放的旧树的根
+  std::vector<page_id_t> retired_roots_;
 };
 
 }  // namespace bustub
@@ -13,7 +13,9 @@
 
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "container/hash/hash_function.h"
@@ -24,6 +26,13 @@ namespace bustub {
 
 #define BPLUSTREE_INDEX_TYPE BPlusTreeIndex<KeyType, ValueType, KeyComparator>
 
+/**
+ * B+ tree index with a change buffer: an insert or delete whose target leaf is not in the buffer pool is kept in a
+ * small sorted in-memory delta instead of reading the leaf from disk. Once a key has a pending change, later changes
+ * to it are buffered too, so they stay in order. The delta is merged into the tree in key order when it fills up,
+ * and the part that covers a leaf is merged before the leaf is read (ScanKey, iterators), so lookups see every
+ * change.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeIndex : public Index {
  public:
@@ -31,21 +40,70 @@ class BPlusTreeIndex : public Index {
 
   void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
+  void InsertEntries(const std::vector<std::pair<Tuple, RID>> &entries, Transaction *transaction) override;
+
   void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  auto GetStats() -> std::optional<IndexStats> override;
+
+  auto Reindex(Transaction *transaction) -> bool override;
+
   auto GetBeginIterator() -> INDEXITERATOR_TYPE;
 
   auto GetBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE;
 
   auto GetEndIterator() -> INDEXITERATOR_TYPE;
 
+  // 范围扫描, 见 BPlusTree::RangeBegin
+  auto GetRangeIterator(const std::optional<KeyType> &low, bool low_inclusive, const std::optional<KeyType> &high,
+                        bool high_inclusive, bool reverse) -> INDEXITERATOR_TYPE;
+
+  // change buffer 最多缓冲多少个 key, 0 关闭 (先合并掉已缓冲的修改)
+  void SetChangeBufferCapacity(size_t capacity);
+
+  // 见 BPlusTree::SetSwizzleLevels; 打开以后 buffer pool 要比索引活得久
+  void SetSwizzleLevels(int levels) { container_.SetSwizzleLevels(levels); }
+
+  // 缓冲着修改的 key 个数
+  auto GetBufferedChanges() const -> size_t { return change_buffer_.size(); }
+
+  // 把 change buffer 全部合并进树
+  void MergeChangeBuffer();
+
  protected:
+  /** 一个 key 上缓冲的净修改: 先从树里删掉这个 key (remove_), 再插入 insert_ */
+  struct BufferedChange {
+    bool remove_{false};
+    std::optional<MappingType> insert_;
+  };
+
+  struct KeyLess {
+    auto operator()(const KeyType &lhs, const KeyType &rhs) const -> bool { return comparator_(lhs, rhs) < 0; }
+    KeyComparator comparator_;
+  };
+
+  /**
+   * 叶子不在 buffer pool 里, 或者这个 key 已经有缓冲的修改时, 把修改记进 change buffer.
+   * @param rid 插入的值, nullptr 表示删除
+   * @return false 表示没有缓冲, 由调用者直接改树
+   */
+  auto BufferChange(const KeyType &key, const RID *rid) -> bool;
+
+  /** 同上, 只是叶子是否在 buffer pool 里已经由调用者探测过 */
+  void RecordChange(const KeyType &key, const RID *rid);
+
+  /** 合并 low <= key <= high 的缓冲修改, 没有的一端不限 */
+  void MergeRange(const std::optional<KeyType> &low, const std::optional<KeyType> &high);
+
   // comparator for key
   KeyComparator comparator_;
   // container
   BPlusTree<KeyType, ValueType, KeyComparator> container_;
+  // change buffer, 按 key 排序
+  std::map<KeyType, BufferedChange, KeyLess> change_buffer_;
+  size_t change_buffer_capacity_{CHANGE_BUFFER_SIZE};
 };
 
 /** We only support index table with one integer key for now in BusTub. Hardcode everything here. */
@@ -94,13 +94,38 @@ class GenericComparator {
     return 0;
   }
 
-  GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_} {}
+  GenericComparator(const GenericComparator &other)
+      : key_schema_{other.key_schema_}, integer_key_type_{other.integer_key_type_} {}
+
+  auto operator=(const GenericComparator &other) -> GenericComparator & = default;
 
   // constructor
-  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
+  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {
+    if (key_schema_ == nullptr || key_schema_->GetColumnCount() != 1 || key_schema_->GetColumn(0).GetOffset() != 0) {
+      return;
+    }
+    switch (key_schema_->GetColumn(0).GetType()) {
+      case TypeId::TINYINT:
+      case TypeId::SMALLINT:
+      case TypeId::INTEGER:
+      case TypeId::BIGINT:
+        integer_key_type_ = key_schema_->GetColumn(0).GetType();
+        break;
+      default:
+        break;
+    }
+  }
+
+  /**
+   * The integer type of the key if the key schema is a single integer column,
+   * TypeId::INVALID otherwise. Such keys can be compared as native integers
+   * read from the first bytes of GenericKey (see NodeSearch).
+   */
+  inline auto GetIntegerKeyType() const -> TypeId { return integer_key_type_; }
 
  private:
   Schema *key_schema_;
+  TypeId integer_key_type_{TypeId::INVALID};
 };
 
 }  // namespace bustub
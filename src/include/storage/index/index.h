@@ -13,6 +13,7 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -43,12 +44,20 @@ class IndexMetadata {
    * @param table_name The name of the table on which the index is created 表名
    * @param tuple_schema The schema of the indexed key        tuple 的schema
    * @param key_attrs The mapping from indexed columns to base table columns  表属性
+   * @param include_attrs Base table columns stored in the index entry after the key but not compared (covering index)
    */
   IndexMetadata(std::string index_name, std::string table_name, const Schema *tuple_schema,
-                std::vector<uint32_t> key_attrs)
-      : name_(std::move(index_name)), table_name_(std::move(table_name)), key_attrs_(std::move(key_attrs)) {
+                std::vector<uint32_t> key_attrs, std::vector<uint32_t> include_attrs = {})
+      : name_(std::move(index_name)),
+        table_name_(std::move(table_name)),
+        key_attrs_(std::move(key_attrs)),
+        include_attrs_(std::move(include_attrs)) {
     key_schema_ = std::make_shared<Schema>(Schema::CopySchema(tuple_schema, key_attrs_));     // 根据 key 属性, 即表的列集合
-  }                                                                                           // 和表schema 构成一个 子schema
+                                                                                              // 和表schema 构成一个 子schema
+    entry_attrs_ = key_attrs_;                                                                // 索引项 = key 列 + include 列
+    entry_attrs_.insert(entry_attrs_.end(), include_attrs_.begin(), include_attrs_.end());
+    entry_schema_ = std::make_shared<Schema>(Schema::CopySchema(tuple_schema, entry_attrs_));
+  }
 
   ~IndexMetadata() = default;
 
@@ -72,6 +81,18 @@ class IndexMetadata {
   /** @return The mapping relation between indexed columns and base table columns */
   inline auto GetKeyAttrs() const -> const std::vector<uint32_t> & { return key_attrs_; }
 
+  /** @return The base table columns carried in the index entry but not part of the key */
+  inline auto GetIncludeAttrs() const -> const std::vector<uint32_t> & { return include_attrs_; }
+
+  /**
+   * @return The base table columns of an index entry: the key columns followed by the include columns.
+   * Equal to GetKeyAttrs() for an index without include columns.
+   */
+  inline auto GetEntryAttrs() const -> const std::vector<uint32_t> & { return entry_attrs_; }
+
+  /** @return A schema object pointer that represents an index entry (key + include columns) */
+  inline auto GetEntrySchema() const -> Schema * { return entry_schema_.get(); }
+
   /** @return A string representation for debugging */
   auto ToString() const -> std::string {
     std::stringstream os;
@@ -92,8 +113,29 @@ class IndexMetadata {
   std::string table_name_;
   /** The mapping relation between key schema and tuple schema */
   const std::vector<uint32_t> key_attrs_;
+  /** The included (payload) columns of a covering index */
+  const std::vector<uint32_t> include_attrs_;
+  /** key_attrs_ followed by include_attrs_ */
+  std::vector<uint32_t> entry_attrs_;
   /** The schema of the indexed key */
   std::shared_ptr<Schema> key_schema_;
+  /** The schema of an index entry */
+  std::shared_ptr<Schema> entry_schema_;
+};
+
+/**
+ * Shape of a tree index, reported before and after a REINDEX.
+ */
+struct IndexStats {
+  /** Number of levels, 0 for an empty index */
+  int height_{0};
+  int internal_pages_{0};
+  int leaf_pages_{0};
+  int64_t entries_{0};
+  /** entries_ over what the leaves can hold */
+  double fill_factor_{0};
+  /** Fraction of the leaf-chain links that go to the physically next page, 1 means a scan reads the file in order */
+  double leaf_contiguity_{0};
 };
 
 /////////////////////////////////////////////////////////////////////
@@ -139,6 +181,15 @@ class Index {
   /** @return The index key attributes */
   auto GetKeyAttrs() const -> const std::vector<uint32_t> & { return metadata_->GetKeyAttrs(); }
 
+  /** @return The include (payload) attributes of a covering index */
+  auto GetIncludeAttrs() const -> const std::vector<uint32_t> & { return metadata_->GetIncludeAttrs(); }
+
+  /** @return The index entry schema, i.e. the key schema followed by the include columns */
+  auto GetEntrySchema() const -> Schema * { return metadata_->GetEntrySchema(); }
+
+  /** @return The index entry attributes */
+  auto GetEntryAttrs() const -> const std::vector<uint32_t> & { return metadata_->GetEntryAttrs(); }
+
   /** @return A string representation for debugging */
   auto ToString() const -> std::string {
     std::stringstream os;
@@ -153,12 +204,25 @@ class Index {
 
   /**
    * Insert an entry into the index.
-   * @param key The index key
+   * @param key The index key; for a covering index, the entry tuple (GetEntrySchema) that also carries the payload
    * @param rid The RID associated with the key (unused)
    * @param transaction The transaction context
    */
   virtual void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) = 0;
 
+  /**
+   * Insert a batch of entries into the index. The default inserts them one by
+   * one; tree indexes override it to sort the batch and insert key runs that
+   * land in the same leaf with a single descent.
+   * @param entries The (index key, RID) pairs, in any order
+   * @param transaction The transaction context
+   */
+  virtual void InsertEntries(const std::vector<std::pair<Tuple, RID>> &entries, Transaction *transaction) {
+    for (const auto &[key, rid] : entries) {
+      InsertEntry(key, rid, transaction);
+    }
+  }
+
   /**
    * Delete an index entry by key.
    * @param key The index key
@@ -175,6 +239,26 @@ class Index {
    */
   virtual void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) = 0;
 
+  /**
+   * @return true if the index keeps its keys in order, so IndexScanExecutor can run range and ordered scans on it;
+   * hash indexes only answer ScanKey
+   */
+  virtual auto IsOrdered() const -> bool { return true; }
+
+  ///////////////////////////////////////////////////////////////////
+  // Maintenance
+  ///////////////////////////////////////////////////////////////////
+
+  /** @return The shape of the index, std::nullopt if this index type does not report it */
+  virtual auto GetStats() -> std::optional<IndexStats> { return std::nullopt; }
+
+  /**
+   * Rebuild the index compactly on new pages and switch to it, then free the old pages.
+   * @param transaction The transaction context
+   * @return false if this index type does not support it
+   */
+  virtual auto Reindex(Transaction *transaction) -> bool { return false; }
+
  private:
   /** The Index structure owns its metadata */
   std::unique_ptr<IndexMetadata> metadata_;
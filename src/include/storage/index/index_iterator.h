@@ -13,6 +13,10 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include <atomic>
+#include <memory>
+#include <optional>
+
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
@@ -24,13 +28,33 @@ class IndexIterator {
  public:
   // you may define your own constructor based on your member variables
   IndexIterator();
-  IndexIterator(int index, B_PLUS_TREE_LEAF_PAGE_TYPE *page, BufferPoolManager *bpm);
+  /**
+   * @param readers 树的读者计数, 迭代器停在叶子上期间算一个读者, REINDEX 据此推迟释放旧树; 可以为空
+   */
+  IndexIterator(int index, B_PLUS_TREE_LEAF_PAGE_TYPE *page, BufferPoolManager *bpm,
+                std::shared_ptr<std::atomic<int64_t>> readers = nullptr);
+  /**
+   * 范围迭代器.
+   * @param index 起始位置, 可以越过本页的两端, 构造时会顺着兄弟链接挪到第一个有效位置
+   * @param reverse true 则沿 prev 链接从大到小扫描
+   * @param stop 扫描终点 (正向为上界, 反向为下界), 无则扫到树的一端
+   * @param stop_inclusive 终点本身是否在范围内
+   */
+  IndexIterator(int index, B_PLUS_TREE_LEAF_PAGE_TYPE *page, BufferPoolManager *bpm, const KeyComparator &comparator,
+                bool reverse, std::optional<KeyType> stop, bool stop_inclusive,
+                std::shared_ptr<std::atomic<int64_t>> readers = nullptr);
+  // 迭代器 pin 着当前叶子, 只能移动; 析构时 unpin, 没走到终点就丢掉也不会漏 pin
+  IndexIterator(IndexIterator &&other) noexcept;
+  auto operator=(IndexIterator &&other) noexcept -> IndexIterator &;
+  IndexIterator(const IndexIterator &) = delete;
+  auto operator=(const IndexIterator &) -> IndexIterator & = delete;
   ~IndexIterator();  // NOLINT
 
   auto IsEnd() -> bool;
 
   auto operator*() -> const MappingType &;
 
+  // 按迭代方向前进一个 (反向迭代器的 ++ 走向更小的 key)
   auto operator++() -> IndexIterator &;
 
   auto operator==(const IndexIterator &itr) const -> bool {
@@ -52,11 +76,24 @@ class IndexIterator {
   }
 
  private:
+  // 停在叶子上就登记为树的读者
+  void Register();
+
+  // 挪到第一个有效位置; 越过终点或树的一端时 unpin 叶子, 变成 End
+  void Settle();
+
+  // unpin 叶子, 注销读者
+  void Finish();
+
   // add your own private member variables here
-  int index_;                // 本节点的第多少个?
-  Page *page_;
-  B_PLUS_TREE_LEAF_PAGE_TYPE *bptLeafPage_;       // 模板类leaf page 的对象指针
-  BufferPoolManager *buffer_pool_manager_;
+  int index_{0};             // 本节点的第多少个?
+  B_PLUS_TREE_LEAF_PAGE_TYPE *bptLeafPage_{nullptr};  // 模板类leaf page 的对象指针, pin 着
+  BufferPoolManager *buffer_pool_manager_{nullptr};
+  bool reverse_{false};
+  std::optional<KeyType> stop_;                   // 范围的终点
+  bool stop_inclusive_{true};
+  std::optional<KeyComparator> comparator_;       // 无终点时不需要
+  std::shared_ptr<std::atomic<int64_t>> readers_;  // 登记着的读者计数, 走到 End 后为空
 };
 
 }  // namespace bustub
@@ -0,0 +1,63 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_encoder.h
+//
+// Identification: src/include/storage/index/key_encoder.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "catalog/schema.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * KeyEncoder turns an index key tuple into a binary-comparable byte string:
+ * for any two keys a, b of the same key schema, memcmp order of Encode(a) and
+ * Encode(b) equals the order GenericComparator would give. The slotted B+ tree
+ * works on these bytes only, which is what makes prefix compression and suffix
+ * truncation possible.
+ *
+ * Column encodings (concatenated in key schema order):
+ *  - integer types: big-endian with the sign bit flipped
+ *  - BOOLEAN: one byte
+ *  - DECIMAL: IEEE-754 bits, sign bit flipped for positives, all bits flipped for negatives
+ *  - TIMESTAMP: big-endian
+ *  - VARCHAR: 0x01, then the bytes with every 0x00 escaped as 0x00 0xFF, terminated by
+ *    0x00 0x00, so a string sorts before all strings it is a proper prefix of
+ * NULL integers/decimals are stored as the type's minimum value, so they sort first.
+ * A NULL VARCHAR is the single byte 0x00.
+ */
+class KeyEncoder {
+ public:
+  /** Encode all columns of key (a tuple laid out with key_schema). */
+  static auto Encode(const Tuple &key, const Schema *key_schema) -> std::string;
+
+  /** Append the encoding of one value. */
+  static void AppendValue(const Value &value, std::string *out);
+
+  /** Decode an integer encoded by AppendValue, for tests and debug output. */
+  static auto DecodeBigInt(std::string_view bytes) -> int64_t;
+
+  /** Decode a key produced by Encode back into a tuple laid out with key_schema. */
+  static auto Decode(std::string_view bytes, const Schema *key_schema) -> Tuple;
+
+  /** Decode one value of the given type from the front of bytes and advance bytes past it. */
+  static auto DecodeValue(std::string_view *bytes, TypeId type) -> Value;
+
+ private:
+  static void AppendBigEndian(uint64_t bits, size_t width, std::string *out);
+  static auto ReadBigEndian(std::string_view *bytes, size_t width) -> uint64_t;
+};
+
+}  // namespace bustub
@@ -39,6 +39,8 @@ class LinearProbeHashTableIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  auto IsOrdered() const -> bool override { return false; }
+
  protected:
   // comparator for key
   KeyComparator comparator_;
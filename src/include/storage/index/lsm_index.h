@@ -0,0 +1,66 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lsm_index.h
+//
+// Identification: src/include/storage/index/lsm_index.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "storage/index/index.h"
+#include "storage/index/lsm_tree.h"
+
+namespace bustub {
+
+/**
+ * Write-optimized index over LsmTree (CREATE INDEX ... USING lsm). Tree keys are built like ArtIndex's: the
+ * KeyEncoder encoding followed by the RID (page id, then slot, big-endian). A delete writes a tombstone. The bloom
+ * filters hash the encoding without the RID, so ScanKey skips the runs that do not hold the key. Runs live on buffer
+ * pool pages; the memtable, fence pointers and bloom filters are in memory, so the index does not outlive the process.
+ */
+class LsmIndex : public Index {
+ public:
+  LsmIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager);
+
+  void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
+
+  /**
+   * Iterate the entries between low and high in key order; a missing bound is open. Each entry is the encoded key
+   * followed by the RID bytes, KeyEncoder::Decode reads the key back and GetRid the RID.
+   */
+  auto Scan(const std::optional<Tuple> &low, bool low_inclusive, const std::optional<Tuple> &high,
+            bool high_inclusive) const -> LsmIterator;
+
+  /** the encoded form of key, which every tree key of that key starts with */
+  auto EncodeKey(const Tuple &key) const -> std::string;
+
+  /** @return the RID stored at the end of a tree key */
+  static auto GetRid(std::string_view tree_key) -> RID;
+
+  /** Write out the memtable and finish the due compactions. */
+  void Flush() { tree_.Flush(); }
+
+  auto GetTree() const -> const LsmTree & { return tree_; }
+
+ private:
+  auto TreeKey(const Tuple &key, RID rid) const -> std::string;
+
+  LsmTree tree_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,266 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lsm_tree.h
+//
+// Identification: src/include/storage/index/lsm_tree.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <cstring>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/** a memtable is frozen and written out as a level-0 run once its entries take this many bytes */
+static constexpr size_t LSM_MEMTABLE_SIZE = 256 * 1024;
+/** level-0 runs may overlap; this many of them are merged into level 1 */
+static constexpr size_t LSM_L0_COMPACTION_TRIGGER = 4;
+/** level i + 1 holds this many times the bytes of level i, level 1 holds as many memtables */
+static constexpr size_t LSM_LEVEL_SIZE_RATIO = 10;
+/** longest key a run page can hold */
+static constexpr size_t LSM_MAX_KEY_SIZE = BUSTUB_PAGE_SIZE / 4;
+
+/** A sorted stream of (key, tombstone) entries, positioned at its first key >= the key it was opened at. */
+class LsmCursor {
+ public:
+  virtual ~LsmCursor() = default;
+  virtual auto Valid() const -> bool = 0;
+  virtual auto Key() const -> std::string_view = 0;
+  virtual auto Deleted() const -> bool = 0;
+  virtual void Next() = 0;
+};
+
+/**
+ * Memtable: a skiplist from key to tombstone flag. Writes are serialized by the caller; readers take no latch. Nodes
+ * are linked in with release stores and never unlinked, a second write of a key flips the flag in place, so a reader
+ * running next to the writer sees every node completely or not at all.
+ */
+class LsmMemTable {
+ public:
+  LsmMemTable();
+
+  ~LsmMemTable();
+
+  DISALLOW_COPY_AND_MOVE(LsmMemTable);
+
+  /** insert key, or overwrite its tombstone flag */
+  void Put(std::string_view key, bool deleted);
+
+  /** @return a cursor at the first key >= low; it keeps the memtable alive */
+  static auto NewCursor(std::shared_ptr<const LsmMemTable> memtable, std::string_view low)
+      -> std::unique_ptr<LsmCursor>;
+
+  /** @return the approximate memory the entries take */
+  auto GetBytes() const -> size_t { return bytes_.load(std::memory_order_relaxed); }
+
+  auto IsEmpty() const -> bool { return GetBytes() == 0; }
+
+  struct Node;
+
+ private:
+  static constexpr int MAX_HEIGHT = 12;
+
+  auto RandomHeight() -> int;
+  /** first node >= key; prev[i] is the last node < key on level i if prev is not null */
+  auto FindGreaterOrEqual(std::string_view key, Node **prev) const -> Node *;
+
+  Node *head_;
+  std::atomic<int> height_{1};
+  std::atomic<size_t> bytes_{0};
+  std::mt19937 rng_{15445};
+};
+
+/**
+ * An immutable sorted run on pages allocated from the buffer pool: each page holds a count followed by
+ * (key length, tombstone, key) entries in key order. The fence pointers (first key of every page) and the bloom
+ * filter stay in memory, so a lookup reads at most one page per run, and none of a run whose bloom filter rules the
+ * key out. The pages are deleted with the run.
+ */
+class LsmRun {
+ public:
+  LsmRun(BufferPoolManager *bpm, size_t bloom_suffix_size);
+
+  ~LsmRun();
+
+  DISALLOW_COPY_AND_MOVE(LsmRun);
+
+  /** Append an entry; keys must come in increasing order. */
+  void Append(std::string_view key, bool deleted);
+
+  /** Write the last page and build the bloom filter. */
+  void Finish();
+
+  /** @return false if no key of the run starts with bloom_key (its key without the bloom suffix), true if one may */
+  auto MayContain(std::string_view bloom_key) const -> bool;
+
+  /** @return false if the run has no key in [low, high) */
+  auto Overlaps(std::string_view low, const std::optional<std::string> &high) const -> bool;
+
+  /** @return a cursor at the first key >= low; it keeps the run alive */
+  static auto NewCursor(std::shared_ptr<const LsmRun> run, std::string_view low) -> std::unique_ptr<LsmCursor>;
+
+  /** @return the bytes of the entries */
+  auto GetBytes() const -> size_t { return bytes_; }
+
+  auto GetNumPages() const -> size_t { return page_ids_.size(); }
+
+  /** Copy page i into data and set offsets to where its entries start. */
+  void ReadPage(size_t i, std::string *data, std::vector<uint16_t> *offsets) const;
+
+  /** @return the key of the entry at offset of a page read with ReadPage */
+  static auto EntryKey(std::string_view data, uint16_t offset) -> std::string_view {
+    uint16_t key_len;
+    memcpy(&key_len, data.data() + offset, sizeof(key_len));
+    return data.substr(offset + sizeof(key_len) + 1, key_len);
+  }
+
+  /** @return the tombstone flag of the entry at offset of a page read with ReadPage */
+  static auto EntryDeleted(std::string_view data, uint16_t offset) -> bool {
+    return data[offset + sizeof(uint16_t)] != 0;
+  }
+
+ private:
+  static constexpr size_t BLOOM_BITS_PER_KEY = 10;
+  static constexpr size_t BLOOM_HASHES = 7;
+
+  static void BloomHash(std::string_view key, uint64_t *h1, uint64_t *h2);
+  void FlushPage();
+
+  BufferPoolManager *bpm_;
+  /** the bloom filter hashes the key without this many trailing bytes */
+  size_t bloom_suffix_size_;
+  std::vector<page_id_t> page_ids_;
+  /** first key of every page */
+  std::vector<std::string> fences_;
+  std::string last_key_;
+  size_t bytes_{0};
+  std::vector<uint64_t> bloom_;
+  /** the page being filled, and the hashes of the bloom keys seen so far, until Finish */
+  std::string page_;
+  uint16_t page_count_{0};
+  std::vector<std::pair<uint64_t, uint64_t>> bloom_hashes_;
+  std::string last_bloom_key_;
+};
+
+/**
+ * Merging iterator: the union of several cursors, newest first. Of equal keys the newest entry wins and the rest are
+ * skipped; tombstones hide the key unless keep_tombstones (compaction into a level that is not the last one).
+ */
+class LsmIterator {
+ public:
+  LsmIterator(std::vector<std::unique_ptr<LsmCursor>> cursors, std::optional<std::string> high, bool keep_tombstones);
+
+  auto IsEnd() const -> bool { return end_; }
+
+  auto Key() const -> const std::string & { return key_; }
+
+  auto Deleted() const -> bool { return deleted_; }
+
+  auto operator++() -> LsmIterator &;
+
+ private:
+  void FindNext();
+
+  std::vector<std::unique_ptr<LsmCursor>> cursors_;
+  /** exclusive upper bound */
+  std::optional<std::string> high_;
+  bool keep_tombstones_;
+  bool end_{false};
+  std::string key_;
+  bool deleted_{false};
+};
+
+/**
+ * Log-structured merge tree over byte-string keys without values (an index stores its RID in the key). Writes go to
+ * the skiplist memtable; a full memtable is frozen and a background thread writes it out as a level-0 run. Level-0
+ * runs may overlap; levels 1 and deeper are a single sorted run each, LSM_LEVEL_SIZE_RATIO times bigger than the one
+ * above (leveled compaction). The background thread merges level 0 into level 1 once it has l0_trigger runs, and a
+ * level into the next one once it outgrows its size; tombstones are dropped when merged into the last level.
+ *
+ * Readers take a snapshot (memtables and the current list of runs) under the latch and read without it. Writers
+ * wait when the previous memtable is still being written out.
+ */
+class LsmTree {
+ public:
+  /**
+   * @param bloom_suffix_size bloom filters hash keys without this many trailing bytes, so a point lookup by that
+   * prefix can skip runs
+   */
+  LsmTree(BufferPoolManager *bpm, size_t bloom_suffix_size, size_t memtable_size = LSM_MEMTABLE_SIZE,
+          size_t l0_trigger = LSM_L0_COMPACTION_TRIGGER, size_t size_ratio = LSM_LEVEL_SIZE_RATIO);
+
+  ~LsmTree();
+
+  DISALLOW_COPY_AND_MOVE(LsmTree);
+
+  /** Write key, or a tombstone for it. */
+  void Put(std::string_view key, bool deleted);
+
+  /**
+   * @brief Iterate the live keys in [low, high), high = std::nullopt has no upper bound.
+   * @param bloom_key if every key of the range starts with bloom_key (a point lookup), skip the runs whose bloom
+   * filter does not contain it
+   */
+  auto Scan(std::string_view low, std::optional<std::string> high, std::optional<std::string_view> bloom_key) const
+      -> LsmIterator;
+
+  /** Write out the memtable and wait until no compaction is due. */
+  void Flush();
+
+  /** @return the number of level-0 runs, then the bytes of level 1, 2, ... */
+  auto GetShape() const -> std::vector<size_t>;
+
+  /** @return the smallest key greater than every key that starts with prefix, std::nullopt if there is none */
+  static auto Successor(std::string_view prefix) -> std::optional<std::string>;
+
+ private:
+  struct Version {
+    /** newest first */
+    std::vector<std::shared_ptr<const LsmRun>> l0_;
+    /** levels_[i] is level i + 1, nullptr if empty */
+    std::vector<std::shared_ptr<const LsmRun>> levels_;
+  };
+
+  /** level (1 based) whose size calls for a compaction, 0 for level 0, -1 if none */
+  auto PickCompaction(const Version &version) const -> int;
+  auto LevelCapacity(size_t level) const -> size_t;
+  auto WriteRun(LsmIterator *iter) const -> std::shared_ptr<const LsmRun>;
+  void BackgroundWork();
+
+  BufferPoolManager *bpm_;
+  size_t bloom_suffix_size_;
+  size_t memtable_size_;
+  size_t l0_trigger_;
+  size_t size_ratio_;
+
+  mutable std::mutex latch_;
+  std::condition_variable cv_;
+  std::shared_ptr<LsmMemTable> memtable_;
+  /** frozen memtable being written out */
+  std::shared_ptr<const LsmMemTable> immutable_;
+  std::shared_ptr<const Version> version_;
+  bool busy_{false};
+  bool stop_{false};
+  std::thread background_;
+};
+
+}  // namespace bustub
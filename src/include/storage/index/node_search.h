@@ -0,0 +1,297 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// node_search.h
+//
+// Identification: src/include/storage/index/node_search.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE4_2__)
+#include <immintrin.h>
+#endif
+
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+/** below this many entries the search window is finished with a (vectorized) linear count */
+static constexpr int NODE_SEARCH_LINEAR_WINDOW = 16;
+
+/**
+ * In-node search over the sorted (key, value) array of a B+ tree page.
+ *
+ * Every search returns the number of entries in [begin, end) that are ordered
+ * before key (LowerBound: entry < key, UpperBound: entry <= key), plus begin.
+ *
+ * When the comparator tells us the key is a single fixed-width integer column
+ * (GenericComparator::GetIntegerKeyType), the integer is read straight out of
+ * the key bytes: a branch-free binary search narrows the range down to
+ * NODE_SEARCH_LINEAR_WINDOW entries, which are then counted with AVX2/SSE4.2
+ * vector compares when the target supports them (configure with
+ * -DBUSTUB_SIMD=avx2 or sse4.2), plain scalar compares otherwise. Any other key
+ * goes through the comparator with a branch-free binary search.
+ */
+class NodeSearch {
+ public:
+  template <typename MappingType, typename KeyType, typename KeyComparator>
+  static auto LowerBound(const MappingType *array, int begin, int end, const KeyType &key, const KeyComparator &cmp)
+      -> int {
+    return Search<false>(array, begin, end, key, cmp);
+  }
+
+  template <typename MappingType, typename KeyType, typename KeyComparator>
+  static auto UpperBound(const MappingType *array, int begin, int end, const KeyType &key, const KeyComparator &cmp)
+      -> int {
+    return Search<true>(array, begin, end, key, cmp);
+  }
+
+  /** fixed-width integer search over keys stored stride bytes apart, exposed for benchmarks */
+  template <typename T, bool kUpper>
+  static auto IntegerSearch(const char *base, size_t stride, int begin, int end, T key) -> int {
+    int lo = begin;
+    int len = end - begin;
+    while (len > NODE_SEARCH_LINEAR_WINDOW) {
+      int half = len / 2;
+      T v = Load<T>(base, stride, lo + half - 1);
+      lo += (kUpper ? v <= key : v < key) ? half : 0;  // cmov, 没有分支预测失败
+      len -= half;
+    }
+    return lo + CountWindow<T, kUpper>(base, stride, lo, lo + len, key);
+  }
+
+  /**
+   * Eytzinger (BFS) layout of the entries [1, m] of a page: the entry at position k has children 2k and 2k+1, so
+   * the first levels of every search share the same few cache lines and the next levels can be prefetched before
+   * they are needed. Used by read-mostly internal pages (see BPlusTreeInternalPage::ToEytzingerLayout); position 0
+   * is not part of the layout.
+   * @return the position of the last entry whose key is <= key, 0 if there is none
+   */
+  template <typename MappingType, typename KeyType, typename KeyComparator>
+  static auto EytzingerLastNotAfter(const MappingType *array, int m, const KeyType &key, const KeyComparator &cmp)
+      -> int {
+    const auto *base = reinterpret_cast<const char *>(&array[0].first);
+    const auto *key_bytes = reinterpret_cast<const char *>(&key);
+    switch (IntegerKeyType(cmp)) {
+      case TypeId::BIGINT:
+        if constexpr (sizeof(KeyType) >= sizeof(int64_t)) {
+          return EytzingerInteger<int64_t>(base, sizeof(MappingType), m, Load<int64_t>(key_bytes, 0, 0));
+        }
+        break;
+      case TypeId::INTEGER:
+        if constexpr (sizeof(KeyType) >= sizeof(int32_t)) {
+          return EytzingerInteger<int32_t>(base, sizeof(MappingType), m, Load<int32_t>(key_bytes, 0, 0));
+        }
+        break;
+      case TypeId::SMALLINT:
+        return EytzingerInteger<int16_t>(base, sizeof(MappingType), m, Load<int16_t>(key_bytes, 0, 0));
+      case TypeId::TINYINT:
+        return EytzingerInteger<int8_t>(base, sizeof(MappingType), m, Load<int8_t>(key_bytes, 0, 0));
+      default:
+        break;
+    }
+    int k = 1;
+    int last = 0;
+    while (k <= m) {
+      bool right = cmp(array[k].first, key) <= 0;
+      last = right ? k : last;
+      k = 2 * k + static_cast<int>(right);
+    }
+    return last;
+  }
+
+  /** permute the sorted entries [1, m] of array into Eytzinger order */
+  template <typename MappingType>
+  static void ToEytzinger(MappingType *array, int m) {
+    std::vector<MappingType> sorted(array + 1, array + 1 + m);
+    int next = 0;
+    InOrder(1, m, [&](int k) { array[k] = sorted[next++]; });
+  }
+
+  /** the inverse of ToEytzinger */
+  template <typename MappingType>
+  static void FromEytzinger(MappingType *array, int m) {
+    std::vector<MappingType> sorted;
+    sorted.reserve(m);
+    InOrder(1, m, [&](int k) { sorted.push_back(array[k]); });
+    std::copy(sorted.begin(), sorted.end(), array + 1);
+  }
+
+  /** @return the position in an Eytzinger layout of m entries of the entry of sorted rank (1-based) rank */
+  static auto EytzingerPosition(int rank, int m) -> int {
+    int k = 1;
+    while (true) {
+      int left = SubtreeSize(2 * k, m);
+      if (rank == left + 1) {
+        return k;
+      }
+      k = rank <= left ? 2 * k : 2 * k + 1;
+      rank = rank <= left ? rank : rank - left - 1;
+    }
+  }
+
+  /** @return the sorted rank (1-based) of the entry at position k of an Eytzinger layout of m entries */
+  static auto EytzingerRank(int k, int m) -> int {
+    int rank = SubtreeSize(2 * k, m) + 1;
+    for (; k > 1; k /= 2) {
+      if (k % 2 == 1) {  // 右孩子: 父节点和左兄弟的子树都在它前面
+        rank += SubtreeSize(k - 1, m) + 1;
+      }
+    }
+    return rank;
+  }
+
+ private:
+  template <typename KeyComparator>
+  static auto IntegerKeyType(const KeyComparator &cmp) -> TypeId {
+    return TypeId::INVALID;
+  }
+
+  template <size_t KeySize>
+  static auto IntegerKeyType(const GenericComparator<KeySize> &cmp) -> TypeId {
+    return cmp.GetIntegerKeyType();
+  }
+
+  template <bool kUpper, typename MappingType, typename KeyType, typename KeyComparator>
+  static auto Search(const MappingType *array, int begin, int end, const KeyType &key, const KeyComparator &cmp)
+      -> int {
+    if (end <= begin) {
+      return begin;
+    }
+    const auto *base = reinterpret_cast<const char *>(&array[0].first);
+    const auto *key_bytes = reinterpret_cast<const char *>(&key);
+    switch (IntegerKeyType(cmp)) {
+      case TypeId::BIGINT:
+        if constexpr (sizeof(KeyType) >= sizeof(int64_t)) {
+          return IntegerSearch<int64_t, kUpper>(base, sizeof(MappingType), begin, end, Load<int64_t>(key_bytes, 0, 0));
+        }
+        break;
+      case TypeId::INTEGER:
+        if constexpr (sizeof(KeyType) >= sizeof(int32_t)) {
+          return IntegerSearch<int32_t, kUpper>(base, sizeof(MappingType), begin, end, Load<int32_t>(key_bytes, 0, 0));
+        }
+        break;
+      case TypeId::SMALLINT:
+        return IntegerSearch<int16_t, kUpper>(base, sizeof(MappingType), begin, end, Load<int16_t>(key_bytes, 0, 0));
+      case TypeId::TINYINT:
+        return IntegerSearch<int8_t, kUpper>(base, sizeof(MappingType), begin, end, Load<int8_t>(key_bytes, 0, 0));
+      default:
+        break;
+    }
+    // 通用 key: 用比较器做无分支二分
+    int lo = begin;
+    int len = end - begin;
+    while (len > 0) {
+      int half = len / 2;
+      int c = cmp(array[lo + half].first, key);
+      bool right = kUpper ? c <= 0 : c < 0;
+      lo = right ? lo + half + 1 : lo;
+      len = right ? len - half - 1 : half;
+    }
+    return lo;
+  }
+
+  template <typename T>
+  static auto EytzingerInteger(const char *base, size_t stride, int m, T key) -> int {
+    int k = 1;
+    int last = 0;
+    while (k <= m) {
+      __builtin_prefetch(base + stride * 16 * k);  // 四层以后的节点, 超出页尾也只是一次无用的预取
+      bool right = Load<T>(base, stride, k) <= key;
+      last = right ? k : last;
+      k = 2 * k + static_cast<int>(right);
+    }
+    return last;
+  }
+
+  /** number of positions of the subtree at position k in a layout of m entries */
+  static auto SubtreeSize(int k, int m) -> int {
+    int size = 0;
+    for (int64_t lo = k, hi = k; lo <= m; lo = 2 * lo, hi = 2 * hi + 1) {
+      size += static_cast<int>(std::min<int64_t>(hi, m) - lo + 1);
+    }
+    return size;
+  }
+
+  template <typename F>
+  static void InOrder(int k, int m, const F &visit) {
+    if (k <= m) {
+      InOrder(2 * k, m, visit);
+      visit(k);
+      InOrder(2 * k + 1, m, visit);
+    }
+  }
+
+  template <typename T>
+  static auto Load(const char *base, size_t stride, int index) -> T {
+    T v;
+    memcpy(&v, base + stride * index, sizeof(T));
+    return v;
+  }
+
+  /** number of keys in [begin, end) ordered before key */
+  template <typename T, bool kUpper>
+  static auto CountWindow(const char *base, size_t stride, int begin, int end, T key) -> int {
+    int count = 0;
+    int i = begin;
+#if defined(__AVX2__)
+    if constexpr (sizeof(T) == sizeof(int64_t)) {
+      const __m256i k = _mm256_set1_epi64x(key);
+      for (; i + 4 <= end; i += 4) {
+        __m256i v = _mm256_set_epi64x(Load<T>(base, stride, i + 3), Load<T>(base, stride, i + 2),
+                                      Load<T>(base, stride, i + 1), Load<T>(base, stride, i));
+        __m256i gt = kUpper ? _mm256_cmpgt_epi64(v, k) : _mm256_cmpgt_epi64(k, v);
+        int bits = __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(gt)));
+        count += kUpper ? 4 - bits : bits;
+      }
+    } else if constexpr (sizeof(T) == sizeof(int32_t)) {
+      const __m256i k = _mm256_set1_epi32(key);
+      for (; i + 8 <= end; i += 8) {
+        __m256i v = _mm256_set_epi32(Load<T>(base, stride, i + 7), Load<T>(base, stride, i + 6),
+                                     Load<T>(base, stride, i + 5), Load<T>(base, stride, i + 4),
+                                     Load<T>(base, stride, i + 3), Load<T>(base, stride, i + 2),
+                                     Load<T>(base, stride, i + 1), Load<T>(base, stride, i));
+        __m256i gt = kUpper ? _mm256_cmpgt_epi32(v, k) : _mm256_cmpgt_epi32(k, v);
+        int bits = __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(gt)));
+        count += kUpper ? 8 - bits : bits;
+      }
+    }
+#elif defined(__SSE4_2__)
+    if constexpr (sizeof(T) == sizeof(int64_t)) {
+      const __m128i k = _mm_set1_epi64x(key);
+      for (; i + 2 <= end; i += 2) {
+        __m128i v = _mm_set_epi64x(Load<T>(base, stride, i + 1), Load<T>(base, stride, i));
+        __m128i gt = kUpper ? _mm_cmpgt_epi64(v, k) : _mm_cmpgt_epi64(k, v);
+        int bits = __builtin_popcount(_mm_movemask_pd(_mm_castsi128_pd(gt)));
+        count += kUpper ? 2 - bits : bits;
+      }
+    } else if constexpr (sizeof(T) == sizeof(int32_t)) {
+      const __m128i k = _mm_set1_epi32(key);
+      for (; i + 4 <= end; i += 4) {
+        __m128i v = _mm_set_epi32(Load<T>(base, stride, i + 3), Load<T>(base, stride, i + 2),
+                                  Load<T>(base, stride, i + 1), Load<T>(base, stride, i));
+        __m128i gt = kUpper ? _mm_cmpgt_epi32(v, k) : _mm_cmpgt_epi32(k, v);
+        int bits = __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(gt)));
+        count += kUpper ? 4 - bits : bits;
+      }
+    }
+#endif
+    for (; i < end; i++) {
+      T v = Load<T>(base, stride, i);
+      count += static_cast<int>(kUpper ? v <= key : v < key);
+    }
+    return count;
+  }
+};
+
+}  // namespace bustub
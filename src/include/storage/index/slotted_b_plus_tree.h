@@ -0,0 +1,187 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/index/slotted_b_plus_tree.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "common/rwlatch.h"
+#include "concurrency/transaction.h"
+#include "storage/page/b_plus_tree_key_overflow_page.h"
+#include "storage/page/b_plus_tree_posting_page.h"
+#include "storage/page/b_plus_tree_slotted_page.h"
+
+namespace bustub {
+
+// 超过此长度的 key 在叶子里只存截断的前缀, 完整 key 放到 key overflow page 上
+#define SLOTTED_PAGE_INLINE_KEY_SIZE (SLOTTED_PAGE_MAX_KEY_SIZE - 1)
+
+/** the full keys (and their RIDs) of one leaf entry: one key, or all keys of an oversized-key bucket */
+using SlottedKeyEntries = std::vector<std::pair<std::string, std::vector<RID>>>;
+
+/**
+ * Forward iterator over a SlottedBPlusTree, yielding one (key, RID) pair per
+ * RID in key order, RIDs of a key in page order. Keeps the current leaf pinned
+ * and unpins it when moving to the next leaf or when destroyed.
+ */
+class SlottedIndexIterator {
+ public:
+  SlottedIndexIterator() = default;
+  SlottedIndexIterator(BufferPoolManager *bpm, Page *page, int index);
+  SlottedIndexIterator(SlottedIndexIterator &&other) noexcept;
+  auto operator=(SlottedIndexIterator &&other) noexcept -> SlottedIndexIterator &;
+  SlottedIndexIterator(const SlottedIndexIterator &) = delete;
+  auto operator=(const SlottedIndexIterator &) -> SlottedIndexIterator & = delete;
+  ~SlottedIndexIterator();
+
+  auto IsEnd() const -> bool { return page_ == nullptr; }
+
+  auto operator*() -> const std::pair<std::string, RID> &;
+
+  auto operator++() -> SlottedIndexIterator &;
+
+  auto operator==(const SlottedIndexIterator &itr) const -> bool {
+    if (page_ == nullptr || itr.page_ == nullptr) {
+      return page_ == itr.page_;
+    }
+    return page_->GetPageId() == itr.page_->GetPageId() && index_ == itr.index_ && key_index_ == itr.key_index_ &&
+           rid_index_ == itr.rid_index_;
+  }
+
+  auto operator!=(const SlottedIndexIterator &itr) const -> bool { return !(*this == itr); }
+
+ private:
+  auto Leaf() const -> BPlusTreeSlottedPage * { return reinterpret_cast<BPlusTreeSlottedPage *>(page_->GetData()); }
+  /** skip forward over exhausted (or empty) leaves */
+  void SkipExhaustedLeaves();
+  /** read the full key(s) and posting list(s) of the entry at index_ */
+  void LoadEntry();
+  void Release();
+
+  BufferPoolManager *buffer_pool_manager_{nullptr};
+  Page *page_{nullptr};
+  int index_{0};
+  SlottedKeyEntries keys_;
+  size_t key_index_{0};
+  size_t rid_index_{0};
+  std::pair<std::string, RID> item_;
+};
+
+/**
+ * B+ tree over variable-length, binary-comparable keys (see KeyEncoder), built
+ * on BPlusTreeSlottedPage.
+ *
+ * Compared with BPlusTree, a node holds as many entries as fit in its bytes
+ * rather than a fixed number of GenericKey<N> slots:
+ * (1) leaf and internal pages strip the common prefix of their fence keys
+ * (2) separators pushed up by a leaf split are suffix-truncated, so internal
+ *     pages hold the shortest key that distinguishes the two children
+ * (3) duplicate keys are stored once, with a posting list of all their RIDs
+ *     sorted by page id: delta-encoded inline in the leaf entry, moved to a
+ *     chain of BPlusTreePostingPage when it outgrows SLOTTED_PAGE_MAX_VALUE_SIZE
+ * (4) remove never merges pages, under-full leaves are left for compaction
+ * (5) a key longer than SLOTTED_PAGE_INLINE_KEY_SIZE is stored as its first
+ *     SLOTTED_PAGE_INLINE_KEY_SIZE bytes plus 0xFF; all full keys sharing that
+ *     prefix go to one bucket on a chain of BPlusTreeKeyOverflowPage. The 0xFF
+ *     keeps the truncated key after every shorter key it is a prefix of, so
+ *     the leaf order is still the order of the full keys
+ *
+ * Leaf value format:
+ *  | INLINE (1) | delta-encoded RIDs |  or  | OVERFLOW (1) | HeadPageId (4) | Count (4) |
+ *  or, for a truncated key, | KEY_OVERFLOW (1) | HeadPageId (4) |
+ * Key bucket format, split over the overflow page chain:
+ *  | KeyLen (4) | Key | RidsLen (4) | delta-encoded RIDs | ... sorted by key
+ */
+class SlottedBPlusTree {
+ public:
+  /** @param unique reject a second RID for an existing key */
+  explicit SlottedBPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, bool unique = true);
+
+  // Returns true if this B+ tree has no keys and values.
+  auto IsEmpty() const -> bool;
+
+  // Insert a key-value pair into this B+ tree, false on duplicate (key for unique trees, key-value pair
+  // otherwise).
+  auto Insert(std::string_view key, const RID &value, Transaction *transaction = nullptr) -> bool;
+
+  // Remove a key and all its values from this B+ tree.
+  void Remove(std::string_view key, Transaction *transaction = nullptr);
+
+  // Remove one key-value pair, false if it is not in the tree.
+  auto Remove(std::string_view key, const RID &value, Transaction *transaction = nullptr) -> bool;
+
+  // return the values associated with a given key, sorted by page id
+  auto GetValue(std::string_view key, std::vector<RID> *result, Transaction *transaction = nullptr) -> bool;
+
+  // return the page id of the root node
+  auto GetRootPageId() const -> page_id_t;
+
+  // number of levels, 0 for an empty tree
+  auto GetHeight() -> int;
+
+  // index iterator
+  auto Begin() -> SlottedIndexIterator;
+  auto Begin(std::string_view key) -> SlottedIndexIterator;
+  auto End() -> SlottedIndexIterator;
+
+  /** decode a leaf value (inline or overflow posting list) and append its RIDs to rids */
+  static void ReadPosting(BufferPoolManager *bpm, std::string_view payload, std::vector<RID> *rids);
+
+  /** decode the leaf entry (key, payload) into its full keys and their RIDs, in key order */
+  static void ReadEntry(BufferPoolManager *bpm, std::string_view key, std::string_view payload,
+                        SlottedKeyEntries *entries);
+
+  /** the form of key stored in the leaf: key itself, or its truncated prefix for an oversized key */
+  static auto StoredKey(std::string_view key) -> std::string;
+
+ private:
+  void UpdateRootPageId(int insert_record = 0);
+
+  /** descend to the leaf for key, the leaf stays pinned; internal pages on the way are recorded in path */
+  auto FindLeafPage(std::string_view key, bool left_most, std::vector<page_id_t> *path) -> Page *;
+
+  /** rebuild leaf from entries (its old entries plus the change that did not fit) split over two pages */
+  void SplitLeafNode(BPlusTreeSlottedPage *leaf, const std::vector<std::pair<std::string, std::string>> &entries,
+                     std::vector<page_id_t> *path);
+
+  void InsertIntoParent(page_id_t left_id, const std::string &separator, page_id_t right_id,
+                        std::vector<page_id_t> *path);
+
+  /** pick the split position so that both halves get about the same number of bytes */
+  static auto SplitPoint(const std::vector<size_t> &entry_sizes) -> size_t;
+
+  static auto InlinePosting(const std::vector<RID> &rids) -> std::string;
+  /** add rid to the posting list in payload, false if it is already there */
+  auto AddToPosting(std::string *payload, const RID &rid) -> bool;
+  /** remove rid from the posting list in payload, false if it is not there; payload is cleared once empty */
+  auto RemoveFromPosting(std::string *payload, const RID &rid) -> bool;
+  /** delete the posting pages of an overflow posting list, or the overflow pages of a key bucket */
+  void FreePosting(std::string_view payload);
+
+  /** read all full keys of the key bucket in payload */
+  static void LoadKeyBucket(BufferPoolManager *bpm, std::string_view payload, SlottedKeyEntries *entries);
+  /** write entries back to the key bucket in payload (reusing its pages); payload is cleared once empty */
+  void StoreKeyBucket(const SlottedKeyEntries &entries, std::string *payload);
+  /** add key:rid to the key bucket in payload, false on duplicate */
+  auto AddToKeyBucket(std::string *payload, std::string_view key, const RID &rid) -> bool;
+  /** remove key:rid (or all RIDs of key if rid is nullptr), false if it is not there */
+  auto RemoveFromKeyBucket(std::string *payload, std::string_view key, const RID *rid) -> bool;
+
+  std::string index_name_;
+  page_id_t root_page_id_;
+  BufferPoolManager *buffer_pool_manager_;
+  bool unique_;
+  ReaderWriterLatch latch_;
+};
+
+}  // namespace bustub
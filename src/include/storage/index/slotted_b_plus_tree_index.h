@@ -0,0 +1,55 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// slotted_b_plus_tree_index.h
+//
+// Identification: src/include/storage/index/slotted_b_plus_tree_index.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "storage/index/index.h"
+#include "storage/index/slotted_b_plus_tree.h"
+
+namespace bustub {
+
+/**
+ * Index over SlottedBPlusTree. Keys are encoded with KeyEncoder, so any key
+ * schema of fixed-width columns works without picking a GenericKey<N> size.
+ * A non-unique index keeps one entry per distinct key; ScanKey returns its
+ * RIDs sorted by page id, so fetching them from the table heap is sequential.
+ */
+class SlottedBPlusTreeIndex : public Index {
+ public:
+  SlottedBPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+                        bool unique = false);
+
+  void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
+
+  auto GetBeginIterator() -> SlottedIndexIterator;
+
+  auto GetBeginIterator(const Tuple &key) -> SlottedIndexIterator;
+
+  auto GetEndIterator() -> SlottedIndexIterator;
+
+  /** the encoded form of key, as stored in the tree */
+  auto EncodeKey(const Tuple &key) const -> std::string;
+
+ protected:
+  // container
+  SlottedBPlusTree container_;
+};
+
+}  // namespace bustub
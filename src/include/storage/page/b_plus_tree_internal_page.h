@@ -31,6 +31,12 @@ namespace bustub {
  *  --------------------------------------------------------------------------
  * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
  *  --------------------------------------------------------------------------
+ *
+ * Read-mostly layout (IndexPageType::EYTZINGER_INTERNAL_PAGE): entries [1, n] are
+ * kept in Eytzinger (BFS) order instead, entry 0 stays in place. KeyAt/ValueAt/
+ * ItemAt still take the sorted index; a descent uses ChildSlotByKey + ValueAtSlot
+ * and never leaves the layout. Every other method first turns the page back into
+ * the sorted layout, so only pages nobody writes keep paying nothing for it.
  */
 INDEX_TEMPLATE_ARGUMENTS    //模板类
 class BPlusTreeInternalPage : public BPlusTreePage {
@@ -44,6 +50,8 @@ class BPlusTreeInternalPage : public BPlusTreePage {
 
   auto IndexofInsert(KeyType key, KeyComparator &comparator) -> int;
 
+  auto ChildIndexByKey(const KeyType &key, const KeyComparator &kcomparator) const -> int;
+
   auto IndexByVal(ValueType val) -> int;
 
   auto Insert(KeyType key, ValueType value, KeyComparator &kcomparator) ->int;
@@ -77,6 +85,17 @@ class BPlusTreeInternalPage : public BPlusTreePage {
 
   void SetKeyByIndex(KeyType key, int index);
 
+  // Eytzinger 只读布局, REINDEX 之后的内部页用它
+  void ToEytzingerLayout();
+  void ToSortedLayout();
+  auto IsEytzingerLayout() const -> bool;
+
+  // 有序下标 -> 物理 slot; 有序布局下两者相同
+  auto SlotAt(int index) const -> int;
+  auto ValueAtSlot(int slot) const -> ValueType;
+  // 下降用: key 所在子节点的物理 slot, 与 SlotAt(ChildIndexByKey(key)) 相同
+  auto ChildSlotByKey(const KeyType &key, const KeyComparator &kcomparator) const -> int;
+
 
  private:
   // Flexible array member for page data.       //弹性数组，页数据
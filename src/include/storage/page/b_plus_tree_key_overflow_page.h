@@ -0,0 +1,65 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/page/b_plus_tree_key_overflow_page.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "common/config.h"
+
+namespace bustub {
+
+#define KEY_OVERFLOW_PAGE_HEADER_SIZE 12
+#define KEY_OVERFLOW_PAGE_DATA_SIZE (BUSTUB_PAGE_SIZE - KEY_OVERFLOW_PAGE_HEADER_SIZE)
+
+/**
+ * Overflow page for oversized keys in SlottedBPlusTree.
+ *
+ * A key longer than SLOTTED_PAGE_INLINE_KEY_SIZE is not stored in the leaf.
+ * The leaf holds its truncated prefix instead, and the value of that entry
+ * points to a chain of key overflow pages. The chain holds every full key that
+ * shares the prefix, together with its RIDs, as one opaque byte string split
+ * over the pages in order.
+ *
+ * Page format:
+ *  ---------------------------------------------------------
+ * | PageId (4) | NextPageId (4) | DataLen (4) | DATA ... |
+ *  ---------------------------------------------------------
+ */
+class BPlusTreeKeyOverflowPage {
+ public:
+  void Init(page_id_t page_id);
+
+  auto GetPageId() const -> page_id_t { return page_id_; }
+  auto GetNextPageId() const -> page_id_t { return next_page_id_; }
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  /** append the bytes of this page to out */
+  void Load(std::string *out) const;
+
+  /**
+   * Replace the content of this page with as many leading bytes of data as fit.
+   * @return the number of bytes stored
+   */
+  auto Store(std::string_view data) -> size_t;
+
+ private:
+  auto Data() -> char * { return reinterpret_cast<char *>(this) + KEY_OVERFLOW_PAGE_HEADER_SIZE; }
+  auto Data() const -> const char * { return reinterpret_cast<const char *>(this) + KEY_OVERFLOW_PAGE_HEADER_SIZE; }
+
+  page_id_t page_id_;
+  page_id_t next_page_id_;
+  int32_t data_len_;
+};
+
+static_assert(sizeof(BPlusTreeKeyOverflowPage) == KEY_OVERFLOW_PAGE_HEADER_SIZE);
+
+}  // namespace bustub
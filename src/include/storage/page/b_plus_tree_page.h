@@ -25,7 +25,8 @@ namespace bustub {
 #define INDEX_TEMPLATE_ARGUMENTS template <typename KeyType, typename ValueType, typename KeyComparator>
 
 // define page type enum， 页枚举
-enum class IndexPageType { INVALID_INDEX_PAGE = 0, LEAF_PAGE, INTERNAL_PAGE };
+// EYTZINGER_INTERNAL_PAGE: REINDEX 建出来的只读内部页, 见 BPlusTreeInternalPage::ToEytzingerLayout
+enum class IndexPageType { INVALID_INDEX_PAGE = 0, LEAF_PAGE, INTERNAL_PAGE, EYTZINGER_INTERNAL_PAGE };
 
 /**
  * Both internal and leaf page are inherited from this page.
@@ -45,6 +46,7 @@ class BPlusTreePage {
   auto IsLeafPage() const -> bool;
   auto IsRootPage(page_id_t rootId) const -> bool;
   void SetPageType(IndexPageType page_type);
+  auto GetPageType() const -> IndexPageType;
 
   auto GetSize() const -> int;
   void SetSize(int size);
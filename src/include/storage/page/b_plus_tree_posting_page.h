@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/page/b_plus_tree_posting_page.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "common/config.h"
+#include "common/rid.h"
+
+namespace bustub {
+
+#define POSTING_PAGE_HEADER_SIZE 24
+#define POSTING_PAGE_DATA_SIZE (BUSTUB_PAGE_SIZE - POSTING_PAGE_HEADER_SIZE)
+
+/**
+ * Overflow page for the RID posting list of one key in SlottedBPlusTree.
+ *
+ * A posting list is the sorted set of RIDs of one key. RIDs are ordered by
+ * RID::Get() (page id, then slot), so reading them in order visits the table
+ * heap sequentially. The list is delta-encoded: the first RID is written as a
+ * varint, every following RID as the varint of its distance to the previous.
+ *
+ * Small lists live inline in the leaf entry. A list that outgrows the leaf is
+ * moved to a chain of posting pages; every page holds a self-contained run
+ * (its first RID is absolute) and the chain is sorted, so an insert or delete
+ * only decodes and rewrites one page.
+ *
+ * Page format:
+ *  ------------------------------------------------------------------------------
+ * | PageId (4) | NextPageId (4) | Count (4) | DataLen (4) | LastRid (8) | DATA ... |
+ *  ------------------------------------------------------------------------------
+ */
+class BPlusTreePostingPage {
+ public:
+  void Init(page_id_t page_id);
+
+  auto GetPageId() const -> page_id_t { return page_id_; }
+  auto GetNextPageId() const -> page_id_t { return next_page_id_; }
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+  auto GetCount() const -> int { return count_; }
+  /** the biggest RID on this page, used to pick the page a RID belongs to */
+  auto GetLastRid() const -> int64_t { return last_rid_; }
+
+  /** decode all RIDs of this page and append them to rids */
+  void Load(std::vector<RID> *rids) const;
+
+  /**
+   * Replace the content of this page with rids[begin, end).
+   * @return false (page unchanged) if the encoded run does not fit
+   */
+  auto Store(const std::vector<RID> &rids, size_t begin, size_t end) -> bool;
+
+  /** delta-encode rids[begin, end) (sorted, no duplicates) and append the bytes to out */
+  static void Encode(const std::vector<RID> &rids, size_t begin, size_t end, std::string *out);
+
+  /** decode a run written by Encode and append the RIDs to rids */
+  static void Decode(std::string_view bytes, std::vector<RID> *rids);
+
+ private:
+  auto Data() -> char * { return reinterpret_cast<char *>(this) + POSTING_PAGE_HEADER_SIZE; }
+  auto Data() const -> const char * { return reinterpret_cast<const char *>(this) + POSTING_PAGE_HEADER_SIZE; }
+
+  page_id_t page_id_;
+  page_id_t next_page_id_;
+  int32_t count_;
+  int32_t data_len_;
+  int64_t last_rid_;
+};
+
+static_assert(sizeof(BPlusTreePostingPage) == POSTING_PAGE_HEADER_SIZE);
+
+}  // namespace bustub
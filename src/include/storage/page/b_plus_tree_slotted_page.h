@@ -0,0 +1,160 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/page/b_plus_tree_slotted_page.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define SLOTTED_PAGE_HEADER_SIZE 40
+#define SLOTTED_PAGE_SLOT_SIZE 6
+#define SLOTTED_PAGE_VALUE_SIZE 8
+#define SLOTTED_PAGE_MAX_KEY_SIZE (BUSTUB_PAGE_SIZE / 8)     // 超过此长度的 key 不能放进页内
+#define SLOTTED_PAGE_MAX_VALUE_SIZE (BUSTUB_PAGE_SIZE / 16)  // 超过此长度的 value 不能放进页内
+
+/**
+ * Variable-length slotted page used by SlottedBPlusTree for both leaf and
+ * internal nodes. Keys are opaque byte strings compared with memcmp (see
+ * storage/index/key_encoder.h). Values are byte strings as well: internal
+ * pages store 8-byte child page ids, leaf pages store whatever the tree puts
+ * there (SlottedBPlusTree stores RID posting lists).
+ *
+ * Every page stores its lower and upper fence keys: all keys that can ever be
+ * routed to this page satisfy lower <= K < upper. The common prefix of the two
+ * fences is therefore shared by every key in the page, so it is stored only once
+ * (inside the lower fence) and stripped from every entry (prefix compression).
+ * An infinite upper fence disables the prefix.
+ *
+ * As in BPlusTreeInternalPage, the key of slot 0 in an internal page is never
+ * stored; KeyAt(0) returns the lower fence.
+ *
+ * Page format:
+ *  ---------------------------------------------------------------------------------
+ * | HEADER | LOWER FENCE | UPPER FENCE | SLOT(0) ... SLOT(n-1) | FREE | ... ENTRIES |
+ *  ---------------------------------------------------------------------------------
+ *                                                                      ^
+ *                                                                      free space offset
+ *  Header format (size in byte, 40 bytes in total):
+ *  ---------------------------------------------------------------------
+ * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
+ *  ---------------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | NextPageId (4) | FreeSpaceOffset (2) |
+ *  ---------------------------------------------------------------------
+ * | GarbageBytes (2) | LowerFenceLen (2) | UpperFenceLen (2) | PrefixLen (2) | Reserved (2) |
+ *  ---------------------------------------------------------------------
+ *
+ *  Slot format:  | EntryOffset (2) | SuffixLen (2) | ValueLen (2) |
+ *  Entry format: | KEY SUFFIX (SuffixLen) | VALUE (ValueLen) |
+ */
+class BPlusTreeSlottedPage : public BPlusTreePage {
+ public:
+  static constexpr uint16_t UPPER_FENCE_INFINITY = 0xFFFF;
+
+  // After creating a new page from buffer pool, must call initialize method to set default values
+  void Init(page_id_t page_id, IndexPageType page_type, std::string_view lower_fence, std::string_view upper_fence,
+            bool upper_is_infinity);
+
+  auto GetNextPageId() const -> page_id_t;
+  void SetNextPageId(page_id_t next_page_id);
+
+  /** fence keys and common prefix */
+  auto GetLowerFence() const -> std::string_view;
+  auto GetUpperFence() const -> std::string_view;
+  auto IsUpperInfinity() const -> bool;
+  auto GetPrefix() const -> std::string_view;
+
+  /** full key (prefix + suffix) at index; slot 0 of an internal page returns the lower fence */
+  auto KeyAt(int index) const -> std::string;
+  auto SuffixAt(int index) const -> std::string_view;
+  /** value at index read as an 8-byte integer, for pages whose values are child page ids or RIDs */
+  auto ValueAt(int index) const -> int64_t;
+  void SetValueAt(int index, int64_t value);
+  auto PayloadAt(int index) const -> std::string_view;
+
+  /**
+   * Replace the value at index, moving the entry if the size changes.
+   * @return false (page unchanged) if the page does not have enough room
+   */
+  auto SetPayloadAt(int index, std::string_view payload) -> bool;
+
+  /** compare key with the key at index, <0 key smaller, 0 equal, >0 key bigger */
+  auto CompareAt(std::string_view key, int index) const -> int;
+
+  /** leaf: index of the first key >= key, GetSize() if none */
+  auto LowerBound(std::string_view key) const -> int;
+
+  /** internal: index of the child whose range contains key */
+  auto ChildIndex(std::string_view key) const -> int;
+
+  /**
+   * Insert key:value at index, compacting the page first if necessary.
+   * @return false if the page does not have enough room even after compaction
+   */
+  auto InsertAt(int index, std::string_view key, int64_t value) -> bool;
+  auto InsertAt(int index, std::string_view key, std::string_view payload) -> bool;
+
+  /** append key:value after the last entry, the caller guarantees order and space */
+  void Append(std::string_view key, int64_t value);
+  void Append(std::string_view key, std::string_view payload);
+
+  void RemoveAt(int index);
+
+  /** bytes an entry for key takes on this page (slot + suffix + value) */
+  auto EntrySize(std::string_view key, size_t value_size = SLOTTED_PAGE_VALUE_SIZE) const -> int;
+  auto GetFreeSpace() const -> int;
+  auto GetGarbageBytes() const -> int;
+
+  /** bytes taken by live entries (slots included), fences and header excluded */
+  auto GetUsedBytes() const -> int;
+
+  /** rewrite the entry heap so that the space of removed entries becomes free again */
+  void Compact();
+
+  /** copy out all entries with full keys, used when splitting or rebuilding a page */
+  void CopyEntries(std::vector<std::pair<std::string, int64_t>> *entries) const;
+  void CopyEntries(std::vector<std::pair<std::string, std::string>> *entries) const;
+
+  /**
+   * Suffix truncation: the shortest key S with left < S <= right.
+   * left must be strictly smaller than right.
+   */
+  static auto ShortestSeparator(std::string_view left, std::string_view right) -> std::string;
+
+  /** length of the common prefix of two keys */
+  static auto CommonPrefixLength(std::string_view a, std::string_view b) -> size_t;
+
+ private:
+  auto Data() -> char * { return reinterpret_cast<char *>(this); }
+  auto Data() const -> const char * { return reinterpret_cast<const char *>(this); }
+  auto SlotAreaOffset() const -> int;
+  auto SlotOffset(int index) const -> uint16_t;
+  auto SlotKeyLen(int index) const -> uint16_t;
+  auto SlotValueLen(int index) const -> uint16_t;
+  void SetSlot(int index, uint16_t offset, uint16_t key_len, uint16_t value_len);
+  void WriteEntry(int index, std::string_view suffix, std::string_view payload);
+
+  page_id_t next_page_id_;
+  uint16_t free_space_offset_;
+  uint16_t garbage_bytes_;
+  uint16_t lower_fence_len_;
+  uint16_t upper_fence_len_;
+  uint16_t prefix_len_;
+  uint16_t reserved_;
+};
+
+static_assert(sizeof(BPlusTreeSlottedPage) == SLOTTED_PAGE_HEADER_SIZE);
+
+}  // namespace bustub
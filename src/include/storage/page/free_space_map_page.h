@@ -0,0 +1,62 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map_page.h
+//
+// Identification: src/include/storage/page/free_space_map_page.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+
+#include "common/config.h"
+
+namespace bustub {
+
+#define FSM_PAGE_HEADER_SIZE 8
+#define FSM_PAGE_CAPACITY ((BUSTUB_PAGE_SIZE - FSM_PAGE_HEADER_SIZE) / (sizeof(page_id_t) + sizeof(uint8_t)))
+
+/**
+ * One page of a table heap's free-space map (see FreeSpaceMap). Entry i records a heap page and its free-space
+ * category, the free bytes of the page in units of FSM_CATEGORY_SIZE rounded down. Entries are in heap order; the
+ * pages of one map are chained through NextPageId.
+ *
+ * Page format:
+ *  -----------------------------------------------------------------------------------------
+ * | NextPageId (4) | Count (4) | HeapPageId_1 (4) ... HeapPageId_n (4) | Category_1 (1) ... |
+ *  -----------------------------------------------------------------------------------------
+ */
+class FreeSpaceMapPage {
+ public:
+  void Init();
+
+  auto GetNextPageId() const -> page_id_t { return next_page_id_; }
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  auto GetCount() const -> uint32_t { return count_; }
+  auto IsFull() const -> bool { return count_ == FSM_PAGE_CAPACITY; }
+
+  /** @return the heap page of entry i, INVALID_PAGE_ID if the page was removed from the heap */
+  auto GetHeapPageId(uint32_t i) const -> page_id_t { return heap_page_ids_[i]; }
+  void SetHeapPageId(uint32_t i, page_id_t heap_page_id) { heap_page_ids_[i] = heap_page_id; }
+  auto GetCategory(uint32_t i) const -> uint8_t { return categories_[i]; }
+  void SetCategory(uint32_t i, uint8_t category) { categories_[i] = category; }
+
+  /** Append an entry; the page must not be full. */
+  void Append(page_id_t heap_page_id, uint8_t category);
+
+ private:
+  page_id_t next_page_id_;
+  uint32_t count_;
+  page_id_t heap_page_ids_[FSM_PAGE_CAPACITY];
+  uint8_t categories_[FSM_PAGE_CAPACITY];
+};
+
+static_assert(sizeof(FreeSpaceMapPage) <= BUSTUB_PAGE_SIZE);
+
+}  // namespace bustub
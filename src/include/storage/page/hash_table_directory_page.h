@@ -27,9 +27,12 @@ namespace bustub {
  * Directory Page for extendible hash table.
  *
  * Directory format (size in byte):
- * --------------------------------------------------------------------------------------------
- * | LSN (4) | PageId(4) | GlobalDepth(4) | LocalDepths(512) | BucketPageIds(2048) | Free(1524)
- * --------------------------------------------------------------------------------------------
+ * ---------------------------------------------------------------------------------------------------------
+ * | LSN (4) | PageId(4) | GlobalDepth(4) | LocalDepths(512) | BucketPageIds(2048) | Version(4) | Free(1520)
+ * ---------------------------------------------------------------------------------------------------------
+ *
+ * Version is bumped on every change of the bucket mapping (split, merge, growing or shrinking the directory), so a
+ * reader that looked up a bucket without holding the directory latch can tell whether its mapping is still current.
  */
 class HashTableDirectoryPage {
  public:
@@ -171,6 +174,16 @@ class HashTableDirectoryPage {
    */
   auto GetLocalHighBit(uint32_t bucket_idx) -> uint32_t;
 
+  /**
+   * @return the mapping version, see the class comment
+   */
+  auto GetVersion() const -> uint32_t;
+
+  /**
+   * Bump the mapping version, called under the directory write latch after changing bucket page ids or depths
+   */
+  void IncrVersion();
+
   /**
    * VerifyIntegrity
    *
@@ -192,6 +205,7 @@ class HashTableDirectoryPage {
   uint32_t global_depth_{0};
   uint8_t local_depths_[DIRECTORY_ARRAY_SIZE];
   page_id_t bucket_page_ids_[DIRECTORY_ARRAY_SIZE];
+  uint32_t version_{0};
 };
 
 }  // namespace bustub
@@ -14,6 +14,8 @@
 
 #include <cstring>
 #include <iostream>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 #include "common/rwlatch.h"
@@ -66,6 +68,28 @@ class Page {
   /** Sets the page LSN. */
   inline void SetLSN(lsn_t lsn) { memcpy(GetData() + OFFSET_LSN, &lsn, sizeof(lsn_t)); }
 
+  /**
+   * Pointer swizzling for index inner nodes: the frame of a child, by slot. The page data keeps the child page ids,
+   * a swizzled reference only lives in this frame. The references belong to the index (BPlusTree): it holds a pin on
+   * every referenced child and only swizzles into frames it keeps pinned itself, so the buffer pool never evicts or
+   * deletes a frame that has references and never touches them.
+   * @return the child frame, nullptr if slot is not swizzled
+   */
+  inline auto GetSwizzledChild(size_t slot) -> Page * {
+    return slot < swizzled_children_.size() ? swizzled_children_[slot] : nullptr;
+  }
+
+  /** Remember the frame of the child in slot. */
+  inline void SwizzleChild(size_t slot, Page *child) {
+    if (slot >= swizzled_children_.size()) {
+      swizzled_children_.resize(slot + 1, nullptr);
+    }
+    swizzled_children_[slot] = child;
+  }
+
+  /** Take all swizzled references out of this frame; the caller releases the pins they hold. */
+  inline auto UnswizzleChildren() -> std::vector<Page *> { return std::exchange(swizzled_children_, {}); }
+
  protected:
   static_assert(sizeof(page_id_t) == 4);
   static_assert(sizeof(lsn_t) == 4);
@@ -88,6 +112,8 @@ class Page {
   bool is_dirty_ = false;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
+  /** Swizzled child references, slot -> child frame (see GetSwizzledChild). */
+  std::vector<Page *> swizzled_children_;
 };
 
 }  // namespace bustub
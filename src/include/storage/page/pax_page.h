@@ -0,0 +1,255 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pax_page.h
+//
+// Identification: src/include/storage/page/pax_page.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "catalog/schema.h"
+#include "storage/page/table_page.h"
+
+namespace bustub {
+
+/**
+ * Where the minipages of a PaxPage sit, for one schema. Every page of a PAX table has the same layout, so the table
+ * heap computes it once (see TableHeap).
+ *
+ * The capacity (slots per page) is chosen so that a page of average rows fills up its minipages and its varchar heap
+ * at about the same time; a VARCHAR(n) column is assumed to hold about n / 2 bytes.
+ */
+class PaxLayout {
+  friend class PaxPage;
+
+ public:
+  explicit PaxLayout(const Schema &schema);
+
+  auto GetSchema() const -> const Schema & { return schema_; }
+
+  /** @return the number of slots of a page */
+  auto GetCapacity() const -> uint32_t { return capacity_; }
+
+  /** @return the largest tuple (in the format of Tuple) an empty page holds */
+  auto MaxTupleSize() const -> uint32_t { return BUSTUB_PAGE_SIZE - data_end_ + row_overhead_; }
+
+ private:
+  /** TablePage header and VarBytes */
+  static constexpr uint32_t SIZE_PAX_PAGE_HEADER = 32;
+
+  /** the minipage of one column */
+  struct Minipage {
+    /** null bitmap, a bit per slot */
+    uint32_t nulls_offset_;
+    /** capacity values of width_ bytes; a varchar value is the (offset, length) of its bytes in the varchar heap */
+    uint32_t values_offset_;
+    uint32_t width_;
+  };
+
+  /** lay out the bitmaps and minipages of capacity slots; @return where the varchar heap may start */
+  auto Place(uint32_t capacity) -> uint32_t;
+
+  Schema schema_;
+  uint32_t capacity_;
+  /** size of a bitmap of capacity bits, whole 64-bit words */
+  uint32_t bitmap_size_;
+  uint32_t present_offset_;
+  uint32_t deleted_offset_;
+  std::vector<Minipage> minipages_;
+  /** end of the last minipage: the varchar heap grows down from the end of the page to here */
+  uint32_t data_end_;
+  /** bytes of a tuple that are not varchar data: the fixed-length part and a length per varchar */
+  uint32_t row_overhead_;
+  /** every column referenced, for reading whole tuples */
+  std::vector<bool> all_columns_;
+};
+
+/**
+ * PAX (Partition Attributes Across) page: the tuples of the page are stored column by column, in a minipage per
+ * column, so a scan that needs two columns of a wide table reads two dense arrays instead of every byte of every row.
+ * The page keeps the header of TablePage, so the heap links, the free-space map and the page id work the same; only
+ * the tuple methods differ, and they take the PaxLayout of the table. Call them through PaxPage, never through
+ * TablePage: the names are hidden, not overridden.
+ *
+ * Page format:
+ *  --------------------------------------------------------------------------------------------------
+ *  | TablePage header (28) | VarBytes (4) | present bitmap | deleted bitmap | minipage 1 | ... | minipage n |
+ *  --------------------------------------------------------------------------------------------------
+ *  ---------------------------------------------------
+ *  | ... FREE SPACE ... | ... VARCHAR HEAP ... |
+ *  ---------------------------------------------------
+ *                       ^
+ *                       free space pointer
+ *
+ *  Minipage format: | null bitmap | value_1 | value_2 | ... | value_capacity |
+ *
+ * A slot is live if its present bit is set and its deleted bit (MarkDelete) is not. TupleCount is one past the
+ * highest slot ever used. VarBytes counts the live bytes of the varchar heap; what ApplyDelete and UpdateTuple leave
+ * behind is reclaimed by compacting the heap when an insert needs the space.
+ *
+ * A NULL is stored like in a row (the NULL value of the type, or a varchar of length BUSTUB_VALUE_NULL) and also
+ * flagged in the null bitmap of its minipage.
+ */
+class PaxPage : public TablePage {
+ public:
+  /** Initialize the header and clear the bitmaps, see TablePage::Init */
+  void Init(const PaxLayout &layout, page_id_t page_id, uint32_t page_size, page_id_t prev_page_id,
+            LogManager *log_manager, Transaction *txn);
+
+  /**
+   * @return the free space in the units of TablePage: a tuple of n bytes fits iff TablePage::SpaceForTuple(n) is at
+   * most this, so the free-space map and TableHeap treat both layouts alike
+   */
+  auto GetFreeSpaceRemaining(const PaxLayout &layout) -> uint32_t;
+
+  /** see TablePage::InsertTuple */
+  auto InsertTuple(const PaxLayout &layout, const Tuple &tuple, RID *rid, Transaction *txn, LockManager *lock_manager,
+                   LogManager *log_manager) -> bool;
+
+  /** see TablePage::AppendTuple */
+  auto AppendTuple(const PaxLayout &layout, const char *data, uint32_t size, RID *rid) -> bool;
+
+  /** see TablePage::MarkDelete */
+  auto MarkDelete(const PaxLayout &layout, const RID &rid, Transaction *txn, LockManager *lock_manager,
+                  LogManager *log_manager) -> bool;
+
+  /** see TablePage::UpdateTuple */
+  auto UpdateTuple(const PaxLayout &layout, const Tuple &new_tuple, Tuple *old_tuple, const RID &rid,
+                   Transaction *txn, LockManager *lock_manager, LogManager *log_manager) -> bool;
+
+  /** see TablePage::ApplyDelete */
+  void ApplyDelete(const PaxLayout &layout, const RID &rid, Transaction *txn, LogManager *log_manager,
+                   Tuple *deleted_tuple = nullptr);
+
+  /** see TablePage::RollbackDelete */
+  void RollbackDelete(const PaxLayout &layout, const RID &rid, Transaction *txn, LogManager *log_manager);
+
+  /** Read a tuple, put back together in the format of Tuple; see TablePage::GetTuple */
+  auto GetTuple(const PaxLayout &layout, const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager)
+      -> bool;
+
+  /**
+   * Put the live tuples of this page together in rows, a column at a time, and append a view of each to views.
+   * @param columns the columns to fill in, nullptr for all; the others read as garbage (zero, or a NULL varchar)
+   * @param[out] rows overwritten with the rows; views made into it by earlier calls become invalid
+   */
+  void GetTupleViews(const PaxLayout &layout, const std::vector<uint32_t> *columns, std::vector<char> *rows,
+                     std::vector<TupleView> *views);
+
+  /** see TablePage::GetFirstTupleRid */
+  auto GetFirstTupleRid(const PaxLayout &layout, RID *first_rid) -> bool;
+
+  /** see TablePage::GetNextTupleRid */
+  auto GetNextTupleRid(const PaxLayout &layout, const RID &cur_rid, RID *next_rid) -> bool;
+
+  /**
+   * Move the live varchar data together at the end of the page and drop the free slots at the end, see
+   * TablePage::Compact.
+   * @return the bytes freed
+   */
+  auto Compact(const PaxLayout &layout) -> uint32_t;
+
+  /** see TablePage::HasMarkedDeletes */
+  auto HasMarkedDeletes(const PaxLayout &layout) -> bool;
+
+  /** @return one past the highest slot in use; the slots to look at with GetLiveBits */
+  auto GetSlotCount() -> uint32_t { return GetTupleCount(); }
+
+  /** @return the live bits of slots [64 * word, 64 * word + 64) */
+  auto GetLiveBits(const PaxLayout &layout, uint32_t word) -> uint64_t {
+    return Bitmap(layout.present_offset_)[word] & ~Bitmap(layout.deleted_offset_)[word];
+  }
+
+  /** @return the values of an inlined column, value i of slot i; only live slots hold a value */
+  auto GetColumnData(const PaxLayout &layout, uint32_t column_idx) -> const char * {
+    return GetData() + layout.minipages_[column_idx].values_offset_;
+  }
+
+  /** @return the bytes of a varchar column in slot, with the trailing '\0'; nullptr if it is NULL */
+  auto GetVarcharData(const PaxLayout &layout, uint32_t column_idx, uint32_t slot) -> const char * {
+    const VarcharEntry *entry = GetVarchar(layout, column_idx, slot);
+    return entry->length_ == BUSTUB_VALUE_NULL ? nullptr : GetData() + entry->offset_;
+  }
+
+  /** @return true if the value of column_idx in slot is NULL */
+  auto IsNull(const PaxLayout &layout, uint32_t column_idx, uint32_t slot) -> bool {
+    return TestBit(Bitmap(layout.minipages_[column_idx].nulls_offset_), slot);
+  }
+
+ private:
+  static constexpr size_t OFFSET_VAR_BYTES = SIZE_TABLE_PAGE_HEADER;
+
+  /** a varchar value in its minipage */
+  struct VarcharEntry {
+    uint32_t offset_;
+    /** the length as in a row: with the trailing '\0', or BUSTUB_VALUE_NULL */
+    uint32_t length_;
+  };
+
+  static auto TestBit(const uint64_t *bitmap, uint32_t i) -> bool { return ((bitmap[i / 64] >> (i % 64)) & 1) != 0; }
+  static void SetBit(uint64_t *bitmap, uint32_t i) { bitmap[i / 64] |= uint64_t{1} << (i % 64); }
+  static void ClearBit(uint64_t *bitmap, uint32_t i) { bitmap[i / 64] &= ~(uint64_t{1} << (i % 64)); }
+
+  auto Bitmap(uint32_t offset) -> uint64_t * { return reinterpret_cast<uint64_t *>(GetData() + offset); }
+
+  auto GetVarBytes() -> uint32_t { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_VAR_BYTES); }
+  void SetVarBytes(uint32_t var_bytes) { memcpy(GetData() + OFFSET_VAR_BYTES, &var_bytes, sizeof(uint32_t)); }
+
+  auto GetVarchar(const PaxLayout &layout, uint32_t column_idx, uint32_t slot) -> VarcharEntry * {
+    return reinterpret_cast<VarcharEntry *>(GetData() + layout.minipages_[column_idx].values_offset_) + slot;
+  }
+
+  /** @return true if slot holds a tuple that is not marked deleted */
+  auto IsLive(const PaxLayout &layout, uint32_t slot) -> bool {
+    return TestBit(Bitmap(layout.present_offset_), slot) && !TestBit(Bitmap(layout.deleted_offset_), slot);
+  }
+
+  /** @return the first slot without a tuple, or the capacity if the page is full */
+  auto FindFreeSlot(const PaxLayout &layout) -> uint32_t;
+
+  /** @return the first live slot at or after slot, or GetTupleCount() if there is none */
+  auto NextLiveSlot(const PaxLayout &layout, uint32_t slot) -> uint32_t;
+
+  /** @return the varchar bytes of slot, the heap space it takes */
+  auto VarBytesOf(const PaxLayout &layout, uint32_t slot) -> uint32_t;
+
+  /**
+   * Split a tuple of size bytes into the minipages at slot, compacting the varchar heap if its free space is in
+   * pieces. The page must have room for it, see GetFreeSpaceRemaining.
+   */
+  void WriteSlot(const PaxLayout &layout, uint32_t slot, const char *data, uint32_t size);
+
+  /** put the tuple of slot back together into tuple */
+  void ReadSlot(const PaxLayout &layout, uint32_t slot, const RID &rid, Tuple *tuple);
+
+  /** give the varchar bytes of slot back to the heap */
+  void ReleaseVarchars(const PaxLayout &layout, uint32_t slot);
+
+  /** move the live varchar data to the end of the page so the free space is in one piece */
+  void CompactHeap(const PaxLayout &layout);
+
+  /**
+   * Write the given slots as rows, a column at a time. The row of slots[i] starts at out + row_offsets[i] and is
+   * row_sizes[i] bytes (see RowSize).
+   */
+  void WriteRows(const PaxLayout &layout, const std::vector<uint32_t> &slots, const std::vector<bool> &referenced,
+                 const std::vector<uint32_t> &row_offsets, char *out);
+
+  /** @return the length of slot as a row in which only the referenced varchars carry their data */
+  auto RowSize(const PaxLayout &layout, uint32_t slot, const std::vector<bool> &referenced) -> uint32_t;
+
+  /** take the lock of a tuple that is about to change, upgrading a shared lock, see TablePage::MarkDelete */
+  static auto LockForWrite(const RID &rid, Transaction *txn, LockManager *lock_manager) -> bool;
+
+  /** append a log record for a change of this page */
+  void AppendLog(LogRecord *log_record, Transaction *txn, LogManager *log_manager);
+};
+
+}  // namespace bustub
@@ -0,0 +1,64 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_overflow_page.h
+//
+// Identification: src/include/storage/page/table_overflow_page.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "common/config.h"
+
+namespace bustub {
+
+#define TABLE_OVERFLOW_PAGE_HEADER_SIZE 12
+#define TABLE_OVERFLOW_PAGE_DATA_SIZE (BUSTUB_PAGE_SIZE - TABLE_OVERFLOW_PAGE_HEADER_SIZE)
+
+/**
+ * Overflow page for a VARCHAR value of a table stored out of line (see Toast).
+ *
+ * The tuple keeps a pointer to the first page of a chain and a prefix of the value; the chain holds the whole
+ * value, split over the pages in order. A chain belongs to one value of one tuple and is deleted with it.
+ *
+ * Page format:
+ *  ---------------------------------------------------------
+ * | PageId (4) | NextPageId (4) | DataLen (4) | DATA ... |
+ *  ---------------------------------------------------------
+ */
+class TableOverflowPage {
+ public:
+  void Init(page_id_t page_id);
+
+  auto GetPageId() const -> page_id_t { return page_id_; }
+  auto GetNextPageId() const -> page_id_t { return next_page_id_; }
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  /** append the bytes of this page to out */
+  void Load(std::string *out) const;
+
+  /**
+   * Replace the content of this page with as many leading bytes of data as fit.
+   * @return the number of bytes stored
+   */
+  auto Store(std::string_view data) -> size_t;
+
+ private:
+  auto Data() -> char * { return reinterpret_cast<char *>(this) + TABLE_OVERFLOW_PAGE_HEADER_SIZE; }
+  auto Data() const -> const char * { return reinterpret_cast<const char *>(this) + TABLE_OVERFLOW_PAGE_HEADER_SIZE; }
+
+  page_id_t page_id_;
+  page_id_t next_page_id_;
+  int32_t data_len_;
+};
+
+static_assert(sizeof(TableOverflowPage) == TABLE_OVERFLOW_PAGE_HEADER_SIZE);
+
+}  // namespace bustub
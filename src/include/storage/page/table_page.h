@@ -13,12 +13,14 @@
 #pragma once
 
 #include <cstring>
+#include <vector>
 
 #include "common/rid.h"
 #include "concurrency/lock_manager.h"
 #include "recovery/log_manager.h"
 #include "storage/page/page.h"
 #include "storage/table/tuple.h"
+#include "storage/table/tuple_view.h"
 
 static constexpr uint64_t DELETE_MASK = (1U << (8 * sizeof(uint32_t) - 1));
 
@@ -36,9 +38,11 @@ namespace bustub {
  *  ----------------------------------------------------------------------------
  *  | PageId (4)| LSN (4)| PrevPageId (4)| NextPageId (4)| FreeSpacePointer(4) |
  *  ----------------------------------------------------------------------------
- *  ----------------------------------------------------------------
- *  | TupleCount (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
- *  ----------------------------------------------------------------
+ *  ---------------------------------------------------------------------------------
+ *  | TupleCount (4) | FsmPageId (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
+ *  ---------------------------------------------------------------------------------
+ *
+ *  FsmPageId is only set on the first page of a table heap: the first page of its free-space map.
  *
  */
 class TablePage : public Page {
@@ -72,6 +76,23 @@ class TablePage : public Page {
     memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
   }
 
+  /** @return the first page of the table heap's free-space map, only set on the first page of the heap */
+  auto GetFsmPageId() -> page_id_t { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_FSM_PAGE_ID); }
+
+  /** Set the first page of the table heap's free-space map. */
+  void SetFsmPageId(page_id_t fsm_page_id) { memcpy(GetData() + OFFSET_FSM_PAGE_ID, &fsm_page_id, sizeof(page_id_t)); }
+
+  /** @return the bytes left for new tuples and their slots */
+  auto GetFreeSpaceRemaining() -> uint32_t {
+    return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
+  }
+
+  /** @return the space a tuple of tuple_size bytes takes in a page, with its slot */
+  static constexpr auto SpaceForTuple(uint32_t tuple_size) -> uint32_t { return tuple_size + SIZE_TUPLE; }
+
+  /** @return the largest tuple an empty page holds */
+  static constexpr auto MaxTupleSize() -> uint32_t { return BUSTUB_PAGE_SIZE - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE; }
+
   /**
    * Insert a tuple into the table.
    * @param tuple tuple to insert
@@ -84,6 +105,16 @@ class TablePage : public Page {
   auto InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager)
       -> bool;
 
+  /**
+   * Append a tuple in a new slot at the end, without looking for a free slot and without locking or logging it. Only
+   * for a page no other transaction can reach yet (see TableBulkLoader).
+   * @param data the tuple, in the format of Tuple
+   * @param size the length of data
+   * @param[out] rid rid of the appended tuple
+   * @return true if there was enough space
+   */
+  auto AppendTuple(const char *data, uint32_t size, RID *rid) -> bool;
+
   /**
    * Mark a tuple as deleted. This does not actually delete the tuple.
    * @param rid rid of the tuple to mark as deleted
@@ -107,8 +138,11 @@ class TablePage : public Page {
   auto UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID &rid, Transaction *txn,
                    LockManager *lock_manager, LogManager *log_manager) -> bool;
 
-  /** To be called on commit or abort. Actually perform the delete or rollback an insert. */
-  void ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_manager);
+  /**
+   * To be called on commit or abort. Actually perform the delete or rollback an insert.
+   * @param[out] deleted_tuple if not null, the tuple that was deleted
+   */
+  void ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_manager, Tuple *deleted_tuple = nullptr);
 
   /** To be called on abort. Rollback a delete, i.e. this reverses a MarkDelete. */
   void RollbackDelete(const RID &rid, Transaction *txn, LogManager *log_manager);
@@ -123,6 +157,12 @@ class TablePage : public Page {
    */
   auto GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager) -> bool;
 
+  /**
+   * Append a view of every live tuple in this page to views.
+   * @param data the data of this page, or a copy of it that the views should point into
+   */
+  void GetTupleViews(const char *data, std::vector<TupleView> *views);
+
   /** @return the rid of the first tuple in this page */
 
   /**
@@ -139,17 +179,31 @@ class TablePage : public Page {
    */
   auto GetNextTupleRid(const RID &cur_rid, RID *next_rid) -> bool;
 
- private:
+  /**
+   * Drop the empty slots at the end of the slot array (vacuum). The tuple data needs no compacting, ApplyDelete
+   * already closes the gap a tuple leaves; an empty slot in the middle stays, the slot numbers after it are RIDs.
+   * @return the bytes freed
+   */
+  auto Compact() -> uint32_t;
+
+  /** @return true if no slot is in use; after Compact, true iff the page has no tuple at all */
+  auto IsEmpty() -> bool { return GetTupleCount() == 0; }
+
+  /** @return true if a tuple is marked deleted, i.e. its delete is not committed or aborted yet */
+  auto HasMarkedDeletes() -> bool;
+
+ protected:
   static_assert(sizeof(page_id_t) == 4);
 
-  static constexpr size_t SIZE_TABLE_PAGE_HEADER = 24;
+  static constexpr size_t SIZE_TABLE_PAGE_HEADER = 28;
   static constexpr size_t SIZE_TUPLE = 8;
   static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
   static constexpr size_t OFFSET_NEXT_PAGE_ID = 12;
   static constexpr size_t OFFSET_FREE_SPACE = 16;
   static constexpr size_t OFFSET_TUPLE_COUNT = 20;
-  static constexpr size_t OFFSET_TUPLE_OFFSET = 24;  // Naming things is hard.
-  static constexpr size_t OFFSET_TUPLE_SIZE = 28;
+  static constexpr size_t OFFSET_FSM_PAGE_ID = 24;
+  static constexpr size_t OFFSET_TUPLE_OFFSET = 28;  // Naming things is hard.
+  static constexpr size_t OFFSET_TUPLE_SIZE = 32;
 
   /** @return pointer to the end of the current free space, see header comment */
   auto GetFreeSpacePointer() -> uint32_t { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
@@ -168,10 +222,6 @@ class TablePage : public Page {
   /** Set the number of tuples in this page. */
   void SetTupleCount(uint32_t tuple_count) { memcpy(GetData() + OFFSET_TUPLE_COUNT, &tuple_count, sizeof(uint32_t)); }
 
-  auto GetFreeSpaceRemaining() -> uint32_t {
-    return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
-  }
-
   /** @return tuple offset at slot slot_num */
   auto GetTupleOffsetAtSlot(uint32_t slot_num) -> uint32_t {
     return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_OFFSET + SIZE_TUPLE * slot_num);
@@ -1,15 +1,13 @@
 #pragma once
 
+#include <vector>
+
 #include "storage/page/page.h"
 #include "storage/table/tmp_tuple.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
-// To pass the test cases for this class, you must follow the existing TmpTuplePage format and implement the
-// existing functions exactly as they are! It may be helpful to look at TablePage.
-// Remember that this task is optional, you get full credit if you finish the next task.
-
 /**
  * TmpTuplePage format:
  *
@@ -17,20 +15,60 @@ namespace bustub {
  * | PageId (4) | LSN (4) | FreeSpace (4) | (free space) | TupleSize2 | TupleData2 | TupleSize1 | TupleData1 |
  *
  * We choose this format because DeserializeExpression expects to read Size followed by Data.
+ *
+ * FreeSpace is the offset of the last tuple inserted, the end of the free space; tuples are inserted from the end of
+ * the page towards the header. The page holds the tuples of a spill run (see SpillRun); it is never logged.
+ *
+ * A tuple inserted together with its RID is | TupleSize | RID (8) | TupleData |, TupleSize counting the RID too, so
+ * the offsets of the tuples are found the same way; a page holds tuples of one kind.
  */
 class TmpTuplePage : public Page {
  public:
-  void Init(page_id_t page_id, uint32_t page_size) {
-    memcpy(GetData(), &page_id, sizeof(page_id_t));
-    memcpy(GetData() + sizeof(page_id_t), &page_size, sizeof(uint32_t));
-  }
+  void Init(page_id_t page_id, uint32_t page_size);
+
+  auto GetTablePageId() -> page_id_t;
+
+  /**
+   * Insert a tuple at the end of the free space.
+   * @param[out] out where the tuple is
+   * @return false if the tuple does not fit
+   */
+  auto Insert(const Tuple &tuple, TmpTuple *out) -> bool;
+
+  /** Insert a tuple and its RID (tuple.GetRid()); read back with GetTupleWithRid */
+  auto InsertWithRid(const Tuple &tuple, TmpTuple *out) -> bool;
 
-  auto GetTablePageId() -> page_id_t { return INVALID_PAGE_ID; }
+  /** @return the offsets of the tuples, in the order they were inserted */
+  auto GetTupleOffsets() -> std::vector<uint32_t>;
 
-  auto Insert(const Tuple &tuple, TmpTuple *out) -> bool { return false; }
+  /** @return the bytes of the tuple at offset, and its size in size */
+  auto GetTupleData(uint32_t offset, uint32_t *size) -> const char *;
+
+  /** @return the bytes of the tuple at offset inserted by InsertWithRid, its size in size and its RID in rid */
+  auto GetTupleWithRid(uint32_t offset, RID *rid, uint32_t *size) -> const char *;
+
+  /** @return the largest tuple a page of page_size bytes holds */
+  static constexpr auto MaxTupleSize(uint32_t page_size) -> uint32_t {
+    return page_size - SIZE_TMP_PAGE_HEADER - sizeof(uint32_t);
+  }
+
+  /** @return the largest tuple a page of page_size bytes holds together with its RID */
+  static constexpr auto MaxTupleWithRidSize(uint32_t page_size) -> uint32_t {
+    return MaxTupleSize(page_size) - sizeof(int64_t);
+  }
 
  private:
   static_assert(sizeof(page_id_t) == 4);
+
+  static constexpr size_t OFFSET_LSN = 4;
+  static constexpr size_t OFFSET_FREE_SPACE = 8;
+  static constexpr uint32_t SIZE_TMP_PAGE_HEADER = 12;
+
+  /** make room for size bytes after a size field at the end of the free space; the offset of the size field */
+  auto Allocate(uint32_t size, uint32_t *offset) -> bool;
+
+  auto GetFreeSpacePointer() -> uint32_t;
+  void SetFreeSpacePointer(uint32_t free_space_pointer);
 };
 
 }  // namespace bustub
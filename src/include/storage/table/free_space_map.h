@@ -0,0 +1,98 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.h
+//
+// Identification: src/include/storage/table/free_space_map.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "storage/page/free_space_map_page.h"
+
+namespace bustub {
+
+/** a free-space category is this many bytes; categories round down, so a page has at least category * size free */
+static constexpr uint32_t FSM_CATEGORY_SIZE = BUSTUB_PAGE_SIZE / 256;
+
+/**
+ * Free-space map of a table heap: the approximate free bytes of every heap page, one byte per page, kept on a chain
+ * of FreeSpaceMapPage and cached in memory. The cache carries a max-tree over the categories, so finding a page
+ * with room is O(log n) instead of a walk of the heap. Changes are written through to the map pages, which are not
+ * logged: after a crash a category may be off, and the heap corrects it when an insert does not fit.
+ */
+class FreeSpaceMap {
+ public:
+  /** Create an empty map on a new page. */
+  explicit FreeSpaceMap(BufferPoolManager *bpm);
+
+  /** Load the map whose first page is first_page_id. */
+  FreeSpaceMap(BufferPoolManager *bpm, page_id_t first_page_id);
+
+  auto GetFirstPageId() const -> page_id_t { return fsm_page_ids_.front(); }
+
+  /** Record a heap page appended at the end of the heap. */
+  void AddPage(page_id_t heap_page_id, uint32_t free_bytes);
+
+  /**
+   * Forget a page unlinked from the heap (see TableHeap::Vacuum). Its entry stays behind as a tombstone with
+   * category 0, the entries after it keep their place on the map pages; the last page of the heap is never removed.
+   */
+  void RemovePage(page_id_t heap_page_id);
+
+  /** Record the free bytes of a heap page of this map; ignored if the category does not change. */
+  void Update(page_id_t heap_page_id, uint32_t free_bytes);
+
+  /** @return the first heap page that has at least bytes free, INVALID_PAGE_ID if none does */
+  auto FindPage(uint32_t bytes) -> page_id_t;
+
+  /** @return true if heap_page_id is a page of this map */
+  auto Contains(page_id_t heap_page_id) -> bool;
+
+  /** @return true if heap_page_id is a page of this map and has at least bytes free */
+  auto HasRoom(page_id_t heap_page_id, uint32_t bytes) -> bool;
+
+  /** @return the last heap page, INVALID_PAGE_ID if the map is empty */
+  auto GetLastPageId() -> page_id_t;
+
+  /** @return the heap pages, in heap order */
+  auto GetPageIds() -> std::vector<page_id_t>;
+
+  /** @return the number of heap pages, without the removed ones */
+  auto GetNumPages() -> size_t;
+
+ private:
+  /** round down: the page has at least this category */
+  static auto ToCategory(uint32_t free_bytes) -> uint8_t;
+  /** round up: the category a page needs to surely hold bytes */
+  static auto NeededCategory(uint32_t bytes) -> uint32_t;
+
+  /** Set the category of slot i in the max-tree. */
+  void SetLeaf(size_t i, uint8_t category);
+  /** Set the category of slot i in the max-tree and on its map page. */
+  void SetCategory(size_t i, uint8_t category);
+  /** Grow the max-tree to hold at least n slots. */
+  void Reserve(size_t n);
+
+  BufferPoolManager *bpm_;
+  std::mutex latch_;
+  std::vector<page_id_t> fsm_page_ids_;
+  /** heap page of every slot, INVALID_PAGE_ID for a removed one */
+  std::vector<page_id_t> heap_page_ids_;
+  /** slot of every heap page that is not removed */
+  std::unordered_map<page_id_t, size_t> slots_;
+  /** max-tree: tree_[capacity_ + i] is the category of slot i, tree_[j] the max of its children */
+  std::vector<uint8_t> tree_;
+  size_t capacity_{0};
+};
+
+}  // namespace bustub
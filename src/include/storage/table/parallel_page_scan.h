@@ -0,0 +1,123 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_page_scan.h
+//
+// Identification: src/include/storage/table/parallel_page_scan.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <exception>
+#include <functional>
+#include <mutex>  // NOLINT
+#include <optional>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/macros.h"
+#include "concurrency/transaction.h"
+#include "storage/table/table_page_scan.h"
+#include "storage/table/tuple.h"
+#include "storage/table/zone_map.h"
+
+namespace bustub {
+
+class TableHeap;
+
+/** pages in a morsel of a parallel scan */
+static constexpr size_t SCAN_MORSEL_PAGES = 16;
+/** morsels a worker of a parallel scan may be ahead of the consumer, bounding the tuples held */
+static constexpr size_t SCAN_MORSELS_AHEAD_PER_WORKER = 2;
+
+/**
+ * Morsel-driven parallel scan of a TableHeap. The page directory of the heap (TableHeap::GetPageDirectory) is split
+ * into morsels of morsel_pages pages; worker threads take the next morsel from the dispatcher, scan it with a
+ * TablePageScan of their own, apply the filter and put the tuples that pass into the output of the morsel. Next
+ * returns the outputs morsel by morsel, in morsel order: the tuples come in the order of a serial scan.
+ *
+ * Workers run at most SCAN_MORSELS_AHEAD_PER_WORKER morsels per worker ahead of the morsel Next reads, so a
+ * consumer that stops early (LIMIT) does not make the scan read the whole table. The pages are those in the
+ * directory when the scan starts; the scan counts as a reader of the heap while it lives (see TableHeap::Vacuum).
+ *
+ * The workers share the transaction but take no tuple lock, so the caller runs a parallel scan only without logging
+ * (see TablePageScan). An exception thrown by the filter comes out of Next.
+ */
+class ParallelPageScan {
+ public:
+  /** @return true if the tuple is in the output of the scan; called by the workers at the same time */
+  using Filter = std::function<bool(const Tuple &tuple)>;
+
+  /**
+   * @param workers the number of worker threads
+   * @param filter the predicate of the caller, nullptr to keep every tuple
+   * @param columns the columns the caller reads, see TablePageScan
+   * @param ranges the ranges of the predicate, see TablePageScan
+   */
+  ParallelPageScan(TableHeap *table_heap, Transaction *txn, size_t workers, Filter filter = nullptr,
+                   std::optional<std::vector<uint32_t>> columns = std::nullopt, std::vector<ZoneRange> ranges = {},
+                   size_t morsel_pages = SCAN_MORSEL_PAGES);
+
+  ~ParallelPageScan();
+
+  DISALLOW_COPY_AND_MOVE(ParallelPageScan);
+
+  /**
+   * @param[out] tuple the next tuple of the scan
+   * @return false if there is none left
+   */
+  auto Next(Tuple *tuple) -> bool;
+
+  auto GetMorselCount() const -> size_t { return morsels_.size(); }
+
+  auto GetWorkerCount() const -> size_t { return workers_.size(); }
+
+ private:
+  /** a tuple in the output of a morsel */
+  struct Row {
+    RID rid_;
+    size_t offset_;
+    uint32_t size_;
+  };
+
+  struct Morsel {
+    std::vector<page_id_t> page_ids_;
+    /** the tuples that passed the filter, one after another */
+    std::vector<char> data_;
+    std::vector<Row> rows_;
+    std::exception_ptr error_;
+    bool done_{false};
+  };
+
+  void Work();
+
+  /** scan a morsel into its output; no latch held */
+  void ScanMorsel(Morsel *morsel);
+
+  TableHeap *table_heap_;
+  Transaction *txn_;
+  Filter filter_;
+  std::optional<std::vector<uint32_t>> columns_;
+  std::vector<ZoneRange> ranges_;
+  /** the dispatcher: morsels are handed out in order, next_morsel_ is the next one */
+  std::vector<Morsel> morsels_;
+  size_t window_;
+
+  std::mutex latch_;
+  std::condition_variable cv_;
+  size_t next_morsel_{0};
+  /** the morsel Next reads, and the next row of it */
+  size_t current_{0};
+  size_t pos_{0};
+  /** the current morsel is done; Next reads it without the latch */
+  bool current_done_{false};
+  bool stop_{false};
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,109 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// spill_run.h
+//
+// Identification: src/include/storage/table/spill_run.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <deque>
+#include <future>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/macros.h"
+#include "storage/page/tmp_tuple_page.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/** pages a SpillRunReader fetches ahead of the page it reads */
+static constexpr size_t SPILL_READ_AHEAD_PAGES = 2;
+
+/**
+ * An append-only run of tuples in TmpTuplePages allocated from the buffer pool: the spill file of an operator whose
+ * state does not fit in the memory budget of the query (see QueryMemory). Append fills one page at a time and keeps
+ * only that page pinned; a full page is unpinned dirty, and the buffer pool writes it out when it needs the frame.
+ * The tuples are read back in append order by a SpillRunReader.
+ *
+ * The pages are deleted when the run is destroyed. Operators own their runs, so a query leaves no page behind when it
+ * ends, whether it read its runs to the end or not. The readers of a run must be destroyed before the run.
+ */
+class SpillRun {
+ public:
+  explicit SpillRun(BufferPoolManager *bpm) : bpm_(bpm) {}
+
+  ~SpillRun();
+
+  DISALLOW_COPY_AND_MOVE(SpillRun);
+
+  /**
+   * Append a tuple and its RID to the run.
+   * @throw Exception if the tuple does not fit in a page, or the buffer pool has no frame for a new page
+   */
+  void Append(const Tuple &tuple);
+
+  /** unpin the page being appended to; no tuple is appended after. SpillRunReader calls it */
+  void Finish();
+
+  auto GetTupleCount() const -> size_t { return tuple_count_; }
+
+  auto GetPageCount() const -> size_t { return page_ids_.size(); }
+
+ private:
+  friend class SpillRunReader;
+
+  BufferPoolManager *bpm_;
+  std::vector<page_id_t> page_ids_;
+  /** the last page of the run, pinned while tuples are appended to it */
+  TmpTuplePage *page_{nullptr};
+  size_t tuple_count_{0};
+};
+
+/**
+ * Sequential reader of a SpillRun. While the tuples of a page are read, the next read_ahead pages are fetched in the
+ * background, so a page evicted to disk is read while the caller works on the page before it. The reader keeps at
+ * most read_ahead + 1 pages of the run pinned.
+ *
+ * The tuples are copies, with the RIDs they were appended with: they stay valid after the reader moves on. A tuple
+ * read from a table whose long values are stored out of line still reads them through the buffer pool of the run
+ * (see Toast).
+ */
+class SpillRunReader {
+ public:
+  explicit SpillRunReader(SpillRun *run, size_t read_ahead = SPILL_READ_AHEAD_PAGES);
+
+  ~SpillRunReader();
+
+  DISALLOW_COPY_AND_MOVE(SpillRunReader);
+
+  /**
+   * @param[out] tuple the next tuple of the run
+   * @return false if there is none left
+   * @throw Exception if the buffer pool has no frame for a page of the run
+   */
+  auto Next(Tuple *tuple) -> bool;
+
+ private:
+  /** start fetching pages until read_ahead_ are on the way */
+  void FetchAhead();
+
+  SpillRun *run_;
+  size_t read_ahead_;
+  /** the next page of the run to fetch */
+  size_t next_fetch_{0};
+  /** the pages being fetched, in run order; a fetch that found no frame gives nullptr */
+  std::deque<std::future<Page *>> ahead_;
+  /** the page being read, pinned, and the offsets of its tuples */
+  TmpTuplePage *page_{nullptr};
+  std::vector<uint32_t> offsets_;
+  size_t pos_{0};
+};
+
+}  // namespace bustub
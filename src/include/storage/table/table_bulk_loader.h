@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_bulk_loader.h
+//
+// Identification: src/include/storage/table/table_bulk_loader.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "common/rid.h"
+#include "concurrency/transaction.h"
+#include "storage/page/table_page.h"
+#include "storage/table/tuple.h"
+#include "storage/table/zone_map.h"
+
+namespace bustub {
+
+class TableHeap;
+
+/**
+ * Bulk load into a TableHeap (COPY FROM). Tuples are appended to fresh pages that are chained to each other but not
+ * to the heap, one page pinned at a time: no free-space search, no slot search, and no lock or log record per tuple
+ * (Init logs each new page). Finish links the whole chain after the last page of the heap and adds the pages to its
+ * free-space map (and zone map); until then no other transaction can see them, and a loader destroyed without Finish
+ * deletes them (and the overflow pages of its long values), so a failed load leaves the table as it was.
+ */
+class TableBulkLoader {
+ public:
+  TableBulkLoader(TableHeap *table_heap, Transaction *txn);
+
+  ~TableBulkLoader();
+
+  DISALLOW_COPY_AND_MOVE(TableBulkLoader);
+
+  /**
+   * Append a tuple, starting a new page when the current one is full.
+   * @param data the tuple, in the format of Tuple; at most TablePage::MaxTupleSize() bytes once its long values are
+   * stored out of line (see Toast::StoredSize)
+   * @param size the length of data
+   * @param[out] rid the rid the tuple will have in the heap
+   * @return false if the buffer pool has no frame for a new page or an overflow page
+   */
+  auto Append(const char *data, uint32_t size, RID *rid) -> bool;
+
+  /** Link the loaded pages into the heap. */
+  void Finish();
+
+  /** @return the pages loaded so far, in heap order */
+  auto GetPageIds() const -> const std::vector<page_id_t> & { return page_ids_; }
+
+ private:
+  /** unpin the page being filled and note its free space */
+  void ClosePage();
+
+  TableHeap *table_heap_;
+  Transaction *txn_;
+  std::vector<page_id_t> page_ids_;
+  /** free bytes of every closed page, for the free-space map */
+  std::vector<uint32_t> free_bytes_;
+  /** zones of the loaded pages, for the zone map of the heap if it has one */
+  std::vector<PageZone> zones_;
+  /** the chains of the values stored out of line, deleted with the pages if there is no Finish */
+  std::vector<page_id_t> chains_;
+  /** the tuple last appended, with pointers in place of its long values */
+  Tuple toasted_;
+  /** the page being filled, pinned; nullptr before the first tuple and after Finish */
+  TablePage *page_{nullptr};
+  bool finished_{false};
+};
+
+}  // namespace bustub
@@ -12,34 +12,88 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <set>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "recovery/log_manager.h"
+#include "storage/page/pax_page.h"
 #include "storage/page/table_page.h"
+#include "storage/table/free_space_map.h"
 #include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
+#include "storage/table/zone_map.h"
 
 namespace bustub {
 
+/** how the pages of a table heap store their tuples: TablePage (rows) or PaxPage (a minipage per column) */
+enum class TableLayout { ROW, PAX };
+
+/** what vacuum did, see TableHeap::Vacuum */
+struct VacuumStats {
+  uint64_t pages_visited_{0};
+  /** bytes freed by compacting pages: slots at the end of a row page, holes in the varchar heap of a PAX page */
+  uint64_t bytes_reclaimed_{0};
+  /** empty pages taken out of the heap */
+  uint64_t pages_unlinked_{0};
+  /** unlinked pages put on the free list of the heap, for it to append again */
+  uint64_t pages_recycled_{0};
+
+  auto operator+=(const VacuumStats &other) -> VacuumStats & {
+    pages_visited_ += other.pages_visited_;
+    bytes_reclaimed_ += other.bytes_reclaimed_;
+    pages_unlinked_ += other.pages_unlinked_;
+    pages_recycled_ += other.pages_recycled_;
+    return *this;
+  }
+};
+
 /**
  * TableHeap represents a physical table on disk.
  * This is just a doubly-linked list of pages.
  * 代表物理表在磁盘上
+ *
+ * A free-space map (see FreeSpaceMap) tracks the free bytes of every page, so an insert goes straight to a page
+ * with room instead of walking the list; each thread first retries the page it inserted into last.
+ *
+ * The pages of a heap are all TablePage or all PaxPage (CREATE TABLE ... WITH (layout = pax)); a PAX heap keeps the
+ * PaxLayout of its schema and hands it to every page call. Callers see the same tuples either way.
+ *
+ * A heap may also keep a zone map (see ZoneMap, EnableZoneMap): every insert and update widens the zone of its page,
+ * and a TablePageScan with ranges skips the pages whose zone rules them out.
+ *
+ * With toast on (EnableToast) a VARCHAR value longer than TOAST_THRESHOLD goes to a chain of overflow pages and the
+ * tuple on the page keeps a pointer to it; GetTuple and the views read it back when the column is read. The chains of
+ * a tuple are deleted when its delete is applied; those of the old value of an update are not, rollback needs them.
+ *
+ * Vacuum (see Vacuum, TableVacuum) compacts the pages that had a delete applied and takes the empty ones out of the
+ * list. An unlinked page keeps its links, so a scan standing on it goes on to the right page; it goes on the free list
+ * of the heap, where appending a page takes it from, only once no scan, iterator or insert that started before the
+ * unlink is left (active_readers_). The ids stay with the heap: the buffer pool does not hand a deleted id out again.
  */
 class TableHeap {
   friend class TableIterator;
+  friend class TableBulkLoader;
+  friend class TablePageScan;
+  friend class ParallelPageScan;
 
  public:
   ~TableHeap() = default;
 
   /**
-   * Create a table heap without a transaction. (open table)
+   * Create a table heap without a transaction. (open table) Loads the free-space map, or builds it once from the
+   * pages of a heap that has none.
    * @param buffer_pool_manager the buffer pool manager
    * @param lock_manager the lock manager
    * @param log_manager the log manager
    * @param first_page_id the id of the first page
+   * @param pax_schema the schema of a heap of PaxPage, nullptr for a heap of TablePage
    */
   TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-            page_id_t first_page_id);
+            page_id_t first_page_id, const Schema *pax_schema = nullptr);
 
   /**
    * Create a table heap with a transaction. (create table)
@@ -47,12 +101,14 @@ class TableHeap {
    * @param lock_manager the lock manager
    * @param log_manager the log manager
    * @param txn the creating transaction
+   * @param pax_schema the schema of a heap of PaxPage, nullptr for a heap of TablePage
    */
   TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-            Transaction *txn);
+            Transaction *txn, const Schema *pax_schema = nullptr);
 
   /**
-   * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
+   * Insert a tuple into the table. If the tuple is too large (>= page_size) once its long values are stored out of
+   * line, return false.
    * @param tuple tuple to insert
    * @param[out] rid the rid of the inserted tuple
    * @param txn the transaction performing the insert
@@ -91,6 +147,21 @@ class TableHeap {
    */
   void RollbackDelete(const RID &rid, Transaction *txn);
 
+  /**
+   * Called on commit of an update: deletes the out of line chains of the value it replaced.
+   * @param old_tuple the value before the update, as stored in the page (from the write set)
+   */
+  void ApplyUpdate(const Tuple &old_tuple);
+
+  /**
+   * Called on abort to rollback an update: puts the stored bytes of the old value back as they were, so it keeps
+   * its own chains, and deletes the chains of the value it replaces.
+   * @param old_tuple the value before the update, as stored in the page (from the write set)
+   * @param rid rid of the updated tuple
+   * @param txn transaction performing the rollback
+   */
+  void RollbackUpdate(const Tuple &old_tuple, const RID &rid, Transaction *txn);
+
   /**
    * Read a tuple from the table.
    * @param rid rid of the tuple to read
@@ -109,11 +180,116 @@ class TableHeap {
   /** @return the id of the first page of this table */
   inline auto GetFirstPageId() const -> page_id_t { return first_page_id_; }
 
+  auto GetFreeSpaceMap() -> FreeSpaceMap * { return fsm_.get(); }
+
+  /**
+   * The page directory of this heap: the free-space map has every page of the heap in heap order, so a parallel
+   * scan splits the heap into morsels without walking the chain.
+   * @return the pages of the heap, in heap order
+   */
+  auto GetPageDirectory() -> std::vector<page_id_t> { return fsm_->GetPageIds(); }
+
+  /**
+   * Keep a zone map of this heap from now on, built from the pages it already has. Call it before other threads
+   * write to the heap (Catalog::CreateTable does); the zone map lives in memory only, a heap opened again has none.
+   * @param schema the schema of the tuples of this heap
+   */
+  void EnableZoneMap(const Schema &schema);
+
+  /**
+   * Store the long VARCHAR values of the tuples inserted or updated from now on out of line (see Toast), and delete
+   * them with their tuple. Call it before the heap is used (Catalog::CreateTable does).
+   * @param schema the schema of the tuples of this heap
+   */
+  void EnableToast(const Schema &schema);
+
+  /** @return the zone map of this heap, nullptr if it has none */
+  auto GetZoneMap() -> ZoneMap * { return zone_map_.get(); }
+
+  /**
+   * Vacuum at most max_pages pages, of those that had a delete applied since they were last vacuumed: compact each
+   * one (see TablePage::Compact), rebuild its zone if no delete on it is pending, and unlink it from the heap if it
+   * has no tuple left. The first and the last page are never unlinked. The pages unlinked by earlier calls are
+   * recycled first, if no reader may still reach them. RIDs do not change.
+   * @param whole_heap vacuum every page, not only those with applied deletes (a heap opened again knows of none)
+   */
+  auto Vacuum(size_t max_pages, bool whole_heap = false) -> VacuumStats;
+
+  auto GetLayout() const -> TableLayout { return pax_layout_ == nullptr ? TableLayout::ROW : TableLayout::PAX; }
+
+  /** @return the layout of the pages of a PAX heap, nullptr for a row heap */
+  auto GetPaxLayout() const -> const PaxLayout * { return pax_layout_.get(); }
+
+  /** @return the largest tuple a page of this heap holds */
+  auto MaxTupleSize() const -> uint32_t {
+    return pax_layout_ == nullptr ? TablePage::MaxTupleSize() : pax_layout_->MaxTupleSize();
+  }
+
+  /**
+   * Append a view of every live tuple of a page of this heap to views; the page must be latched.
+   * @param data the data of the page, or a copy of it, that the views of a row page point into
+   * @param columns the columns the caller reads, nullptr for all; only a PAX page makes use of it
+   * @param[out] rows the rows of a PAX page are put together here and the views point into it
+   */
+  void GetTupleViews(TablePage *page, const char *data, const std::vector<uint32_t> *columns, std::vector<char> *rows,
+                     std::vector<TupleView> *views);
+
  private:
+  /**
+   * Append a page after the last one, a recycled one if there is any, and insert tuple into it; false if the buffer
+   * pool is out of frames.
+   */
+  auto AppendPageAndInsert(const Tuple &tuple, RID *rid, Transaction *txn) -> bool;
+
+  /** InsertTuple of a tuple whose long values are already out of line */
+  auto InsertStoredTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> bool;
+
+  /** the page calls that differ between the layouts */
+  void InitPage(TablePage *page, page_id_t page_id, page_id_t prev_page_id, Transaction *txn);
+  auto FreeSpaceOf(TablePage *page) -> uint32_t;
+  auto InsertInto(TablePage *page, const Tuple &tuple, RID *rid, Transaction *txn) -> bool;
+  auto AppendTo(TablePage *page, const char *data, uint32_t size, RID *rid) -> bool;
+  auto FirstTupleRid(TablePage *page, RID *first_rid) -> bool;
+  auto NextTupleRid(TablePage *page, const RID &cur_rid, RID *next_rid) -> bool;
+  auto CompactPage(TablePage *page) -> uint32_t;
+  auto HasMarkedDeletes(TablePage *page) -> bool;
+
+  /** Compact a page and rebuild its zone; @return true if it is empty and may be unlinked */
+  auto VacuumPage(page_id_t page_id, VacuumStats *stats) -> bool;
+
+  /** Take an empty page out of the list, the free-space map and the zone map; false if it is not empty any more. */
+  auto Unlink(page_id_t page_id) -> bool;
+
+  /** Move the unlinked pages to the free list, if no reader is left that may reach them. */
+  void RecycleUnlinkedPages(VacuumStats *stats);
+
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_{};
+  std::unique_ptr<FreeSpaceMap> fsm_;
+  /** set for a heap of PaxPage */
+  std::unique_ptr<PaxLayout> pax_layout_;
+  std::unique_ptr<ZoneMap> zone_map_;
+  /** set if long VARCHAR values are stored out of line */
+  std::unique_ptr<Schema> toast_schema_;
+  /** serializes appending pages to the heap, and unlinking them */
+  std::mutex append_latch_;
+  /** pages unlinked by vacuum that no reader can reach any more, to append again; under append_latch_ */
+  std::vector<page_id_t> free_page_ids_;
+
+  /**
+   * scans, iterators and inserts running; each may hold the id of a page that has been unlinked meanwhile. Shared with
+   * the iterators, which may outlive the heap.
+   */
+  std::shared_ptr<std::atomic<int64_t>> active_readers_{std::make_shared<std::atomic<int64_t>>(0)};
+  /** serializes Vacuum */
+  std::mutex vacuum_latch_;
+  /** pages unlinked and not recycled yet */
+  std::vector<page_id_t> unlinked_page_ids_;
+  std::mutex dirty_latch_;
+  /** pages that had a delete applied since they were last vacuumed; only heap pages, never an unlinked one */
+  std::set<page_id_t> dirty_page_ids_;
 };
 
 }  // namespace bustub
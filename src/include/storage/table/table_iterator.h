@@ -12,7 +12,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <cassert>
+#include <memory>
 
 #include "common/rid.h"
 #include "concurrency/transaction.h"
@@ -24,6 +26,7 @@ class TableHeap;
 
 /**
  * TableIterator enables the sequential scan of a TableHeap.
+ * An iterator counts as a reader of its heap while it lives, so vacuum does not free a page it stands on.
  */
 class TableIterator {
   friend class Cursor;
@@ -31,10 +34,9 @@ class TableIterator {
  public:
   TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
 
-  TableIterator(const TableIterator &other)
-      : table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)), txn_(other.txn_) {}
+  TableIterator(const TableIterator &other);
 
-  ~TableIterator() { delete tuple_; }
+  ~TableIterator();
 
   inline auto operator==(const TableIterator &itr) const -> bool {
     return tuple_->rid_.Get() == itr.tuple_->rid_.Get();
@@ -50,15 +52,12 @@ class TableIterator {
 
   auto operator++(int) -> TableIterator;
 
-  auto operator=(const TableIterator &other) -> TableIterator & {
-    table_heap_ = other.table_heap_;
-    *tuple_ = *other.tuple_;
-    txn_ = other.txn_;
-    return *this;
-  }
+  auto operator=(const TableIterator &other) -> TableIterator &;
 
  private:
   TableHeap *table_heap_;
+  /** the reader count of the heap; shared, since an iterator may outlive its heap */
+  std::shared_ptr<std::atomic<int64_t>> readers_;
   Tuple *tuple_;
   Transaction *txn_;
 };
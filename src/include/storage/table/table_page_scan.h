@@ -0,0 +1,93 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_page_scan.h
+//
+// Identification: src/include/storage/table/table_page_scan.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "concurrency/transaction.h"
+#include "storage/table/tuple_view.h"
+#include "storage/table/zone_map.h"
+
+namespace bustub {
+
+class TableHeap;
+
+/**
+ * Page-at-a-time scan of a TableHeap. NextPage pins and read-latches the next page once, copies it into a buffer
+ * owned by the scan and releases it; GetViews then has a TupleView of every live tuple of that page. Unlike
+ * TableIterator there is no FetchPage, latch or allocation per tuple.
+ *
+ * The views point into the copy, not the frame: they stay valid until the scan moves past the page, even if the page
+ * is changed meanwhile (a delete or update of the same transaction moves the tuples of the page around), and the
+ * scan holds no latch between calls.
+ *
+ * The tuples of a PAX page (see PaxPage) are put together into rows owned by the scan instead of copying the page;
+ * only the columns the caller reads are filled in.
+ *
+ * Given the ranges of its predicate (see ZoneRange), the scan does not fetch the pages whose zone map rules them out.
+ *
+ * A scan may also cover a given list of pages instead of the whole chain: a morsel of a parallel scan (see
+ * ParallelPageScan).
+ *
+ * A scan counts as a reader of the heap while it lives (see TableHeap::Vacuum).
+ */
+class TablePageScan {
+ public:
+  /**
+   * @param columns the columns the caller reads from the views, nullopt for all
+   * @param ranges the ranges a tuple must be in to satisfy the predicate of the caller; the views may still hold
+   * tuples out of them
+   */
+  TablePageScan(TableHeap *table_heap, Transaction *txn, std::optional<std::vector<uint32_t>> columns = std::nullopt,
+                std::vector<ZoneRange> ranges = {});
+
+  /**
+   * Scan the pages page_ids, in that order, instead of following the chain of the heap.
+   * @param page_ids pages of the heap, from its page directory (see TableHeap::GetPageDirectory)
+   */
+  TablePageScan(TableHeap *table_heap, Transaction *txn, std::vector<page_id_t> page_ids,
+                std::optional<std::vector<uint32_t>> columns = std::nullopt, std::vector<ZoneRange> ranges = {});
+
+  ~TablePageScan();
+
+  DISALLOW_COPY_AND_MOVE(TablePageScan);
+
+  /**
+   * Move to the next page that has a live tuple; the views of the previous page become invalid.
+   * @return false if there are no more pages
+   */
+  auto NextPage() -> bool;
+
+  /** @return the live tuples of the current page, in slot order */
+  auto GetViews() const -> const std::vector<TupleView> & { return views_; }
+
+ private:
+  TableHeap *table_heap_;
+  Transaction *txn_;
+  page_id_t next_page_id_;
+  /** the pages to scan if not the chain, and the next one of them */
+  std::optional<std::vector<page_id_t>> page_ids_;
+  size_t next_page_index_{0};
+  std::optional<std::vector<uint32_t>> columns_;
+  std::vector<ZoneRange> ranges_;
+  std::unique_ptr<char[]> page_copy_;
+  /** the rows of the current page of a PAX heap */
+  std::vector<char> rows_;
+  std::vector<TupleView> views_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,70 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_vacuum.h
+//
+// Identification: src/include/storage/table/table_vacuum.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <mutex>               // NOLINT
+#include <thread>              // NOLINT
+#include <vector>
+
+#include "common/macros.h"
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+/** pages a cycle of the background vacuum looks at, over all tables: the page I/O it may do per cycle */
+static constexpr size_t VACUUM_PAGES_PER_CYCLE = 64;
+/** time between two cycles of the background vacuum */
+static constexpr std::chrono::milliseconds VACUUM_INTERVAL{100};
+
+/**
+ * Background vacuum of the table heaps of a catalog. Every interval a thread vacuums at most pages_per_cycle pages
+ * (see TableHeap::Vacuum), starting at the next table each cycle, so a table with many deletes does not hold up the
+ * others. A table without applied deletes costs nothing.
+ */
+class TableVacuum {
+ public:
+  explicit TableVacuum(size_t pages_per_cycle = VACUUM_PAGES_PER_CYCLE,
+                       std::chrono::milliseconds interval = VACUUM_INTERVAL);
+
+  ~TableVacuum();
+
+  DISALLOW_COPY_AND_MOVE(TableVacuum);
+
+  /** Vacuum heap from now on; it must outlive this. */
+  void AddTable(TableHeap *heap);
+
+  /** Run a cycle now, in the calling thread; @return what it did */
+  auto RunOnce() -> VacuumStats;
+
+  /** @return what the cycles so far did */
+  auto GetStats() -> VacuumStats;
+
+ private:
+  void BackgroundWork();
+
+  size_t pages_per_cycle_;
+  std::chrono::milliseconds interval_;
+
+  std::mutex latch_;
+  std::condition_variable cv_;
+  std::vector<TableHeap *> heaps_;
+  /** the table the next cycle starts at */
+  size_t next_heap_{0};
+  VacuumStats stats_;
+  bool stop_{false};
+  std::thread background_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,98 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// toast.h
+//
+// Identification: src/include/storage/table/toast.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/schema.h"
+#include "storage/table/tuple.h"
+#include "type/limits.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/** a VARCHAR value longer than this many bytes is stored out of line */
+static constexpr uint32_t TOAST_THRESHOLD = 256;
+/** the leading bytes of a value stored out of line that the tuple keeps */
+static constexpr uint32_t TOAST_PREFIX_SIZE = 32;
+/** set in the length field of a varchar whose bytes in the tuple are a pointer to the value, not the value */
+static constexpr uint32_t TOAST_FLAG = 1U << 31;
+
+/**
+ * Out-of-line storage of long VARCHAR values (TOAST). A value longer than TOAST_THRESHOLD goes to a chain of
+ * TableOverflowPage; in the tuple, where the value would be, is
+ *
+ *  ------------------------------------------------------------------------------------
+ * | TOAST_FLAG | n (4) | Length of the value (4) | FirstPageId (4) | Prefix (n - 8) |
+ *  ------------------------------------------------------------------------------------
+ *
+ * so a tuple stays small however long its values are, and its other columns are read without touching the chain.
+ * The length field says how many bytes follow it either way; only Tuple::GetValue and TupleView::GetValue read the
+ * chain, when the column is read. The prefix is the first TOAST_PREFIX_SIZE bytes of the value: a comparison with a
+ * constant is often decided by it alone (see ComparisonExpression).
+ */
+class Toast {
+ public:
+  /** @return true if a varchar whose length field is length is stored out of line */
+  static auto IsToasted(uint32_t length) -> bool { return length != BUSTUB_VALUE_NULL && (length & TOAST_FLAG) != 0; }
+
+  /** @return the bytes that follow a length field of a varchar in a tuple */
+  static auto StoredBytes(uint32_t length) -> uint32_t {
+    return length == BUSTUB_VALUE_NULL ? 0 : length & ~TOAST_FLAG;
+  }
+
+  /** @return the size of a tuple, in the format of Tuple, once its long values are stored out of line */
+  static auto StoredSize(const Schema &schema, const char *data, uint32_t size) -> uint32_t;
+
+  /**
+   * Store the long values of a tuple out of line. A value already out of line (read from a table) gets a chain of
+   * its own: a chain belongs to one tuple.
+   * @param data the tuple, in the format of Tuple
+   * @param[out] out the tuple with pointers in place of the long values, which reads them back through bpm; left as
+   * it is if there is none
+   * @param[out] chains the first page of every chain written is appended here
+   * @return false if the buffer pool is out of frames; the chains written are deleted again
+   */
+  static auto StoreLongValues(BufferPoolManager *bpm, const Schema &schema, const char *data, uint32_t size,
+                              Tuple *out, std::vector<page_id_t> *chains) -> bool;
+
+  /**
+   * Read a value stored out of line.
+   * @param storage the length field of the value in the tuple
+   */
+  static auto Load(BufferPoolManager *bpm, const char *storage) -> Value;
+
+  /**
+   * @param storage the length field of a value stored out of line
+   * @param[out] length the length of the whole value, with its '\0' (see Value)
+   * @return the prefix of the value kept in the tuple
+   */
+  static auto Prefix(const char *storage, uint32_t *length) -> std::string_view;
+
+  /** Delete the chains of the values of a tuple stored out of line. */
+  static void DeleteChains(BufferPoolManager *bpm, const Schema &schema, const char *data);
+
+  /** Delete the pages of a chain. */
+  static void DeleteChain(BufferPoolManager *bpm, page_id_t page_id);
+
+ private:
+  /** Write bytes to a new chain; false if the buffer pool is out of frames, with nothing left behind. */
+  static auto WriteChain(BufferPoolManager *bpm, std::string_view bytes, page_id_t *first_page_id) -> bool;
+
+  /** @return the length field of column column_idx of a tuple, and where it is in data */
+  static auto LengthField(const Schema &schema, const char *data, uint32_t column_idx, uint32_t *offset) -> uint32_t;
+};
+
+}  // namespace bustub
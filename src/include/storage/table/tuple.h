@@ -13,6 +13,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "catalog/schema.h"
@@ -21,6 +22,8 @@
 
 namespace bustub {
 
+class BufferPoolManager;
+
 /**
  * Tuple format:
  * ---------------------------------------------------------------------
@@ -29,8 +32,11 @@ namespace bustub {
  */
 class Tuple {
   friend class TablePage;
+  friend class PaxPage;
   friend class TableHeap;
   friend class TableIterator;
+  friend class TupleView;
+  friend class Toast;
 
  public:
   // Default constructor (to create a dummy tuple)
@@ -84,6 +90,15 @@ class Tuple {
   }
   inline auto IsAllocated() -> bool { return allocated_; }
 
+  /**
+   * For a VARCHAR column whose value is stored out of line (see Toast), the prefix of the value kept in the tuple;
+   * enough to decide many comparisons without reading the value.
+   * @param[out] length the length of the whole value, with its '\0'
+   * @return false if the value is in the tuple (or NULL)
+   */
+  auto GetToastedPrefix(const Schema *schema, uint32_t column_idx, std::string_view *prefix, uint32_t *length) const
+      -> bool;
+
   auto ToString(const Schema *schema) const -> std::string;
 
  private:
@@ -94,6 +109,7 @@ class Tuple {
   RID rid_{};              // if pointing to the table heap, the rid is valid
   uint32_t size_{0};
   char *data_{nullptr};
+  BufferPoolManager *toast_bpm_{nullptr};  // 读存在行外的值用, 由 TableHeap 设置
 };
 
 }  // namespace bustub
@@ -0,0 +1,93 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_view.h
+//
+// Identification: src/include/storage/table/tuple_view.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+
+#include "catalog/schema.h"
+#include "common/rid.h"
+#include "storage/table/toast.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * A tuple that does not own its bytes: a pointer and a length into a page held by a scan (see TablePageScan), in the
+ * same format as Tuple. Reading a value needs no copy; ToTuple / CopyTo make an owning Tuple.
+ */
+class TupleView {
+  friend class TableHeap;
+
+ public:
+  TupleView() = default;
+
+  TupleView(RID rid, const char *data, uint32_t size) : rid_(rid), data_(data), size_(size) {}
+
+  /** a view of a tuple of a heap whose long values are stored out of line, read through toast_bpm (see Toast) */
+  TupleView(RID rid, const char *data, uint32_t size, BufferPoolManager *toast_bpm)
+      : rid_(rid), data_(data), size_(size), toast_bpm_(toast_bpm) {}
+
+  inline auto GetRid() const -> RID { return rid_; }
+
+  inline auto GetData() const -> const char * { return data_; }
+
+  inline auto GetLength() const -> uint32_t { return size_; }
+
+  /** Get the value of a specified column, see Tuple::GetValue */
+  auto GetValue(const Schema *schema, uint32_t column_idx) const -> Value {
+    const auto &col = schema->GetColumn(column_idx);
+    const char *data_ptr = data_ + col.GetOffset();
+    // varchar 在定长部分存的是数据的相对偏移
+    if (!col.IsInlined()) {
+      int32_t offset;
+      memcpy(&offset, data_ptr, sizeof(offset));
+      data_ptr = data_ + offset;
+      uint32_t length;
+      memcpy(&length, data_ptr, sizeof(length));
+      if (col.GetType() == TypeId::VARCHAR && Toast::IsToasted(length)) {
+        return Toast::Load(toast_bpm_, data_ptr);
+      }
+    }
+    return Value::DeserializeFrom(data_ptr, col.GetType());
+  }
+
+  /** Copy the bytes into tuple; its buffer is reused when it has the same length. */
+  void CopyTo(Tuple *tuple) const {
+    if (!tuple->allocated_ || tuple->size_ != size_) {
+      if (tuple->allocated_) {
+        delete[] tuple->data_;
+      }
+      tuple->data_ = new char[size_];
+      tuple->size_ = size_;
+      tuple->allocated_ = true;
+    }
+    memcpy(tuple->data_, data_, size_);
+    tuple->rid_ = rid_;
+    tuple->toast_bpm_ = toast_bpm_;
+  }
+
+  auto ToTuple() const -> Tuple {
+    Tuple tuple;
+    CopyTo(&tuple);
+    return tuple;
+  }
+
+ private:
+  RID rid_{};
+  const char *data_{nullptr};
+  uint32_t size_{0};
+  BufferPoolManager *toast_bpm_{nullptr};
+};
+
+}  // namespace bustub
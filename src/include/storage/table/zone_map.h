@@ -0,0 +1,116 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// zone_map.h
+//
+// Identification: src/include/storage/table/zone_map.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <mutex>  // NOLINT
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/** the zone of one column of a page */
+struct ColumnZone {
+  /** min and max of the non-NULL values; unset before the first one, and always for a VARCHAR column */
+  std::optional<Value> min_;
+  std::optional<Value> max_;
+  uint32_t null_count_{0};
+};
+
+/**
+ * Min, max and null count of every column over the tuples written to a page. A delete does not take its tuple out,
+ * so the zone only ever widens: it may cover values the page no longer has, never the other way round.
+ */
+struct PageZone {
+  uint32_t tuple_count_{0};
+  std::vector<ColumnZone> columns_;
+};
+
+/**
+ * A range of a column that a scan predicate requires, e.g. `a > 5 AND a <= 10` is (5, 10] on a. A page whose zone
+ * does not meet every range of a predicate has no tuple that satisfies it.
+ */
+struct ZoneRange {
+  uint32_t column_idx_{0};
+  std::optional<Value> lo_;
+  bool lo_inclusive_{true};
+  std::optional<Value> hi_;
+  bool hi_inclusive_{true};
+};
+
+/** what the seq scans of a table got from its zone map */
+struct ZoneMapStats {
+  size_t pages_{0};
+  /** pages a scan with ranges checked and then read */
+  uint64_t pages_scanned_{0};
+  /** pages a scan with ranges skipped without reading them */
+  uint64_t pages_skipped_{0};
+};
+
+/**
+ * Zone map of a table heap: a PageZone for every page, kept in memory next to the heap (see TableHeap) and widened
+ * under the page latch by every insert and update. The pages are kept in heap order, so a scan that skips a page
+ * finds the next one without fetching it.
+ *
+ * Min and max are kept for the inlined columns; a VARCHAR column only has a null count.
+ */
+class ZoneMap {
+ public:
+  explicit ZoneMap(const Schema &schema);
+
+  /** @return the zone of a page without tuples */
+  auto MakeZone() const -> PageZone;
+
+  /** Widen zone by a tuple, in the format of Tuple. */
+  void Widen(PageZone *zone, const char *data) const;
+
+  /** Record a page appended at the end of the heap, with the zone of the tuples it has. */
+  void AddPage(page_id_t page_id, PageZone zone);
+
+  /** Widen the zone of a page of this map by a tuple written to it; the page must be write-latched. */
+  void Widen(page_id_t page_id, const char *data);
+
+  /** Replace the zone of a page of this map by one rebuilt from its tuples (vacuum); the page must be write-latched. */
+  void SetZone(page_id_t page_id, PageZone zone);
+
+  /** Forget a page unlinked from the heap. */
+  void RemovePage(page_id_t page_id);
+
+  /**
+   * Check a page against the ranges of a scan predicate, and count it in the stats.
+   * @param[out] next_page_id the page after page_id, set if it can be skipped
+   * @return true if no tuple of the page can satisfy the predicate
+   */
+  auto CanSkip(page_id_t page_id, const std::vector<ZoneRange> &ranges, page_id_t *next_page_id) -> bool;
+
+  auto GetStats() -> ZoneMapStats;
+
+ private:
+  /** @return true if a column whose zone is zone can have a value in range */
+  static auto Meets(const ColumnZone &zone, uint32_t tuple_count, const ZoneRange &range) -> bool;
+
+  Schema schema_;
+  std::mutex latch_;
+  std::vector<page_id_t> page_ids_;
+  std::unordered_map<page_id_t, size_t> slots_;
+  std::vector<PageZone> zones_;
+  std::atomic<uint64_t> pages_scanned_{0};
+  std::atomic<uint64_t> pages_skipped_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,145 @@
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/index_lookup_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "optimizer/optimizer.h"
+#include "type/type_id.h"
+
+namespace bustub {
+
+namespace {
+
+/** 把 AND 连起来的谓词拆成若干个 conjunct */
+void SplitConjuncts(const AbstractExpressionRef &expr, std::vector<AbstractExpressionRef> *conjuncts) {
+  if (const auto *logic = dynamic_cast<const LogicExpression *>(expr.get());
+      logic != nullptr && logic->logic_type_ == LogicType::And) {
+    SplitConjuncts(logic->children_[0], conjuncts);
+    SplitConjuncts(logic->children_[1], conjuncts);
+    return;
+  }
+  conjuncts->push_back(expr);
+}
+
+/** 同一列上的若干个等值: `col = v`, 或者 IN 列表展开成的 `col = v1 OR col = v2 OR ...` */
+struct EqualityList {
+  uint32_t col_idx_;
+  std::vector<Value> values_;
+};
+
+auto MatchEqualityList(const AbstractExpression &expr) -> std::optional<EqualityList> {
+  if (const auto *logic = dynamic_cast<const LogicExpression *>(&expr);
+      logic != nullptr && logic->logic_type_ == LogicType::Or) {
+    auto left = MatchEqualityList(*logic->children_[0]);
+    auto right = MatchEqualityList(*logic->children_[1]);
+    if (!left.has_value() || !right.has_value() || left->col_idx_ != right->col_idx_) {
+      return std::nullopt;
+    }
+    left->values_.insert(left->values_.end(), right->values_.begin(), right->values_.end());
+    return left;
+  }
+  const auto *cmp = dynamic_cast<const ComparisonExpression *>(&expr);
+  if (cmp == nullptr || cmp->comp_type_ != ComparisonType::Equal) {
+    return std::nullopt;
+  }
+  const auto *col = dynamic_cast<const ColumnValueExpression *>(cmp->children_[0].get());
+  const auto *constant = dynamic_cast<const ConstantValueExpression *>(cmp->children_[1].get());
+  if (col == nullptr || constant == nullptr) {
+    col = dynamic_cast<const ColumnValueExpression *>(cmp->children_[1].get());
+    constant = dynamic_cast<const ConstantValueExpression *>(cmp->children_[0].get());
+  }
+  // NULL 常量永远不相等, 这种谓词留给 filter
+  if (col == nullptr || constant == nullptr || constant->val_.IsNull()) {
+    return std::nullopt;
+  }
+  return EqualityList{col->GetColIdx(), {constant->val_}};
+}
+
+/** 排序去重, 同一个 key 只探查一次, 也就不会重复输出同一行 */
+void SortUnique(std::vector<Value> *values) {
+  std::sort(values->begin(), values->end(),
+            [](const Value &a, const Value &b) { return a.CompareLessThan(b) == CmpBool::CmpTrue; });
+  values->erase(std::unique(values->begin(), values->end(),
+                            [](const Value &a, const Value &b) { return a.CompareEquals(b) == CmpBool::CmpTrue; }),
+                values->end());
+}
+
+}  // namespace
+
+auto Optimizer::OptimizeFilterAsIndexLookup(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeFilterAsIndexLookup(child));
+  }
+  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  if (optimized_plan->GetType() != PlanType::Filter) {
+    return optimized_plan;
+  }
+  const auto &filter_plan = dynamic_cast<const FilterPlanNode &>(*optimized_plan);
+  BUSTUB_ENSURE(filter_plan.children_.size() == 1, "Filter with multiple children?? Impossible!");
+  if (filter_plan.GetChildPlan()->GetType() != PlanType::SeqScan) {
+    return optimized_plan;
+  }
+  const auto &seq_scan = dynamic_cast<const SeqScanPlanNode &>(*filter_plan.GetChildPlan());
+  const auto *table_info = catalog_.GetTable(seq_scan.GetTableOid());
+
+  std::vector<AbstractExpressionRef> conjuncts;
+  SplitConjuncts(filter_plan.GetPredicate(), &conjuncts);
+
+  // 探查次数最少的那个 conjunct 胜出
+  std::optional<index_oid_t> best_index;
+  std::vector<Value> best_keys;
+  for (const auto &conjunct : conjuncts) {
+    auto equalities = MatchEqualityList(*conjunct);
+    if (!equalities.has_value()) {
+      continue;
+    }
+    TypeId type = table_info->schema_.GetColumn(equalities->col_idx_).GetType();
+    if ((type != TypeId::INTEGER && type != TypeId::VARCHAR) ||
+        std::any_of(equalities->values_.begin(), equalities->values_.end(),
+                    [type](const Value &value) { return value.GetTypeId() != type; })) {
+      continue;
+    }
+    SortUnique(&equalities->values_);
+    if (best_index.has_value() && best_keys.size() <= equalities->values_.size()) {
+      continue;
+    }
+    // 单个等值在有序索引上是 [v, v] 的范围扫描, 留给 OptimizeFilterAsIndexRangeScan (还能变成 index-only);
+    // hash 索引只能点查, IN 列表在任何索引上都是多次点查; 同一列上两种都有时优先 hash, 点查不用下降
+    std::optional<index_oid_t> candidate;
+    for (const auto *index_info : catalog_.GetTableIndexes(table_info->name_)) {
+      if (index_info->index_->GetKeyAttrs() != std::vector<uint32_t>{equalities->col_idx_}) {
+        continue;
+      }
+      if (!index_info->index_->IsOrdered()) {
+        candidate = index_info->index_oid_;
+        break;
+      }
+      if (equalities->values_.size() > 1 && !candidate.has_value()) {
+        candidate = index_info->index_oid_;
+      }
+    }
+    if (candidate.has_value()) {
+      best_index = candidate;
+      best_keys = equalities->values_;
+    }
+  }
+  if (!best_index.has_value()) {
+    return optimized_plan;
+  }
+
+  // 索引只负责找出候选行, 原来的 filter 保留, 其它条件照常过滤
+  auto lookup = std::make_shared<IndexLookupPlanNode>(seq_scan.output_schema_, *best_index, std::move(best_keys));
+  return std::make_shared<FilterPlanNode>(filter_plan.output_schema_, filter_plan.GetPredicate(), std::move(lookup));
+}
+
+}  // namespace bustub
@@ -0,0 +1,80 @@
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/projection_plan.h"
+#include "optimizer/optimizer.h"
+
+namespace bustub {
+
+namespace {
+
+/** 收集表达式里引用到的列 */
+void CollectColumns(const AbstractExpression &expr, std::unordered_set<uint32_t> *columns) {
+  if (const auto *col = dynamic_cast<const ColumnValueExpression *>(&expr); col != nullptr) {
+    columns->insert(col->GetColIdx());
+    return;
+  }
+  for (const auto &child : expr.GetChildren()) {
+    CollectColumns(*child, columns);
+  }
+}
+
+}  // namespace
+
+auto Optimizer::OptimizeIndexOnlyScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeIndexOnlyScan(child));
+  }
+  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  // Projection(IndexScan) 或 Projection(Filter(IndexScan))
+  if (optimized_plan->GetType() != PlanType::Projection) {
+    return optimized_plan;
+  }
+  const auto &projection = dynamic_cast<const ProjectionPlanNode &>(*optimized_plan);
+  std::unordered_set<uint32_t> columns;
+  for (const auto &expr : projection.GetExpressions()) {
+    CollectColumns(*expr, &columns);
+  }
+  const FilterPlanNode *filter = nullptr;
+  AbstractPlanNodeRef scan_plan = projection.GetChildPlan();
+  if (scan_plan->GetType() == PlanType::Filter) {
+    filter = dynamic_cast<const FilterPlanNode *>(scan_plan.get());
+    CollectColumns(*filter->GetPredicate(), &columns);
+    scan_plan = filter->GetChildPlan();
+  }
+  if (scan_plan->GetType() != PlanType::IndexScan) {
+    return optimized_plan;
+  }
+  const auto &index_scan = dynamic_cast<const IndexScanPlanNode &>(*scan_plan);
+  if (index_scan.IsIndexOnly()) {
+    return optimized_plan;
+  }
+
+  // 用到的列都在索引项里 (key 列或 include 列) 才能不回表
+  const auto *index_info = catalog_.GetIndex(index_scan.GetIndexOid());
+  const auto &entry_attrs = index_info->index_->GetEntryAttrs();
+  std::unordered_set<uint32_t> covered(entry_attrs.begin(), entry_attrs.end());
+  for (auto col : columns) {
+    if (covered.count(col) == 0) {
+      return optimized_plan;
+    }
+  }
+
+  AbstractPlanNodeRef new_scan = std::make_shared<IndexScanPlanNode>(
+      index_scan.output_schema_, index_scan.GetIndexOid(), index_scan.GetLowerBound(), index_scan.GetUpperBound(),
+      index_scan.IsReverse(), true);
+  if (filter != nullptr) {
+    new_scan = std::make_shared<FilterPlanNode>(filter->output_schema_, filter->GetPredicate(), std::move(new_scan));
+  }
+  return std::make_shared<ProjectionPlanNode>(projection.output_schema_, projection.GetExpressions(),
+                                              std::move(new_scan));
+}
+
+}  // namespace bustub
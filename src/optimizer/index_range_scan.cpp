@@ -0,0 +1,173 @@
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "optimizer/optimizer.h"
+#include "type/type_id.h"
+
+namespace bustub {
+
+namespace {
+
+/** 把 AND 连起来的谓词拆成若干个 conjunct */
+void SplitConjuncts(const AbstractExpressionRef &expr, std::vector<AbstractExpressionRef> *conjuncts) {
+  if (const auto *logic = dynamic_cast<const LogicExpression *>(expr.get());
+      logic != nullptr && logic->logic_type_ == LogicType::And) {
+    SplitConjuncts(logic->children_[0], conjuncts);
+    SplitConjuncts(logic->children_[1], conjuncts);
+    return;
+  }
+  conjuncts->push_back(expr);
+}
+
+/** `col op const` 或 `const op col`, 统一成 col 在左边 */
+struct ColumnBound {
+  uint32_t col_idx_;
+  ComparisonType comp_type_;
+  Value value_;
+};
+
+auto MatchColumnBound(const AbstractExpression &expr) -> std::optional<ColumnBound> {
+  const auto *cmp = dynamic_cast<const ComparisonExpression *>(&expr);
+  if (cmp == nullptr || cmp->comp_type_ == ComparisonType::NotEqual) {
+    return std::nullopt;
+  }
+  const auto *left_col = dynamic_cast<const ColumnValueExpression *>(cmp->children_[0].get());
+  const auto *right_col = dynamic_cast<const ColumnValueExpression *>(cmp->children_[1].get());
+  const auto *left_const = dynamic_cast<const ConstantValueExpression *>(cmp->children_[0].get());
+  const auto *right_const = dynamic_cast<const ConstantValueExpression *>(cmp->children_[1].get());
+  if (left_col != nullptr && right_const != nullptr) {
+    return ColumnBound{left_col->GetColIdx(), cmp->comp_type_, right_const->val_};
+  }
+  if (left_const != nullptr && right_col != nullptr) {
+    // 5 < x 等价于 x > 5
+    ComparisonType flipped = cmp->comp_type_;
+    switch (cmp->comp_type_) {
+      case ComparisonType::LessThan:
+        flipped = ComparisonType::GreaterThan;
+        break;
+      case ComparisonType::LessThanOrEqual:
+        flipped = ComparisonType::GreaterThanOrEqual;
+        break;
+      case ComparisonType::GreaterThan:
+        flipped = ComparisonType::LessThan;
+        break;
+      case ComparisonType::GreaterThanOrEqual:
+        flipped = ComparisonType::LessThanOrEqual;
+        break;
+      default:
+        break;
+    }
+    return ColumnBound{right_col->GetColIdx(), flipped, left_const->val_};
+  }
+  return std::nullopt;
+}
+
+/** 收紧下界: 取更大的那个, 相等时开区间更紧 */
+void TightenLower(std::optional<IndexScanBound> *lower, const Value &value, bool inclusive) {
+  if (!lower->has_value() || value.CompareGreaterThan((*lower)->key_) == CmpBool::CmpTrue ||
+      (value.CompareEquals((*lower)->key_) == CmpBool::CmpTrue && !inclusive)) {
+    *lower = IndexScanBound{value, inclusive};
+  }
+}
+
+/** 收紧上界: 取更小的那个, 相等时开区间更紧 */
+void TightenUpper(std::optional<IndexScanBound> *upper, const Value &value, bool inclusive) {
+  if (!upper->has_value() || value.CompareLessThan((*upper)->key_) == CmpBool::CmpTrue ||
+      (value.CompareEquals((*upper)->key_) == CmpBool::CmpTrue && !inclusive)) {
+    *upper = IndexScanBound{value, inclusive};
+  }
+}
+
+}  // namespace
+
+auto Optimizer::OptimizeFilterAsIndexRangeScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeFilterAsIndexRangeScan(child));
+  }
+  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  if (optimized_plan->GetType() != PlanType::Filter) {
+    return optimized_plan;
+  }
+  const auto &filter_plan = dynamic_cast<const FilterPlanNode &>(*optimized_plan);
+  BUSTUB_ENSURE(filter_plan.children_.size() == 1, "Filter with multiple children?? Impossible!");
+  if (filter_plan.GetChildPlan()->GetType() != PlanType::SeqScan) {
+    return optimized_plan;
+  }
+  const auto &seq_scan = dynamic_cast<const SeqScanPlanNode &>(*filter_plan.GetChildPlan());
+  const auto *table_info = catalog_.GetTable(seq_scan.GetTableOid());
+
+  std::vector<AbstractExpressionRef> conjuncts;
+  SplitConjuncts(filter_plan.GetPredicate(), &conjuncts);
+
+  // 找第一个有索引的列, 把这一列上的所有比较合成一个区间
+  for (const auto &conjunct : conjuncts) {
+    auto bound = MatchColumnBound(*conjunct);
+    if (!bound.has_value()) {
+      continue;
+    }
+    // IndexScanExecutor 支持单个 integer 列的索引, 以及单个 varchar 列的 slotted b+ 树索引, art 索引和 lsm 索引
+    TypeId type = table_info->schema_.GetColumn(bound->col_idx_).GetType();
+    if ((type != TypeId::INTEGER && type != TypeId::VARCHAR) || bound->value_.GetTypeId() != type) {
+      continue;
+    }
+    auto index = MatchIndex(table_info->name_, bound->col_idx_);
+    if (!index.has_value()) {
+      continue;
+    }
+    if (type == TypeId::VARCHAR) {
+      const auto *matched = catalog_.GetIndex(std::get<0>(*index))->index_.get();
+      if (dynamic_cast<const SlottedBPlusTreeIndex *>(matched) == nullptr &&
+          dynamic_cast<const ArtIndex *>(matched) == nullptr && dynamic_cast<const LsmIndex *>(matched) == nullptr) {
+        continue;
+      }
+    }
+
+    std::optional<IndexScanBound> lower;
+    std::optional<IndexScanBound> upper;
+    for (const auto &other : conjuncts) {
+      auto b = MatchColumnBound(*other);
+      if (!b.has_value() || b->col_idx_ != bound->col_idx_ || b->value_.GetTypeId() != type) {
+        continue;
+      }
+      switch (b->comp_type_) {
+        case ComparisonType::Equal:
+          TightenLower(&lower, b->value_, true);
+          TightenUpper(&upper, b->value_, true);
+          break;
+        case ComparisonType::GreaterThan:
+          TightenLower(&lower, b->value_, false);
+          break;
+        case ComparisonType::GreaterThanOrEqual:
+          TightenLower(&lower, b->value_, true);
+          break;
+        case ComparisonType::LessThan:
+          TightenUpper(&upper, b->value_, false);
+          break;
+        case ComparisonType::LessThanOrEqual:
+          TightenUpper(&upper, b->value_, true);
+          break;
+        default:
+          break;
+      }
+    }
+    // 索引只负责缩小扫描范围, 原来的 filter 保留, 其它条件照常过滤
+    auto [index_oid, index_name] = *index;
+    auto index_scan = std::make_shared<IndexScanPlanNode>(seq_scan.output_schema_, index_oid, lower, upper);
+    return std::make_shared<FilterPlanNode>(filter_plan.output_schema_, filter_plan.GetPredicate(),
+                                            std::move(index_scan));
+  }
+  return optimized_plan;
+}
+
+}  // namespace bustub
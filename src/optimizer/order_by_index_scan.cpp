@@ -1,5 +1,7 @@
 #include <algorithm>
 #include <memory>
+#include <optional>
+#include <vector>
 
 #include "binder/bound_order_by.h"
 #include "catalog/catalog.h"
@@ -37,11 +39,12 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
       return optimized_plan;
     }
 
-    // Order type is asc or default
+    // Order type is asc, default or desc; desc scans the index backwards
     const auto &[order_type, expr] = order_bys[0];
-    if (!(order_type == OrderByType::ASC || order_type == OrderByType::DEFAULT)) {
+    if (!(order_type == OrderByType::ASC || order_type == OrderByType::DEFAULT || order_type == OrderByType::DESC)) {
       return optimized_plan;
     }
+    bool reverse = order_type == OrderByType::DESC;
 
     // Order expression is a column value expression
     const auto *column_value_expr = dynamic_cast<ColumnValueExpression *>(expr.get());
@@ -62,13 +65,34 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
 
       for (const auto *index : indices) {
         const auto &columns = index->key_schema_.GetColumns();
-        if (columns.size() == 1 &&
+        if (index->index_->IsOrdered() && columns.size() == 1 &&
             columns[0].GetName() == table_info->schema_.GetColumn(order_by_column_id).GetName()) {
           // Index matched, return index scan instead
-          return std::make_shared<IndexScanPlanNode>(optimized_plan->output_schema_, index->index_oid_);
+          return std::make_shared<IndexScanPlanNode>(optimized_plan->output_schema_, index->index_oid_, std::nullopt,
+                                                     std::nullopt, reverse);
         }
       }
     }
+
+    // Range scan (possibly under its filter) produced by OptimizeFilterAsIndexRangeScan: already ordered by the index
+    // key, only the direction needs to be set
+    const AbstractPlanNodeRef *scan_plan = &child_plan;
+    if (child_plan->GetType() == PlanType::Filter) {
+      scan_plan = &child_plan->children_[0];
+    }
+    if ((*scan_plan)->GetType() == PlanType::IndexScan) {
+      const auto &index_scan = dynamic_cast<const IndexScanPlanNode &>(**scan_plan);
+      const auto *index_info = catalog_.GetIndex(index_scan.GetIndexOid());
+      if (index_info->index_->GetKeyAttrs() == std::vector<uint32_t>{order_by_column_id}) {
+        AbstractPlanNodeRef scan = std::make_shared<IndexScanPlanNode>(
+            index_scan.output_schema_, index_scan.GetIndexOid(), index_scan.GetLowerBound(),
+            index_scan.GetUpperBound(), reverse);
+        if (child_plan->GetType() == PlanType::Filter) {
+          return child_plan->CloneWithChildren({scan});
+        }
+        return scan;
+      }
+    }
   }
 
   return optimized_plan;
@@ -0,0 +1,84 @@
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/plans/aggregation_plan.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/projection_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "optimizer/optimizer.h"
+
+namespace bustub {
+
+namespace {
+
+/** 收集表达式里引用到的列 */
+void CollectColumns(const AbstractExpression &expr, std::set<uint32_t> *columns) {
+  if (const auto *col = dynamic_cast<const ColumnValueExpression *>(&expr); col != nullptr) {
+    columns->insert(col->GetColIdx());
+    return;
+  }
+  for (const auto &child : expr.GetChildren()) {
+    CollectColumns(*child, columns);
+  }
+}
+
+}  // namespace
+
+auto Optimizer::OptimizeSeqScanColumns(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeSeqScanColumns(child));
+  }
+  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  // Projection / Aggregation 的输出只取决于它们的表达式, 下面的 Filter (或并进 SeqScan 的谓词) 再加上谓词用到的列
+  std::set<uint32_t> columns;
+  if (optimized_plan->GetType() == PlanType::Projection) {
+    for (const auto &expr : dynamic_cast<const ProjectionPlanNode &>(*optimized_plan).GetExpressions()) {
+      CollectColumns(*expr, &columns);
+    }
+  } else if (optimized_plan->GetType() == PlanType::Aggregation) {
+    const auto &aggregation = dynamic_cast<const AggregationPlanNode &>(*optimized_plan);
+    for (const auto &expr : aggregation.GetGroupBys()) {
+      CollectColumns(*expr, &columns);
+    }
+    for (const auto &expr : aggregation.GetAggregates()) {
+      CollectColumns(*expr, &columns);
+    }
+  } else {
+    return optimized_plan;
+  }
+  const FilterPlanNode *filter = nullptr;
+  AbstractPlanNodeRef scan_plan = optimized_plan->GetChildAt(0);
+  if (scan_plan->GetType() == PlanType::Filter) {
+    filter = dynamic_cast<const FilterPlanNode *>(scan_plan.get());
+    CollectColumns(*filter->GetPredicate(), &columns);
+    scan_plan = filter->GetChildPlan();
+  }
+  if (scan_plan->GetType() != PlanType::SeqScan) {
+    return optimized_plan;
+  }
+  const auto &seq_scan = dynamic_cast<const SeqScanPlanNode &>(*scan_plan);
+  if (seq_scan.filter_predicate_ != nullptr) {
+    CollectColumns(*seq_scan.filter_predicate_, &columns);
+  }
+  // 行存的页整页拷贝, 少拷几列没有好处
+  const auto *table_info = catalog_.GetTable(seq_scan.GetTableOid());
+  if (seq_scan.columns_.has_value() || table_info->table_ == nullptr ||
+      table_info->table_->GetLayout() != TableLayout::PAX) {
+    return optimized_plan;
+  }
+
+  AbstractPlanNodeRef new_plan = std::make_shared<SeqScanPlanNode>(
+      seq_scan.output_schema_, seq_scan.GetTableOid(), seq_scan.table_name_,
+      std::vector<uint32_t>(columns.begin(), columns.end()), seq_scan.filter_predicate_);
+  if (filter != nullptr) {
+    new_plan = filter->CloneWithChildren({std::move(new_plan)});
+  }
+  return optimized_plan->CloneWithChildren({std::move(new_plan)});
+}
+
+}  // namespace bustub
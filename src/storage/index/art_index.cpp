@@ -0,0 +1,88 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// art_index.cpp
+//
+// Identification: src/storage/index/art_index.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/art_index.h"
+
+#include "common/macros.h"
+#include "storage/index/key_encoder.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+ArtIndex::ArtIndex(std::unique_ptr<IndexMetadata> &&metadata) : Index(std::move(metadata)) {}
+
+auto ArtIndex::EncodeKey(const Tuple &key) const -> std::string { return KeyEncoder::Encode(key, GetKeySchema()); }
+
+auto ArtIndex::TreeKey(const Tuple &key, RID rid) const -> std::string {
+  std::string tree_key = EncodeKey(key);
+  auto bits = static_cast<uint64_t>(rid.Get());
+  for (int shift = 56; shift >= 0; shift -= 8) {
+    tree_key.push_back(static_cast<char>((bits >> shift) & 0xFF));
+  }
+  return tree_key;
+}
+
+void ArtIndex::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  tree_.Insert(TreeKey(key, rid), rid);
+}
+
+void ArtIndex::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) { tree_.Remove(TreeKey(key, rid)); }
+
+void ArtIndex::ScanEncoded(std::string_view low, std::optional<std::string_view> high, std::vector<RID> *result) {
+  std::vector<std::pair<std::string, RID>> entries;
+  tree_.ScanRange(low, high, &entries);
+  result->reserve(result->size() + entries.size());
+  for (const auto &[tree_key, rid] : entries) {
+    result->push_back(rid);
+  }
+}
+
+void ArtIndex::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
+  // key 的编码是定长的或者带结束符, 所以以它开头的树 key 恰好就是这个 key 的所有项
+  std::string encoded = EncodeKey(key);
+  auto next = AdaptiveRadixTree<RID>::Successor(encoded);
+  ScanEncoded(encoded, next.has_value() ? std::make_optional<std::string_view>(*next) : std::nullopt, result);
+}
+
+void ArtIndex::ScanPrefix(const std::string &prefix, std::vector<RID> *result) {
+  BUSTUB_ASSERT(GetKeySchema()->GetColumnCount() == 1 && GetKeySchema()->GetColumn(0).GetType() == TypeId::VARCHAR,
+                "prefix scan needs a single varchar key");
+  // 去掉结束符 0x00 0x00, 剩下的就是所有以 prefix 开头的字符串编码的公共前缀
+  std::string encoded;
+  KeyEncoder::AppendValue(ValueFactory::GetVarcharValue(prefix), &encoded);
+  encoded.resize(encoded.size() - 2);
+  auto next = AdaptiveRadixTree<RID>::Successor(encoded);
+  ScanEncoded(encoded, next.has_value() ? std::make_optional<std::string_view>(*next) : std::nullopt, result);
+}
+
+void ArtIndex::ScanRange(const std::optional<Tuple> &low, bool low_inclusive, const std::optional<Tuple> &high,
+                         bool high_inclusive, std::vector<std::pair<std::string, RID>> *result) {
+  // 树 key = 编码 + rid, 所以 "> k" 从 Successor(k) 开始, "<= k" 到 Successor(k) 为止
+  std::string from;
+  if (low.has_value()) {
+    from = EncodeKey(*low);
+    if (!low_inclusive) {
+      auto next = AdaptiveRadixTree<RID>::Successor(from);
+      if (!next.has_value()) {
+        return;
+      }
+      from = std::move(*next);
+    }
+  }
+  std::optional<std::string> to;
+  if (high.has_value()) {
+    to = high_inclusive ? AdaptiveRadixTree<RID>::Successor(EncodeKey(*high)) : EncodeKey(*high);
+  }
+  tree_.ScanRange(from, to.has_value() ? std::make_optional<std::string_view>(*to) : std::nullopt, result);
+}
+
+}  // namespace bustub
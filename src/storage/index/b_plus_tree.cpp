@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <string>
 
 #include "common/exception.h"
@@ -28,6 +29,12 @@ BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manag
       leaf_max_size_(leaf_max_size),
       internal_max_size_(internal_max_size) {}
 
+INDEX_TEMPLATE_ARGUMENTS
+BPLUSTREE_TYPE::~BPlusTree() {
+  this->UnswizzleAll();
+  this->FreeRetiredTrees();
+}
+
 /*
  * Helper function to decide whether current b+tree is empty
   b+ 树是空的吗?
@@ -63,10 +70,15 @@ auto BPLUSTREE_TYPE::IsEmpty() const -> bool {
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) -> bool {
   bool ret;
-  LeafPage *lpage = reinterpret_cast<LeafPage *>(this->FindLeafPageByKey(key)->GetData());
+  Page *page = this->FindLeafPageByKey(key);
+  if (page == nullptr) {
+    return false;
+  }
+  LeafPage *lpage = reinterpret_cast<LeafPage *>(page->GetData());
   ValueType value;
   ret = lpage->GetValByKey(key, value, this->comparator_);
   result->push_back(value);
+  this->buffer_pool_manager_->UnpinPage(lpage->GetPageId(), false);
   return ret;
 }
 
@@ -79,6 +91,7 @@ void BPLUSTREE_TYPE::SplitInternalNode(InternalPage *mePage) {
       this->buffer_pool_manager_->UnpinPage(mePage->GetPageId(), true);
       return;
     }
+    this->UnswizzleAll();                                                             // 要改内部节点了
 
     page_id_t newPageId;
     Page *newPage;
@@ -106,6 +119,7 @@ void BPLUSTREE_TYPE::SplitInternalNode(InternalPage *mePage) {
     if (mePage->IsRootPage(this->GetRootPageId())) {
       printf("SplitInternalNode is root\n");
       parentPage = reinterpret_cast<InternalPage *>(this->buffer_pool_manager_->NewPage(&parentId)->GetData());                    // 4 创建父节点
+      parentPage->Init(parentId, INVALID_PAGE_ID, this->internal_max_size_);
 
       mePage->SetParentPageId(parentId);                       // 左右子节点向上指针
       rightPage->SetParentPageId(parentId);
@@ -121,7 +135,7 @@ void BPLUSTREE_TYPE::SplitInternalNode(InternalPage *mePage) {
       printf("SplitInternalNode \n");
       parentPage = reinterpret_cast<InternalPage *>(this->buffer_pool_manager_->FetchPage(mePage->GetParentPageId())->GetData());    // 4 获取父节点页
 
-      rightPage->SetParentPageId(parentId);         // 右子节点向上指针
+      rightPage->SetParentPageId(mePage->GetParentPageId());         // 右子节点向上指针
 
       parentPage->Insert(rightMin, rightPage->GetPageId(), this->comparator_); // 5  内部页, 新建右节点的首个KV移动到父节点
       
@@ -145,6 +159,7 @@ void BPLUSTREE_TYPE::SplitLeafNode(LeafPage *mePage) {
       this->buffer_pool_manager_->UnpinPage(mePage->GetPageId(), true);
       return;
     }
+    this->UnswizzleAll();                                                             // 要改内部节点了
 
     page_id_t newPageId;
     Page *newPage;
@@ -163,6 +178,8 @@ void BPLUSTREE_TYPE::SplitLeafNode(LeafPage *mePage) {
 
     rightPage->SetNextPageId(mePage->GetNextPageId());                                // 3  设置 right 节点的 next 节点id 为原left 的next id
     mePage->SetNextPageId(rightPage->GetPageId());                                    // 设置 left  节点的 next 节点id 为 right 节点的 id
+    rightPage->SetPrevPageId(mePage->GetPageId());                                    // prev 链接: me <- right <- 原next
+    this->SetLeafPrevPageId(rightPage->GetNextPageId(), rightPage->GetPageId());
 
     // 如果没有父节点, 即本身是root 节点
 
@@ -183,7 +200,7 @@ void BPLUSTREE_TYPE::SplitLeafNode(LeafPage *mePage) {
     } else {
       printf("SplitLeafNode  \n");
       parentPage = reinterpret_cast<InternalPage *>(this->buffer_pool_manager_->FetchPage(mePage->GetParentPageId())->GetData());    // 9 获取父节点页
-      rightPage->SetParentPageId(parentId);                                         // 10 右子节点向上指针
+      rightPage->SetParentPageId(mePage->GetParentPageId());                        // 10 右子节点向上指针
 
       parentPage->Insert(rightMin, rightPage->GetPageId(), this->comparator_);      // 11  内部页, 新建右节点的首个KV移动到父节点
       
@@ -217,6 +234,7 @@ void BPLUSTREE_TYPE::SplitLeafNode(LeafPage *mePage) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) -> bool {
+  this->FreeRetiredTrees();
   BPlusTreePage *mePage = nullptr;
   LeafPage *leafPage;
   if (this->IsEmpty()) {                              // 如果树是空的
@@ -248,6 +266,46 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
 }
 
 
+/*
+ * 批量插入. 先按 key 排序, 再一段一段地插: 从根下降一次找到叶子和它的上界 fence,
+ * 后面所有 < fence 的 key 都落在这个叶子上, 直接插进去, 不再重复下降.
+ * 叶子满了就分裂一次, 剩下的 key 重新下降 (分裂可能改变了 fence).
+ * 这样 n 个 key 的下降次数从 n 次降到约等于涉及的叶子数 + 分裂次数.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::InsertBatch(std::vector<MappingType> *batch, Transaction *transaction) {
+  std::sort(batch->begin(), batch->end(), [this](const MappingType &a, const MappingType &b) {
+    return this->comparator_(a.first, b.first) < 0;
+  });
+
+  size_t i = 0;
+  if (i < batch->size() && this->IsEmpty()) {                 // 空树, 第一个 key 走普通插入, 建立 root
+    this->Insert((*batch)[i].first, (*batch)[i].second, transaction);
+    i++;
+  }
+  while (i < batch->size()) {
+    std::optional<KeyType> fence;
+    auto *leafPage = reinterpret_cast<LeafPage *>(this->FindLeafPageWithFence((*batch)[i].first, &fence)->GetData());
+    bool split = false;
+    for (; i < batch->size(); i++) {
+      const auto &[key, value] = (*batch)[i];
+      if (fence.has_value() && this->comparator_(key, *fence) >= 0) {   // 这一段结束, 下一个 key 在右边的叶子
+        break;
+      }
+      leafPage->Insert(key, value, this->comparator_);
+      if (leafPage->GetSize() == leafPage->GetMaxSize()) {
+        this->SplitLeafNode(leafPage);                          // 分裂并 unpin, 剩下的 key 重新下降
+        split = true;
+        i++;
+        break;
+      }
+    }
+    if (!split) {
+      this->buffer_pool_manager_->UnpinPage(leafPage->GetPageId(), true);
+    }
+  }
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::StealInternalBrother(InternalPage *mePage) -> bool {
   InternalPage *leftPage;
@@ -324,8 +382,8 @@ auto BPLUSTREE_TYPE::StealInternalBrother(InternalPage *mePage) -> bool {
 
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::StealLeafBrother(LeafPage *mePage) -> bool {
-  LeafPage *leftPage;
-  LeafPage *rightPage;
+  LeafPage *leftPage = nullptr;
+  LeafPage *rightPage = nullptr;
   InternalPage *parentPage;
   int index;
   if (mePage->IsRootPage(this->GetRootPageId())) {
@@ -361,10 +419,13 @@ auto BPLUSTREE_TYPE::StealLeafBrother(LeafPage *mePage) -> bool {
     this->buffer_pool_manager_->UnpinPage(leftPage->GetPageId(), true);
     return true;
   }
+  if (leftPage != nullptr) {
+    this->buffer_pool_manager_->UnpinPage(leftPage->GetPageId(), false);
+  }
 
 
   // 偷取右侧
-  if ( index != parentPage->GetSize()) {
+  if (index + 1 < parentPage->GetSize()) {
       rightPage = reinterpret_cast<LeafPage *>(this->buffer_pool_manager_->FetchPage(parentPage->ItemAt(index+1).second)->GetData());   // 1 获取右侧节点
   }
 
@@ -374,7 +435,7 @@ auto BPLUSTREE_TYPE::StealLeafBrother(LeafPage *mePage) -> bool {
     rightPage->Remove(elem.first, this->comparator_);
     mePage->Insert(elem.first, elem.second, this->comparator_);                                                      // 4 本节点加入借来的元素
 
-    parentPage->SetKeyByIndex(elem.first, index+1);                    // 替代下面两行
+    parentPage->SetKeyByIndex(rightPage->ItemAt(0).first, index+1);   // 右边叶子的分隔 key 变成它新的头部
     //parentPage->Insert(elem.first, mePage->GetPageId(), this->comparator_);                                  // 5 父节点加入右侧的新头部索引
     //parentPage->Remove(elem.first, this->comparator_);                                                         // 3 父节点删除右侧头部索引
 
@@ -383,6 +444,10 @@ auto BPLUSTREE_TYPE::StealLeafBrother(LeafPage *mePage) -> bool {
     this->buffer_pool_manager_->UnpinPage(rightPage->GetPageId(), true);
     return true;
   }
+  if (rightPage != nullptr) {
+    this->buffer_pool_manager_->UnpinPage(rightPage->GetPageId(), false);
+  }
+  this->buffer_pool_manager_->UnpinPage(parentPage->GetPageId(), false);
   return false;
 }
 
@@ -430,6 +495,8 @@ void BPLUSTREE_TYPE::MergeLeafNode(LeafPage *mePage) {
     for (int i = 0; i < mePage->GetSize(); i++) {                                                  // 5 将本节点的kv复制到左节点尾部， 本节点清空
       leftPage->Insert(mePage->ItemAt(i).first, mePage->ItemAt(i).second, this->comparator_);
     }
+    leftPage->SetNextPageId(mePage->GetNextPageId());                                            // 把本节点从叶子链表摘掉
+    this->SetLeafPrevPageId(mePage->GetNextPageId(), leftPage->GetPageId());
     this->buffer_pool_manager_->DeletePage(mePage->GetPageId());
     //this->buffer_pool_manager_->UnpinPage(parentPage->GetPageId());
     this->buffer_pool_manager_->UnpinPage(leftPage->GetPageId(), true);
@@ -442,6 +509,8 @@ void BPLUSTREE_TYPE::MergeLeafNode(LeafPage *mePage) {
     for (int i = 0; i < rightPage->GetSize(); i++) {                                                  // 5 将本节点的kv复制到右节点尾部， 本节点清空
       mePage->Insert(rightPage->ItemAt(i).first, rightPage->ItemAt(i).second, this->comparator_);
     }
+    mePage->SetNextPageId(rightPage->GetNextPageId());                                              // 把右节点从叶子链表摘掉
+    this->SetLeafPrevPageId(rightPage->GetNextPageId(), mePage->GetPageId());
     this->buffer_pool_manager_->DeletePage(rightPage->GetPageId());
     this->buffer_pool_manager_->UnpinPage(mePage->GetPageId(), true);
   }
@@ -520,6 +589,17 @@ void BPLUSTREE_TYPE::MergeInternalNode(InternalPage *mePage) {
 }
 
 
+// 设置叶子 page_id 的 prev 链接, page_id 非法则什么都不做
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SetLeafPrevPageId(page_id_t page_id, page_id_t prev_page_id) {
+  if (page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  Page *page = this->buffer_pool_manager_->FetchPage(page_id);
+  reinterpret_cast<LeafPage *>(page->GetData())->SetPrevPageId(prev_page_id);
+  this->buffer_pool_manager_->UnpinPage(page_id, true);
+}
+
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
@@ -533,15 +613,19 @@ void BPLUSTREE_TYPE::MergeInternalNode(InternalPage *mePage) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
+    this->FreeRetiredTrees();
     LeafPage *mePage;
+    if (this->IsEmpty()) {
+      return;
+    }
     mePage = reinterpret_cast<LeafPage *>(this->FindLeafPageByKey(key)->GetData());                     // 找到这个key 所在的叶子页
-    mePage->Remove(key, this->comparator_);                                 // 删除K:V
-    if (mePage->IsRootPage(this->GetRootPageId())) {
-      if (mePage->GetSize() == 1) {
-        this->buffer_pool_manager_->DeletePage(mePage->GetPageId());
-      }
+    int removed = mePage->Remove(key, this->comparator_);                   // 删除K:V
+    // 没有这个 key, 根叶子, 或者删完不少于半满: 不用调整
+    if (removed == 0 || mePage->IsRootPage(this->GetRootPageId()) || mePage->GetSize() >= mePage->GetMinSize()) {
+      this->buffer_pool_manager_->UnpinPage(mePage->GetPageId(), removed != 0);
       return;
     }
+    this->UnswizzleAll();                                                   // 借节点/合并要改内部节点
     // 尝试偷取节点
     int ret = this->StealLeafBrother(mePage);
     if (ret) {
@@ -562,31 +646,43 @@ auto BPLUSTREE_TYPE::FindLeftMostLeftLeafPage() -> Page* {
     return nullptr;
   }
 
-  Page *page = this->buffer_pool_manager_->FetchPage(this->GetRootPageId());   //获取page
-  assert(this->GetRootPageId() != 0);
-  printf("FindLeftMostLeftLeafPage pageid=%d\n", this->GetRootPageId());
-  BPlusTreePage *btPage = reinterpret_cast<BPlusTreePage *>(page->GetData());         //page 的data 强转为btpage
+  bool pinned;
+  Page *page = this->FetchRoot(&pinned);                                              //获取page
+  BPlusTreePage *ctpage = reinterpret_cast<BPlusTreePage *>(page->GetData());         //page 的data 强转为btpage
 
-  BPlusTreePage *ctpage = btPage;
   // 2 遍历寻找, 条件不是leaf, 则继续寻找
-  int count = 0;
-  while (!ctpage->IsLeafPage()) {       // 非 leaf
-    if (count == 1) {
-      break;
-    }
-    count++;
-    
-    printf("FindLeftMostLeftLeafPage pageid=%d\n", ctpage->GetPageId());
-    InternalPage *bintnal_page = reinterpret_cast <InternalPage *>(ctpage);    //btpage 强转为内部节点
-    page_id_t leftPageId =  bintnal_page->ValueAt(0);                                 //获取第一个kv的v, 即pageid
-    Page *leftPage = (this->buffer_pool_manager_->FetchPage(leftPageId));                  //或对page
-    BPlusTreePage *leftBtPage  = reinterpret_cast <BPlusTreePage *>(leftPage->GetData());        //强转为btpage
-    this->buffer_pool_manager_->UnpinPage(ctpage->GetPageId(), false);                            //获取了子接地那的page, 将父节点的page unpin
+  for (int depth = 0; !ctpage->IsLeafPage(); depth++) {       // 非 leaf
+    bool left_pinned;
+    Page *leftPage = this->FetchChild(page, pinned, 0, depth, &left_pinned);                 //第一个kv的v, 即最左边的孩子
+    this->ReleaseDescent(page, pinned);                                                //获取了子节点的page, 将父节点的page unpin
+
+    ctpage = reinterpret_cast <BPlusTreePage *>(leftPage->GetData());                //遍历, 则左侧
+    page = leftPage;                                                                   //保存本次的page
+    pinned = left_pinned;
+  }
+  return page;
+}
+
+// 一直向右下搜索, 反向扫描的起点
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindRightMostLeafPage() -> Page* {
+  if (IsEmpty()) {
+    return nullptr;
+  }
 
-    ctpage = leftBtPage;                                                              //遍历, 则左侧
-    page = leftPage;                                                                               //保存本次的page
+  bool pinned;
+  Page *page = this->FetchRoot(&pinned);
+  BPlusTreePage *ctpage = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  for (int depth = 0; !ctpage->IsLeafPage(); depth++) {
+    bool right_pinned;
+    int slot = reinterpret_cast<InternalPage *>(ctpage)->SlotAt(ctpage->GetSize() - 1);    // 最后一个kv的v
+    Page *rightPage = this->FetchChild(page, pinned, slot, depth, &right_pinned);
+    this->ReleaseDescent(page, pinned);
+
+    ctpage = reinterpret_cast <BPlusTreePage *>(rightPage->GetData());
+    page = rightPage;
+    pinned = right_pinned;
   }
-  //返回值怎么构造?  转化为leaf 节点
   return page;
 }
 
@@ -603,8 +699,11 @@ INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
   // 1 用root page id 获取页, 强转为 BPlusTreePage, 判断是不是 leaf , 一直想左下搜索
   Page *page = this->FindLeftMostLeftLeafPage();
+  if (page == nullptr) {
+    return this->End();
+  }
   B_PLUS_TREE_LEAF_PAGE_TYPE *lpage  = reinterpret_cast <B_PLUS_TREE_LEAF_PAGE_TYPE *>(page->GetData());  
-  return INDEXITERATOR_TYPE(0, lpage, this->buffer_pool_manager_);
+  return INDEXITERATOR_TYPE(0, lpage, this->buffer_pool_manager_, this->active_readers_);
 }
 
 /*
@@ -625,49 +724,397 @@ auto BPLUSTREE_TYPE::FindLeafPageByKey(KeyType key) -> Page* {
     return nullptr;
   }
 
-  Page *page = (this->buffer_pool_manager_->FetchPage(this->GetRootPageId()));   //获取page
+  bool pinned;
+  Page *page = this->FetchRoot(&pinned);                                               //获取page
   BPlusTreePage *btPage = reinterpret_cast <BPlusTreePage *>(page->GetData());         //page 的data 强转为btpage
 
   // 2 遍历寻找, 条件不是leaf, 则继续寻找
-  while (!btPage->IsLeafPage()) {
+  for (int depth = 0; !btPage->IsLeafPage(); depth++) {
     InternalPage *inernalPage = reinterpret_cast <InternalPage *>(btPage);    //btpage 强转为内部节点
 
     // 3 找到key 应该的的页的页id,   找的是某个key， 我小于这个key， 则我是这个key 左边位置对应的page
-    int id = 1; 
-    bool find = false;
-    for (id = 1; id < inernalPage->GetSize(); id++) {
-      KeyType curKey = inernalPage->KeyAt(id);    // [小于 curKey]  [大于等于curKey]
-      if (this->comparator_(key, curKey) < 0) {         //如果搜索的key 小于 curKey, 则位于前面的区间
-        find = true;
-        break;
-      }
-    }
-    id = id - 1;
-    if (!find) {                  //如果没有找到，则插入最后一个子节点
-      id = inernalPage->GetSize() - 1;
-    }
-    page_id_t leftPageId = inernalPage->ValueAt(id);                                 //获取第一个kv的v, 即pageid
-
+    int slot = inernalPage->ChildSlotByKey(key, this->comparator_);   // [小于 K(id+1)]  [大于等于 K(id)]
 
-    Page *leftPage = (this->buffer_pool_manager_->FetchPage(leftPageId));                  //获取page
+    bool left_pinned;
+    Page *leftPage = this->FetchChild(page, pinned, slot, depth, &left_pinned);                          //获取page
     BPlusTreePage *leftBtPage  = reinterpret_cast <BPlusTreePage *>(leftPage->GetData());        //强转为btpage
-    this->buffer_pool_manager_->UnpinPage(btPage->GetPageId(), false);                              //获取了子节点的page, 将父节点的page unpin
+    this->ReleaseDescent(page, pinned);                                                           //获取了子节点的page, 将父节点的page unpin
 
     btPage = leftBtPage;                                                              //遍历, 则左侧
     page = leftPage;                                                                  //保存本次的page
+    pinned = left_pinned;
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafPageWithFence(const KeyType &key, std::optional<KeyType> *fence) -> Page* {
+  *fence = std::nullopt;
+  if (IsEmpty()) {
+    return nullptr;
+  }
+
+  bool pinned;
+  Page *page = this->FetchRoot(&pinned);
+  auto *btPage = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  for (int depth = 0; !btPage->IsLeafPage(); depth++) {
+    auto *inernalPage = reinterpret_cast<InternalPage *>(btPage);
+    int id = inernalPage->ChildIndexByKey(key, this->comparator_);
+    if (id + 1 < inernalPage->GetSize()) {                      // 越往下的分隔 key 越紧
+      *fence = inernalPage->KeyAt(id + 1);
+    }
+    bool child_pinned;
+    Page *childPage = this->FetchChild(page, pinned, inernalPage->SlotAt(id), depth, &child_pinned);
+    this->ReleaseDescent(page, pinned);
+
+    btPage = reinterpret_cast<BPlusTreePage *>(childPage->GetData());
+    page = childPage;
+    pinned = child_pinned;
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::ProbeLeaf(const KeyType &key, std::optional<KeyType> *low_fence,
+                               std::optional<KeyType> *high_fence) -> bool {
+  *low_fence = std::nullopt;
+  *high_fence = std::nullopt;
+  if (IsEmpty()) {
+    return true;
+  }
+  if (!this->buffer_pool_manager_->IsPageResident(this->root_page_id_)) {
+    return false;
+  }
+
+  bool pinned;
+  Page *page = this->FetchRoot(&pinned);
+  auto *btPage = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  for (int depth = 0; !btPage->IsLeafPage(); depth++) {
+    auto *inernalPage = reinterpret_cast<InternalPage *>(btPage);
+    int id = inernalPage->ChildIndexByKey(key, this->comparator_);
+    if (id > 0) {                                               // 越往下的分隔 key 越紧
+      *low_fence = inernalPage->KeyAt(id);
+    }
+    if (id + 1 < inernalPage->GetSize()) {
+      *high_fence = inernalPage->KeyAt(id + 1);
+    }
+    if (!this->buffer_pool_manager_->IsPageResident(inernalPage->ValueAt(id))) {   // 孩子不在, 不去读它
+      this->ReleaseDescent(page, pinned);
+      return false;
+    }
+    bool child_pinned;
+    Page *childPage = this->FetchChild(page, pinned, inernalPage->SlotAt(id), depth, &child_pinned);
+    this->ReleaseDescent(page, pinned);
+
+    btPage = reinterpret_cast<BPlusTreePage *>(childPage->GetData());
+    page = childPage;
+    pinned = child_pinned;
+  }
+  this->ReleaseDescent(page, pinned);
+  return true;
+}
+
+/*
+ * swizzle 引用只存在 frame 上 (Page::swizzled_children_), 页里仍然是 page id, 刷盘不受影响.
+ * 每个引用持有孩子 frame 的一个 pin, 根 frame 也由 root_frame_ 持有一个 pin, 并且只往这些被持有的
+ * frame 上挂引用: 带引用的 frame 不会被驱逐或删除, buffer pool 也就不用碰这些引用, 后台线程
+ * (vacuum, 并行扫描) 同时用 buffer pool 也没关系.
+ * 持有的 frame 数不超过 pool size / SWIZZLE_POOL_FRACTION, 超过的孩子照常 FetchPage/UnpinPage.
+ * 改内部节点结构之前 UnswizzleAll 全部放掉, 之后的下降重新挂上.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FetchRoot(bool *pinned) -> Page * {
+  if (this->root_frame_ != nullptr) {
+    if (this->root_frame_->GetPageId() == this->root_page_id_) {
+      *pinned = false;
+      return this->root_frame_;
+    }
+    this->UnswizzleAll();                                       // 换了根
   }
+  Page *page = this->buffer_pool_manager_->FetchPage(this->root_page_id_);
+  if (this->swizzle_levels_ > 0 && this->CanSwizzle() && !reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage()) {
+    this->root_frame_ = page;                                   // 这个 pin 留给 root_frame_; 叶子根不缓存
+    this->swizzled_frames_++;
+    *pinned = false;
+    return page;
+  }
+  *pinned = true;
   return page;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FetchChild(Page *parent, bool parent_pinned, int slot, int depth, bool *pinned) -> Page * {
+  page_id_t child_id = reinterpret_cast<InternalPage *>(parent->GetData())->ValueAtSlot(slot);
+  bool swizzle = !parent_pinned && depth < this->swizzle_levels_;
+  if (swizzle) {
+    Page *child = parent->GetSwizzledChild(slot);
+    if (child != nullptr && child->GetPageId() == child_id) {
+      *pinned = false;
+      return child;
+    }
+    if (child != nullptr) {                                     // slot 里换了孩子, 放掉旧引用
+      parent->SwizzleChild(slot, nullptr);
+      this->ReleaseSwizzled(child);
+    }
+  }
+
+  Page *child = this->buffer_pool_manager_->FetchPage(child_id);
+  if (swizzle && this->CanSwizzle() && !reinterpret_cast<BPlusTreePage *>(child->GetData())->IsLeafPage()) {
+    parent->SwizzleChild(slot, child);                          // 这个 pin 留给引用
+    this->swizzled_frames_++;
+    *pinned = false;
+    return child;
+  }
+  *pinned = true;
+  return child;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleaseDescent(Page *page, bool pinned) {
+  if (pinned) {
+    this->buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::CanSwizzle() -> bool {
+  return this->swizzled_frames_ < this->buffer_pool_manager_->GetPoolSize() / SWIZZLE_POOL_FRACTION;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::UnswizzleAll() {
+  if (this->root_frame_ != nullptr) {
+    this->ReleaseSwizzled(this->root_frame_);
+    this->root_frame_ = nullptr;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleaseSwizzled(Page *frame) {
+  for (Page *child : frame->UnswizzleChildren()) {
+    if (child != nullptr) {
+      this->ReleaseSwizzled(child);
+    }
+  }
+  this->buffer_pool_manager_->UnpinPage(frame->GetPageId(), false);
+  this->swizzled_frames_--;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SetSwizzleLevels(int levels) {
+  this->UnswizzleAll();
+  this->swizzle_levels_ = levels;
+}
+
+/*****************************************************************************
+ * REINDEX
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::GetStats() -> IndexStats {
+  IndexStats stats;
+  if (IsEmpty()) {
+    return stats;
+  }
+
+  // 1 最左路径得到高度, 再数内部节点
+  Page *page = this->FindLeftMostLeftLeafPage();
+  page_id_t leaf_id = page->GetPageId();
+  this->buffer_pool_manager_->UnpinPage(leaf_id, false);
+  stats.height_ = 1;
+  for (page_id_t id = this->root_page_id_; id != leaf_id; stats.height_++) {
+    auto *internal = reinterpret_cast<InternalPage *>(this->buffer_pool_manager_->FetchPage(id)->GetData());
+    page_id_t child = internal->ValueAt(0);
+    this->buffer_pool_manager_->UnpinPage(id, false);
+    id = child;
+  }
+  stats.internal_pages_ = this->CountInternalPages(this->root_page_id_, stats.height_);
+
+  // 2 沿叶子链数叶子和 entry, 下一个叶子正好是下一页的算连续
+  int links = 0;
+  int contiguous = 0;
+  while (leaf_id != INVALID_PAGE_ID) {
+    auto *leaf = reinterpret_cast<LeafPage *>(this->buffer_pool_manager_->FetchPage(leaf_id)->GetData());
+    stats.leaf_pages_++;
+    stats.entries_ += leaf->GetSize();
+    page_id_t next = leaf->GetNextPageId();
+    if (next != INVALID_PAGE_ID) {
+      links++;
+      contiguous += next == leaf_id + 1 ? 1 : 0;
+    }
+    this->buffer_pool_manager_->UnpinPage(leaf_id, false);
+    leaf_id = next;
+  }
+  // 叶子到 max size 就分裂, 最多装 max size - 1 个
+  stats.fill_factor_ = static_cast<double>(stats.entries_) / (stats.leaf_pages_ * (this->leaf_max_size_ - 1));
+  stats.leaf_contiguity_ = links == 0 ? 1.0 : static_cast<double>(contiguous) / links;
+  return stats;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::CountInternalPages(page_id_t page_id, int levels) -> int {
+  if (levels <= 1) {
+    return 0;
+  }
+  auto *internal = reinterpret_cast<InternalPage *>(this->buffer_pool_manager_->FetchPage(page_id)->GetData());
+  std::vector<page_id_t> children;
+  for (int i = 0; i < internal->GetSize(); i++) {
+    children.push_back(internal->ValueAt(i));
+  }
+  this->buffer_pool_manager_->UnpinPage(page_id, false);
+
+  int count = 1;
+  for (auto child : children) {
+    count += this->CountInternalPages(child, levels - 1);
+  }
+  return count;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::Reindex(double fill_factor, Transaction *transaction) {
+  this->FreeRetiredTrees();
+  if (IsEmpty()) {
+    return;
+  }
+  int64_t entries = this->GetStats().entries_;
+  if (entries == 0) {
+    return;
+  }
+
+  // 1 叶子: 先连续分配完所有叶子再建内部节点, 叶子的 page id 就是 key 的顺序; entry 平均分到各页
+  auto leaf_capacity = std::clamp(static_cast<int64_t>((this->leaf_max_size_ - 1) * fill_factor), int64_t{1},
+                                  static_cast<int64_t>(this->leaf_max_size_ - 1));
+  int64_t leaves = (entries + leaf_capacity - 1) / leaf_capacity;
+  std::vector<std::pair<KeyType, page_id_t>> level;          // 正在建的这一层: 每个节点的最小 key 和页号
+  {
+    auto it = this->Begin();
+    LeafPage *prev = nullptr;
+    for (int64_t i = 0; i < leaves; i++) {
+      page_id_t page_id;
+      auto *leaf = reinterpret_cast<LeafPage *>(this->buffer_pool_manager_->NewPage(&page_id)->GetData());
+      leaf->Init(page_id, INVALID_PAGE_ID, this->leaf_max_size_);
+      for (int64_t n = entries / leaves + (i < entries % leaves ? 1 : 0); n > 0; n--) {
+        leaf->InsertElemLast(*it);
+        ++it;
+      }
+      if (prev != nullptr) {
+        prev->SetNextPageId(page_id);
+        leaf->SetPrevPageId(prev->GetPageId());
+        this->buffer_pool_manager_->UnpinPage(prev->GetPageId(), true);
+      }
+      level.emplace_back(leaf->KeyAt(0), page_id);
+      prev = leaf;
+    }
+    this->buffer_pool_manager_->UnpinPage(prev->GetPageId(), true);
+  }
+
+  // 2 逐层往上建内部节点, 直到只剩一个节点; 内部节点同样到 max size 就分裂, 最多 max size - 1 个孩子
+  auto internal_capacity = static_cast<size_t>(std::max(2, this->internal_max_size_ - 1));
+  while (level.size() > 1) {
+    size_t nodes = (level.size() + internal_capacity - 1) / internal_capacity;
+    std::vector<std::pair<KeyType, page_id_t>> upper;
+    size_t pos = 0;
+    for (size_t i = 0; i < nodes; i++) {
+      page_id_t page_id;
+      auto *internal = reinterpret_cast<InternalPage *>(this->buffer_pool_manager_->NewPage(&page_id)->GetData());
+      internal->Init(page_id, INVALID_PAGE_ID, this->internal_max_size_);
+      size_t count = level.size() / nodes + (i < level.size() % nodes ? 1 : 0);
+      for (size_t j = pos; j < pos + count; j++) {
+        internal->InsertElemLast(level[j]);                     // [0] 的 key 不参与查找
+        Page *child = this->buffer_pool_manager_->FetchPage(level[j].second);
+        reinterpret_cast<BPlusTreePage *>(child->GetData())->SetParentPageId(page_id);
+        this->buffer_pool_manager_->UnpinPage(level[j].second, true);
+      }
+      internal->ToEytzingerLayout();                            // 建好就是只读的, 下次写它时再换回有序布局
+      upper.emplace_back(level[pos].first, page_id);
+      pos += count;
+      this->buffer_pool_manager_->UnpinPage(page_id, true);
+    }
+    level = std::move(upper);
+  }
+
+  // 3 切换 root, 旧树交给 FreeRetiredTrees: 切换前拿到的迭代器可能还在旧树的叶子上
+  this->UnswizzleAll();
+  this->retired_roots_.push_back(this->root_page_id_);
+  this->root_page_id_ = level[0].second;
+  this->UpdateRootPageId(0);
+  this->FreeRetiredTrees();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::FreeSubtree(page_id_t page_id) {
+  auto *page = reinterpret_cast<BPlusTreePage *>(this->buffer_pool_manager_->FetchPage(page_id)->GetData());
+  std::vector<page_id_t> children;
+  if (!page->IsLeafPage()) {
+    auto *internal = reinterpret_cast<InternalPage *>(page);
+    for (int i = 0; i < internal->GetSize(); i++) {
+      children.push_back(internal->ValueAt(i));
+    }
+  }
+  this->buffer_pool_manager_->UnpinPage(page_id, false);
+  for (auto child : children) {
+    this->FreeSubtree(child);
+  }
+  this->buffer_pool_manager_->DeletePage(page_id);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::FreeRetiredTrees() {
+  // 新的迭代器都从新 root 下降, 计数到 0 之后不会再有读者进旧树
+  if (this->retired_roots_.empty() || this->active_readers_->load() > 0) {
+    return;
+  }
+  for (auto root : this->retired_roots_) {
+    this->FreeSubtree(root);
+  }
+  this->retired_roots_.clear();
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
   Page *page = FindLeafPageByKey(key);
+  if (page == nullptr) {
+    return this->End();
+  }
   B_PLUS_TREE_LEAF_PAGE_TYPE *lpage  = reinterpret_cast <B_PLUS_TREE_LEAF_PAGE_TYPE *>(page->GetData());
-  int index = 0;
-  if (lpage != nullptr) {
-    index = lpage->IndexByKey(key, this->comparator_);
+  int index = lpage->IndexByKey(key, this->comparator_);
+  return INDEXITERATOR_TYPE(index, lpage, this->buffer_pool_manager_, this->active_readers_);
+}
+
+/*
+ * 范围扫描的起点:
+ *   正向: low 所在的叶子, 开区间从第一个 > low 的位置开始, 闭区间从第一个 >= low 开始; 无 low 则最左叶子
+ *   反向: high 所在的叶子, 从最后一个 <= high (开区间 < high) 的位置开始; 无 high 则最右叶子
+ * 起点落在本页末尾/开头之外时由迭代器顺着兄弟链接挪过去; 另一端交给迭代器判断.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RangeBegin(const std::optional<KeyType> &low, bool low_inclusive,
+                                const std::optional<KeyType> &high, bool high_inclusive, bool reverse)
+    -> INDEXITERATOR_TYPE {
+  const std::optional<KeyType> &start = reverse ? high : low;
+  bool start_inclusive = reverse ? high_inclusive : low_inclusive;
+  Page *page;
+  if (start.has_value()) {
+    page = this->FindLeafPageByKey(*start);
+  } else {
+    page = reverse ? this->FindRightMostLeafPage() : this->FindLeftMostLeftLeafPage();
+  }
+  if (page == nullptr) {
+    return this->End();
+  }
+
+  auto *lpage = reinterpret_cast<LeafPage *>(page->GetData());
+  int index;
+  if (!start.has_value()) {
+    index = reverse ? lpage->GetSize() - 1 : 0;
+  } else if (reverse) {
+    index = (start_inclusive ? lpage->UpperIndexByKey(*start, this->comparator_)
+                             : lpage->IndexByKey(*start, this->comparator_)) - 1;
+  } else {
+    index = start_inclusive ? lpage->IndexByKey(*start, this->comparator_)
+                            : lpage->UpperIndexByKey(*start, this->comparator_);
   }
-  return INDEXITERATOR_TYPE(index, lpage, this->buffer_pool_manager_);
+  return INDEXITERATOR_TYPE(index, lpage, this->buffer_pool_manager_, this->comparator_, reverse,
+                            reverse ? low : high, reverse ? low_inclusive : high_inclusive, this->active_readers_);
 }
 
 /*
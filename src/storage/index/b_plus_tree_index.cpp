@@ -11,6 +11,8 @@
 
 #include "storage/index/b_plus_tree_index.h"
 
+#include <algorithm>
+
 namespace bustub {
 /*
  * Constructor
@@ -19,7 +21,8 @@ INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager)
     : Index(std::move(metadata)),
       comparator_(GetMetadata()->GetKeySchema()),
-      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_) {}
+      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_),
+      change_buffer_(KeyLess{comparator_}) {}
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
@@ -27,7 +30,45 @@ void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *t
   KeyType index_key;
   index_key.SetFromKey(key);
 
-  container_.Insert(index_key, rid, transaction);
+  if (!BufferChange(index_key, &rid)) {
+    container_.Insert(index_key, rid, transaction);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::InsertEntries(const std::vector<std::pair<Tuple, RID>> &entries, Transaction *transaction) {
+  std::vector<MappingType> batch;
+  batch.reserve(entries.size());
+  for (const auto &[key, rid] : entries) {
+    KeyType index_key;
+    index_key.SetFromKey(key);
+    batch.emplace_back(index_key, rid);
+  }
+  if (change_buffer_capacity_ == 0) {
+    container_.InsertBatch(&batch, transaction);
+    return;
+  }
+
+  // 排好序一段一段探测: 同一个 fence 范围里的 key 落在同一个页下面, 在不在 buffer pool 只探测一次
+  std::sort(batch.begin(), batch.end(),
+            [this](const MappingType &a, const MappingType &b) { return comparator_(a.first, b.first) < 0; });
+  std::vector<MappingType> direct;
+  std::optional<KeyType> high_fence;
+  bool probed = false;
+  bool resident = false;
+  for (const auto &[index_key, rid] : batch) {
+    if (!probed || (high_fence.has_value() && comparator_(index_key, *high_fence) >= 0)) {
+      std::optional<KeyType> low_fence;
+      resident = container_.ProbeLeaf(index_key, &low_fence, &high_fence);
+      probed = true;
+    }
+    if (resident && change_buffer_.count(index_key) == 0) {
+      direct.emplace_back(index_key, rid);
+    } else {
+      RecordChange(index_key, &rid);
+    }
+  }
+  container_.InsertBatch(&direct, transaction);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -36,7 +77,9 @@ void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *t
   KeyType index_key;
   index_key.SetFromKey(key);
 
-  container_.Remove(index_key, transaction);
+  if (!BufferChange(index_key, nullptr)) {
+    container_.Remove(index_key, transaction);
+  }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -45,18 +88,121 @@ void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, T
   KeyType index_key;
   index_key.SetFromKey(key);
 
+  if (!change_buffer_.empty()) {                                  // 读叶子之前先把落在它上面的缓冲修改合并进去
+    std::optional<KeyType> low_fence;
+    std::optional<KeyType> high_fence;
+    container_.ProbeLeaf(index_key, &low_fence, &high_fence);
+    MergeRange(low_fence, high_fence);
+  }
   container_.GetValue(index_key, result, transaction);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_INDEX_TYPE::GetBeginIterator() -> INDEXITERATOR_TYPE { return container_.Begin(); }
+auto BPLUSTREE_INDEX_TYPE::GetStats() -> std::optional<IndexStats> {
+  MergeChangeBuffer();
+  return container_.GetStats();
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE { return container_.Begin(key); }
+auto BPLUSTREE_INDEX_TYPE::Reindex(Transaction *transaction) -> bool {
+  MergeChangeBuffer();
+  container_.Reindex(1.0, transaction);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetBeginIterator() -> INDEXITERATOR_TYPE {
+  MergeChangeBuffer();
+  return container_.Begin();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE {
+  MergeRange(key, std::nullopt);
+  return container_.Begin(key);
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetEndIterator() -> INDEXITERATOR_TYPE { return container_.End(); }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetRangeIterator(const std::optional<KeyType> &low, bool low_inclusive,
+                                            const std::optional<KeyType> &high, bool high_inclusive, bool reverse)
+    -> INDEXITERATOR_TYPE {
+  MergeRange(low, high);
+  return container_.RangeBegin(low, low_inclusive, high, high_inclusive, reverse);
+}
+
+/*
+ * change buffer
+ * 只缓冲叶子不在 buffer pool 里的修改, 省掉一次随机读; 叶子在的话直接改和缓冲一样快.
+ * 一个 key 上的多次修改压成一个净修改 BufferedChange, 和依次作用在树上的结果一样 (树里 key 唯一, 重复插入被忽略):
+ *   删除          -> 先删, 不插; 之前缓冲的插入作废
+ *   插入          -> 已经缓冲了插入就忽略 (先到的插入占住了 key), 否则在删除(如果有)之后插入
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::BufferChange(const KeyType &key, const RID *rid) -> bool {
+  if (change_buffer_capacity_ == 0) {
+    return false;
+  }
+  if (change_buffer_.count(key) == 0) {                           // 这个 key 有缓冲的修改时必须排在后面, 不能直接改树
+    std::optional<KeyType> low_fence;
+    std::optional<KeyType> high_fence;
+    if (container_.ProbeLeaf(key, &low_fence, &high_fence)) {
+      return false;
+    }
+  }
+  RecordChange(key, rid);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::RecordChange(const KeyType &key, const RID *rid) {
+  BufferedChange &change = change_buffer_[key];
+  if (rid == nullptr) {
+    change.remove_ = true;
+    change.insert_.reset();
+  } else if (!change.insert_.has_value()) {
+    change.insert_.emplace(key, *rid);
+  }
+  if (change_buffer_.size() >= change_buffer_capacity_) {         // 满了整批合并, key 有序, 相邻的修改落在同一个叶子
+    MergeChangeBuffer();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::MergeRange(const std::optional<KeyType> &low, const std::optional<KeyType> &high) {
+  if (change_buffer_.empty() || (low.has_value() && high.has_value() && comparator_(*low, *high) > 0)) {
+    return;
+  }
+  auto begin = low.has_value() ? change_buffer_.lower_bound(*low) : change_buffer_.begin();
+  auto end = high.has_value() ? change_buffer_.upper_bound(*high) : change_buffer_.end();
+
+  // 先按 key 顺序做删除, 再把插入交给 InsertBatch; 同一个 key 的删除总在插入之前, 不同 key 之间互不影响
+  std::vector<MappingType> inserts;
+  for (auto it = begin; it != end; ++it) {
+    if (it->second.remove_ && !container_.IsEmpty()) {
+      container_.Remove(it->first);
+    }
+    if (it->second.insert_.has_value()) {
+      inserts.push_back(*it->second.insert_);
+    }
+  }
+  change_buffer_.erase(begin, end);
+  container_.InsertBatch(&inserts);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::MergeChangeBuffer() { MergeRange(std::nullopt, std::nullopt); }
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::SetChangeBufferCapacity(size_t capacity) {
+  change_buffer_capacity_ = capacity;
+  if (change_buffer_.size() >= capacity) {
+    MergeChangeBuffer();
+  }
+}
+
 template class BPlusTreeIndex<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
@@ -1,5 +1,7 @@
+#include <algorithm>
 #include <vector>
 
+#include "common/exception.h"
 #include "storage/index/extendible_hash_table_index.h"
 
 namespace bustub {
@@ -20,7 +22,14 @@ void HASH_TABLE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *
   KeyType index_key;
   index_key.SetFromKey(key);
 
-  container_.Insert(transaction, index_key, rid);
+  // 已经有这一项, 或者同一个 key 的 rid 多到一个桶放不下 (桶已分裂到目录上限); 后者不能悄悄丢掉这一项
+  if (!container_.Insert(transaction, index_key, rid)) {
+    std::vector<RID> rids;
+    container_.GetValue(transaction, index_key, &rids);
+    if (std::find(rids.begin(), rids.end(), rid) == rids.end()) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "hash index bucket overflow: too many rows with the same key");
+    }
+  }
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
@@ -2,6 +2,7 @@
  * index_iterator.cpp
  */
 #include <cassert>
+#include <utility>
 
 #include "storage/index/index_iterator.h"
 
@@ -15,11 +16,68 @@ INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator() = default;
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::IndexIterator(int index, B_PLUS_TREE_LEAF_PAGE_TYPE *btpage, BufferPoolManager *bpm):
-                              index_(index), bptLeafPage_(btpage), buffer_pool_manager_(bpm) {}
+INDEXITERATOR_TYPE::IndexIterator(int index, B_PLUS_TREE_LEAF_PAGE_TYPE *btpage, BufferPoolManager *bpm,
+                                  std::shared_ptr<std::atomic<int64_t>> readers):
+                              index_(index), bptLeafPage_(btpage), buffer_pool_manager_(bpm),
+                              readers_(std::move(readers)) {
+  this->Register();
+  this->Settle();
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::~IndexIterator() = default;  // NOLINT
+INDEXITERATOR_TYPE::IndexIterator(int index, B_PLUS_TREE_LEAF_PAGE_TYPE *btpage, BufferPoolManager *bpm,
+                                  const KeyComparator &comparator, bool reverse, std::optional<KeyType> stop,
+                                  bool stop_inclusive, std::shared_ptr<std::atomic<int64_t>> readers)
+    : index_(index),
+      bptLeafPage_(btpage),
+      buffer_pool_manager_(bpm),
+      reverse_(reverse),
+      stop_(std::move(stop)),
+      stop_inclusive_(stop_inclusive),
+      comparator_(comparator),
+      readers_(std::move(readers)) {
+  this->Register();
+  this->Settle();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::IndexIterator(IndexIterator &&other) noexcept
+    : index_(other.index_),
+      bptLeafPage_(other.bptLeafPage_),
+      buffer_pool_manager_(other.buffer_pool_manager_),
+      reverse_(other.reverse_),
+      stop_(std::move(other.stop_)),
+      stop_inclusive_(other.stop_inclusive_),
+      comparator_(std::move(other.comparator_)),
+      readers_(std::move(other.readers_)) {
+  other.bptLeafPage_ = nullptr;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::operator=(IndexIterator &&other) noexcept -> IndexIterator & {
+  if (this != &other) {
+    if (this->bptLeafPage_ != nullptr) {
+      this->Finish();
+    }
+    index_ = other.index_;
+    bptLeafPage_ = other.bptLeafPage_;
+    buffer_pool_manager_ = other.buffer_pool_manager_;
+    reverse_ = other.reverse_;
+    stop_ = std::move(other.stop_);
+    stop_inclusive_ = other.stop_inclusive_;
+    comparator_ = std::move(other.comparator_);
+    readers_ = std::move(other.readers_);
+    other.bptLeafPage_ = nullptr;
+  }
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::~IndexIterator() {  // NOLINT
+  if (this->bptLeafPage_ != nullptr) {                      // 没扫到终点就不要了 (LIMIT), 放掉当前叶子
+    this->Finish();
+  }
+}
 
 /**
  * @brief 首先要明白, 迭代器是为了扫描的时候, 有可能是跨叶子页的.
@@ -58,23 +116,62 @@ auto INDEXITERATOR_TYPE::operator*() -> const MappingType & {
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
-    this->index_++;
-    if (this->bptLeafPage_->GetSize() == this->index_ ) {
-        if (this->bptLeafPage_->GetNextPageId() == INVALID_PAGE_ID) {
-            this->bptLeafPage_ = nullptr;
-            return *this;
-        }
-        Page *nextPage = this->buffer_pool_manager_->FetchPage(this->bptLeafPage_->GetNextPageId()); 
-        if (nextPage == nullptr) {      // 非正常逻辑, 不会走进来
-            printf("非正常逻辑");
+    if (this->bptLeafPage_ == nullptr) {
+        return *this;
+    }
+    this->index_ += this->reverse_ ? -1 : 1;
+    this->Settle();
+    return *this;
+}
+
+/**
+ * @brief 越过本页的一端时, 顺着 next (反向则 prev) 链接换到兄弟叶子, 跳过空叶子;
+ * 然后检查终点, 越过终点就提前结束, 不再去碰后面的叶子.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Settle() {
+    while (this->bptLeafPage_ != nullptr && (this->index_ < 0 || this->index_ >= this->bptLeafPage_->GetSize())) {
+        page_id_t sibling = this->reverse_ ? this->bptLeafPage_->GetPrevPageId() : this->bptLeafPage_->GetNextPageId();
+        if (sibling == INVALID_PAGE_ID) {
+            this->Finish();
+            return;
         }
-        B_PLUS_TREE_LEAF_PAGE_TYPE *nextLeafPage = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(nextPage->GetData());
+        Page *nextPage = this->buffer_pool_manager_->FetchPage(sibling);
         this->buffer_pool_manager_->UnpinPage(this->bptLeafPage_->GetPageId(), false);
+        this->bptLeafPage_ = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(nextPage->GetData());
+        this->index_ = this->reverse_ ? this->bptLeafPage_->GetSize() - 1 : 0;
+    }
+    if (this->bptLeafPage_ == nullptr || !this->stop_.has_value()) {
+        return;
+    }
+    int cmp = (*this->comparator_)(this->bptLeafPage_->KeyAt(this->index_), *this->stop_);
+    if (this->reverse_) {
+        cmp = -cmp;
+    }
+    if (cmp > 0 || (cmp == 0 && !this->stop_inclusive_)) {
+        this->Finish();
+    }
+}
 
-        this->bptLeafPage_ = nextLeafPage;
-        this->index_ = 0;
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Register() {
+    if (this->bptLeafPage_ == nullptr) {
+        this->readers_.reset();
+        return;
+    }
+    if (this->readers_ != nullptr) {
+        this->readers_->fetch_add(1);
+    }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Finish() {
+    this->buffer_pool_manager_->UnpinPage(this->bptLeafPage_->GetPageId(), false);
+    this->bptLeafPage_ = nullptr;
+    if (this->readers_ != nullptr) {
+        this->readers_->fetch_sub(1);
+        this->readers_.reset();
     }
-    return *this;
 }
 
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
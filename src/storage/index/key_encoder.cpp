@@ -0,0 +1,156 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_encoder.cpp
+//
+// Identification: src/storage/index/key_encoder.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/macros.h"
+#include "storage/index/key_encoder.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+auto KeyEncoder::Encode(const Tuple &key, const Schema *key_schema) -> std::string {
+  std::string out;
+  out.reserve(key_schema->GetLength());
+  for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+    AppendValue(key.GetValue(key_schema, i), &out);
+  }
+  return out;
+}
+
+void KeyEncoder::AppendValue(const Value &value, std::string *out) {
+  switch (value.GetTypeId()) {
+    case TypeId::BOOLEAN:
+      out->push_back(static_cast<char>(value.GetAs<int8_t>()));
+      return;
+    case TypeId::TINYINT:
+      AppendBigEndian(static_cast<uint8_t>(value.GetAs<int8_t>()) ^ 0x80U, 1, out);
+      return;
+    case TypeId::SMALLINT:
+      AppendBigEndian(static_cast<uint16_t>(value.GetAs<int16_t>()) ^ 0x8000U, 2, out);
+      return;
+    case TypeId::INTEGER:
+      AppendBigEndian(static_cast<uint32_t>(value.GetAs<int32_t>()) ^ 0x80000000U, 4, out);
+      return;
+    case TypeId::BIGINT:
+      AppendBigEndian(static_cast<uint64_t>(value.GetAs<int64_t>()) ^ 0x8000000000000000ULL, 8, out);
+      return;
+    case TypeId::DECIMAL: {
+      auto d = value.GetAs<double>();
+      uint64_t bits;
+      memcpy(&bits, &d, sizeof(double));
+      // 正数翻转符号位, 负数全部取反, 这样字节序就是数值序
+      bits = (bits & 0x8000000000000000ULL) != 0 ? ~bits : bits ^ 0x8000000000000000ULL;
+      AppendBigEndian(bits, 8, out);
+      return;
+    }
+    case TypeId::TIMESTAMP:
+      AppendBigEndian(value.GetAs<uint64_t>(), 8, out);
+      return;
+    case TypeId::VARCHAR: {
+      // NULL 只占一个 0x00, 排在所有字符串前面
+      if (value.IsNull()) {
+        out->push_back('\0');
+        return;
+      }
+      // 0x00 转义成 0x00 0xFF, 以 0x00 0x00 结尾: 短串是长串的前缀时排在前面
+      out->push_back('\1');
+      for (char c : value.ToString()) {
+        out->push_back(c);
+        if (c == '\0') {
+          out->push_back(static_cast<char>(0xFF));
+        }
+      }
+      out->append(2, '\0');
+      return;
+    }
+    default:
+      throw NotImplementedException("KeyEncoder: unsupported key column type");
+  }
+}
+
+auto KeyEncoder::DecodeBigInt(std::string_view bytes) -> int64_t {
+  uint64_t bits = 0;
+  for (size_t i = 0; i < 8 && i < bytes.size(); i++) {
+    bits = (bits << 8) | static_cast<uint8_t>(bytes[i]);
+  }
+  return static_cast<int64_t>(bits ^ 0x8000000000000000ULL);
+}
+
+auto KeyEncoder::Decode(std::string_view bytes, const Schema *key_schema) -> Tuple {
+  std::vector<Value> values;
+  values.reserve(key_schema->GetColumnCount());
+  for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+    values.push_back(DecodeValue(&bytes, key_schema->GetColumn(i).GetType()));
+  }
+  return {values, key_schema};
+}
+
+auto KeyEncoder::DecodeValue(std::string_view *bytes, TypeId type) -> Value {
+  switch (type) {
+    case TypeId::BOOLEAN:
+      return ValueFactory::GetBooleanValue(static_cast<int8_t>(ReadBigEndian(bytes, 1)));
+    case TypeId::TINYINT:
+      return ValueFactory::GetTinyIntValue(static_cast<int8_t>(ReadBigEndian(bytes, 1) ^ 0x80U));
+    case TypeId::SMALLINT:
+      return ValueFactory::GetSmallIntValue(static_cast<int16_t>(ReadBigEndian(bytes, 2) ^ 0x8000U));
+    case TypeId::INTEGER:
+      return ValueFactory::GetIntegerValue(static_cast<int32_t>(ReadBigEndian(bytes, 4) ^ 0x80000000U));
+    case TypeId::BIGINT:
+      return ValueFactory::GetBigIntValue(static_cast<int64_t>(ReadBigEndian(bytes, 8) ^ 0x8000000000000000ULL));
+    case TypeId::DECIMAL: {
+      uint64_t bits = ReadBigEndian(bytes, 8);
+      bits = (bits & 0x8000000000000000ULL) != 0 ? bits ^ 0x8000000000000000ULL : ~bits;
+      double d;
+      memcpy(&d, &bits, sizeof(double));
+      return ValueFactory::GetDecimalValue(d);
+    }
+    case TypeId::TIMESTAMP:
+      return ValueFactory::GetTimestampValue(static_cast<int64_t>(ReadBigEndian(bytes, 8)));
+    case TypeId::VARCHAR: {
+      if (ReadBigEndian(bytes, 1) == 0) {
+        return ValueFactory::GetNullValueByType(TypeId::VARCHAR);
+      }
+      std::string str;
+      size_t i = 0;
+      while (i + 1 < bytes->size() && !((*bytes)[i] == '\0' && (*bytes)[i + 1] == '\0')) {
+        str.push_back((*bytes)[i]);
+        i += (*bytes)[i] == '\0' ? 2 : 1;
+      }
+      bytes->remove_prefix(std::min(i + 2, bytes->size()));
+      return ValueFactory::GetVarcharValue(str);
+    }
+    default:
+      throw NotImplementedException("KeyEncoder: unsupported key column type");
+  }
+}
+
+auto KeyEncoder::ReadBigEndian(std::string_view *bytes, size_t width) -> uint64_t {
+  BUSTUB_ASSERT(bytes->size() >= width, "truncated key");
+  uint64_t bits = 0;
+  for (size_t i = 0; i < width; i++) {
+    bits = (bits << 8) | static_cast<uint8_t>((*bytes)[i]);
+  }
+  bytes->remove_prefix(width);
+  return bits;
+}
+
+void KeyEncoder::AppendBigEndian(uint64_t bits, size_t width, std::string *out) {
+  for (size_t i = width; i > 0; i--) {
+    out->push_back(static_cast<char>((bits >> ((i - 1) * 8)) & 0xFF));
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lsm_index.cpp
+//
+// Identification: src/storage/index/lsm_index.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/lsm_index.h"
+
+#include "common/exception.h"
+#include "storage/index/key_encoder.h"
+
+namespace bustub {
+
+static constexpr size_t RID_SIZE = sizeof(int64_t);
+
+LsmIndex::LsmIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager)
+    : Index(std::move(metadata)), tree_(buffer_pool_manager, RID_SIZE) {}
+
+auto LsmIndex::EncodeKey(const Tuple &key) const -> std::string { return KeyEncoder::Encode(key, GetKeySchema()); }
+
+auto LsmIndex::TreeKey(const Tuple &key, RID rid) const -> std::string {
+  std::string tree_key = EncodeKey(key);
+  auto bits = static_cast<uint64_t>(rid.Get());
+  for (int shift = 56; shift >= 0; shift -= 8) {
+    tree_key.push_back(static_cast<char>((bits >> shift) & 0xFF));
+  }
+  if (tree_key.size() > LSM_MAX_KEY_SIZE) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "key is too long for an lsm index");
+  }
+  return tree_key;
+}
+
+auto LsmIndex::GetRid(std::string_view tree_key) -> RID {
+  uint64_t bits = 0;
+  for (size_t i = tree_key.size() - RID_SIZE; i < tree_key.size(); i++) {
+    bits = (bits << 8) | static_cast<uint8_t>(tree_key[i]);
+  }
+  return RID(static_cast<int64_t>(bits));
+}
+
+void LsmIndex::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  tree_.Put(TreeKey(key, rid), false);
+}
+
+void LsmIndex::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) { tree_.Put(TreeKey(key, rid), true); }
+
+void LsmIndex::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
+  // key 的编码是定长的或者带结束符, 以它开头的树 key 恰好就是这个 key 的所有项, bloom filter 也按它查
+  std::string encoded = EncodeKey(key);
+  for (auto it = tree_.Scan(encoded, LsmTree::Successor(encoded), encoded); !it.IsEnd(); ++it) {
+    result->push_back(GetRid(it.Key()));
+  }
+}
+
+auto LsmIndex::Scan(const std::optional<Tuple> &low, bool low_inclusive, const std::optional<Tuple> &high,
+                    bool high_inclusive) const -> LsmIterator {
+  // 树 key = 编码 + rid, 所以 "> k" 从 Successor(k) 开始, "<= k" 到 Successor(k) 为止
+  std::string from;
+  if (low.has_value()) {
+    from = EncodeKey(*low);
+    if (!low_inclusive) {
+      auto next = LsmTree::Successor(from);
+      if (!next.has_value()) {
+        return LsmIterator({}, std::nullopt, false);
+      }
+      from = std::move(*next);
+    }
+  }
+  std::optional<std::string> to;
+  if (high.has_value()) {
+    to = high_inclusive ? LsmTree::Successor(EncodeKey(*high)) : EncodeKey(*high);
+  }
+  return tree_.Scan(from, std::move(to), std::nullopt);
+}
+
+}  // namespace bustub
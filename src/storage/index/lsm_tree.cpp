@@ -0,0 +1,549 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lsm_tree.cpp
+//
+// Identification: src/storage/index/lsm_tree.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/lsm_tree.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#include "murmur3/MurmurHash3.h"
+
+namespace bustub {
+
+//===--------------------------------------------------------------------===//
+// LsmMemTable
+//===--------------------------------------------------------------------===//
+
+struct LsmMemTable::Node {
+  /** next_ 实际有 height 个, 跟在结构体后面 */
+  static auto Make(std::string_view key, bool deleted, int height) -> Node * {
+    void *memory = ::operator new(sizeof(Node) + (height - 1) * sizeof(std::atomic<Node *>));
+    auto *node = new (memory) Node(key, deleted);
+    for (int i = 1; i < height; i++) {
+      new (&node->next_[i]) std::atomic<Node *>(nullptr);
+    }
+    return node;
+  }
+
+  static void Free(Node *node) {
+    node->~Node();
+    ::operator delete(node);
+  }
+
+  Node(std::string_view key, bool deleted) : key_(key), deleted_(deleted) {}
+
+  auto Next(int level) const -> Node * { return next_[level].load(std::memory_order_acquire); }
+
+  std::string key_;
+  std::atomic<bool> deleted_;
+  std::atomic<Node *> next_[1]{nullptr};
+};
+
+namespace {
+
+class MemTableCursor : public LsmCursor {
+ public:
+  MemTableCursor(std::shared_ptr<const LsmMemTable> memtable, const LsmMemTable::Node *node)
+      : memtable_(std::move(memtable)), node_(node) {}
+
+  auto Valid() const -> bool override { return node_ != nullptr; }
+  auto Key() const -> std::string_view override { return node_->key_; }
+  auto Deleted() const -> bool override { return node_->deleted_.load(std::memory_order_acquire); }
+  void Next() override { node_ = node_->Next(0); }
+
+ private:
+  std::shared_ptr<const LsmMemTable> memtable_;
+  const LsmMemTable::Node *node_;
+};
+
+class RunCursor : public LsmCursor {
+ public:
+  RunCursor(std::shared_ptr<const LsmRun> run, size_t page, std::string_view low) : run_(std::move(run)), page_(page) {
+    Load();
+    pos_ = std::lower_bound(offsets_.begin(), offsets_.end(), low,
+                            [this](uint16_t offset, std::string_view key) {
+                              return LsmRun::EntryKey(data_, offset) < key;
+                            }) -
+           offsets_.begin();
+    SkipExhaustedPage();
+  }
+
+  auto Valid() const -> bool override { return page_ < run_->GetNumPages(); }
+  auto Key() const -> std::string_view override { return LsmRun::EntryKey(data_, offsets_[pos_]); }
+  auto Deleted() const -> bool override { return LsmRun::EntryDeleted(data_, offsets_[pos_]); }
+  void Next() override {
+    pos_++;
+    SkipExhaustedPage();
+  }
+
+ private:
+  /** 整页拷出来就 unpin, 游标不占 buffer pool 的 frame */
+  void Load() {
+    offsets_.clear();
+    if (page_ < run_->GetNumPages()) {
+      run_->ReadPage(page_, &data_, &offsets_);
+    }
+  }
+
+  void SkipExhaustedPage() {
+    while (page_ < run_->GetNumPages() && pos_ == offsets_.size()) {
+      page_++;
+      pos_ = 0;
+      Load();
+    }
+  }
+
+  std::shared_ptr<const LsmRun> run_;
+  size_t page_;
+  size_t pos_{0};
+  std::string data_;
+  std::vector<uint16_t> offsets_;
+};
+
+}  // namespace
+
+LsmMemTable::LsmMemTable() : head_(Node::Make("", false, MAX_HEIGHT)) {}
+
+LsmMemTable::~LsmMemTable() {
+  Node *node = head_;
+  while (node != nullptr) {
+    Node *next = node->Next(0);
+    Node::Free(node);
+    node = next;
+  }
+}
+
+auto LsmMemTable::RandomHeight() -> int {
+  int height = 1;
+  while (height < MAX_HEIGHT && rng_() % 4 == 0) {
+    height++;
+  }
+  return height;
+}
+
+auto LsmMemTable::FindGreaterOrEqual(std::string_view key, Node **prev) const -> Node * {
+  Node *node = head_;
+  int level = height_.load(std::memory_order_acquire) - 1;
+  while (true) {
+    Node *next = node->Next(level);
+    if (next != nullptr && next->key_ < key) {
+      node = next;
+      continue;
+    }
+    if (prev != nullptr) {
+      prev[level] = node;
+    }
+    if (level == 0) {
+      return next;
+    }
+    level--;
+  }
+}
+
+void LsmMemTable::Put(std::string_view key, bool deleted) {
+  Node *prev[MAX_HEIGHT];
+  Node *node = FindGreaterOrEqual(key, prev);
+  if (node != nullptr && node->key_ == key) {
+    node->deleted_.store(deleted, std::memory_order_release);
+    return;
+  }
+
+  // 1 新节点先把自己的 next 都填好, 再从下往上逐层挂进去; 读者沿哪一层走到它都是完整的
+  int height = RandomHeight();
+  int old_height = height_.load(std::memory_order_relaxed);
+  for (int i = old_height; i < height; i++) {
+    prev[i] = head_;
+  }
+  if (height > old_height) {
+    height_.store(height, std::memory_order_release);
+  }
+  node = Node::Make(key, deleted, height);
+  for (int i = 0; i < height; i++) {
+    node->next_[i].store(prev[i]->Next(i), std::memory_order_relaxed);
+    prev[i]->next_[i].store(node, std::memory_order_release);
+  }
+  bytes_.fetch_add(sizeof(Node) + (height - 1) * sizeof(Node *) + key.size(), std::memory_order_relaxed);
+}
+
+auto LsmMemTable::NewCursor(std::shared_ptr<const LsmMemTable> memtable, std::string_view low)
+    -> std::unique_ptr<LsmCursor> {
+  const Node *node = memtable->FindGreaterOrEqual(low, nullptr);
+  return std::make_unique<MemTableCursor>(std::move(memtable), node);
+}
+
+//===--------------------------------------------------------------------===//
+// LsmRun
+//===--------------------------------------------------------------------===//
+
+LsmRun::LsmRun(BufferPoolManager *bpm, size_t bloom_suffix_size) : bpm_(bpm), bloom_suffix_size_(bloom_suffix_size) {}
+
+LsmRun::~LsmRun() {
+  for (page_id_t page_id : page_ids_) {
+    bpm_->DeletePage(page_id);
+  }
+}
+
+void LsmRun::BloomHash(std::string_view key, uint64_t *h1, uint64_t *h2) {
+  uint64_t out[2];
+  murmur3::MurmurHash3_x64_128(key.data(), static_cast<int>(key.size()), 0, out);
+  *h1 = out[0];
+  *h2 = out[1] | 1;  // 奇数步长, 各个 hash 落在不同的位上
+}
+
+void LsmRun::Append(std::string_view key, bool deleted) {
+  BUSTUB_ASSERT(key.size() <= LSM_MAX_KEY_SIZE, "key too long for a run page");
+  size_t entry_size = sizeof(uint16_t) + 1 + key.size();
+  if (page_count_ > 0 && page_.size() + entry_size > BUSTUB_PAGE_SIZE) {
+    FlushPage();
+  }
+  if (page_count_ == 0) {
+    fences_.emplace_back(key);
+    page_.assign(sizeof(uint16_t), '\0');                         // 页头: entry 个数, FlushPage 时填
+  }
+  auto key_len = static_cast<uint16_t>(key.size());
+  page_.append(reinterpret_cast<const char *>(&key_len), sizeof(key_len));
+  page_.push_back(static_cast<char>(deleted));
+  page_.append(key);
+  page_count_++;
+  bytes_ += entry_size;
+  last_key_ = key;
+
+  // 同一个 bloom key (去掉后缀) 的 entry 是挨着的, 只记一次
+  std::string_view bloom_key = key.substr(0, key.size() > bloom_suffix_size_ ? key.size() - bloom_suffix_size_ : 0);
+  if (bloom_hashes_.empty() || bloom_key != last_bloom_key_) {
+    uint64_t h1;
+    uint64_t h2;
+    BloomHash(bloom_key, &h1, &h2);
+    bloom_hashes_.emplace_back(h1, h2);
+    last_bloom_key_ = bloom_key;
+  }
+}
+
+void LsmRun::FlushPage() {
+  if (page_count_ == 0) {
+    return;
+  }
+  memcpy(page_.data(), &page_count_, sizeof(page_count_));
+  page_id_t page_id;
+  Page *page = bpm_->NewPage(&page_id);
+  memcpy(page->GetData(), page_.data(), page_.size());
+  bpm_->UnpinPage(page_id, true);
+  page_ids_.push_back(page_id);
+  page_count_ = 0;
+  page_.clear();
+}
+
+void LsmRun::Finish() {
+  FlushPage();
+  size_t bits = std::max<size_t>(64, bloom_hashes_.size() * BLOOM_BITS_PER_KEY);
+  bloom_.assign((bits + 63) / 64, 0);
+  bits = bloom_.size() * 64;
+  for (auto [h1, h2] : bloom_hashes_) {
+    for (size_t i = 0; i < BLOOM_HASHES; i++) {
+      uint64_t bit = (h1 + i * h2) % bits;
+      bloom_[bit / 64] |= static_cast<uint64_t>(1) << (bit % 64);
+    }
+  }
+  bloom_hashes_.clear();
+  bloom_hashes_.shrink_to_fit();
+  page_.clear();
+  page_.shrink_to_fit();
+}
+
+auto LsmRun::MayContain(std::string_view bloom_key) const -> bool {
+  if (bloom_.empty()) {
+    return false;
+  }
+  uint64_t h1;
+  uint64_t h2;
+  BloomHash(bloom_key, &h1, &h2);
+  size_t bits = bloom_.size() * 64;
+  for (size_t i = 0; i < BLOOM_HASHES; i++) {
+    uint64_t bit = (h1 + i * h2) % bits;
+    if ((bloom_[bit / 64] & (static_cast<uint64_t>(1) << (bit % 64))) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto LsmRun::Overlaps(std::string_view low, const std::optional<std::string> &high) const -> bool {
+  return !page_ids_.empty() && std::string_view(last_key_) >= low && (!high.has_value() || fences_[0] < *high);
+}
+
+void LsmRun::ReadPage(size_t i, std::string *data, std::vector<uint16_t> *offsets) const {
+  Page *page = bpm_->FetchPage(page_ids_[i]);
+  data->assign(page->GetData(), BUSTUB_PAGE_SIZE);
+  bpm_->UnpinPage(page_ids_[i], false);
+  uint16_t count;
+  memcpy(&count, data->data(), sizeof(count));
+  size_t offset = sizeof(count);
+  offsets->reserve(count);
+  for (uint16_t n = 0; n < count; n++) {
+    offsets->push_back(static_cast<uint16_t>(offset));
+    uint16_t key_len;
+    memcpy(&key_len, data->data() + offset, sizeof(key_len));
+    offset += sizeof(key_len) + 1 + key_len;
+  }
+}
+
+auto LsmRun::NewCursor(std::shared_ptr<const LsmRun> run, std::string_view low) -> std::unique_ptr<LsmCursor> {
+  // fence pointer: 最后一个首 key <= low 的页, 之前的页都比 low 小
+  const auto &fences = run->fences_;
+  size_t page = std::upper_bound(fences.begin(), fences.end(), low,
+                                 [](std::string_view key, const std::string &fence) { return key < fence; }) -
+                fences.begin();
+  return std::make_unique<RunCursor>(std::move(run), page == 0 ? 0 : page - 1, low);
+}
+
+//===--------------------------------------------------------------------===//
+// LsmIterator
+//===--------------------------------------------------------------------===//
+
+LsmIterator::LsmIterator(std::vector<std::unique_ptr<LsmCursor>> cursors, std::optional<std::string> high,
+                         bool keep_tombstones)
+    : cursors_(std::move(cursors)), high_(std::move(high)), keep_tombstones_(keep_tombstones) {
+  FindNext();
+}
+
+auto LsmIterator::operator++() -> LsmIterator & {
+  FindNext();
+  return *this;
+}
+
+void LsmIterator::FindNext() {
+  while (true) {
+    // 1 所有游标里最小的 key; 相等时下标小的 (新的) 赢
+    int winner = -1;
+    for (size_t i = 0; i < cursors_.size(); i++) {
+      if (cursors_[i]->Valid() && (winner < 0 || cursors_[i]->Key() < cursors_[winner]->Key())) {
+        winner = static_cast<int>(i);
+      }
+    }
+    if (winner < 0 || (high_.has_value() && cursors_[winner]->Key() >= *high_)) {
+      end_ = true;
+      return;
+    }
+    key_ = cursors_[winner]->Key();
+    deleted_ = cursors_[winner]->Deleted();
+
+    // 2 这个 key 在旧游标里的版本都被盖住了, 一起跳过
+    for (auto &cursor : cursors_) {
+      if (cursor->Valid() && cursor->Key() == key_) {
+        cursor->Next();
+      }
+    }
+    if (!deleted_ || keep_tombstones_) {
+      return;
+    }
+  }
+}
+
+//===--------------------------------------------------------------------===//
+// LsmTree
+//===--------------------------------------------------------------------===//
+
+LsmTree::LsmTree(BufferPoolManager *bpm, size_t bloom_suffix_size, size_t memtable_size, size_t l0_trigger,
+                 size_t size_ratio)
+    : bpm_(bpm),
+      bloom_suffix_size_(bloom_suffix_size),
+      memtable_size_(memtable_size),
+      l0_trigger_(l0_trigger),
+      size_ratio_(size_ratio),
+      memtable_(std::make_shared<LsmMemTable>()),
+      version_(std::make_shared<const Version>()) {
+  background_ = std::thread(&LsmTree::BackgroundWork, this);
+}
+
+LsmTree::~LsmTree() {
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  background_.join();
+}
+
+void LsmTree::Put(std::string_view key, bool deleted) {
+  std::unique_lock<std::mutex> lock(latch_);
+  memtable_->Put(key, deleted);
+  if (memtable_->GetBytes() < memtable_size_) {
+    return;
+  }
+  // 冻结, 交给后台线程写成 level 0 的 run; 上一个还没写完就等它 (写入比刷盘快时的反压)
+  cv_.wait(lock, [this] { return immutable_ == nullptr; });
+  immutable_ = std::move(memtable_);
+  memtable_ = std::make_shared<LsmMemTable>();
+  cv_.notify_all();
+}
+
+auto LsmTree::Scan(std::string_view low, std::optional<std::string> high,
+                   std::optional<std::string_view> bloom_key) const -> LsmIterator {
+  std::shared_ptr<const LsmMemTable> memtable;
+  std::shared_ptr<const LsmMemTable> immutable;
+  std::shared_ptr<const Version> version;
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    memtable = memtable_;
+    immutable = immutable_;
+    version = version_;
+  }
+
+  // 新的在前: memtable, 冻结的 memtable, level 0 (新的在前), level 1, 2, ...
+  std::vector<std::unique_ptr<LsmCursor>> cursors;
+  cursors.push_back(LsmMemTable::NewCursor(memtable, low));
+  if (immutable != nullptr) {
+    cursors.push_back(LsmMemTable::NewCursor(immutable, low));
+  }
+  auto add_run = [&](const std::shared_ptr<const LsmRun> &run) {
+    if (run != nullptr && run->Overlaps(low, high) && (!bloom_key.has_value() || run->MayContain(*bloom_key))) {
+      cursors.push_back(LsmRun::NewCursor(run, low));
+    }
+  };
+  for (const auto &run : version->l0_) {
+    add_run(run);
+  }
+  for (const auto &run : version->levels_) {
+    add_run(run);
+  }
+  return LsmIterator(std::move(cursors), std::move(high), false);
+}
+
+void LsmTree::Flush() {
+  std::unique_lock<std::mutex> lock(latch_);
+  cv_.wait(lock, [this] { return immutable_ == nullptr; });
+  if (!memtable_->IsEmpty()) {
+    immutable_ = std::move(memtable_);
+    memtable_ = std::make_shared<LsmMemTable>();
+    cv_.notify_all();
+  }
+  cv_.wait(lock, [this] { return immutable_ == nullptr && !busy_ && PickCompaction(*version_) < 0; });
+}
+
+auto LsmTree::GetShape() const -> std::vector<size_t> {
+  std::scoped_lock<std::mutex> lock(latch_);
+  std::vector<size_t> shape{version_->l0_.size()};
+  for (const auto &run : version_->levels_) {
+    shape.push_back(run == nullptr ? 0 : run->GetBytes());
+  }
+  return shape;
+}
+
+auto LsmTree::Successor(std::string_view prefix) -> std::optional<std::string> {
+  std::string next(prefix);
+  while (!next.empty() && static_cast<uint8_t>(next.back()) == 0xFF) {
+    next.pop_back();
+  }
+  if (next.empty()) {
+    return std::nullopt;
+  }
+  next.back() = static_cast<char>(static_cast<uint8_t>(next.back()) + 1);
+  return next;
+}
+
+auto LsmTree::LevelCapacity(size_t level) const -> size_t {
+  size_t capacity = memtable_size_;
+  for (size_t i = 0; i < level; i++) {
+    capacity *= size_ratio_;
+  }
+  return capacity;
+}
+
+auto LsmTree::PickCompaction(const Version &version) const -> int {
+  if (version.l0_.size() >= l0_trigger_) {
+    return 0;
+  }
+  for (size_t i = 0; i < version.levels_.size(); i++) {
+    if (version.levels_[i] != nullptr && version.levels_[i]->GetBytes() > LevelCapacity(i + 1)) {
+      return static_cast<int>(i + 1);
+    }
+  }
+  return -1;
+}
+
+auto LsmTree::WriteRun(LsmIterator *iter) const -> std::shared_ptr<const LsmRun> {
+  auto run = std::make_shared<LsmRun>(bpm_, bloom_suffix_size_);
+  for (; !iter->IsEnd(); ++(*iter)) {
+    run->Append(iter->Key(), iter->Deleted());
+  }
+  run->Finish();
+  if (run->GetNumPages() == 0) {
+    return nullptr;
+  }
+  return run;
+}
+
+void LsmTree::BackgroundWork() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    cv_.wait(lock, [this] { return stop_ || immutable_ != nullptr || PickCompaction(*version_) >= 0; });
+    if (stop_) {
+      return;
+    }
+    // 只有这个线程改 run 的列表, 放开锁写 run 的时候 version_ 不会变
+    busy_ = true;
+    auto next = std::make_shared<Version>(*version_);
+
+    if (immutable_ != nullptr) {
+      // 1 冻结的 memtable 写成一个新的 level 0 run, 墓碑留着, 它要盖住下面的旧版本
+      std::vector<std::unique_ptr<LsmCursor>> cursors;
+      cursors.push_back(LsmMemTable::NewCursor(immutable_, ""));
+      lock.unlock();
+      LsmIterator iter(std::move(cursors), std::nullopt, true);
+      auto run = WriteRun(&iter);
+      lock.lock();
+      if (run != nullptr) {
+        next->l0_.insert(next->l0_.begin(), std::move(run));
+      }
+      immutable_.reset();
+    } else {
+      // 2 level 0 的全部 run, 或者超了大小的那一层, 和下一层归并成下一层
+      int level = PickCompaction(*version_);
+      size_t target = level;                                      // 输出层 level + 1 在 levels_[level]
+      std::vector<std::unique_ptr<LsmCursor>> cursors;
+      if (level == 0) {
+        for (const auto &run : version_->l0_) {
+          cursors.push_back(LsmRun::NewCursor(run, ""));
+        }
+      } else {
+        cursors.push_back(LsmRun::NewCursor(version_->levels_[level - 1], ""));
+      }
+      if (target < version_->levels_.size() && version_->levels_[target] != nullptr) {
+        cursors.push_back(LsmRun::NewCursor(version_->levels_[target], ""));
+      }
+      // 输出层下面没有数据了, 墓碑要盖住的东西都在这次归并里, 可以丢掉
+      bool last = std::all_of(version_->levels_.begin() + std::min(target + 1, version_->levels_.size()),
+                              version_->levels_.end(), [](const auto &run) { return run == nullptr; });
+      lock.unlock();
+      LsmIterator iter(std::move(cursors), std::nullopt, !last);
+      auto run = WriteRun(&iter);
+      lock.lock();
+      if (level == 0) {
+        next->l0_.clear();
+      } else {
+        next->levels_[level - 1] = nullptr;
+      }
+      if (next->levels_.size() <= target) {
+        next->levels_.resize(target + 1);
+      }
+      next->levels_[target] = std::move(run);
+    }
+
+    // 旧的 run 没有读者拿着就在这里释放页
+    version_ = std::move(next);
+    busy_ = false;
+    cv_.notify_all();
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,869 @@
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "storage/index/slotted_b_plus_tree.h"
+#include "storage/page/header_page.h"
+
+namespace bustub {
+
+// leaf value 的第一个字节, 区分 posting list 在页内还是在 posting page 链上, 或者是超长 key 的 bucket
+static constexpr char POSTING_INLINE = 0;
+static constexpr char POSTING_OVERFLOW = 1;
+static constexpr char KEY_OVERFLOW = 2;
+static constexpr size_t POSTING_OVERFLOW_SIZE = 1 + sizeof(page_id_t) + sizeof(uint32_t);
+static constexpr size_t KEY_OVERFLOW_SIZE = 1 + sizeof(page_id_t);
+
+static auto RidLess(const RID &a, const RID &b) -> bool { return a.Get() < b.Get(); }
+
+static auto KeyLess(const std::pair<std::string, std::vector<RID>> &entry, std::string_view key) -> bool {
+  return std::string_view(entry.first) < key;
+}
+
+static void DecodeOverflow(std::string_view payload, page_id_t *head, uint32_t *count) {
+  memcpy(head, payload.data() + 1, sizeof(page_id_t));
+  memcpy(count, payload.data() + 1 + sizeof(page_id_t), sizeof(uint32_t));
+}
+
+static auto EncodeOverflow(page_id_t head, uint32_t count) -> std::string {
+  std::string payload(POSTING_OVERFLOW_SIZE, POSTING_OVERFLOW);
+  memcpy(payload.data() + 1, &head, sizeof(page_id_t));
+  memcpy(payload.data() + 1 + sizeof(page_id_t), &count, sizeof(uint32_t));
+  return payload;
+}
+
+/*****************************************************************************
+ * ITERATOR
+ *****************************************************************************/
+SlottedIndexIterator::SlottedIndexIterator(BufferPoolManager *bpm, Page *page, int index)
+    : buffer_pool_manager_(bpm), page_(page), index_(index) {
+  SkipExhaustedLeaves();
+  LoadEntry();
+}
+
+SlottedIndexIterator::SlottedIndexIterator(SlottedIndexIterator &&other) noexcept
+    : buffer_pool_manager_(other.buffer_pool_manager_),
+      page_(other.page_),
+      index_(other.index_),
+      keys_(std::move(other.keys_)),
+      key_index_(other.key_index_),
+      rid_index_(other.rid_index_),
+      item_(std::move(other.item_)) {
+  other.page_ = nullptr;
+}
+
+auto SlottedIndexIterator::operator=(SlottedIndexIterator &&other) noexcept -> SlottedIndexIterator & {
+  if (this != &other) {
+    Release();
+    buffer_pool_manager_ = other.buffer_pool_manager_;
+    page_ = other.page_;
+    index_ = other.index_;
+    keys_ = std::move(other.keys_);
+    key_index_ = other.key_index_;
+    rid_index_ = other.rid_index_;
+    item_ = std::move(other.item_);
+    other.page_ = nullptr;
+  }
+  return *this;
+}
+
+SlottedIndexIterator::~SlottedIndexIterator() { Release(); }
+
+void SlottedIndexIterator::Release() {
+  if (page_ != nullptr) {
+    buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
+    page_ = nullptr;
+  }
+}
+
+/*
+ * 本页读完(或者是空页), 顺着 next 指针找下一个有数据的叶子页
+ */
+void SlottedIndexIterator::SkipExhaustedLeaves() {
+  while (page_ != nullptr && index_ >= Leaf()->GetSize()) {
+    page_id_t next_page_id = Leaf()->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
+    page_ = next_page_id == INVALID_PAGE_ID ? nullptr : buffer_pool_manager_->FetchPage(next_page_id);
+    index_ = 0;
+  }
+}
+
+void SlottedIndexIterator::LoadEntry() {
+  keys_.clear();
+  key_index_ = 0;
+  rid_index_ = 0;
+  if (page_ == nullptr) {
+    return;
+  }
+  SlottedBPlusTree::ReadEntry(buffer_pool_manager_, Leaf()->KeyAt(index_), Leaf()->PayloadAt(index_), &keys_);
+  item_ = {keys_[0].first, keys_[0].second[0]};
+}
+
+auto SlottedIndexIterator::operator*() -> const std::pair<std::string, RID> & {
+  BUSTUB_ASSERT(page_ != nullptr, "dereference end iterator");
+  return item_;
+}
+
+auto SlottedIndexIterator::operator++() -> SlottedIndexIterator & {
+  if (++rid_index_ < keys_[key_index_].second.size()) {  // 同一个 key 的下一个 RID
+    item_.second = keys_[key_index_].second[rid_index_];
+    return *this;
+  }
+  if (++key_index_ < keys_.size()) {  // 同一个 bucket 里的下一个超长 key
+    rid_index_ = 0;
+    item_ = {keys_[key_index_].first, keys_[key_index_].second[0]};
+    return *this;
+  }
+  index_++;
+  SkipExhaustedLeaves();
+  LoadEntry();
+  return *this;
+}
+
+/*****************************************************************************
+ * TREE
+ *****************************************************************************/
+SlottedBPlusTree::SlottedBPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, bool unique)
+    : index_name_(std::move(name)),
+      root_page_id_(INVALID_PAGE_ID),
+      buffer_pool_manager_(buffer_pool_manager),
+      unique_(unique) {}
+
+auto SlottedBPlusTree::IsEmpty() const -> bool { return root_page_id_ == INVALID_PAGE_ID; }
+
+auto SlottedBPlusTree::GetRootPageId() const -> page_id_t { return root_page_id_; }
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+/*
+ * 从 root 向下找到 key 所在的叶子页, 叶子页保持 pin 状态, 由调用者 unpin
+ * path 记录经过的内部节点, 分裂时用来找父节点
+ */
+auto SlottedBPlusTree::FindLeafPage(std::string_view key, bool left_most, std::vector<page_id_t> *path) -> Page * {
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  auto *node = reinterpret_cast<BPlusTreeSlottedPage *>(page->GetData());
+  while (!node->IsLeafPage()) {
+    int index = left_most ? 0 : node->ChildIndex(key);
+    auto child_page_id = static_cast<page_id_t>(node->ValueAt(index));
+    if (path != nullptr) {
+      path->push_back(node->GetPageId());
+    }
+    Page *child_page = buffer_pool_manager_->FetchPage(child_page_id);
+    buffer_pool_manager_->UnpinPage(node->GetPageId(), false);
+    page = child_page;
+    node = reinterpret_cast<BPlusTreeSlottedPage *>(page->GetData());
+  }
+  return page;
+}
+
+auto SlottedBPlusTree::GetValue(std::string_view key, std::vector<RID> *result, Transaction *transaction) -> bool {
+  latch_.RLock();
+  if (IsEmpty()) {
+    latch_.RUnlock();
+    return false;
+  }
+  std::string stored = StoredKey(key);
+  Page *page = FindLeafPage(stored, false, nullptr);
+  auto *leaf = reinterpret_cast<BPlusTreeSlottedPage *>(page->GetData());
+  int index = leaf->LowerBound(stored);
+  bool found = index < leaf->GetSize() && leaf->CompareAt(stored, index) == 0;
+  if (found && key.size() > SLOTTED_PAGE_INLINE_KEY_SIZE) {
+    SlottedKeyEntries entries;
+    LoadKeyBucket(buffer_pool_manager_, leaf->PayloadAt(index), &entries);
+    auto it = std::lower_bound(entries.begin(), entries.end(), key, KeyLess);
+    found = it != entries.end() && it->first == key;
+    if (found) {
+      result->insert(result->end(), it->second.begin(), it->second.end());
+    }
+  } else if (found) {
+    ReadPosting(buffer_pool_manager_, leaf->PayloadAt(index), result);
+  }
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  latch_.RUnlock();
+  return found;
+}
+
+auto SlottedBPlusTree::GetHeight() -> int {
+  latch_.RLock();
+  int height = 0;
+  if (!IsEmpty()) {
+    height = 1;
+    Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+    auto *node = reinterpret_cast<BPlusTreeSlottedPage *>(page->GetData());
+    while (!node->IsLeafPage()) {
+      Page *child_page = buffer_pool_manager_->FetchPage(static_cast<page_id_t>(node->ValueAt(0)));
+      buffer_pool_manager_->UnpinPage(node->GetPageId(), false);
+      node = reinterpret_cast<BPlusTreeSlottedPage *>(child_page->GetData());
+      height++;
+    }
+    buffer_pool_manager_->UnpinPage(node->GetPageId(), false);
+  }
+  latch_.RUnlock();
+  return height;
+}
+
+/*****************************************************************************
+ * POSTING LIST
+ *****************************************************************************/
+auto SlottedBPlusTree::InlinePosting(const std::vector<RID> &rids) -> std::string {
+  std::string payload(1, POSTING_INLINE);
+  BPlusTreePostingPage::Encode(rids, 0, rids.size(), &payload);
+  return payload;
+}
+
+void SlottedBPlusTree::ReadPosting(BufferPoolManager *bpm, std::string_view payload, std::vector<RID> *rids) {
+  if (payload[0] == POSTING_INLINE) {
+    BPlusTreePostingPage::Decode(payload.substr(1), rids);
+    return;
+  }
+  page_id_t page_id;
+  uint32_t count;
+  DecodeOverflow(payload, &page_id, &count);
+  rids->reserve(rids->size() + count);
+  while (page_id != INVALID_PAGE_ID) {
+    auto *posting = reinterpret_cast<BPlusTreePostingPage *>(bpm->FetchPage(page_id)->GetData());
+    posting->Load(rids);
+    page_id_t next_page_id = posting->GetNextPageId();
+    bpm->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+}
+
+/*
+  把 rid 加入 posting list
+  1 页内 list: 解码, 插入, 重新编码; 超过 SLOTTED_PAGE_MAX_VALUE_SIZE 则整个搬到一个新的 posting page
+  2 posting page 链: 找到 rid 所属的页(第一个 last rid >= rid 的页, 或最后一页), 只改写这一页;
+    这一页放不下时一分为二, 新页接在它后面
+*/
+auto SlottedBPlusTree::AddToPosting(std::string *payload, const RID &rid) -> bool {
+  std::vector<RID> rids;
+  if ((*payload)[0] == POSTING_INLINE) {
+    ReadPosting(buffer_pool_manager_, *payload, &rids);
+    auto it = std::lower_bound(rids.begin(), rids.end(), rid, RidLess);
+    if (it != rids.end() && *it == rid) {
+      return false;
+    }
+    rids.insert(it, rid);
+    std::string inline_payload = InlinePosting(rids);
+    if (inline_payload.size() <= SLOTTED_PAGE_MAX_VALUE_SIZE) {
+      *payload = std::move(inline_payload);
+      return true;
+    }
+    page_id_t page_id;
+    auto *posting = reinterpret_cast<BPlusTreePostingPage *>(buffer_pool_manager_->NewPage(&page_id)->GetData());
+    posting->Init(page_id);
+    bool ok = posting->Store(rids, 0, rids.size());
+    BUSTUB_ASSERT(ok, "inline posting list must fit in one posting page");
+    (void)ok;
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    *payload = EncodeOverflow(page_id, rids.size());
+    return true;
+  }
+
+  page_id_t head;
+  uint32_t count;
+  DecodeOverflow(*payload, &head, &count);
+  page_id_t page_id = head;
+  auto *posting = reinterpret_cast<BPlusTreePostingPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+  while (posting->GetNextPageId() != INVALID_PAGE_ID && rid.Get() > posting->GetLastRid()) {
+    page_id_t next_page_id = posting->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+    posting = reinterpret_cast<BPlusTreePostingPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+  }
+  posting->Load(&rids);
+  auto it = std::lower_bound(rids.begin(), rids.end(), rid, RidLess);
+  if (it != rids.end() && *it == rid) {
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    return false;
+  }
+  rids.insert(it, rid);
+  if (!posting->Store(rids, 0, rids.size())) {
+    size_t mid = rids.size() / 2;
+    page_id_t new_page_id;
+    auto *new_posting =
+        reinterpret_cast<BPlusTreePostingPage *>(buffer_pool_manager_->NewPage(&new_page_id)->GetData());
+    new_posting->Init(new_page_id);
+    new_posting->Store(rids, mid, rids.size());
+    new_posting->SetNextPageId(posting->GetNextPageId());
+    posting->Store(rids, 0, mid);
+    posting->SetNextPageId(new_page_id);
+    buffer_pool_manager_->UnpinPage(new_page_id, true);
+  }
+  buffer_pool_manager_->UnpinPage(page_id, true);
+  *payload = EncodeOverflow(head, count + 1);
+  return true;
+}
+
+/*
+  把 rid 从 posting list 删除
+  posting page 链上某页删空了就从链上摘掉; 只剩一页并且足够小时搬回页内
+*/
+auto SlottedBPlusTree::RemoveFromPosting(std::string *payload, const RID &rid) -> bool {
+  std::vector<RID> rids;
+  if ((*payload)[0] == POSTING_INLINE) {
+    ReadPosting(buffer_pool_manager_, *payload, &rids);
+    auto it = std::lower_bound(rids.begin(), rids.end(), rid, RidLess);
+    if (it == rids.end() || !(*it == rid)) {
+      return false;
+    }
+    rids.erase(it);
+    *payload = rids.empty() ? std::string() : InlinePosting(rids);
+    return true;
+  }
+
+  page_id_t head;
+  uint32_t count;
+  DecodeOverflow(*payload, &head, &count);
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  page_id_t page_id = head;
+  auto *posting = reinterpret_cast<BPlusTreePostingPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+  while (posting->GetNextPageId() != INVALID_PAGE_ID && rid.Get() > posting->GetLastRid()) {
+    page_id_t next_page_id = posting->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    prev_page_id = page_id;
+    page_id = next_page_id;
+    posting = reinterpret_cast<BPlusTreePostingPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+  }
+  posting->Load(&rids);
+  auto it = std::lower_bound(rids.begin(), rids.end(), rid, RidLess);
+  if (it == rids.end() || !(*it == rid)) {
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    return false;
+  }
+  rids.erase(it);
+  count--;
+
+  if (!rids.empty()) {
+    posting->Store(rids, 0, rids.size());
+    buffer_pool_manager_->UnpinPage(page_id, true);
+  } else {
+    page_id_t next_page_id = posting->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+    if (prev_page_id == INVALID_PAGE_ID) {
+      head = next_page_id;
+    } else {
+      auto *prev = reinterpret_cast<BPlusTreePostingPage *>(buffer_pool_manager_->FetchPage(prev_page_id)->GetData());
+      prev->SetNextPageId(next_page_id);
+      buffer_pool_manager_->UnpinPage(prev_page_id, true);
+    }
+  }
+  if (count == 0) {
+    payload->clear();
+    return true;
+  }
+
+  // 只剩一页, 并且编码后不到页内上限的一半(避免在边界上来回搬), 搬回页内
+  auto *first = reinterpret_cast<BPlusTreePostingPage *>(buffer_pool_manager_->FetchPage(head)->GetData());
+  bool collapse = first->GetNextPageId() == INVALID_PAGE_ID;
+  std::string inline_payload;
+  if (collapse) {
+    rids.clear();
+    first->Load(&rids);
+    inline_payload = InlinePosting(rids);
+    collapse = inline_payload.size() <= SLOTTED_PAGE_MAX_VALUE_SIZE / 2;
+  }
+  buffer_pool_manager_->UnpinPage(head, false);
+  if (collapse) {
+    buffer_pool_manager_->DeletePage(head);
+    *payload = std::move(inline_payload);
+  } else {
+    *payload = EncodeOverflow(head, count);
+  }
+  return true;
+}
+
+void SlottedBPlusTree::FreePosting(std::string_view payload) {
+  if (payload[0] == POSTING_INLINE) {
+    return;
+  }
+  if (payload[0] == KEY_OVERFLOW) {
+    page_id_t page_id;
+    memcpy(&page_id, payload.data() + 1, sizeof(page_id_t));
+    while (page_id != INVALID_PAGE_ID) {
+      auto *overflow =
+          reinterpret_cast<BPlusTreeKeyOverflowPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+      page_id_t next_page_id = overflow->GetNextPageId();
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      buffer_pool_manager_->DeletePage(page_id);
+      page_id = next_page_id;
+    }
+    return;
+  }
+  page_id_t page_id;
+  uint32_t count;
+  DecodeOverflow(payload, &page_id, &count);
+  while (page_id != INVALID_PAGE_ID) {
+    auto *posting = reinterpret_cast<BPlusTreePostingPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+    page_id_t next_page_id = posting->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+}
+
+/*****************************************************************************
+ * OVERSIZED KEYS
+ *****************************************************************************/
+auto SlottedBPlusTree::StoredKey(std::string_view key) -> std::string {
+  if (key.size() <= SLOTTED_PAGE_INLINE_KEY_SIZE) {
+    return std::string(key);
+  }
+  // 截断后补一个 0xFF: 比所有以这个前缀开头的短 key 都大, 和其它 key 的相对顺序不变
+  std::string stored(key.substr(0, SLOTTED_PAGE_INLINE_KEY_SIZE));
+  stored.push_back(static_cast<char>(0xFF));
+  return stored;
+}
+
+void SlottedBPlusTree::ReadEntry(BufferPoolManager *bpm, std::string_view key, std::string_view payload,
+                                 SlottedKeyEntries *entries) {
+  if (payload[0] == KEY_OVERFLOW) {
+    LoadKeyBucket(bpm, payload, entries);
+    return;
+  }
+  entries->emplace_back(std::string(key), std::vector<RID>());
+  ReadPosting(bpm, payload, &entries->back().second);
+}
+
+void SlottedBPlusTree::LoadKeyBucket(BufferPoolManager *bpm, std::string_view payload, SlottedKeyEntries *entries) {
+  if (payload.empty()) {
+    return;
+  }
+  page_id_t page_id;
+  memcpy(&page_id, payload.data() + 1, sizeof(page_id_t));
+  std::string bytes;
+  while (page_id != INVALID_PAGE_ID) {
+    auto *overflow = reinterpret_cast<BPlusTreeKeyOverflowPage *>(bpm->FetchPage(page_id)->GetData());
+    overflow->Load(&bytes);
+    page_id_t next_page_id = overflow->GetNextPageId();
+    bpm->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+
+  std::string_view rest(bytes);
+  while (!rest.empty()) {
+    uint32_t key_len;
+    uint32_t rids_len;
+    memcpy(&key_len, rest.data(), sizeof(uint32_t));
+    rest.remove_prefix(sizeof(uint32_t));
+    entries->emplace_back(std::string(rest.substr(0, key_len)), std::vector<RID>());
+    rest.remove_prefix(key_len);
+    memcpy(&rids_len, rest.data(), sizeof(uint32_t));
+    rest.remove_prefix(sizeof(uint32_t));
+    BPlusTreePostingPage::Decode(rest.substr(0, rids_len), &entries->back().second);
+    rest.remove_prefix(rids_len);
+  }
+}
+
+/*
+  把 bucket 整体重新写回 key overflow page 链
+  超长 key 很少, 一个 bucket 通常只有一两页, 每次修改都整体改写; 旧链上的页按顺序复用, 不够再申请, 多出来的删除
+*/
+void SlottedBPlusTree::StoreKeyBucket(const SlottedKeyEntries &entries, std::string *payload) {
+  if (entries.empty()) {
+    if (!payload->empty()) {
+      FreePosting(*payload);
+    }
+    payload->clear();
+    return;
+  }
+  std::string bytes;
+  for (const auto &[key, rids] : entries) {
+    auto key_len = static_cast<uint32_t>(key.size());
+    bytes.append(reinterpret_cast<const char *>(&key_len), sizeof(uint32_t));
+    bytes.append(key);
+    std::string encoded;
+    BPlusTreePostingPage::Encode(rids, 0, rids.size(), &encoded);
+    auto rids_len = static_cast<uint32_t>(encoded.size());
+    bytes.append(reinterpret_cast<const char *>(&rids_len), sizeof(uint32_t));
+    bytes.append(encoded);
+  }
+
+  std::vector<page_id_t> pages;
+  if (!payload->empty()) {
+    page_id_t page_id;
+    memcpy(&page_id, payload->data() + 1, sizeof(page_id_t));
+    while (page_id != INVALID_PAGE_ID) {
+      pages.push_back(page_id);
+      auto *overflow =
+          reinterpret_cast<BPlusTreeKeyOverflowPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+      page_id_t next_page_id = overflow->GetNextPageId();
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      page_id = next_page_id;
+    }
+  }
+  size_t page_count = (bytes.size() + KEY_OVERFLOW_PAGE_DATA_SIZE - 1) / KEY_OVERFLOW_PAGE_DATA_SIZE;
+  for (size_t i = page_count; i < pages.size(); i++) {
+    buffer_pool_manager_->DeletePage(pages[i]);
+  }
+  pages.resize(page_count, INVALID_PAGE_ID);
+  for (auto &page_id : pages) {
+    if (page_id == INVALID_PAGE_ID) {
+      buffer_pool_manager_->NewPage(&page_id);
+      buffer_pool_manager_->UnpinPage(page_id, true);
+    }
+  }
+
+  std::string_view rest(bytes);
+  for (size_t i = 0; i < pages.size(); i++) {
+    auto *overflow = reinterpret_cast<BPlusTreeKeyOverflowPage *>(buffer_pool_manager_->FetchPage(pages[i])->GetData());
+    overflow->Init(pages[i]);
+    overflow->SetNextPageId(i + 1 < pages.size() ? pages[i + 1] : INVALID_PAGE_ID);
+    rest.remove_prefix(overflow->Store(rest));
+    buffer_pool_manager_->UnpinPage(pages[i], true);
+  }
+
+  payload->assign(KEY_OVERFLOW_SIZE, KEY_OVERFLOW);
+  memcpy(payload->data() + 1, &pages[0], sizeof(page_id_t));
+}
+
+auto SlottedBPlusTree::AddToKeyBucket(std::string *payload, std::string_view key, const RID &rid) -> bool {
+  SlottedKeyEntries entries;
+  LoadKeyBucket(buffer_pool_manager_, *payload, &entries);
+  auto it = std::lower_bound(entries.begin(), entries.end(), key, KeyLess);
+  if (it != entries.end() && it->first == key) {
+    if (unique_) {
+      return false;
+    }
+    auto pos = std::lower_bound(it->second.begin(), it->second.end(), rid, RidLess);
+    if (pos != it->second.end() && *pos == rid) {
+      return false;
+    }
+    it->second.insert(pos, rid);
+  } else {
+    entries.insert(it, {std::string(key), {rid}});
+  }
+  StoreKeyBucket(entries, payload);
+  return true;
+}
+
+auto SlottedBPlusTree::RemoveFromKeyBucket(std::string *payload, std::string_view key, const RID *rid) -> bool {
+  SlottedKeyEntries entries;
+  LoadKeyBucket(buffer_pool_manager_, *payload, &entries);
+  auto it = std::lower_bound(entries.begin(), entries.end(), key, KeyLess);
+  if (it == entries.end() || it->first != key) {
+    return false;
+  }
+  if (rid != nullptr) {
+    auto pos = std::lower_bound(it->second.begin(), it->second.end(), *rid, RidLess);
+    if (pos == it->second.end() || !(*pos == *rid)) {
+      return false;
+    }
+    it->second.erase(pos);
+  }
+  if (rid == nullptr || it->second.empty()) {
+    entries.erase(it);
+  }
+  StoreKeyBucket(entries, payload);
+  return true;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+/*
+ * 插入 key:val 对
+ * 1 如果当前树为空, 新建叶子页作为 root
+ * 2 否则找到叶子页: key 已存在则把 val 加入它的 posting list (唯一索引直接失败), 不存在则插入新 entry
+ * 3 叶子页空间不足则分裂
+ * 超长 key 以截断后的形式参与上面的过程, val 加入它所在 bucket 里完整 key 的 RID 列表
+ */
+auto SlottedBPlusTree::Insert(std::string_view key, const RID &value, Transaction *transaction) -> bool {
+  bool oversized = key.size() > SLOTTED_PAGE_INLINE_KEY_SIZE;
+  std::string stored = StoredKey(key);
+  latch_.WLock();
+  if (IsEmpty()) {
+    page_id_t new_page_id;
+    Page *page = buffer_pool_manager_->NewPage(&new_page_id);
+    auto *leaf = reinterpret_cast<BPlusTreeSlottedPage *>(page->GetData());
+    leaf->Init(new_page_id, IndexPageType::LEAF_PAGE, "", "", true);
+    std::string payload;
+    if (oversized) {
+      AddToKeyBucket(&payload, key, value);
+    } else {
+      payload = InlinePosting({value});
+    }
+    leaf->Append(stored, payload);
+    root_page_id_ = new_page_id;
+    UpdateRootPageId(1);
+    buffer_pool_manager_->UnpinPage(new_page_id, true);
+    latch_.WUnlock();
+    return true;
+  }
+
+  std::vector<page_id_t> path;
+  Page *page = FindLeafPage(stored, false, &path);
+  auto *leaf = reinterpret_cast<BPlusTreeSlottedPage *>(page->GetData());
+  int index = leaf->LowerBound(stored);
+  bool exists = index < leaf->GetSize() && leaf->CompareAt(stored, index) == 0;
+  std::string payload;
+  bool fits;
+  if (exists) {
+    payload = leaf->PayloadAt(index);
+    bool added = oversized ? AddToKeyBucket(&payload, key, value) : !unique_ && AddToPosting(&payload, value);
+    if (!added) {
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      latch_.WUnlock();
+      return false;
+    }
+    fits = leaf->SetPayloadAt(index, payload);
+  } else {
+    if (oversized) {
+      AddToKeyBucket(&payload, key, value);
+    } else {
+      payload = InlinePosting({value});
+    }
+    fits = leaf->InsertAt(index, stored, payload);
+  }
+  if (!fits) {
+    std::vector<std::pair<std::string, std::string>> entries;
+    leaf->CopyEntries(&entries);
+    if (exists) {
+      entries[index].second = payload;
+    } else {
+      entries.insert(entries.begin() + index, {stored, payload});
+    }
+    SplitLeafNode(leaf, entries, &path);
+  }
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  latch_.WUnlock();
+  return true;
+}
+
+auto SlottedBPlusTree::SplitPoint(const std::vector<size_t> &entry_sizes) -> size_t {
+  size_t total = 0;
+  for (auto size : entry_sizes) {
+    total += size;
+  }
+  size_t acc = 0;
+  size_t mid = 0;
+  while (mid < entry_sizes.size() && acc * 2 < total) {
+    acc += entry_sizes[mid];
+    mid++;
+  }
+  return std::clamp<size_t>(mid, 1, entry_sizes.size() - 1);
+}
+
+/*
+  分裂叶子节点
+  1 entries 是本页所有 entry 加上这次放不下的修改
+  2 按字节数平分, 左边留在本页, 右边放到新页
+  3 分隔 key 做后缀截断: 取能区分左页最大 key 和右页最小 key 的最短前缀
+  4 分隔 key 同时作为左页的上界和右页的下界, 两页各自的公共前缀只会变长
+*/
+void SlottedBPlusTree::SplitLeafNode(BPlusTreeSlottedPage *leaf,
+                                     const std::vector<std::pair<std::string, std::string>> &entries,
+                                     std::vector<page_id_t> *path) {
+  std::string lower(leaf->GetLowerFence());
+  std::string upper(leaf->GetUpperFence());
+  bool upper_is_infinity = leaf->IsUpperInfinity();
+  std::vector<size_t> entry_sizes;
+  for (const auto &entry : entries) {
+    entry_sizes.push_back(leaf->EntrySize(entry.first, entry.second.size()));
+  }
+  size_t mid = SplitPoint(entry_sizes);
+  std::string separator = BPlusTreeSlottedPage::ShortestSeparator(entries[mid - 1].first, entries[mid].first);
+
+  page_id_t right_page_id;
+  Page *right_page = buffer_pool_manager_->NewPage(&right_page_id);
+  auto *right = reinterpret_cast<BPlusTreeSlottedPage *>(right_page->GetData());
+  page_id_t next_page_id = leaf->GetNextPageId();
+
+  leaf->Init(leaf->GetPageId(), IndexPageType::LEAF_PAGE, lower, separator, false);
+  leaf->SetNextPageId(right_page_id);
+  right->Init(right_page_id, IndexPageType::LEAF_PAGE, separator, upper, upper_is_infinity);
+  right->SetNextPageId(next_page_id);
+  for (size_t i = 0; i < entries.size(); i++) {
+    (i < mid ? leaf : right)->Append(entries[i].first, entries[i].second);
+  }
+  buffer_pool_manager_->UnpinPage(right_page_id, true);
+
+  InsertIntoParent(leaf->GetPageId(), separator, right_page_id, path);
+}
+
+/*
+  把 separator -> right_id 插入父节点
+  1 没有父节点, 即 left 是 root, 新建 root
+  2 父节点空间足够, 直接插入
+  3 否则分裂父节点, 中间的 key 上移, 递归
+*/
+void SlottedBPlusTree::InsertIntoParent(page_id_t left_id, const std::string &separator, page_id_t right_id,
+                                        std::vector<page_id_t> *path) {
+  if (path->empty()) {
+    page_id_t root_id;
+    Page *page = buffer_pool_manager_->NewPage(&root_id);
+    auto *root = reinterpret_cast<BPlusTreeSlottedPage *>(page->GetData());
+    root->Init(root_id, IndexPageType::INTERNAL_PAGE, "", "", true);
+    root->Append("", left_id);
+    root->Append(separator, right_id);
+    root_page_id_ = root_id;
+    UpdateRootPageId(0);
+    buffer_pool_manager_->UnpinPage(root_id, true);
+    return;
+  }
+
+  page_id_t parent_id = path->back();
+  path->pop_back();
+  Page *page = buffer_pool_manager_->FetchPage(parent_id);
+  auto *parent = reinterpret_cast<BPlusTreeSlottedPage *>(page->GetData());
+  int index = parent->ChildIndex(separator) + 1;  // left 原来的范围包含 separator, 插在 left 后面
+  if (parent->InsertAt(index, separator, right_id)) {
+    buffer_pool_manager_->UnpinPage(parent_id, true);
+    return;
+  }
+
+  std::vector<std::pair<std::string, int64_t>> entries;
+  parent->CopyEntries(&entries);
+  entries.insert(entries.begin() + index, {separator, right_id});
+  std::string lower(parent->GetLowerFence());
+  std::string upper(parent->GetUpperFence());
+  bool upper_is_infinity = parent->IsUpperInfinity();
+  std::vector<size_t> entry_sizes;
+  for (const auto &entry : entries) {
+    entry_sizes.push_back(parent->EntrySize(entry.first));
+  }
+  size_t mid = SplitPoint(entry_sizes);
+  std::string push_up = entries[mid].first;  // 内部节点分裂, 中间 key 上移, 其子节点成为右页的 [0]
+
+  page_id_t new_page_id;
+  Page *new_page = buffer_pool_manager_->NewPage(&new_page_id);
+  auto *new_internal = reinterpret_cast<BPlusTreeSlottedPage *>(new_page->GetData());
+  parent->Init(parent_id, IndexPageType::INTERNAL_PAGE, lower, push_up, false);
+  new_internal->Init(new_page_id, IndexPageType::INTERNAL_PAGE, push_up, upper, upper_is_infinity);
+  for (size_t i = 0; i < entries.size(); i++) {
+    (i < mid ? parent : new_internal)->Append(entries[i].first, entries[i].second);
+  }
+  buffer_pool_manager_->UnpinPage(parent_id, true);
+  buffer_pool_manager_->UnpinPage(new_page_id, true);
+
+  InsertIntoParent(parent_id, push_up, new_page_id, path);
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+/*
+ * 删除 key 及其所有 RID, 不做合并; 删除留下的空间在下一次插入空间不足时整理回收
+ */
+void SlottedBPlusTree::Remove(std::string_view key, Transaction *transaction) {
+  latch_.WLock();
+  if (IsEmpty()) {
+    latch_.WUnlock();
+    return;
+  }
+  std::string stored = StoredKey(key);
+  Page *page = FindLeafPage(stored, false, nullptr);
+  auto *leaf = reinterpret_cast<BPlusTreeSlottedPage *>(page->GetData());
+  int index = leaf->LowerBound(stored);
+  bool found = index < leaf->GetSize() && leaf->CompareAt(stored, index) == 0;
+  if (found && key.size() > SLOTTED_PAGE_INLINE_KEY_SIZE) {
+    // 只删除 bucket 里的这一个完整 key, bucket 的 value 长度不变
+    std::string payload(leaf->PayloadAt(index));
+    found = RemoveFromKeyBucket(&payload, key, nullptr);
+    if (found && payload.empty()) {
+      leaf->RemoveAt(index);
+    } else if (found) {
+      leaf->SetPayloadAt(index, payload);
+    }
+  } else if (found) {
+    FreePosting(leaf->PayloadAt(index));
+    leaf->RemoveAt(index);
+  }
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), found);
+  latch_.WUnlock();
+}
+
+/*
+ * 从 key 的 posting list 中删除一个 RID, list 删空了再删除 key
+ */
+auto SlottedBPlusTree::Remove(std::string_view key, const RID &value, Transaction *transaction) -> bool {
+  latch_.WLock();
+  if (IsEmpty()) {
+    latch_.WUnlock();
+    return false;
+  }
+  std::string stored = StoredKey(key);
+  std::vector<page_id_t> path;
+  Page *page = FindLeafPage(stored, false, &path);
+  auto *leaf = reinterpret_cast<BPlusTreeSlottedPage *>(page->GetData());
+  int index = leaf->LowerBound(stored);
+  std::string payload;
+  bool found = index < leaf->GetSize() && leaf->CompareAt(stored, index) == 0;
+  if (found) {
+    payload = leaf->PayloadAt(index);
+    found = key.size() > SLOTTED_PAGE_INLINE_KEY_SIZE ? RemoveFromKeyBucket(&payload, key, &value)
+                                                      : RemoveFromPosting(&payload, value);
+  }
+  if (found) {
+    if (payload.empty()) {
+      leaf->RemoveAt(index);
+    } else if (!leaf->SetPayloadAt(index, payload)) {
+      // posting list 从 posting page 搬回页内时会比原来的 value 长, 叶子页可能放不下
+      std::vector<std::pair<std::string, std::string>> entries;
+      leaf->CopyEntries(&entries);
+      entries[index].second = payload;
+      SplitLeafNode(leaf, entries, &path);
+    }
+  }
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), found);
+  latch_.WUnlock();
+  return found;
+}
+
+/*****************************************************************************
+ * INDEX ITERATOR
+ *****************************************************************************/
+auto SlottedBPlusTree::Begin() -> SlottedIndexIterator {
+  latch_.RLock();
+  if (IsEmpty()) {
+    latch_.RUnlock();
+    return End();
+  }
+  Page *page = FindLeafPage("", true, nullptr);
+  SlottedIndexIterator iterator(buffer_pool_manager_, page, 0);
+  latch_.RUnlock();
+  return iterator;
+}
+
+auto SlottedBPlusTree::Begin(std::string_view key) -> SlottedIndexIterator {
+  latch_.RLock();
+  if (IsEmpty()) {
+    latch_.RUnlock();
+    return End();
+  }
+  std::string stored = StoredKey(key);
+  Page *page = FindLeafPage(stored, false, nullptr);
+  int index = reinterpret_cast<BPlusTreeSlottedPage *>(page->GetData())->LowerBound(stored);
+  SlottedIndexIterator iterator(buffer_pool_manager_, page, index);
+  // 超长 key 落在 bucket 上, 跳过 bucket 里比它小的完整 key
+  while (!iterator.IsEnd() && std::string_view((*iterator).first) < key) {
+    ++iterator;
+  }
+  latch_.RUnlock();
+  return iterator;
+}
+
+auto SlottedBPlusTree::End() -> SlottedIndexIterator { return {}; }
+
+/*****************************************************************************
+ * UTILITIES AND DEBUG
+ *****************************************************************************/
+/*
+ * Update/Insert root page id in header page(where page_id = 0, header_page is
+ * defined under include/page/header_page.h)
+ */
+void SlottedBPlusTree::UpdateRootPageId(int insert_record) {
+  auto *header_page = reinterpret_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+  if (insert_record != 0) {
+    header_page->InsertRecord(index_name_, root_page_id_);
+  } else {
+    header_page->UpdateRecord(index_name_, root_page_id_);
+  }
+  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
+}
+
+}  // namespace bustub
@@ -0,0 +1,48 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// slotted_b_plus_tree_index.cpp
+//
+// Identification: src/storage/index/slotted_b_plus_tree_index.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/slotted_b_plus_tree_index.h"
+#include "storage/index/key_encoder.h"
+
+namespace bustub {
+/*
+ * Constructor
+ */
+SlottedBPlusTreeIndex::SlottedBPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata,
+                                             BufferPoolManager *buffer_pool_manager, bool unique)
+    : Index(std::move(metadata)), container_(GetMetadata()->GetName(), buffer_pool_manager, unique) {}
+
+auto SlottedBPlusTreeIndex::EncodeKey(const Tuple &key) const -> std::string {
+  return KeyEncoder::Encode(key, GetMetadata()->GetKeySchema());
+}
+
+void SlottedBPlusTreeIndex::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  container_.Insert(EncodeKey(key), rid, transaction);
+}
+
+void SlottedBPlusTreeIndex::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  container_.Remove(EncodeKey(key), rid, transaction);
+}
+
+void SlottedBPlusTreeIndex::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
+  container_.GetValue(EncodeKey(key), result, transaction);
+}
+
+auto SlottedBPlusTreeIndex::GetBeginIterator() -> SlottedIndexIterator { return container_.Begin(); }
+
+auto SlottedBPlusTreeIndex::GetBeginIterator(const Tuple &key) -> SlottedIndexIterator {
+  return container_.Begin(EncodeKey(key));
+}
+
+auto SlottedBPlusTreeIndex::GetEndIterator() -> SlottedIndexIterator { return container_.End(); }
+
+}  // namespace bustub
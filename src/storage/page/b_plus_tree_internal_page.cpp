@@ -13,6 +13,7 @@
 #include <sstream>
 
 #include "common/exception.h"
+#include "storage/index/node_search.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 
 namespace bustub {
@@ -42,7 +43,7 @@ INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const -> KeyType {
   // replace with your own code
   if (index < this->GetSize()) {
-    MappingType mt = this->array_[index];
+    MappingType mt = this->array_[this->SlotAt(index)];
     return mt.first;
   }
   KeyType key{};
@@ -57,7 +58,7 @@ INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType {
   // replace with your own code
   if (index < this->GetSize()) {
-    MappingType mt = this->array_[index];
+    MappingType mt = this->array_[this->SlotAt(index)];
     return mt.second;
   }
   ValueType val{};
@@ -68,12 +69,13 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType {
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ItemAt(int index) const -> const MappingType & {
   // replace with your own code{
-    return this->array_[index];
+    return this->array_[this->SlotAt(index)];
 }
 
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
+  this->ToSortedLayout();
     if (index < this->GetSize()) {
       MappingType &mt = this->array_[index];
       mt.first = key;
@@ -100,13 +102,32 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
 */
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::IndexofInsert(KeyType key, KeyComparator &comparator) -> int {   // 返回的是我要插入的位置
-  int i = 1;
-  for ( i = 1; i < this->GetSize(); i++) {
-    if(comparator(key, this->array_[i].first) <= 0) {     // 找这么一个 key, 此 key 第一次大于 入参 key; 找第一个大于入参 key 的 key
-      break;
-    }
+  this->ToSortedLayout();
+  return NodeSearch::LowerBound(this->array_, 1, this->GetSize(), key, comparator);
+}
+
+/*
+  返回 key 所在子节点的 index: 最后一个 K(i) <= key 的 i, [0] 没有 key, 所以至少返回 0
+         K(1)   K(2)   K(3)
+  [0]    [1]    [2]    [3]
+*/
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ChildIndexByKey(const KeyType &key, const KeyComparator &kcomparator) const
+    -> int {
+  if (this->IsEytzingerLayout()) {
+    int slot = this->ChildSlotByKey(key, kcomparator);
+    return slot == 0 ? 0 : NodeSearch::EytzingerRank(slot, this->GetSize() - 1);
   }
-  return i;
+  return NodeSearch::UpperBound(this->array_, 1, this->GetSize(), key, kcomparator) - 1;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ChildSlotByKey(const KeyType &key, const KeyComparator &kcomparator) const
+    -> int {
+  if (this->IsEytzingerLayout()) {
+    return NodeSearch::EytzingerLastNotAfter(this->array_, this->GetSize() - 1, key, kcomparator);
+  }
+  return NodeSearch::UpperBound(this->array_, 1, this->GetSize(), key, kcomparator) - 1;
 }
 
 /**
@@ -118,8 +139,9 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::IndexofInsert(KeyType key, KeyComparator &c
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::IndexByVal(ValueType val) -> int {
+  this->ToSortedLayout();
   int i = 0;
-  for ( i = 1; i < this->GetSize(); i++) {
+  for ( i = 0; i < this->GetSize(); i++) {  // 从 [0] 找起, 最左孩子返回 0
     if(this->array_[i].second == val) {     // 找这么一个 key, 此 key 第一次大于 入参 key; 找第一个大于入参 key 的 key
       return i;
     }
@@ -136,12 +158,13 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::IndexByVal(ValueType val) -> int {
 */
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::Insert(KeyType key, ValueType value, KeyComparator &kcomparator) ->int {
+  this->ToSortedLayout();
   int index = this->IndexofInsert(key, kcomparator);
-  if (kcomparator(this->array_[index].first, key) == 0) {
+  if (index < this->GetSize() && kcomparator(this->array_[index].first, key) == 0) {
     return -1;
   }
-  for (int i = this->GetSize(); i >= index; i--) {
-    this->array_[i] = this->array_[i+1];
+  for (int i = this->GetSize(); i > index; i--) {     // [index, size) 整体右移一位
+    this->array_[i] = this->array_[i-1];
   }
   this->array_[index] = MappingType(key, value);
   this->IncreaseSize();
@@ -156,6 +179,7 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::Insert(KeyType key, ValueType value, KeyCom
 
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::Indexof(KeyType key, KeyComparator &kcomparator) -> int {   // 返回的是我要插入的位置
+  this->ToSortedLayout();
   int i = 1;
   for ( i = 1; i < this->GetSize(); i++) {
     if(kcomparator(key, this->array_[i].first) == 0) {     // 找这么一个 key, 此 key 第一次大于 入参 key; 找第一个大于入参 key 的 key
@@ -176,6 +200,7 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::Indexof(KeyType key, KeyComparator &kcompar
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertElemLast(MappingType elem) {
+  this->ToSortedLayout();
   int id = this->GetSize();
   this->array_[id] = elem;
   this->IncreaseSize();
@@ -189,6 +214,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertElemLast(MappingType elem) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveOutRightHalf(BPlusTreeInternalPage *to)   {
+  this->ToSortedLayout();
   int count = this->GetSize() / 2;
   int midId = this->GetSize() - count;  // 10 个元素, 最大 index=9, mid=5, 共5个. 
   to->MoveInLeftHalf(this->array_, midId, count);
@@ -212,13 +238,8 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveInLeftHalf(MappingType *array, int star
 
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::IndexByKey(KeyType key, KeyComparator &kcomparator) -> int {
-  int i = 0;
-  for ( i = 1; i < this->GetSize(); i++) {
-    if(kcomparator(key, this->array_[i].first) <= 0) {     // 找这么一个 key, 此 key 第一次大于 入参 key; 找第一个大于入参 key 的 key
-      break;
-    }
-  }
-  return i;
+  this->ToSortedLayout();
+  return NodeSearch::LowerBound(this->array_, 1, this->GetSize(), key, kcomparator);
 }
 
 /*
@@ -228,6 +249,7 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::IndexByKey(KeyType key, KeyComparator &kcom
 */
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(KeyType key, KeyComparator &kcomparator) -> int {
+  this->ToSortedLayout();
   int index = this->IndexByKey(key, kcomparator);
   if (index == -1) {
     return -1;
@@ -251,6 +273,7 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(KeyType key, KeyComparator &kcompara
 */
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveByIndex(int index) -> int {
+  this->ToSortedLayout();
   if (index >= this->GetSize()) {
     return -1;
   }
@@ -272,6 +295,7 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveByIndex(int index) -> int {
 */
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveFisrtNullKey() -> int {
+  this->ToSortedLayout();
 
   int index = 0;
   // 删除 index 处元素
@@ -290,10 +314,11 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveFisrtNullKey() -> int {
 */
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertFisrtNullKey(ValueType value) -> int {
+  this->ToSortedLayout();
   int index = 0;
 
-  for (int i = this->GetSize(); i >= index; i--) {
-    this->array_[i] = this->array_[i+1];
+  for (int i = this->GetSize(); i > index; i--) {
+    this->array_[i] = this->array_[i-1];
   }
   this->array_[index] = MappingType(KeyType{}, value);
   this->IncreaseSize();
@@ -316,6 +341,7 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetFisrtNullKey(ValueType value) -> int {
 }
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyByIndex(KeyType key, int index) {
+  this->ToSortedLayout();
   // 校验 index
   this->array_[index].first = key;
   return;
@@ -336,6 +362,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyByIndex(KeyType key, int index) {
 */
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetLastSmallerKey(KeyType key, int &index, KeyType &rtkey, KeyComparator &kcomparator) -> int {
+  this->ToSortedLayout();
   int id = 0;
   for (int i = 1; i < this->GetSize(); i++) {
     if(kcomparator(this->array_[i].first, key) <= 0) {
@@ -354,6 +381,42 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetLastSmallerKey(KeyType key, int &index,
   return 1;
 }
 
+/*
+  [1, size) 换成 Eytzinger 顺序, [0] 不动; 页类型记录当前布局
+*/
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::ToEytzingerLayout() {
+  if (!this->IsEytzingerLayout()) {
+    NodeSearch::ToEytzinger(this->array_, this->GetSize() - 1);
+    this->SetPageType(IndexPageType::EYTZINGER_INTERNAL_PAGE);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::ToSortedLayout() {
+  if (this->IsEytzingerLayout()) {
+    NodeSearch::FromEytzinger(this->array_, this->GetSize() - 1);
+    this->SetPageType(IndexPageType::INVALID_INDEX_PAGE);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsEytzingerLayout() const -> bool {
+  return this->GetPageType() == IndexPageType::EYTZINGER_INTERNAL_PAGE;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::SlotAt(int index) const -> int {
+  if (index == 0 || !this->IsEytzingerLayout()) {
+    return index;
+  }
+  return NodeSearch::EytzingerPosition(index, this->GetSize() - 1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAtSlot(int slot) const -> ValueType {
+  return this->array_[slot].second;
+}
 
 // valuetype for internalNode should be page id_t
 template class BPlusTreeInternalPage<GenericKey<4>, page_id_t, GenericComparator<4>>;
@@ -0,0 +1,36 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/page/b_plus_tree_key_overflow_page.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstring>
+
+#include "storage/page/b_plus_tree_key_overflow_page.h"
+
+namespace bustub {
+
+void BPlusTreeKeyOverflowPage::Init(page_id_t page_id) {
+  this->page_id_ = page_id;
+  this->next_page_id_ = INVALID_PAGE_ID;
+  this->data_len_ = 0;
+}
+
+void BPlusTreeKeyOverflowPage::Load(std::string *out) const {
+  out->append(Data(), static_cast<size_t>(this->data_len_));
+}
+
+auto BPlusTreeKeyOverflowPage::Store(std::string_view data) -> size_t {
+  size_t len = std::min<size_t>(data.size(), KEY_OVERFLOW_PAGE_DATA_SIZE);
+  memcpy(Data(), data.data(), len);
+  this->data_len_ = static_cast<int32_t>(len);
+  return len;
+}
+
+}  // namespace bustub
@@ -13,6 +13,7 @@
 
 #include "common/exception.h"
 #include "common/rid.h"
+#include "storage/index/node_search.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
@@ -31,6 +32,7 @@ INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
   this->SetPageId(page_id);
   this->SetNextPageId(INVALID_PAGE_ID);
+  this->SetPrevPageId(INVALID_PAGE_ID);
   this->SetParentPageId(parent_id);
 
   this->SetMaxSize(max_size);
@@ -51,6 +53,16 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) {
   this->next_page_id_ = next_page_id;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetPrevPageId() const -> page_id_t {
+  return this->prev_page_id_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetPrevPageId(page_id_t prev_page_id) {
+  this->prev_page_id_ = prev_page_id;
+}
+
 /*
  * Helper method to find and return the key associated with input "index"(a.k.a
  * array offset)
@@ -101,20 +113,21 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveInLeftHalf(MappingType *array, int start, i
  
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_LEAF_PAGE_TYPE::IndexByKey(KeyType key, KeyComparator &kcomparator) -> int {
-  int i = 0;
-  for ( i = 0; i < this->GetSize(); i++) {
-    if(kcomparator(key, this->array_[i].first) <= 0) {     // 找这么一个 key, 此 key 第一次大于 入参 key; 找第一个大于入参 key 的 key
-      break;
-    }
-  }
-  return i;
+  return NodeSearch::LowerBound(this->array_, 0, this->GetSize(), key, kcomparator);
+}
+
+//找到第一个大于 key 的 key 的索引,  1 3 5 7
+//                                     5     return 3
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::UpperIndexByKey(KeyType key, KeyComparator &kcomparator) -> int {
+  return NodeSearch::UpperBound(this->array_, 0, this->GetSize(), key, kcomparator);
 }
 
 
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(KeyType key, ValueType value, KeyComparator &kcomparator) -> int {
   int index = this->IndexByKey(key, kcomparator);
-  if (kcomparator(key, this->array_[index].first) == 0) {
+  if (index < this->GetSize() && kcomparator(key, this->array_[index].first) == 0) {
     return 0;
   }
   for (int i = this->GetSize()-1; i >= index; i--) {
@@ -134,22 +147,12 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(KeyType key, ValueType value, KeyCompara
  
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetValByKey(KeyType key, ValueType &value, KeyComparator &kcomparator) -> bool {
-  int i = 0;
-  bool find = false;
-  for ( i = 0; i < this->GetSize(); i++) {
-    if(kcomparator(key, this->array_[i].first) <= 0) {     // 找这么一个 key, 此 key 第一次大于 入参 key; 找第一个大于入参 key 的 key
-      if (kcomparator(key, this->array_[i].first) == 0) {
-        value = this->array_[i].second;
-        find = true;
-      }
-      break;
-    } 
-  }
-  if (find) {
+  int i = this->IndexByKey(key, kcomparator);
+  if (i < this->GetSize() && kcomparator(key, this->array_[i].first) == 0) {
+    value = this->array_[i].second;
     return true;
   }
   return false;
-
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -163,7 +166,7 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::ItemAt(int index) const -> const MappingType &
 INDEX_TEMPLATE_ARGUMENTS 
 auto B_PLUS_TREE_LEAF_PAGE_TYPE::Remove(KeyType key, KeyComparator &kcomparator) -> int {
   int index = this->IndexByKey(key, kcomparator);
-  if (kcomparator(key, this->array_[index].first) != 0) {
+  if (index >= this->GetSize() || kcomparator(key, this->array_[index].first) != 0) {
     return 0;
   }
 
@@ -44,6 +44,9 @@ auto BPlusTreePage::IsRootPage(page_id_t rootId) const -> bool {
 void BPlusTreePage::SetPageType(IndexPageType page_type) {
     this->page_type_ = page_type;
 }
+auto BPlusTreePage::GetPageType() const -> IndexPageType {
+    return this->page_type_;
+}
 
 /*
  * Helper methods to get/set size (number of key/value pairs stored in that
@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/page/b_plus_tree_posting_page.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+
+#include "common/exception.h"
+#include "common/macros.h"
+#include "storage/page/b_plus_tree_posting_page.h"
+
+namespace bustub {
+
+void BPlusTreePostingPage::Init(page_id_t page_id) {
+  this->page_id_ = page_id;
+  this->next_page_id_ = INVALID_PAGE_ID;
+  this->count_ = 0;
+  this->data_len_ = 0;
+  this->last_rid_ = 0;
+}
+
+void BPlusTreePostingPage::Load(std::vector<RID> *rids) const {
+  rids->reserve(rids->size() + this->count_);
+  Decode({Data(), static_cast<size_t>(this->data_len_)}, rids);
+}
+
+auto BPlusTreePostingPage::Store(const std::vector<RID> &rids, size_t begin, size_t end) -> bool {
+  std::string bytes;
+  Encode(rids, begin, end, &bytes);
+  if (bytes.size() > POSTING_PAGE_DATA_SIZE) {
+    return false;
+  }
+  memcpy(Data(), bytes.data(), bytes.size());
+  this->data_len_ = static_cast<int32_t>(bytes.size());
+  this->count_ = static_cast<int32_t>(end - begin);
+  this->last_rid_ = end > begin ? rids[end - 1].Get() : 0;
+  return true;
+}
+
+/*
+ * varint: 每字节低 7 位存数据, 最高位为 1 表示后面还有字节
+ * 第一个 RID 存绝对值, 之后存与前一个的差值; RID 按 (page id, slot) 排好序, 差值都很小
+ */
+void BPlusTreePostingPage::Encode(const std::vector<RID> &rids, size_t begin, size_t end, std::string *out) {
+  uint64_t prev = 0;
+  for (size_t i = begin; i < end; i++) {
+    auto cur = static_cast<uint64_t>(rids[i].Get());
+    BUSTUB_ASSERT(i == begin || cur > prev, "posting list must be sorted and unique");
+    uint64_t delta = cur - prev;
+    while (delta >= 0x80) {
+      out->push_back(static_cast<char>((delta & 0x7F) | 0x80));
+      delta >>= 7;
+    }
+    out->push_back(static_cast<char>(delta));
+    prev = cur;
+  }
+}
+
+void BPlusTreePostingPage::Decode(std::string_view bytes, std::vector<RID> *rids) {
+  uint64_t prev = 0;
+  size_t i = 0;
+  while (i < bytes.size()) {
+    uint64_t delta = 0;
+    int shift = 0;
+    uint8_t byte;
+    do {
+      byte = static_cast<uint8_t>(bytes[i++]);
+      delta |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      shift += 7;
+    } while ((byte & 0x80) != 0);
+    prev += delta;
+    rids->emplace_back(static_cast<int64_t>(prev));
+  }
+}
+
+}  // namespace bustub
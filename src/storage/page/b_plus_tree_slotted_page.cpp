@@ -0,0 +1,353 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/page/b_plus_tree_slotted_page.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/exception.h"
+#include "storage/page/b_plus_tree_slotted_page.h"
+
+namespace bustub {
+
+/*****************************************************************************
+ * HELPER METHODS AND UTILITIES
+ *****************************************************************************/
+
+/**
+ * Init method after creating a new slotted page
+ * 设置页类型, 大小为0, 写入上下界 fence key, 公共前缀 = 两个 fence 的公共前缀
+ */
+void BPlusTreeSlottedPage::Init(page_id_t page_id, IndexPageType page_type, std::string_view lower_fence,
+                                std::string_view upper_fence, bool upper_is_infinity) {
+  BUSTUB_ASSERT(lower_fence.size() <= SLOTTED_PAGE_MAX_KEY_SIZE, "lower fence too long");
+  BUSTUB_ASSERT(upper_is_infinity || upper_fence.size() <= SLOTTED_PAGE_MAX_KEY_SIZE, "upper fence too long");
+  this->SetPageId(page_id);
+  this->SetParentPageId(INVALID_PAGE_ID);
+  this->SetPageType(page_type);
+  this->SetSize(0);
+  this->SetMaxSize(0);  // 容量按字节计算, max size 不使用
+  this->SetLSN();
+  this->next_page_id_ = INVALID_PAGE_ID;
+  this->garbage_bytes_ = 0;
+  this->reserved_ = 0;
+  this->free_space_offset_ = BUSTUB_PAGE_SIZE;
+
+  this->lower_fence_len_ = static_cast<uint16_t>(lower_fence.size());
+  memcpy(Data() + SLOTTED_PAGE_HEADER_SIZE, lower_fence.data(), lower_fence.size());
+  if (upper_is_infinity) {
+    this->upper_fence_len_ = UPPER_FENCE_INFINITY;
+    this->prefix_len_ = 0;
+  } else {
+    this->upper_fence_len_ = static_cast<uint16_t>(upper_fence.size());
+    memcpy(Data() + SLOTTED_PAGE_HEADER_SIZE + lower_fence.size(), upper_fence.data(), upper_fence.size());
+    this->prefix_len_ = static_cast<uint16_t>(CommonPrefixLength(lower_fence, upper_fence));
+  }
+}
+
+auto BPlusTreeSlottedPage::GetNextPageId() const -> page_id_t { return this->next_page_id_; }
+
+void BPlusTreeSlottedPage::SetNextPageId(page_id_t next_page_id) { this->next_page_id_ = next_page_id; }
+
+auto BPlusTreeSlottedPage::GetLowerFence() const -> std::string_view {
+  return {Data() + SLOTTED_PAGE_HEADER_SIZE, this->lower_fence_len_};
+}
+
+auto BPlusTreeSlottedPage::GetUpperFence() const -> std::string_view {
+  if (IsUpperInfinity()) {
+    return {};
+  }
+  return {Data() + SLOTTED_PAGE_HEADER_SIZE + this->lower_fence_len_, this->upper_fence_len_};
+}
+
+auto BPlusTreeSlottedPage::IsUpperInfinity() const -> bool { return this->upper_fence_len_ == UPPER_FENCE_INFINITY; }
+
+// 公共前缀就存在 lower fence 的开头, 不再单独存一份
+auto BPlusTreeSlottedPage::GetPrefix() const -> std::string_view {
+  return {Data() + SLOTTED_PAGE_HEADER_SIZE, this->prefix_len_};
+}
+
+auto BPlusTreeSlottedPage::SlotAreaOffset() const -> int {
+  int upper_len = IsUpperInfinity() ? 0 : this->upper_fence_len_;
+  return SLOTTED_PAGE_HEADER_SIZE + this->lower_fence_len_ + upper_len;
+}
+
+auto BPlusTreeSlottedPage::SlotOffset(int index) const -> uint16_t {
+  uint16_t offset;
+  memcpy(&offset, Data() + SlotAreaOffset() + index * SLOTTED_PAGE_SLOT_SIZE, sizeof(uint16_t));
+  return offset;
+}
+
+auto BPlusTreeSlottedPage::SlotKeyLen(int index) const -> uint16_t {
+  uint16_t key_len;
+  memcpy(&key_len, Data() + SlotAreaOffset() + index * SLOTTED_PAGE_SLOT_SIZE + sizeof(uint16_t), sizeof(uint16_t));
+  return key_len;
+}
+
+auto BPlusTreeSlottedPage::SlotValueLen(int index) const -> uint16_t {
+  uint16_t value_len;
+  memcpy(&value_len, Data() + SlotAreaOffset() + index * SLOTTED_PAGE_SLOT_SIZE + 2 * sizeof(uint16_t),
+         sizeof(uint16_t));
+  return value_len;
+}
+
+void BPlusTreeSlottedPage::SetSlot(int index, uint16_t offset, uint16_t key_len, uint16_t value_len) {
+  char *slot = Data() + SlotAreaOffset() + index * SLOTTED_PAGE_SLOT_SIZE;
+  memcpy(slot, &offset, sizeof(uint16_t));
+  memcpy(slot + sizeof(uint16_t), &key_len, sizeof(uint16_t));
+  memcpy(slot + 2 * sizeof(uint16_t), &value_len, sizeof(uint16_t));
+}
+
+/*
+ * 在 entry 堆顶写入 suffix + value, 并设置 index 处的槽位
+ */
+void BPlusTreeSlottedPage::WriteEntry(int index, std::string_view suffix, std::string_view payload) {
+  auto entry_size = static_cast<uint16_t>(suffix.size() + payload.size());
+  this->free_space_offset_ -= entry_size;
+  memcpy(Data() + this->free_space_offset_, suffix.data(), suffix.size());
+  memcpy(Data() + this->free_space_offset_ + suffix.size(), payload.data(), payload.size());
+  SetSlot(index, this->free_space_offset_, static_cast<uint16_t>(suffix.size()),
+          static_cast<uint16_t>(payload.size()));
+}
+
+auto BPlusTreeSlottedPage::KeyAt(int index) const -> std::string {
+  if (index == 0 && !this->IsLeafPage()) {
+    return std::string(GetLowerFence());
+  }
+  std::string key(GetPrefix());
+  key.append(SuffixAt(index));
+  return key;
+}
+
+auto BPlusTreeSlottedPage::SuffixAt(int index) const -> std::string_view {
+  return {Data() + SlotOffset(index), SlotKeyLen(index)};
+}
+
+auto BPlusTreeSlottedPage::ValueAt(int index) const -> int64_t {
+  BUSTUB_ASSERT(SlotValueLen(index) == SLOTTED_PAGE_VALUE_SIZE, "value is not an 8-byte integer");
+  int64_t value;
+  memcpy(&value, Data() + SlotOffset(index) + SlotKeyLen(index), SLOTTED_PAGE_VALUE_SIZE);
+  return value;
+}
+
+void BPlusTreeSlottedPage::SetValueAt(int index, int64_t value) {
+  BUSTUB_ASSERT(SlotValueLen(index) == SLOTTED_PAGE_VALUE_SIZE, "value is not an 8-byte integer");
+  memcpy(Data() + SlotOffset(index) + SlotKeyLen(index), &value, SLOTTED_PAGE_VALUE_SIZE);
+}
+
+auto BPlusTreeSlottedPage::PayloadAt(int index) const -> std::string_view {
+  return {Data() + SlotOffset(index) + SlotKeyLen(index), SlotValueLen(index)};
+}
+
+/*
+  替换 index 处的 value
+  1 长度不变, 原地覆盖
+  2 否则删掉旧 entry 再插入新 entry, 空间不够时不做任何修改, 返回 false
+*/
+auto BPlusTreeSlottedPage::SetPayloadAt(int index, std::string_view payload) -> bool {
+  BUSTUB_ASSERT(payload.size() <= SLOTTED_PAGE_MAX_VALUE_SIZE, "value too long");
+  if (payload.size() == SlotValueLen(index)) {
+    memcpy(Data() + SlotOffset(index) + SlotKeyLen(index), payload.data(), payload.size());
+    return true;
+  }
+  int old_entry = SlotKeyLen(index) + SlotValueLen(index);
+  int new_entry = SlotKeyLen(index) + static_cast<int>(payload.size());
+  if (GetFreeSpace() + this->garbage_bytes_ + old_entry < new_entry) {
+    return false;
+  }
+  std::string key = KeyAt(index);
+  RemoveAt(index);
+  bool ok = InsertAt(index, key, payload);
+  BUSTUB_ASSERT(ok, "slotted page overflow on value update");
+  return ok;
+}
+
+/*
+ * 先比较前缀, 前缀相同再比较后缀; 正常情况下查找的 key 都落在 fence 之间, 前缀一定相同
+ */
+auto BPlusTreeSlottedPage::CompareAt(std::string_view key, int index) const -> int {
+  std::string_view prefix = GetPrefix();
+  size_t n = std::min(key.size(), prefix.size());
+  int cmp = memcmp(key.data(), prefix.data(), n);
+  if (cmp != 0) {
+    return cmp;
+  }
+  if (key.size() < prefix.size()) {
+    return -1;
+  }
+  return key.substr(prefix.size()).compare(SuffixAt(index));
+}
+
+/*
+ * 二分查找第一个大于或等于 key 的 index,   1 3 5 7
+ *                                            4     return 2
+ *                                            5     return 2
+ */
+auto BPlusTreeSlottedPage::LowerBound(std::string_view key) const -> int {
+  int left = this->IsLeafPage() ? 0 : 1;
+  int right = this->GetSize();
+  while (left < right) {
+    int mid = left + (right - left) / 2;
+    if (CompareAt(key, mid) > 0) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return left;
+}
+
+/*
+ * 找到 key 所在的子节点
+ *          key1        key2       key3
+ * page0    page1       page2      page3
+ *  < key1   >=key1     >=key2     >=key3
+ */
+auto BPlusTreeSlottedPage::ChildIndex(std::string_view key) const -> int {
+  int left = 1;
+  int right = this->GetSize();
+  while (left < right) {  // 第一个大于 key 的 index
+    int mid = left + (right - left) / 2;
+    if (CompareAt(key, mid) >= 0) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return left - 1;
+}
+
+auto BPlusTreeSlottedPage::EntrySize(std::string_view key, size_t value_size) const -> int {
+  return SLOTTED_PAGE_SLOT_SIZE + static_cast<int>(key.size()) - this->prefix_len_ + static_cast<int>(value_size);
+}
+
+auto BPlusTreeSlottedPage::GetFreeSpace() const -> int {
+  return this->free_space_offset_ - SlotAreaOffset() - this->GetSize() * SLOTTED_PAGE_SLOT_SIZE;
+}
+
+auto BPlusTreeSlottedPage::GetGarbageBytes() const -> int { return this->garbage_bytes_; }
+
+auto BPlusTreeSlottedPage::GetUsedBytes() const -> int {
+  return BUSTUB_PAGE_SIZE - this->free_space_offset_ - this->garbage_bytes_ + this->GetSize() * SLOTTED_PAGE_SLOT_SIZE;
+}
+
+/*
+  插入 key:value 到 index 处
+  return, 1 成功, true
+          2 空间不足, false; 调用者需要分裂
+*/
+auto BPlusTreeSlottedPage::InsertAt(int index, std::string_view key, int64_t value) -> bool {
+  return InsertAt(index, key, std::string_view(reinterpret_cast<const char *>(&value), SLOTTED_PAGE_VALUE_SIZE));
+}
+
+auto BPlusTreeSlottedPage::InsertAt(int index, std::string_view key, std::string_view payload) -> bool {
+  BUSTUB_ASSERT(payload.size() <= SLOTTED_PAGE_MAX_VALUE_SIZE, "value too long");
+  // internal 页的 [0] 不存 key
+  std::string_view suffix;
+  if (this->IsLeafPage() || index != 0) {
+    BUSTUB_ASSERT(key.substr(0, this->prefix_len_) == GetPrefix(), "key out of fence range");
+    suffix = key.substr(this->prefix_len_);
+  }
+  int need = SLOTTED_PAGE_SLOT_SIZE + static_cast<int>(suffix.size()) + static_cast<int>(payload.size());
+  if (GetFreeSpace() < need) {
+    if (GetFreeSpace() + this->garbage_bytes_ < need) {
+      return false;
+    }
+    Compact();
+  }
+
+  // 槽位后移, 空出 index
+  char *slots = Data() + SlotAreaOffset();
+  memmove(slots + (index + 1) * SLOTTED_PAGE_SLOT_SIZE, slots + index * SLOTTED_PAGE_SLOT_SIZE,
+          (this->GetSize() - index) * SLOTTED_PAGE_SLOT_SIZE);
+  WriteEntry(index, suffix, payload);
+  this->IncreaseSize();
+  return true;
+}
+
+void BPlusTreeSlottedPage::Append(std::string_view key, int64_t value) {
+  bool ok = InsertAt(this->GetSize(), key, value);
+  BUSTUB_ASSERT(ok, "slotted page overflow on append");
+  (void)ok;
+}
+
+void BPlusTreeSlottedPage::Append(std::string_view key, std::string_view payload) {
+  bool ok = InsertAt(this->GetSize(), key, payload);
+  BUSTUB_ASSERT(ok, "slotted page overflow on append");
+  (void)ok;
+}
+
+/*
+  删除 index 处元素, entry 的空间记为垃圾, 下次空间不足时整理
+*/
+void BPlusTreeSlottedPage::RemoveAt(int index) {
+  this->garbage_bytes_ += SlotKeyLen(index) + SlotValueLen(index);
+  char *slots = Data() + SlotAreaOffset();
+  memmove(slots + index * SLOTTED_PAGE_SLOT_SIZE, slots + (index + 1) * SLOTTED_PAGE_SLOT_SIZE,
+          (this->GetSize() - index - 1) * SLOTTED_PAGE_SLOT_SIZE);
+  this->DecreaseSize();
+}
+
+/*
+  整理 entry 堆: 按槽位顺序把所有 entry 重新紧凑地写到页尾
+*/
+void BPlusTreeSlottedPage::Compact() {
+  if (this->garbage_bytes_ == 0) {
+    return;
+  }
+  char buf[BUSTUB_PAGE_SIZE];
+  int offset = BUSTUB_PAGE_SIZE;
+  for (int i = 0; i < this->GetSize(); i++) {
+    int entry_size = SlotKeyLen(i) + SlotValueLen(i);
+    offset -= entry_size;
+    memcpy(buf + offset, Data() + SlotOffset(i), entry_size);
+    SetSlot(i, static_cast<uint16_t>(offset), SlotKeyLen(i), SlotValueLen(i));
+  }
+  memcpy(Data() + offset, buf + offset, BUSTUB_PAGE_SIZE - offset);
+  this->free_space_offset_ = static_cast<uint16_t>(offset);
+  this->garbage_bytes_ = 0;
+}
+
+void BPlusTreeSlottedPage::CopyEntries(std::vector<std::pair<std::string, int64_t>> *entries) const {
+  entries->reserve(entries->size() + this->GetSize());
+  for (int i = 0; i < this->GetSize(); i++) {
+    entries->emplace_back(KeyAt(i), ValueAt(i));
+  }
+}
+
+void BPlusTreeSlottedPage::CopyEntries(std::vector<std::pair<std::string, std::string>> *entries) const {
+  entries->reserve(entries->size() + this->GetSize());
+  for (int i = 0; i < this->GetSize(); i++) {
+    entries->emplace_back(KeyAt(i), PayloadAt(i));
+  }
+}
+
+/*
+ * 后缀截断: 取 right 的最短前缀, 使其仍然大于 left
+ *   left = "apple", right = "banana"   return "b"
+ *   left = "abc",   right = "abd1"     return "abd"
+ *   left = "ab",    right = "abc"      return "abc"
+ */
+auto BPlusTreeSlottedPage::ShortestSeparator(std::string_view left, std::string_view right) -> std::string {
+  size_t lcp = CommonPrefixLength(left, right);
+  BUSTUB_ASSERT(lcp < right.size(), "separator requires left < right");
+  return std::string(right.substr(0, lcp + 1));
+}
+
+auto BPlusTreeSlottedPage::CommonPrefixLength(std::string_view a, std::string_view b) -> size_t {
+  size_t n = std::min(a.size(), b.size());
+  size_t i = 0;
+  while (i < n && a[i] == b[i]) {
+    i++;
+  }
+  return i;
+}
+
+}  // namespace bustub
@@ -0,0 +1,31 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map_page.cpp
+//
+// Identification: src/storage/page/free_space_map_page.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/free_space_map_page.h"
+
+#include "common/macros.h"
+
+namespace bustub {
+
+void FreeSpaceMapPage::Init() {
+  next_page_id_ = INVALID_PAGE_ID;
+  count_ = 0;
+}
+
+void FreeSpaceMapPage::Append(page_id_t heap_page_id, uint8_t category) {
+  BUSTUB_ASSERT(!IsFull(), "free-space map page is full");
+  heap_page_ids_[count_] = heap_page_id;
+  categories_[count_] = category;
+  count_++;
+}
+
+}  // namespace bustub
@@ -0,0 +1,498 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pax_page.cpp
+//
+// Identification: src/storage/page/pax_page.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/pax_page.h"
+
+#include <algorithm>
+
+#include "storage/table/toast.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/** when sizing a page, a VARCHAR(n) column is assumed to hold n / 2 bytes, but at most this many */
+static constexpr uint32_t PAX_VARCHAR_ESTIMATE_MAX = 64;
+
+PaxLayout::PaxLayout(const Schema &schema) : schema_(schema), all_columns_(schema.GetColumnCount(), true) {
+  // 每个 slot 在位图和 minipage 里占的位数, 以及估计的变长数据字节数
+  uint32_t slot_bits = 2;
+  uint32_t varchar_estimate = 0;
+  row_overhead_ = schema.GetLength();
+  for (const auto &col : schema.GetColumns()) {
+    if (col.IsInlined()) {
+      slot_bits += 8 * col.GetFixedLength() + 1;
+    } else {
+      slot_bits += 8 * 2 * sizeof(uint32_t) + 1;
+      varchar_estimate += std::min(col.GetVariableLength() / 2 + 1, PAX_VARCHAR_ESTIMATE_MAX);
+      row_overhead_ += sizeof(uint32_t);
+    }
+  }
+  capacity_ = std::max<uint32_t>((BUSTUB_PAGE_SIZE - SIZE_PAX_PAGE_HEADER) * 8 / (slot_bits + 8 * varchar_estimate), 1);
+  // 位图按 8 字节对齐会多占一点, 往下调到放得下为止
+  while (capacity_ > 1 && Place(capacity_) + capacity_ * varchar_estimate > BUSTUB_PAGE_SIZE) {
+    capacity_--;
+  }
+  data_end_ = Place(capacity_);
+  BUSTUB_ENSURE(data_end_ < BUSTUB_PAGE_SIZE, "A row of this schema does not fit in a PAX page.");
+}
+
+auto PaxLayout::Place(uint32_t capacity) -> uint32_t {
+  bitmap_size_ = (capacity + 63) / 64 * sizeof(uint64_t);
+  uint32_t offset = SIZE_PAX_PAGE_HEADER;
+  present_offset_ = offset;
+  offset += bitmap_size_;
+  deleted_offset_ = offset;
+  offset += bitmap_size_;
+  minipages_.clear();
+  for (const auto &col : schema_.GetColumns()) {
+    Minipage minipage;
+    minipage.nulls_offset_ = offset;
+    offset += bitmap_size_;
+    minipage.values_offset_ = offset;
+    minipage.width_ = col.IsInlined() ? col.GetFixedLength() : 2 * sizeof(uint32_t);
+    offset += minipage.width_ * capacity;
+    offset = (offset + sizeof(uint64_t) - 1) / sizeof(uint64_t) * sizeof(uint64_t);
+    minipages_.push_back(minipage);
+  }
+  return offset;
+}
+
+void PaxPage::Init(const PaxLayout &layout, page_id_t page_id, uint32_t page_size, page_id_t prev_page_id,
+                   LogManager *log_manager, Transaction *txn) {
+  TablePage::Init(page_id, page_size, prev_page_id, log_manager, txn);
+  SetVarBytes(0);
+  memset(GetData() + PaxLayout::SIZE_PAX_PAGE_HEADER, 0, layout.data_end_ - PaxLayout::SIZE_PAX_PAGE_HEADER);
+}
+
+auto PaxPage::GetFreeSpaceRemaining(const PaxLayout &layout) -> uint32_t {
+  if (FindFreeSlot(layout) == layout.capacity_) {
+    return 0;
+  }
+  // 一个 n 字节的 tuple 在这一页要的只是它的变长数据: n - row_overhead_ 字节
+  return BUSTUB_PAGE_SIZE - layout.data_end_ - GetVarBytes() + layout.row_overhead_ + SIZE_TUPLE;
+}
+
+auto PaxPage::InsertTuple(const PaxLayout &layout, const Tuple &tuple, RID *rid, Transaction *txn,
+                          LockManager *lock_manager, LogManager *log_manager) -> bool {
+  BUSTUB_ASSERT(tuple.size_ > 0, "Cannot have empty tuples.");
+  if (GetFreeSpaceRemaining(layout) < SpaceForTuple(tuple.size_)) {
+    return false;
+  }
+  uint32_t slot = FindFreeSlot(layout);
+  WriteSlot(layout, slot, tuple.data_, tuple.size_);
+  rid->Set(GetTablePageId(), slot);
+
+  if (enable_logging) {
+    BUSTUB_ASSERT(!txn->IsSharedLocked(*rid) && !txn->IsExclusiveLocked(*rid), "A new tuple should not be locked.");
+    bool locked = lock_manager->LockExclusive(txn, *rid);
+    BUSTUB_ENSURE(locked, "Locking a new tuple should always work.");
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::INSERT, *rid, tuple);
+    AppendLog(&log_record, txn, log_manager);
+  }
+  return true;
+}
+
+auto PaxPage::AppendTuple(const PaxLayout &layout, const char *data, uint32_t size, RID *rid) -> bool {
+  BUSTUB_ASSERT(size > 0, "Cannot have empty tuples.");
+  uint32_t slot = GetTupleCount();
+  if (slot == layout.capacity_ || GetFreeSpaceRemaining(layout) < SpaceForTuple(size)) {
+    return false;
+  }
+  WriteSlot(layout, slot, data, size);
+  rid->Set(GetTablePageId(), slot);
+  return true;
+}
+
+auto PaxPage::MarkDelete(const PaxLayout &layout, const RID &rid, Transaction *txn, LockManager *lock_manager,
+                         LogManager *log_manager) -> bool {
+  uint32_t slot_num = rid.GetSlotNum();
+  // If the slot is empty or already deleted, abort the transaction.
+  if (slot_num >= GetTupleCount() || !IsLive(layout, slot_num)) {
+    if (enable_logging) {
+      txn->SetState(TransactionState::ABORTED);
+    }
+    return false;
+  }
+
+  if (enable_logging) {
+    if (!LockForWrite(rid, txn, lock_manager)) {
+      return false;
+    }
+    Tuple dummy_tuple;
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::MARKDELETE, rid, dummy_tuple);
+    AppendLog(&log_record, txn, log_manager);
+  }
+  SetBit(Bitmap(layout.deleted_offset_), slot_num);
+  return true;
+}
+
+auto PaxPage::UpdateTuple(const PaxLayout &layout, const Tuple &new_tuple, Tuple *old_tuple, const RID &rid,
+                          Transaction *txn, LockManager *lock_manager, LogManager *log_manager) -> bool {
+  BUSTUB_ASSERT(new_tuple.size_ > 0, "Cannot have empty tuples.");
+  uint32_t slot_num = rid.GetSlotNum();
+  if (slot_num >= GetTupleCount() || !IsLive(layout, slot_num)) {
+    if (enable_logging) {
+      txn->SetState(TransactionState::ABORTED);
+    }
+    return false;
+  }
+  // 新的变长数据放不下就返回 false, 由上层删了再插, 同 TablePage::UpdateTuple
+  uint32_t free_bytes = BUSTUB_PAGE_SIZE - layout.data_end_ - GetVarBytes() + VarBytesOf(layout, slot_num);
+  if (free_bytes + layout.row_overhead_ < new_tuple.size_) {
+    return false;
+  }
+
+  ReadSlot(layout, slot_num, rid, old_tuple);
+  if (enable_logging) {
+    if (!LockForWrite(rid, txn, lock_manager)) {
+      return false;
+    }
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::UPDATE, rid, *old_tuple, new_tuple);
+    AppendLog(&log_record, txn, log_manager);
+  }
+  ReleaseVarchars(layout, slot_num);
+  WriteSlot(layout, slot_num, new_tuple.data_, new_tuple.size_);
+  return true;
+}
+
+void PaxPage::ApplyDelete(const PaxLayout &layout, const RID &rid, Transaction *txn, LogManager *log_manager,
+                          Tuple *deleted_tuple) {
+  uint32_t slot_num = rid.GetSlotNum();
+  BUSTUB_ASSERT(slot_num < GetTupleCount() && TestBit(Bitmap(layout.present_offset_), slot_num),
+                "Cannot delete an empty slot.");
+  Tuple delete_tuple;
+  if (enable_logging || deleted_tuple != nullptr) {
+    ReadSlot(layout, slot_num, rid, &delete_tuple);
+  }
+  if (enable_logging) {
+    BUSTUB_ASSERT(txn->IsExclusiveLocked(rid), "We must own the exclusive lock!");
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::APPLYDELETE, rid, delete_tuple);
+    AppendLog(&log_record, txn, log_manager);
+  }
+  if (deleted_tuple != nullptr) {
+    *deleted_tuple = delete_tuple;
+  }
+  ReleaseVarchars(layout, slot_num);
+  ClearBit(Bitmap(layout.present_offset_), slot_num);
+  ClearBit(Bitmap(layout.deleted_offset_), slot_num);
+}
+
+void PaxPage::RollbackDelete(const PaxLayout &layout, const RID &rid, Transaction *txn, LogManager *log_manager) {
+  if (enable_logging) {
+    BUSTUB_ASSERT(txn->IsExclusiveLocked(rid), "We must own an exclusive lock on the RID.");
+    Tuple dummy_tuple;
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::ROLLBACKDELETE, rid, dummy_tuple);
+    AppendLog(&log_record, txn, log_manager);
+  }
+  uint32_t slot_num = rid.GetSlotNum();
+  BUSTUB_ASSERT(slot_num < GetTupleCount(), "We can't have more slots than tuples.");
+  ClearBit(Bitmap(layout.deleted_offset_), slot_num);
+}
+
+auto PaxPage::GetTuple(const PaxLayout &layout, const RID &rid, Tuple *tuple, Transaction *txn,
+                       LockManager *lock_manager) -> bool {
+  uint32_t slot_num = rid.GetSlotNum();
+  if (slot_num >= GetTupleCount() || !IsLive(layout, slot_num)) {
+    if (enable_logging) {
+      txn->SetState(TransactionState::ABORTED);
+    }
+    return false;
+  }
+  if (enable_logging) {
+    if (!txn->IsSharedLocked(rid) && !txn->IsExclusiveLocked(rid) && !lock_manager->LockShared(txn, rid)) {
+      return false;
+    }
+  }
+  ReadSlot(layout, slot_num, rid, tuple);
+  return true;
+}
+
+void PaxPage::GetTupleViews(const PaxLayout &layout, const std::vector<uint32_t> *columns, std::vector<char> *rows,
+                            std::vector<TupleView> *views) {
+  const std::vector<bool> *referenced = &layout.all_columns_;
+  std::vector<bool> selected;
+  if (columns != nullptr) {
+    selected.assign(layout.minipages_.size(), false);
+    for (auto column_idx : *columns) {
+      selected[column_idx] = true;
+    }
+    referenced = &selected;
+  }
+
+  std::vector<uint32_t> slots;
+  std::vector<uint32_t> row_offsets;
+  uint32_t size = 0;
+  for (uint32_t word = 0; word * 64 < GetTupleCount(); word++) {
+    for (uint64_t live = GetLiveBits(layout, word); live != 0; live &= live - 1) {
+      uint32_t slot = word * 64 + __builtin_ctzll(live);
+      slots.push_back(slot);
+      row_offsets.push_back(size);
+      size += RowSize(layout, slot, *referenced);
+    }
+  }
+  rows->resize(size);
+  WriteRows(layout, slots, *referenced, row_offsets, rows->data());
+
+  page_id_t page_id = GetTablePageId();
+  for (size_t i = 0; i < slots.size(); i++) {
+    uint32_t end = i + 1 < slots.size() ? row_offsets[i + 1] : size;
+    views->emplace_back(RID(page_id, slots[i]), rows->data() + row_offsets[i], end - row_offsets[i]);
+  }
+}
+
+auto PaxPage::GetFirstTupleRid(const PaxLayout &layout, RID *first_rid) -> bool {
+  uint32_t slot = NextLiveSlot(layout, 0);
+  if (slot < GetTupleCount()) {
+    first_rid->Set(GetTablePageId(), slot);
+    return true;
+  }
+  first_rid->Set(INVALID_PAGE_ID, 0);
+  return false;
+}
+
+auto PaxPage::GetNextTupleRid(const PaxLayout &layout, const RID &cur_rid, RID *next_rid) -> bool {
+  BUSTUB_ASSERT(cur_rid.GetPageId() == GetTablePageId(), "Wrong table!");
+  uint32_t slot = NextLiveSlot(layout, cur_rid.GetSlotNum() + 1);
+  if (slot < GetTupleCount()) {
+    next_rid->Set(GetTablePageId(), slot);
+    return true;
+  }
+  next_rid->Set(INVALID_PAGE_ID, 0);
+  return false;
+}
+
+auto PaxPage::Compact(const PaxLayout &layout) -> uint32_t {
+  // 变长区里 ApplyDelete 和 UpdateTuple 留下的空洞, 平时等插入放不下时才整理
+  uint32_t freed = BUSTUB_PAGE_SIZE - GetFreeSpacePointer() - GetVarBytes();
+  if (freed > 0) {
+    CompactHeap(layout);
+  }
+  const uint64_t *present = Bitmap(layout.present_offset_);
+  uint32_t slot_count = GetTupleCount();
+  while (slot_count > 0 && !TestBit(present, slot_count - 1)) {
+    slot_count--;
+  }
+  SetTupleCount(slot_count);
+  return freed;
+}
+
+auto PaxPage::HasMarkedDeletes(const PaxLayout &layout) -> bool {
+  const uint64_t *deleted = Bitmap(layout.deleted_offset_);
+  for (uint32_t word = 0; word * 64 < GetTupleCount(); word++) {
+    if (deleted[word] != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+auto PaxPage::FindFreeSlot(const PaxLayout &layout) -> uint32_t {
+  const uint64_t *present = Bitmap(layout.present_offset_);
+  for (uint32_t word = 0; word < layout.bitmap_size_ / sizeof(uint64_t); word++) {
+    if (present[word] != ~uint64_t{0}) {
+      // 最后一个字里超出 capacity 的位总是 0
+      return std::min<uint32_t>(word * 64 + __builtin_ctzll(~present[word]), layout.capacity_);
+    }
+  }
+  return layout.capacity_;
+}
+
+auto PaxPage::NextLiveSlot(const PaxLayout &layout, uint32_t slot) -> uint32_t {
+  uint32_t count = GetTupleCount();
+  for (uint32_t word = slot / 64; word * 64 < count; word++) {
+    uint64_t live = GetLiveBits(layout, word);
+    if (word == slot / 64) {
+      live &= ~uint64_t{0} << (slot % 64);
+    }
+    if (live != 0) {
+      return word * 64 + __builtin_ctzll(live);
+    }
+  }
+  return count;
+}
+
+auto PaxPage::VarBytesOf(const PaxLayout &layout, uint32_t slot) -> uint32_t {
+  uint32_t var_bytes = 0;
+  for (auto column_idx : layout.schema_.GetUnlinedColumns()) {
+    var_bytes += Toast::StoredBytes(GetVarchar(layout, column_idx, slot)->length_);
+  }
+  return var_bytes;
+}
+
+void PaxPage::WriteSlot(const PaxLayout &layout, uint32_t slot, const char *data, uint32_t size) {
+  if (GetFreeSpacePointer() - layout.data_end_ < size - layout.row_overhead_) {
+    CompactHeap(layout);
+  }
+  const Schema &schema = layout.schema_;
+  for (uint32_t i = 0; i < layout.minipages_.size(); i++) {
+    const auto &col = schema.GetColumn(i);
+    const auto &minipage = layout.minipages_[i];
+    const char *field = data + col.GetOffset();
+    bool is_null;
+    if (col.IsInlined()) {
+      memcpy(GetData() + minipage.values_offset_ + slot * minipage.width_, field, minipage.width_);
+      is_null = Value::DeserializeFrom(field, col.GetType()).IsNull();
+    } else {
+      // tuple 里是 数据的相对偏移 -> (长度, 内容); minipage 里记内容在本页变长区的位置和长度
+      uint32_t offset;
+      memcpy(&offset, field, sizeof(offset));
+      VarcharEntry entry{0, 0};
+      memcpy(&entry.length_, data + offset, sizeof(uint32_t));
+      is_null = entry.length_ == BUSTUB_VALUE_NULL;
+      if (!is_null) {
+        // 存在行外的值, 这里放的是它的指针 (见 Toast), 长度字段照抄
+        uint32_t bytes = Toast::StoredBytes(entry.length_);
+        entry.offset_ = GetFreeSpacePointer() - bytes;
+        memcpy(GetData() + entry.offset_, data + offset + sizeof(uint32_t), bytes);
+        SetFreeSpacePointer(entry.offset_);
+        SetVarBytes(GetVarBytes() + bytes);
+      }
+      *GetVarchar(layout, i, slot) = entry;
+    }
+    if (is_null) {
+      SetBit(Bitmap(minipage.nulls_offset_), slot);
+    } else {
+      ClearBit(Bitmap(minipage.nulls_offset_), slot);
+    }
+  }
+  SetBit(Bitmap(layout.present_offset_), slot);
+  ClearBit(Bitmap(layout.deleted_offset_), slot);
+  if (slot >= GetTupleCount()) {
+    SetTupleCount(slot + 1);
+  }
+}
+
+void PaxPage::ReadSlot(const PaxLayout &layout, uint32_t slot, const RID &rid, Tuple *tuple) {
+  uint32_t size = RowSize(layout, slot, layout.all_columns_);
+  if (tuple->allocated_) {
+    delete[] tuple->data_;
+  }
+  tuple->data_ = new char[size];
+  tuple->size_ = size;
+  tuple->rid_ = rid;
+  tuple->allocated_ = true;
+  WriteRows(layout, {slot}, layout.all_columns_, {0}, tuple->data_);
+}
+
+void PaxPage::ReleaseVarchars(const PaxLayout &layout, uint32_t slot) {
+  for (auto column_idx : layout.schema_.GetUnlinedColumns()) {
+    VarcharEntry *entry = GetVarchar(layout, column_idx, slot);
+    if (entry->length_ != BUSTUB_VALUE_NULL) {
+      SetVarBytes(GetVarBytes() - Toast::StoredBytes(entry->length_));
+      *entry = VarcharEntry{0, BUSTUB_VALUE_NULL};
+    }
+  }
+}
+
+void PaxPage::CompactHeap(const PaxLayout &layout) {
+  char heap[BUSTUB_PAGE_SIZE];
+  uint32_t free_space_pointer = BUSTUB_PAGE_SIZE;
+  const uint64_t *present = Bitmap(layout.present_offset_);
+  for (uint32_t slot = 0; slot < GetTupleCount(); slot++) {
+    if (!TestBit(present, slot)) {
+      continue;
+    }
+    for (auto column_idx : layout.schema_.GetUnlinedColumns()) {
+      VarcharEntry *entry = GetVarchar(layout, column_idx, slot);
+      if (entry->length_ != BUSTUB_VALUE_NULL) {
+        free_space_pointer -= Toast::StoredBytes(entry->length_);
+        memcpy(heap + free_space_pointer, GetData() + entry->offset_, Toast::StoredBytes(entry->length_));
+        entry->offset_ = free_space_pointer;
+      }
+    }
+  }
+  memcpy(GetData() + free_space_pointer, heap + free_space_pointer, BUSTUB_PAGE_SIZE - free_space_pointer);
+  SetFreeSpacePointer(free_space_pointer);
+}
+
+/** copy the values of slots into their rows, for a column of W bytes */
+template <uint32_t W>
+static void ScatterColumn(const char *values, const std::vector<uint32_t> &slots,
+                          const std::vector<uint32_t> &row_offsets, uint32_t column_offset, char *out) {
+  for (size_t i = 0; i < slots.size(); i++) {
+    memcpy(out + row_offsets[i] + column_offset, values + slots[i] * W, W);
+  }
+}
+
+void PaxPage::WriteRows(const PaxLayout &layout, const std::vector<uint32_t> &slots,
+                        const std::vector<bool> &referenced, const std::vector<uint32_t> &row_offsets, char *out) {
+  const Schema &schema = layout.schema_;
+  for (auto row_offset : row_offsets) {
+    memset(out + row_offset, 0, schema.GetLength());
+  }
+  // 定长列一列一列地拷
+  for (uint32_t i = 0; i < layout.minipages_.size(); i++) {
+    const auto &col = schema.GetColumn(i);
+    if (!col.IsInlined() || !referenced[i]) {
+      continue;
+    }
+    const char *values = GetData() + layout.minipages_[i].values_offset_;
+    switch (layout.minipages_[i].width_) {
+      case 1:
+        ScatterColumn<1>(values, slots, row_offsets, col.GetOffset(), out);
+        break;
+      case 2:
+        ScatterColumn<2>(values, slots, row_offsets, col.GetOffset(), out);
+        break;
+      case 4:
+        ScatterColumn<4>(values, slots, row_offsets, col.GetOffset(), out);
+        break;
+      case 8:
+        ScatterColumn<8>(values, slots, row_offsets, col.GetOffset(), out);
+        break;
+      default:
+        UNREACHABLE("Unexpected column width.");
+    }
+  }
+  // 变长数据按列的顺序接在每行定长部分的后面; 没用到的列只放一个 NULL 长度
+  if (schema.GetUnlinedColumns().empty()) {
+    return;
+  }
+  for (size_t r = 0; r < slots.size(); r++) {
+    char *row = out + row_offsets[r];
+    uint32_t tail = schema.GetLength();
+    for (auto column_idx : schema.GetUnlinedColumns()) {
+      const VarcharEntry *entry = GetVarchar(layout, column_idx, slots[r]);
+      uint32_t length = referenced[column_idx] ? entry->length_ : BUSTUB_VALUE_NULL;
+      memcpy(row + schema.GetColumn(column_idx).GetOffset(), &tail, sizeof(uint32_t));
+      memcpy(row + tail, &length, sizeof(uint32_t));
+      tail += sizeof(uint32_t);
+      memcpy(row + tail, GetData() + entry->offset_, Toast::StoredBytes(length));
+      tail += Toast::StoredBytes(length);
+    }
+  }
+}
+
+auto PaxPage::RowSize(const PaxLayout &layout, uint32_t slot, const std::vector<bool> &referenced) -> uint32_t {
+  uint32_t size = layout.row_overhead_;
+  for (auto column_idx : layout.schema_.GetUnlinedColumns()) {
+    if (referenced[column_idx]) {
+      size += Toast::StoredBytes(GetVarchar(layout, column_idx, slot)->length_);
+    }
+  }
+  return size;
+}
+
+auto PaxPage::LockForWrite(const RID &rid, Transaction *txn, LockManager *lock_manager) -> bool {
+  if (txn->IsSharedLocked(rid)) {
+    return lock_manager->LockUpgrade(txn, rid);
+  }
+  return txn->IsExclusiveLocked(rid) || lock_manager->LockExclusive(txn, rid);
+}
+
+void PaxPage::AppendLog(LogRecord *log_record, Transaction *txn, LogManager *log_manager) {
+  lsn_t lsn = log_manager->AppendLogRecord(log_record);
+  SetLSN(lsn);
+  txn->SetPrevLSN(lsn);
+}
+
+}  // namespace bustub
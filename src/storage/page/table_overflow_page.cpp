@@ -0,0 +1,35 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_overflow_page.cpp
+//
+// Identification: src/storage/page/table_overflow_page.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstring>
+
+#include "storage/page/table_overflow_page.h"
+
+namespace bustub {
+
+void TableOverflowPage::Init(page_id_t page_id) {
+  page_id_ = page_id;
+  next_page_id_ = INVALID_PAGE_ID;
+  data_len_ = 0;
+}
+
+void TableOverflowPage::Load(std::string *out) const { out->append(Data(), static_cast<size_t>(data_len_)); }
+
+auto TableOverflowPage::Store(std::string_view data) -> size_t {
+  size_t len = std::min<size_t>(data.size(), TABLE_OVERFLOW_PAGE_DATA_SIZE);
+  memcpy(Data(), data.data(), len);
+  data_len_ = static_cast<int32_t>(len);
+  return len;
+}
+
+}  // namespace bustub
@@ -33,6 +33,7 @@ void TablePage::Init(page_id_t page_id, uint32_t page_size, page_id_t prev_page_
   SetNextPageId(INVALID_PAGE_ID);
   SetFreeSpacePointer(page_size);
   SetTupleCount(0);
+  SetFsmPageId(INVALID_PAGE_ID);
 }
 
 auto TablePage::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, LockManager *lock_manager,
@@ -85,6 +86,21 @@ auto TablePage::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, Lock
   return true;
 }
 
+auto TablePage::AppendTuple(const char *data, uint32_t size, RID *rid) -> bool {
+  BUSTUB_ASSERT(size > 0, "Cannot have empty tuples.");
+  if (GetFreeSpaceRemaining() < size + SIZE_TUPLE) {
+    return false;
+  }
+  uint32_t slot = GetTupleCount();
+  SetFreeSpacePointer(GetFreeSpacePointer() - size);
+  memcpy(GetData() + GetFreeSpacePointer(), data, size);
+  SetTupleOffsetAtSlot(slot, GetFreeSpacePointer());
+  SetTupleSize(slot, size);
+  SetTupleCount(slot + 1);
+  rid->Set(GetTablePageId(), slot);
+  return true;
+}
+
 auto TablePage::MarkDelete(const RID &rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager)
     -> bool {
   uint32_t slot_num = rid.GetSlotNum();
@@ -198,7 +214,7 @@ auto TablePage::UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID
   return true;
 }
 
-void TablePage::ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_manager) {
+void TablePage::ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_manager, Tuple *deleted_tuple) {
   uint32_t slot_num = rid.GetSlotNum();
   BUSTUB_ASSERT(slot_num < GetTupleCount(), "Cannot have more slots than tuples.");
 
@@ -226,6 +242,9 @@ void TablePage::ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_ma
     SetLSN(lsn);
     txn->SetPrevLSN(lsn);
   }
+  if (deleted_tuple != nullptr) {
+    *deleted_tuple = delete_tuple;
+  }
 
   uint32_t free_space_pointer = GetFreeSpacePointer();
   BUSTUB_ASSERT(tuple_offset >= free_space_pointer, "Free space appears before tuples.");
@@ -306,6 +325,16 @@ auto TablePage::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockMan
   return true;
 }
 
+void TablePage::GetTupleViews(const char *data, std::vector<TupleView> *views) {
+  page_id_t page_id = GetTablePageId();
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    uint32_t tuple_size = GetTupleSize(i);
+    if (!IsDeleted(tuple_size)) {
+      views->emplace_back(RID(page_id, i), data + GetTupleOffsetAtSlot(i), tuple_size);
+    }
+  }
+}
+
 auto TablePage::GetFirstTupleRid(RID *first_rid) -> bool {
   // Find and return the first valid tuple.
   for (uint32_t i = 0; i < GetTupleCount(); ++i) {
@@ -331,4 +360,23 @@ auto TablePage::GetNextTupleRid(const RID &cur_rid, RID *next_rid) -> bool {
   next_rid->Set(INVALID_PAGE_ID, 0);
   return false;
 }
+
+auto TablePage::Compact() -> uint32_t {
+  uint32_t tuple_count = GetTupleCount();
+  while (tuple_count > 0 && GetTupleSize(tuple_count - 1) == 0) {
+    tuple_count--;
+  }
+  uint32_t freed = (GetTupleCount() - tuple_count) * SIZE_TUPLE;
+  SetTupleCount(tuple_count);
+  return freed;
+}
+
+auto TablePage::HasMarkedDeletes() -> bool {
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    if ((GetTupleSize(i) & DELETE_MASK) != 0) {
+      return true;
+    }
+  }
+  return false;
+}
 }  // namespace bustub
@@ -0,0 +1,97 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tmp_tuple_page.cpp
+//
+// Identification: src/storage/page/tmp_tuple_page.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstring>
+
+#include "storage/page/tmp_tuple_page.h"
+
+namespace bustub {
+
+void TmpTuplePage::Init(page_id_t page_id, uint32_t page_size) {
+  memcpy(GetData(), &page_id, sizeof(page_id_t));
+  lsn_t lsn = INVALID_LSN;
+  memcpy(GetData() + OFFSET_LSN, &lsn, sizeof(lsn_t));
+  SetFreeSpacePointer(page_size);
+}
+
+auto TmpTuplePage::GetTablePageId() -> page_id_t { return *reinterpret_cast<page_id_t *>(GetData()); }
+
+auto TmpTuplePage::Insert(const Tuple &tuple, TmpTuple *out) -> bool {
+  uint32_t offset;
+  if (!Allocate(tuple.GetLength(), &offset)) {
+    return false;
+  }
+  tuple.SerializeTo(GetData() + offset);
+  *out = TmpTuple(GetTablePageId(), offset);
+  return true;
+}
+
+auto TmpTuplePage::InsertWithRid(const Tuple &tuple, TmpTuple *out) -> bool {
+  uint32_t size = sizeof(int64_t) + tuple.GetLength();
+  uint32_t offset;
+  if (!Allocate(size, &offset)) {
+    return false;
+  }
+  int64_t rid = tuple.GetRid().Get();
+  memcpy(GetData() + offset, &size, sizeof(uint32_t));
+  memcpy(GetData() + offset + sizeof(uint32_t), &rid, sizeof(int64_t));
+  memcpy(GetData() + offset + sizeof(uint32_t) + sizeof(int64_t), tuple.GetData(), tuple.GetLength());
+  *out = TmpTuple(GetTablePageId(), offset);
+  return true;
+}
+
+auto TmpTuplePage::Allocate(uint32_t size, uint32_t *offset) -> bool {
+  uint32_t free_space_pointer = GetFreeSpacePointer();
+  if (free_space_pointer < SIZE_TMP_PAGE_HEADER + sizeof(uint32_t) + size) {
+    return false;
+  }
+  free_space_pointer -= sizeof(uint32_t) + size;
+  SetFreeSpacePointer(free_space_pointer);
+  *offset = free_space_pointer;
+  return true;
+}
+
+auto TmpTuplePage::GetTupleOffsets() -> std::vector<uint32_t> {
+  std::vector<uint32_t> offsets;
+  // 从最后插入的往页尾走, 每个 tuple 的长度在它前面
+  for (uint32_t offset = GetFreeSpacePointer(); offset < BUSTUB_PAGE_SIZE;) {
+    offsets.push_back(offset);
+    offset += sizeof(uint32_t) + *reinterpret_cast<uint32_t *>(GetData() + offset);
+  }
+  std::reverse(offsets.begin(), offsets.end());
+  return offsets;
+}
+
+auto TmpTuplePage::GetTupleData(uint32_t offset, uint32_t *size) -> const char * {
+  *size = *reinterpret_cast<uint32_t *>(GetData() + offset);
+  return GetData() + offset + sizeof(uint32_t);
+}
+
+auto TmpTuplePage::GetTupleWithRid(uint32_t offset, RID *rid, uint32_t *size) -> const char * {
+  const char *data = GetTupleData(offset, size);
+  int64_t value;
+  memcpy(&value, data, sizeof(int64_t));
+  *rid = RID(value);
+  *size -= sizeof(int64_t);
+  return data + sizeof(int64_t);
+}
+
+auto TmpTuplePage::GetFreeSpacePointer() -> uint32_t {
+  return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE);
+}
+
+void TmpTuplePage::SetFreeSpacePointer(uint32_t free_space_pointer) {
+  memcpy(GetData() + OFFSET_FREE_SPACE, &free_space_pointer, sizeof(uint32_t));
+}
+
+}  // namespace bustub
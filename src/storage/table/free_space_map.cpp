@@ -0,0 +1,193 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.cpp
+//
+// Identification: src/storage/table/free_space_map.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/free_space_map.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+FreeSpaceMap::FreeSpaceMap(BufferPoolManager *bpm) : bpm_(bpm) {
+  page_id_t page_id;
+  auto *page = reinterpret_cast<FreeSpaceMapPage *>(bpm_->NewPage(&page_id)->GetData());
+  page->Init();
+  bpm_->UnpinPage(page_id, true);
+  fsm_page_ids_.push_back(page_id);
+}
+
+FreeSpaceMap::FreeSpaceMap(BufferPoolManager *bpm, page_id_t first_page_id) : bpm_(bpm) {
+  // 整条链读进内存, 之后查找和修改都不用遍历
+  std::vector<uint8_t> categories;
+  for (page_id_t page_id = first_page_id; page_id != INVALID_PAGE_ID;) {
+    auto *page = reinterpret_cast<FreeSpaceMapPage *>(bpm_->FetchPage(page_id)->GetData());
+    for (uint32_t i = 0; i < page->GetCount(); i++) {
+      if (page->GetHeapPageId(i) != INVALID_PAGE_ID) {
+        slots_[page->GetHeapPageId(i)] = heap_page_ids_.size();
+      }
+      heap_page_ids_.push_back(page->GetHeapPageId(i));
+      categories.push_back(page->GetCategory(i));
+    }
+    fsm_page_ids_.push_back(page_id);
+    page_id_t next_page_id = page->GetNextPageId();
+    bpm_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  Reserve(categories.size());
+  std::copy(categories.begin(), categories.end(), tree_.begin() + capacity_);
+  for (size_t j = capacity_ - 1; j > 0; j--) {
+    tree_[j] = std::max(tree_[2 * j], tree_[2 * j + 1]);
+  }
+}
+
+auto FreeSpaceMap::ToCategory(uint32_t free_bytes) -> uint8_t {
+  return static_cast<uint8_t>(std::min<uint32_t>(free_bytes / FSM_CATEGORY_SIZE, UINT8_MAX));
+}
+
+auto FreeSpaceMap::NeededCategory(uint32_t bytes) -> uint32_t {
+  return (bytes + FSM_CATEGORY_SIZE - 1) / FSM_CATEGORY_SIZE;
+}
+
+void FreeSpaceMap::Reserve(size_t n) {
+  if (n <= capacity_) {
+    return;
+  }
+  size_t capacity = std::max<size_t>(capacity_, 64);
+  while (capacity < n) {
+    capacity *= 2;
+  }
+  std::vector<uint8_t> tree(2 * capacity, 0);
+  std::copy(tree_.begin() + capacity_, tree_.end(), tree.begin() + capacity);
+  for (size_t j = capacity - 1; j > 0; j--) {
+    tree[j] = std::max(tree[2 * j], tree[2 * j + 1]);
+  }
+  tree_ = std::move(tree);
+  capacity_ = capacity;
+}
+
+void FreeSpaceMap::SetLeaf(size_t i, uint8_t category) {
+  size_t j = capacity_ + i;
+  tree_[j] = category;
+  for (j /= 2; j > 0; j /= 2) {
+    tree_[j] = std::max(tree_[2 * j], tree_[2 * j + 1]);
+  }
+}
+
+void FreeSpaceMap::SetCategory(size_t i, uint8_t category) {
+  SetLeaf(i, category);
+  page_id_t page_id = fsm_page_ids_[i / FSM_PAGE_CAPACITY];
+  auto *page = reinterpret_cast<FreeSpaceMapPage *>(bpm_->FetchPage(page_id)->GetData());
+  page->SetCategory(i % FSM_PAGE_CAPACITY, category);
+  bpm_->UnpinPage(page_id, true);
+}
+
+void FreeSpaceMap::AddPage(page_id_t heap_page_id, uint32_t free_bytes) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  size_t i = heap_page_ids_.size();
+  uint8_t category = ToCategory(free_bytes);
+
+  // 最后一页满了就在链尾接一页
+  page_id_t page_id = fsm_page_ids_.back();
+  auto *page = reinterpret_cast<FreeSpaceMapPage *>(bpm_->FetchPage(page_id)->GetData());
+  if (page->IsFull()) {
+    page_id_t new_page_id;
+    auto *new_page = reinterpret_cast<FreeSpaceMapPage *>(bpm_->NewPage(&new_page_id)->GetData());
+    new_page->Init();
+    page->SetNextPageId(new_page_id);
+    bpm_->UnpinPage(page_id, true);
+    fsm_page_ids_.push_back(new_page_id);
+    page_id = new_page_id;
+    page = new_page;
+  }
+  page->Append(heap_page_id, category);
+  bpm_->UnpinPage(page_id, true);
+
+  heap_page_ids_.push_back(heap_page_id);
+  slots_[heap_page_id] = i;
+  Reserve(i + 1);
+  SetLeaf(i, category);
+}
+
+void FreeSpaceMap::RemovePage(page_id_t heap_page_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto it = slots_.find(heap_page_id);
+  BUSTUB_ASSERT(it != slots_.end(), "page is not in the free-space map");
+  BUSTUB_ASSERT(it->second + 1 < heap_page_ids_.size(), "the last page of a heap is never removed");
+  size_t i = it->second;
+  slots_.erase(it);
+  heap_page_ids_[i] = INVALID_PAGE_ID;
+  // 墓碑的类别是 0, FindPage 永远不会找到它
+  SetLeaf(i, 0);
+  page_id_t page_id = fsm_page_ids_[i / FSM_PAGE_CAPACITY];
+  auto *page = reinterpret_cast<FreeSpaceMapPage *>(bpm_->FetchPage(page_id)->GetData());
+  page->SetHeapPageId(i % FSM_PAGE_CAPACITY, INVALID_PAGE_ID);
+  page->SetCategory(i % FSM_PAGE_CAPACITY, 0);
+  bpm_->UnpinPage(page_id, true);
+}
+
+void FreeSpaceMap::Update(page_id_t heap_page_id, uint32_t free_bytes) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto it = slots_.find(heap_page_id);
+  BUSTUB_ASSERT(it != slots_.end(), "page is not in the free-space map");
+  uint8_t category = ToCategory(free_bytes);
+  if (tree_[capacity_ + it->second] != category) {
+    SetCategory(it->second, category);
+  }
+}
+
+auto FreeSpaceMap::FindPage(uint32_t bytes) -> page_id_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  uint32_t needed = NeededCategory(bytes);
+  if (capacity_ == 0 || tree_[1] < needed) {
+    return INVALID_PAGE_ID;
+  }
+  // 从根往下, 左边够就走左边: 找到的是最靠前的有空间的页
+  size_t j = 1;
+  while (j < capacity_) {
+    j = tree_[2 * j] >= needed ? 2 * j : 2 * j + 1;
+  }
+  return heap_page_ids_[j - capacity_];
+}
+
+auto FreeSpaceMap::Contains(page_id_t heap_page_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return slots_.count(heap_page_id) != 0;
+}
+
+auto FreeSpaceMap::HasRoom(page_id_t heap_page_id, uint32_t bytes) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto it = slots_.find(heap_page_id);
+  return it != slots_.end() && tree_[capacity_ + it->second] >= NeededCategory(bytes);
+}
+
+auto FreeSpaceMap::GetLastPageId() -> page_id_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return heap_page_ids_.empty() ? INVALID_PAGE_ID : heap_page_ids_.back();
+}
+
+auto FreeSpaceMap::GetPageIds() -> std::vector<page_id_t> {
+  std::scoped_lock<std::mutex> lock(latch_);
+  std::vector<page_id_t> page_ids;
+  page_ids.reserve(slots_.size());
+  std::copy_if(heap_page_ids_.begin(), heap_page_ids_.end(), std::back_inserter(page_ids),
+               [](page_id_t page_id) { return page_id != INVALID_PAGE_ID; });
+  return page_ids;
+}
+
+auto FreeSpaceMap::GetNumPages() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return slots_.size();
+}
+
+}  // namespace bustub
@@ -0,0 +1,125 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_page_scan.cpp
+//
+// Identification: src/storage/table/parallel_page_scan.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/parallel_page_scan.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+ParallelPageScan::ParallelPageScan(TableHeap *table_heap, Transaction *txn, size_t workers, Filter filter,
+                                   std::optional<std::vector<uint32_t>> columns, std::vector<ZoneRange> ranges,
+                                   size_t morsel_pages)
+    : table_heap_(table_heap),
+      txn_(txn),
+      filter_(std::move(filter)),
+      columns_(std::move(columns)),
+      ranges_(std::move(ranges)) {
+  // 先算作读者再取页目录: 目录里的页在扫描结束前不会被 vacuum 回收
+  (*table_heap_->active_readers_)++;
+  std::vector<page_id_t> page_ids = table_heap_->GetPageDirectory();
+  morsels_ = std::vector<Morsel>((page_ids.size() + morsel_pages - 1) / morsel_pages);
+  for (size_t i = 0; i < morsels_.size(); i++) {
+    auto first = page_ids.begin() + i * morsel_pages;
+    morsels_[i].page_ids_.assign(first, first + std::min(morsel_pages, page_ids.size() - i * morsel_pages));
+  }
+  workers = std::max<size_t>(1, std::min(workers, morsels_.size()));
+  window_ = workers * SCAN_MORSELS_AHEAD_PER_WORKER;
+  for (size_t i = 0; i < workers && !morsels_.empty(); i++) {
+    workers_.emplace_back(&ParallelPageScan::Work, this);
+  }
+}
+
+ParallelPageScan::~ParallelPageScan() {
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+  (*table_heap_->active_readers_)--;
+}
+
+auto ParallelPageScan::Next(Tuple *tuple) -> bool {
+  while (current_ < morsels_.size()) {
+    Morsel &morsel = morsels_[current_];
+    if (!current_done_) {
+      std::unique_lock<std::mutex> lock(latch_);
+      cv_.wait(lock, [&] { return morsel.done_; });
+      current_done_ = true;
+      if (morsel.error_ != nullptr) {
+        std::rethrow_exception(std::exchange(morsel.error_, nullptr));
+      }
+    }
+    if (pos_ < morsel.rows_.size()) {
+      const Row &row = morsel.rows_[pos_++];
+      TupleView(row.rid_, morsel.data_.data() + row.offset_, row.size_, table_heap_->buffer_pool_manager_)
+          .CopyTo(tuple);
+      return true;
+    }
+    // 这个 morsel 读完了, 放掉它的内存, 让 worker 往后多取一个
+    std::vector<char>().swap(morsel.data_);
+    std::vector<Row>().swap(morsel.rows_);
+    {
+      std::scoped_lock<std::mutex> lock(latch_);
+      current_++;
+    }
+    cv_.notify_all();
+    pos_ = 0;
+    current_done_ = false;
+  }
+  return false;
+}
+
+void ParallelPageScan::Work() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    cv_.wait(lock, [this] { return stop_ || next_morsel_ == morsels_.size() || next_morsel_ < current_ + window_; });
+    if (stop_ || next_morsel_ == morsels_.size()) {
+      return;
+    }
+    Morsel *morsel = &morsels_[next_morsel_++];
+    lock.unlock();
+    ScanMorsel(morsel);
+    lock.lock();
+    morsel->done_ = true;
+    cv_.notify_all();
+  }
+}
+
+void ParallelPageScan::ScanMorsel(Morsel *morsel) {
+  try {
+    TablePageScan scan(table_heap_, txn_, std::move(morsel->page_ids_), columns_, ranges_);
+    Tuple tuple;
+    while (scan.NextPage()) {
+      for (const auto &view : scan.GetViews()) {
+        if (filter_ != nullptr) {
+          view.CopyTo(&tuple);
+          if (!filter_(tuple)) {
+            continue;
+          }
+        }
+        morsel->rows_.push_back({view.GetRid(), morsel->data_.size(), view.GetLength()});
+        morsel->data_.insert(morsel->data_.end(), view.GetData(), view.GetData() + view.GetLength());
+      }
+    }
+  } catch (...) {
+    morsel->error_ = std::current_exception();
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,112 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// spill_run.cpp
+//
+// Identification: src/storage/table/spill_run.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/spill_run.h"
+
+#include <algorithm>
+#include <string>
+
+#include "common/exception.h"
+#include "storage/table/tuple_view.h"
+
+namespace bustub {
+
+SpillRun::~SpillRun() {
+  Finish();
+  for (page_id_t page_id : page_ids_) {
+    bpm_->DeletePage(page_id);  // 已经换出到磁盘的页不在池里, 删不掉也没关系, 页号不会再被用
+  }
+}
+
+void SpillRun::Append(const Tuple &tuple) {
+  if (tuple.GetLength() > TmpTuplePage::MaxTupleWithRidSize(BUSTUB_PAGE_SIZE)) {
+    throw Exception(ExceptionType::OUT_OF_RANGE,
+                    "a tuple of " + std::to_string(tuple.GetLength()) + " bytes does not fit in a spill page");
+  }
+  TmpTuple location(INVALID_PAGE_ID, 0);
+  if (page_ != nullptr && page_->InsertWithRid(tuple, &location)) {
+    tuple_count_++;
+    return;
+  }
+  Finish();
+  page_id_t page_id;
+  page_ = reinterpret_cast<TmpTuplePage *>(bpm_->NewPage(&page_id));
+  if (page_ == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame in the buffer pool for a spill page");
+  }
+  page_->Init(page_id, BUSTUB_PAGE_SIZE);
+  page_ids_.push_back(page_id);
+  page_->InsertWithRid(tuple, &location);
+  tuple_count_++;
+}
+
+void SpillRun::Finish() {
+  if (page_ != nullptr) {
+    bpm_->UnpinPage(page_->GetTablePageId(), true);
+    page_ = nullptr;
+  }
+}
+
+SpillRunReader::SpillRunReader(SpillRun *run, size_t read_ahead) : run_(run), read_ahead_(read_ahead) {
+  run_->Finish();
+  FetchAhead();
+}
+
+SpillRunReader::~SpillRunReader() {
+  if (page_ != nullptr) {
+    run_->bpm_->UnpinPage(page_->GetTablePageId(), false);
+  }
+  for (auto &fetch : ahead_) {
+    if (Page *page = fetch.get(); page != nullptr) {
+      run_->bpm_->UnpinPage(page->GetPageId(), false);
+    }
+  }
+}
+
+auto SpillRunReader::Next(Tuple *tuple) -> bool {
+  while (pos_ == offsets_.size()) {
+    if (page_ != nullptr) {
+      run_->bpm_->UnpinPage(page_->GetTablePageId(), false);
+      page_ = nullptr;
+    }
+    if (ahead_.empty()) {
+      return false;
+    }
+    Page *page = ahead_.front().get();
+    ahead_.pop_front();
+    FetchAhead();
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame in the buffer pool to read a spill page");
+    }
+    page_ = reinterpret_cast<TmpTuplePage *>(page);
+    offsets_ = page_->GetTupleOffsets();
+    pos_ = 0;
+  }
+  RID rid;
+  uint32_t size;
+  const char *data = page_->GetTupleWithRid(offsets_[pos_++], &rid, &size);
+  TupleView(rid, data, size, run_->bpm_).CopyTo(tuple);
+  return true;
+}
+
+void SpillRunReader::FetchAhead() {
+  // 不预读时也先排一个, 取的时候才去 fetch
+  auto policy = read_ahead_ == 0 ? std::launch::deferred : std::launch::async;
+  while (ahead_.size() < std::max<size_t>(read_ahead_, 1) && next_fetch_ < run_->page_ids_.size()) {
+    ahead_.push_back(std::async(policy, [bpm = run_->bpm_, page_id = run_->page_ids_[next_fetch_]] {
+      return bpm->FetchPage(page_id);
+    }));
+    next_fetch_++;
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,131 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_bulk_loader.cpp
+//
+// Identification: src/storage/table/table_bulk_loader.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/table_bulk_loader.h"
+
+#include <mutex>  // NOLINT
+#include <utility>
+
+#include "storage/table/table_heap.h"
+#include "storage/table/toast.h"
+
+namespace bustub {
+
+TableBulkLoader::TableBulkLoader(TableHeap *table_heap, Transaction *txn) : table_heap_(table_heap), txn_(txn) {}
+
+TableBulkLoader::~TableBulkLoader() {
+  if (finished_) {
+    return;
+  }
+  // 没有 Finish: 这些页还没挂到堆上, 直接删掉
+  ClosePage();
+  for (auto page_id : page_ids_) {
+    table_heap_->buffer_pool_manager_->DeletePage(page_id);
+  }
+  for (auto page_id : chains_) {
+    Toast::DeleteChain(table_heap_->buffer_pool_manager_, page_id);
+  }
+}
+
+auto TableBulkLoader::Append(const char *data, uint32_t size, RID *rid) -> bool {
+  BUSTUB_ASSERT(!finished_, "the load is finished");
+  // 长的值先存到行外, 页里放的是换成指针之后的 tuple
+  if (const Schema *schema = table_heap_->toast_schema_.get(); schema != nullptr) {
+    size_t chain_count = chains_.size();
+    if (!Toast::StoreLongValues(table_heap_->buffer_pool_manager_, *schema, data, size, &toasted_, &chains_)) {
+      return false;
+    }
+    if (chains_.size() != chain_count) {
+      data = toasted_.GetData();
+      size = toasted_.GetLength();
+    }
+  }
+  ZoneMap *zone_map = table_heap_->zone_map_.get();
+  if (page_ != nullptr && table_heap_->AppendTo(page_, data, size, rid)) {
+    if (zone_map != nullptr) {
+      zone_map->Widen(&zones_.back(), data);
+    }
+    return true;
+  }
+  page_id_t page_id;
+  auto new_page = static_cast<TablePage *>(table_heap_->buffer_pool_manager_->NewPage(&page_id));
+  if (new_page == nullptr) {
+    return false;
+  }
+  // prev 先指向上一个新页, 第一页的 prev 在 Finish 里接到堆的最后一页
+  page_id_t prev_page_id = page_ids_.empty() ? INVALID_PAGE_ID : page_ids_.back();
+  table_heap_->InitPage(new_page, page_id, prev_page_id, txn_);
+  if (page_ != nullptr) {
+    page_->SetNextPageId(page_id);
+  }
+  ClosePage();
+  page_ = new_page;
+  page_ids_.push_back(page_id);
+  bool appended = table_heap_->AppendTo(page_, data, size, rid);
+  BUSTUB_ASSERT(appended, "an empty page must hold the tuple");
+  if (zone_map != nullptr) {
+    zones_.push_back(zone_map->MakeZone());
+    zone_map->Widen(&zones_.back(), data);
+  }
+  return true;
+}
+
+void TableBulkLoader::ClosePage() {
+  if (page_ == nullptr) {
+    return;
+  }
+  free_bytes_.push_back(table_heap_->FreeSpaceOf(page_));
+  table_heap_->buffer_pool_manager_->UnpinPage(page_->GetTablePageId(), true);
+  page_ = nullptr;
+}
+
+void TableBulkLoader::Finish() {
+  BUSTUB_ASSERT(!finished_, "the load is finished");
+  ClosePage();
+  finished_ = true;
+  if (page_ids_.empty()) {
+    return;
+  }
+  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+  // tuple 没有写日志, 开了日志时先把页刷到盘上, 再让堆指向它们
+  if (enable_logging) {
+    for (auto page_id : page_ids_) {
+      buffer_pool_manager->FlushPage(page_id);
+    }
+  }
+
+  // 和 TableHeap::AppendPageAndInsert 一样在 append_latch_ 下接到最后一页后面
+  std::scoped_lock<std::mutex> lock(table_heap_->append_latch_);
+  FreeSpaceMap *fsm = table_heap_->fsm_.get();
+  page_id_t last_page_id = fsm->GetLastPageId();
+  auto last_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(last_page_id));
+  auto first_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(page_ids_.front()));
+  BUSTUB_ASSERT(last_page != nullptr && first_page != nullptr, "all pages are pinned");
+  first_page->WLatch();
+  first_page->SetPrevPageId(last_page_id);
+  first_page->WUnlatch();
+  buffer_pool_manager->UnpinPage(page_ids_.front(), true);
+  last_page->WLatch();
+  last_page->SetNextPageId(page_ids_.front());
+  last_page->WUnlatch();
+  buffer_pool_manager->UnpinPage(last_page_id, true);
+  for (size_t i = 0; i < page_ids_.size(); i++) {
+    fsm->AddPage(page_ids_[i], free_bytes_[i]);
+  }
+  if (ZoneMap *zone_map = table_heap_->zone_map_.get(); zone_map != nullptr) {
+    for (size_t i = 0; i < page_ids_.size(); i++) {
+      zone_map->AddPage(page_ids_[i], std::move(zones_[i]));
+    }
+  }
+}
+
+}  // namespace bustub
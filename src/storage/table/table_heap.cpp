@@ -11,87 +11,213 @@
 //===----------------------------------------------------------------------===//
 
 #include <cassert>
+#include <utility>
 
 #include "common/logger.h"
 #include "storage/table/table_heap.h"
+#include "storage/table/toast.h"
 
 namespace bustub {
 
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-                     page_id_t first_page_id)
+                     page_id_t first_page_id, const Schema *pax_schema)
     : buffer_pool_manager_(buffer_pool_manager),
       lock_manager_(lock_manager),
       log_manager_(log_manager),
-      first_page_id_(first_page_id) {}
+      first_page_id_(first_page_id) {
+  if (pax_schema != nullptr) {
+    pax_layout_ = std::make_unique<PaxLayout>(*pax_schema);
+  }
+  auto first_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+  first_page->WLatch();
+  bool has_fsm = first_page->GetFsmPageId() != INVALID_PAGE_ID;
+  if (has_fsm) {
+    fsm_ = std::make_unique<FreeSpaceMap>(buffer_pool_manager_, first_page->GetFsmPageId());
+  } else {
+    fsm_ = std::make_unique<FreeSpaceMap>(buffer_pool_manager_);
+    first_page->SetFsmPageId(fsm_->GetFirstPageId());
+  }
+  first_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(first_page_id_, !has_fsm);
+
+  // 地图可能落后于堆 (以前没有地图的表, 崩溃前没来得及写下去的地图页), 从它记得的最后一页往后补上
+  page_id_t page_id = fsm_->GetLastPageId();
+  bool known = page_id != INVALID_PAGE_ID;
+  if (!known) {
+    page_id = first_page_id_;
+  }
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    page->RLatch();
+    uint32_t free_bytes = FreeSpaceOf(page);
+    page_id_t next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    if (!known) {
+      fsm_->AddPage(page_id, free_bytes);
+    }
+    known = false;
+    page_id = next_page_id;
+  }
+}
 
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-                     Transaction *txn)
+                     Transaction *txn, const Schema *pax_schema)
     : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager), log_manager_(log_manager) {
+  if (pax_schema != nullptr) {
+    pax_layout_ = std::make_unique<PaxLayout>(*pax_schema);
+  }
   // Initialize the first table page.
   printf("TableHeap::TableHeap first_page_id_=%d\n", first_page_id_);
   auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(&first_page_id_));
   BUSTUB_ASSERT(first_page != nullptr,
                 "Couldn't create a page for the table heap. Have you completed the buffer pool manager project?");
   first_page->WLatch();
-  first_page->Init(first_page_id_, BUSTUB_PAGE_SIZE, INVALID_LSN, log_manager_, txn);
+  InitPage(first_page, first_page_id_, INVALID_LSN, txn);
+  fsm_ = std::make_unique<FreeSpaceMap>(buffer_pool_manager_);
+  fsm_->AddPage(first_page_id_, FreeSpaceOf(first_page));
+  first_page->SetFsmPageId(fsm_->GetFirstPageId());
   first_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(first_page_id_, true);
 }
 
 auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> bool {
-  if (tuple.size_ + 32 > BUSTUB_PAGE_SIZE) {  // larger than one page size
+  std::vector<page_id_t> chains;
+  Tuple toasted;
+  if (toast_schema_ != nullptr &&
+      !Toast::StoreLongValues(buffer_pool_manager_, *toast_schema_, tuple.data_, tuple.size_, &toasted, &chains)) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
+  // 长的值存到行外之后才看放不放得下
+  if (!chains.empty()) {
+    bool inserted = InsertStoredTuple(toasted, rid, txn);
+    if (!inserted) {
+      for (auto page_id : chains) {
+        Toast::DeleteChain(buffer_pool_manager_, page_id);
+      }
+    }
+    return inserted;
+  }
+  return InsertStoredTuple(tuple, rid, txn);
+}
 
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  if (cur_page == nullptr) {
+auto TableHeap::InsertStoredTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> bool {
+  if (tuple.size_ > MaxTupleSize()) {  // larger than one page size
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
+  uint32_t needed = TablePage::SpaceForTuple(tuple.size_);
+  // 地图给的页可能正被 vacuum 摘掉, 插入结束前它不能被释放
+  (*active_readers_)++;
+
+  // 每个线程记着上次插入的页, 连续插入时直接回到这一页, 不用查地图
+  static thread_local std::pair<const TableHeap *, page_id_t> last_insert_page{nullptr, INVALID_PAGE_ID};
+  page_id_t page_id = INVALID_PAGE_ID;
+  if (last_insert_page.first == this && fsm_->HasRoom(last_insert_page.second, needed)) {
+    page_id = last_insert_page.second;
+  }
 
-  cur_page->WLatch();
-  // Insert into the first page with enough space. If no such page exists, create a new page and insert into that.
-  // INVARIANT: cur_page is WLatched if you leave the loop normally.
-  while (!cur_page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_)) {
-    auto next_page_id = cur_page->GetNextPageId();
-    // If the next page is a valid page,
-    if (next_page_id != INVALID_PAGE_ID) {
-      // Unlatch and unpin the current page.
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
-      // And repeat the process with the next page.
-      cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
-      cur_page->WLatch();
-    } else {
-      // Otherwise we have run out of valid pages. We need to create a new page.
-      auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&next_page_id));
-      // If we could not create a new page,
-      if (new_page == nullptr) {
-        // Then life sucks and we abort the transaction.
-        cur_page->WUnlatch();
-        buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
+  // 地图说有空间的页不一定真有 (别的线程刚插过, 崩溃后地图没更新), 插不进就更正地图再找
+  while (true) {
+    if (page_id == INVALID_PAGE_ID) {
+      page_id = fsm_->FindPage(needed);
+    }
+    // 哪一页都放不下, 在最后接一页新的
+    if (page_id == INVALID_PAGE_ID) {
+      if (!AppendPageAndInsert(tuple, rid, txn)) {
+        (*active_readers_)--;
         txn->SetState(TransactionState::ABORTED);
         return false;
       }
-      // Otherwise we were able to create a new page. We initialize it now.
-      new_page->WLatch();
-      cur_page->SetNextPageId(next_page_id);
-      new_page->Init(next_page_id, BUSTUB_PAGE_SIZE, cur_page->GetTablePageId(), log_manager_, txn);
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
-      cur_page = new_page;
-    }
-  }
-  // This line has caused most of us to double-take and "whoa double unlatch".
-  // We are not, in fact, double unlatching. See the invariant above.
-  cur_page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
+      break;
+    }
+    auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (cur_page == nullptr) {
+      (*active_readers_)--;
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    cur_page->WLatch();
+    // vacuum 在页的写锁下把页从地图里去掉: 不在地图里的页已经摘出了堆, 重新找
+    bool in_heap = fsm_->Contains(page_id);
+    bool inserted = in_heap && InsertInto(cur_page, tuple, rid, txn);
+    if (inserted && zone_map_ != nullptr) {
+      zone_map_->Widen(page_id, tuple.GetData());
+    }
+    if (in_heap) {
+      fsm_->Update(page_id, FreeSpaceOf(cur_page));
+    }
+    cur_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, inserted);
+    if (inserted) {
+      break;
+    }
+    page_id = INVALID_PAGE_ID;
+  }
+  (*active_readers_)--;
+  last_insert_page = {this, rid->GetPageId()};
   // Update the transaction's write set.
   txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
   return true;
 }
 
+auto TableHeap::AppendPageAndInsert(const Tuple &tuple, RID *rid, Transaction *txn) -> bool {
+  std::scoped_lock<std::mutex> lock(append_latch_);
+  // 等锁的时候别的线程可能已经接了一页, 先试最后一页
+  page_id_t last_page_id = fsm_->GetLastPageId();
+  auto last_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(last_page_id));
+  if (last_page == nullptr) {
+    return false;
+  }
+  last_page->WLatch();
+  if (InsertInto(last_page, tuple, rid, txn)) {
+    if (zone_map_ != nullptr) {
+      zone_map_->Widen(last_page_id, tuple.GetData());
+    }
+    fsm_->Update(last_page_id, FreeSpaceOf(last_page));
+    last_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(last_page_id, true);
+    return true;
+  }
+
+  // 先用 vacuum 摘下来的空页, 没有再向缓冲池要新页
+  page_id_t new_page_id;
+  TablePage *new_page;
+  if (!free_page_ids_.empty()) {
+    new_page_id = free_page_ids_.back();
+    new_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(new_page_id));
+    if (new_page != nullptr) {
+      free_page_ids_.pop_back();
+    }
+  } else {
+    new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&new_page_id));
+  }
+  // If we could not create a new page, then life sucks and we abort the transaction.
+  if (new_page == nullptr) {
+    last_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(last_page_id, false);
+    return false;
+  }
+  new_page->WLatch();
+  last_page->SetNextPageId(new_page_id);
+  InitPage(new_page, new_page_id, last_page_id, txn);
+  last_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(last_page_id, true);
+  // 空页一定放得下, 见 InsertTuple 开头的大小检查
+  bool inserted = InsertInto(new_page, tuple, rid, txn);
+  BUSTUB_ASSERT(inserted, "an empty page must hold the tuple");
+  fsm_->AddPage(new_page_id, FreeSpaceOf(new_page));
+  if (zone_map_ != nullptr) {
+    PageZone zone = zone_map_->MakeZone();
+    zone_map_->Widen(&zone, tuple.GetData());
+    zone_map_->AddPage(new_page_id, std::move(zone));
+  }
+  new_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(new_page_id, true);
+  return true;
+}
+
 auto TableHeap::MarkDelete(const RID &rid, Transaction *txn) -> bool {
   // TODO(Amadou): remove empty page
   // Find the page which contains the tuple.
@@ -103,7 +229,11 @@ auto TableHeap::MarkDelete(const RID &rid, Transaction *txn) -> bool {
   }
   // Otherwise, mark the tuple as deleted.
   page->WLatch();
-  page->MarkDelete(rid, txn, lock_manager_, log_manager_);
+  if (pax_layout_ != nullptr) {
+    static_cast<PaxPage *>(page)->MarkDelete(*pax_layout_, rid, txn, lock_manager_, log_manager_);
+  } else {
+    page->MarkDelete(rid, txn, lock_manager_, log_manager_);
+  }
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
   // Update the transaction's write set.
@@ -119,10 +249,33 @@ auto TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
+  // 新值里长的值先存到行外; 旧值的链提交时才删 (ApplyUpdate), 回滚要把旧值放回来 (RollbackUpdate)
+  std::vector<page_id_t> chains;
+  Tuple toasted;
+  if (toast_schema_ != nullptr &&
+      !Toast::StoreLongValues(buffer_pool_manager_, *toast_schema_, tuple.data_, tuple.size_, &toasted, &chains)) {
+    buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  const Tuple &new_tuple = chains.empty() ? tuple : toasted;
   // Update the tuple; but first save the old value for rollbacks.
   Tuple old_tuple;
   page->WLatch();
-  bool is_updated = page->UpdateTuple(tuple, &old_tuple, rid, txn, lock_manager_, log_manager_);
+  bool is_updated =
+      pax_layout_ != nullptr
+          ? static_cast<PaxPage *>(page)->UpdateTuple(*pax_layout_, new_tuple, &old_tuple, rid, txn, lock_manager_,
+                                                      log_manager_)
+          : page->UpdateTuple(new_tuple, &old_tuple, rid, txn, lock_manager_, log_manager_);
+  if (is_updated && zone_map_ != nullptr) {
+    zone_map_->Widen(rid.GetPageId(), new_tuple.GetData());
+  }
+  if (!is_updated) {
+    for (auto page_id : chains) {
+      Toast::DeleteChain(buffer_pool_manager_, page_id);
+    }
+  }
+  fsm_->Update(rid.GetPageId(), FreeSpaceOf(page));
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), is_updated);
   // Update the transaction's write set.
@@ -137,11 +290,27 @@ void TableHeap::ApplyDelete(const RID &rid, Transaction *txn) {
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
   // Delete the tuple from the page.
+  Tuple deleted_tuple;
+  Tuple *deleted = toast_schema_ != nullptr ? &deleted_tuple : nullptr;
   page->WLatch();
-  page->ApplyDelete(rid, txn, log_manager_);
+  if (pax_layout_ != nullptr) {
+    static_cast<PaxPage *>(page)->ApplyDelete(*pax_layout_, rid, txn, log_manager_, deleted);
+  } else {
+    page->ApplyDelete(rid, txn, log_manager_, deleted);
+  }
+  fsm_->Update(rid.GetPageId(), FreeSpaceOf(page));
+  // 留给 vacuum 整理, 页空了就摘掉. 在页锁下记: 摘页也拿着页锁, 之后就不会再记上这一页
+  {
+    std::scoped_lock<std::mutex> lock(dirty_latch_);
+    dirty_page_ids_.insert(rid.GetPageId());
+  }
   lock_manager_->Unlock(txn, rid);
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  // 缓冲池不会再发出删掉的页号, 之前拷出去的 tuple 里的指针不会指到别的数据上
+  if (deleted != nullptr) {
+    Toast::DeleteChains(buffer_pool_manager_, *toast_schema_, deleted_tuple.data_);
+  }
 }
 
 void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
@@ -150,9 +319,43 @@ void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
   BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
   // Rollback the delete.
   page->WLatch();
-  page->RollbackDelete(rid, txn, log_manager_);
+  if (pax_layout_ != nullptr) {
+    static_cast<PaxPage *>(page)->RollbackDelete(*pax_layout_, rid, txn, log_manager_);
+  } else {
+    page->RollbackDelete(rid, txn, log_manager_);
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+}
+
+void TableHeap::ApplyUpdate(const Tuple &old_tuple) {
+  if (toast_schema_ != nullptr) {
+    Toast::DeleteChains(buffer_pool_manager_, *toast_schema_, old_tuple.data_);
+  }
+}
+
+void TableHeap::RollbackUpdate(const Tuple &old_tuple, const RID &rid, Transaction *txn) {
+  // Find the page which contains the tuple.
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
+  // 旧值原样放回, 不走 StoreLongValues: 再存一遍会给它抄一条新链, 原来的链就丢了
+  Tuple replaced;
+  page->WLatch();
+  [[maybe_unused]] bool is_updated =
+      pax_layout_ != nullptr
+          ? static_cast<PaxPage *>(page)->UpdateTuple(*pax_layout_, old_tuple, &replaced, rid, txn, lock_manager_,
+                                                      log_manager_)
+          : page->UpdateTuple(old_tuple, &replaced, rid, txn, lock_manager_, log_manager_);
+  BUSTUB_ASSERT(is_updated, "The old value fitted in this page before the update.");
+  if (zone_map_ != nullptr) {
+    zone_map_->Widen(rid.GetPageId(), old_tuple.GetData());
+  }
+  fsm_->Update(rid.GetPageId(), FreeSpaceOf(page));
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  if (toast_schema_ != nullptr) {
+    Toast::DeleteChains(buffer_pool_manager_, *toast_schema_, replaced.data_);
+  }
 }
 
 auto TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) -> bool {
@@ -165,22 +368,171 @@ auto TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) -> bool
   }
   // Read the tuple from the page.
   page->RLatch();
-  bool res = page->GetTuple(rid, tuple, txn, lock_manager_);
+  bool res = pax_layout_ != nullptr
+                 ? static_cast<PaxPage *>(page)->GetTuple(*pax_layout_, rid, tuple, txn, lock_manager_)
+                 : page->GetTuple(rid, tuple, txn, lock_manager_);
   page->RUnlatch();
   buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
+  tuple->toast_bpm_ = buffer_pool_manager_;
   return res;
 }
 
+void TableHeap::EnableToast(const Schema &schema) { toast_schema_ = std::make_unique<Schema>(schema); }
+
+void TableHeap::EnableZoneMap(const Schema &schema) {
+  // 建的时候不能有新页接上来; 已有的页上的插入由调用者保证没有
+  std::scoped_lock<std::mutex> lock(append_latch_);
+  auto zone_map = std::make_unique<ZoneMap>(schema);
+  std::vector<char> rows;
+  std::vector<TupleView> views;
+  page_id_t page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    BUSTUB_ASSERT(page != nullptr, "all pages are pinned");
+    page->RLatch();
+    views.clear();
+    GetTupleViews(page, page->GetData(), nullptr, &rows, &views);
+    PageZone zone = zone_map->MakeZone();
+    for (const auto &view : views) {
+      zone_map->Widen(&zone, view.GetData());
+    }
+    zone_map->AddPage(page_id, std::move(zone));
+    page_id_t next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  zone_map_ = std::move(zone_map);
+}
+
+auto TableHeap::Vacuum(size_t max_pages, bool whole_heap) -> VacuumStats {
+  std::scoped_lock<std::mutex> vacuum_lock(vacuum_latch_);
+  VacuumStats stats;
+  RecycleUnlinkedPages(&stats);
+  std::vector<page_id_t> page_ids;
+  {
+    std::scoped_lock<std::mutex> lock(dirty_latch_);
+    if (whole_heap) {
+      auto all_page_ids = fsm_->GetPageIds();
+      dirty_page_ids_.insert(all_page_ids.begin(), all_page_ids.end());
+    }
+    while (!dirty_page_ids_.empty() && page_ids.size() < max_pages) {
+      page_ids.push_back(*dirty_page_ids_.begin());
+      dirty_page_ids_.erase(dirty_page_ids_.begin());
+    }
+  }
+  for (auto page_id : page_ids) {
+    if (VacuumPage(page_id, &stats) && Unlink(page_id)) {
+      stats.pages_unlinked_++;
+    }
+  }
+  // 没有读者的话, 这一轮摘掉的页马上就能再用
+  RecycleUnlinkedPages(&stats);
+  return stats;
+}
+
+auto TableHeap::VacuumPage(page_id_t page_id, VacuumStats *stats) -> bool {
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  if (page == nullptr) {
+    // 缓冲池满了, 留到下一轮
+    std::scoped_lock<std::mutex> lock(dirty_latch_);
+    dirty_page_ids_.insert(page_id);
+    return false;
+  }
+  page->WLatch();
+  uint32_t freed = CompactPage(page);
+  fsm_->Update(page_id, FreeSpaceOf(page));
+  // 删除还没提交时不重建: 回滚会把 tuple 放回来, 范围就漏了它
+  if (zone_map_ != nullptr && !HasMarkedDeletes(page)) {
+    std::vector<char> rows;
+    std::vector<TupleView> views;
+    GetTupleViews(page, page->GetData(), nullptr, &rows, &views);
+    PageZone zone = zone_map_->MakeZone();
+    for (const auto &view : views) {
+      zone_map_->Widen(&zone, view.GetData());
+    }
+    zone_map_->SetZone(page_id, std::move(zone));
+  }
+  bool unlink = page->IsEmpty() && page_id != first_page_id_ && page->GetNextPageId() != INVALID_PAGE_ID;
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, freed > 0);
+  stats->pages_visited_++;
+  stats->bytes_reclaimed_ += freed;
+  return unlink;
+}
+
+auto TableHeap::Unlink(page_id_t page_id) -> bool {
+  // 页的前后指针只在 append_latch_ 下改 (这里, 和在最后接新页), 拿着它读不用页锁
+  std::scoped_lock<std::mutex> lock(append_latch_);
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  if (page == nullptr) {
+    return false;
+  }
+  page_id_t prev_page_id = page->GetPrevPageId();
+  page_id_t next_page_id = page->GetNextPageId();
+  auto prev_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(prev_page_id));
+  auto next_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
+  if (prev_page == nullptr || next_page == nullptr) {
+    if (prev_page != nullptr) {
+      buffer_pool_manager_->UnpinPage(prev_page_id, false);
+    }
+    if (next_page != nullptr) {
+      buffer_pool_manager_->UnpinPage(next_page_id, false);
+    }
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    return false;
+  }
+  // 同时拿三页的只有这里, 按链的顺序加锁
+  prev_page->WLatch();
+  page->WLatch();
+  next_page->WLatch();
+  // 整理完放开锁之后可能又插进了 tuple
+  bool empty = page->IsEmpty();
+  if (empty) {
+    // 摘掉的页自己的指针不动: 停在它上面的扫描还能走到下一页
+    prev_page->SetNextPageId(next_page_id);
+    next_page->SetPrevPageId(prev_page_id);
+    fsm_->RemovePage(page_id);
+    if (zone_map_ != nullptr) {
+      zone_map_->RemovePage(page_id);
+    }
+    unlinked_page_ids_.push_back(page_id);
+    // 回收之后这一页会接回堆的最后, 不能再被 vacuum 当成原来的页
+    std::scoped_lock<std::mutex> dirty_lock(dirty_latch_);
+    dirty_page_ids_.erase(page_id);
+  }
+  next_page->WUnlatch();
+  page->WUnlatch();
+  prev_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(next_page_id, empty);
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  buffer_pool_manager_->UnpinPage(prev_page_id, empty);
+  return empty;
+}
+
+void TableHeap::RecycleUnlinkedPages(VacuumStats *stats) {
+  // 摘页之前开始的扫描, 迭代器和插入可能还拿着这些页号; 有读者就等下一轮
+  if (unlinked_page_ids_.empty() || *active_readers_ > 0) {
+    return;
+  }
+  std::scoped_lock<std::mutex> lock(append_latch_);
+  free_page_ids_.insert(free_page_ids_.end(), unlinked_page_ids_.begin(), unlinked_page_ids_.end());
+  stats->pages_recycled_ += unlinked_page_ids_.size();
+  unlinked_page_ids_.clear();
+}
+
 auto TableHeap::Begin(Transaction *txn) -> TableIterator {
   // Start an iterator from the first page.
   // TODO(Wuwen): Hacky fix for now. Removing empty pages is a better way to handle this.
+  // vacuum 摘掉的空页要等到没有读者才释放, 走到迭代器接手为止都算一个读者
+  (*active_readers_)++;
   RID rid;
   auto page_id = first_page_id_;
   while (page_id != INVALID_PAGE_ID) {
     auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
     page->RLatch();
     // If this fails because there is no tuple, then RID will be the default-constructed value, which means EOF.
-    auto found_tuple = page->GetFirstTupleRid(&rid);
+    auto found_tuple = FirstTupleRid(page, &rid);
     page->RUnlatch();
     buffer_pool_manager_->UnpinPage(page_id, false);
     if (found_tuple) {
@@ -188,9 +540,68 @@ auto TableHeap::Begin(Transaction *txn) -> TableIterator {
     }
     page_id = page->GetNextPageId();
   }
-  return {this, rid, txn};
+  TableIterator begin(this, rid, txn);
+  (*active_readers_)--;
+  return begin;
 }
 
 auto TableHeap::End() -> TableIterator { return {this, RID(INVALID_PAGE_ID, 0), nullptr}; }
 
+void TableHeap::GetTupleViews(TablePage *page, const char *data, const std::vector<uint32_t> *columns,
+                              std::vector<char> *rows, std::vector<TupleView> *views) {
+  size_t first = views->size();
+  if (pax_layout_ != nullptr) {
+    static_cast<PaxPage *>(page)->GetTupleViews(*pax_layout_, columns, rows, views);
+  } else {
+    page->GetTupleViews(data, views);
+  }
+  for (size_t i = first; i < views->size(); i++) {
+    (*views)[i].toast_bpm_ = buffer_pool_manager_;
+  }
+}
+
+void TableHeap::InitPage(TablePage *page, page_id_t page_id, page_id_t prev_page_id, Transaction *txn) {
+  if (pax_layout_ != nullptr) {
+    static_cast<PaxPage *>(page)->Init(*pax_layout_, page_id, BUSTUB_PAGE_SIZE, prev_page_id, log_manager_, txn);
+  } else {
+    page->Init(page_id, BUSTUB_PAGE_SIZE, prev_page_id, log_manager_, txn);
+  }
+}
+
+auto TableHeap::FreeSpaceOf(TablePage *page) -> uint32_t {
+  return pax_layout_ != nullptr ? static_cast<PaxPage *>(page)->GetFreeSpaceRemaining(*pax_layout_)
+                                : page->GetFreeSpaceRemaining();
+}
+
+auto TableHeap::InsertInto(TablePage *page, const Tuple &tuple, RID *rid, Transaction *txn) -> bool {
+  if (pax_layout_ != nullptr) {
+    return static_cast<PaxPage *>(page)->InsertTuple(*pax_layout_, tuple, rid, txn, lock_manager_, log_manager_);
+  }
+  return page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_);
+}
+
+auto TableHeap::AppendTo(TablePage *page, const char *data, uint32_t size, RID *rid) -> bool {
+  return pax_layout_ != nullptr ? static_cast<PaxPage *>(page)->AppendTuple(*pax_layout_, data, size, rid)
+                                : page->AppendTuple(data, size, rid);
+}
+
+auto TableHeap::FirstTupleRid(TablePage *page, RID *first_rid) -> bool {
+  return pax_layout_ != nullptr ? static_cast<PaxPage *>(page)->GetFirstTupleRid(*pax_layout_, first_rid)
+                                : page->GetFirstTupleRid(first_rid);
+}
+
+auto TableHeap::NextTupleRid(TablePage *page, const RID &cur_rid, RID *next_rid) -> bool {
+  return pax_layout_ != nullptr ? static_cast<PaxPage *>(page)->GetNextTupleRid(*pax_layout_, cur_rid, next_rid)
+                                : page->GetNextTupleRid(cur_rid, next_rid);
+}
+
+auto TableHeap::CompactPage(TablePage *page) -> uint32_t {
+  return pax_layout_ != nullptr ? static_cast<PaxPage *>(page)->Compact(*pax_layout_) : page->Compact();
+}
+
+auto TableHeap::HasMarkedDeletes(TablePage *page) -> bool {
+  return pax_layout_ != nullptr ? static_cast<PaxPage *>(page)->HasMarkedDeletes(*pax_layout_)
+                                : page->HasMarkedDeletes();
+}
+
 }  // namespace bustub
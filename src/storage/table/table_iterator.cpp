@@ -17,12 +17,33 @@
 namespace bustub {
 
 TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn)
-    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn) {
+    : table_heap_(table_heap), readers_(table_heap->active_readers_), tuple_(new Tuple(rid)), txn_(txn) {
+  (*readers_)++;
   if (rid.GetPageId() != INVALID_PAGE_ID) {
     table_heap_->GetTuple(tuple_->rid_, tuple_, txn_);      // 获取的tuple 放在了成员变量里 tuple_
   }
 }
 
+TableIterator::TableIterator(const TableIterator &other)
+    : table_heap_(other.table_heap_), readers_(other.readers_), tuple_(new Tuple(*other.tuple_)), txn_(other.txn_) {
+  (*readers_)++;
+}
+
+TableIterator::~TableIterator() {
+  (*readers_)--;
+  delete tuple_;
+}
+
+auto TableIterator::operator=(const TableIterator &other) -> TableIterator & {
+  (*other.readers_)++;
+  (*readers_)--;
+  table_heap_ = other.table_heap_;
+  readers_ = other.readers_;
+  *tuple_ = *other.tuple_;
+  txn_ = other.txn_;
+  return *this;
+}
+
 auto TableIterator::operator*() -> const Tuple & {
   assert(*this != table_heap_->End());
   return *tuple_;
@@ -40,15 +61,14 @@ auto TableIterator::operator++() -> TableIterator & {
   assert(cur_page != nullptr);  // all pages are pinned
 
   RID next_tuple_rid;
-  if (!cur_page->GetNextTupleRid(tuple_->rid_,
-                                 &next_tuple_rid)) {  // end of this page
+  if (!table_heap_->NextTupleRid(cur_page, tuple_->rid_, &next_tuple_rid)) {  // end of this page
     while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
       auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
       cur_page->RUnlatch();
       buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
       cur_page = next_page;
       cur_page->RLatch();
-      if (cur_page->GetFirstTupleRid(&next_tuple_rid)) {
+      if (table_heap_->FirstTupleRid(cur_page, &next_tuple_rid)) {
         break;
       }
     }
@@ -0,0 +1,91 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_page_scan.cpp
+//
+// Identification: src/storage/table/table_page_scan.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/table_page_scan.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+TablePageScan::TablePageScan(TableHeap *table_heap, Transaction *txn, std::optional<std::vector<uint32_t>> columns,
+                             std::vector<ZoneRange> ranges)
+    : table_heap_(table_heap),
+      txn_(txn),
+      next_page_id_(table_heap->GetFirstPageId()),
+      columns_(std::move(columns)),
+      ranges_(std::move(ranges)),
+      page_copy_(new char[BUSTUB_PAGE_SIZE]) {
+  (*table_heap_->active_readers_)++;
+}
+
+TablePageScan::TablePageScan(TableHeap *table_heap, Transaction *txn, std::vector<page_id_t> page_ids,
+                             std::optional<std::vector<uint32_t>> columns, std::vector<ZoneRange> ranges)
+    : TablePageScan(table_heap, txn, std::move(columns), std::move(ranges)) {
+  page_ids_ = std::move(page_ids);
+  next_page_id_ = page_ids_->empty() ? INVALID_PAGE_ID : page_ids_->front();
+}
+
+TablePageScan::~TablePageScan() { (*table_heap_->active_readers_)--; }
+
+auto TablePageScan::NextPage() -> bool {
+  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+  ZoneMap *zone_map = ranges_.empty() ? nullptr : table_heap_->GetZoneMap();
+  views_.clear();
+  while (next_page_id_ != INVALID_PAGE_ID) {
+    page_id_t page_id = next_page_id_;
+    // 给了页的列表就按列表走, 不看页上的 next
+    if (page_ids_) {
+      next_page_index_++;
+      next_page_id_ = next_page_index_ < page_ids_->size() ? (*page_ids_)[next_page_index_] : INVALID_PAGE_ID;
+    }
+    // zone map 说这一页没有满足谓词的 tuple, 不 fetch 直接跳到下一页
+    page_id_t chain_next_page_id;
+    if (zone_map != nullptr && zone_map->CanSkip(page_id, ranges_, &chain_next_page_id)) {
+      if (!page_ids_) {
+        next_page_id_ = chain_next_page_id;
+      }
+      continue;
+    }
+    auto page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(page_id));
+    BUSTUB_ASSERT(page != nullptr, "all pages are pinned");
+    page->RLatch();
+    if (table_heap_->GetLayout() == TableLayout::ROW) {
+      memcpy(page_copy_.get(), page->GetData(), BUSTUB_PAGE_SIZE);
+    }
+    table_heap_->GetTupleViews(page, page_copy_.get(), columns_ ? &*columns_ : nullptr, &rows_, &views_);
+    if (!page_ids_) {
+      next_page_id_ = page->GetNextPageId();
+    }
+    page->RUnlatch();
+    buffer_pool_manager->UnpinPage(page_id, false);
+
+    // 和 TablePage::GetTuple 一样, 开了日志就要先拿到共享锁; 拿不到的 tuple 不返回
+    if (enable_logging) {
+      LockManager *lock_manager = table_heap_->lock_manager_;
+      auto locked = std::remove_if(views_.begin(), views_.end(), [&](const TupleView &view) {
+        RID rid = view.GetRid();
+        return !txn_->IsSharedLocked(rid) && !txn_->IsExclusiveLocked(rid) && !lock_manager->LockShared(txn_, rid);
+      });
+      views_.erase(locked, views_.end());
+    }
+    if (!views_.empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace bustub
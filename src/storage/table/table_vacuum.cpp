@@ -0,0 +1,73 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_vacuum.cpp
+//
+// Identification: src/storage/table/table_vacuum.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/table_vacuum.h"
+
+namespace bustub {
+
+TableVacuum::TableVacuum(size_t pages_per_cycle, std::chrono::milliseconds interval)
+    : pages_per_cycle_(pages_per_cycle), interval_(interval) {
+  background_ = std::thread(&TableVacuum::BackgroundWork, this);
+}
+
+TableVacuum::~TableVacuum() {
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  background_.join();
+}
+
+void TableVacuum::AddTable(TableHeap *heap) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  heaps_.push_back(heap);
+}
+
+auto TableVacuum::RunOnce() -> VacuumStats {
+  std::vector<TableHeap *> heaps;
+  size_t start;
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    heaps = heaps_;
+    start = next_heap_;
+    next_heap_ = heaps.empty() ? 0 : (next_heap_ + 1) % heaps.size();
+  }
+  // 一轮最多看 pages_per_cycle_ 页, 前面的表用不完再给后面的
+  VacuumStats stats;
+  for (size_t i = 0; i < heaps.size() && stats.pages_visited_ < pages_per_cycle_; i++) {
+    stats += heaps[(start + i) % heaps.size()]->Vacuum(pages_per_cycle_ - stats.pages_visited_);
+  }
+  std::scoped_lock<std::mutex> lock(latch_);
+  stats_ += stats;
+  return stats;
+}
+
+auto TableVacuum::GetStats() -> VacuumStats {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return stats_;
+}
+
+void TableVacuum::BackgroundWork() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    cv_.wait_for(lock, interval_, [this] { return stop_; });
+    if (stop_) {
+      return;
+    }
+    lock.unlock();
+    RunOnce();
+    lock.lock();
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,181 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// toast.cpp
+//
+// Identification: src/storage/table/toast.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/toast.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "common/macros.h"
+#include "storage/page/table_overflow_page.h"
+#include "storage/table/tuple_view.h"
+
+namespace bustub {
+
+/** bytes of the pointer after the length field, before the prefix: length of the value, first page */
+static constexpr uint32_t TOAST_POINTER_SIZE = sizeof(uint32_t) + sizeof(page_id_t);
+
+auto Toast::LengthField(const Schema &schema, const char *data, uint32_t column_idx, uint32_t *offset) -> uint32_t {
+  memcpy(offset, data + schema.GetColumn(column_idx).GetOffset(), sizeof(uint32_t));
+  uint32_t length;
+  memcpy(&length, data + *offset, sizeof(uint32_t));
+  return length;
+}
+
+auto Toast::StoredSize(const Schema &schema, const char *data, uint32_t size) -> uint32_t {
+  for (auto column_idx : schema.GetUnlinedColumns()) {
+    uint32_t offset;
+    uint32_t length = LengthField(schema, data, column_idx, &offset);
+    if (length != BUSTUB_VALUE_NULL && !IsToasted(length) && length > TOAST_THRESHOLD) {
+      size -= length - TOAST_POINTER_SIZE - std::min(length, TOAST_PREFIX_SIZE);
+    }
+  }
+  return size;
+}
+
+auto Toast::StoreLongValues(BufferPoolManager *bpm, const Schema &schema, const char *data, uint32_t size, Tuple *out,
+                            std::vector<page_id_t> *chains) -> bool {
+  const auto &unlined = schema.GetUnlinedColumns();
+  if (std::none_of(unlined.begin(), unlined.end(), [&](uint32_t column_idx) {
+        uint32_t offset;
+        uint32_t length = LengthField(schema, data, column_idx, &offset);
+        return IsToasted(length) || (length != BUSTUB_VALUE_NULL && length > TOAST_THRESHOLD);
+      })) {
+    return true;
+  }
+  // 定长部分照抄, 变长数据按列的顺序重新排, 长的换成指针
+  size_t first_chain = chains->size();
+  std::string row(data, schema.GetLength());
+  for (auto column_idx : unlined) {
+    uint32_t offset;
+    uint32_t length = LengthField(schema, data, column_idx, &offset);
+    auto new_offset = static_cast<uint32_t>(row.size());
+    memcpy(row.data() + schema.GetColumn(column_idx).GetOffset(), &new_offset, sizeof(uint32_t));
+    if (length == BUSTUB_VALUE_NULL || (!IsToasted(length) && length <= TOAST_THRESHOLD)) {
+      row.append(data + offset, sizeof(uint32_t) + StoredBytes(length));
+      continue;
+    }
+    // 已经在行外的值 (比如从别的表扫出来的 tuple) 也另写一条链, 一条链只属于一个 tuple
+    std::string loaded;
+    std::string_view value(data + offset + sizeof(uint32_t), length);
+    if (IsToasted(length)) {
+      Value detoasted = Load(bpm, data + offset);
+      length = detoasted.GetLength();
+      loaded.assign(detoasted.GetData(), length);
+      value = loaded;
+    }
+    page_id_t first_page_id;
+    if (!WriteChain(bpm, value, &first_page_id)) {
+      for (size_t i = first_chain; i < chains->size(); i++) {
+        DeleteChain(bpm, (*chains)[i]);
+      }
+      chains->resize(first_chain);
+      return false;
+    }
+    chains->push_back(first_page_id);
+    uint32_t prefix = std::min(length, TOAST_PREFIX_SIZE);
+    uint32_t field = TOAST_FLAG | (TOAST_POINTER_SIZE + prefix);
+    row.append(reinterpret_cast<const char *>(&field), sizeof(uint32_t));
+    row.append(reinterpret_cast<const char *>(&length), sizeof(uint32_t));
+    row.append(reinterpret_cast<const char *>(&first_page_id), sizeof(page_id_t));
+    row.append(value.data(), prefix);
+  }
+  TupleView(RID(), row.data(), row.size()).CopyTo(out);
+  out->toast_bpm_ = bpm;
+  return true;
+}
+
+auto Toast::WriteChain(BufferPoolManager *bpm, std::string_view bytes, page_id_t *first_page_id) -> bool {
+  *first_page_id = INVALID_PAGE_ID;
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  TableOverflowPage *prev = nullptr;
+  while (!bytes.empty()) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(&page_id);
+    if (page == nullptr) {
+      if (prev != nullptr) {
+        bpm->UnpinPage(prev_page_id, true);
+        DeleteChain(bpm, *first_page_id);
+      }
+      return false;
+    }
+    auto *overflow = reinterpret_cast<TableOverflowPage *>(page->GetData());
+    overflow->Init(page_id);
+    bytes.remove_prefix(overflow->Store(bytes));
+    // 前一页接上这一页才放开它, 同时最多 pin 两页
+    if (prev != nullptr) {
+      prev->SetNextPageId(page_id);
+      bpm->UnpinPage(prev_page_id, true);
+    } else {
+      *first_page_id = page_id;
+    }
+    prev = overflow;
+    prev_page_id = page_id;
+  }
+  bpm->UnpinPage(prev_page_id, true);
+  return true;
+}
+
+auto Toast::Load(BufferPoolManager *bpm, const char *storage) -> Value {
+  uint32_t length;
+  page_id_t page_id;
+  memcpy(&length, storage + sizeof(uint32_t), sizeof(uint32_t));
+  memcpy(&page_id, storage + 2 * sizeof(uint32_t), sizeof(page_id_t));
+  std::string bytes;
+  bytes.reserve(length);
+  while (page_id != INVALID_PAGE_ID) {
+    Page *page = bpm->FetchPage(page_id);
+    BUSTUB_ASSERT(page != nullptr, "no frame to read a value stored out of line");
+    auto *overflow = reinterpret_cast<const TableOverflowPage *>(page->GetData());
+    overflow->Load(&bytes);
+    page_id_t next_page_id = overflow->GetNextPageId();
+    bpm->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  BUSTUB_ASSERT(bytes.size() == length, "the chain does not hold the whole value");
+  return {TypeId::VARCHAR, bytes.data(), length, true};
+}
+
+auto Toast::Prefix(const char *storage, uint32_t *length) -> std::string_view {
+  uint32_t field;
+  memcpy(&field, storage, sizeof(uint32_t));
+  memcpy(length, storage + sizeof(uint32_t), sizeof(uint32_t));
+  return {storage + sizeof(uint32_t) + TOAST_POINTER_SIZE, StoredBytes(field) - TOAST_POINTER_SIZE};
+}
+
+void Toast::DeleteChains(BufferPoolManager *bpm, const Schema &schema, const char *data) {
+  for (auto column_idx : schema.GetUnlinedColumns()) {
+    uint32_t offset;
+    if (IsToasted(LengthField(schema, data, column_idx, &offset))) {
+      page_id_t page_id;
+      memcpy(&page_id, data + offset + 2 * sizeof(uint32_t), sizeof(page_id_t));
+      DeleteChain(bpm, page_id);
+    }
+  }
+}
+
+void Toast::DeleteChain(BufferPoolManager *bpm, page_id_t page_id) {
+  while (page_id != INVALID_PAGE_ID) {
+    // DeletePage 只删在缓冲池里的页, 顺便读出下一页
+    Page *page = bpm->FetchPage(page_id);
+    if (page == nullptr) {
+      return;
+    }
+    page_id_t next_page_id = reinterpret_cast<const TableOverflowPage *>(page->GetData())->GetNextPageId();
+    bpm->UnpinPage(page_id, false);
+    bpm->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+}
+
+}  // namespace bustub
@@ -16,6 +16,7 @@
 #include <string>
 #include <vector>
 
+#include "storage/table/toast.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -67,7 +68,8 @@ Tuple::Tuple(std::vector<Value> values, const Schema *schema) : allocated_(true)
   }
 }
 
-Tuple::Tuple(const Tuple &other) : allocated_(other.allocated_), rid_(other.rid_), size_(other.size_) {
+Tuple::Tuple(const Tuple &other)
+    : allocated_(other.allocated_), rid_(other.rid_), size_(other.size_), toast_bpm_(other.toast_bpm_) {
   if (allocated_) {
     delete[] data_;
   }
@@ -88,6 +90,7 @@ auto Tuple::operator=(const Tuple &other) -> Tuple & {
   allocated_ = other.allocated_;
   rid_ = other.rid_;
   size_ = other.size_;
+  toast_bpm_ = other.toast_bpm_;
 
   if (allocated_) {
     // Deep copy.
@@ -106,10 +109,27 @@ auto Tuple::GetValue(const Schema *schema, const uint32_t column_idx) const -> V
   assert(data_);
   const TypeId column_type = schema->GetColumn(column_idx).GetType();
   const char *data_ptr = GetDataPtr(schema, column_idx);
+  if (column_type == TypeId::VARCHAR && Toast::IsToasted(*reinterpret_cast<const uint32_t *>(data_ptr))) {
+    assert(toast_bpm_ != nullptr);
+    return Toast::Load(toast_bpm_, data_ptr);
+  }
   // the third parameter "is_inlined" is unused
   return Value::DeserializeFrom(data_ptr, column_type);
 }
 
+auto Tuple::GetToastedPrefix(const Schema *schema, uint32_t column_idx, std::string_view *prefix,
+                             uint32_t *length) const -> bool {
+  if (schema->GetColumn(column_idx).GetType() != TypeId::VARCHAR) {
+    return false;
+  }
+  const char *data_ptr = GetDataPtr(schema, column_idx);
+  if (!Toast::IsToasted(*reinterpret_cast<const uint32_t *>(data_ptr))) {
+    return false;
+  }
+  *prefix = Toast::Prefix(data_ptr, length);
+  return true;
+}
+
 auto Tuple::KeyFromTuple(const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs)
     -> Tuple {
   std::vector<Value> values;
@@ -0,0 +1,145 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// zone_map.cpp
+//
+// Identification: src/storage/table/zone_map.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/zone_map.h"
+
+#include <cstring>
+#include <utility>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+ZoneMap::ZoneMap(const Schema &schema) : schema_(schema) {}
+
+auto ZoneMap::MakeZone() const -> PageZone {
+  PageZone zone;
+  zone.columns_.resize(schema_.GetColumnCount());
+  return zone;
+}
+
+void ZoneMap::Widen(PageZone *zone, const char *data) const {
+  zone->tuple_count_++;
+  for (uint32_t i = 0; i < schema_.GetColumnCount(); i++) {
+    const Column &col = schema_.GetColumn(i);
+    ColumnZone &column = zone->columns_[i];
+    // varchar 只看长度是不是 NULL, 不反序列化出字符串
+    if (!col.IsInlined()) {
+      uint32_t offset;
+      uint32_t length;
+      memcpy(&offset, data + col.GetOffset(), sizeof(uint32_t));
+      memcpy(&length, data + offset, sizeof(uint32_t));
+      column.null_count_ += length == BUSTUB_VALUE_NULL ? 1 : 0;
+      continue;
+    }
+    Value value = Value::DeserializeFrom(data + col.GetOffset(), col.GetType());
+    if (value.IsNull()) {
+      column.null_count_++;
+      continue;
+    }
+    if (!column.min_.has_value() || value.CompareLessThan(*column.min_) == CmpBool::CmpTrue) {
+      column.min_ = value;
+    }
+    if (!column.max_.has_value() || value.CompareGreaterThan(*column.max_) == CmpBool::CmpTrue) {
+      column.max_ = std::move(value);
+    }
+  }
+}
+
+void ZoneMap::AddPage(page_id_t page_id, PageZone zone) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  slots_[page_id] = page_ids_.size();
+  page_ids_.push_back(page_id);
+  zones_.push_back(std::move(zone));
+}
+
+void ZoneMap::Widen(page_id_t page_id, const char *data) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto it = slots_.find(page_id);
+  BUSTUB_ASSERT(it != slots_.end(), "page is not in the zone map");
+  Widen(&zones_[it->second], data);
+}
+
+void ZoneMap::SetZone(page_id_t page_id, PageZone zone) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto it = slots_.find(page_id);
+  BUSTUB_ASSERT(it != slots_.end(), "page is not in the zone map");
+  zones_[it->second] = std::move(zone);
+}
+
+void ZoneMap::RemovePage(page_id_t page_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto it = slots_.find(page_id);
+  if (it == slots_.end()) {
+    return;
+  }
+  size_t i = it->second;
+  slots_.erase(it);
+  page_ids_.erase(page_ids_.begin() + i);
+  zones_.erase(zones_.begin() + i);
+  for (; i < page_ids_.size(); i++) {
+    slots_[page_ids_[i]] = i;
+  }
+}
+
+auto ZoneMap::Meets(const ColumnZone &zone, uint32_t tuple_count, const ZoneRange &range) -> bool {
+  // 全是 NULL: 和 NULL 比较不会是 true
+  if (zone.null_count_ == tuple_count) {
+    return false;
+  }
+  if (!zone.min_.has_value()) {
+    return true;
+  }
+  if (range.lo_.has_value()) {
+    CmpBool below = range.lo_inclusive_ ? zone.max_->CompareLessThan(*range.lo_)
+                                        : zone.max_->CompareLessThanEquals(*range.lo_);
+    if (below == CmpBool::CmpTrue) {
+      return false;
+    }
+  }
+  if (range.hi_.has_value()) {
+    CmpBool above = range.hi_inclusive_ ? zone.min_->CompareGreaterThan(*range.hi_)
+                                        : zone.min_->CompareGreaterThanEquals(*range.hi_);
+    if (above == CmpBool::CmpTrue) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto ZoneMap::CanSkip(page_id_t page_id, const std::vector<ZoneRange> &ranges, page_id_t *next_page_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto it = slots_.find(page_id);
+  if (it == slots_.end()) {
+    pages_scanned_++;
+    return false;
+  }
+  const PageZone &zone = zones_[it->second];
+  bool skip = zone.tuple_count_ == 0;
+  for (size_t i = 0; !skip && i < ranges.size(); i++) {
+    skip = !Meets(zone.columns_[ranges[i].column_idx_], zone.tuple_count_, ranges[i]);
+  }
+  if (!skip) {
+    pages_scanned_++;
+    return false;
+  }
+  pages_skipped_++;
+  *next_page_id = it->second + 1 < page_ids_.size() ? page_ids_[it->second + 1] : INVALID_PAGE_ID;
+  return true;
+}
+
+auto ZoneMap::GetStats() -> ZoneMapStats {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return {page_ids_.size(), pages_scanned_.load(), pages_skipped_.load()};
+}
+
+}  // namespace bustub
@@ -13,6 +13,7 @@
 #include "binder/binder.h"
 #include <memory>
 #include "binder/bound_statement.h"
+#include "binder/statement/index_statement.h"
 #include "catalog/catalog.h"
 #include "gtest/gtest.h"
 
@@ -143,6 +144,18 @@ TEST(BinderTest, FailBindUnknownColumn) {
 
 TEST(BinderTest, BindCreateTable) { TryBind("CREATE TABLE tablex (v1 int)"); }
 
+TEST(BinderTest, BindCreateIndexAccessMethod) {
+  auto index_type = [](const std::string &query) {
+    auto statements = TryBind(query);
+    return dynamic_cast<const IndexStatement &>(*statements[0]).index_type_;
+  };
+  // the parser fills in "art" when USING is left out, only an explicit USING art is an ART index
+  EXPECT_EQ(index_type("CREATE INDEX ia ON a (x)"), "btree");
+  EXPECT_EQ(index_type("CREATE INDEX ia ON a USING art (x)"), "art");
+  EXPECT_EQ(index_type("create index ia on a using HASH (x, y)"), "hash");
+  EXPECT_EQ(index_type("CREATE INDEX \"using\" ON a (x)"), "btree");
+}
+
 TEST(BinderTest, BindInsert) { TryBind("INSERT INTO y VALUES (1,2,3,4,5), (6,7,8,9,10)"); }
 
 TEST(BinderTest, BindInsertSelect) { TryBind("INSERT INTO y SELECT * FROM y WHERE x < 500"); }
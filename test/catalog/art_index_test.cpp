@@ -0,0 +1,99 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// art_index_test.cpp
+//
+// Identification: test/catalog/art_index_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "common/bustub_instance.h"
+#include "common/util/string_util.h"
+#include "gtest/gtest.h"
+#include "storage/index/art_index.h"
+
+namespace bustub {
+
+static auto ExecSql(BustubInstance *instance, const std::string &sql) -> std::string {
+  std::stringstream ss;
+  auto writer = SimpleStreamWriter(ss, true, " ");
+  instance->ExecuteSql(sql, writer);
+  return ss.str();
+}
+
+TEST(ArtIndexTest, IntegerKey) {
+  auto instance = std::make_unique<BustubInstance>("art_index_test.db");
+  instance->GenerateMockTable();
+  instance->GenerateTestTable();
+  ExecSql(instance.get(), "create table t1(v1 int, v2 varchar(8));");
+  ExecSql(instance.get(), "insert into t1 values (5, 'e'), (-3, 'c'), (1, 'a'), (-3, 'cc');");
+  ExecSql(instance.get(), "create index t1v1 on t1 using art (v1);");
+  ExecSql(instance.get(), "insert into t1 values (4, 'd'), (2, 'b');");
+
+  const auto *index_info = instance->catalog_->GetIndex("t1v1", "t1");
+  ASSERT_NE(index_info, nullptr);
+  ASSERT_NE(dynamic_cast<ArtIndex *>(index_info->index_.get()), nullptr);
+
+  // 等值和范围都走 IndexScan, 负数按数值排在前面
+  const std::string range = "select v1, v2 from t1 where v1 >= -3 and v1 < 4;";
+  EXPECT_TRUE(StringUtil::Contains(ExecSql(instance.get(), "explain (o) " + range), "IndexScan"));
+  EXPECT_EQ(ExecSql(instance.get(), range), "-3 c \n-3 cc \n1 a \n2 b \n");
+  EXPECT_EQ(ExecSql(instance.get(), "select v2 from t1 where v1 = -3;"), "c \ncc \n");
+  EXPECT_EQ(ExecSql(instance.get(), "select v1 from t1 where v1 > 2;"), "4 \n5 \n");
+  const std::string order_by = "select * from t1 order by v1 desc;";
+  EXPECT_TRUE(StringUtil::Contains(ExecSql(instance.get(), "explain (o) " + order_by), "reverse"));
+  EXPECT_EQ(ExecSql(instance.get(), order_by), "5 e \n4 d \n2 b \n1 a \n-3 cc \n-3 c \n");
+  // IN 列表: 每个 key 一次 ScanKey
+  const std::string in_list = "select v2 from t1 where v1 in (5, -3, 7);";
+  EXPECT_TRUE(StringUtil::Contains(ExecSql(instance.get(), "explain (o) " + in_list), "IndexLookup"));
+  EXPECT_EQ(ExecSql(instance.get(), in_list), "c \ncc \ne \n");
+
+  // 删除的行从索引里消失
+  ExecSql(instance.get(), "delete from t1 where v2 = 'c';");
+  EXPECT_EQ(ExecSql(instance.get(), "select v2 from t1 where v1 = -3;"), "cc \n");
+
+  instance.reset();
+  remove("art_index_test.db");
+  remove("art_index_test.log");
+}
+
+TEST(ArtIndexTest, VarcharKeyAndPrefixScan) {
+  auto instance = std::make_unique<BustubInstance>("art_index_test.db");
+  instance->GenerateMockTable();
+  instance->GenerateTestTable();
+  ExecSql(instance.get(), "create table t1(v1 varchar(16), v2 int);");
+  ExecSql(instance.get(), "insert into t1 values ('apple', 1), ('apply', 2), ('app', 3), ('banana', 4), ('ap', 5);");
+  ExecSql(instance.get(), "create index t1v1 on t1 using art (v1);");
+
+  const std::string range = "select v2 from t1 where v1 >= 'app' and v1 < 'b';";
+  EXPECT_TRUE(StringUtil::Contains(ExecSql(instance.get(), "explain (o) " + range), "IndexScan"));
+  EXPECT_EQ(ExecSql(instance.get(), range), "3 \n1 \n2 \n");
+  EXPECT_EQ(ExecSql(instance.get(), "select v2 from t1 where v1 = 'apple';"), "1 \n");
+  EXPECT_EQ(ExecSql(instance.get(), "select v2 from t1 where v1 = 'appl';"), "");
+
+  auto *index = dynamic_cast<ArtIndex *>(instance->catalog_->GetIndex("t1v1", "t1")->index_.get());
+  ASSERT_NE(index, nullptr);
+  std::vector<RID> rids;
+  index->ScanPrefix("app", &rids);
+  EXPECT_EQ(rids.size(), 3);
+  rids.clear();
+  index->ScanPrefix("appl", &rids);
+  EXPECT_EQ(rids.size(), 2);
+  rids.clear();
+  index->ScanPrefix("", &rids);
+  EXPECT_EQ(rids.size(), 5);
+
+  instance.reset();
+  remove("art_index_test.db");
+  remove("art_index_test.log");
+}
+
+}  // namespace bustub
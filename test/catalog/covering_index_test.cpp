@@ -0,0 +1,66 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// covering_index_test.cpp
+//
+// Identification: test/catalog/covering_index_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "common/bustub_instance.h"
+#include "common/util/string_util.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+static auto ExecSql(BustubInstance *instance, const std::string &sql) -> std::string {
+  std::stringstream ss;
+  auto writer = SimpleStreamWriter(ss, true, " ");
+  instance->ExecuteSql(sql, writer);
+  return ss.str();
+}
+
+TEST(CoveringIndexTest, IndexOnlyScan) {
+  auto instance = std::make_unique<BustubInstance>("covering_index_test.db");
+  // 和 shell / sqllogictest 一样先建好测试表, 页 0 不会分给 t1
+  instance->GenerateMockTable();
+  instance->GenerateTestTable();
+  ExecSql(instance.get(), "create table t1(v1 int, v2 int, v3 int, v4 varchar(8));");
+  ExecSql(instance.get(), "insert into t1 values (5, 50, 500, 'e'), (3, 30, 300, 'c'), (1, 10, 100, 'a');");
+  ExecSql(instance.get(), "create index t1v1 on t1(v1) with (include = 'v2, v3');");
+  // 建索引之后插入的行也要带上 include 列
+  ExecSql(instance.get(), "insert into t1 values (4, 40, 400, 'd'), (2, 20, 200, 'b');");
+
+  const auto *index_info = instance->catalog_->GetIndex("t1v1", "t1");
+  ASSERT_NE(index_info, nullptr);
+  EXPECT_EQ(index_info->index_->GetIncludeAttrs(), (std::vector<uint32_t>{1, 2}));
+  EXPECT_EQ(index_info->key_size_, 16);
+
+  // 所有列都在索引项里: index-only, 不回表
+  const std::string covered = "select v1, v2 + v3 from t1 where v1 >= 2 and v1 < 5;";
+  EXPECT_TRUE(StringUtil::Contains(ExecSql(instance.get(), "explain (o) " + covered), "index_only"));
+  EXPECT_EQ(ExecSql(instance.get(), covered), "2 220 \n3 330 \n4 440 \n");
+
+  // v4 不在索引里, 照常回表
+  const std::string uncovered = "select v1, v4 from t1 where v1 > 3;";
+  EXPECT_FALSE(StringUtil::Contains(ExecSql(instance.get(), "explain (o) " + uncovered), "index_only"));
+  EXPECT_EQ(ExecSql(instance.get(), uncovered), "4 d \n5 e \n");
+
+  // 删除的行从索引里消失
+  ExecSql(instance.get(), "delete from t1 where v1 = 3;");
+  EXPECT_EQ(ExecSql(instance.get(), covered), "2 220 \n4 440 \n");
+
+  instance.reset();
+  remove("covering_index_test.db");
+  remove("covering_index_test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,123 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_index_lookup_test.cpp
+//
+// Identification: test/catalog/hash_index_lookup_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "common/bustub_instance.h"
+#include "common/util/string_util.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+static auto ExecSql(BustubInstance *instance, const std::string &sql) -> std::string {
+  std::stringstream ss;
+  auto writer = SimpleStreamWriter(ss, true, " ");
+  instance->ExecuteSql(sql, writer);
+  return ss.str();
+}
+
+TEST(HashIndexLookupTest, EqualityAndInList) {
+  auto instance = std::make_unique<BustubInstance>("hash_index_lookup_test.db");
+  instance->GenerateMockTable();
+  instance->GenerateTestTable();
+  ExecSql(instance.get(), "create table t1(v1 int, v2 varchar(8));");
+  ExecSql(instance.get(), "insert into t1 values (5, 'e'), (3, 'c'), (1, 'a'), (3, 'cc');");
+  ExecSql(instance.get(), "create index t1v1 on t1 using hash (v1);");
+  // 建索引之后插入的行也要进 hash 索引
+  ExecSql(instance.get(), "insert into t1 values (4, 'd'), (2, 'b');");
+
+  const auto *index_info = instance->catalog_->GetIndex("t1v1", "t1");
+  ASSERT_NE(index_info, nullptr);
+  EXPECT_FALSE(index_info->index_->IsOrdered());
+
+  // 等值走 hash 点查, 重复 key 的行都要找到
+  const std::string equal = "select v2 from t1 where v1 = 3;";
+  EXPECT_TRUE(StringUtil::Contains(ExecSql(instance.get(), "explain (o) " + equal), "IndexLookup"));
+  EXPECT_EQ(ExecSql(instance.get(), equal), "c \ncc \n");
+  EXPECT_EQ(ExecSql(instance.get(), "select v2 from t1 where v1 = 9;"), "");
+
+  // IN 列表: 每个不同的 key 探查一次, 按 key 的顺序输出
+  const std::string in_list = "select v1, v2 from t1 where v1 in (4, 1, 4, 9);";
+  EXPECT_TRUE(StringUtil::Contains(ExecSql(instance.get(), "explain (o) " + in_list), "IndexLookup"));
+  EXPECT_EQ(ExecSql(instance.get(), in_list), "1 a \n4 d \n");
+
+  // 其它条件留在 filter 里
+  EXPECT_EQ(ExecSql(instance.get(), "select v2 from t1 where v1 = 3 and v2 = 'cc';"), "cc \n");
+
+  // hash 索引不能做范围扫描和排序
+  const std::string range = "select v1 from t1 where v1 > 3;";
+  EXPECT_FALSE(StringUtil::Contains(ExecSql(instance.get(), "explain (o) " + range), "Index"));
+  EXPECT_EQ(ExecSql(instance.get(), range), "5 \n4 \n");
+
+  // OR 和 NOT IN 的语义
+  EXPECT_EQ(ExecSql(instance.get(), "select v2 from t1 where v1 = 1 or v2 = 'e';"), "e \na \n");
+  EXPECT_EQ(ExecSql(instance.get(), "select v1 from t1 where v1 not in (3, 4, 5);"), "1 \n2 \n");
+
+  // 删除的行从 hash 索引里消失
+  ExecSql(instance.get(), "delete from t1 where v1 = 3;");
+  EXPECT_EQ(ExecSql(instance.get(), equal), "");
+  EXPECT_EQ(ExecSql(instance.get(), "select v1 from t1 where v1 in (2, 3, 5);"), "2 \n5 \n");
+
+  instance.reset();
+  remove("hash_index_lookup_test.db");
+  remove("hash_index_lookup_test.log");
+}
+
+TEST(HashIndexLookupTest, InListOnBPlusTree) {
+  auto instance = std::make_unique<BustubInstance>("hash_index_lookup_test.db");
+  instance->GenerateMockTable();
+  instance->GenerateTestTable();
+  ExecSql(instance.get(), "create table t1(v1 int, v2 int);");
+  ExecSql(instance.get(), "insert into t1 values (1, 10), (2, 20), (3, 30), (4, 40), (5, 50);");
+  ExecSql(instance.get(), "create index t1v1 on t1(v1);");
+
+  // b+ 树上的 IN 列表也拆成点查
+  const std::string in_list = "select v2 from t1 where v1 in (5, 2);";
+  EXPECT_TRUE(StringUtil::Contains(ExecSql(instance.get(), "explain (o) " + in_list), "IndexLookup"));
+  EXPECT_EQ(ExecSql(instance.get(), in_list), "20 \n50 \n");
+
+  // 单个等值还是范围扫描
+  const std::string equal = "select v2 from t1 where v1 = 3;";
+  EXPECT_FALSE(StringUtil::Contains(ExecSql(instance.get(), "explain (o) " + equal), "IndexLookup"));
+  EXPECT_EQ(ExecSql(instance.get(), equal), "30 \n");
+
+  instance.reset();
+  remove("hash_index_lookup_test.db");
+  remove("hash_index_lookup_test.log");
+}
+
+TEST(HashIndexLookupTest, InListPrefersHash) {
+  auto instance = std::make_unique<BustubInstance>("hash_index_lookup_test.db");
+  instance->GenerateMockTable();
+  instance->GenerateTestTable();
+  ExecSql(instance.get(), "create table t1(v1 int, v2 int);");
+  ExecSql(instance.get(), "insert into t1 values (1, 10), (2, 20), (3, 30), (4, 40), (5, 50);");
+  // b+ 树先建, 在索引列表里排在前面
+  ExecSql(instance.get(), "create index t1v1_tree on t1(v1);");
+  ExecSql(instance.get(), "create index t1v1_hash on t1 using hash (v1);");
+  const auto *hash_info = instance->catalog_->GetIndex("t1v1_hash", "t1");
+  ASSERT_NE(hash_info, nullptr);
+
+  const std::string in_list = "select v2 from t1 where v1 in (5, 2);";
+  EXPECT_TRUE(StringUtil::Contains(ExecSql(instance.get(), "explain (o) " + in_list),
+                                   fmt::format("IndexLookup {{ index_oid={},", hash_info->index_oid_)));
+  EXPECT_EQ(ExecSql(instance.get(), in_list), "20 \n50 \n");
+
+  instance.reset();
+  remove("hash_index_lookup_test.db");
+  remove("hash_index_lookup_test.log");
+}
+
+}  // namespace bustub
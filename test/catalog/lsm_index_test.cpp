@@ -0,0 +1,88 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lsm_index_test.cpp
+//
+// Identification: test/catalog/lsm_index_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "common/bustub_instance.h"
+#include "common/util/string_util.h"
+#include "gtest/gtest.h"
+#include "storage/index/lsm_index.h"
+
+namespace bustub {
+
+static auto ExecSql(BustubInstance *instance, const std::string &sql) -> std::string {
+  std::stringstream ss;
+  auto writer = SimpleStreamWriter(ss, true, " ");
+  instance->ExecuteSql(sql, writer);
+  return ss.str();
+}
+
+TEST(LsmIndexTest, IntegerKey) {
+  auto instance = std::make_unique<BustubInstance>("lsm_index_test.db");
+  instance->GenerateMockTable();
+  instance->GenerateTestTable();
+  ExecSql(instance.get(), "create table t1(v1 int, v2 varchar(8));");
+  ExecSql(instance.get(), "insert into t1 values (5, 'e'), (-3, 'c'), (1, 'a'), (-3, 'cc');");
+  ExecSql(instance.get(), "create index t1v1 on t1 using lsm (v1);");
+
+  auto *index = dynamic_cast<LsmIndex *>(instance->catalog_->GetIndex("t1v1", "t1")->index_.get());
+  ASSERT_NE(index, nullptr);
+  // 建索引时的项写到 run 里, 之后的留在 memtable, 查询两边都要读到
+  index->Flush();
+  ExecSql(instance.get(), "insert into t1 values (4, 'd'), (2, 'b');");
+
+  const std::string range = "select v1, v2 from t1 where v1 >= -3 and v1 < 4;";
+  EXPECT_TRUE(StringUtil::Contains(ExecSql(instance.get(), "explain (o) " + range), "IndexScan"));
+  EXPECT_EQ(ExecSql(instance.get(), range), "-3 c \n-3 cc \n1 a \n2 b \n");
+  EXPECT_EQ(ExecSql(instance.get(), "select v2 from t1 where v1 = -3;"), "c \ncc \n");
+  EXPECT_EQ(ExecSql(instance.get(), "select v1 from t1 where v1 > 2;"), "4 \n5 \n");
+  const std::string order_by = "select * from t1 order by v1 desc;";
+  EXPECT_TRUE(StringUtil::Contains(ExecSql(instance.get(), "explain (o) " + order_by), "reverse"));
+  EXPECT_EQ(ExecSql(instance.get(), order_by), "5 e \n4 d \n2 b \n1 a \n-3 cc \n-3 c \n");
+  const std::string in_list = "select v2 from t1 where v1 in (5, -3, 7);";
+  EXPECT_TRUE(StringUtil::Contains(ExecSql(instance.get(), "explain (o) " + in_list), "IndexLookup"));
+  EXPECT_EQ(ExecSql(instance.get(), in_list), "c \ncc \ne \n");
+
+  // 删除写墓碑, 盖住 run 里的旧项
+  ExecSql(instance.get(), "delete from t1 where v2 = 'c';");
+  EXPECT_EQ(ExecSql(instance.get(), "select v2 from t1 where v1 = -3;"), "cc \n");
+  index->Flush();
+  EXPECT_EQ(ExecSql(instance.get(), "select v2 from t1 where v1 = -3;"), "cc \n");
+
+  instance.reset();
+  remove("lsm_index_test.db");
+  remove("lsm_index_test.log");
+}
+
+TEST(LsmIndexTest, VarcharKey) {
+  auto instance = std::make_unique<BustubInstance>("lsm_index_test.db");
+  instance->GenerateMockTable();
+  instance->GenerateTestTable();
+  ExecSql(instance.get(), "create table t1(v1 varchar(16), v2 int);");
+  ExecSql(instance.get(), "insert into t1 values ('apple', 1), ('apply', 2), ('app', 3), ('banana', 4), ('ap', 5);");
+  ExecSql(instance.get(), "create index t1v1 on t1 using lsm (v1);");
+
+  const std::string range = "select v2 from t1 where v1 >= 'app' and v1 < 'b';";
+  EXPECT_TRUE(StringUtil::Contains(ExecSql(instance.get(), "explain (o) " + range), "IndexScan"));
+  EXPECT_EQ(ExecSql(instance.get(), range), "3 \n1 \n2 \n");
+  EXPECT_EQ(ExecSql(instance.get(), "select v2 from t1 where v1 = 'apple';"), "1 \n");
+  EXPECT_EQ(ExecSql(instance.get(), "select v2 from t1 where v1 = 'appl';"), "");
+
+  instance.reset();
+  remove("lsm_index_test.db");
+  remove("lsm_index_test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,199 @@
+/**
+ * adaptive_radix_tree_test.cpp
+ */
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "container/art/adaptive_radix_tree.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+/** 4-byte big-endian, so byte order is numeric order for non-negative values */
+static auto IntKey(uint32_t value) -> std::string {
+  std::string key(4, '\0');
+  for (int i = 3; i >= 0; i--) {
+    key[i] = static_cast<char>(value & 0xFF);
+    value >>= 8;
+  }
+  return key;
+}
+
+/** the terminator keeps string keys prefix-free */
+static auto StrKey(const std::string &str) -> std::string { return str + '\0'; }
+
+static auto Scan(const AdaptiveRadixTree<int> &tree, const std::string &low, std::optional<std::string> high)
+    -> std::vector<int> {
+  std::vector<std::pair<std::string, int>> entries;
+  tree.ScanRange(low, high.has_value() ? std::make_optional<std::string_view>(*high) : std::nullopt, &entries);
+  std::vector<int> values;
+  for (const auto &[key, value] : entries) {
+    values.push_back(value);
+  }
+  return values;
+}
+
+TEST(AdaptiveRadixTreeTest, InsertFindRemove) {
+  AdaptiveRadixTree<int> tree;
+  EXPECT_TRUE(tree.Insert(StrKey("apple"), 1));
+  EXPECT_TRUE(tree.Insert(StrKey("apply"), 2));
+  EXPECT_TRUE(tree.Insert(StrKey("banana"), 3));
+  EXPECT_TRUE(tree.Insert(StrKey("app"), 4));
+  EXPECT_FALSE(tree.Insert(StrKey("apple"), 5));
+  // 破坏 prefix-free 的 key 插不进去
+  EXPECT_FALSE(tree.Insert("app", 6));
+  EXPECT_FALSE(tree.Insert(StrKey("apple") + "x", 7));
+  EXPECT_EQ(tree.GetSize(), 4);
+
+  int value = 0;
+  EXPECT_TRUE(tree.Find(StrKey("apple"), &value));
+  EXPECT_EQ(value, 1);
+  EXPECT_TRUE(tree.Find(StrKey("app"), &value));
+  EXPECT_EQ(value, 4);
+  EXPECT_FALSE(tree.Find(StrKey("ap"), &value));
+  EXPECT_FALSE(tree.Find(StrKey("applesauce"), &value));
+  EXPECT_FALSE(tree.Find("", &value));
+
+  // 前缀扫描, 按 key 的顺序
+  EXPECT_EQ(Scan(tree, "app", AdaptiveRadixTree<int>::Successor("app")), (std::vector<int>{4, 1, 2}));
+  EXPECT_EQ(Scan(tree, "appl", AdaptiveRadixTree<int>::Successor("appl")), (std::vector<int>{1, 2}));
+  EXPECT_EQ(Scan(tree, "b", std::nullopt), (std::vector<int>{3}));
+  EXPECT_EQ(Scan(tree, "", std::nullopt), (std::vector<int>{4, 1, 2, 3}));
+
+  EXPECT_TRUE(tree.Remove(StrKey("apple")));
+  EXPECT_FALSE(tree.Remove(StrKey("apple")));
+  EXPECT_FALSE(tree.Find(StrKey("apple"), &value));
+  EXPECT_TRUE(tree.Find(StrKey("apply"), &value));
+  EXPECT_EQ(value, 2);
+  // 删到只剩一个孩子的节点要合并回父节点, 查找和扫描照常
+  EXPECT_TRUE(tree.Remove(StrKey("app")));
+  EXPECT_TRUE(tree.Find(StrKey("apply"), &value));
+  EXPECT_EQ(Scan(tree, "", std::nullopt), (std::vector<int>{2, 3}));
+  EXPECT_EQ(tree.GetSize(), 2);
+}
+
+TEST(AdaptiveRadixTreeTest, GrowAndShrinkNodes) {
+  AdaptiveRadixTree<int> tree;
+  // 同一个节点下 256 个孩子: Node4 -> Node16 -> Node48 -> Node256
+  for (int i = 0; i < 256; i++) {
+    ASSERT_TRUE(tree.Insert(IntKey(0x01000000U | (static_cast<uint32_t>(i) << 8)), i));
+  }
+  int value = 0;
+  for (int i = 0; i < 256; i++) {
+    ASSERT_TRUE(tree.Find(IntKey(0x01000000U | (static_cast<uint32_t>(i) << 8)), &value));
+    ASSERT_EQ(value, i);
+  }
+  // 再删回去: Node256 -> Node48 -> Node16 -> Node4
+  for (int i = 0; i < 255; i++) {
+    ASSERT_TRUE(tree.Remove(IntKey(0x01000000U | (static_cast<uint32_t>(i) << 8))));
+    for (int j = i + 1; j < 256; j += 17) {
+      ASSERT_TRUE(tree.Find(IntKey(0x01000000U | (static_cast<uint32_t>(j) << 8)), &value));
+      ASSERT_EQ(value, j);
+    }
+  }
+  EXPECT_EQ(Scan(tree, "", std::nullopt), (std::vector<int>{255}));
+}
+
+TEST(AdaptiveRadixTreeTest, RandomAgainstMap) {
+  std::mt19937 rng(15445);
+  AdaptiveRadixTree<int> tree;
+  std::map<std::string, int> reference;
+  auto random_key = [&]() {
+    if (rng() % 2 == 0) {
+      return IntKey(rng() % 5000);
+    }
+    std::string str(1 + rng() % 6, 'a');
+    for (auto &c : str) {
+      c = static_cast<char>('a' + rng() % 4);
+    }
+    return StrKey(str);
+  };
+
+  for (int i = 0; i < 20000; i++) {
+    std::string key = random_key();
+    if (rng() % 3 == 0) {
+      ASSERT_EQ(tree.Remove(key), reference.erase(key) == 1);
+    } else {
+      ASSERT_EQ(tree.Insert(key, i), reference.emplace(key, i).second);
+    }
+  }
+  ASSERT_EQ(tree.GetSize(), reference.size());
+
+  for (int i = 0; i < 300; i++) {
+    std::string low = random_key().substr(0, rng() % 5);
+    std::optional<std::string> high;
+    if (rng() % 4 != 0) {
+      high = random_key().substr(0, rng() % 5);
+    } else if (!low.empty()) {
+      high = AdaptiveRadixTree<int>::Successor(low);
+    }
+    std::vector<int> expected;
+    for (auto it = reference.lower_bound(low); it != reference.end() && (!high.has_value() || it->first < *high);
+         ++it) {
+      expected.push_back(it->second);
+    }
+    ASSERT_EQ(Scan(tree, low, high), expected);
+  }
+}
+
+TEST(AdaptiveRadixTreeTest, ConcurrentInsertFindRemove) {
+  const int num_threads = 4;
+  const int keys_per_thread = 5000;
+  AdaptiveRadixTree<int> tree;
+
+  // 每个线程插自己的 key, 同时查别的线程的 key, 查到的值必须是对的
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&tree, t]() {
+      int value;
+      for (int i = 0; i < keys_per_thread; i++) {
+        int key = i * num_threads + t;
+        EXPECT_TRUE(tree.Insert(IntKey(key), key));
+        int other = (i * num_threads + (t + 1) % num_threads);
+        if (tree.Find(IntKey(other), &value)) {
+          EXPECT_EQ(value, other);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(tree.GetSize(), num_threads * keys_per_thread);
+
+  // 一半线程删奇数 key, 另一半扫描
+  threads.clear();
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&tree, t]() {
+      if (t % 2 == 0) {
+        for (int key = t / 2 * 2 + 1; key < num_threads * keys_per_thread; key += num_threads) {
+          EXPECT_TRUE(tree.Remove(IntKey(key)));
+        }
+        return;
+      }
+      for (int round = 0; round < 5; round++) {
+        std::vector<std::pair<std::string, int>> entries;
+        tree.ScanRange("", std::nullopt, &entries);
+        EXPECT_TRUE(std::is_sorted(entries.begin(), entries.end()));
+        for (const auto &[key, value] : entries) {
+          EXPECT_EQ(key, IntKey(value));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(tree.GetSize(), num_threads * keys_per_thread / 2);
+  int value;
+  for (int key = 0; key < num_threads * keys_per_thread; key++) {
+    ASSERT_EQ(tree.Find(IntKey(key), &value), key % 2 == 0);
+  }
+}
+
+}  // namespace bustub
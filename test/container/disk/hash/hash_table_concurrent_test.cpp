@@ -0,0 +1,155 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_concurrent_test.cpp
+//
+// Identification: test/container/disk/hash/hash_table_concurrent_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <functional>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "container/disk/hash/disk_extendible_hash_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+using IntHashTable = DiskExtendibleHashTable<int, int, IntComparator>;
+
+static void LaunchParallel(int num_threads, const std::function<void(int)> &work) {
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back(work, tid);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, SplitMergeTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  IntHashTable ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // a few thousand keys need several splits of several buckets
+  const int num_keys = 5000;
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, i, i)) << i;
+  }
+  EXPECT_FALSE(ht.Insert(nullptr, 0, 0));
+  EXPECT_GT(ht.GetGlobalDepth(), 2);
+  ht.VerifyIntegrity();
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ASSERT_TRUE(ht.GetValue(nullptr, i, &res)) << i;
+    EXPECT_EQ(res, std::vector<int>{i});
+  }
+
+  // emptying the table merges every bucket back and shrinks the directory
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(ht.Remove(nullptr, i, i)) << i;
+  }
+  EXPECT_FALSE(ht.Remove(nullptr, 0, 0));
+  ht.VerifyIntegrity();
+  EXPECT_EQ(ht.GetGlobalDepth(), 0);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, ConcurrentInsertRemoveTest) {
+  const int num_threads = 4;
+  const int keys_per_thread = 2000;
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  IntHashTable ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // each thread owns the keys k with k % num_threads == tid, and checks them while the others split the buckets
+  LaunchParallel(num_threads, [&](int tid) {
+    for (int i = 0; i < keys_per_thread; i++) {
+      int key = i * num_threads + tid;
+      EXPECT_TRUE(ht.Insert(nullptr, key, key));
+      std::vector<int> res;
+      EXPECT_TRUE(ht.GetValue(nullptr, key, &res)) << key;
+    }
+  });
+  ht.VerifyIntegrity();
+
+  // odd threads remove their keys (merging buckets), even threads keep reading theirs
+  LaunchParallel(num_threads, [&](int tid) {
+    for (int i = 0; i < keys_per_thread; i++) {
+      int key = i * num_threads + tid;
+      std::vector<int> res;
+      if (tid % 2 == 1) {
+        EXPECT_TRUE(ht.Remove(nullptr, key, key));
+      } else {
+        EXPECT_TRUE(ht.GetValue(nullptr, key, &res)) << key;
+      }
+    }
+  });
+  ht.VerifyIntegrity();
+
+  for (int key = 0; key < num_threads * keys_per_thread; key++) {
+    std::vector<int> res;
+    EXPECT_EQ(ht.GetValue(nullptr, key, &res), key % num_threads % 2 == 0) << key;
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+/*
+ * Throughput of a lookup-heavy mix (3 lookups per insert) with 1 to 8 threads. Each thread inserts its own keys, so
+ * the threads meet only on buckets and on the directory page. Build in Release mode for meaningful numbers.
+ */
+// NOLINTNEXTLINE
+TEST(HashTableTest, ConcurrentBenchmark) {
+  const int ops_per_run = 40000;
+  for (int num_threads : {1, 2, 4, 8}) {
+    auto *disk_manager = new DiskManager("test.db");
+    auto *bpm = new BufferPoolManagerInstance(100, disk_manager);
+    IntHashTable ht("blah", bpm, IntComparator(), HashFunction<int>());
+    int ops_per_thread = ops_per_run / num_threads;
+
+    auto start = std::chrono::steady_clock::now();
+    LaunchParallel(num_threads, [&](int tid) {
+      std::vector<int> res;
+      for (int i = 0; i < ops_per_thread / 4; i++) {
+        int key = i * num_threads + tid;
+        ht.Insert(nullptr, key, key);
+        for (int probe = 0; probe < 3; probe++) {
+          res.clear();
+          ht.GetValue(nullptr, key - probe * num_threads, &res);
+        }
+      }
+    });
+    auto millis =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    printf("%d threads: %d ops in %ld ms, %.0f ops/s\n", num_threads, ops_per_run, static_cast<long>(millis),  // NOLINT
+           ops_per_run * 1000.0 / std::max<int64_t>(millis, 1));
+    ht.VerifyIntegrity();
+
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete disk_manager;
+    delete bpm;
+  }
+}
+
+}  // namespace bustub
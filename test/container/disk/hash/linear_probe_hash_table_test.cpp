@@ -0,0 +1,111 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// linear_probe_hash_table_test.cpp
+//
+// Identification: test/container/disk/hash/linear_probe_hash_table_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "container/disk/hash/linear_probe_hash_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+using IntLinearProbeTable = LinearProbeHashTable<int, int, IntComparator>;
+
+static void CheckKeys(IntLinearProbeTable *ht, int num_keys, int removed_below) {
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    if (i < removed_below && i % 2 == 0) {
+      EXPECT_FALSE(ht->GetValue(nullptr, i, &res)) << i;
+      continue;
+    }
+    ASSERT_TRUE(ht->GetValue(nullptr, i, &res)) << i;
+    EXPECT_EQ(res, std::vector<int>{i});
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, IncrementalGrowTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  IntLinearProbeTable ht("blah", bpm, IntComparator(), 16, HashFunction<int>());
+
+  // every doubling leaves the old array to be drained by the following writes, lookups see both arrays meanwhile
+  const int num_keys = 20000;
+  int migrating_checks = 0;
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, i, i)) << i;
+    if (ht.IsMigrating() && i % 50 == 0) {
+      migrating_checks++;
+      CheckKeys(&ht, i + 1, 0);
+    }
+  }
+  EXPECT_GT(migrating_checks, 0);
+  EXPECT_GE(ht.GetSize(), num_keys);
+  CheckKeys(&ht, num_keys, 0);
+
+  // duplicates are found in either array
+  EXPECT_FALSE(ht.Insert(nullptr, 0, 0));
+  EXPECT_FALSE(ht.Insert(nullptr, num_keys - 1, num_keys - 1));
+  EXPECT_TRUE(ht.Insert(nullptr, 0, 1));
+  EXPECT_TRUE(ht.Remove(nullptr, 0, 1));
+
+  for (int i = 0; i < num_keys; i += 2) {
+    ASSERT_TRUE(ht.Remove(nullptr, i, i)) << i;
+  }
+  EXPECT_FALSE(ht.Remove(nullptr, 0, 0));
+  CheckKeys(&ht, num_keys, num_keys);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, BlockingResizeTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  IntLinearProbeTable ht("blah", bpm, IntComparator(), 16, HashFunction<int>());
+
+  // batch 0: the whole table is rehashed inside the insert that grows it
+  ht.SetMigrationBatch(0);
+  const int num_keys = 3000;
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, i, i)) << i;
+    ASSERT_FALSE(ht.IsMigrating());
+  }
+  CheckKeys(&ht, num_keys, 0);
+
+  // an explicit Resize drains right away as well, whatever the batch
+  ht.SetMigrationBatch(64);
+  size_t size = ht.GetSize();
+  ht.Resize(size);
+  EXPECT_EQ(ht.GetSize(), 2 * size);
+  EXPECT_FALSE(ht.IsMigrating());
+  CheckKeys(&ht, num_keys, 0);
+
+  // churn leaves tombstones behind, they are dropped by a rehash instead of growing the table forever
+  for (int round = 0; round < 20; round++) {
+    for (int i = 0; i < num_keys; i++) {
+      ASSERT_TRUE(ht.Remove(nullptr, i, i + round)) << i;
+      ASSERT_TRUE(ht.Insert(nullptr, i, i + round + 1)) << i;
+    }
+  }
+  EXPECT_LE(ht.GetSize(), 4 * size);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+}  // namespace bustub
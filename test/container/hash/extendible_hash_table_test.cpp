@@ -3,8 +3,10 @@
  */
 
 #include <memory>
+#include <string>
 #include <thread>  // NOLINT
 #include <iostream>
+#include <vector>
 
 #include "container/hash/extendible_hash_table.h"
 #include "gtest/gtest.h"
@@ -74,4 +76,74 @@ TEST(ExtendibleHashTableTest, ConcurrentInsertTest) {
   }
 }
 
+TEST(ExtendibleHashTableTest, FlatBucketTest) {
+  // 20 entries per bucket: the tag groups of 16 end in the middle of a bucket
+  auto table = std::make_unique<ExtendibleHashTable<int, std::string>>(20);
+  const int num_keys = 5000;
+  for (int i = 0; i < num_keys; i++) {
+    table->Insert(i, std::to_string(i));
+  }
+  // updates in place, even in full buckets
+  for (int i = 0; i < num_keys; i += 3) {
+    table->Insert(i, "u" + std::to_string(i));
+  }
+  EXPECT_GE(table->GetNumBuckets(), num_keys / 20);
+
+  std::string result;
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(table->Find(i, result)) << i;
+    EXPECT_EQ(result, (i % 3 == 0 ? "u" : "") + std::to_string(i));
+  }
+  EXPECT_FALSE(table->Find(num_keys, result));
+  EXPECT_FALSE(table->Find(-1, result));
+
+  // removes fill the holes with the last entry of the bucket
+  for (int i = 0; i < num_keys; i += 2) {
+    ASSERT_TRUE(table->Remove(i)) << i;
+  }
+  EXPECT_FALSE(table->Remove(0));
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_EQ(table->Find(i, result), i % 2 == 1) << i;
+  }
+  int buckets = table->GetNumBuckets();
+  for (int i = 0; i < num_keys; i += 2) {
+    table->Insert(i, std::to_string(i));
+  }
+  EXPECT_EQ(table->GetNumBuckets(), buckets);
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(table->Find(i, result)) << i;
+  }
+}
+
+TEST(ExtendibleHashTableTest, ConcurrentSplitTest) {
+  const int num_threads = 4;
+  const int keys_per_thread = 3000;
+  auto table = std::make_unique<ExtendibleHashTable<int, int>>(4);
+
+  // every thread inserts and reads back its own keys while the others split the buckets under it
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([tid, &table]() {
+      int val;
+      for (int i = 0; i < keys_per_thread; i++) {
+        int key = i * num_threads + tid;
+        table->Insert(key, key);
+        EXPECT_TRUE(table->Find(key, val)) << key;
+        EXPECT_EQ(val, key);
+        if (i % 4 == 3) {
+          EXPECT_TRUE(table->Remove(key - 2 * num_threads));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (int key = 0; key < num_threads * keys_per_thread; key++) {
+    int val;
+    EXPECT_EQ(table->Find(key, val), key / num_threads % 4 != 1) << key;
+  }
+}
+
 }  // namespace bustub
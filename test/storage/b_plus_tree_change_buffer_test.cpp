@@ -0,0 +1,143 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_change_buffer_test.cpp
+//
+// Identification: test/storage/b_plus_tree_change_buffer_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree_index.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+using ChangeBufferIndex = BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
+
+/** every key of the reference through ScanKey, and the whole index through the iterators, forward and reverse */
+static void CheckIndex(ChangeBufferIndex *index, const std::map<int64_t, int64_t> &reference) {
+  auto *key_schema = index->GetKeySchema();
+  std::vector<RID> rids;
+  for (const auto &[key, value] : reference) {
+    rids.clear();
+    index->ScanKey(Tuple({ValueFactory::GetBigIntValue(key)}, key_schema), &rids, nullptr);
+    ASSERT_EQ(rids.size(), 1U) << key;
+    ASSERT_EQ(rids[0].GetSlotNum(), value) << key;
+  }
+
+  auto expected = reference.begin();
+  for (auto it = index->GetBeginIterator(); !it.IsEnd(); ++it, ++expected) {
+    ASSERT_NE(expected, reference.end());
+    ASSERT_EQ((*it).second.GetSlotNum(), expected->second);
+  }
+  EXPECT_EQ(expected, reference.end());
+  auto reverse = reference.rbegin();
+  for (auto it = index->GetRangeIterator(std::nullopt, true, std::nullopt, true, true); !it.IsEnd(); ++it, ++reverse) {
+    ASSERT_NE(reverse, reference.rend());
+    ASSERT_EQ((*it).second.GetSlotNum(), reverse->second);
+  }
+  EXPECT_EQ(reverse, reference.rend());
+  EXPECT_EQ(index->GetBufferedChanges(), 0U);
+}
+
+TEST(BPlusTreeTests, ChangeBufferTest) {
+  auto *disk_manager = new DiskManager("change_buffer_test.db");
+  // 叶子比 frame 多得多, 大部分修改的目标叶子不在 buffer pool 里
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(16, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+
+  auto schema = ParseCreateStatement("a bigint");
+  auto metadata = std::make_unique<IndexMetadata>("a_idx", "t", schema.get(), std::vector<uint32_t>{0});
+  ChangeBufferIndex index(std::move(metadata), bpm);
+  index.SetChangeBufferCapacity(256);
+  auto *key_schema = index.GetKeySchema();
+  auto make_key = [&](int64_t key) { return Tuple({ValueFactory::GetBigIntValue(key)}, key_schema); };
+
+  std::mt19937 rng(15445);
+  std::vector<int64_t> keys(20000);
+  for (size_t i = 0; i < keys.size(); i++) {
+    keys[i] = static_cast<int64_t>(i);
+  }
+  std::shuffle(keys.begin(), keys.end(), rng);
+
+  std::map<int64_t, int64_t> reference;
+  size_t max_buffered = 0;
+  for (auto key : keys) {
+    index.InsertEntry(make_key(key), RID(0, key), nullptr);
+    reference[key] = key;
+    max_buffered = std::max(max_buffered, index.GetBufferedChanges());
+  }
+  EXPECT_GT(max_buffered, 0U);
+  EXPECT_LT(max_buffered, 256U);
+
+  // 删除, 删了再插 (新值), 插入已有的 key (被忽略), 删除不存在的 key; 都在缓冲着修改的时候查
+  for (int round = 0; round < 3; round++) {
+    for (int i = 0; i < 3000; i++) {
+      int64_t key = keys[rng() % keys.size()];
+      switch (rng() % 4) {
+        case 0:
+          index.DeleteEntry(make_key(key), RID(0, key), nullptr);
+          reference.erase(key);
+          break;
+        case 1:
+          index.DeleteEntry(make_key(key), RID(0, key), nullptr);
+          index.InsertEntry(make_key(key), RID(0, key + 100000), nullptr);
+          reference[key] = key + 100000;
+          break;
+        case 2:
+          index.InsertEntry(make_key(key), RID(0, key + 200000), nullptr);
+          reference.emplace(key, key + 200000);
+          break;
+        default:
+          index.DeleteEntry(make_key(key + 50000), RID(0, key), nullptr);
+          break;
+      }
+    }
+    EXPECT_GT(index.GetBufferedChanges(), 0U);
+    CheckIndex(&index, reference);
+  }
+
+  // 批量插入走同样的路径
+  std::vector<std::pair<Tuple, RID>> entries;
+  for (int64_t key = 20000; key < 25000; key++) {
+    entries.emplace_back(make_key(key), RID(0, key));
+    reference[key] = key;
+  }
+  std::shuffle(entries.begin(), entries.end(), rng);
+  index.InsertEntries(entries, nullptr);
+  CheckIndex(&index, reference);
+
+  // 关掉之后修改直接进树
+  index.InsertEntry(make_key(-1), RID(0, 7), nullptr);
+  reference[-1] = 7;
+  index.SetChangeBufferCapacity(0);
+  EXPECT_EQ(index.GetBufferedChanges(), 0U);
+  for (int64_t key = 25000; key < 26000; key++) {
+    index.InsertEntry(make_key(key), RID(0, key), nullptr);
+    ASSERT_EQ(index.GetBufferedChanges(), 0U);
+    reference[key] = key;
+  }
+  CheckIndex(&index, reference);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("change_buffer_test.db");
+  remove("change_buffer_test.log");
+}
+
+}  // namespace bustub
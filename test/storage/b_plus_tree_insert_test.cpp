@@ -12,6 +12,9 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
@@ -189,7 +192,78 @@ TEST(BPlusTreeTests, InsertTest3) {
   }
 
   printf("测试 tree.Begin()\n");
-  auto iterator = tree.Begin();
+  {
+    auto iterator = tree.Begin();  // 迭代器 pin 着叶子, 要在 buffer pool 之前析构
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, InsertBatchTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(300, disk_manager);
+  // small nodes so that a batch splits leaves and internal pages; the pool holds the whole tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 8, 5);
+  auto *transaction = new Transaction(0);
+
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  ASSERT_EQ(page_id, HEADER_PAGE_ID);
+  (void)header_page;
+
+  auto make_batch = [](const std::vector<int64_t> &keys) {
+    std::vector<std::pair<GenericKey<8>, RID>> batch;
+    for (auto key : keys) {
+      GenericKey<8> index_key;
+      index_key.SetFromInteger(key);
+      batch.emplace_back(index_key, RID(0, key));
+    }
+    return batch;
+  };
+
+  // 第一批建树: 偶数 key, 打乱顺序, 带一个重复 key
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < 300; key += 2) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  auto batch = make_batch(keys);
+  batch.push_back(batch.front());
+  tree.InsertBatch(&batch, transaction);
+
+  // 第二批插到已有的树里, 落在每两个老 key 之间
+  std::vector<int64_t> odd_keys;
+  for (int64_t key = 1; key < 300; key += 2) {
+    odd_keys.push_back(key);
+  }
+  std::shuffle(odd_keys.begin(), odd_keys.end(), std::mt19937(15721));
+  batch = make_batch(odd_keys);
+  tree.InsertBatch(&batch, transaction);
+
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < 300; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    tree.GetValue(index_key, &rids);
+    ASSERT_EQ(rids.size(), 1) << key;
+    EXPECT_EQ(rids[0].GetSlotNum(), key);
+  }
+
+  int64_t current_key = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key++;
+  }
+  EXPECT_EQ(current_key, 300);
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
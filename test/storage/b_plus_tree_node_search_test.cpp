@@ -0,0 +1,136 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_node_search_test.cpp
+//
+// Identification: test/storage/b_plus_tree_node_search_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "common/rid.h"
+#include "gtest/gtest.h"
+#include "storage/index/node_search.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+static auto IntValue(TypeId type, int64_t v) -> Value {
+  return type == TypeId::BIGINT ? ValueFactory::GetBigIntValue(v)
+                                 : ValueFactory::GetIntegerValue(static_cast<int32_t>(v));
+}
+
+template <size_t KeySize>
+static void CheckAgainstStd(const char *create_stmt, int n) {
+  auto key_schema = ParseCreateStatement(create_stmt);
+  GenericComparator<KeySize> comparator(key_schema.get());
+  TypeId type = key_schema->GetColumn(0).GetType();
+  ASSERT_EQ(comparator.GetIntegerKeyType(), type);
+  std::mt19937 gen(15445);
+  std::uniform_int_distribution<int64_t> dist(-1000, 1000);
+
+  std::vector<int64_t> ints;
+  for (int i = 0; i < n; i++) {
+    ints.push_back(dist(gen));
+  }
+  std::sort(ints.begin(), ints.end());
+  std::vector<std::pair<GenericKey<KeySize>, RID>> array(ints.size());
+  for (size_t i = 0; i < ints.size(); i++) {
+    array[i].first.SetFromKey(Tuple({IntValue(type, ints[i])}, key_schema.get()));
+  }
+
+  for (int64_t probe = -1010; probe <= 1010; probe += 7) {
+    GenericKey<KeySize> key;
+    key.SetFromKey(Tuple({IntValue(type, probe)}, key_schema.get()));
+    int lower = std::lower_bound(ints.begin(), ints.end(), probe) - ints.begin();
+    int upper = std::upper_bound(ints.begin(), ints.end(), probe) - ints.begin();
+    ASSERT_EQ(NodeSearch::LowerBound(array.data(), 0, n, key, comparator), lower) << probe;
+    ASSERT_EQ(NodeSearch::UpperBound(array.data(), 0, n, key, comparator), upper) << probe;
+    // internal pages search from 1
+    ASSERT_EQ(NodeSearch::LowerBound(array.data(), 1, n, key, comparator), std::max(lower, 1)) << probe;
+  }
+}
+
+TEST(BPlusTreeNodeSearchTest, IntegerKeys) {
+  for (int n : {0, 1, 5, 16, 17, 100, 255}) {
+    CheckAgainstStd<8>("a bigint", n);
+    CheckAgainstStd<4>("a integer", n);
+  }
+}
+
+TEST(BPlusTreeNodeSearchTest, ComparatorKeys) {
+  // two columns: not an integer key, goes through the comparator
+  auto key_schema = ParseCreateStatement("a integer,b integer");
+  GenericComparator<8> comparator(key_schema.get());
+  ASSERT_EQ(comparator.GetIntegerKeyType(), TypeId::INVALID);
+
+  std::vector<std::pair<GenericKey<8>, RID>> array(60);
+  for (int i = 0; i < 60; i++) {
+    Tuple tuple({ValueFactory::GetIntegerValue(i / 10), ValueFactory::GetIntegerValue(i % 10 * 2)}, key_schema.get());
+    array[i].first.SetFromKey(tuple);
+  }
+  GenericKey<8> key;
+  key.SetFromKey(Tuple({ValueFactory::GetIntegerValue(3), ValueFactory::GetIntegerValue(4)}, key_schema.get()));
+  EXPECT_EQ(NodeSearch::LowerBound(array.data(), 0, 60, key, comparator), 32);
+  EXPECT_EQ(NodeSearch::UpperBound(array.data(), 0, 60, key, comparator), 33);
+  key.SetFromKey(Tuple({ValueFactory::GetIntegerValue(3), ValueFactory::GetIntegerValue(5)}, key_schema.get()));
+  EXPECT_EQ(NodeSearch::LowerBound(array.data(), 0, 60, key, comparator), 33);
+  EXPECT_EQ(NodeSearch::UpperBound(array.data(), 0, 60, key, comparator), 33);
+}
+
+static void CheckEytzinger(const char *create_stmt) {
+  auto key_schema = ParseCreateStatement(create_stmt);
+  GenericComparator<8> comparator(key_schema.get());
+  auto make_key = [&](int64_t v) {
+    std::vector<Value> values;
+    if (key_schema->GetColumnCount() == 1) {
+      values.push_back(ValueFactory::GetBigIntValue(v));
+    } else {  // 两列不走整数快速路径
+      values.push_back(ValueFactory::GetIntegerValue(0));
+      values.push_back(ValueFactory::GetIntegerValue(static_cast<int32_t>(v)));
+    }
+    GenericKey<8> key;
+    key.SetFromKey(Tuple(values, key_schema.get()));
+    return key;
+  };
+
+  for (int m : {0, 1, 2, 7, 8, 100, 340}) {
+    // internal page 的形状: [0] 没有 key, [1, m] 有序
+    std::vector<std::pair<GenericKey<8>, page_id_t>> array(m + 1);
+    std::vector<int64_t> sorted;
+    for (int i = 1; i <= m; i++) {
+      array[i] = {make_key(i * 3), i};
+      sorted.push_back(i * 3);
+    }
+    NodeSearch::ToEytzinger(array.data(), m);
+    for (int k = 1; k <= m; k++) {
+      int rank = NodeSearch::EytzingerRank(k, m);
+      ASSERT_EQ(array[k].second, rank);
+      ASSERT_EQ(NodeSearch::EytzingerPosition(rank, m), k);
+    }
+    for (int64_t probe = -2; probe <= m * 3 + 2; probe++) {
+      int k = NodeSearch::EytzingerLastNotAfter(array.data(), m, make_key(probe), comparator);
+      int expected = std::upper_bound(sorted.begin(), sorted.end(), probe) - sorted.begin();
+      ASSERT_EQ(k == 0 ? 0 : NodeSearch::EytzingerRank(k, m), expected) << m << " " << probe;
+    }
+    NodeSearch::FromEytzinger(array.data(), m);
+    for (int i = 1; i <= m; i++) {
+      ASSERT_EQ(array[i].second, i);
+    }
+  }
+}
+
+TEST(BPlusTreeNodeSearchTest, Eytzinger) {
+  CheckEytzinger("a bigint");
+  CheckEytzinger("a integer,b integer");
+}
+
+}  // namespace bustub
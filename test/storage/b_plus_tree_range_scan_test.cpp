@@ -0,0 +1,174 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_range_scan_test.cpp
+//
+// Identification: test/storage/b_plus_tree_range_scan_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using RangeTree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+static auto Key(int64_t v) -> std::optional<GenericKey<8>> {
+  GenericKey<8> key;
+  key.SetFromInteger(v);
+  return key;
+}
+
+static auto Collect(RangeTree *tree, std::optional<GenericKey<8>> low, bool low_inclusive,
+                    std::optional<GenericKey<8>> high, bool high_inclusive, bool reverse) -> std::vector<int64_t> {
+  std::vector<int64_t> keys;
+  for (auto it = tree->RangeBegin(low, low_inclusive, high, high_inclusive, reverse); !it.IsEnd(); ++it) {
+    keys.push_back((*it).second.GetSlotNum());
+  }
+  return keys;
+}
+
+static auto Expected(int64_t from, int64_t to, int64_t step) -> std::vector<int64_t> {
+  std::vector<int64_t> keys;
+  for (int64_t v = from; step > 0 ? v <= to : v >= to; v += step) {
+    keys.push_back(v);
+  }
+  return keys;
+}
+
+TEST(BPlusTreeTests, RangeScanTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(100, disk_manager);
+  // small nodes: the scans below cross many leaf pages under a three level tree
+  RangeTree tree("foo_pk", bpm, comparator, 8, 5);
+  auto *transaction = new Transaction(0);
+
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  ASSERT_EQ(page_id, HEADER_PAGE_ID);
+  (void)header_page;
+
+  EXPECT_TRUE(tree.RangeBegin(std::nullopt, true, std::nullopt, true, true).IsEnd());
+
+  // even keys 0, 2, ..., 398
+  std::vector<int64_t> keys = Expected(0, 398, 2);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  for (auto v : keys) {
+    GenericKey<8> index_key;
+    index_key.SetFromInteger(v);
+    tree.Insert(index_key, RID(0, v), transaction);
+  }
+
+  // forward
+  EXPECT_EQ(Collect(&tree, std::nullopt, true, std::nullopt, true, false), Expected(0, 398, 2));
+  EXPECT_EQ(Collect(&tree, Key(10), true, Key(50), true, false), Expected(10, 50, 2));
+  EXPECT_EQ(Collect(&tree, Key(10), false, Key(50), false, false), Expected(12, 48, 2));
+  EXPECT_EQ(Collect(&tree, Key(11), true, Key(51), true, false), Expected(12, 50, 2));
+  EXPECT_EQ(Collect(&tree, std::nullopt, true, Key(7), true, false), Expected(0, 6, 2));
+  EXPECT_EQ(Collect(&tree, Key(391), false, std::nullopt, true, false), Expected(392, 398, 2));
+  EXPECT_EQ(Collect(&tree, Key(42), true, Key(42), true, false), Expected(42, 42, 2));
+  EXPECT_TRUE(Collect(&tree, Key(42), false, Key(42), true, false).empty());
+  EXPECT_TRUE(Collect(&tree, Key(399), true, std::nullopt, true, false).empty());
+
+  // reverse, along the prev links
+  EXPECT_EQ(Collect(&tree, std::nullopt, true, std::nullopt, true, true), Expected(398, 0, -2));
+  EXPECT_EQ(Collect(&tree, Key(10), true, Key(50), true, true), Expected(50, 10, -2));
+  EXPECT_EQ(Collect(&tree, Key(10), false, Key(50), false, true), Expected(48, 12, -2));
+  EXPECT_EQ(Collect(&tree, Key(11), true, Key(51), true, true), Expected(50, 12, -2));
+  EXPECT_EQ(Collect(&tree, Key(391), true, std::nullopt, true, true), Expected(398, 392, -2));
+  EXPECT_EQ(Collect(&tree, std::nullopt, true, Key(7), false, true), Expected(6, 0, -2));
+  EXPECT_TRUE(Collect(&tree, std::nullopt, true, Key(0), false, true).empty());
+
+  // a finished scan leaves nothing pinned: every frame can still be used
+  std::vector<page_id_t> pages;
+  for (int i = 0; i < 99; i++) {
+    page_id_t new_page_id;
+    ASSERT_NE(bpm->NewPage(&new_page_id), nullptr) << i;
+    pages.push_back(new_page_id);
+  }
+  for (auto id : pages) {
+    bpm->UnpinPage(id, false);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+// LIMIT 停在扫描中途: 丢掉的迭代器放掉它 pin 的叶子
+TEST(BPlusTreeTests, AbandonedRangeScanTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  // 树比 buffer pool 大, 每个漏掉的 pin 都占住一个 frame, 漏几次就没 frame 可用了
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(16, disk_manager);
+  RangeTree tree("foo_pk", bpm, comparator, 8, 5);
+  auto *transaction = new Transaction(0);
+
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  for (int64_t v = 0; v < 400; v++) {
+    GenericKey<8> index_key;
+    index_key.SetFromInteger(v);
+    tree.Insert(index_key, RID(0, v), transaction);
+  }
+
+  for (int64_t start = 0; start < 400; start += 7) {
+    for (bool reverse : {false, true}) {
+      auto it = reverse ? tree.RangeBegin(std::nullopt, true, Key(start), true, true)
+                        : tree.RangeBegin(Key(start), true, std::nullopt, true);
+      for (int n = 0; n < 3 && !it.IsEnd(); n++) {
+        ASSERT_EQ((*it).second.GetSlotNum(), reverse ? start - n : start + n);
+        ++it;
+      }
+    }
+  }
+
+  // 移动后只有新的迭代器拥有叶子
+  auto moved_from = tree.RangeBegin(Key(100), true, Key(200), true);
+  auto it = std::move(moved_from);
+  EXPECT_TRUE(moved_from.IsEnd());  // NOLINT
+  ASSERT_FALSE(it.IsEnd());
+  EXPECT_EQ((*it).second.GetSlotNum(), 100);
+  it = tree.RangeBegin(Key(300), true, std::nullopt, true);
+  EXPECT_EQ((*it).second.GetSlotNum(), 300);
+  it = tree.End();
+
+  std::vector<page_id_t> pages;
+  for (int i = 0; i < 15; i++) {
+    page_id_t new_page_id;
+    ASSERT_NE(bpm->NewPage(&new_page_id), nullptr) << i;
+    pages.push_back(new_page_id);
+  }
+  for (auto id : pages) {
+    bpm->UnpinPage(id, false);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,213 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_reindex_test.cpp
+//
+// Identification: test/storage/b_plus_tree_reindex_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using ReindexTree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+static void InsertKeys(ReindexTree *tree, int64_t from, int64_t to, Transaction *transaction) {
+  std::vector<int64_t> keys;
+  for (int64_t key = from; key < to; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  GenericKey<8> index_key;
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    tree->Insert(index_key, RID(0, key), transaction);
+  }
+}
+
+static void CheckKeys(ReindexTree *tree, int64_t num_keys) {
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < num_keys; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree->GetValue(index_key, &rids)) << key;
+    EXPECT_EQ(rids[0].GetSlotNum(), key);
+  }
+  int64_t expected = 0;
+  for (auto it = tree->Begin(); !it.IsEnd(); ++it) {
+    EXPECT_EQ((*it).second.GetSlotNum(), expected++);
+  }
+  EXPECT_EQ(expected, num_keys);
+  for (auto it = tree->RangeBegin(std::nullopt, true, std::nullopt, true, true); !it.IsEnd(); ++it) {
+    EXPECT_EQ((*it).second.GetSlotNum(), --expected);
+  }
+  EXPECT_EQ(expected, 0);
+}
+
+TEST(BPlusTreeTests, ReindexTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  // leaves hold up to 7 entries, internal pages up to 4 children
+  ReindexTree tree("foo_pk", bpm, comparator, 8, 5);
+  auto *transaction = new Transaction(0);
+
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  ASSERT_EQ(page_id, HEADER_PAGE_ID);
+  (void)header_page;
+
+  EXPECT_EQ(tree.GetStats().height_, 0);
+  tree.Reindex(1.0, transaction);
+  EXPECT_TRUE(tree.IsEmpty());
+
+  // random inserts: half full leaves, scattered over the file
+  InsertKeys(&tree, 0, 500, transaction);
+  auto before = tree.GetStats();
+  EXPECT_EQ(before.entries_, 500);
+  EXPECT_LT(before.fill_factor_, 0.9);
+  EXPECT_LT(before.leaf_contiguity_, 0.5);
+
+  tree.Reindex(1.0, transaction);
+  auto after = tree.GetStats();
+  EXPECT_EQ(after.entries_, 500);
+  EXPECT_EQ(after.leaf_pages_, 72);  // ceil(500 / 7)
+  EXPECT_GT(after.fill_factor_, 0.99);
+  EXPECT_EQ(after.leaf_contiguity_, 1.0);
+  EXPECT_LE(after.height_, before.height_);
+  EXPECT_EQ(after.internal_pages_, 18 + 5 + 2 + 1);
+  CheckKeys(&tree, 500);
+
+  // the packed tree splits as usual
+  InsertKeys(&tree, 500, 600, transaction);
+  CheckKeys(&tree, 600);
+
+  tree.Reindex(0.5, transaction);
+  after = tree.GetStats();
+  EXPECT_EQ(after.leaf_pages_, 200);  // 3 entries per leaf
+  EXPECT_EQ(after.leaf_contiguity_, 1.0);
+  CheckKeys(&tree, 600);
+
+  // nothing is left pinned
+  std::vector<page_id_t> pages;
+  for (int i = 0; i < 63; i++) {
+    page_id_t new_page_id;
+    ASSERT_NE(bpm->NewPage(&new_page_id), nullptr) << i;
+    pages.push_back(new_page_id);
+  }
+  for (auto id : pages) {
+    bpm->UnpinPage(id, false);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, ReindexEytzingerTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  // full-size internal pages, so the root holds hundreds of keys in Eytzinger order
+  ReindexTree tree("foo_pk", bpm, comparator, 8);
+  auto *transaction = new Transaction(0);
+
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+
+  InsertKeys(&tree, 0, 2000, transaction);
+  tree.Reindex(1.0, transaction);
+  auto *root = bpm->FetchPage(tree.GetRootPageId());
+  EXPECT_EQ(reinterpret_cast<BPlusTreePage *>(root->GetData())->GetPageType(), IndexPageType::EYTZINGER_INTERNAL_PAGE);
+  bpm->UnpinPage(root->GetPageId(), false);
+  CheckKeys(&tree, 2000);
+
+  // writes turn the pages they touch back into the sorted layout
+  GenericKey<8> index_key;
+  for (int64_t key = 1000; key < 2000; key++) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+  }
+  CheckKeys(&tree, 1000);
+  InsertKeys(&tree, 1000, 3000, transaction);
+  CheckKeys(&tree, 3000);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, ReindexWithOpenIteratorTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  // both trees stay resident, so a freed page shows up as no longer in the pool
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(512, disk_manager);
+  ReindexTree tree("foo_pk", bpm, comparator, 8, 5);
+  auto *transaction = new Transaction(0);
+
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+
+  InsertKeys(&tree, 0, 500, transaction);
+  page_id_t old_root = tree.GetRootPageId();
+  {
+    auto it = tree.Begin();
+    for (int i = 0; i < 100; i++) {
+      ++it;
+    }
+
+    // the iterator keeps the old tree alive across the root switch and the writes after it
+    tree.Reindex(1.0, transaction);
+    EXPECT_NE(tree.GetRootPageId(), old_root);
+    InsertKeys(&tree, 500, 600, transaction);
+    EXPECT_TRUE(bpm->IsPageResident(old_root));
+
+    int64_t expected = 100;
+    for (; !it.IsEnd() && expected < 300; ++it) {
+      EXPECT_EQ((*it).second.GetSlotNum(), expected++);
+    }
+    EXPECT_EQ(expected, 300);
+  }
+
+  // dropped in the middle of the range: the next write frees the old tree
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(599);
+  tree.Remove(index_key, transaction);
+  EXPECT_FALSE(bpm->IsPageResident(old_root));
+  CheckKeys(&tree, 599);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
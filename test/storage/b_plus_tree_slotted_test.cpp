@@ -0,0 +1,330 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_slotted_test.cpp
+//
+// Identification: test/storage/b_plus_tree_slotted_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/key_encoder.h"
+#include "storage/index/slotted_b_plus_tree.h"
+#include "storage/index/slotted_b_plus_tree_index.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+static auto MakeKey(int64_t tenant, int64_t id) -> std::string {
+  std::string key;
+  KeyEncoder::AppendValue(ValueFactory::GetBigIntValue(tenant), &key);
+  KeyEncoder::AppendValue(ValueFactory::GetBigIntValue(id), &key);
+  return key;
+}
+
+TEST(BPlusTreeSlottedTests, PageTest) {
+  auto *page = new char[BUSTUB_PAGE_SIZE];
+  auto *node = reinterpret_cast<BPlusTreeSlottedPage *>(page);
+  node->Init(1, IndexPageType::LEAF_PAGE, "customer_0100", "customer_0200", false);
+  EXPECT_EQ(node->GetPrefix(), "customer_0");
+
+  EXPECT_TRUE(node->InsertAt(0, "customer_0150", 150));
+  EXPECT_TRUE(node->InsertAt(0, "customer_0120", 120));
+  EXPECT_TRUE(node->InsertAt(2, "customer_0199", 199));
+  ASSERT_EQ(node->GetSize(), 3);
+  EXPECT_EQ(node->SuffixAt(0), "120");
+  EXPECT_EQ(node->KeyAt(1), "customer_0150");
+  EXPECT_EQ(node->ValueAt(2), 199);
+  EXPECT_EQ(node->LowerBound("customer_0130"), 1);
+  EXPECT_EQ(node->LowerBound("customer_0150"), 1);
+  EXPECT_EQ(node->LowerBound("customer_0199x"), 3);
+
+  // removed entries are reclaimed by compaction
+  int free_space = node->GetFreeSpace();
+  node->RemoveAt(1);
+  EXPECT_EQ(node->GetGarbageBytes(), node->EntrySize("customer_0150") - SLOTTED_PAGE_SLOT_SIZE);
+  node->Compact();
+  EXPECT_EQ(node->GetGarbageBytes(), 0);
+  EXPECT_EQ(node->GetFreeSpace(), free_space + node->EntrySize("customer_0150"));
+  EXPECT_EQ(node->KeyAt(1), "customer_0199");
+
+  EXPECT_EQ(BPlusTreeSlottedPage::ShortestSeparator("apple", "banana"), "b");
+  EXPECT_EQ(BPlusTreeSlottedPage::ShortestSeparator("customer_0149", "customer_0150"), "customer_015");
+  EXPECT_EQ(BPlusTreeSlottedPage::ShortestSeparator("ab", "abc"), "abc");
+  delete[] page;
+}
+
+TEST(BPlusTreeSlottedTests, InsertScanRemoveTest) {
+  auto *disk_manager = new DiskManager("slotted_test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  SlottedBPlusTree tree("foo_pk", bpm);
+  auto *transaction = new Transaction(0);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  ASSERT_EQ(page_id, HEADER_PAGE_ID);
+  (void)header_page;
+
+  // a few tenants with many ids: keys share long prefixes
+  std::vector<int64_t> ids;
+  for (int64_t i = 0; i < 5000; i++) {
+    ids.push_back(i);
+  }
+  std::shuffle(ids.begin(), ids.end(), std::mt19937(15445));
+  for (auto id : ids) {
+    EXPECT_TRUE(tree.Insert(MakeKey(id % 3, id), RID(id), transaction));
+  }
+  EXPECT_FALSE(tree.Insert(MakeKey(1, 1), RID(1), transaction));
+  EXPECT_GE(tree.GetHeight(), 2);
+
+  std::vector<RID> rids;
+  for (int64_t id = 0; id < 5000; id++) {
+    rids.clear();
+    ASSERT_TRUE(tree.GetValue(MakeKey(id % 3, id), &rids));
+    ASSERT_EQ(rids.size(), 1);
+    EXPECT_EQ(rids[0].Get(), id);
+  }
+  EXPECT_FALSE(tree.GetValue(MakeKey(0, 1), &rids));
+
+  // full scan comes back in (tenant, id) order
+  int64_t count = 0;
+  std::string last;
+  for (auto it = tree.Begin(); !it.IsEnd(); ++it) {
+    EXPECT_LT(last, (*it).first);
+    last = (*it).first;
+    count++;
+  }
+  EXPECT_EQ(count, 5000);
+
+  // remove even ids, scan tenant 1 from its first key
+  for (int64_t id = 0; id < 5000; id += 2) {
+    tree.Remove(MakeKey(id % 3, id), transaction);
+  }
+  count = 0;
+  for (auto it = tree.Begin(MakeKey(1, 0)); !it.IsEnd(); ++it) {
+    auto tenant = KeyEncoder::DecodeBigInt((*it).first);
+    if (tenant != 1) {
+      break;
+    }
+    EXPECT_EQ((*it).second.Get() % 2, 1);
+    count++;
+  }
+  EXPECT_EQ(count, 834);
+
+  for (int64_t id = 0; id < 5000; id += 2) {
+    EXPECT_TRUE(tree.Insert(MakeKey(id % 3, id), RID(id), transaction));
+  }
+  count = 0;
+  for (auto it = tree.Begin(); it != tree.End(); ++it) {
+    count++;
+  }
+  EXPECT_EQ(count, 5000);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("slotted_test.db");
+  remove("slotted_test.log");
+}
+
+TEST(BPlusTreeSlottedTests, DuplicateKeyTest) {
+  auto *disk_manager = new DiskManager("slotted_test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  SlottedBPlusTree tree("foo_idx", bpm, false);
+  auto *transaction = new Transaction(0);
+
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  ASSERT_EQ(page_id, HEADER_PAGE_ID);
+  (void)header_page;
+
+  // key k gets k * k RIDs: short inline lists, lists moved to posting pages and chains of several posting pages
+  std::mt19937 gen(15445);
+  std::vector<std::pair<int64_t, RID>> entries;
+  for (int64_t k = 1; k <= 40; k++) {
+    for (int64_t i = 0; i < k * k; i++) {
+      entries.emplace_back(k, RID(static_cast<page_id_t>(gen() % 2000), static_cast<uint32_t>(i)));
+    }
+  }
+  std::shuffle(entries.begin(), entries.end(), gen);
+  for (const auto &[k, rid] : entries) {
+    ASSERT_TRUE(tree.Insert(MakeKey(k, 0), rid, transaction));
+  }
+  EXPECT_FALSE(tree.Insert(MakeKey(entries[0].first, 0), entries[0].second, transaction));
+
+  auto check = [&](int64_t k, std::vector<RID> expected) {
+    std::sort(expected.begin(), expected.end(), [](const RID &a, const RID &b) { return a.Get() < b.Get(); });
+    std::vector<RID> rids;
+    ASSERT_EQ(tree.GetValue(MakeKey(k, 0), &rids), !expected.empty());
+    ASSERT_EQ(rids, expected) << k;
+  };
+  std::vector<std::vector<RID>> expected(41);
+  for (const auto &[k, rid] : entries) {
+    expected[k].push_back(rid);
+  }
+  for (int64_t k = 1; k <= 40; k++) {
+    check(k, expected[k]);
+  }
+
+  int64_t count = 0;
+  for (auto it = tree.Begin(); !it.IsEnd(); ++it) {
+    count++;
+  }
+  EXPECT_EQ(count, static_cast<int64_t>(entries.size()));
+
+  // remove most RIDs: posting pages are freed and small lists move back inline
+  for (const auto &[k, rid] : entries) {
+    if (rid.GetSlotNum() >= 3) {
+      ASSERT_TRUE(tree.Remove(MakeKey(k, 0), rid, transaction));
+    }
+  }
+  EXPECT_FALSE(tree.Remove(MakeKey(40, 0), RID(0, 100), transaction));
+  for (int64_t k = 1; k <= 40; k++) {
+    std::vector<RID> left;
+    for (const auto &rid : expected[k]) {
+      if (rid.GetSlotNum() < 3) {
+        left.push_back(rid);
+      }
+    }
+    check(k, left);
+  }
+  for (const auto &rid : expected[2]) {
+    if (rid.GetSlotNum() < 3) {
+      ASSERT_TRUE(tree.Remove(MakeKey(2, 0), rid, transaction));
+    }
+  }
+  check(2, {});
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("slotted_test.db");
+  remove("slotted_test.log");
+}
+
+TEST(BPlusTreeSlottedTests, IndexScanKeyTest) {
+  auto *disk_manager = new DiskManager("slotted_test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+
+  auto schema = ParseCreateStatement("a bigint,b integer");
+  auto metadata = std::make_unique<IndexMetadata>("b_idx", "t", schema.get(), std::vector<uint32_t>{1});
+  SlottedBPlusTreeIndex index(std::move(metadata), bpm);
+  auto *key_schema = index.GetKeySchema();
+  for (int i = 0; i < 300; i++) {
+    Tuple key({ValueFactory::GetIntegerValue(i % 3)}, key_schema);
+    index.InsertEntry(key, RID(299 - i, 0), nullptr);
+  }
+  std::vector<RID> rids;
+  index.ScanKey(Tuple({ValueFactory::GetIntegerValue(1)}, key_schema), &rids, nullptr);
+  ASSERT_EQ(rids.size(), 100U);
+  for (size_t i = 1; i < rids.size(); i++) {
+    EXPECT_LT(rids[i - 1].GetPageId(), rids[i].GetPageId());
+  }
+  index.DeleteEntry(Tuple({ValueFactory::GetIntegerValue(1)}, key_schema), rids[0], nullptr);
+  rids.clear();
+  index.ScanKey(Tuple({ValueFactory::GetIntegerValue(1)}, key_schema), &rids, nullptr);
+  EXPECT_EQ(rids.size(), 99U);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("slotted_test.db");
+  remove("slotted_test.log");
+}
+
+TEST(BPlusTreeSlottedTests, VarcharKeyTest) {
+  auto *disk_manager = new DiskManager("slotted_test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(200, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+
+  auto schema = ParseCreateStatement("a integer,b varchar(2000)");
+  auto metadata = std::make_unique<IndexMetadata>("b_idx", "t", schema.get(), std::vector<uint32_t>{1});
+  SlottedBPlusTreeIndex index(std::move(metadata), bpm);
+  auto *key_schema = index.GetKeySchema();
+  auto make_key = [&](const std::string &s) { return Tuple({ValueFactory::GetVarcharValue(s)}, key_schema); };
+
+  // short keys, keys that are prefixes of each other, and oversized keys sharing the same truncated prefix
+  std::vector<std::string> strings = {"", "a", "ab", "abc", "b", std::string(300, 'm')};
+  std::string long_prefix(SLOTTED_PAGE_INLINE_KEY_SIZE + 10, 'x');
+  for (int i = 0; i < 40; i++) {
+    strings.push_back(long_prefix + std::to_string(i * 7919 % 1000));
+    strings.push_back(std::string(400 + i * 30, 'y') + std::to_string(i));
+  }
+  strings.push_back(long_prefix.substr(0, 100));
+  std::sort(strings.begin(), strings.end());
+  strings.erase(std::unique(strings.begin(), strings.end()), strings.end());
+  std::vector<std::string> shuffled = strings;
+  std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(15445));
+  for (const auto &s : shuffled) {
+    int pos = std::lower_bound(strings.begin(), strings.end(), s) - strings.begin();
+    index.InsertEntry(make_key(s), RID(pos, 0), nullptr);
+  }
+  // 超长 key 的第二个 RID
+  index.InsertEntry(make_key(long_prefix + "0"), RID(9999, 0), nullptr);
+
+  // the scan yields the full keys in string order
+  std::vector<std::string> scanned;
+  for (auto it = index.GetBeginIterator(); !it.IsEnd(); ++it) {
+    Tuple key = KeyEncoder::Decode((*it).first, key_schema);
+    std::string str = key.GetValue(key_schema, 0).ToString();
+    if (scanned.empty() || scanned.back() != str) {
+      scanned.push_back(str);
+    }
+  }
+  EXPECT_EQ(scanned, strings);
+
+  for (size_t i = 0; i < strings.size(); i++) {
+    std::vector<RID> rids;
+    index.ScanKey(make_key(strings[i]), &rids, nullptr);
+    ASSERT_FALSE(rids.empty()) << strings[i].size();
+    EXPECT_EQ(rids[0], RID(i, 0));
+    EXPECT_EQ(rids.size(), strings[i] == long_prefix + "0" ? 2U : 1U);
+  }
+  std::vector<RID> rids;
+  index.ScanKey(make_key(long_prefix + "1"), &rids, nullptr);
+  EXPECT_TRUE(rids.empty());
+
+  // a scan starting inside a bucket of oversized keys
+  size_t from = std::lower_bound(strings.begin(), strings.end(), long_prefix + "5") - strings.begin();
+  {
+    auto it = index.GetBeginIterator(make_key(long_prefix + "5"));
+    ASSERT_FALSE(it.IsEnd());
+    EXPECT_EQ((*it).second, RID(from, 0));
+  }
+
+  // remove every other key
+  for (size_t i = 0; i < strings.size(); i += 2) {
+    index.DeleteEntry(make_key(strings[i]), RID(i, 0), nullptr);
+  }
+  for (size_t i = 0; i < strings.size(); i++) {
+    rids.clear();
+    index.ScanKey(make_key(strings[i]), &rids, nullptr);
+    bool keeps_second_rid = strings[i] == long_prefix + "0";
+    EXPECT_EQ(rids.empty(), i % 2 == 0 && !keeps_second_rid) << i;
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("slotted_test.db");
+  remove("slotted_test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,208 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_swizzle_test.cpp
+//
+// Identification: test/storage/b_plus_tree_swizzle_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using SwizzleTree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+/** GetValue every key in [0, num_keys), keys with key % step == phase are expected */
+static void CheckLookups(SwizzleTree *tree, int64_t num_keys, int64_t step, int64_t phase) {
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < num_keys; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    bool present = tree->GetValue(index_key, &rids);
+    if (key % step != phase) {
+      EXPECT_FALSE(present) << key;
+      continue;
+    }
+    ASSERT_TRUE(present) << key;
+    EXPECT_EQ(rids[0].GetSlotNum(), key);
+  }
+}
+
+static void InsertKeys(SwizzleTree *tree, std::vector<int64_t> keys, Transaction *transaction) {
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  GenericKey<8> index_key;
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    tree->Insert(index_key, RID(0, key), transaction);
+  }
+}
+
+TEST(BPlusTreeTests, SwizzleTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  // the tree is several times bigger than the pool: swizzled children get evicted under the descents
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  SwizzleTree tree("foo_pk", bpm, comparator, 8, 5);
+  tree.SetSwizzleLevels(3);
+  auto *transaction = new Transaction(0);
+
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  ASSERT_EQ(page_id, HEADER_PAGE_ID);
+  (void)header_page;
+
+  const int64_t num_keys = 1000;
+  std::vector<int64_t> odd_keys;
+  std::vector<int64_t> even_keys;
+  for (int64_t key = 0; key < num_keys; key++) {
+    (key % 2 == 1 ? odd_keys : even_keys).push_back(key);
+  }
+  InsertKeys(&tree, odd_keys, transaction);
+  CheckLookups(&tree, num_keys, 2, 1);
+
+  // splits under swizzled parents move their children to other slots and other pages
+  InsertKeys(&tree, even_keys, transaction);
+  CheckLookups(&tree, num_keys, 1, 0);
+
+  tree.SetSwizzleLevels(0);
+  CheckLookups(&tree, num_keys, 1, 0);
+  tree.SetSwizzleLevels(1);
+  CheckLookups(&tree, num_keys, 1, 0);
+
+  int64_t expected = 0;
+  for (auto it = tree.Begin(); !it.IsEnd(); ++it) {
+    EXPECT_EQ((*it).second.GetSlotNum(), expected++);
+  }
+  EXPECT_EQ(expected, num_keys);
+
+  // swizzled frames stay pinned, at most 64 / SWIZZLE_POOL_FRACTION of them; turning swizzling off releases them
+  std::vector<page_id_t> pages;
+  for (size_t i = 0; i < 63 - 64 / SWIZZLE_POOL_FRACTION; i++) {
+    page_id_t new_page_id;
+    ASSERT_NE(bpm->NewPage(&new_page_id), nullptr) << i;
+    pages.push_back(new_page_id);
+  }
+  for (auto id : pages) {
+    bpm->UnpinPage(id, false);
+  }
+  pages.clear();
+  tree.SetSwizzleLevels(0);
+  for (int i = 0; i < 63; i++) {
+    page_id_t new_page_id;
+    ASSERT_NE(bpm->NewPage(&new_page_id), nullptr) << i;
+    pages.push_back(new_page_id);
+  }
+  for (auto id : pages) {
+    bpm->UnpinPage(id, false);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, SwizzleUnderEvictionTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  // a few hundred pages of tree in 32 frames, while another thread keeps evicting whatever is not pinned,
+  // the way the vacuum thread and the scan workers share the pool with the index
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(32, disk_manager);
+  SwizzleTree tree("foo_pk", bpm, comparator, 8, 5);
+  tree.SetSwizzleLevels(3);
+  auto *transaction = new Transaction(0);
+
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+
+  std::atomic<bool> stop{false};
+  std::thread churn([&]() {
+    while (!stop) {
+      page_id_t churn_page_id;
+      Page *page = bpm->NewPage(&churn_page_id);
+      if (page != nullptr) {
+        page->GetData()[0] = 1;
+        bpm->UnpinPage(churn_page_id, true);
+      }
+    }
+  });
+
+  const int64_t num_keys = 2000;
+  std::vector<int64_t> odd_keys;
+  std::vector<int64_t> even_keys;
+  for (int64_t key = 0; key < num_keys; key++) {
+    (key % 2 == 1 ? odd_keys : even_keys).push_back(key);
+  }
+  InsertKeys(&tree, odd_keys, transaction);
+  CheckLookups(&tree, num_keys, 2, 1);
+  InsertKeys(&tree, even_keys, transaction);
+  CheckLookups(&tree, num_keys, 1, 0);
+
+  // merges delete pages under swizzled parents
+  GenericKey<8> index_key;
+  for (auto key : odd_keys) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+  }
+  CheckLookups(&tree, num_keys, 2, 0);
+  int64_t expected = 0;
+  for (auto it = tree.Begin(); !it.IsEnd(); ++it) {
+    EXPECT_EQ((*it).second.GetSlotNum(), expected);
+    expected += 2;
+  }
+  EXPECT_EQ(expected, num_keys);
+
+  stop = true;
+  churn.join();
+
+  // nothing but the swizzled frames is left pinned
+  std::vector<page_id_t> pages;
+  for (size_t i = 0; i < 31 - 32 / SWIZZLE_POOL_FRACTION; i++) {
+    page_id_t new_page_id;
+    ASSERT_NE(bpm->NewPage(&new_page_id), nullptr) << i;
+    pages.push_back(new_page_id);
+  }
+  for (auto id : pages) {
+    bpm->UnpinPage(id, false);
+  }
+  pages.clear();
+  tree.SetSwizzleLevels(0);
+  for (int i = 0; i < 31; i++) {
+    page_id_t new_page_id;
+    ASSERT_NE(bpm->NewPage(&new_page_id), nullptr) << i;
+    pages.push_back(new_page_id);
+  }
+  for (auto id : pages) {
+    bpm->UnpinPage(id, false);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
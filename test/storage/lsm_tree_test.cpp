@@ -0,0 +1,144 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lsm_tree_test.cpp
+//
+// Identification: test/storage/lsm_tree_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/lsm_tree.h"
+
+namespace bustub {
+
+/** 8 字节前缀 + 1 字节后缀, bloom filter 按前缀 */
+static auto MakeKey(uint32_t prefix, uint8_t suffix) -> std::string {
+  char buf[16];
+  snprintf(buf, sizeof(buf), "%08u", prefix);
+  return std::string(buf) + static_cast<char>(suffix);
+}
+
+static void CheckTree(const LsmTree &tree, const std::map<std::string, bool> &reference) {
+  auto expected = reference.begin();
+  for (auto it = tree.Scan("", std::nullopt, std::nullopt); !it.IsEnd(); ++it, ++expected) {
+    ASSERT_NE(expected, reference.end());
+    ASSERT_EQ(it.Key(), expected->first);
+  }
+  EXPECT_EQ(expected, reference.end());
+}
+
+TEST(LsmTreeTest, RandomPutAndDelete) {
+  auto *disk_manager = new DiskManager("lsm_tree_test.db");
+  auto *bpm = new BufferPoolManagerInstance(32, disk_manager);
+  std::map<std::string, bool> reference;
+  {
+    // 小 memtable, 写入过程中会多次冻结, 写 level 0 并一路 compaction 到更深的层
+    LsmTree tree(bpm, 1, 4096, 2, 4);
+    std::mt19937 rng(15445);
+    for (int i = 0; i < 30000; i++) {
+      std::string key = MakeKey(rng() % 5000, rng() % 3);
+      if (rng() % 4 == 0) {
+        tree.Put(key, true);
+        reference.erase(key);
+      } else {
+        tree.Put(key, false);
+        reference[key] = true;
+      }
+    }
+    // 写入还在后台落盘的时候读
+    CheckTree(tree, reference);
+
+    tree.Flush();
+    auto shape = tree.GetShape();
+    EXPECT_LT(shape[0], 2U);
+    EXPECT_GE(shape.size(), 3U);
+    CheckTree(tree, reference);
+
+    // 点查 (带 bloom key) 和范围扫描
+    for (uint32_t prefix = 0; prefix < 5000; prefix += 7) {
+      std::string low = MakeKey(prefix, 0);
+      low.pop_back();
+      std::vector<std::string> found;
+      for (auto it = tree.Scan(low, LsmTree::Successor(low), low); !it.IsEnd(); ++it) {
+        found.push_back(it.Key());
+      }
+      std::vector<std::string> expected;
+      for (auto it = reference.lower_bound(low); it != reference.end() && it->first.compare(0, 8, low) == 0; ++it) {
+        expected.push_back(it->first);
+      }
+      ASSERT_EQ(found, expected) << low;
+    }
+    size_t count = 0;
+    for (auto it = tree.Scan(MakeKey(1000, 0), MakeKey(2000, 0), std::nullopt); !it.IsEnd(); ++it) {
+      count++;
+    }
+    EXPECT_EQ(count, std::distance(reference.lower_bound(MakeKey(1000, 0)), reference.lower_bound(MakeKey(2000, 0))));
+
+    // 全部删掉, 合并到最深的一层后墓碑也没了
+    for (const auto &[key, unused] : reference) {
+      tree.Put(key, true);
+    }
+    reference.clear();
+    CheckTree(tree, reference);
+  }
+
+  delete bpm;
+  delete disk_manager;
+  remove("lsm_tree_test.db");
+  remove("lsm_tree_test.log");
+}
+
+TEST(LsmTreeTest, ConcurrentReaders) {
+  auto *disk_manager = new DiskManager("lsm_tree_test.db");
+  auto *bpm = new BufferPoolManagerInstance(32, disk_manager);
+  {
+    LsmTree tree(bpm, 0, 2048, 2, 4);
+    // 写者按顺序写; 读者的快照里看到的 key 必须是连续的前缀 0..n-1
+    const uint32_t total = 20000;
+    std::thread writer([&] {
+      for (uint32_t i = 0; i < total; i++) {
+        tree.Put(MakeKey(i, 0), false);
+      }
+    });
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 2; r++) {
+      readers.emplace_back([&] {
+        for (int round = 0; round < 20; round++) {
+          uint32_t next = 0;
+          for (auto it = tree.Scan("", std::nullopt, std::nullopt); !it.IsEnd(); ++it, ++next) {
+            ASSERT_EQ(it.Key(), MakeKey(next, 0));
+          }
+        }
+      });
+    }
+    writer.join();
+    for (auto &reader : readers) {
+      reader.join();
+    }
+    tree.Flush();
+    uint32_t next = 0;
+    for (auto it = tree.Scan("", std::nullopt, std::nullopt); !it.IsEnd(); ++it, ++next) {
+      ASSERT_EQ(it.Key(), MakeKey(next, 0));
+    }
+    EXPECT_EQ(next, total);
+  }
+
+  delete bpm;
+  delete disk_manager;
+  remove("lsm_tree_test.db");
+  remove("lsm_tree_test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,200 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// copy_from_test.cpp
+//
+// Identification: test/table/copy_from_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "common/bustub_instance.h"
+#include "common/exception.h"
+#include "common/util/csv_reader.h"
+#include "common/util/string_util.h"
+#include "concurrency/transaction_manager.h"
+#include "gtest/gtest.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+static auto ExecSql(BustubInstance *instance, const std::string &sql) -> std::string {
+  std::stringstream ss;
+  auto writer = SimpleStreamWriter(ss, true, " ");
+  instance->ExecuteSql(sql, writer);
+  return ss.str();
+}
+
+static void WriteFile(const std::string &path, const std::string &content) {
+  std::ofstream file(path, std::ios::binary);
+  file << content;
+}
+
+/** rows in the heap of table */
+static auto CountRows(BustubInstance *instance, const std::string &table) -> size_t {
+  auto *heap = instance->catalog_->GetTable(table)->table_.get();
+  size_t rows = 0;
+  for (auto it = heap->Begin(nullptr); it != heap->End(); ++it) {
+    rows++;
+  }
+  return rows;
+}
+
+TEST(CopyFromTest, CsvReader) {
+  // 引号里的分隔符, 换行和 "", \r\n 结尾, 最后一行没有换行
+  WriteFile("copy_from_test.csv", "a,\"b,c\",\"x\"\"y\"\r\n,\"\",\"two\nlines\"\n1|2\n\"tail\"");
+  CsvReader reader("copy_from_test.csv");
+  std::vector<std::string_view> fields;
+  ASSERT_TRUE(reader.NextRow(&fields));
+  EXPECT_EQ(fields, (std::vector<std::string_view>{"a", "b,c", "x\"y"}));
+  ASSERT_TRUE(reader.NextRow(&fields));
+  EXPECT_EQ(fields, (std::vector<std::string_view>{"", "", "two\nlines"}));
+  EXPECT_FALSE(reader.IsQuoted(0));
+  EXPECT_TRUE(reader.IsQuoted(1));
+  ASSERT_TRUE(reader.NextRow(&fields));
+  EXPECT_EQ(fields, (std::vector<std::string_view>{"1|2"}));
+  ASSERT_TRUE(reader.NextRow(&fields));
+  EXPECT_EQ(fields, (std::vector<std::string_view>{"tail"}));
+  EXPECT_FALSE(reader.NextRow(&fields));
+
+  // 跨过读入块边界的记录, 以及比整个块还长的字段
+  std::string big(3 << 20, 'z');
+  std::string content;
+  for (int i = 0; i < 100000; i++) {
+    content += std::to_string(i) + ",\"" + std::to_string(i) + "\"\"q\"\n";
+  }
+  content += big + "\n";
+  WriteFile("copy_from_test.csv", content);
+  CsvReader long_reader("copy_from_test.csv");
+  for (int i = 0; i < 100000; i++) {
+    ASSERT_TRUE(long_reader.NextRow(&fields));
+    ASSERT_EQ(fields.size(), 2);
+    ASSERT_EQ(fields[0], std::to_string(i));
+    ASSERT_EQ(fields[1], std::to_string(i) + "\"q");
+  }
+  ASSERT_TRUE(long_reader.NextRow(&fields));
+  EXPECT_EQ(fields[0], big);
+  EXPECT_FALSE(long_reader.NextRow(&fields));
+
+  WriteFile("copy_from_test.csv", "a,b\"c\n");
+  CsvReader bad_reader("copy_from_test.csv");
+  EXPECT_THROW(bad_reader.NextRow(&fields), Exception);
+  WriteFile("copy_from_test.csv", "\"never closed\n");
+  CsvReader unterminated_reader("copy_from_test.csv");
+  EXPECT_THROW(unterminated_reader.NextRow(&fields), Exception);
+  remove("copy_from_test.csv");
+}
+
+TEST(CopyFromTest, Csv) {
+  auto instance = std::make_unique<BustubInstance>("copy_from_test.db");
+  instance->GenerateMockTable();
+  instance->GenerateTestTable();
+  ExecSql(instance.get(), "create table t1(v1 int, v2 varchar(32), v3 int);");
+  ExecSql(instance.get(), "insert into t1 values (0, 'old', 0);");
+  ExecSql(instance.get(), "create index t1v1 on t1(v1);");
+
+  WriteFile("copy_from_test.csv", "v1|v2|v3\n1|\"a|b\"|10\n2||20\n3|\"\"|\n");
+  EXPECT_EQ(ExecSql(instance.get(), "copy t1 from 'copy_from_test.csv' (format csv, delimiter '|', header);"),
+            "COPY 3 \n");
+  EXPECT_EQ(ExecSql(instance.get(), "select * from t1;"),
+            "0 old 0 \n1 a|b 10 \n2 varlen_null 20 \n3  integer_null \n");
+  // 索引在装完之后批量建好
+  const std::string lookup = "select v3 from t1 where v1 = 2;";
+  EXPECT_TRUE(StringUtil::Contains(ExecSql(instance.get(), "explain (o) " + lookup), "Index"));
+  EXPECT_EQ(ExecSql(instance.get(), lookup), "20 \n");
+
+  // 多页的文件
+  std::string content;
+  for (int i = 100; i < 20100; i++) {
+    content += fmt::format("{},row-{},{}\n", i, i, i * 2);
+  }
+  WriteFile("copy_from_test.csv", content);
+  EXPECT_EQ(ExecSql(instance.get(), "copy t1 from 'copy_from_test.csv';"), "COPY 20000 \n");
+  EXPECT_EQ(CountRows(instance.get(), "t1"), 20004);
+  EXPECT_EQ(ExecSql(instance.get(), "select v2, v3 from t1 where v1 = 12345;"), "row-12345 24690 \n");
+  // 之后的 insert 接在装入的页后面
+  ExecSql(instance.get(), "insert into t1 values (-1, 'after', 0);");
+  EXPECT_EQ(ExecSql(instance.get(), "select v2 from t1 where v1 = -1;"), "after \n");
+
+  // 出错时整个 COPY 不生效
+  WriteFile("copy_from_test.csv", content + "7,x,oops\n");
+  try {
+    ExecSql(instance.get(), "copy t1 from 'copy_from_test.csv';");
+    FAIL() << "a bad integer should fail the copy";
+  } catch (const Exception &e) {
+    EXPECT_TRUE(StringUtil::Contains(e.what(), "row 20001")) << e.what();
+  }
+  WriteFile("copy_from_test.csv", "1,2\n");
+  EXPECT_THROW(ExecSql(instance.get(), "copy t1 from 'copy_from_test.csv';"), Exception);
+  EXPECT_THROW(ExecSql(instance.get(), "copy t1 from 'copy_from_test_missing.csv';"), Exception);
+  EXPECT_EQ(CountRows(instance.get(), "t1"), 20005);
+  EXPECT_EQ(ExecSql(instance.get(), "select v2 from t1 where v1 = 7;"), "");
+
+  // SQL 只能建 int 和 varchar 列, 其他类型的表从 catalog 建
+  Schema schema({Column{"a", TypeId::BIGINT}, Column{"b", TypeId::BOOLEAN}, Column{"c", TypeId::DECIMAL},
+                 Column{"d", TypeId::SMALLINT}});
+  auto *txn = instance->transaction_manager_->Begin();
+  instance->catalog_->CreateTable(txn, "t2", schema);
+  instance->transaction_manager_->Commit(txn);
+  delete txn;
+  WriteFile("copy_from_test.csv", "-9000000000,t,1.5,-7\n,false,,\n");
+  EXPECT_EQ(ExecSql(instance.get(), "copy t2 from 'copy_from_test.csv';"), "COPY 2 \n");
+  auto *heap = instance->catalog_->GetTable("t2")->table_.get();
+  auto it = heap->Begin(nullptr);
+  EXPECT_EQ(it->GetValue(&schema, 0).GetAs<int64_t>(), -9000000000);
+  EXPECT_TRUE(it->GetValue(&schema, 1).GetAs<bool>());
+  EXPECT_EQ(it->GetValue(&schema, 2).GetAs<double>(), 1.5);
+  EXPECT_EQ(it->GetValue(&schema, 3).GetAs<int16_t>(), -7);
+  ++it;
+  EXPECT_TRUE(it->GetValue(&schema, 0).IsNull());
+  EXPECT_FALSE(it->GetValue(&schema, 1).GetAs<bool>());
+  EXPECT_TRUE(it->GetValue(&schema, 2).IsNull());
+  EXPECT_TRUE(it->GetValue(&schema, 3).IsNull());
+  WriteFile("copy_from_test.csv", "1,t,1,40000\n");
+  EXPECT_THROW(ExecSql(instance.get(), "copy t2 from 'copy_from_test.csv';"), Exception);
+
+  instance.reset();
+  remove("copy_from_test.csv");
+  remove("copy_from_test.db");
+  remove("copy_from_test.log");
+}
+
+TEST(CopyFromTest, Binary) {
+  auto instance = std::make_unique<BustubInstance>("copy_from_test.db");
+  instance->GenerateMockTable();
+  instance->GenerateTestTable();
+  ExecSql(instance.get(), "create table t1(v1 int, v2 varchar(16));");
+  const Schema &schema = instance->catalog_->GetTable("t1")->schema_;
+
+  std::string content;
+  for (int i = 0; i < 3; i++) {
+    Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(i, 'b'))}, &schema);
+    std::string bytes(tuple.GetLength() + sizeof(uint32_t), '\0');
+    tuple.SerializeTo(bytes.data());
+    content += bytes;
+  }
+  WriteFile("copy_from_test.bin", content);
+  EXPECT_EQ(ExecSql(instance.get(), "copy t1 from 'copy_from_test.bin' (format binary);"), "COPY 3 \n");
+  EXPECT_EQ(ExecSql(instance.get(), "select * from t1;"), "0  \n1 b \n2 bb \n");
+
+  // 截断的文件
+  WriteFile("copy_from_test.bin", content.substr(0, content.size() - 1));
+  EXPECT_THROW(ExecSql(instance.get(), "copy t1 from 'copy_from_test.bin' (format binary);"), Exception);
+  EXPECT_EQ(CountRows(instance.get(), "t1"), 3);
+
+  instance.reset();
+  remove("copy_from_test.bin");
+  remove("copy_from_test.db");
+  remove("copy_from_test.log");
+}
+
+}  // namespace bustub
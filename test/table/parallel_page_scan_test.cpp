@@ -0,0 +1,156 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_page_scan_test.cpp
+//
+// Identification: test/table/parallel_page_scan_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/bustub_instance.h"
+#include "concurrency/transaction.h"
+#include "gtest/gtest.h"
+#include "storage/table/parallel_page_scan.h"
+#include "storage/table/table_heap.h"
+#include "storage/table/table_page_scan.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+static auto ExecSql(BustubInstance *instance, const std::string &sql) -> std::string {
+  std::stringstream ss;
+  auto writer = SimpleStreamWriter(ss, true, " ");
+  instance->ExecuteSql(sql, writer);
+  return ss.str();
+}
+
+/** the tuples of a serial scan that pass filter */
+static auto SerialScan(TableHeap *heap, Transaction *txn, const ParallelPageScan::Filter &filter)
+    -> std::vector<Tuple> {
+  std::vector<Tuple> tuples;
+  TablePageScan scan(heap, txn);
+  while (scan.NextPage()) {
+    for (const auto &view : scan.GetViews()) {
+      Tuple tuple = view.ToTuple();
+      if (filter == nullptr || filter(tuple)) {
+        tuples.push_back(tuple);
+      }
+    }
+  }
+  return tuples;
+}
+
+TEST(ParallelPageScanTest, MatchesSerialScan) {
+  auto *disk_manager = new DiskManager("parallel_page_scan_test.db");
+  auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  LockManager lock_manager;
+  Transaction txn(0);
+  Schema schema({Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 64}});
+  TableHeap heap(bpm, &lock_manager, nullptr, &txn);
+  std::vector<RID> rids;
+  for (int i = 0; i < 5000; i++) {
+    Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(i % 50, 'v'))}, &schema);
+    RID rid;
+    ASSERT_TRUE(heap.InsertTuple(tuple, &rid, &txn));
+    rids.push_back(rid);
+  }
+  for (size_t i = 0; i < rids.size(); i += 3) {
+    ASSERT_TRUE(heap.MarkDelete(rids[i], &txn));
+    heap.ApplyDelete(rids[i], &txn);
+  }
+  size_t pages = heap.GetPageDirectory().size();
+  ASSERT_GT(pages, 20);
+  EXPECT_EQ(heap.GetPageDirectory().front(), heap.GetFirstPageId());
+
+  ParallelPageScan::Filter odd = [&](const Tuple &tuple) {
+    return tuple.GetValue(&schema, 0).GetAs<int32_t>() % 2 == 1;
+  };
+  for (const auto &filter : {ParallelPageScan::Filter{}, odd}) {
+    std::vector<Tuple> expected = SerialScan(&heap, &txn, filter);
+    for (size_t workers : {1, 3, 8}) {
+      // morsel 比 worker 少, 一样多, 多得多
+      for (size_t morsel_pages : {size_t{1}, size_t{4}, pages}) {
+        ParallelPageScan scan(&heap, &txn, workers, filter, std::nullopt, {}, morsel_pages);
+        EXPECT_EQ(scan.GetMorselCount(), (pages + morsel_pages - 1) / morsel_pages);
+        EXPECT_LE(scan.GetWorkerCount(), scan.GetMorselCount());
+        // 输出和单线程扫描一个顺序
+        Tuple tuple;
+        size_t n = 0;
+        while (scan.Next(&tuple)) {
+          ASSERT_LT(n, expected.size());
+          ASSERT_EQ(tuple.GetRid(), expected[n].GetRid());
+          ASSERT_EQ(tuple.GetValue(&schema, 1).ToString(), expected[n].GetValue(&schema, 1).ToString());
+          n++;
+        }
+        EXPECT_EQ(n, expected.size()) << workers << " " << morsel_pages;
+        EXPECT_FALSE(scan.Next(&tuple));
+      }
+    }
+  }
+
+  // 只读几个就不读了: 析构时 worker 停下
+  {
+    ParallelPageScan scan(&heap, &txn, 4, nullptr, std::nullopt, {}, 1);
+    Tuple tuple;
+    ASSERT_TRUE(scan.Next(&tuple));
+  }
+  // filter 抛的异常从 Next 出来
+  {
+    ParallelPageScan::Filter fail = [](const Tuple &) -> bool { throw std::runtime_error("bad tuple"); };
+    ParallelPageScan scan(&heap, &txn, 4, fail, std::nullopt, {}, 2);
+    Tuple tuple;
+    EXPECT_THROW(scan.Next(&tuple), std::runtime_error);
+  }
+
+  delete bpm;
+  delete disk_manager;
+  remove("parallel_page_scan_test.db");
+  remove("parallel_page_scan_test.log");
+}
+
+TEST(ParallelPageScanTest, Sql) {
+  auto instance = std::make_unique<BustubInstance>("parallel_page_scan_test.db");
+  instance->GenerateMockTable();
+  instance->GenerateTestTable();
+  ExecSql(instance.get(), "create table t1(v1 int, v2 varchar(32));");
+  ExecSql(instance.get(), "create table t2(v1 int, v2 varchar(32)) with (layout = pax);");
+  size_t workers = scan_workers;
+  for (const std::string table : {"t1", "t2"}) {
+    for (int batch = 0; batch < 20; batch++) {
+      std::string values;
+      for (int i = batch * 500; i < (batch + 1) * 500; i++) {
+        values += fmt::format("{}({}, 'value-{}')", values.empty() ? "" : ", ", i, i);
+      }
+      ExecSql(instance.get(), fmt::format("insert into {} values {};", table, values));
+    }
+    ASSERT_GT(instance->catalog_->GetTable(table)->table_->GetPageDirectory().size(), SCAN_MORSEL_PAGES);
+
+    std::vector<std::string> queries{fmt::format("select * from {};", table),
+                                     fmt::format("select v2 from {} where v1 > 9000 and v1 < 9010;", table),
+                                     fmt::format("select v1 from {} where v2 = 'value-4321';", table)};
+    scan_workers = 1;
+    std::vector<std::string> expected;
+    for (const auto &query : queries) {
+      expected.push_back(ExecSql(instance.get(), query));
+    }
+    scan_workers = 4;
+    for (size_t i = 0; i < queries.size(); i++) {
+      EXPECT_EQ(ExecSql(instance.get(), queries[i]), expected[i]) << queries[i];
+    }
+    EXPECT_EQ(ExecSql(instance.get(), queries[2]), "4321 \n");
+  }
+  scan_workers = workers;
+}
+
+}  // namespace bustub
@@ -0,0 +1,228 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pax_table_test.cpp
+//
+// Identification: test/table/pax_table_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/bustub_instance.h"
+#include "common/exception.h"
+#include "common/util/string_util.h"
+#include "concurrency/transaction.h"
+#include "gtest/gtest.h"
+#include "storage/table/table_heap.h"
+#include "storage/table/table_page_scan.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+static auto MakeTuple(int i, const Schema *schema) -> Tuple {
+  // 每 5 行一个 NULL 的 varchar, 每 11 行一个 NULL 的 bigint
+  Value name = i % 5 == 0 ? ValueFactory::GetNullValueByType(TypeId::VARCHAR)
+                          : ValueFactory::GetVarcharValue(std::string(i % 40, 'a' + i % 26));
+  Value total = i % 11 == 0 ? ValueFactory::GetNullValueByType(TypeId::BIGINT) : ValueFactory::GetBigIntValue(-i);
+  return Tuple({ValueFactory::GetIntegerValue(i), name, total, ValueFactory::GetVarcharValue(std::to_string(i))},
+               schema);
+}
+
+static auto SameBytes(const Tuple &a, const Tuple &b) -> bool {
+  return a.GetLength() == b.GetLength() && memcmp(a.GetData(), b.GetData(), a.GetLength()) == 0;
+}
+
+TEST(PaxTableTest, MatchesRowLayout) {
+  auto *disk_manager = new DiskManager("pax_table_test.db");
+  auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  LockManager lock_manager;
+  Transaction txn(0);
+  Schema schema({Column{"id", TypeId::INTEGER}, Column{"name", TypeId::VARCHAR, 64}, Column{"total", TypeId::BIGINT},
+                 Column{"tag", TypeId::VARCHAR, 8}});
+  TableHeap row_heap(bpm, &lock_manager, nullptr, &txn);
+  TableHeap pax_heap(bpm, &lock_manager, nullptr, &txn, &schema);
+  ASSERT_EQ(pax_heap.GetLayout(), TableLayout::PAX);
+  ASSERT_GT(pax_heap.GetPaxLayout()->GetCapacity(), 1);
+
+  std::vector<RID> row_rids;
+  std::vector<RID> pax_rids;
+  for (int i = 0; i < 3000; i++) {
+    Tuple tuple = MakeTuple(i, &schema);
+    RID rid;
+    ASSERT_TRUE(row_heap.InsertTuple(tuple, &rid, &txn));
+    row_rids.push_back(rid);
+    ASSERT_TRUE(pax_heap.InsertTuple(tuple, &rid, &txn));
+    pax_rids.push_back(rid);
+    // 读回来的和插进去的一个字节都不差
+    Tuple read;
+    ASSERT_TRUE(pax_heap.GetTuple(rid, &read, &txn));
+    ASSERT_TRUE(SameBytes(read, tuple)) << i;
+  }
+  ASSERT_GT(pax_rids.back().GetPageId(), pax_rids.front().GetPageId());
+
+  // 删一部分, 回滚一个删除, 改长一部分 varchar (要整理页内变长区, 或者放不下)
+  for (int i = 0; i < 3000; i += 7) {
+    ASSERT_TRUE(row_heap.MarkDelete(row_rids[i], &txn));
+    row_heap.ApplyDelete(row_rids[i], &txn);
+    ASSERT_TRUE(pax_heap.MarkDelete(pax_rids[i], &txn));
+    pax_heap.ApplyDelete(pax_rids[i], &txn);
+  }
+  ASSERT_TRUE(pax_heap.MarkDelete(pax_rids[1], &txn));
+  Tuple deleted;
+  EXPECT_FALSE(pax_heap.GetTuple(pax_rids[1], &deleted, &txn));
+  pax_heap.RollbackDelete(pax_rids[1], &txn);
+  size_t updated = 0;
+  for (int i = 3; i < 3000; i += 7) {
+    Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(60, 'u')),
+                 ValueFactory::GetBigIntValue(i), ValueFactory::GetVarcharValue("x")},
+                &schema);
+    bool row_updated = row_heap.UpdateTuple(tuple, row_rids[i], &txn);
+    bool pax_updated = pax_heap.UpdateTuple(tuple, pax_rids[i], &txn);
+    if (!row_updated) {
+      ASSERT_TRUE(row_heap.MarkDelete(row_rids[i], &txn));
+      row_heap.ApplyDelete(row_rids[i], &txn);
+      ASSERT_TRUE(row_heap.InsertTuple(tuple, &row_rids[i], &txn));
+    }
+    if (!pax_updated) {
+      ASSERT_TRUE(pax_heap.MarkDelete(pax_rids[i], &txn));
+      pax_heap.ApplyDelete(pax_rids[i], &txn);
+      ASSERT_TRUE(pax_heap.InsertTuple(tuple, &pax_rids[i], &txn));
+    }
+    updated += pax_updated ? 1 : 0;
+  }
+  EXPECT_GT(updated, 0);
+  // 删掉的 slot 再用上
+  for (int i = 3000; i < 3100; i++) {
+    Tuple tuple = MakeTuple(i, &schema);
+    RID rid;
+    ASSERT_TRUE(row_heap.InsertTuple(tuple, &rid, &txn));
+    row_rids.push_back(rid);
+    ASSERT_TRUE(pax_heap.InsertTuple(tuple, &rid, &txn));
+    pax_rids.push_back(rid);
+  }
+  EXPECT_LT(pax_rids.back().GetPageId(), pax_rids[2999].GetPageId());
+
+  for (size_t i = 0; i < pax_rids.size(); i++) {
+    // 删掉的 rid 可能已经给了新插入的 tuple
+    if (i < 3000 && i % 7 == 0) {
+      continue;
+    }
+    Tuple row_tuple;
+    Tuple pax_tuple;
+    ASSERT_TRUE(row_heap.GetTuple(row_rids[i], &row_tuple, &txn));
+    ASSERT_TRUE(pax_heap.GetTuple(pax_rids[i], &pax_tuple, &txn));
+    ASSERT_TRUE(SameBytes(pax_tuple, row_tuple)) << i;
+  }
+
+  // 迭代器和按页扫描看到的 tuple 相同
+  std::vector<Tuple> expected;
+  for (auto it = pax_heap.Begin(&txn); it != pax_heap.End(); ++it) {
+    expected.push_back(*it);
+  }
+  size_t row_count = 0;
+  for (auto it = row_heap.Begin(&txn); it != row_heap.End(); ++it) {
+    row_count++;
+  }
+  ASSERT_EQ(expected.size(), row_count);
+  size_t n = 0;
+  TablePageScan scan(&pax_heap, &txn);
+  while (scan.NextPage()) {
+    for (const auto &view : scan.GetViews()) {
+      ASSERT_LT(n, expected.size());
+      ASSERT_EQ(view.GetRid(), expected[n].GetRid());
+      ASSERT_TRUE(SameBytes(view.ToTuple(), expected[n])) << n;
+      n++;
+    }
+  }
+  EXPECT_EQ(n, expected.size());
+
+  // 只要 total 和 tag 两列: 这两列对, 其他列不拼
+  n = 0;
+  TablePageScan pruned(&pax_heap, &txn, std::vector<uint32_t>{2, 3});
+  while (pruned.NextPage()) {
+    for (const auto &view : pruned.GetViews()) {
+      for (uint32_t col : {2, 3}) {
+        ASSERT_EQ(view.GetValue(&schema, col).ToString(), expected[n].GetValue(&schema, col).ToString()) << n;
+      }
+      ASSERT_TRUE(view.GetValue(&schema, 1).IsNull());
+      ASSERT_LE(view.GetLength(), expected[n].GetLength());
+      n++;
+    }
+  }
+  EXPECT_EQ(n, expected.size());
+
+  delete bpm;
+  delete disk_manager;
+  remove("pax_table_test.db");
+  remove("pax_table_test.log");
+}
+
+static auto ExecSql(BustubInstance *instance, const std::string &sql) -> std::string {
+  std::stringstream ss;
+  auto writer = SimpleStreamWriter(ss, true, " ");
+  instance->ExecuteSql(sql, writer);
+  return ss.str();
+}
+
+TEST(PaxTableTest, Sql) {
+  auto instance = std::make_unique<BustubInstance>("pax_table_test.db");
+  instance->GenerateMockTable();
+  instance->GenerateTestTable();
+  ExecSql(instance.get(), "create table r(a int, b varchar(16), c int);");
+  ExecSql(instance.get(), "create table p(a int, b varchar(16), c int) with (layout = pax);");
+  EXPECT_EQ(instance->catalog_->GetTable("r")->table_->GetLayout(), TableLayout::ROW);
+  EXPECT_EQ(instance->catalog_->GetTable("p")->table_->GetLayout(), TableLayout::PAX);
+  EXPECT_THROW(ExecSql(instance.get(), "create table q(a int) with (layout = columnar);"), NotImplementedException);
+
+  for (const char *table : {"r", "p"}) {
+    std::string values;
+    for (int i = 0; i < 1000; i++) {
+      values += fmt::format("{}({}, 'name-{}', {})", i == 0 ? "" : ", ", i, i, i % 10);
+    }
+    ExecSql(instance.get(), fmt::format("insert into {} values {};", table, values));
+    ExecSql(instance.get(), fmt::format("delete from {} where c = 3;", table));
+  }
+
+  // 投影和过滤只用到 a, c 两列, PAX 表的扫描只拼这两列
+  const std::string query = "select a + c from {} where c < 2;";
+  EXPECT_TRUE(StringUtil::Contains(ExecSql(instance.get(), "explain (o) " + fmt::format(query, "p")),
+                                   "SeqScan { table=p, columns=[0, 2], filter="));
+  EXPECT_TRUE(StringUtil::Contains(ExecSql(instance.get(), "explain (o) " + fmt::format(query, "r")),
+                                   "SeqScan { table=r, filter="));
+  for (const std::string &sql :
+       {query, std::string("select * from {};"), std::string("select b from {} where a > 990;")}) {
+    auto expected = ExecSql(instance.get(), fmt::format(sql, "r"));
+    EXPECT_EQ(ExecSql(instance.get(), fmt::format(sql, "p")), expected) << sql;
+  }
+  EXPECT_EQ(ExecSql(instance.get(), "select b from p where a = 15;"), "name-15 \n");
+  EXPECT_EQ(ExecSql(instance.get(), "select b from p where a = 13;"), "");
+
+  // COPY 直接装成 PAX 页
+  {
+    std::ofstream file("pax_table_test.csv");
+    for (int i = 2000; i < 4000; i++) {
+      file << i << ",copied-" << i << "," << (i % 2 == 0 ? "" : "1") << "\n";
+    }
+  }
+  EXPECT_EQ(ExecSql(instance.get(), "copy p from 'pax_table_test.csv';"), "COPY 2000 \n");
+  EXPECT_EQ(ExecSql(instance.get(), "select b, c from p where a = 3001;"), "copied-3001 1 \n");
+  EXPECT_EQ(ExecSql(instance.get(), "select b, c from p where a = 3002;"), "copied-3002 integer_null \n");
+  remove("pax_table_test.csv");
+
+  instance.reset();
+  remove("pax_table_test.db");
+  remove("pax_table_test.log");
+}
+
+}  // namespace bustub
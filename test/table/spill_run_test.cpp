@@ -0,0 +1,192 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// spill_run_test.cpp
+//
+// Identification: test/table/spill_run_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/bustub_instance.h"
+#include "common/exception.h"
+#include "gtest/gtest.h"
+#include "storage/table/spill_run.h"
+#include "storage/table/tuple_view.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+static auto ExecSql(BustubInstance *instance, const std::string &sql) -> std::string {
+  std::stringstream ss;
+  auto writer = SimpleStreamWriter(ss, true, " ");
+  instance->ExecuteSql(sql, writer);
+  return ss.str();
+}
+
+TEST(SpillRunTest, AppendAndRead) {
+  auto *disk_manager = new DiskManager("spill_run_test.db");
+  // 池比 run 小得多, 写的页要换出去, 读的时候再读回来
+  auto *bpm = new BufferPoolManagerInstance(16, disk_manager);
+  Schema schema({Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 300}});
+  auto make_tuple = [&](int i) {
+    Tuple values({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(i % 300, 'x'))}, &schema);
+    Tuple tuple;
+    TupleView(RID(i / 7, i % 7), values.GetData(), values.GetLength()).CopyTo(&tuple);
+    return tuple;
+  };
+
+  {
+    SpillRun run(bpm);
+    for (int i = 0; i < 3000; i++) {
+      run.Append(make_tuple(i));
+    }
+    EXPECT_EQ(run.GetTupleCount(), 3000);
+    ASSERT_GT(run.GetPageCount(), 16);
+    for (size_t read_ahead : {0, 1, 3}) {
+      SpillRunReader reader(&run, read_ahead);
+      Tuple tuple;
+      for (int i = 0; i < 3000; i++) {
+        ASSERT_TRUE(reader.Next(&tuple));
+        ASSERT_EQ(tuple.GetValue(&schema, 0).GetAs<int32_t>(), i);
+        ASSERT_EQ(tuple.GetValue(&schema, 1).ToString(), std::string(i % 300, 'x'));
+        ASSERT_EQ(tuple.GetRid(), RID(i / 7, i % 7));
+      }
+      EXPECT_FALSE(reader.Next(&tuple));
+      EXPECT_FALSE(reader.Next(&tuple));
+    }
+    // 没读完就析构: 预读的页都放掉了
+    {
+      SpillRunReader reader(&run);
+      Tuple tuple;
+      ASSERT_TRUE(reader.Next(&tuple));
+    }
+    // 两个 reader 交替读, 像归并那样
+    SpillRunReader first(&run);
+    SpillRunReader second(&run);
+    Tuple a;
+    Tuple b;
+    for (int i = 0; i < 3000; i++) {
+      ASSERT_TRUE(first.Next(&a));
+      ASSERT_TRUE(second.Next(&b));
+      ASSERT_EQ(a.GetValue(&schema, 0).GetAs<int32_t>(), b.GetValue(&schema, 0).GetAs<int32_t>());
+    }
+  }
+
+  // 空 run
+  {
+    SpillRun run(bpm);
+    SpillRunReader reader(&run);
+    Tuple tuple;
+    EXPECT_FALSE(reader.Next(&tuple));
+  }
+
+  // 一页放不下的 tuple
+  {
+    Schema wide({Column{"b", TypeId::VARCHAR, BUSTUB_PAGE_SIZE}});
+    SpillRun run(bpm);
+    EXPECT_THROW(run.Append(Tuple({ValueFactory::GetVarcharValue(std::string(BUSTUB_PAGE_SIZE, 'w'))}, &wide)),
+                 Exception);
+  }
+
+  // run 析构后它的页都放掉了, 整个池都能用
+  std::vector<page_id_t> page_ids(16);
+  for (auto &page_id : page_ids) {
+    ASSERT_NE(bpm->NewPage(&page_id), nullptr);
+  }
+  for (auto page_id : page_ids) {
+    bpm->UnpinPage(page_id, false);
+  }
+
+  delete bpm;
+  delete disk_manager;
+  remove("spill_run_test.db");
+  remove("spill_run_test.log");
+}
+
+TEST(SpillRunTest, SortSpills) {
+  auto instance = std::make_unique<BustubInstance>("spill_run_test.db");
+  instance->GenerateMockTable();
+  instance->GenerateTestTable();
+  ExecSql(instance.get(), "create table t1(v1 int, v2 varchar(32), v3 int);");
+  for (int batch = 0; batch < 10; batch++) {
+    std::string values;
+    for (int i = batch * 500; i < (batch + 1) * 500; i++) {
+      values += fmt::format("{}({}, 'value-{}', {})", values.empty() ? "" : ", ", (i * 7919) % 5000, i % 97, i % 10);
+    }
+    ExecSql(instance.get(), fmt::format("insert into t1 values {};", values));
+  }
+
+  std::vector<std::string> queries{"select v1, v2 from t1 order by v1;",
+                                   "select v3, v2, v1 from t1 order by v3 desc, v2;",
+                                   "select v1, v3 from t1 order by v3;"};
+  size_t budget = query_memory_budget;
+  std::vector<std::string> expected;
+  for (const auto &query : queries) {
+    expected.push_back(ExecSql(instance.get(), query));
+  }
+  // v1 是 0..4999 的一个排列
+  std::string ascending;
+  for (int i = 0; i < 5000; i++) {
+    ascending += fmt::format("{} value-{} \n", i, (i * 2679) % 5000 % 97);
+  }
+  EXPECT_EQ(expected[0], ascending);
+
+  // 一个 run 几百行: 一趟并不完, 要并两趟; 结果不变, 相同的键保持输入的顺序
+  query_memory_budget = 64 << 10;
+  for (size_t i = 0; i < queries.size(); i++) {
+    EXPECT_EQ(ExecSql(instance.get(), queries[i]), expected[i]) << queries[i];
+  }
+  // 预算放不下一行: 每行一个 run
+  std::string small_query = "select v1, v3 from t1 where v1 < 300 order by v3;";
+  query_memory_budget = budget;
+  std::string small_expected = ExecSql(instance.get(), small_query);
+  query_memory_budget = 0;
+  EXPECT_EQ(ExecSql(instance.get(), small_query), small_expected);
+  query_memory_budget = budget;
+}
+
+TEST(SpillRunTest, AggregationSpills) {
+  auto instance = std::make_unique<BustubInstance>("spill_run_test.db");
+  ExecSql(instance.get(), "create table t1(v1 int, v2 varchar(32), v3 int);");
+  for (int batch = 0; batch < 4; batch++) {
+    std::string values;
+    for (int i = batch * 500; i < (batch + 1) * 500; i++) {
+      values += fmt::format("{}({}, 'value-{}', {})", values.empty() ? "" : ", ", i, i % 300, i % 7);
+    }
+    ExecSql(instance.get(), fmt::format("insert into t1 values {};", values));
+  }
+
+  std::vector<std::string> queries{"select v2, sum(v1), max(v1) from t1 group by v2 order by v2;",
+                                   "select v3, v2, count(*), min(v1) from t1 group by v3, v2 order by v3, v2;"};
+  size_t budget = query_memory_budget;
+  std::vector<std::string> expected;
+  for (const auto &query : queries) {
+    expected.push_back(ExecSql(instance.get(), query));
+  }
+  // 300 组, 每组 v1 = k, k + 300, ...
+  auto rows = expected[0];
+  EXPECT_EQ(std::count(rows.begin(), rows.end(), '\n'), 300);
+  EXPECT_EQ(rows.substr(0, rows.find('\n') + 1), "value-0 6300 1800 \n");
+
+  // 几十组就满: 多数组要写到分区里, 分区还要再分; 预算为 0 时每一趟只放得下一组
+  for (size_t small : {size_t{4} << 10, size_t{0}}) {
+    query_memory_budget = small;
+    for (size_t i = 0; i < queries.size(); i++) {
+      EXPECT_EQ(ExecSql(instance.get(), queries[i]), expected[i]) << small << " " << queries[i];
+    }
+  }
+  query_memory_budget = budget;
+}
+
+}  // namespace bustub
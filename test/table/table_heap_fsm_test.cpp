@@ -0,0 +1,147 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_heap_fsm_test.cpp
+//
+// Identification: test/table/table_heap_fsm_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <set>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "concurrency/transaction.h"
+#include "gtest/gtest.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/** pages of the heap, following the next links */
+static auto CountHeapPages(BufferPoolManager *bpm, page_id_t first_page_id) -> size_t {
+  size_t pages = 0;
+  for (page_id_t page_id = first_page_id; page_id != INVALID_PAGE_ID; pages++) {
+    auto *page = static_cast<TablePage *>(bpm->FetchPage(page_id));
+    page_id_t next_page_id = page->GetNextPageId();
+    bpm->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return pages;
+}
+
+TEST(TableHeapTest, FreeSpaceMap) {
+  auto *disk_manager = new DiskManager("table_heap_fsm_test.db");
+  auto *bpm = new BufferPoolManagerInstance(32, disk_manager);
+  LockManager lock_manager;
+  Transaction txn(0);
+  Schema schema({Column{"a", TypeId::VARCHAR, 128}});
+  auto make_tuple = [&](int i) {
+    return Tuple({ValueFactory::GetVarcharValue(std::to_string(i) + std::string(100, 'x'))}, &schema);
+  };
+
+  auto heap = std::make_unique<TableHeap>(bpm, &lock_manager, nullptr, &txn);
+  std::vector<RID> rids;
+  for (int i = 0; i < 10000; i++) {
+    RID rid;
+    ASSERT_TRUE(heap->InsertTuple(make_tuple(i), &rid, &txn));
+    rids.push_back(rid);
+  }
+  size_t pages = heap->GetFreeSpaceMap()->GetNumPages();
+  EXPECT_EQ(pages, CountHeapPages(bpm, heap->GetFirstPageId()));
+  // 每页都装满了才接新页
+  size_t per_page = TablePage::MaxTupleSize() / TablePage::SpaceForTuple(make_tuple(0).GetLength());
+  EXPECT_LE(pages, 10000 / (per_page - 1) + 1);
+
+  // 删掉前面一半页上的 tuple, 新插入的先填回这些页, 堆不变长
+  size_t deleted = 0;
+  for (const auto &rid : rids) {
+    if (rid.GetPageId() < rids[rids.size() / 2].GetPageId()) {
+      ASSERT_TRUE(heap->MarkDelete(rid, &txn));
+      heap->ApplyDelete(rid, &txn);
+      deleted++;
+    }
+  }
+  for (size_t i = 0; i < deleted; i++) {
+    RID rid;
+    ASSERT_TRUE(heap->InsertTuple(make_tuple(static_cast<int>(i)), &rid, &txn));
+  }
+  EXPECT_EQ(heap->GetFreeSpaceMap()->GetNumPages(), pages);
+
+  // 重新打开: 地图从它的页读回来
+  page_id_t first_page_id = heap->GetFirstPageId();
+  heap = std::make_unique<TableHeap>(bpm, &lock_manager, nullptr, first_page_id);
+  EXPECT_EQ(heap->GetFreeSpaceMap()->GetNumPages(), pages);
+  RID rid;
+  ASSERT_TRUE(heap->InsertTuple(make_tuple(0), &rid, &txn));
+  Tuple tuple;
+  ASSERT_TRUE(heap->GetTuple(rid, &tuple, &txn));
+  EXPECT_EQ(tuple.GetValue(&schema, 0).ToString(), std::to_string(0) + std::string(100, 'x'));
+
+  // 没有地图的堆 (first page 上没记) 打开时走一遍页建出来
+  auto *first_page = static_cast<TablePage *>(bpm->FetchPage(first_page_id));
+  first_page->SetFsmPageId(INVALID_PAGE_ID);
+  bpm->UnpinPage(first_page_id, true);
+  heap = std::make_unique<TableHeap>(bpm, &lock_manager, nullptr, first_page_id);
+  EXPECT_EQ(heap->GetFreeSpaceMap()->GetNumPages(), CountHeapPages(bpm, first_page_id));
+
+  heap.reset();
+  delete bpm;
+  delete disk_manager;
+  remove("table_heap_fsm_test.db");
+  remove("table_heap_fsm_test.log");
+}
+
+TEST(TableHeapTest, ConcurrentInsert) {
+  auto *disk_manager = new DiskManager("table_heap_fsm_test.db");
+  auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  LockManager lock_manager;
+  Transaction create_txn(0);
+  Schema schema({Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 128}});
+  TableHeap heap(bpm, &lock_manager, nullptr, &create_txn);
+
+  const int num_threads = 4;
+  const int per_thread = 3000;
+  std::vector<std::vector<RID>> rids(num_threads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      Transaction txn(t + 1);
+      for (int i = 0; i < per_thread; i++) {
+        Tuple tuple(
+            {ValueFactory::GetIntegerValue(t * per_thread + i), ValueFactory::GetVarcharValue(std::string(60, 'y'))},
+            &schema);
+        RID rid;
+        ASSERT_TRUE(heap.InsertTuple(tuple, &rid, &txn));
+        rids[t].push_back(rid);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  std::set<int64_t> seen;
+  for (int t = 0; t < num_threads; t++) {
+    for (int i = 0; i < per_thread; i++) {
+      ASSERT_TRUE(seen.insert(rids[t][i].Get()).second);
+      Tuple tuple;
+      ASSERT_TRUE(heap.GetTuple(rids[t][i], &tuple, &create_txn));
+      ASSERT_EQ(tuple.GetValue(&schema, 0).GetAs<int32_t>(), t * per_thread + i);
+    }
+  }
+  EXPECT_EQ(heap.GetFreeSpaceMap()->GetNumPages(), CountHeapPages(bpm, heap.GetFirstPageId()));
+
+  delete bpm;
+  delete disk_manager;
+  remove("table_heap_fsm_test.db");
+  remove("table_heap_fsm_test.log");
+}
+
+}  // namespace bustub
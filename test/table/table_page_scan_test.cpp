@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_page_scan_test.cpp
+//
+// Identification: test/table/table_page_scan_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "concurrency/transaction.h"
+#include "gtest/gtest.h"
+#include "storage/table/table_heap.h"
+#include "storage/table/table_page_scan.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+TEST(TablePageScanTest, MatchesTableIterator) {
+  auto *disk_manager = new DiskManager("table_page_scan_test.db");
+  auto *bpm = new BufferPoolManagerInstance(32, disk_manager);
+  LockManager lock_manager;
+  Transaction txn(0);
+  Schema schema({Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 64}, Column{"c", TypeId::BIGINT}});
+  TableHeap heap(bpm, &lock_manager, nullptr, &txn);
+
+  std::vector<RID> rids;
+  for (int i = 0; i < 3000; i++) {
+    Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(i % 50, 'v')),
+                 ValueFactory::GetBigIntValue(-i)},
+                &schema);
+    RID rid;
+    ASSERT_TRUE(heap.InsertTuple(tuple, &rid, &txn));
+    rids.push_back(rid);
+  }
+  // 删掉一部分 tuple, 再把第二页整页删空: 扫描要跳过删除的 tuple 和空页
+  page_id_t second_page_id = INVALID_PAGE_ID;
+  for (size_t i = 0; i < rids.size(); i++) {
+    if (second_page_id == INVALID_PAGE_ID && rids[i].GetPageId() != rids[0].GetPageId()) {
+      second_page_id = rids[i].GetPageId();
+    }
+    if (i % 7 == 0 || rids[i].GetPageId() == second_page_id) {
+      ASSERT_TRUE(heap.MarkDelete(rids[i], &txn));
+      heap.ApplyDelete(rids[i], &txn);
+    }
+  }
+
+  std::vector<Tuple> expected;
+  for (auto it = heap.Begin(&txn); it != heap.End(); ++it) {
+    expected.push_back(*it);
+  }
+  ASSERT_LT(expected.size(), rids.size());
+
+  size_t n = 0;
+  Tuple tuple;
+  TablePageScan scan(&heap, &txn);
+  while (scan.NextPage()) {
+    ASSERT_FALSE(scan.GetViews().empty());
+    for (const auto &view : scan.GetViews()) {
+      ASSERT_LT(n, expected.size());
+      const Tuple &want = expected[n++];
+      ASSERT_EQ(view.GetRid(), want.GetRid());
+      ASSERT_EQ(view.GetLength(), want.GetLength());
+      for (uint32_t col = 0; col < schema.GetColumnCount(); col++) {
+        ASSERT_EQ(view.GetValue(&schema, col).CompareEquals(want.GetValue(&schema, col)), CmpBool::CmpTrue);
+      }
+      // 长度相同时复用 tuple 的内存
+      const char *buffer = tuple.GetData();
+      uint32_t length = tuple.GetLength();
+      view.CopyTo(&tuple);
+      if (length == view.GetLength()) {
+        ASSERT_EQ(tuple.GetData(), buffer);
+      }
+      ASSERT_EQ(tuple.GetRid(), want.GetRid());
+      ASSERT_EQ(tuple.GetValue(&schema, 1).ToString(), want.GetValue(&schema, 1).ToString());
+    }
+  }
+  EXPECT_EQ(n, expected.size());
+  EXPECT_FALSE(scan.NextPage());
+
+  delete bpm;
+  delete disk_manager;
+  remove("table_page_scan_test.db");
+  remove("table_page_scan_test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,373 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_vacuum_test.cpp
+//
+// Identification: test/table/table_vacuum_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/bustub_instance.h"
+#include "common/config.h"
+#include "concurrency/transaction.h"
+#include "gtest/gtest.h"
+#include "storage/table/table_heap.h"
+#include "storage/table/table_page_scan.h"
+#include "storage/table/table_vacuum.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/** pages of the heap, following the next links */
+static auto CountHeapPages(BufferPoolManager *bpm, page_id_t first_page_id) -> size_t {
+  size_t pages = 0;
+  for (page_id_t page_id = first_page_id; page_id != INVALID_PAGE_ID; pages++) {
+    auto *page = static_cast<TablePage *>(bpm->FetchPage(page_id));
+    page_id_t next_page_id = page->GetNextPageId();
+    bpm->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return pages;
+}
+
+/** the ids of the live tuples, in scan order */
+static auto ScanIds(TableHeap *heap, Transaction *txn, const Schema &schema) -> std::vector<int> {
+  std::vector<int> ids;
+  TablePageScan scan(heap, txn);
+  while (scan.NextPage()) {
+    for (const auto &view : scan.GetViews()) {
+      ids.push_back(view.GetValue(&schema, 0).GetAs<int32_t>());
+    }
+  }
+  return ids;
+}
+
+TEST(TableVacuumTest, UnlinksAndRecyclesEmptyPages) {
+  auto *disk_manager = new DiskManager("table_vacuum_test.db");
+  auto *bpm = new BufferPoolManagerInstance(32, disk_manager);
+  LockManager lock_manager;
+  Transaction txn(0);
+  Schema schema({Column{"id", TypeId::INTEGER}, Column{"note", TypeId::VARCHAR, 128}});
+  auto make_tuple = [&](int id) {
+    return Tuple({ValueFactory::GetIntegerValue(id), ValueFactory::GetVarcharValue(std::string(100, 'n'))}, &schema);
+  };
+
+  TableHeap heap(bpm, &lock_manager, nullptr, &txn);
+  heap.EnableZoneMap(schema);
+  std::vector<RID> rids;
+  for (int i = 0; i < 3000; i++) {
+    RID rid;
+    ASSERT_TRUE(heap.InsertTuple(make_tuple(i), &rid, &txn));
+    rids.push_back(rid);
+  }
+  size_t pages = heap.GetFreeSpaceMap()->GetNumPages();
+  ASSERT_GT(pages, 20);
+  // 没删过东西, 没有要整理的页
+  EXPECT_EQ(heap.Vacuum(SIZE_MAX).pages_visited_, 0);
+
+  // 删掉第一页以外前一半页上的 tuple, 和后一半里每隔一个
+  page_id_t middle_page_id = rids[rids.size() / 2].GetPageId();
+  std::vector<int> expected;
+  for (int i = 0; i < 3000; i++) {
+    page_id_t page_id = rids[i].GetPageId();
+    bool emptied = page_id != heap.GetFirstPageId() && page_id < middle_page_id;
+    if (emptied || (page_id > middle_page_id && i % 2 == 0)) {
+      ASSERT_TRUE(heap.MarkDelete(rids[i], &txn));
+      heap.ApplyDelete(rids[i], &txn);
+    } else {
+      expected.push_back(i);
+    }
+  }
+
+  // 扫描停在一页上时摘掉的页先不还: 扫描可能还要走过它们
+  auto scan = std::make_unique<TablePageScan>(&heap, &txn);
+  ASSERT_TRUE(scan->NextPage());
+  auto stats = heap.Vacuum(SIZE_MAX);
+  EXPECT_GT(stats.pages_unlinked_, 10);
+  EXPECT_EQ(stats.pages_recycled_, 0);
+  EXPECT_GT(stats.bytes_reclaimed_, 0);
+  size_t live_pages = pages - stats.pages_unlinked_;
+  EXPECT_EQ(heap.GetFreeSpaceMap()->GetNumPages(), live_pages);
+  EXPECT_EQ(heap.GetZoneMap()->GetStats().pages_, live_pages);
+  EXPECT_EQ(CountHeapPages(bpm, heap.GetFirstPageId()), live_pages);
+  std::vector<int> scanned;
+  do {
+    for (const auto &view : scan->GetViews()) {
+      scanned.push_back(view.GetValue(&schema, 0).GetAs<int32_t>());
+    }
+  } while (scan->NextPage());
+  EXPECT_EQ(scanned, expected);
+
+  // 没有读者了, 下一轮回收这些页
+  scan.reset();
+  auto recycled = heap.Vacuum(0);
+  EXPECT_EQ(recycled.pages_visited_, 0);
+  EXPECT_EQ(recycled.pages_recycled_, stats.pages_unlinked_);
+
+  // 堆照常用: 插入先填回后一半页的空位, 再接回收的页, 索引里的 RID 不变
+  EXPECT_EQ(ScanIds(&heap, &txn, schema), expected);
+  size_t appended_recycled = 0;
+  for (int i = 3000; i < 4500; i++) {
+    RID rid;
+    ASSERT_TRUE(heap.InsertTuple(make_tuple(i), &rid, &txn));
+    appended_recycled += rid.GetPageId() != heap.GetFirstPageId() && rid.GetPageId() < middle_page_id ? 1 : 0;
+    expected.push_back(i);
+  }
+  EXPECT_GT(appended_recycled, 0);
+  EXPECT_EQ(CountHeapPages(bpm, heap.GetFirstPageId()), heap.GetFreeSpaceMap()->GetNumPages());
+  EXPECT_LE(heap.GetFreeSpaceMap()->GetNumPages(), pages);
+  std::vector<int> ids = ScanIds(&heap, &txn, schema);
+  EXPECT_EQ(std::multiset<int>(ids.begin(), ids.end()), std::multiset<int>(expected.begin(), expected.end()));
+  Tuple tuple;
+  ASSERT_TRUE(heap.GetTuple(rids[2999], &tuple, &txn));
+  EXPECT_EQ(tuple.GetValue(&schema, 0).GetAs<int32_t>(), 2999);
+
+  // 重新打开: 地图里摘掉的页留下的墓碑不算
+  page_id_t first_page_id = heap.GetFirstPageId();
+  size_t pages_now = heap.GetFreeSpaceMap()->GetNumPages();
+  TableHeap reopened(bpm, &lock_manager, nullptr, first_page_id);
+  EXPECT_EQ(reopened.GetFreeSpaceMap()->GetNumPages(), pages_now);
+  EXPECT_EQ(CountHeapPages(bpm, first_page_id), pages_now);
+
+  delete bpm;
+  delete disk_manager;
+  remove("table_vacuum_test.db");
+  remove("table_vacuum_test.log");
+}
+
+TEST(TableVacuumTest, CompactsPagesAndZones) {
+  auto *disk_manager = new DiskManager("table_vacuum_test.db");
+  auto *bpm = new BufferPoolManagerInstance(32, disk_manager);
+  LockManager lock_manager;
+  Transaction txn(0);
+  Schema schema({Column{"id", TypeId::INTEGER}, Column{"note", TypeId::VARCHAR, 128}});
+  auto make_tuple = [&](int id) {
+    return Tuple({ValueFactory::GetIntegerValue(id), ValueFactory::GetVarcharValue(std::string(id % 50, 'n'))},
+                 &schema);
+  };
+
+  for (const Schema *pax_schema : std::vector<const Schema *>{nullptr, &schema}) {
+    TableHeap heap(bpm, &lock_manager, nullptr, &txn, pax_schema);
+    heap.EnableZoneMap(schema);
+    std::vector<RID> rids;
+    for (int i = 0; i < 1000; i++) {
+      RID rid;
+      ASSERT_TRUE(heap.InsertTuple(make_tuple(i), &rid, &txn));
+      rids.push_back(rid);
+    }
+    // 每页留下第一个 tuple, 删掉最后一个和一部分中间的: 行页尾部的槽, PAX 页变长区里的空洞都能整理出来
+    std::vector<int> expected;
+    for (int i = 0; i < 1000; i++) {
+      bool last = i + 1 == 1000 || rids[i + 1].GetPageId() != rids[i].GetPageId();
+      if (rids[i].GetSlotNum() != 0 && (last || i % 10 >= 5)) {
+        ASSERT_TRUE(heap.MarkDelete(rids[i], &txn));
+        heap.ApplyDelete(rids[i], &txn);
+      } else {
+        expected.push_back(i);
+      }
+    }
+    // 一个删除还没提交的页不缩小范围: 回滚会把 tuple 放回来
+    ASSERT_TRUE(heap.MarkDelete(rids[0], &txn));
+
+    size_t pages = heap.GetFreeSpaceMap()->GetNumPages();
+    auto stats = heap.Vacuum(pages / 2);
+    EXPECT_EQ(stats.pages_visited_, pages / 2);
+    stats += heap.Vacuum(SIZE_MAX);
+    EXPECT_EQ(stats.pages_visited_, pages);
+    EXPECT_EQ(stats.pages_unlinked_, 0);
+    EXPECT_GT(stats.bytes_reclaimed_, 0);
+    EXPECT_EQ(ScanIds(&heap, &txn, schema), std::vector<int>(expected.begin() + 1, expected.end()));
+
+    heap.RollbackDelete(rids[0], &txn);
+    ZoneRange range;
+    range.hi_ = ValueFactory::GetIntegerValue(0);
+    TablePageScan scan(&heap, &txn, std::nullopt, {range});
+    ASSERT_TRUE(scan.NextPage());
+    EXPECT_EQ(scan.GetViews().front().GetValue(&schema, 0).GetAs<int32_t>(), 0);
+  }
+
+  delete bpm;
+  delete disk_manager;
+  remove("table_vacuum_test.db");
+  remove("table_vacuum_test.log");
+}
+
+TEST(TableVacuumTest, Background) {
+  auto *disk_manager = new DiskManager("table_vacuum_test.db");
+  auto *bpm = new BufferPoolManagerInstance(32, disk_manager);
+  LockManager lock_manager;
+  Transaction txn(0);
+  Schema schema({Column{"id", TypeId::INTEGER}, Column{"note", TypeId::VARCHAR, 128}});
+  TableHeap heap_a(bpm, &lock_manager, nullptr, &txn);
+  TableHeap heap_b(bpm, &lock_manager, nullptr, &txn);
+  for (auto *heap : {&heap_a, &heap_b}) {
+    std::vector<RID> rids;
+    for (int i = 0; i < 1000; i++) {
+      RID rid;
+      Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(100, 'n'))}, &schema);
+      ASSERT_TRUE(heap->InsertTuple(tuple, &rid, &txn));
+      rids.push_back(rid);
+    }
+    for (int i = 0; i < 900; i++) {
+      ASSERT_TRUE(heap->MarkDelete(rids[i], &txn));
+      heap->ApplyDelete(rids[i], &txn);
+    }
+  }
+
+  // 一轮最多 4 页, 两张表轮流
+  {
+    TableVacuum vacuum(4, std::chrono::hours(1));
+    vacuum.AddTable(&heap_a);
+    vacuum.AddTable(&heap_b);
+    EXPECT_EQ(vacuum.RunOnce().pages_visited_, 4);
+    EXPECT_EQ(vacuum.RunOnce().pages_visited_, 4);
+    EXPECT_GT(heap_a.Vacuum(SIZE_MAX).pages_visited_, 0);
+    EXPECT_GT(heap_b.Vacuum(SIZE_MAX).pages_visited_, 0);
+    EXPECT_EQ(vacuum.RunOnce().pages_visited_, 0);
+    EXPECT_EQ(vacuum.GetStats().pages_visited_, 8);
+  }
+  EXPECT_EQ(ScanIds(&heap_a, &txn, schema).size(), 100);
+  EXPECT_EQ(ScanIds(&heap_b, &txn, schema).size(), 100);
+  EXPECT_EQ(heap_a.GetFreeSpaceMap()->GetNumPages(), CountHeapPages(bpm, heap_a.GetFirstPageId()));
+
+  delete bpm;
+  delete disk_manager;
+  remove("table_vacuum_test.db");
+  remove("table_vacuum_test.log");
+}
+
+TEST(TableVacuumTest, Concurrent) {
+  auto *disk_manager = new DiskManager("table_vacuum_test.db");
+  auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  LockManager lock_manager;
+  Transaction txn(0);
+  Schema schema({Column{"id", TypeId::INTEGER}, Column{"note", TypeId::VARCHAR, 128}});
+  TableHeap heap(bpm, &lock_manager, nullptr, &txn);
+  heap.EnableZoneMap(schema);
+  TableVacuum vacuum(16, std::chrono::milliseconds(1));
+  vacuum.AddTable(&heap);
+
+  // 两个线程反复插入再删光, 一个线程一直扫, 后台 vacuum 同时摘页回收
+  std::atomic<bool> done{false};
+  std::vector<std::thread> writers;
+  for (int t = 0; t < 2; t++) {
+    writers.emplace_back([&, t] {
+      Transaction writer_txn(t + 1);
+      for (int round = 0; round < 5; round++) {
+        std::vector<RID> rids;
+        for (int i = 0; i < 500; i++) {
+          Tuple tuple(
+              {ValueFactory::GetIntegerValue(t * 1000 + i), ValueFactory::GetVarcharValue(std::string(100, 'n'))},
+              &schema);
+          RID rid;
+          ASSERT_TRUE(heap.InsertTuple(tuple, &rid, &writer_txn));
+          rids.push_back(rid);
+        }
+        for (const auto &rid : rids) {
+          ASSERT_TRUE(heap.MarkDelete(rid, &writer_txn));
+          heap.ApplyDelete(rid, &writer_txn);
+        }
+      }
+    });
+  }
+  std::thread reader([&] {
+    Transaction reader_txn(3);
+    while (!done) {
+      for (int id : ScanIds(&heap, &reader_txn, schema)) {
+        ASSERT_TRUE(id >= 0 && id < 1500);
+      }
+    }
+  });
+  for (auto &writer : writers) {
+    writer.join();
+  }
+  done = true;
+  reader.join();
+  vacuum.RunOnce();
+  heap.Vacuum(SIZE_MAX, true);
+
+  EXPECT_TRUE(ScanIds(&heap, &txn, schema).empty());
+  EXPECT_GT(vacuum.GetStats().pages_unlinked_, 0);
+  EXPECT_EQ(heap.GetFreeSpaceMap()->GetNumPages(), CountHeapPages(bpm, heap.GetFirstPageId()));
+  EXPECT_EQ(heap.GetZoneMap()->GetStats().pages_, heap.GetFreeSpaceMap()->GetNumPages());
+
+  delete bpm;
+  delete disk_manager;
+  remove("table_vacuum_test.db");
+  remove("table_vacuum_test.log");
+}
+
+static auto ExecSql(BustubInstance *instance, const std::string &sql) -> std::string {
+  std::stringstream ss;
+  auto writer = SimpleStreamWriter(ss, true, " ");
+  instance->ExecuteSql(sql, writer);
+  return ss.str();
+}
+
+TEST(TableVacuumTest, Sql) {
+  auto instance = std::make_unique<BustubInstance>("table_vacuum_test.db");
+  instance->GenerateMockTable();
+  instance->GenerateTestTable();
+  ExecSql(instance.get(), "create table t(id int, v varchar(128));");
+  std::string values;
+  for (int i = 0; i < 2000; i++) {
+    values += fmt::format("{}({}, '{}')", i == 0 ? "" : ", ", i, std::string(100, 'v'));
+  }
+  ExecSql(instance.get(), fmt::format("insert into t values {};", values));
+  ExecSql(instance.get(), "delete from t where id >= 100 and id < 1900;");
+
+  // 默认没有后台 vacuum, 删掉的页都等 \vacuum 来整理
+  EXPECT_EQ(instance->catalog_->GetVacuum(), nullptr);
+  ExecSql(instance.get(), "\\vacuum t");
+  auto *heap = instance->catalog_->GetTable("t")->table_.get();
+  size_t pages = heap->GetFreeSpaceMap()->GetNumPages();
+  EXPECT_LE(pages, 8);
+  auto rows = ExecSql(instance.get(), "select id from t;");
+  EXPECT_EQ(std::count(rows.begin(), rows.end(), '\n'), 200);
+  EXPECT_EQ(ExecSql(instance.get(), "select id from t where id > 1997;"), "1998 \n1999 \n");
+  // 已经整理过了: 每页都看一遍, 没有可做的
+  EXPECT_EQ(ExecSql(instance.get(), "\\vacuum t"), fmt::format("{} 0 0 0 \n", pages));
+
+  instance.reset();
+  remove("table_vacuum_test.db");
+  remove("table_vacuum_test.log");
+}
+
+TEST(TableVacuumTest, SqlBackground) {
+  enable_background_vacuum = true;
+  auto instance = std::make_unique<BustubInstance>("table_vacuum_test.db");
+  ExecSql(instance.get(), "create table t(id int, v varchar(128));");
+  ASSERT_NE(instance->catalog_->GetVacuum(), nullptr);
+  std::string values;
+  for (int i = 0; i < 2000; i++) {
+    values += fmt::format("{}({}, '{}')", i == 0 ? "" : ", ", i, std::string(100, 'v'));
+  }
+  ExecSql(instance.get(), fmt::format("insert into t values {};", values));
+  ExecSql(instance.get(), "delete from t where id >= 100 and id < 1900;");
+
+  // 后台可能已经整理过一部分, \vacuum 把剩下的做完
+  ExecSql(instance.get(), "\\vacuum t");
+  EXPECT_LE(instance->catalog_->GetTable("t")->table_->GetFreeSpaceMap()->GetNumPages(), 8);
+  auto rows = ExecSql(instance.get(), "select id from t;");
+  EXPECT_EQ(std::count(rows.begin(), rows.end(), '\n'), 200);
+
+  instance.reset();
+  enable_background_vacuum = false;
+  remove("table_vacuum_test.db");
+  remove("table_vacuum_test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,291 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// toast_test.cpp
+//
+// Identification: test/table/toast_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/bustub_instance.h"
+#include "concurrency/transaction.h"
+#include "concurrency/transaction_manager.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "gtest/gtest.h"
+#include "storage/table/table_heap.h"
+#include "storage/table/table_page_scan.h"
+#include "storage/table/toast.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+static auto ExecSql(BustubInstance *instance, const std::string &sql) -> std::string {
+  std::stringstream ss;
+  auto writer = SimpleStreamWriter(ss, true, " ");
+  instance->ExecuteSql(sql, writer);
+  return ss.str();
+}
+
+/** a value of length bytes that differs from the others of the same length after its prefix */
+static auto LongString(size_t length, int i) -> std::string {
+  std::string s(length, 'a' + i % 26);
+  s[length / 2] = static_cast<char>('0' + i % 10);
+  return s;
+}
+
+/** the pages in the frames of the buffer pool */
+static auto PagesInPool(BufferPoolManagerInstance *bpm) -> std::set<page_id_t> {
+  std::set<page_id_t> page_ids;
+  for (size_t i = 0; i < bpm->GetPoolSize(); i++) {
+    if (bpm->GetPages()[i].GetPageId() != INVALID_PAGE_ID) {
+      page_ids.insert(bpm->GetPages()[i].GetPageId());
+    }
+  }
+  return page_ids;
+}
+
+static void CheckLayout(const Schema *pax_schema) {
+  auto *disk_manager = new DiskManager("toast_test.db");
+  auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  LockManager lock_manager;
+  Transaction txn(0);
+  Schema schema(
+      {Column{"id", TypeId::INTEGER}, Column{"body", TypeId::VARCHAR, 20000}, Column{"tag", TypeId::VARCHAR, 8}});
+  TableHeap heap(bpm, &lock_manager, nullptr, &txn, pax_schema);
+  heap.EnableToast(schema);
+
+  // 比一页还长的, 刚过阈值的, 短的, 和 NULL
+  std::vector<size_t> lengths{10000, TOAST_THRESHOLD + 1, 100, 0};
+  std::vector<RID> rids;
+  for (int i = 0; i < 40; i++) {
+    size_t length = lengths[i % lengths.size()];
+    Value body = length == 0 ? ValueFactory::GetNullValueByType(TypeId::VARCHAR)
+                             : ValueFactory::GetVarcharValue(LongString(length, i));
+    Tuple tuple({ValueFactory::GetIntegerValue(i), body, ValueFactory::GetVarcharValue(std::to_string(i))}, &schema);
+    RID rid;
+    ASSERT_TRUE(heap.InsertTuple(tuple, &rid, &txn));
+    rids.push_back(rid);
+    // 页里只有指针和前缀
+    Tuple read;
+    ASSERT_TRUE(heap.GetTuple(rid, &read, &txn));
+    EXPECT_LT(read.GetLength(), 200);
+    EXPECT_EQ(read.GetValue(&schema, 1).ToString(), body.ToString()) << i;
+    EXPECT_EQ(read.GetValue(&schema, 2).ToString(), std::to_string(i));
+  }
+
+  // 按页扫描的 view 和迭代器读出来的也是整个值
+  int scanned = 0;
+  TablePageScan scan(&heap, &txn);
+  while (scan.NextPage()) {
+    for (const auto &view : scan.GetViews()) {
+      int i = view.GetValue(&schema, 0).GetAs<int32_t>();
+      size_t length = lengths[i % lengths.size()];
+      Value body = view.GetValue(&schema, 1);
+      EXPECT_EQ(body.ToString(), length == 0 ? "varlen_null" : LongString(length, i)) << i;
+      EXPECT_EQ(view.ToTuple().GetValue(&schema, 1).ToString(), body.ToString()) << i;
+      scanned++;
+    }
+  }
+  EXPECT_EQ(scanned, 40);
+  for (auto it = heap.Begin(&txn); it != heap.End(); ++it) {
+    int i = it->GetValue(&schema, 0).GetAs<int32_t>();
+    if (lengths[i % lengths.size()] != 0) {
+      EXPECT_EQ(it->GetValue(&schema, 1).ToString(), LongString(lengths[i % lengths.size()], i)) << i;
+    }
+  }
+
+  // 应用删除时链上的页一起删掉
+  std::set<page_id_t> before = PagesInPool(bpm);
+  Tuple tuple({ValueFactory::GetIntegerValue(-1), ValueFactory::GetVarcharValue(LongString(10000, 1)),
+               ValueFactory::GetVarcharValue("x")},
+              &schema);
+  RID rid;
+  ASSERT_TRUE(heap.InsertTuple(tuple, &rid, &txn));
+  std::set<page_id_t> chain = PagesInPool(bpm);
+  for (auto page_id : before) {
+    chain.erase(page_id);
+  }
+  ASSERT_EQ(chain.size(), 3);
+  ASSERT_TRUE(heap.MarkDelete(rid, &txn));
+  heap.ApplyDelete(rid, &txn);
+  for (auto page_id : PagesInPool(bpm)) {
+    EXPECT_EQ(chain.count(page_id), 0) << page_id;
+  }
+
+  // 更新成长的值, 再更新回短的
+  Tuple updated({ValueFactory::GetIntegerValue(2), ValueFactory::GetVarcharValue(LongString(5000, 7)),
+                 ValueFactory::GetVarcharValue("u")},
+                &schema);
+  if (heap.UpdateTuple(updated, rids[2], &txn)) {
+    Tuple read;
+    ASSERT_TRUE(heap.GetTuple(rids[2], &read, &txn));
+    EXPECT_EQ(read.GetValue(&schema, 1).ToString(), LongString(5000, 7));
+  }
+
+  delete bpm;
+  delete disk_manager;
+  remove("toast_test.db");
+  remove("toast_test.log");
+}
+
+TEST(ToastTest, RowHeap) { CheckLayout(nullptr); }
+
+TEST(ToastTest, PaxHeap) {
+  Schema schema(
+      {Column{"id", TypeId::INTEGER}, Column{"body", TypeId::VARCHAR, 20000}, Column{"tag", TypeId::VARCHAR, 8}});
+  CheckLayout(&schema);
+}
+
+static void CheckUpdates(const Schema *pax_schema) {
+  auto *disk_manager = new DiskManager("toast_test.db");
+  auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  LockManager lock_manager;
+  TransactionManager txn_mgr(&lock_manager);
+  Schema schema(
+      {Column{"id", TypeId::INTEGER}, Column{"body", TypeId::VARCHAR, 20000}, Column{"tag", TypeId::VARCHAR, 8}});
+  auto row = [&schema](int i) {
+    return Tuple({ValueFactory::GetIntegerValue(1), ValueFactory::GetVarcharValue(LongString(10000, i)),
+                  ValueFactory::GetVarcharValue("x")},
+                 &schema);
+  };
+
+  auto *txn = txn_mgr.Begin();
+  TableHeap heap(bpm, &lock_manager, nullptr, txn, pax_schema);
+  heap.EnableToast(schema);
+  RID rid;
+  ASSERT_TRUE(heap.InsertTuple(row(0), &rid, txn));
+  txn_mgr.Commit(txn);
+  delete txn;
+  std::set<page_id_t> committed = PagesInPool(bpm);
+
+  // 提交时删掉被替换的值的链: 反复更新, 页数不涨
+  for (int i = 1; i <= 30; i++) {
+    txn = txn_mgr.Begin();
+    ASSERT_TRUE(heap.UpdateTuple(row(i), rid, txn));
+    ASSERT_TRUE(heap.UpdateTuple(row(i + 100), rid, txn));
+    txn_mgr.Commit(txn);
+    delete txn;
+    EXPECT_EQ(PagesInPool(bpm).size(), committed.size()) << i;
+  }
+  committed = PagesInPool(bpm);
+
+  // 回滚时删掉新值的链, 旧值连同它的链原样放回
+  txn = txn_mgr.Begin();
+  ASSERT_TRUE(heap.UpdateTuple(row(200), rid, txn));
+  ASSERT_TRUE(heap.UpdateTuple(row(201), rid, txn));
+  EXPECT_EQ(PagesInPool(bpm).size(), committed.size() + 6);
+  txn_mgr.Abort(txn);
+  delete txn;
+  EXPECT_EQ(PagesInPool(bpm), committed);
+  Transaction reader(100);
+  Tuple read;
+  ASSERT_TRUE(heap.GetTuple(rid, &read, &reader));
+  EXPECT_EQ(read.GetValue(&schema, 1).ToString(), LongString(10000, 130));
+
+  delete bpm;
+  delete disk_manager;
+  remove("toast_test.db");
+  remove("toast_test.log");
+}
+
+TEST(ToastTest, UpdateFreesReplacedChains) {
+  CheckUpdates(nullptr);
+  Schema schema(
+      {Column{"id", TypeId::INTEGER}, Column{"body", TypeId::VARCHAR, 20000}, Column{"tag", TypeId::VARCHAR, 8}});
+  CheckUpdates(&schema);
+}
+
+TEST(ToastTest, ComparisonByPrefix) {
+  auto *disk_manager = new DiskManager("toast_test.db");
+  auto *bpm = new BufferPoolManagerInstance(16, disk_manager);
+  Schema schema({Column{"body", TypeId::VARCHAR, 2000}});
+  std::string long_value = std::string(40, 'm') + std::string(400, 'z');
+  Tuple toasted;
+  std::vector<page_id_t> chains;
+  Tuple tuple({ValueFactory::GetVarcharValue(long_value)}, &schema);
+  ASSERT_TRUE(Toast::StoreLongValues(bpm, schema, tuple.GetData(), tuple.GetLength(), &toasted, &chains));
+  ASSERT_EQ(chains.size(), 1);
+  ASSERT_EQ(toasted.GetLength(), Toast::StoredSize(schema, tuple.GetData(), tuple.GetLength()));
+  EXPECT_EQ(toasted.GetValue(&schema, 0).ToString(), long_value);
+  std::string_view prefix;
+  uint32_t length;
+  ASSERT_TRUE(toasted.GetToastedPrefix(&schema, 0, &prefix, &length));
+  EXPECT_EQ(prefix, long_value.substr(0, TOAST_PREFIX_SIZE));
+  EXPECT_EQ(length, long_value.size() + 1);
+
+  // 前缀判定得了的, 判定不了的 (读整个值), 常量在左边的; 结果都和比较整个值一样
+  auto column = std::make_shared<ColumnValueExpression>(0, 0, TypeId::VARCHAR);
+  std::vector<std::string> constants{"a",
+                                     "n",
+                                     std::string(10, 'm'),
+                                     std::string(32, 'm'),
+                                     std::string(40, 'm'),
+                                     long_value,
+                                     long_value + "z",
+                                     std::string(40, 'm') + "y",
+                                     std::string(33, 'm') + "a"};
+  std::vector<ComparisonType> types{ComparisonType::Equal,           ComparisonType::NotEqual,
+                                    ComparisonType::LessThan,        ComparisonType::LessThanOrEqual,
+                                    ComparisonType::GreaterThan,     ComparisonType::GreaterThanOrEqual};
+  for (const auto &constant : constants) {
+    auto value = std::make_shared<ConstantValueExpression>(ValueFactory::GetVarcharValue(constant));
+    for (auto type : types) {
+      ComparisonExpression column_left(column, value, type);
+      ComparisonExpression column_right(value, column, type);
+      // 整个值的比较: 对没存到行外的 tuple 求值
+      bool expected = column_left.Evaluate(&tuple, schema).GetAs<bool>();
+      bool expected_right = column_right.Evaluate(&tuple, schema).GetAs<bool>();
+      EXPECT_EQ(column_left.Evaluate(&toasted, schema).GetAs<bool>(), expected) << column_left.ToString();
+      EXPECT_EQ(column_right.Evaluate(&toasted, schema).GetAs<bool>(), expected_right) << column_right.ToString();
+    }
+  }
+
+  Toast::DeleteChain(bpm, chains[0]);
+  delete bpm;
+  delete disk_manager;
+  remove("toast_test.db");
+}
+
+TEST(ToastTest, Sql) {
+  auto instance = std::make_unique<BustubInstance>("toast_test.db");
+  instance->GenerateMockTable();
+  instance->GenerateTestTable();
+  ExecSql(instance.get(), "create table t1(v1 int, v2 varchar(20000));");
+  ExecSql(instance.get(), "create table t2(v1 int, v2 varchar(20000)) with (layout = pax);");
+  std::string long_a(9000, 'a');
+  std::string long_b = std::string(300, 'a') + "b";
+  for (const std::string table : {"t1", "t2"}) {
+    ExecSql(instance.get(), fmt::format("insert into {} values (1, '{}'), (2, '{}'), (3, 'short');", table, long_a,
+                                        long_b));
+    EXPECT_EQ(ExecSql(instance.get(), fmt::format("select v1 from {} where v2 = '{}';", table, long_b)), "2 \n");
+    EXPECT_EQ(ExecSql(instance.get(), fmt::format("select v1 from {} where v2 > 'b';", table)), "3 \n");
+    EXPECT_EQ(ExecSql(instance.get(), fmt::format("select v1 from {} where v2 < '{}';", table, long_b)), "1 \n");
+    EXPECT_EQ(ExecSql(instance.get(), fmt::format("select v2 from {} where v1 = 1;", table)), long_a + " \n");
+    // 从一个表插到另一个表, 两边各有各的链
+    ExecSql(instance.get(), fmt::format("insert into {} select v1 + 10, v2 from {};", table, table));
+    ExecSql(instance.get(), fmt::format("delete from {} where v1 < 10;", table));
+    EXPECT_EQ(ExecSql(instance.get(), fmt::format("select v2 from {} where v1 = 11;", table)), long_a + " \n");
+  }
+
+  // COPY: 一行放不进一页, 存到行外之后放得下
+  std::ofstream("toast_test.csv") << "7," << long_a << "\n";
+  EXPECT_EQ(ExecSql(instance.get(), "copy t1 from 'toast_test.csv';"), "COPY 1 \n");
+  EXPECT_EQ(ExecSql(instance.get(), "select v2 from t1 where v1 = 7;"), long_a + " \n");
+  remove("toast_test.csv");
+}
+
+}  // namespace bustub
@@ -0,0 +1,186 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// zone_map_test.cpp
+//
+// Identification: test/table/zone_map_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/bustub_instance.h"
+#include "common/util/string_util.h"
+#include "concurrency/transaction.h"
+#include "gtest/gtest.h"
+#include "storage/table/table_bulk_loader.h"
+#include "storage/table/table_heap.h"
+#include "storage/table/table_page_scan.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/** the ts of the tuples a scan with ranges returns that are in [lo, hi] */
+static auto ScanRange(TableHeap *heap, Transaction *txn, const Schema &schema, int lo, int hi) -> std::set<int> {
+  ZoneRange range;
+  range.lo_ = ValueFactory::GetIntegerValue(lo);
+  range.hi_ = ValueFactory::GetIntegerValue(hi);
+  std::set<int> found;
+  TablePageScan scan(heap, txn, std::nullopt, {range});
+  while (scan.NextPage()) {
+    for (const auto &view : scan.GetViews()) {
+      Value ts = view.GetValue(&schema, 0);
+      if (!ts.IsNull() && ts.GetAs<int32_t>() >= lo && ts.GetAs<int32_t>() <= hi) {
+        found.insert(ts.GetAs<int32_t>());
+      }
+    }
+  }
+  return found;
+}
+
+static auto Expected(int lo, int hi) -> std::set<int> {
+  std::set<int> expected;
+  for (int i = lo; i <= hi; i++) {
+    expected.insert(i);
+  }
+  return expected;
+}
+
+TEST(ZoneMapTest, SkipsPages) {
+  auto *disk_manager = new DiskManager("zone_map_test.db");
+  auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  LockManager lock_manager;
+  Transaction txn(0);
+  Schema schema({Column{"ts", TypeId::INTEGER}, Column{"note", TypeId::VARCHAR, 64}});
+  auto make_tuple = [&](int ts) {
+    return Tuple({ValueFactory::GetIntegerValue(ts), ValueFactory::GetVarcharValue(std::string(40, 'n'))}, &schema);
+  };
+
+  // 按 ts 递增插入, 每页是一段连续的 ts
+  TableHeap heap(bpm, &lock_manager, nullptr, &txn);
+  std::vector<RID> rids;
+  for (int i = 0; i < 2000; i++) {
+    RID rid;
+    ASSERT_TRUE(heap.InsertTuple(make_tuple(i), &rid, &txn));
+    rids.push_back(rid);
+  }
+  ASSERT_EQ(heap.GetZoneMap(), nullptr);
+  heap.EnableZoneMap(schema);
+  ZoneMap *zone_map = heap.GetZoneMap();
+  size_t pages = zone_map->GetStats().pages_;
+  EXPECT_EQ(pages, heap.GetFreeSpaceMap()->GetNumPages());
+  ASSERT_GT(pages, 10);
+
+  EXPECT_EQ(ScanRange(&heap, &txn, schema, 1900, 1950), Expected(1900, 1950));
+  auto stats = zone_map->GetStats();
+  EXPECT_LE(stats.pages_scanned_, 2);
+  EXPECT_EQ(stats.pages_scanned_ + stats.pages_skipped_, pages);
+
+  // 之后的插入和更新扩大所在页的范围
+  for (int i = 2000; i < 2500; i++) {
+    RID rid;
+    ASSERT_TRUE(heap.InsertTuple(make_tuple(i), &rid, &txn));
+  }
+  ASSERT_TRUE(heap.UpdateTuple(make_tuple(5000), rids[0], &txn));
+  auto found = ScanRange(&heap, &txn, schema, 2400, 5000);
+  EXPECT_EQ(found.count(5000), 1);
+  EXPECT_EQ(found.size(), 101);
+
+  // 删除不缩小范围: 页还在扫描里, 只是没有 tuple 返回
+  for (int i = 100; i < 200; i++) {
+    ASSERT_TRUE(heap.MarkDelete(rids[i], &txn));
+    heap.ApplyDelete(rids[i], &txn);
+  }
+  EXPECT_EQ(ScanRange(&heap, &txn, schema, 100, 199), std::set<int>{});
+  EXPECT_EQ(ScanRange(&heap, &txn, schema, 150, 250), Expected(200, 250));
+
+  // COPY 装的页也有范围
+  TableBulkLoader loader(&heap, &txn);
+  for (int i = 10000; i < 11000; i++) {
+    Tuple tuple = make_tuple(i);
+    RID rid;
+    ASSERT_TRUE(loader.Append(tuple.GetData(), tuple.GetLength(), &rid));
+  }
+  loader.Finish();
+  stats = zone_map->GetStats();
+  EXPECT_EQ(ScanRange(&heap, &txn, schema, 10500, 10510), Expected(10500, 10510));
+  auto after = zone_map->GetStats();
+  EXPECT_EQ(after.pages_, heap.GetFreeSpaceMap()->GetNumPages());
+  EXPECT_LE(after.pages_scanned_ - stats.pages_scanned_, 2);
+
+  delete bpm;
+  delete disk_manager;
+  remove("zone_map_test.db");
+  remove("zone_map_test.log");
+}
+
+TEST(ZoneMapTest, NullsAndPax) {
+  auto *disk_manager = new DiskManager("zone_map_test.db");
+  auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  LockManager lock_manager;
+  Transaction txn(0);
+  Schema schema({Column{"ts", TypeId::INTEGER}, Column{"note", TypeId::VARCHAR, 64}});
+
+  // 前半 ts 全是 NULL: 这些页任何范围都跳过
+  TableHeap heap(bpm, &lock_manager, nullptr, &txn, &schema);
+  heap.EnableZoneMap(schema);
+  for (int i = 0; i < 1000; i++) {
+    Value ts = i < 500 ? ValueFactory::GetNullValueByType(TypeId::INTEGER) : ValueFactory::GetIntegerValue(i);
+    RID rid;
+    ASSERT_TRUE(heap.InsertTuple(Tuple({ts, ValueFactory::GetVarcharValue("x")}, &schema), &rid, &txn));
+  }
+  EXPECT_EQ(ScanRange(&heap, &txn, schema, 0, 100000), Expected(500, 999));
+  auto stats = heap.GetZoneMap()->GetStats();
+  EXPECT_GT(stats.pages_skipped_, 0);
+  EXPECT_LT(stats.pages_scanned_, stats.pages_);
+
+  delete bpm;
+  delete disk_manager;
+  remove("zone_map_test.db");
+  remove("zone_map_test.log");
+}
+
+static auto ExecSql(BustubInstance *instance, const std::string &sql) -> std::string {
+  std::stringstream ss;
+  auto writer = SimpleStreamWriter(ss, true, " ");
+  instance->ExecuteSql(sql, writer);
+  return ss.str();
+}
+
+TEST(ZoneMapTest, Sql) {
+  auto instance = std::make_unique<BustubInstance>("zone_map_test.db");
+  instance->GenerateMockTable();
+  instance->GenerateTestTable();
+  ExecSql(instance.get(), "create table t(ts int, v varchar(64));");
+  std::string values;
+  for (int i = 0; i < 2000; i++) {
+    values += fmt::format("{}({}, '{}')", i == 0 ? "" : ", ", i, std::string(40, 'v'));
+  }
+  ExecSql(instance.get(), fmt::format("insert into t values {};", values));
+
+  EXPECT_TRUE(StringUtil::Contains(ExecSql(instance.get(), "explain (o) select ts from t where ts > 1990;"),
+                                   "SeqScan { table=t, filter=(#0.0>1990) }"));
+  EXPECT_EQ(ExecSql(instance.get(), "select ts from t where ts > 1995;"), "1996 \n1997 \n1998 \n1999 \n");
+  EXPECT_EQ(ExecSql(instance.get(), "select ts from t where 3 >= ts and ts >= 2;"), "2 \n3 \n");
+  // OR 用不上 zone map, 结果照样对
+  EXPECT_EQ(ExecSql(instance.get(), "select ts from t where ts = 1 or ts = 1999;"), "1 \n1999 \n");
+  auto zone_map = ExecSql(instance.get(), "\\zonemap t");
+  auto stats = instance->catalog_->GetTable("t")->table_->GetZoneMap()->GetStats();
+  EXPECT_GT(stats.pages_skipped_, stats.pages_scanned_);
+  EXPECT_EQ(zone_map, fmt::format("{} {} {} \n", stats.pages_, stats.pages_scanned_, stats.pages_skipped_));
+
+  instance.reset();
+  remove("zone_map_test.db");
+  remove("zone_map_test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,206 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// art_bench.cpp
+//
+// Identification: tools/art_bench/art_bench.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "storage/index/art_index.h"
+#include "storage/index/b_plus_tree_index.h"
+#include "storage/index/key_encoder.h"
+#include "storage/index/slotted_b_plus_tree_index.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+using bustub::ArtIndex;
+using bustub::BPlusTreeIndex;
+using bustub::BufferPoolManagerInstance;
+using bustub::DiskManager;
+using bustub::GenericComparator;
+using bustub::GenericKey;
+using bustub::Index;
+using bustub::IndexMetadata;
+using bustub::KeyEncoder;
+using bustub::page_id_t;
+using bustub::ParseCreateStatement;
+using bustub::RID;
+using bustub::Schema;
+using bustub::SlottedBPlusTreeIndex;
+using bustub::SlottedIndexIterator;
+using bustub::Tuple;
+using bustub::ValueFactory;
+
+static const char *const DB_FILE = "art_bench.db";
+
+static auto NanosPerOp(size_t ops, const std::function<void()> &work) -> double {
+  auto start = std::chrono::steady_clock::now();
+  work();
+  auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+  return static_cast<double>(nanos) / ops;
+}
+
+/** insert keys (RID i for keys[i]), then ScanKey every probe; a first untimed pass warms the pool */
+static void MeasureLookup(const char *name, Index *index, const std::vector<Tuple> &keys,
+                          const std::vector<Tuple> &probes) {
+  double insert = NanosPerOp(keys.size(), [&]() {
+    for (size_t i = 0; i < keys.size(); i++) {
+      index->InsertEntry(keys[i], RID(static_cast<int64_t>(i)), nullptr);
+    }
+  });
+  std::vector<RID> rids;
+  for (const auto &probe : probes) {
+    index->ScanKey(probe, &rids, nullptr);
+  }
+  rids.clear();
+  double lookup = NanosPerOp(probes.size(), [&]() {
+    for (const auto &probe : probes) {
+      index->ScanKey(probe, &rids, nullptr);
+    }
+  });
+  printf("  %-8s insert %7.0f ns   lookup %7.0f ns   (found %zu)\n", name, insert, lookup, rids.size());  // NOLINT
+}
+
+/** run scan for every prefix, print ns per scan and per returned row */
+static void MeasurePrefix(const char *name, const std::vector<std::string> &prefixes,
+                          const std::function<size_t(const std::string &)> &scan) {
+  size_t rows = 0;
+  for (const auto &prefix : prefixes) {
+    rows += scan(prefix);
+  }
+  rows = 0;
+  double nanos = NanosPerOp(prefixes.size(), [&]() {
+    for (const auto &prefix : prefixes) {
+      rows += scan(prefix);
+    }
+  });
+  printf("  %-8s prefix scan %9.0f ns   %6.1f ns/row   (%zu rows)\n", name, nanos,  // NOLINT
+         nanos * prefixes.size() / std::max<size_t>(rows, 1), rows);
+}
+
+/** a fresh pool and disk file, with the header page the b+ trees keep their root in */
+struct Pool {
+  explicit Pool(size_t frames) : disk_manager_(DB_FILE), bpm_(frames, &disk_manager_) {
+    page_id_t header_page_id;
+    bpm_.NewPage(&header_page_id);
+    bpm_.UnpinPage(header_page_id, true);
+  }
+  ~Pool() { remove(DB_FILE); }
+  DiskManager disk_manager_;
+  BufferPoolManagerInstance bpm_;
+};
+
+/*
+ * Adaptive radix tree index against the B+ trees: insert and point lookup
+ * (Index::ScanKey) for BIGINT keys (BPlusTreeIndex<GenericKey<8>>) and
+ * VARCHAR keys (SlottedBPlusTreeIndex), and prefix scans over the VARCHAR
+ * keys (ArtIndex::ScanPrefix against a slotted tree iterator). The buffer
+ * pool holds the whole B+ tree, so both sides run from memory. Build in
+ * Release mode, the Debug build runs with -O0 and ASAN.
+ *
+ * usage: art_bench [keys] [lookups]
+ */
+auto main(int argc, char **argv) -> int {
+  size_t num_keys = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+  size_t lookups = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100000;
+  size_t frames = num_keys / 8 + 256;
+  std::mt19937_64 gen(15445);
+
+  // bigint: 0..n 打乱顺序插入, 随机探查
+  auto int_schema = ParseCreateStatement("a bigint");
+  auto int_key_schema = std::make_shared<Schema>(Schema::CopySchema(int_schema.get(), {0}));
+  std::vector<Tuple> int_keys;
+  for (size_t i = 0; i < num_keys; i++) {
+    int_keys.emplace_back(std::vector{ValueFactory::GetBigIntValue(static_cast<int64_t>(i))}, int_key_schema.get());
+  }
+  std::shuffle(int_keys.begin(), int_keys.end(), gen);
+  std::vector<Tuple> int_probes;
+  for (size_t i = 0; i < lookups; i++) {
+    int_probes.push_back(int_keys[gen() % num_keys]);
+  }
+
+  // varchar: "<两个字母>/item-<序号>", 676 个前缀组, 每组约 n / 676 个 key
+  auto str_schema = ParseCreateStatement("a varchar(32)");
+  auto str_key_schema = std::make_shared<Schema>(Schema::CopySchema(str_schema.get(), {0}));
+  std::vector<Tuple> str_keys;
+  std::vector<std::string> prefixes;
+  for (char a = 'a'; a <= 'z'; a++) {
+    for (char b = 'a'; b <= 'z'; b++) {
+      prefixes.push_back(std::string{a, b, '/'});
+    }
+  }
+  for (size_t i = 0; i < num_keys; i++) {
+    std::string key = prefixes[gen() % prefixes.size()] + "item-" + std::to_string(i);
+    str_keys.emplace_back(std::vector{ValueFactory::GetVarcharValue(key)}, str_key_schema.get());
+  }
+  std::vector<Tuple> str_probes;
+  for (size_t i = 0; i < lookups; i++) {
+    str_probes.push_back(str_keys[gen() % num_keys]);
+  }
+  std::vector<std::string> scan_prefixes;
+  for (size_t i = 0; i < 2000; i++) {
+    scan_prefixes.push_back(prefixes[gen() % prefixes.size()]);
+  }
+
+  printf("%zu keys, %zu lookups, %zu frames\n", num_keys, lookups, frames);  // NOLINT
+  printf("bigint keys\n");                                                   // NOLINT
+  {
+    Pool pool(frames);
+    BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>> btree(
+        std::make_unique<IndexMetadata>("bench_btree", "bench", int_schema.get(), std::vector<uint32_t>{0}),
+        &pool.bpm_);
+    MeasureLookup("b+ tree", &btree, int_keys, int_probes);
+  }
+  {
+    ArtIndex art(std::make_unique<IndexMetadata>("bench_art", "bench", int_schema.get(), std::vector<uint32_t>{0}));
+    MeasureLookup("art", &art, int_keys, int_probes);
+  }
+
+  printf("varchar keys\n");  // NOLINT
+  {
+    Pool pool(frames);
+    SlottedBPlusTreeIndex btree(
+        std::make_unique<IndexMetadata>("bench_btree", "bench", str_schema.get(), std::vector<uint32_t>{0}),
+        &pool.bpm_);
+    MeasureLookup("b+ tree", &btree, str_keys, str_probes);
+    MeasurePrefix("b+ tree", scan_prefixes, [&](const std::string &prefix) {
+      // 编码后的前缀 = 0x01 + 字节, 不带结束符; 从 prefix 本身开始, 走到不再以它开头为止
+      std::string encoded;
+      KeyEncoder::AppendValue(ValueFactory::GetVarcharValue(prefix), &encoded);
+      encoded.resize(encoded.size() - 2);
+      size_t rows = 0;
+      auto iter = btree.GetBeginIterator(Tuple({ValueFactory::GetVarcharValue(prefix)}, str_key_schema.get()));
+      for (; !iter.IsEnd() && (*iter).first.compare(0, encoded.size(), encoded) == 0; ++iter) {
+        rows++;
+      }
+      return rows;
+    });
+  }
+  {
+    ArtIndex art(std::make_unique<IndexMetadata>("bench_art", "bench", str_schema.get(), std::vector<uint32_t>{0}));
+    MeasureLookup("art", &art, str_keys, str_probes);
+    std::vector<RID> rids;
+    MeasurePrefix("art", scan_prefixes, [&](const std::string &prefix) {
+      rids.clear();
+      art.ScanPrefix(prefix, &rids);
+      return rids.size();
+    });
+  }
+  return 0;
+}
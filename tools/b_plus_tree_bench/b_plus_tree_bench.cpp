@@ -0,0 +1,124 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_bench.cpp
+//
+// Identification: tools/b_plus_tree_bench/b_plus_tree_bench.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/rid.h"
+#include "storage/index/node_search.h"
+#include "storage/page/b_plus_tree_leaf_page.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+using bustub::GenericComparator;
+using bustub::GenericKey;
+using bustub::NodeSearch;
+using bustub::ParseCreateStatement;
+using bustub::RID;
+
+using KeyType = GenericKey<8>;
+using LeafEntry = std::pair<KeyType, RID>;
+
+/** keys a full leaf page of GenericKey<8> holds */
+static constexpr int NODE_SIZE = (bustub::BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(LeafEntry);
+
+/** the in-node search BPlusTreeLeafPage::IndexByKey used before NodeSearch */
+static auto LinearSearch(const LeafEntry *array, int size, const KeyType &key, const GenericComparator<8> &cmp)
+    -> int {
+  int i = 0;
+  for (i = 0; i < size; i++) {
+    if (cmp(key, array[i].first) <= 0) {
+      break;
+    }
+  }
+  return i;
+}
+
+static void Report(const char *name, size_t lookups, const std::function<int64_t()> &run) {
+  auto start = std::chrono::steady_clock::now();
+  int64_t checksum = run();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  printf("%-36s %14.0f lookups/sec  (checksum %ld)\n", name, static_cast<double>(lookups) / elapsed.count(),
+         static_cast<long>(checksum));  // NOLINT
+}
+
+/*
+ * Lookups per second of the in-node searches on one full leaf page of
+ * bigint keys. Build in Release mode, the Debug build runs with -O0 and ASAN.
+ *
+ * usage: b_plus_tree_bench [lookups]
+ */
+auto main(int argc, char **argv) -> int {
+  size_t lookups = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  std::vector<int64_t> sorted(NODE_SIZE);
+  std::vector<LeafEntry> array(NODE_SIZE);
+  for (int i = 0; i < NODE_SIZE; i++) {
+    sorted[i] = static_cast<int64_t>(i) * 2;
+    array[i].first.SetFromInteger(sorted[i]);
+    array[i].second = RID(sorted[i]);
+  }
+  // the read-mostly internal page layout: [0] holds no key, [1, NODE_SIZE] in Eytzinger order
+  std::vector<LeafEntry> eytzinger(NODE_SIZE + 1);
+  std::copy(array.begin(), array.end(), eytzinger.begin() + 1);
+  NodeSearch::ToEytzinger(eytzinger.data(), NODE_SIZE);
+
+  std::mt19937_64 gen(15445);
+  std::uniform_int_distribution<int64_t> dist(0, 2 * NODE_SIZE);
+  std::vector<int64_t> probes(lookups);
+  std::vector<KeyType> probe_keys(lookups);
+  for (size_t i = 0; i < lookups; i++) {
+    probes[i] = dist(gen);
+    probe_keys[i].SetFromInteger(probes[i]);
+  }
+
+  printf("node size: %d keys, %zu lookups\n", NODE_SIZE, lookups);
+  Report("linear scan, comparator (previous)", lookups, [&]() {
+    int64_t sum = 0;
+    for (size_t i = 0; i < lookups; i++) {
+      sum += LinearSearch(array.data(), NODE_SIZE, probe_keys[i], comparator);
+    }
+    return sum;
+  });
+  Report("NodeSearch::LowerBound", lookups, [&]() {
+    int64_t sum = 0;
+    for (size_t i = 0; i < lookups; i++) {
+      sum += NodeSearch::LowerBound(array.data(), 0, NODE_SIZE, probe_keys[i], comparator);
+    }
+    return sum;
+  });
+  Report("NodeSearch::EytzingerLastNotAfter", lookups, [&]() {
+    int64_t sum = 0;
+    for (size_t i = 0; i < lookups; i++) {
+      sum += NodeSearch::EytzingerLastNotAfter(eytzinger.data(), NODE_SIZE, probe_keys[i], comparator);
+    }
+    return sum;
+  });
+  Report("std::lower_bound on int64_t[]", lookups, [&]() {
+    int64_t sum = 0;
+    for (size_t i = 0; i < lookups; i++) {
+      sum += std::lower_bound(sorted.begin(), sorted.end(), probes[i]) - sorted.begin();
+    }
+    return sum;
+  });
+  return 0;
+}
@@ -0,0 +1,134 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_lookup_bench.cpp
+//
+// Identification: tools/b_plus_tree_lookup_bench/b_plus_tree_lookup_bench.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+using bustub::BPlusTree;
+using bustub::BufferPoolManagerInstance;
+using bustub::DiskManager;
+using bustub::GenericComparator;
+using bustub::GenericKey;
+using bustub::page_id_t;
+using bustub::ParseCreateStatement;
+using bustub::RID;
+
+using KeyType = GenericKey<8>;
+using Tree = BPlusTree<KeyType, RID, GenericComparator<8>>;
+
+static const char *const DB_FILE = "b_plus_tree_lookup_bench.db";
+
+/** insert keys into a fresh tree on bpm, after the header page */
+static void Build(Tree *tree, BufferPoolManagerInstance *bpm, const std::vector<int64_t> &keys) {
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+  KeyType index_key;
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    tree->Insert(index_key, RID(key));
+  }
+}
+
+/** GetValue for every probe, print mean and p99 latency; a first untimed pass warms the pool (and the swizzles) */
+static void Measure(const char *name, Tree *tree, const std::vector<int64_t> &probes) {
+  std::vector<int64_t> nanos(probes.size());
+  std::vector<RID> rids;
+  KeyType index_key;
+  for (auto probe : probes) {
+    index_key.SetFromInteger(probe);
+    rids.clear();
+    tree->GetValue(index_key, &rids);
+  }
+  int64_t found = 0;
+  for (size_t i = 0; i < probes.size(); i++) {
+    index_key.SetFromInteger(probes[i]);
+    rids.clear();
+    auto start = std::chrono::steady_clock::now();
+    found += tree->GetValue(index_key, &rids) ? 1 : 0;
+    nanos[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+  }
+  double mean = static_cast<double>(std::accumulate(nanos.begin(), nanos.end(), int64_t{0})) / nanos.size();
+  std::nth_element(nanos.begin(), nanos.begin() + nanos.size() * 99 / 100, nanos.end());
+  printf("  %-14s mean %9.0f ns   p99 %9ld ns   (found %ld)\n", name, mean,
+         static_cast<long>(nanos[nanos.size() * 99 / 100]), static_cast<long>(found));  // NOLINT
+}
+
+/*
+ * Point lookup latency of BPlusTree::GetValue with and without swizzled inner
+ * nodes, for buffer pools holding different fractions of the tree. Build in
+ * Release mode, the Debug build runs with -O0 and ASAN.
+ *
+ * usage: b_plus_tree_lookup_bench [keys] [lookups]
+ */
+auto main(int argc, char **argv) -> int {
+  size_t num_keys = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+  size_t lookups = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100000;
+
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  std::vector<int64_t> keys(num_keys);
+  std::iota(keys.begin(), keys.end(), 0);
+  std::mt19937_64 gen(15445);
+  std::shuffle(keys.begin(), keys.end(), gen);
+  std::uniform_int_distribution<int64_t> dist(0, static_cast<int64_t>(num_keys) - 1);
+  std::vector<int64_t> probes(lookups);
+  for (auto &probe : probes) {
+    probe = dist(gen);
+  }
+
+  // 先用装得下的 pool 建一次, 得到整棵树占多少页
+  page_id_t data_pages;
+  {
+    auto *disk_manager = new DiskManager(DB_FILE);
+    auto *bpm = new BufferPoolManagerInstance(num_keys / 32 + 64, disk_manager);
+    Tree tree("lookup_bench", bpm, comparator);
+    Build(&tree, bpm, keys);
+    bpm->NewPage(&data_pages);
+    bpm->UnpinPage(data_pages, false);
+    delete bpm;
+    delete disk_manager;
+    remove(DB_FILE);
+  }
+  printf("%zu keys in %d pages, %zu lookups\n", num_keys, data_pages, lookups);
+
+  for (double ratio : {1.0, 0.5, 0.2, 0.05}) {
+    size_t pool_size = std::max<size_t>(16, static_cast<size_t>(ratio * data_pages));
+    auto *disk_manager = new DiskManager(DB_FILE);
+    auto *bpm = new BufferPoolManagerInstance(pool_size, disk_manager);
+    Tree tree("lookup_bench", bpm, comparator);
+    Build(&tree, bpm, keys);
+
+    printf("pool/data %.2f (%zu frames)\n", ratio, pool_size);
+    tree.SetSwizzleLevels(0);
+    Measure("fetch/unpin", &tree, probes);
+    tree.SetSwizzleLevels(3);
+    Measure("swizzled", &tree, probes);
+    tree.SetSwizzleLevels(0);  // releases the swizzled frames before the pool goes away
+
+    delete bpm;
+    delete disk_manager;
+    remove(DB_FILE);
+  }
+  return 0;
+}
@@ -25,6 +25,7 @@ using bustub::DiskManager;
 using bustub::Exception;
 using bustub::GenericComparator;
 using bustub::GenericKey;
+using bustub::IndexStats;
 using bustub::page_id_t;
 using bustub::ParseCreateStatement;
 using bustub::RID;
@@ -39,6 +40,8 @@ auto UsageMessage() -> std::string {
       "\td <k>  -- Delete key <k> and its associated value.\n"
       "\tg <filename>.dot  -- Output the tree in graph format to a dot file\n"
       "\tp -- Print the B+ tree.\n"
+      "\ts -- Print height, page counts, leaf fill factor and leaf-chain contiguity.\n"
+      "\tr -- Rebuild the tree compactly (REINDEX) and print the stats before and after.\n"
       "\tq -- Quit. (Or use Ctl-D.)\n"
       "\t? -- Print this help message.\n\n"
       "Please Enter Leaf node max size and Internal node max size:\n"
@@ -47,6 +50,12 @@ auto UsageMessage() -> std::string {
   return message;
 }
 
+void PrintStats(const char *label, const IndexStats &stats) {
+  printf("%-7s height %d, %d internal pages, %d leaf pages, %ld entries, fill factor %.2f, leaf contiguity %.2f\n",
+         label, stats.height_, stats.internal_pages_, stats.leaf_pages_, static_cast<long>(stats.entries_),  // NOLINT
+         stats.fill_factor_, stats.leaf_contiguity_);
+}
+
 auto main(int argc, char **argv) -> int {
   int64_t key = 0;
   GenericKey<8> index_key;
@@ -113,6 +122,14 @@ auto main(int argc, char **argv) -> int {
       case 'p':
         tree.Print(bpm);
         break;
+      case 's':
+        PrintStats("", tree.GetStats());
+        break;
+      case 'r':
+        PrintStats("before", tree.GetStats());
+        tree.Reindex(1.0, transaction);
+        PrintStats("after", tree.GetStats());
+        break;
       case 'g':
         std::cin >> filename;
         tree.Draw(bpm, filename);
@@ -0,0 +1,140 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// copy_bench.cpp
+//
+// Identification: tools/copy_bench/copy_bench.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/bustub_instance.h"
+#include "fmt/format.h"
+#include "type/value_factory.h"
+
+using bustub::BustubInstance;
+using bustub::NoopWriter;
+using bustub::Schema;
+using bustub::Tuple;
+using bustub::ValueFactory;
+
+static const char *const DB_FILE = "copy_bench.db";
+static const char *const CSV_FILE = "copy_bench.csv";
+static const char *const BINARY_FILE = "copy_bench.bin";
+
+static auto Seconds(const std::function<void()> &work) -> double {
+  auto start = std::chrono::steady_clock::now();
+  work();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static auto FileSize(const char *path) -> size_t {
+  FILE *file = fopen(path, "rb");
+  fseek(file, 0, SEEK_END);
+  auto size = static_cast<size_t>(ftell(file));
+  fclose(file);
+  return size;
+}
+
+static void Report(const char *name, size_t rows, size_t bytes, double seconds) {
+  printf("  %-24s %8.0f krows/s   %7.1f MB/s   (%.2f s)\n", name, rows / seconds / 1000,  // NOLINT
+         bytes / seconds / (1 << 20), seconds);
+}
+
+static void ExecSql(BustubInstance *instance, const std::string &sql) {
+  NoopWriter writer;
+  instance->ExecuteSql(sql, writer);
+}
+
+/*
+ * Load rows of (int, varchar(32), int) into a fresh table: COPY FROM a csv file, COPY FROM a binary file, and
+ * INSERT ... VALUES with 1000 rows per statement (on fewer rows, it is much slower). Reading the csv file with fread is
+ * the bandwidth to compare against (the file is in the page cache after it is written). A second run of each COPY
+ * loads into a table with a b+ tree index on the first column. Build in Release mode, the Debug build runs with -O0
+ * and ASAN.
+ *
+ * usage: copy_bench [rows] [insert_rows]
+ */
+auto main(int argc, char **argv) -> int {
+  size_t rows = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+  size_t insert_rows = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100000;
+
+  auto instance = std::make_unique<BustubInstance>(DB_FILE);
+  for (const auto *table : {"csv_t", "bin_t", "insert_t", "csv_idx_t", "bin_idx_t"}) {
+    ExecSql(instance.get(), fmt::format("create table {}(a int, b varchar(32), c int);", table));
+  }
+  ExecSql(instance.get(), "create index csv_idx on csv_idx_t(a);");
+  ExecSql(instance.get(), "create index bin_idx on bin_idx_t(a);");
+  const Schema &schema = instance->catalog_->GetTable("csv_t")->schema_;
+
+  // 同样的行写成 csv 和二进制两个文件
+  FILE *csv = fopen(CSV_FILE, "wb");
+  FILE *binary = fopen(BINARY_FILE, "wb");
+  std::vector<char> bytes;
+  for (size_t i = 0; i < rows; i++) {
+    auto a = static_cast<int32_t>((i * 7919) % rows);
+    std::string b = fmt::format("customer#{:09}", i);
+    auto c = static_cast<int32_t>(i % 1000);
+    fprintf(csv, "%d,%s,%d\n", a, b.c_str(), c);  // NOLINT
+    Tuple tuple({ValueFactory::GetIntegerValue(a), ValueFactory::GetVarcharValue(b), ValueFactory::GetIntegerValue(c)},
+                &schema);
+    bytes.resize(tuple.GetLength() + sizeof(uint32_t));
+    tuple.SerializeTo(bytes.data());
+    fwrite(bytes.data(), 1, bytes.size(), binary);
+  }
+  fclose(csv);
+  fclose(binary);
+  size_t csv_bytes = FileSize(CSV_FILE);
+  size_t binary_bytes = FileSize(BINARY_FILE);
+
+  printf("%zu rows, csv %.1f MB, binary %.1f MB\n", rows, csv_bytes / double(1 << 20),  // NOLINT
+         binary_bytes / double(1 << 20));
+  Report("fread csv file", rows, csv_bytes, Seconds([&]() {
+           std::vector<char> buffer(1 << 20);
+           FILE *file = fopen(CSV_FILE, "rb");
+           while (fread(buffer.data(), 1, buffer.size(), file) > 0) {
+           }
+           fclose(file);
+         }));
+  Report("copy csv", rows, csv_bytes,
+         Seconds([&]() { ExecSql(instance.get(), fmt::format("copy csv_t from '{}';", CSV_FILE)); }));
+  Report("copy binary", rows, binary_bytes, Seconds([&]() {
+           ExecSql(instance.get(), fmt::format("copy bin_t from '{}' (format binary);", BINARY_FILE));
+         }));
+  Report("copy csv, indexed", rows, csv_bytes,
+         Seconds([&]() { ExecSql(instance.get(), fmt::format("copy csv_idx_t from '{}';", CSV_FILE)); }));
+  Report("copy binary, indexed", rows, binary_bytes, Seconds([&]() {
+           ExecSql(instance.get(), fmt::format("copy bin_idx_t from '{}' (format binary);", BINARY_FILE));
+         }));
+
+  // 对照: 每条语句 1000 行的 INSERT
+  std::vector<std::string> statements;
+  for (size_t i = 0; i < insert_rows; i += 1000) {
+    std::string sql = "insert into insert_t values ";
+    for (size_t j = i; j < std::min(i + 1000, insert_rows); j++) {
+      sql += fmt::format("{}({}, 'customer#{:09}', {})", j == i ? "" : ", ", (j * 7919) % rows, j, j % 1000);
+    }
+    statements.push_back(sql + ";");
+  }
+  Report("insert, 1000 rows/stmt", insert_rows, 0, Seconds([&]() {
+           for (const auto &sql : statements) {
+             ExecSql(instance.get(), sql);
+           }
+         }));
+
+  instance.reset();
+  remove(CSV_FILE);
+  remove(BINARY_FILE);
+  remove(DB_FILE);
+  return 0;
+}
@@ -0,0 +1,187 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extendible_hash_table_bench.cpp
+//
+// Identification: tools/extendible_hash_table_bench/extendible_hash_table_bench.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <numeric>
+#include <random>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "container/hash/extendible_hash_table.h"
+
+using bustub::ExtendibleHashTable;
+
+/**
+ * The previous ExtendibleHashTable, kept here as the baseline: a std::list per bucket, shared_ptr buckets in the
+ * directory and one latch around everything.
+ */
+class ListHashTable {
+ public:
+  explicit ListHashTable(size_t bucket_size) : bucket_size_(bucket_size) {
+    dir_.push_back(std::make_shared<Bucket>());
+  }
+
+  auto Find(const int &key, int &value) -> bool {
+    std::scoped_lock<std::mutex> lock(latch_);
+    for (auto &[k, v] : dir_[IndexOf(key)]->list_) {
+      if (k == key) {
+        value = v;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void Insert(const int &key, const int &value) {
+    std::scoped_lock<std::mutex> lock(latch_);
+    size_t id = IndexOf(key);
+    for (auto &[k, v] : dir_[id]->list_) {
+      if (k == key) {
+        v = value;
+        return;
+      }
+    }
+    while (dir_[id]->list_.size() == bucket_size_) {
+      Split(dir_[id]);
+      id = IndexOf(key);
+    }
+    dir_[id]->list_.emplace_back(key, value);
+  }
+
+ private:
+  struct Bucket {
+    int depth_{0};
+    std::list<std::pair<int, int>> list_;
+  };
+
+  auto IndexOf(const int &key) -> size_t { return std::hash<int>()(key) & ((1 << global_depth_) - 1); }
+
+  void Split(std::shared_ptr<Bucket> bucket) {
+    if (bucket->depth_ == global_depth_) {
+      size_t old_size = dir_.size();
+      dir_.resize(old_size * 2);
+      std::copy(dir_.begin(), dir_.begin() + old_size, dir_.begin() + old_size);
+      global_depth_++;
+    }
+    bucket->depth_++;
+    size_t high_bit = static_cast<size_t>(1) << (bucket->depth_ - 1);
+    auto image = std::make_shared<Bucket>();
+    image->depth_ = bucket->depth_;
+    for (auto it = bucket->list_.begin(); it != bucket->list_.end();) {
+      if ((std::hash<int>()(it->first) & high_bit) != 0) {
+        image->list_.push_back(*it);
+        it = bucket->list_.erase(it);
+      } else {
+        it++;
+      }
+    }
+    for (size_t i = 0; i < dir_.size(); i++) {
+      if (dir_[i] == bucket && (i & high_bit) != 0) {
+        dir_[i] = image;
+      }
+    }
+  }
+
+  size_t bucket_size_;
+  int global_depth_{0};
+  std::mutex latch_;
+  std::vector<std::shared_ptr<Bucket>> dir_;
+};
+
+static auto NanosPerOp(size_t ops, const std::function<void()> &work) -> double {
+  auto start = std::chrono::steady_clock::now();
+  work();
+  auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+  return static_cast<double>(nanos) / ops;
+}
+
+/** insert keys in random order, look every key up, look up as many absent keys, then the same lookups on threads */
+template <typename Table>
+static void Measure(const char *name, size_t bucket_size, const std::vector<int> &keys) {
+  Table table(bucket_size);
+  size_t n = keys.size();
+  int sink = 0;
+  double insert = NanosPerOp(n, [&]() {
+    for (int key : keys) {
+      table.Insert(key, key);
+    }
+  });
+  double hit = NanosPerOp(n, [&]() {
+    int value;
+    for (int key : keys) {
+      sink += static_cast<int>(table.Find(key, value));
+    }
+  });
+  double miss = NanosPerOp(n, [&]() {
+    int value;
+    for (int key : keys) {
+      sink += static_cast<int>(table.Find(-key - 1, value));
+    }
+  });
+  printf("  %-6s insert %6.1f ns   find hit %6.1f ns   find miss %6.1f ns", name, insert, hit, miss);  // NOLINT
+
+  for (size_t num_threads : {2, 4}) {
+    std::vector<int> hits(num_threads);
+    double nanos = NanosPerOp(n * num_threads, [&]() {
+      std::vector<std::thread> threads;
+      for (size_t t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t]() {
+          int value;
+          int local_hits = 0;
+          for (int key : keys) {
+            local_hits += static_cast<int>(table.Find(key, value));
+          }
+          hits[t] = local_hits;
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+    });
+    sink += std::accumulate(hits.begin(), hits.end(), 0) / static_cast<int>(num_threads) - static_cast<int>(n);
+    printf("   %zu threads %6.1f ns", num_threads, nanos);  // NOLINT
+  }
+  printf("\n");  // NOLINT
+  if (sink != static_cast<int>(n)) {
+    printf("  wrong number of hits: %d\n", sink);  // NOLINT
+  }
+}
+
+/*
+ * Insert and Find of ExtendibleHashTable<int, int> against the list-bucket version it replaced, ns per operation.
+ * The multi-threaded columns are wall clock per lookup summed over all threads. Build in Release mode, the Debug
+ * build runs with -O0 and ASAN.
+ *
+ * usage: extendible_hash_table_bench [keys] [bucket size]
+ */
+auto main(int argc, char **argv) -> int {
+  size_t num_keys = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+  size_t bucket_size = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 4;
+  std::vector<int> keys(num_keys);
+  std::iota(keys.begin(), keys.end(), 0);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+
+  printf("%zu keys, bucket size %zu\n", num_keys, bucket_size);  // NOLINT
+  for (int round = 0; round < 2; round++) {
+    Measure<ListHashTable>("list", bucket_size, keys);
+    Measure<ExtendibleHashTable<int, int>>("flat", bucket_size, keys);
+  }
+  return 0;
+}
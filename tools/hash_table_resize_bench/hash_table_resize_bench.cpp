@@ -0,0 +1,77 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_resize_bench.cpp
+//
+// Identification: tools/hash_table_resize_bench/hash_table_resize_bench.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "container/disk/hash/linear_probe_hash_table.h"
+
+using bustub::BufferPoolManagerInstance;
+using bustub::DiskManager;
+using bustub::HashFunction;
+using bustub::IntComparator;
+using bustub::LinearProbeHashTable;
+
+static const char *const DB_FILE = "hash_table_resize_bench.db";
+
+/** insert keys 0..num_keys into a table starting at 64 slots, print mean, p99, p99.9 and max insert latency */
+static void Measure(const char *name, size_t migration_batch, size_t num_keys, size_t pool_size) {
+  auto *disk_manager = new DiskManager(DB_FILE);
+  auto *bpm = new BufferPoolManagerInstance(pool_size, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("resize_bench", bpm, IntComparator(), 64, HashFunction<int>());
+  ht.SetMigrationBatch(migration_batch);
+
+  std::vector<int64_t> nanos(num_keys);
+  for (size_t i = 0; i < num_keys; i++) {
+    auto start = std::chrono::steady_clock::now();
+    ht.Insert(nullptr, static_cast<int>(i), static_cast<int>(i));
+    nanos[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+  }
+  double mean = static_cast<double>(std::accumulate(nanos.begin(), nanos.end(), int64_t{0})) / nanos.size();
+  std::sort(nanos.begin(), nanos.end());
+  printf("  %-22s mean %8.0f ns   p99 %8ld ns   p99.9 %10ld ns   max %11ld ns   (%zu slots)\n", name, mean,  // NOLINT
+         static_cast<long>(nanos[nanos.size() * 99 / 100]),                                                   // NOLINT
+         static_cast<long>(nanos[nanos.size() * 999 / 1000]), static_cast<long>(nanos.back()),                // NOLINT
+         ht.GetSize());
+
+  delete bpm;
+  delete disk_manager;
+  remove(DB_FILE);
+}
+
+/*
+ * Insert latency of LinearProbeHashTable growing from 64 slots, with the whole
+ * table rehashed inside the insert that triggers a doubling, and with the old
+ * array drained a few slots per insert. Build in Release mode, the Debug build
+ * runs with -O0 and ASAN.
+ *
+ * usage: hash_table_resize_bench [keys] [pool frames]
+ *
+ * One header page caps the table at about 500k slots, keep keys below ~375k.
+ */
+auto main(int argc, char **argv) -> int {
+  size_t num_keys = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+  size_t pool_size = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 256;
+  printf("%zu inserts, %zu frames\n", num_keys, pool_size);
+  Measure("blocking rehash", 0, num_keys, pool_size);
+  for (size_t batch : {16, 64, 256}) {
+    char name[32];
+    snprintf(name, sizeof(name), "incremental, %zu/op", batch);
+    Measure(name, batch, num_keys, pool_size);
+  }
+  return 0;
+}
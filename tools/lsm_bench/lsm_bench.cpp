@@ -0,0 +1,146 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lsm_bench.cpp
+//
+// Identification: tools/lsm_bench/lsm_bench.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "storage/index/b_plus_tree_index.h"
+#include "storage/index/lsm_index.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+using bustub::BPlusTreeIndex;
+using bustub::BufferPoolManagerInstance;
+using bustub::DiskManager;
+using bustub::GenericComparator;
+using bustub::GenericKey;
+using bustub::Index;
+using bustub::IndexMetadata;
+using bustub::LsmIndex;
+using bustub::page_id_t;
+using bustub::ParseCreateStatement;
+using bustub::RID;
+using bustub::Schema;
+using bustub::Tuple;
+using bustub::ValueFactory;
+
+static const char *const DB_FILE = "lsm_bench.db";
+
+static auto NanosPerOp(size_t ops, const std::function<void()> &work) -> double {
+  auto start = std::chrono::steady_clock::now();
+  work();
+  auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+  return static_cast<double>(nanos) / ops;
+}
+
+/** a fresh pool and disk file, with the header page the b+ tree keeps its root in */
+struct Pool {
+  explicit Pool(size_t frames) : disk_manager_(DB_FILE), bpm_(frames, &disk_manager_) {
+    page_id_t header_page_id;
+    bpm_.NewPage(&header_page_id);
+    bpm_.UnpinPage(header_page_id, true);
+  }
+  ~Pool() { remove(DB_FILE); }
+  DiskManager disk_manager_;
+  BufferPoolManagerInstance bpm_;
+};
+
+/**
+ * insert keys (RID i for keys[i]), flush with flush, then ScanKey every hit and every miss; print ns per operation
+ * and the pages written to disk during the ingest
+ */
+static void Measure(const char *name, Index *index, Pool *pool, const std::vector<Tuple> &keys,
+                    const std::vector<Tuple> &hits, const std::vector<Tuple> &misses,
+                    const std::function<void()> &flush) {
+  int writes = pool->disk_manager_.GetNumWrites();
+  double insert = NanosPerOp(keys.size(), [&]() {
+    for (size_t i = 0; i < keys.size(); i++) {
+      index->InsertEntry(keys[i], RID(static_cast<int64_t>(i)), nullptr);
+    }
+    flush();
+  });
+  writes = pool->disk_manager_.GetNumWrites() - writes;
+  std::vector<RID> rids;
+  double hit = NanosPerOp(hits.size(), [&]() {
+    for (const auto &probe : hits) {
+      index->ScanKey(probe, &rids, nullptr);
+    }
+  });
+  size_t found = rids.size();
+  double miss = NanosPerOp(misses.size(), [&]() {
+    for (const auto &probe : misses) {
+      index->ScanKey(probe, &rids, nullptr);
+    }
+  });
+  printf("  %-8s insert %7.0f ns  (%7d page writes)   hit %7.0f ns   miss %7.0f ns   (found %zu / %zu)\n",  // NOLINT
+         name, insert, writes, hit, miss, found, rids.size());
+}
+
+/*
+ * LSM index against the B+ tree (BPlusTreeIndex<GenericKey<8>>) on BIGINT keys inserted in random order: ingest
+ * throughput with the page writes it causes, and point lookups (Index::ScanKey) of keys that exist and of keys that
+ * do not (the bloom filters skip runs). The pool is much smaller than the index, as for an index that does not fit
+ * in memory. Build in Release mode, the Debug build runs with -O0 and ASAN.
+ *
+ * usage: lsm_bench [keys] [lookups] [frames]
+ */
+auto main(int argc, char **argv) -> int {
+  size_t num_keys = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+  size_t lookups = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100000;
+  size_t frames = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 256;
+  std::mt19937_64 gen(15445);
+
+  // 偶数 key 打乱顺序插入, 奇数 key 探查不存在的情况
+  auto schema = ParseCreateStatement("a bigint");
+  auto key_schema = std::make_shared<Schema>(Schema::CopySchema(schema.get(), {0}));
+  auto make_key = [&](int64_t key) { return Tuple({ValueFactory::GetBigIntValue(key)}, key_schema.get()); };
+  std::vector<Tuple> keys;
+  for (size_t i = 0; i < num_keys; i++) {
+    keys.push_back(make_key(static_cast<int64_t>(2 * i)));
+  }
+  std::shuffle(keys.begin(), keys.end(), gen);
+  std::vector<Tuple> hits;
+  std::vector<Tuple> misses;
+  for (size_t i = 0; i < lookups; i++) {
+    hits.push_back(keys[gen() % num_keys]);
+    misses.push_back(make_key(static_cast<int64_t>(2 * (gen() % num_keys) + 1)));
+  }
+
+  printf("%zu keys, %zu lookups, %zu frames\n", num_keys, lookups, frames);  // NOLINT
+  {
+    Pool pool(frames);
+    BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>> btree(
+        std::make_unique<IndexMetadata>("bench_btree", "bench", schema.get(), std::vector<uint32_t>{0}), &pool.bpm_);
+    Measure("b+ tree", &btree, &pool, keys, hits, misses, [&]() { btree.MergeChangeBuffer(); });
+  }
+  {
+    Pool pool(frames);
+    LsmIndex lsm(std::make_unique<IndexMetadata>("bench_lsm", "bench", schema.get(), std::vector<uint32_t>{0}),
+                 &pool.bpm_);
+    Measure("lsm", &lsm, &pool, keys, hits, misses, [&]() { lsm.Flush(); });
+    auto shape = lsm.GetTree().GetShape();
+    printf("  lsm shape: %zu level-0 runs", shape[0]);  // NOLINT
+    for (size_t i = 1; i < shape.size(); i++) {
+      printf(", L%zu %zu KB", i, shape[i] / 1024);  // NOLINT
+    }
+    printf("\n");  // NOLINT
+  }
+  return 0;
+}
@@ -0,0 +1,394 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pax_bench.cpp
+//
+// Identification: tools/pax_bench/pax_bench.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "concurrency/transaction.h"
+#include "storage/page/pax_page.h"
+#include "storage/table/table_heap.h"
+#include "storage/table/table_page_scan.h"
+#include "type/value_factory.h"
+
+using bustub::BufferPoolManager;
+using bustub::BufferPoolManagerInstance;
+using bustub::Column;
+using bustub::DiskManager;
+using bustub::LockManager;
+using bustub::page_id_t;
+using bustub::PaxLayout;
+using bustub::PaxPage;
+using bustub::RID;
+using bustub::Schema;
+using bustub::TableHeap;
+using bustub::TablePageScan;
+using bustub::Transaction;
+using bustub::Tuple;
+using bustub::TupleView;
+using bustub::TypeId;
+using bustub::ValueFactory;
+
+static const char *const DB_FILE = "pax_bench.db";
+
+/** TPC-H lineitem, dates as days since 1992-01-01 */
+enum LineitemColumn : uint32_t {
+  L_ORDERKEY,
+  L_PARTKEY,
+  L_SUPPKEY,
+  L_LINENUMBER,
+  L_QUANTITY,
+  L_EXTENDEDPRICE,
+  L_DISCOUNT,
+  L_TAX,
+  L_RETURNFLAG,
+  L_LINESTATUS,
+  L_SHIPDATE,
+  L_COMMITDATE,
+  L_RECEIPTDATE,
+  L_SHIPINSTRUCT,
+  L_SHIPMODE,
+  L_COMMENT,
+};
+
+/** 1998-12-01 - 90 days, Q1 */
+static constexpr int32_t Q1_SHIPDATE = 2435;
+/** [1994-01-01, 1995-01-01), Q6 */
+static constexpr int32_t Q6_SHIPDATE_LO = 731;
+static constexpr int32_t Q6_SHIPDATE_HI = 1096;
+
+/** the aggregates of one Q1 group */
+struct Q1Group {
+  double sum_qty_{0};
+  double sum_base_price_{0};
+  double sum_disc_price_{0};
+  double sum_charge_{0};
+  double sum_disc_{0};
+  int64_t count_{0};
+
+  void Add(double quantity, double price, double discount, double tax) {
+    sum_qty_ += quantity;
+    sum_base_price_ += price;
+    sum_disc_price_ += price * (1 - discount);
+    sum_charge_ += price * (1 - discount) * (1 + tax);
+    sum_disc_ += discount;
+    count_++;
+  }
+};
+
+/** the groups of Q1 by (returnflag, linestatus), folded into one number to compare the runs */
+static auto Q1Checksum(const std::map<std::pair<char, char>, Q1Group> &groups) -> double {
+  double checksum = 0;
+  for (const auto &[key, group] : groups) {
+    checksum += key.first * group.sum_charge_ + key.second * group.sum_disc_price_ + group.sum_qty_ +
+                group.sum_base_price_ + group.sum_disc_ + static_cast<double>(group.count_);
+  }
+  return checksum;
+}
+
+static auto Q6Match(double quantity, double discount, int32_t shipdate) -> bool {
+  return shipdate >= Q6_SHIPDATE_LO && shipdate < Q6_SHIPDATE_HI && discount >= 0.05 && discount <= 0.07 &&
+         quantity < 24;
+}
+
+/**
+ * Run query rounds times after a warm-up run, or just once if rounds is 0, and print ns per row. query returns a
+ * checksum so the work is not optimized away.
+ */
+static void Measure(const char *name, size_t rows, int rounds, const std::function<double()> &query) {
+  double checksum = rounds == 0 ? 0 : query();
+  int runs = std::max(rounds, 1);
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < runs; i++) {
+    checksum += query();
+  }
+  auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+  printf("  %-26s %7.1f ns/row   (checksum %.6g)\n", name, static_cast<double>(nanos) / (rows * runs),  // NOLINT
+         checksum);
+}
+
+static auto MakeLineitem(std::mt19937_64 *rng, size_t i, const Schema *schema) -> Tuple {
+  static const char *const INSTRUCTS[] = {"DELIVER IN PERSON", "COLLECT COD", "NONE", "TAKE BACK RETURN"};
+  static const char *const MODES[] = {"REG AIR", "AIR", "RAIL", "SHIP", "TRUCK", "MAIL", "FOB"};
+  auto uniform = [&](int lo, int hi) { return std::uniform_int_distribution<int>(lo, hi)(*rng); };
+  int quantity = uniform(1, 50);
+  int shipdate = uniform(1, 2526);
+  int receiptdate = shipdate + uniform(1, 30);
+  // 1995-06-17 之前收到的有 R / A, 之后的是 N; 发货在那之后的还没完 (O)
+  const char *returnflag = receiptdate <= 1263 ? (uniform(0, 1) == 0 ? "R" : "A") : "N";
+  const char *linestatus = shipdate > 1263 ? "O" : "F";
+  std::string comment(uniform(10, 43), 'c');
+  return Tuple({ValueFactory::GetIntegerValue(static_cast<int32_t>(i / 4)),
+                ValueFactory::GetIntegerValue(uniform(1, 200000)), ValueFactory::GetIntegerValue(uniform(1, 10000)),
+                ValueFactory::GetIntegerValue(static_cast<int32_t>(i % 4 + 1)),
+                ValueFactory::GetDecimalValue(quantity),
+                ValueFactory::GetDecimalValue(quantity * (900 + uniform(0, 110000) / 100.0)),
+                ValueFactory::GetDecimalValue(uniform(0, 10) / 100.0),
+                ValueFactory::GetDecimalValue(uniform(0, 8) / 100.0),
+                ValueFactory::GetVarcharValue(returnflag), ValueFactory::GetVarcharValue(linestatus),
+                ValueFactory::GetIntegerValue(shipdate), ValueFactory::GetIntegerValue(shipdate + uniform(-30, 60)),
+                ValueFactory::GetIntegerValue(receiptdate), ValueFactory::GetVarcharValue(INSTRUCTS[uniform(0, 3)]),
+                ValueFactory::GetVarcharValue(MODES[uniform(0, 6)]), ValueFactory::GetVarcharValue(comment)},
+               schema);
+}
+
+template <typename T>
+static auto Load(const char *data, uint32_t offset) -> T {
+  T value;
+  memcpy(&value, data + offset, sizeof(T));
+  return value;
+}
+
+/** the first byte of a varchar column of a row */
+static auto FirstChar(const char *data, uint32_t offset) -> char {
+  return data[Load<uint32_t>(data, offset) + sizeof(uint32_t)];
+}
+
+/** fetch every page of heap and keep it pinned, so the queries below measure the pages and not the buffer pool */
+static auto PinPages(BufferPoolManager *bpm, TableHeap *heap) -> std::vector<bustub::TablePage *> {
+  std::vector<bustub::TablePage *> pages;
+  page_id_t page_id = heap->GetFirstPageId();
+  while (page_id != bustub::INVALID_PAGE_ID) {
+    auto page = static_cast<bustub::TablePage *>(bpm->FetchPage(page_id));
+    pages.push_back(page);
+    page_id = page->GetNextPageId();
+  }
+  return pages;
+}
+
+/** run fn on the views of every live tuple of pages, as TablePageScan makes them */
+template <typename F>
+static void ForEachView(TableHeap *heap, const std::vector<bustub::TablePage *> &pages,
+                        const std::vector<uint32_t> &columns, F &&fn) {
+  std::vector<char> rows;
+  std::vector<TupleView> views;
+  for (auto page : pages) {
+    views.clear();
+    heap->GetTupleViews(page, page->GetData(), &columns, &rows, &views);
+    for (const auto &view : views) {
+      fn(view);
+    }
+  }
+}
+
+/** fold 256 x 256 Q1 groups by the first bytes of (returnflag, linestatus) into the groups that are used */
+static auto Q1Result(const std::vector<Q1Group> &groups) -> double {
+  std::map<std::pair<char, char>, Q1Group> result;
+  for (int flag : {'A', 'N', 'R'}) {
+    for (int status : {'F', 'O'}) {
+      if (groups[flag * 256 + status].count_ > 0) {
+        result[{static_cast<char>(flag), static_cast<char>(status)}] = groups[flag * 256 + status];
+      }
+    }
+  }
+  return Q1Checksum(result);
+}
+
+static auto Q1Slot(char flag, char status) -> size_t {
+  return static_cast<uint8_t>(flag) * 256 + static_cast<uint8_t>(status);
+}
+
+/*
+ * TPC-H Q1 and Q6 over a lineitem table stored in row pages (TablePage) and in PAX pages (PaxPage).
+ *  - page scan: TablePageScan and TupleView::GetValue, what SeqScanExecutor and the expressions above it do. On the PAX
+ *    table the scan is told the columns the query reads, as OptimizeSeqScanColumns does, and puts only those together.
+ *    Run once: it fetches every page from the buffer pool, and the replacer costs more than the rest of the query.
+ * The other variants work on pages fetched once and left pinned:
+ *  - views: the views of the page scan, with TupleView::GetValue.
+ *  - raw: the same views, reading the fields directly.
+ *  - minipages (PAX only): the query runs on the column arrays of each page, no rows at all.
+ * The pool holds both tables. Build in Release mode, the Debug build runs with -O0 and ASAN.
+ *
+ * usage: pax_bench [rows] [rounds]
+ */
+auto main(int argc, char **argv) -> int {
+  size_t rows = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+  int rounds = argc > 2 ? std::atoi(argv[2]) : 20;
+
+  DiskManager disk_manager(DB_FILE);
+  // 每页二三十行, 两张表都放得进 buffer pool
+  BufferPoolManagerInstance bpm(rows / 10 + 64, &disk_manager);
+  LockManager lock_manager;
+  Transaction txn(0);
+  Schema schema({Column{"l_orderkey", TypeId::INTEGER}, Column{"l_partkey", TypeId::INTEGER},
+                 Column{"l_suppkey", TypeId::INTEGER}, Column{"l_linenumber", TypeId::INTEGER},
+                 Column{"l_quantity", TypeId::DECIMAL}, Column{"l_extendedprice", TypeId::DECIMAL},
+                 Column{"l_discount", TypeId::DECIMAL}, Column{"l_tax", TypeId::DECIMAL},
+                 Column{"l_returnflag", TypeId::VARCHAR, 1}, Column{"l_linestatus", TypeId::VARCHAR, 1},
+                 Column{"l_shipdate", TypeId::INTEGER}, Column{"l_commitdate", TypeId::INTEGER},
+                 Column{"l_receiptdate", TypeId::INTEGER}, Column{"l_shipinstruct", TypeId::VARCHAR, 25},
+                 Column{"l_shipmode", TypeId::VARCHAR, 10}, Column{"l_comment", TypeId::VARCHAR, 44}});
+  TableHeap row_heap(&bpm, &lock_manager, nullptr, &txn);
+  TableHeap pax_heap(&bpm, &lock_manager, nullptr, &txn, &schema);
+  std::mt19937_64 rng(42);
+  for (size_t i = 0; i < rows; i++) {
+    Tuple tuple = MakeLineitem(&rng, i, &schema);
+    RID rid;
+    row_heap.InsertTuple(tuple, &rid, &txn);
+    pax_heap.InsertTuple(tuple, &rid, &txn);
+  }
+  txn.GetWriteSet()->clear();
+  const PaxLayout &layout = *pax_heap.GetPaxLayout();
+
+  const std::vector<uint32_t> q1_columns{L_QUANTITY, L_EXTENDEDPRICE, L_DISCOUNT, L_TAX, L_RETURNFLAG, L_LINESTATUS,
+                                         L_SHIPDATE};
+  const std::vector<uint32_t> q6_columns{L_QUANTITY, L_EXTENDEDPRICE, L_DISCOUNT, L_SHIPDATE};
+
+  auto q1_view = [&](std::vector<Q1Group> *groups, const TupleView &view) {
+    if (view.GetValue(&schema, L_SHIPDATE).GetAs<int32_t>() <= Q1_SHIPDATE) {
+      (*groups)[Q1Slot(view.GetValue(&schema, L_RETURNFLAG).GetData()[0],
+                       view.GetValue(&schema, L_LINESTATUS).GetData()[0])]
+          .Add(view.GetValue(&schema, L_QUANTITY).GetAs<double>(),
+               view.GetValue(&schema, L_EXTENDEDPRICE).GetAs<double>(),
+               view.GetValue(&schema, L_DISCOUNT).GetAs<double>(), view.GetValue(&schema, L_TAX).GetAs<double>());
+    }
+  };
+  auto q6_view = [&](double *revenue, const TupleView &view) {
+    double discount = view.GetValue(&schema, L_DISCOUNT).GetAs<double>();
+    if (Q6Match(view.GetValue(&schema, L_QUANTITY).GetAs<double>(), discount,
+                view.GetValue(&schema, L_SHIPDATE).GetAs<int32_t>())) {
+      *revenue += view.GetValue(&schema, L_EXTENDEDPRICE).GetAs<double>() * discount;
+    }
+  };
+  auto offset = [&](uint32_t column_idx) { return schema.GetColumn(column_idx).GetOffset(); };
+  auto q1_raw = [&](std::vector<Q1Group> *groups, const TupleView &view) {
+    const char *data = view.GetData();
+    if (Load<int32_t>(data, offset(L_SHIPDATE)) <= Q1_SHIPDATE) {
+      (*groups)[Q1Slot(FirstChar(data, offset(L_RETURNFLAG)), FirstChar(data, offset(L_LINESTATUS)))].Add(
+          Load<double>(data, offset(L_QUANTITY)), Load<double>(data, offset(L_EXTENDEDPRICE)),
+          Load<double>(data, offset(L_DISCOUNT)), Load<double>(data, offset(L_TAX)));
+    }
+  };
+  auto q6_raw = [&](double *revenue, const TupleView &view) {
+    const char *data = view.GetData();
+    double discount = Load<double>(data, offset(L_DISCOUNT));
+    if (Q6Match(Load<double>(data, offset(L_QUANTITY)), discount, Load<int32_t>(data, offset(L_SHIPDATE)))) {
+      *revenue += Load<double>(data, offset(L_EXTENDEDPRICE)) * discount;
+    }
+  };
+
+  auto q1_page_scan = [&](TableHeap *heap) {
+    std::vector<Q1Group> groups(256 * 256);
+    TablePageScan scan(heap, &txn, q1_columns);
+    while (scan.NextPage()) {
+      for (const auto &view : scan.GetViews()) {
+        q1_view(&groups, view);
+      }
+    }
+    return Q1Result(groups);
+  };
+  auto q6_page_scan = [&](TableHeap *heap) {
+    double revenue = 0;
+    TablePageScan scan(heap, &txn, q6_columns);
+    while (scan.NextPage()) {
+      for (const auto &view : scan.GetViews()) {
+        q6_view(&revenue, view);
+      }
+    }
+    return revenue;
+  };
+  printf("%zu rows, %u rows per PAX page\n", rows, layout.GetCapacity());  // NOLINT
+  printf("Q1\n");                                                          // NOLINT
+  Measure("row, page scan", rows, 0, [&]() { return q1_page_scan(&row_heap); });
+  Measure("pax, page scan", rows, 0, [&]() { return q1_page_scan(&pax_heap); });
+  printf("Q6\n");  // NOLINT
+  Measure("row, page scan", rows, 0, [&]() { return q6_page_scan(&row_heap); });
+  Measure("pax, page scan", rows, 0, [&]() { return q6_page_scan(&pax_heap); });
+
+  auto row_pages = PinPages(&bpm, &row_heap);
+  auto pax_pages = PinPages(&bpm, &pax_heap);
+  printf("%zu row pages, %zu PAX pages, pinned; %d rounds\n", row_pages.size(), pax_pages.size(), rounds);  // NOLINT
+
+  auto q1_minipages = [&]() {
+    std::vector<Q1Group> groups(256 * 256);
+    for (auto table_page : pax_pages) {
+      auto page = static_cast<PaxPage *>(table_page);
+      auto quantity = reinterpret_cast<const double *>(page->GetColumnData(layout, L_QUANTITY));
+      auto price = reinterpret_cast<const double *>(page->GetColumnData(layout, L_EXTENDEDPRICE));
+      auto discount = reinterpret_cast<const double *>(page->GetColumnData(layout, L_DISCOUNT));
+      auto tax = reinterpret_cast<const double *>(page->GetColumnData(layout, L_TAX));
+      auto shipdate = reinterpret_cast<const int32_t *>(page->GetColumnData(layout, L_SHIPDATE));
+      for (uint32_t word = 0; word * 64 < page->GetSlotCount(); word++) {
+        for (uint64_t live = page->GetLiveBits(layout, word); live != 0; live &= live - 1) {
+          uint32_t slot = word * 64 + __builtin_ctzll(live);
+          if (shipdate[slot] <= Q1_SHIPDATE) {
+            groups[Q1Slot(*page->GetVarcharData(layout, L_RETURNFLAG, slot),
+                          *page->GetVarcharData(layout, L_LINESTATUS, slot))]
+                .Add(quantity[slot], price[slot], discount[slot], tax[slot]);
+          }
+        }
+      }
+    }
+    return Q1Result(groups);
+  };
+  auto q6_minipages = [&]() {
+    double revenue = 0;
+    for (auto table_page : pax_pages) {
+      auto page = static_cast<PaxPage *>(table_page);
+      auto quantity = reinterpret_cast<const double *>(page->GetColumnData(layout, L_QUANTITY));
+      auto price = reinterpret_cast<const double *>(page->GetColumnData(layout, L_EXTENDEDPRICE));
+      auto discount = reinterpret_cast<const double *>(page->GetColumnData(layout, L_DISCOUNT));
+      auto shipdate = reinterpret_cast<const int32_t *>(page->GetColumnData(layout, L_SHIPDATE));
+      for (uint32_t word = 0; word * 64 < page->GetSlotCount(); word++) {
+        for (uint64_t live = page->GetLiveBits(layout, word); live != 0; live &= live - 1) {
+          uint32_t slot = word * 64 + __builtin_ctzll(live);
+          if (Q6Match(quantity[slot], discount[slot], shipdate[slot])) {
+            revenue += price[slot] * discount[slot];
+          }
+        }
+      }
+    }
+    return revenue;
+  };
+  auto q1 = [&](TableHeap *heap, const std::vector<bustub::TablePage *> &pages, bool raw) {
+    std::vector<Q1Group> groups(256 * 256);
+    ForEachView(heap, pages, q1_columns,
+                [&](const TupleView &view) { raw ? q1_raw(&groups, view) : q1_view(&groups, view); });
+    return Q1Result(groups);
+  };
+  auto q6 = [&](TableHeap *heap, const std::vector<bustub::TablePage *> &pages, bool raw) {
+    double revenue = 0;
+    ForEachView(heap, pages, q6_columns,
+                [&](const TupleView &view) { raw ? q6_raw(&revenue, view) : q6_view(&revenue, view); });
+    return revenue;
+  };
+
+  printf("Q1\n");  // NOLINT
+  Measure("row, views", rows, rounds, [&]() { return q1(&row_heap, row_pages, false); });
+  Measure("pax, views", rows, rounds, [&]() { return q1(&pax_heap, pax_pages, false); });
+  Measure("row, raw", rows, rounds, [&]() { return q1(&row_heap, row_pages, true); });
+  Measure("pax, raw", rows, rounds, [&]() { return q1(&pax_heap, pax_pages, true); });
+  Measure("pax, minipages", rows, rounds, q1_minipages);
+  printf("Q6\n");  // NOLINT
+  Measure("row, views", rows, rounds, [&]() { return q6(&row_heap, row_pages, false); });
+  Measure("pax, views", rows, rounds, [&]() { return q6(&pax_heap, pax_pages, false); });
+  Measure("row, raw", rows, rounds, [&]() { return q6(&row_heap, row_pages, true); });
+  Measure("pax, raw", rows, rounds, [&]() { return q6(&pax_heap, pax_pages, true); });
+  Measure("pax, minipages", rows, rounds, q6_minipages);
+
+  for (auto pages : {&row_pages, &pax_pages}) {
+    for (auto page : *pages) {
+      bpm.UnpinPage(page->GetPageId(), false);
+    }
+  }
+  remove(DB_FILE);
+  return 0;
+}
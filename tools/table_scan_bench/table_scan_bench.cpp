@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_scan_bench.cpp
+//
+// Identification: tools/table_scan_bench/table_scan_bench.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "concurrency/transaction.h"
+#include "storage/table/table_heap.h"
+#include "storage/table/table_page_scan.h"
+#include "type/value_factory.h"
+
+using bustub::BufferPoolManagerInstance;
+using bustub::Column;
+using bustub::DiskManager;
+using bustub::LockManager;
+using bustub::RID;
+using bustub::Schema;
+using bustub::TableHeap;
+using bustub::TablePageScan;
+using bustub::Transaction;
+using bustub::Tuple;
+using bustub::TypeId;
+using bustub::ValueFactory;
+
+static const char *const DB_FILE = "table_scan_bench.db";
+
+/** run scan rounds times, print ns per row; scan returns the sum of column a so the work is not optimized away */
+static void Measure(const char *name, size_t rows, int rounds, const std::function<int64_t()> &scan) {
+  int64_t sum = scan();
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < rounds; i++) {
+    sum += scan();
+  }
+  auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+  printf("  %-22s %6.1f ns/row   (sum %ld)\n", name, static_cast<double>(nanos) / (rows * rounds), sum);  // NOLINT
+}
+
+/*
+ * Full scans of a table heap: TableIterator (FetchPage, latch and tuple copy per row, what SeqScanExecutor used),
+ * TablePageScan copying every row into a reused Tuple (what SeqScanExecutor does now), and TablePageScan reading the
+ * column straight from the TupleView. The pool holds the whole table. Build in Release mode, the Debug build runs with
+ * -O0 and ASAN.
+ *
+ * usage: table_scan_bench [rows] [rounds]
+ */
+auto main(int argc, char **argv) -> int {
+  size_t rows = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+  int rounds = argc > 2 ? std::atoi(argv[2]) : 5;
+
+  DiskManager disk_manager(DB_FILE);
+  // 每页约 60 行, 整张表放得进 buffer pool
+  BufferPoolManagerInstance bpm(rows / 50 + 64, &disk_manager);
+  LockManager lock_manager;
+  Transaction txn(0);
+  Schema schema({Column{"a", TypeId::INTEGER}, Column{"b", TypeId::INTEGER}, Column{"c", TypeId::VARCHAR, 32}});
+  TableHeap heap(&bpm, &lock_manager, nullptr, &txn);
+  for (size_t i = 0; i < rows; i++) {
+    Tuple tuple({ValueFactory::GetIntegerValue(static_cast<int32_t>(i % 1000)),
+                 ValueFactory::GetIntegerValue(static_cast<int32_t>(i)),
+                 ValueFactory::GetVarcharValue("row-" + std::to_string(i))},
+                &schema);
+    RID rid;
+    heap.InsertTuple(tuple, &rid, &txn);
+  }
+  txn.GetWriteSet()->clear();
+
+  printf("%zu rows, %d rounds\n", rows, rounds);  // NOLINT
+  Measure("table iterator", rows, rounds, [&]() {
+    int64_t sum = 0;
+    for (auto it = heap.Begin(&txn); it != heap.End(); ++it) {
+      sum += it->GetValue(&schema, 0).GetAs<int32_t>();
+    }
+    return sum;
+  });
+  Measure("page scan + copy", rows, rounds, [&]() {
+    int64_t sum = 0;
+    Tuple tuple;
+    TablePageScan scan(&heap, &txn);
+    while (scan.NextPage()) {
+      for (const auto &view : scan.GetViews()) {
+        view.CopyTo(&tuple);
+        sum += tuple.GetValue(&schema, 0).GetAs<int32_t>();
+      }
+    }
+    return sum;
+  });
+  Measure("page scan, views only", rows, rounds, [&]() {
+    int64_t sum = 0;
+    TablePageScan scan(&heap, &txn);
+    while (scan.NextPage()) {
+      for (const auto &view : scan.GetViews()) {
+        sum += view.GetValue(&schema, 0).GetAs<int32_t>();
+      }
+    }
+    return sum;
+  });
+
+  remove(DB_FILE);
+  return 0;
+}